@@ -0,0 +1,578 @@
+/************************************************************************
+ *  arcclient - Check the archival MiniSEED records of lib660 or lib330.
+ *
+ *  arcclient is a lib660 client of a q660sim fake Q660 that sets the
+ *  archival MiniSEED callback (call_aminidata), which makes lib660
+ *  assemble the archival records on its worker threads (ARC_POOL).
+ *  Compiled with LIB330 it is arcclient330, the same client of lib330
+ *  and a q330sim fake Q330.
+ *  While the data flows it reads the LCQ status with lib_get_lcqstat
+ *  every few milliseconds, as a status display would.
+ *
+ *  For every channel it checks that:
+ *  -   a new archival record has the next sequence number, and an
+ *	incremental update has the sequence number and start time of the
+ *	record it updates and at least as many samples.  An incremental
+ *	record may end with MSA_INC rather than MSA_FINAL, when its last
+ *	update already sent it complete,
+ *  -   a data record does not start before the previous record of the
+ *	channel ended.  A record that starts later follows a gap in the
+ *	data, which is counted,
+ *  -   the archival callbacks are never called at the same time,
+ *  -   the archive status is never behind the records already received,
+ *	and never goes backwards,
+ *  -   after the station is deregistered, the archival records hold as
+ *	many samples as the 512 byte records.
+ ************************************************************************/
+
+/* Modification History:
+------------------------------------------------------------------------
+    2026.292     ver 1.0.0	Initial version.
+*/
+
+#define	VERSION		"1.0.0 (2026.292)"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include <unistd.h>
+#include <string.h>
+#include <signal.h>
+#include <libgen.h>
+#include <math.h>
+#include <pthread.h>
+#include <sys/time.h>
+
+#ifdef LIB330
+#include "libclient.h"
+#include "libmsgs.h"
+#define	LIBNAME		"lib330"
+#define	SIMNAME		"q330sim"
+#define	DEFAULT_HOST	"127.0.0.2"	/* lib330 takes 127.0.0.1 for a baler.*/
+#else
+#define	PROG_DL 1
+#include "libclient.h"
+#include "libmsgs.h"
+#define	LIBNAME		"lib660"
+#define	SIMNAME		"q660sim"
+#define	DEFAULT_HOST	"127.0.0.1"
+#endif
+
+#define	SERIAL		0x0100000000000001LL	/* As in run_bench.	*/
+#define	STAT_INTERVAL	10000		/* usec between lib_get_lcqstat.*/
+#define	STOP_WAIT	30		/* Seconds to wait for a state.	*/
+#define	SEQ_OFFSET	0		/* Sequence number in a header.	*/
+#define	NSAMP_OFFSET	30		/* Number of samples in a header.*/
+
+char *syntax[] = {
+"%s version " VERSION,
+"%s [-d duration] [-e exponent] [-H highest] [-i host] [-v] [-h] baseport",
+"    where:",
+"	-d duration Seconds to run after the data starts (default 30).",
+"	-e exponent Archival record size is 2**exponent (default 12).",
+"	-H highest  Highest rate with incremental archival records",
+"		    (default 20).",
+"	-i host	    IP address of " SIMNAME " (default " DEFAULT_HOST ").",
+"	-v	    Print the " LIBNAME " messages.",
+"	-h	    Print brief help message for syntax.",
+"	baseport    Base port of " SIMNAME ".",
+"Examples:",
+"	" SIMNAME " -b 6100 XX.B001 &",
+"	%s -d 60 6100",
+" Notes",
+" 1.  Gaps are gaps in the data, e.g. from " SIMNAME " -L, and are not errors.",
+" 2.  The exit status is 1 if no archival records were received or any",
+"     check failed.",
+NULL };
+
+typedef struct _chan {			/* One channel (LCQ).		*/
+    char location[3];
+    char channel[4];
+    int lcq;				/* chan_number, names may repeat.*/
+    enum tpacket_class packet_class;
+    int rate;
+    int open;				/* Incremental record is open.	*/
+    int seq;				/* Of the last archival record.	*/
+    double start;			/* Start time of that record.	*/
+    int nsamp;				/* Samples of that record.	*/
+    uint64_t records, updates, worker_calls;
+    uint64_t arc_samples, mini_samples;
+    uint64_t gaps, errors;
+    int stat_seq, stat_cnt;		/* Last lib_get_lcqstat values.	*/
+} CHAN;
+
+char *cmdname;				/* Name of this program.	*/
+volatile int terminate_proc;
+int verbose;
+
+CHAN chans[MAX_LCQ];
+int nchans;
+pthread_mutex_t chan_mutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_t lib_thread;			/* Thread of call_minidata.	*/
+volatile int lib_thread_set;
+volatile int in_arc;			/* call_aminidata is running.	*/
+uint64_t overlaps, stat_errors, stat_reads;
+volatile enum tlibstate lib_state = LIBSTATE_IDLE;
+
+int print_syntax (char *cmd, char *syntax[], FILE *fp);
+void finish_handler (int sig);
+
+/************************************************************************
+ *  find_chan:
+ *	Return the channel of a location, channel name and LCQ number,
+ *	adding it if it is new, or NULL if the table is full.  Call with
+ *	chan_mutex.
+ ************************************************************************/
+CHAN *find_chan (char *location, char *channel, int lcq)
+{
+    CHAN *ch;
+    int i;
+
+    for (i = 0; i < nchans; i++) {
+	ch = &chans[i];
+	if (ch->lcq == lcq && strcmp (ch->location, location) == 0
+	    && strcmp (ch->channel, channel) == 0)
+	    return ch;
+    }
+    if (nchans >= MAX_LCQ) return NULL;
+    ch = &chans[nchans++];
+    memset (ch, 0, sizeof(CHAN));
+    strncpy (ch->location, location, sizeof(ch->location) - 1);
+    strncpy (ch->channel, channel, sizeof(ch->channel) - 1);
+    ch->lcq = lcq;
+    return ch;
+}
+
+/************************************************************************
+ *  record_nsamp:
+ *	Return the number of samples in the header of a MiniSEED record.
+ ************************************************************************/
+int record_nsamp (tminiseed_call *pmini)
+{
+    unsigned char *p = (unsigned char *)pmini->data_address;
+    return (p[NSAMP_OFFSET] << 8) | p[NSAMP_OFFSET + 1];
+}
+
+/************************************************************************
+ *  record_seq:
+ *	Return the sequence number in the header of a MiniSEED record.
+ ************************************************************************/
+int record_seq (tminiseed_call *pmini)
+{
+    char s[7];
+    memcpy (s, (char *)pmini->data_address + SEQ_OFFSET, 6);
+    s[6] = '\0';
+    return atoi (s);
+}
+
+/************************************************************************
+ *  new_record:
+ *	Check a new archival record against the previous record of its
+ *	channel.  Call with chan_mutex.
+ ************************************************************************/
+void new_record (CHAN *ch, tminiseed_call *pmini, int seq, int nsamp)
+{
+    double prev_end;
+
+    if (ch->records > 0) {
+	if (seq != ch->seq + 1) {
+	    printf ("%s.%s: archival record %d follows %d\n",
+		    ch->location, ch->channel, seq, ch->seq);
+	    ++ch->errors;
+	}
+	prev_end = ch->start + (double)ch->nsamp / pmini->rate;
+	if (pmini->packet_class == PKC_DATA && pmini->rate > 0) {
+	    if (pmini->timestamp < prev_end - 0.5 / pmini->rate) {
+		printf ("%s.%s: archival record %d starts %.6f sec before the prev_end of %d\n",
+			ch->location, ch->channel, seq, prev_end - pmini->timestamp, ch->seq);
+		++ch->errors;
+	    }
+	    else if (pmini->timestamp > prev_end + 0.5 / pmini->rate)
+		++ch->gaps;
+	}
+    }
+    ch->arc_samples += ch->nsamp;
+    ch->seq = seq;
+    ch->start = pmini->timestamp;
+    ch->nsamp = nsamp;
+    ch->open = (pmini->miniseed_action == MSA_FIRST);
+    ++ch->records;
+}
+
+/************************************************************************
+ *  update_record:
+ *	Check an incremental update of an archival record.  Call with
+ *	chan_mutex.
+ ************************************************************************/
+void update_record (CHAN *ch, tminiseed_call *pmini, int seq, int nsamp)
+{
+    if (! ch->open || seq != ch->seq || pmini->timestamp != ch->start || nsamp < ch->nsamp) {
+	printf ("%s.%s: archival update %d (%d samples) does not update record %d (%d samples)\n",
+		ch->location, ch->channel, seq, nsamp, ch->seq, ch->nsamp);
+	++ch->errors;
+    }
+    ch->nsamp = nsamp;
+    if (pmini->miniseed_action == MSA_FINAL) ch->open = 0;
+    ++ch->updates;
+}
+
+/************************************************************************
+ *  aminidata_callback:
+ *	Archival MiniSEED callback, called by the archive workers.
+ ************************************************************************/
+void aminidata_callback (pointer p)
+{
+    tminiseed_call *pmini = (tminiseed_call *)p;
+    CHAN *ch;
+    int seq, nsamp;
+
+    if (__atomic_fetch_add (&in_arc, 1, __ATOMIC_ACQ_REL) != 0)
+	__atomic_fetch_add (&overlaps, 1, __ATOMIC_RELAXED);
+    pthread_mutex_lock (&chan_mutex);
+    ch = find_chan (pmini->location, pmini->channel, pmini->chan_number);
+    if (ch != NULL && pmini->miniseed_action != MSA_GETARC) {
+	/* Leave MSA_GETARC alone, there is no last record to return.	*/
+	ch->packet_class = pmini->packet_class;
+	ch->rate = pmini->rate;
+	seq = record_seq (pmini);
+	nsamp = (pmini->packet_class == PKC_DATA) ? record_nsamp (pmini) : 0;
+	if (pmini->miniseed_action == MSA_ARC || pmini->miniseed_action == MSA_FIRST)
+	    new_record (ch, pmini, seq, nsamp);
+	else
+	    update_record (ch, pmini, seq, nsamp);
+	if (lib_thread_set && ! pthread_equal (pthread_self (), lib_thread))
+	    ++ch->worker_calls;
+    }
+    pthread_mutex_unlock (&chan_mutex);
+    __atomic_fetch_sub (&in_arc, 1, __ATOMIC_ACQ_REL);
+}
+
+/************************************************************************
+ *  minidata_callback:
+ *	512 byte MiniSEED callback, called by the library thread.
+ ************************************************************************/
+void minidata_callback (pointer p)
+{
+    tminiseed_call *pmini = (tminiseed_call *)p;
+    CHAN *ch;
+
+    if (! lib_thread_set) {
+	lib_thread = pthread_self ();
+	lib_thread_set = 1;
+    }
+    if (pmini->packet_class != PKC_DATA) return;
+    pthread_mutex_lock (&chan_mutex);
+    if ((ch = find_chan (pmini->location, pmini->channel, pmini->chan_number)) != NULL)
+	ch->mini_samples += record_nsamp (pmini);
+    pthread_mutex_unlock (&chan_mutex);
+}
+
+/************************************************************************
+ *  state_change_callback:
+ *	Keep the library state.
+ ************************************************************************/
+void state_change_callback (pointer p)
+{
+    tstate_call *state = (tstate_call *)p;
+
+    if (state->state_type == ST_STATE) lib_state = (enum tlibstate)state->info;
+}
+
+/************************************************************************
+ *  message_callback:
+ *	Print the library messages with -v.
+ ************************************************************************/
+void message_callback (pointer p)
+{
+    tmsg_call *msg = (tmsg_call *)p;
+    string95 s;
+
+    if (! verbose) return;
+#ifdef LIB330
+    lib_get_msg (msg->code, &s);
+#else
+    lib_get_msg (msg->code, s);
+#endif
+    printf (LIBNAME ": %s %s\n", s, msg->suffix);
+}
+
+#ifndef LIB330
+/************************************************************************
+ *  file_access_callback:
+ *	There are no continuity files: fail every file access.
+ ************************************************************************/
+void file_access_callback (pointer p)
+{
+    tfileacc_call *fc = (tfileacc_call *)p;
+
+    fc->fault = TRUE;
+    fc->handle = -1;
+}
+#endif
+
+/************************************************************************
+ *  check_status:
+ *	Read the LCQ status, and check that the archive status of each
+ *	channel is not behind the archival records received before, and
+ *	does not go backwards.
+ ************************************************************************/
+void check_status (tcontext ct)
+{
+    static tlcqstat lcqstat;
+    uint64_t received[MAX_LCQ];
+    tonelcqstat *pone;
+    CHAN *ch;
+    int i, j;
+
+    /* Records received before the status is read must be counted.	*/
+    pthread_mutex_lock (&chan_mutex);
+    for (i = 0; i < nchans; i++) received[i] = chans[i].records;
+    pthread_mutex_unlock (&chan_mutex);
+
+    if (lib_get_lcqstat (ct, &lcqstat) != LIBERR_NOERR) return;
+    ++stat_reads;
+
+    pthread_mutex_lock (&chan_mutex);
+    for (i = 0; i < lcqstat.count; i++) {
+	pone = &lcqstat.entries[i];
+	for (j = 0; j < nchans; j++) {
+	    ch = &chans[j];
+	    if (ch->lcq == pone->chan_number && strcmp (ch->location, pone->location) == 0
+		&& strcmp (ch->channel, pone->channel) == 0)
+		break;
+	}
+	if (j == nchans) continue;
+	if ((uint64_t)pone->arec_cnt < received[j] || pone->arec_seq < pone->arec_cnt
+	    || pone->arec_cnt < ch->stat_cnt || pone->arec_seq < ch->stat_seq) {
+	    printf ("%s.%s: archive status %d records, sequence %d after %d records, sequence %d, %llu received\n",
+		    ch->location, ch->channel, pone->arec_cnt, pone->arec_seq,
+		    ch->stat_cnt, ch->stat_seq, (unsigned long long)received[j]);
+	    ++stat_errors;
+	}
+	ch->stat_cnt = pone->arec_cnt;
+	ch->stat_seq = pone->arec_seq;
+    }
+    pthread_mutex_unlock (&chan_mutex);
+}
+
+/************************************************************************
+ *  wait_state:
+ *	Wait for a library state.  Return 0, or -1 after STOP_WAIT seconds.
+ ************************************************************************/
+int wait_state (tcontext ct, enum tlibstate state)
+{
+    enum tliberr err;
+    topstat opstat;
+    int i;
+
+    for (i = 0; i < STOP_WAIT * 10; i++) {
+	if (lib_get_state (ct, &err, &opstat) == state) return 0;
+	usleep (100000);
+    }
+    return -1;
+}
+
+/************************************************************************
+ *  main procedure
+ ************************************************************************/
+int main (int argc, char **argv)
+{
+    char *host = DEFAULT_HOST;
+    double duration = 30.;
+    int exponent = 12;
+    int highest = 20;
+    tpar_create create;
+    tpar_register reg;
+#ifndef LIB330
+    tfile_owner fowner;
+#endif
+    tcontext ct;
+    enum tliberr err;
+    topstat opstat;
+    struct timeval tv;
+    double now, stop_time = 0.;
+    uint64_t records = 0, updates = 0, worker_calls = 0, gaps = 0, errors = 0;
+    int64_t serial = SERIAL;
+    int i, baseport, status;
+    CHAN *ch;
+
+    /* Variables needed for getopt. */
+    extern char	*optarg;
+    extern int	optind, opterr;
+    int		c;
+
+    setlinebuf(stdout);
+    cmdname = basename(strdup(argv[0]));
+    while ( (c = getopt(argc,argv,"hd:e:H:i:v")) != -1)
+	switch (c) {
+	case '?':
+	case 'h':   print_syntax(cmdname,syntax,stdout); exit(1);
+	case 'd':   duration = atof(optarg); break;
+	case 'e':   exponent = atoi(optarg); break;
+	case 'H':   highest = atoi(optarg); break;
+	case 'i':   host = optarg; break;
+	case 'v':   verbose = 1; break;
+	default:
+	    fprintf (stderr, "Unsupported option: -%c\n", c);
+	    exit(1);
+	}
+
+    /*	Skip over all options and their arguments.			*/
+    argv = &(argv[optind]);
+    argc -= optind;
+
+    if (argc != 1) {
+	print_syntax(cmdname,syntax,stdout);
+	exit(1);
+    }
+    baseport = atoi(argv[0]);
+    if (duration <= 0. || exponent < 9 || exponent > 14 || baseport <= 0 || baseport > 65535) {
+	fprintf (stderr, "Invalid option value\n");
+	exit(1);
+    }
+
+    signal (SIGINT, finish_handler);
+    signal (SIGTERM, finish_handler);
+    signal (SIGPIPE, SIG_IGN);
+
+    memset (&create, 0, sizeof(create));
+#ifdef LIB330
+    memcpy (create.q330id_serial, &serial, sizeof(serial));
+    create.q330id_dataport = LP_TEL1;
+    create.opt_zoneadjust = 1;	/* No opt_contfile, no continuity.	*/
+#else
+    memset (&fowner, 0, sizeof(fowner));
+    fowner.call_fileacc = file_access_callback;
+    memcpy (create.q660id_serial, &serial, sizeof(serial));
+    create.q660id_priority = 1;
+    strcpy (create.host_ident, "arcclient");
+    create.file_owner = &fowner;
+#endif
+    sprintf (create.host_software, "%s %s", cmdname, VERSION);
+    create.opt_verbose = 0;
+    create.opt_minifilter = OMF_ALL;
+    create.opt_aminifilter = OMF_ALL;
+    create.amini_exponent = exponent;
+    create.amini_512highest = highest;
+    create.mini_separate = 1;
+    create.call_minidata = minidata_callback;
+    create.call_aminidata = aminidata_callback;
+    create.call_state = state_change_callback;
+    create.call_messages = message_callback;
+    lib_create_context (&ct, &create);
+    if (ct == NULL) {
+	fprintf (stderr, "Unable to create the " LIBNAME " context: error %d\n", create.resp_err);
+	exit(1);
+    }
+
+    memset (&reg, 0, sizeof(reg));
+#ifdef LIB330
+    strcpy (reg.q330id_address, host);
+    reg.q330id_baseport = baseport;
+    reg.host_mode = HOST_ETH;
+    reg.host_mincmdretry = 5;
+    reg.host_maxcmdretry = 40;
+#else
+    strcpy (reg.q660id_pass, "0");
+    strcpy (reg.q660id_address, host);
+    reg.q660id_baseport = baseport;
+    reg.prefer_ipv4 = TRUE;
+    reg.start_newer = TRUE;
+    reg.opt_maxsps = 1000;
+    reg.opt_start = OST_LAST;
+    reg.opt_client_mode = LMODE_BSL;
+#endif
+    if ((err = lib_register (ct, &reg)) != LIBERR_NOERR) {
+	fprintf (stderr, "Unable to register with %s:%d: error %d\n", host, baseport, err);
+	exit(1);
+    }
+    printf ("%s version %s, " SIMNAME " %s:%d, %d byte archival records, incremental up to %d sps, duration %.0f sec\n",
+	    cmdname, VERSION, host, baseport, 1 << exponent, highest, duration);
+
+    /* Start the data when registered, and read the status while it	*/
+    /* flows.								*/
+    while (! terminate_proc) {
+	gettimeofday (&tv, NULL);
+	now = tv.tv_sec + tv.tv_usec / 1000000.;
+	if (lib_state == LIBSTATE_RUNWAIT) {
+	    lib_change_state (ct, LIBSTATE_RUN, LIBERR_NOERR);
+	    lib_state = LIBSTATE_RUN;
+	}
+	else if (lib_state == LIBSTATE_RUN && lib_get_state (ct, &err, &opstat) == LIBSTATE_RUN) {
+	    if (stop_time == 0.) stop_time = now + duration;
+	    if (now >= stop_time) break;
+	    check_status (ct);
+	}
+	usleep (STAT_INTERVAL);
+    }
+    if (stop_time == 0.) fprintf (stderr, "The data never started\n");
+
+    /* Deregister, which flushes the records, and wait for the workers.	*/
+    lib_change_state (ct, LIBSTATE_IDLE, LIBERR_CLOSED);
+    if (wait_state (ct, LIBSTATE_IDLE) < 0) fprintf (stderr, "Timeout deregistering\n");
+    lib_change_state (ct, LIBSTATE_TERM, LIBERR_CLOSED);
+    if (wait_state (ct, LIBSTATE_TERM) < 0) fprintf (stderr, "Timeout terminating\n");
+    lib_destroy_context (&ct);
+
+    printf ("loc chan lcq  rate  records  updates  worker_calls  arc_samples  512_samples  gaps  errors\n");
+    for (i = 0; i < nchans; i++) {
+	ch = &chans[i];
+	ch->arc_samples += ch->nsamp;
+	if (ch->packet_class == PKC_DATA && ch->records > 0 && ch->arc_samples != ch->mini_samples) {
+	    printf ("%s.%s: %llu archival samples, %llu 512 byte record samples\n",
+		    ch->location, ch->channel, (unsigned long long)ch->arc_samples,
+		    (unsigned long long)ch->mini_samples);
+	    ++ch->errors;
+	}
+    }
+    for (i = 0; i < nchans; i++) {
+	ch = &chans[i];
+	if (ch->records == 0) continue;
+	printf ("%-3s %-4s %3d %5d %8llu %8llu %13llu %12llu %12llu %5llu %7llu\n",
+		ch->location, ch->channel, ch->lcq, ch->rate, (unsigned long long)ch->records,
+		(unsigned long long)ch->updates, (unsigned long long)ch->worker_calls,
+		(unsigned long long)ch->arc_samples, (unsigned long long)ch->mini_samples,
+		(unsigned long long)ch->gaps, (unsigned long long)ch->errors);
+	records += ch->records;
+	updates += ch->updates;
+	worker_calls += ch->worker_calls;
+	gaps += ch->gaps;
+	errors += ch->errors;
+    }
+    printf ("all %8llu records, %llu updates, %llu from workers, %llu gaps, %llu errors\n",
+	    (unsigned long long)records, (unsigned long long)updates,
+	    (unsigned long long)worker_calls, (unsigned long long)gaps,
+	    (unsigned long long)errors);
+    printf ("%llu status reads, %llu status errors, %llu overlapping callbacks\n",
+	    (unsigned long long)stat_reads, (unsigned long long)stat_errors,
+	    (unsigned long long)overlaps);
+    status = (records == 0 || errors > 0 || stat_errors > 0 || overlaps > 0) ? 1 : 0;
+    return (terminate_proc) ? 1 : status;
+}
+
+/************************************************************************
+ *  print_syntax:
+ *	Print the syntax description of program.
+ ************************************************************************/
+int print_syntax (char	*cmd,		/* program name.			*/
+		  char	*syntax[],	/* syntax array.			*/
+		  FILE	*fp)		/* FILE ptr for output.			*/
+{
+    int i;
+    for (i=0; syntax[i] != NULL; i++) {
+	fprintf (fp, syntax[i], cmd);
+	fprintf (fp, "\n");
+    }
+    return (0);
+}
+
+/************************************************************************
+ *  finish_handler:
+ *	Signal handler to terminate the program.
+ ************************************************************************/
+void finish_handler (int sig)
+{
+    signal (sig, finish_handler);
+    terminate_proc = 1;
+}
@@ -0,0 +1,230 @@
+/***********************************************************************
+ * benchutil.c - MiniSEED records for the comserv benchmark programs.
+ *
+ * 2026-10-19 Initial version.
+ **********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <errno.h>
+#include <arpa/inet.h>
+
+#include "dpstruc.h"
+#include "seedstrc.h"
+#include "stuff.h"
+#include "benchutil.h"
+
+#define STEIM1		10		/* Encoding format.		*/
+#define NFRAMES		7		/* Frames after the header.	*/
+#define AMPLITUDE	100.		/* Counts.			*/
+#define PERIOD		100		/* Samples.			*/
+
+static const char *chan_names[] = {
+    "HHZ", "HHN", "HHE", "HNZ", "HNN", "HNE",
+    "BHZ", "BHN", "BHE", "LHZ", "LHN", "LHE"
+};
+#define NCHAN_NAMES	(int)(sizeof(chan_names) / sizeof(chan_names[0]))
+
+static void put32 (unsigned char *p, uint32_t v)
+{
+    p[0] = v >> 24; p[1] = v >> 16; p[2] = v >> 8; p[3] = v;
+}
+
+/***********************************************************************
+ * synth_init()
+ *	Set up synthetic channel index of a station.  The channel names
+ *	repeat every 12 channels with the next location code.
+ **********************************************************************/
+
+void synth_init (SYNTH_CHAN *c, const char *network, const char *station,
+		 int index, double rate, double start)
+{
+    int n;
+
+    memset (c, 0, sizeof(SYNTH_CHAN));
+    strncpy (c->network, network, sizeof(c->network) - 1);
+    strncpy (c->station, station, sizeof(c->station) - 1);
+    strcpy (c->channel, chan_names[index % NCHAN_NAMES]);
+    n = (index / NCHAN_NAMES) % 100;
+    c->location[0] = '0' + n / 10;
+    c->location[1] = '0' + n % 10;
+    c->rate = rate;
+    c->start = start;
+    c->seq = 1;
+}
+
+/***********************************************************************
+ * synth_record_seconds()
+ *	RETURNS the length of a record of the channel in seconds.
+ **********************************************************************/
+
+double synth_record_seconds (SYNTH_CHAN *c)
+{
+    return BENCH_SYNTH_SAMPLES / c->rate;
+}
+
+/***********************************************************************
+ * synth_record()
+ *	Build the next record of the channel in rec.
+ *	RETURNS the time of the record after it.
+ **********************************************************************/
+
+double synth_record (SYNTH_CHAN *c, char *rec)
+{
+    seed_fixed_data_record_header *h = (seed_fixed_data_record_header *)rec;
+    unsigned char *frame = (unsigned char *)rec + 64;
+    int32_t x[BENCH_SYNTH_SAMPLES];
+    time_t secs = (time_t)floor(c->start);
+    struct tm tm;
+    char s[8];
+    int i, f, w, n;
+
+    memset (rec, 0, BENCH_RECSIZE);
+    gmtime_r (&secs, &tm);
+    snprintf (s, sizeof(s), "%06d", c->seq % 1000000);
+    memcpy (h->header.sequence, s, 6);
+    h->header.seed_record_type = 'D';
+    h->header.continuation_record = ' ';
+    memset (h->header.station_ID_call_letters, ' ', 5);
+    memcpy (h->header.station_ID_call_letters, c->station, strlen(c->station));
+    memcpy (h->header.location_id, c->location, 2);
+    memcpy (h->header.channel_id, c->channel, 3);
+    memset (h->header.seednet, ' ', 2);
+    memcpy (h->header.seednet, c->network, strlen(c->network));
+    h->header.starting_time.yr = htons(tm.tm_year + 1900);
+    h->header.starting_time.jday = htons(tm.tm_yday + 1);
+    h->header.starting_time.hr = tm.tm_hour;
+    h->header.starting_time.minute = tm.tm_min;
+    h->header.starting_time.seconds = tm.tm_sec;
+    h->header.starting_time.tenth_millisec = htons((int)((c->start - secs) * 10000.));
+    h->header.samples_in_record = htons(BENCH_SYNTH_SAMPLES);
+    if (c->rate >= 1.) {
+	h->header.sample_rate_factor = htons((int)(c->rate + 0.5));
+	h->header.sample_rate_multiplier = htons(1);
+    }
+    else {
+	h->header.sample_rate_factor = htons(-(int)(1. / c->rate + 0.5));
+	h->header.sample_rate_multiplier = htons(1);
+    }
+    h->header.IO_flags = SEED_IO_CLOCK_LOCKED;
+    h->header.number_of_following_blockettes = 1;
+    h->header.first_data_byte = htons(64);
+    h->header.first_blockette_byte = htons(48);
+    h->dob.blockette_type = htons(1000);
+    h->dob.encoding_format = STEIM1;
+    h->dob.word_order = 1;
+    h->dob.rec_length = 9;
+
+    for (i = 0; i < BENCH_SYNTH_SAMPLES; i++)
+	x[i] = (int32_t)lrint(AMPLITUDE * sin(2. * M_PI * (double)((c->sample + i) % PERIOD) / PERIOD));
+
+    /* Every data word holds four one byte differences.  The first	*/
+    /* frame starts with the forward and reverse integration constants.	*/
+    n = 0;
+    for (f = 0; f < NFRAMES; f++, frame += 64) {
+	uint32_t nibbles = 0;
+	for (w = (f == 0) ? 3 : 1; w < 16; w++) {
+	    unsigned char *p = frame + 4 * w;
+	    int b;
+	    for (b = 0; b < 4; b++, n++)
+		p[b] = (unsigned char)(int8_t)(x[n] - ((n == 0) ? c->last : x[n-1]));
+	    nibbles |= 1u << (2 * (15 - w));
+	}
+	put32 (frame, nibbles);
+	if (f == 0) {
+	    put32 (frame + 4, (uint32_t)x[0]);
+	    put32 (frame + 8, (uint32_t)x[BENCH_SYNTH_SAMPLES-1]);
+	}
+    }
+
+    c->last = x[BENCH_SYNTH_SAMPLES-1];
+    c->sample += BENCH_SYNTH_SAMPLES;
+    c->seq++;
+    c->start += synth_record_seconds (c);
+    return c->start;
+}
+
+/***********************************************************************
+ * ms_load()
+ *	Append the 512 byte records of a MiniSEED file to *records.
+ *	Records of any other length are skipped.
+ *	RETURNS 0 upon success, -1 if the file could not be read.
+ **********************************************************************/
+
+int ms_load (const char *file, char **records, int *nrecords)
+{
+    unsigned char buf[BENCH_RECSIZE];
+    FILE *fp;
+    int skipped = 0;
+
+    if ((fp = fopen (file, "r")) == NULL) {
+	fprintf (stderr, "Unable to open %s: %s\n", file, strerror(errno));
+	return (-1);
+    }
+    while (fread (buf, BENCH_RECSIZE, 1, fp) == 1) {
+	seed_fixed_data_record_header *h = (seed_fixed_data_record_header *)buf;
+	int reclen = BENCH_RECSIZE;
+	if (strchr ("DRQM", h->header.seed_record_type) == NULL) {
+	    ++skipped;
+	    continue;
+	}
+	if (ntohs(h->dob.blockette_type) == 1000 && h->dob.rec_length != 9) {
+	    reclen = 1 << h->dob.rec_length;
+	    if (reclen > BENCH_RECSIZE) fseek (fp, reclen - BENCH_RECSIZE, SEEK_CUR);
+	    ++skipped;
+	    continue;
+	}
+	if ((*nrecords % 1024) == 0
+	    && (*records = (char *)realloc (*records, (*nrecords + 1024) * BENCH_RECSIZE)) == NULL) {
+	    fprintf (stderr, "Unable to allocate records of %s\n", file);
+	    fclose (fp);
+	    return (-1);
+	}
+	memcpy (*records + (size_t)*nrecords * BENCH_RECSIZE, buf, BENCH_RECSIZE);
+	++*nrecords;
+    }
+    fclose (fp);
+    if (skipped)
+	fprintf (stderr, "Skipped %d records of %s that are not 512 byte data records\n",
+		 skipped, file);
+    return (0);
+}
+
+/***********************************************************************
+ * ms_set_station()
+ *	Replace the SEED station and network codes of a record.
+ **********************************************************************/
+
+void ms_set_station (char *rec, const char *network, const char *station)
+{
+    seed_record_header *h = (seed_record_header *)rec;
+    size_t n;
+
+    memset (h->station_ID_call_letters, ' ', 5);
+    n = strlen(station);
+    memcpy (h->station_ID_call_letters, station, (n > 5) ? 5 : n);
+    memset (h->seednet, ' ', 2);
+    n = strlen(network);
+    memcpy (h->seednet, network, (n > 2) ? 2 : n);
+}
+
+/***********************************************************************
+ * bench_sleep_until()
+ *	Sleep until time t (seconds since 1970), or until a signal such
+ *	as the SIGALRM of a comserv client arrives.
+ **********************************************************************/
+
+void bench_sleep_until (double t)
+{
+    struct timespec ts;
+    double dt = t - dtime ();
+
+    if (dt <= 0.) return;
+    ts.tv_sec = (time_t)dt;
+    ts.tv_nsec = (long)((dt - ts.tv_sec) * 1.0e9);
+    nanosleep (&ts, NULL);
+}
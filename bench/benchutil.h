@@ -0,0 +1,47 @@
+/* benchutil.h - MiniSEED records for the comserv benchmark programs */
+
+#ifndef BENCHUTIL_H
+#define BENCHUTIL_H
+
+/*
+ * 2026-10-19 Initial version.
+ *
+ * The replay programs send either records read from MiniSEED files or
+ * synthetic records.  A synthetic channel produces 512 byte Steim1
+ * records of a small sine wave, with contiguous times, so that the
+ * channel statistics of the servers see no gaps.  Only 512 byte records
+ * are used, since that is the size of a comserv ring element.
+ */
+
+#include <stdint.h>
+
+#define BENCH_RECSIZE		512
+#define BENCH_SYNTH_SAMPLES	412	/* Samples in a synthetic record.	*/
+
+typedef struct {
+    char station[6];		/* SEED codes, NUL terminated.			*/
+    char network[3];
+    char channel[4];
+    char location[3];
+    double rate;		/* Samples per second.				*/
+    double start;		/* Time of the next record.			*/
+    int32_t seq;		/* Sequence number of the next record.		*/
+    int32_t last;		/* Last sample of the previous record.		*/
+    int64_t sample;		/* Index of the next sample.			*/
+} SYNTH_CHAN;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+void synth_init (SYNTH_CHAN *c, const char *network, const char *station,
+		 int index, double rate, double start);
+double synth_record (SYNTH_CHAN *c, char *rec);
+double synth_record_seconds (SYNTH_CHAN *c);
+int ms_load (const char *file, char **records, int *nrecords);
+void ms_set_station (char *rec, const char *network, const char *station);
+void bench_sleep_until (double t);
+#ifdef __cplusplus
+}
+#endif
+
+#endif
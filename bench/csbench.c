@@ -0,0 +1,534 @@
+/************************************************************************
+ *  csbench - Measure the throughput and latency of comserv servers.
+ *
+ *  csbench starts a number of comserv client processes that each read
+ *  all data records of the selected stations as fast as they can, the
+ *  way datalog or cs2ringserver do.  After a warmup period it measures
+ *  for a fixed time:
+ *	- records per second queued by each server, from the server
+ *	  statistics in its shared memory segment (chanstats.h),
+ *	- CPU time used by each server and by each client, per record,
+ *	- latency of each record from its reception by the server to its
+ *	  arrival in a client, from the reception time the server stores
+ *	  with the record.
+ *
+ *  The servers can be any comserv servers.  msreplay, msmcreplay and
+ *  run_bench in this directory provide the load without a data logger.
+ ************************************************************************/
+
+/* Modification History:
+------------------------------------------------------------------------
+    2026.292     ver 1.0.0	Initial version.
+*/
+
+#define	VERSION		"1.0.0 (2026.292)"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include <unistd.h>
+#include <string.h>
+#include <signal.h>
+#include <libgen.h>
+#include <math.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/mman.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+#include "cslimits.h"
+#include "cstypes.h"
+#include "dpstruc.h"
+#include "service.h"
+#include "cfgutil.h"
+#include "chanstats.h"
+#include "timeutil.h"
+#include "stuff.h"
+
+#define ANNOUNCE(cmd,fp)							\
+    ( fprintf (fp, "%s - Using STATIONS_INI=%s NETWORK_INI=%s\n", \
+	      cmd, get_stations_ini_pathname(), get_network_ini_pathname()) )
+
+#define	MAX_BENCH_CLIENTS	99
+#define	DATABUFS		50	/* Records per client request.	*/
+
+/* Latency histogram: bucket i holds latencies from HIST_BASE * HIST_STEP^i */
+/* to HIST_BASE * HIST_STEP^(i+1) seconds, a 2% resolution from 1 usec	*/
+/* to over 100 seconds.							*/
+#define	HIST_BASE		1.0e-6
+#define	HIST_STEP		1.02
+#define	HIST_BUCKETS		1000
+
+char *syntax[] = {
+"%s version " VERSION,
+"%s [-c nclients] [-d duration] [-w warmup] [-b] [-p] [-h] station_list",
+"    where:",
+"	-c nclients Number of client processes (default 1, maximum 99).",
+"	-d duration Seconds to measure (default 30).",
+"	-w warmup   Seconds to run before measuring (default 5).",
+"	-b	    Request blocking connections.  The clients are named BN01",
+"		    to BNnn, and must be listed as blocking clients in the",
+"		    station.ini of each station to be blocking.",
+"	-p	    Use cs_gen_parallel rather than cs_gen in the clients.",
+"	-h	    Print brief help message for syntax.",
+"	station_list",
+"		    Comma-delimited list of stations, or * for all stations",
+"		    in STATIONS_INI.",
+"Examples:",
+"	csbench -c 4 -d 60 B001,B002	4 clients of 2 stations for 1 minute.",
+" Notes",
+" 1.  Latencies are in milliseconds, CPU times per record in microseconds.",
+" 2.  A client that falls behind a non-blocking server loses records, so",
+"     the client rate may be lower than the server rate.",
+NULL };
+
+typedef struct _client_result {		/* Shared with the parent.	*/
+    pid_t pid;
+    int ready;				/* Attached to the servers.	*/
+    int done;				/* Results are complete.	*/
+    uint64_t records;			/* Records measured.		*/
+    uint64_t bytes;
+    double cpu;				/* CPU seconds while measuring.	*/
+    double max;				/* Largest latency, seconds.	*/
+    uint64_t hist[HIST_BUCKETS];
+} CLIENT_RESULT;
+
+typedef struct _bench_shared {		/* Anonymous shared mapping.	*/
+    double measure_start;		/* Set by the parent when all	*/
+    double measure_end;			/* clients are ready.		*/
+    CLIENT_RESULT client[MAX_BENCH_CLIENTS];
+} BENCH_SHARED;
+
+typedef struct _server_info {		/* One selected station.	*/
+    char name[SERVER_NAME_SIZE+1];
+    int segkey;
+    pid_t pid;
+    uint64_t packets[2];		/* Data packets queued at the	*/
+    double cpu[2];			/* start and end, and CPU used.	*/
+} SERVER_INFO;
+
+char *cmdname;				/* Name of this program.	*/
+FILE *info;				/* Output FILE for info.	*/
+volatile int terminate_proc;
+
+BENCH_SHARED *shared;
+SERVER_INFO servers[MAXSTATIONS];
+int nservers;
+int nclients = 1;
+int blocking = 0;
+int parallel = 0;
+
+int print_syntax (char *cmd, char *syntax[], FILE *fp);
+void finish_handler (int sig);
+int find_servers (char *list);
+int sample_servers (int which);
+void run_client (int index);
+void report (double duration);
+
+/************************************************************************
+ *  main procedure
+ ************************************************************************/
+int main (int argc, char **argv)
+{
+    double duration = 30.;
+    double warmup = 5.;
+    double start;
+    int i, status;
+
+    /* Variables needed for getopt. */
+    extern char	*optarg;
+    extern int	optind, opterr;
+    int		ch;
+
+    info = stdout;
+    setlinebuf(stdout);
+    cmdname = basename(strdup(argv[0]));
+    while ( (ch = getopt(argc,argv,"hc:d:w:bp")) != -1)
+	switch (ch) {
+	case '?':
+	case 'h':   ANNOUNCE(cmdname,info); print_syntax(cmdname,syntax,info); exit(1);
+	case 'c':   nclients = atoi(optarg); break;
+	case 'd':   duration = atof(optarg); break;
+	case 'w':   warmup = atof(optarg); break;
+	case 'b':   blocking = 1; break;
+	case 'p':   parallel = 1; break;
+	default:
+	    fprintf (info, "Unsupported option: -%c\n", ch);
+	    exit(1);
+	}
+
+    /*	Skip over all options and their arguments.			*/
+    argv = &(argv[optind]);
+    argc -= optind;
+
+    if (argc != 1) {
+	ANNOUNCE(cmdname,info);
+	print_syntax(cmdname,syntax,info);
+	exit(1);
+    }
+    if (nclients <= 0 || nclients > MAX_BENCH_CLIENTS || duration <= 0. || warmup < 0.) {
+	fprintf (info, "Invalid option value\n");
+	exit(1);
+    }
+    if (find_servers (argv[0]) != 0) exit(1);
+
+    shared = (BENCH_SHARED *)mmap (NULL, sizeof(BENCH_SHARED), PROT_READ|PROT_WRITE,
+				   MAP_SHARED|MAP_ANONYMOUS, -1, 0);
+    if (shared == MAP_FAILED) {
+	fprintf (info, "Unable to map shared results: %s\n", strerror(errno));
+	exit(1);
+    }
+    memset (shared, 0, sizeof(BENCH_SHARED));
+
+    signal (SIGINT, finish_handler);
+    signal (SIGTERM, finish_handler);
+
+    printf ("%s - %s version %s, %d clients of %d stations, warmup %.0f sec, duration %.0f sec\n",
+	    localtime_string(dtime()), cmdname, VERSION, nclients, nservers, warmup, duration);
+    for (i = 0; i < nclients; i++) {
+	pid_t pid = fork ();
+	if (pid < 0) {
+	    fprintf (info, "Unable to start client %d: %s\n", i+1, strerror(errno));
+	    terminate_proc = 1;
+	    break;
+	}
+	if (pid == 0) {
+	    run_client (i);
+	    _exit (0);
+	}
+	shared->client[i].pid = pid;
+    }
+
+    /* Wait for the clients to attach to the servers.			*/
+    start = dtime ();
+    while (! terminate_proc) {
+	for (i = 0; i < nclients && shared->client[i].ready; i++) ;
+	if (i >= nclients) break;
+	if (dtime () - start > 30.) {
+	    fprintf (info, "Clients did not attach to the servers\n");
+	    terminate_proc = 1;
+	    break;
+	}
+	usleep (10000);
+    }
+
+    if (! terminate_proc) {
+	shared->measure_start = dtime () + warmup;
+	shared->measure_end = shared->measure_start + duration;
+	while (! terminate_proc && dtime () < shared->measure_start) usleep (10000);
+	sample_servers (0);
+	while (! terminate_proc && dtime () < shared->measure_end) usleep (10000);
+	sample_servers (1);
+    }
+
+    /* The clients exit at the end of the measurement.			*/
+    for (i = 0; i < nclients; i++) {
+	if (shared->client[i].pid <= 0) continue;
+	if (terminate_proc) kill (shared->client[i].pid, SIGTERM);
+	waitpid (shared->client[i].pid, &status, 0);
+    }
+    if (! terminate_proc) report (duration);
+    return (terminate_proc ? 1 : 0);
+}
+
+/************************************************************************
+ *  print_syntax:
+ *	Print the syntax description of program.
+ ************************************************************************/
+int print_syntax (char	*cmd,		/* program name.			*/
+		  char	*syntax[],	/* syntax array.			*/
+		  FILE	*fp)		/* FILE ptr for output.			*/
+{
+    int i;
+    for (i=0; syntax[i] != NULL; i++) {
+	fprintf (fp, syntax[i], cmd);
+	fprintf (fp, "\n");
+    }
+    return (0);
+}
+
+/************************************************************************
+ *  finish_handler:
+ *	Signal handler to terminate the program.
+ ************************************************************************/
+void finish_handler (int sig)
+{
+    signal (sig, finish_handler);
+    terminate_proc = 1;
+}
+
+/************************************************************************
+ *  find_servers:
+ *	Find the segment keys of the stations in the comma-delimited
+ *	list, or of all stations if the list is *.
+ *  Return 0 on success, -1 if a station was not found.
+ ************************************************************************/
+int find_servers (char *list)
+{
+    tstations_struc stations;
+    char *p, *token;
+    int i;
+
+    cs_setup (&stations, (pchar)"BN00", (pchar)"*", TRUE, FALSE,
+	      1, 1, 0, 100);
+    if (strcmp (list, "*") == 0) {
+	for (i = 0; i < stations.station_count; i++) {
+	    strcpy (servers[nservers].name, (char *)sname_str_cs(stations.station_list[i].stationname));
+	    servers[nservers++].segkey = stations.station_list[i].segkey;
+	}
+    }
+    else {
+	for (p = list; (token = strtok(p, ",")) != NULL; p = NULL) {
+	    upshift(token);
+	    for (i = 0; i < stations.station_count; i++) {
+		if (strcasecmp ((char *)sname_str_cs(stations.station_list[i].stationname),
+				token) == 0) break;
+	    }
+	    if (i >= stations.station_count) {
+		fprintf (info, "Station %s not found in %s\n", token, get_stations_ini_pathname());
+		return (-1);
+	    }
+	    if (nservers >= MAXSTATIONS) break;
+	    strcpy (servers[nservers].name, token);
+	    servers[nservers++].segkey = stations.station_list[i].segkey;
+	}
+    }
+    if (nservers == 0) {
+	fprintf (info, "No stations in %s\n", get_stations_ini_pathname());
+	return (-1);
+    }
+    return (0);
+}
+
+/************************************************************************
+ *  process_cpu:
+ *	Return the user and system CPU seconds of a process, or -1.
+ ************************************************************************/
+double process_cpu (pid_t pid)
+{
+    char path[64], buf[1024], *p;
+    unsigned long utime, stime;
+    FILE *fp;
+    int n;
+
+    snprintf (path, sizeof(path), "/proc/%d/stat", (int)pid);
+    if ((fp = fopen (path, "r")) == NULL) return (-1.);
+    n = fread (buf, 1, sizeof(buf)-1, fp);
+    fclose (fp);
+    buf[(n > 0) ? n : 0] = '\0';
+    /* The command name may contain blanks, the fields follow the ")".	*/
+    if ((p = strrchr (buf, ')')) == NULL) return (-1.);
+    if (sscanf (p + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu",
+		&utime, &stime) != 2) return (-1.);
+    return ((double)(utime + stime) / sysconf(_SC_CLK_TCK));
+}
+
+/************************************************************************
+ *  sample_servers:
+ *	Save the data packets queued and the CPU time used by each server
+ *	at the start (which = 0) or end (which = 1) of the measurement.
+ *  Return the number of servers sampled.
+ ************************************************************************/
+int sample_servers (int which)
+{
+    cs_server_stats stats;
+    cs_stats_table *t;
+    pserver_struc base;
+    void *segment;
+    SERVER_INFO *s;
+    int i, n = 0;
+
+    for (i = 0; i < nservers; i++) {
+	s = &servers[i];
+	s->packets[which] = 0;
+	s->cpu[which] = -1.;
+	if (s->segkey == NOCLIENT) continue;
+	if ((t = cs_stats_attach (s->segkey, &segment)) == NULL) continue;
+	base = (pserver_struc)segment;
+	s->pid = base->server_pid;
+	cs_stats_read_server (t, &stats);
+	s->packets[which] = stats.packets[DATAQ];
+	s->cpu[which] = process_cpu (s->pid);
+	cs_stats_detach (segment);
+	++n;
+    }
+    return (n);
+}
+
+/************************************************************************
+ *  cpu_seconds:
+ *	Return the user and system CPU seconds of this process.
+ ************************************************************************/
+double cpu_seconds (void)
+{
+    struct rusage ru;
+
+    getrusage (RUSAGE_SELF, &ru);
+    return (ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1.0e6
+	    + ru.ru_stime.tv_sec + ru.ru_stime.tv_usec / 1.0e6);
+}
+
+/************************************************************************
+ *  run_client:
+ *	Body of client process index.  Read data from all servers until
+ *	the end of the measurement, and save the results of the records
+ *	received during the measurement.
+ ************************************************************************/
+void run_client (int index)
+{
+    CLIENT_RESULT *r = &shared->client[index];
+    tstations_struc stations;
+    pclient_struc me;
+    pclient_station this;
+    pdata_user pdat;
+    tclientname name;
+    boolean alert;
+    double now, latency, cpu_start = 0.;
+    int measuring = 0;
+    int i, j, k, b;
+
+    signal (SIGINT, finish_handler);
+    signal (SIGTERM, finish_handler);
+
+    memset (name, 0, sizeof(name));
+    snprintf ((char *)name, sizeof(name), "BN%02d", index + 1);
+    cs_setup (&stations, name, (pchar)"*", TRUE, blocking, DATABUFS, 1, CSIM_DATA, 100);
+    for (i = stations.station_count - 1; i >= 0; i--) {
+	for (j = 0; j < nservers; j++) {
+	    if (strcasecmp ((char *)sname_str_cs(stations.station_list[i].stationname),
+			    servers[j].name) == 0) break;
+	}
+	if (j >= nservers) cs_remove (&stations, i);
+    }
+    me = (parallel) ? cs_gen_parallel (&stations) : cs_gen (&stations);
+    r->ready = 1;
+
+    while (! terminate_proc) {
+	now = dtime ();
+	if (shared->measure_start > 0.) {
+	    if (! measuring && now >= shared->measure_start) {
+		measuring = 1;
+		cpu_start = cpu_seconds ();
+	    }
+	    if (now >= shared->measure_end) break;
+	}
+
+	j = cs_scan (me, &alert);
+	if (j == NOCLIENT) {
+	    cs_wait (me, 100000);
+	    continue;
+	}
+	this = (pclient_station)((uintptr_t)me + me->offsets[j]);
+	if (! measuring || this->valdbuf <= 0) continue;
+	pdat = (pdata_user)((uintptr_t)me + this->dbufoffset);
+	now = dtime ();
+	for (k = 0; k < this->valdbuf; k++) {
+	    latency = now - pdat->reception_time;
+	    if (latency < 0.) latency = 0.;
+	    if (latency > r->max) r->max = latency;
+	    b = (latency > HIST_BASE) ? (int)(log (latency / HIST_BASE) / log (HIST_STEP)) : 0;
+	    if (b >= HIST_BUCKETS) b = HIST_BUCKETS - 1;
+	    ++r->hist[b];
+	    ++r->records;
+	    r->bytes += this->dbufsize;
+	    pdat = (pdata_user)((uintptr_t)pdat + this->dbufsize);
+	}
+    }
+
+    if (measuring) r->cpu = cpu_seconds () - cpu_start;
+    r->done = 1;
+
+    /* Acknowledge the last records before detaching.			*/
+    for (i = 0; i < me->maxstation; i++) {
+	this = (pclient_station)((uintptr_t)me + me->offsets[i]);
+	this->reqdbuf = 0;
+    }
+    cs_scan (me, &alert);
+    cs_off (me);
+}
+
+/************************************************************************
+ *  hist_percentile:
+ *	Return percentile p in seconds of the latency histogram.
+ ************************************************************************/
+double hist_percentile (uint64_t *hist, uint64_t count, double max, double p)
+{
+    uint64_t target = (uint64_t)ceil (p / 100. * count);
+    uint64_t n = 0;
+    double upper;
+    int i;
+
+    if (target == 0) target = 1;
+    for (i = 0; i < HIST_BUCKETS; i++) {
+	n += hist[i];
+	if (n >= target) {
+	    upper = HIST_BASE * pow (HIST_STEP, i + 1);
+	    return ((upper < max) ? upper : max);
+	}
+    }
+    return (max);
+}
+
+/************************************************************************
+ *  report:
+ *	Print the results of the servers and the clients.
+ ************************************************************************/
+void report (double duration)
+{
+    static uint64_t hist[HIST_BUCKETS];
+    uint64_t packets = 0, records = 0;
+    double server_cpu = 0., client_cpu = 0., max = 0.;
+    SERVER_INFO *s;
+    CLIENT_RESULT *r;
+    int i, b;
+
+    printf ("\n%-8s %12s %10s %10s %12s\n", "server", "records", "rec/sec", "cpu sec", "usec/rec");
+    for (i = 0; i < nservers; i++) {
+	uint64_t n;
+	double cpu;
+	s = &servers[i];
+	if (s->cpu[0] < 0. || s->cpu[1] < 0.) {
+	    printf ("%-8s %12s\n", s->name, "not running");
+	    continue;
+	}
+	n = s->packets[1] - s->packets[0];
+	cpu = s->cpu[1] - s->cpu[0];
+	packets += n;
+	server_cpu += cpu;
+	printf ("%-8s %12llu %10.1f %10.2f %12.2f\n", s->name, (unsigned long long)n,
+		n / duration, cpu, (n > 0) ? cpu * 1.0e6 / n : 0.);
+    }
+    printf ("%-8s %12llu %10.1f %10.2f %12.2f\n", "total", (unsigned long long)packets,
+	    packets / duration, server_cpu, (packets > 0) ? server_cpu * 1.0e6 / packets : 0.);
+
+    printf ("\n%-8s %12s %10s %10s %12s\n", "client", "records", "rec/sec", "cpu sec", "usec/rec");
+    for (i = 0; i < nclients; i++) {
+	r = &shared->client[i];
+	if (! r->done) {
+	    printf ("BN%02d     %12s\n", i+1, "failed");
+	    continue;
+	}
+	records += r->records;
+	client_cpu += r->cpu;
+	if (r->max > max) max = r->max;
+	for (b = 0; b < HIST_BUCKETS; b++) hist[b] += r->hist[b];
+	printf ("BN%02d     %12llu %10.1f %10.2f %12.2f\n", i+1, (unsigned long long)r->records,
+		r->records / duration, r->cpu, (r->records > 0) ? r->cpu * 1.0e6 / r->records : 0.);
+    }
+    printf ("%-8s %12llu %10.1f %10.2f %12.2f\n", "total", (unsigned long long)records,
+	    records / duration, client_cpu, (records > 0) ? client_cpu * 1.0e6 / records : 0.);
+
+    printf ("\n%-16s %12s %10s %10s %10s %10s %10s\n",
+	    "latency (msec)", "count", "p50", "p90", "p99", "p99.9", "max");
+    if (records > 0) {
+	printf ("%-16s %12llu %10.3f %10.3f %10.3f %10.3f %10.3f\n", "server to client",
+		(unsigned long long)records,
+		hist_percentile (hist, records, max, 50.) * 1.0e3,
+		hist_percentile (hist, records, max, 90.) * 1.0e3,
+		hist_percentile (hist, records, max, 99.) * 1.0e3,
+		hist_percentile (hist, records, max, 99.9) * 1.0e3,
+		max * 1.0e3);
+    }
+}
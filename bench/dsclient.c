@@ -0,0 +1,362 @@
+/************************************************************************
+ *  dsclient - Read and check the low latency data of a lib660 dataserver.
+ *
+ *  dsclient opens a number of TCP connections to the dataserver port of
+ *  a q8serv (DATASERVERPORT), and reads the low latency records that the
+ *  dataserver sends to every client.  Each record is a tlowlat_call of
+ *  total_size bytes.  After a warmup period it reports for a fixed time
+ *  the records and samples per second of each connection, the latency
+ *  of the last sample of each record, and the gaps in each channel.
+ *
+ *  When the data logger is q660sim with -l, the samples are also
+ *  compared with the synthetic samples of q660sim.  The first record of
+ *  a channel gives the offset of its sample index from its timestamp,
+ *  which includes the filter delay of lib660, and every later record
+ *  must hold the samples at that index.
+ ************************************************************************/
+
+/* Modification History:
+------------------------------------------------------------------------
+    2026.292     ver 1.0.0	Initial version.
+*/
+
+#define	VERSION		"1.0.0 (2026.292)"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <errno.h>
+#include <unistd.h>
+#include <string.h>
+#include <signal.h>
+#include <libgen.h>
+#include <math.h>
+#include <poll.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#define	PROG_DL 1
+#include "libclient.h"
+#include "qdputil.h"
+
+#define	Q660_EPOCH	1451606400.	/* 2016-01-01 in seconds since 1970.	*/
+#define	FREQS		10		/* Q660 sample rates.			*/
+#define	MAX_CONN	64
+#define	CHANNELS	256		/* Source sub-channels of a station.	*/
+#define	LOCK_SEARCH	2000		/* Samples searched for the offset.	*/
+
+char *syntax[] = {
+"%s version " VERSION,
+"%s [-c nconn] [-d duration] [-w warmup] [-i host] [-n] [-h] port",
+"    where:",
+"	-c nconn    Number of connections to the dataserver (default 1,",
+"		    maximum 64).",
+"	-d duration Seconds to measure (default 30).",
+"	-w warmup   Seconds to run before measuring (default 5).",
+"	-i host	    IP address of the dataserver (default 127.0.0.1).",
+"	-n	    Do not compare the samples with those of q660sim.",
+"	-h	    Print brief help message for syntax.",
+"	port	    TCP port of the dataserver.",
+"Examples:",
+"	dsclient -c 4 -d 60 5340	4 connections for 1 minute.",
+" Notes",
+" 1.  Latencies are in milliseconds, from the time of the sample after",
+"     the last sample of a record, and are only meaningful when the data",
+"     logger runs in real time.",
+" 2.  A connection that falls a full dataserver ring behind loses its",
+"     oldest records, which are reported as gaps.",
+" 3.  The exit status is 1 if no records were received or any sample",
+"     did not match.",
+NULL };
+
+typedef struct _chan_state {		/* One channel of a connection.	*/
+    int locked;				/* Sample offset is known.	*/
+    int64_t delta;			/* Sample index - round(time * rate).	*/
+    int64_t next;			/* Index of the next sample.	*/
+} CHAN_STATE;
+
+typedef struct _conn {			/* One dataserver connection.	*/
+    int fd;
+    int len;				/* Bytes in buf.		*/
+    union {
+	tlowlat_call rec;
+	unsigned char buf[sizeof(tlowlat_call)];
+    } u;
+    CHAN_STATE chan[CHANNELS];
+    uint64_t records, samples;		/* Measured.			*/
+    uint64_t gaps, lost, mismatch;	/* Whole run.			*/
+    double lat_sum, lat_max;
+} CONN;
+
+char *cmdname;				/* Name of this program.	*/
+volatile int terminate_proc;
+
+CONN conns[MAX_CONN];
+int nconn = 1;
+int check = 1;
+double measure_start, measure_end;
+
+int print_syntax (char *cmd, char *syntax[], FILE *fp);
+void finish_handler (int sig);
+
+/************************************************************************
+ *  dtime:
+ *	Return the current time in seconds since 1970.
+ ************************************************************************/
+double dtime (void)
+{
+    struct timeval tv;
+    gettimeofday (&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1000000.;
+}
+
+/************************************************************************
+ *  matches:
+ *	Return 1 if the samples of a record are the q660sim samples of
+ *	its channel from sample index n on, else 0.
+ ************************************************************************/
+int matches (tlowlat_call *rec, int id, int64_t n)
+{
+    int i;
+
+    for (i = 0; i < rec->sample_count; i++) {
+	if (rec->samples[i] != qdp_sample (id, rec->rate, n + i)) return 0;
+    }
+    return 1;
+}
+
+/************************************************************************
+ *  process_record:
+ *	Check and count one record of a connection.
+ ************************************************************************/
+void process_record (CONN *c, double now)
+{
+    tlowlat_call *rec = &c->u.rec;
+    CHAN_STATE *cs = &c->chan[rec->src_subchan];
+    int id = (rec->src_subchan >> 4) * FREQS + (rec->src_subchan & 0xF);
+    int64_t t, n, d;
+    double lat;
+
+    if (rec->rate <= 0 || rec->sample_count == 0) return;
+    t = llround (rec->timestamp * rec->rate);
+    if (check) {
+	if (! cs->locked) {
+	    /* Find the sample index of the first record.		*/
+	    for (d = 0; d <= LOCK_SEARCH; d++) {
+		if (matches (rec, id, t + d)) { cs->delta = d; break; }
+		if (d > 0 && matches (rec, id, t - d)) { cs->delta = -d; break; }
+	    }
+	    if (d > LOCK_SEARCH) {
+		++c->mismatch;
+		return;
+	    }
+	    cs->locked = 1;
+	    cs->next = t + cs->delta;
+	}
+	n = t + cs->delta;
+	if (! matches (rec, id, n)) ++c->mismatch;
+    }
+    else {
+	n = t;
+	if (! cs->locked) cs->next = n;
+	cs->locked = 1;
+    }
+    if (n != cs->next) {
+	++c->gaps;
+	if (n > cs->next) c->lost += n - cs->next;
+    }
+    cs->next = n + rec->sample_count;
+
+    if (now < measure_start || now >= measure_end) return;
+    ++c->records;
+    c->samples += rec->sample_count;
+    lat = now - (Q660_EPOCH + rec->timestamp + (double)rec->sample_count / rec->rate);
+    c->lat_sum += lat;
+    if (lat > c->lat_max) c->lat_max = lat;
+}
+
+/************************************************************************
+ *  read_conn:
+ *	Read from a connection and process every complete record.
+ *	Return 0, or -1 when the connection is closed.
+ ************************************************************************/
+int read_conn (CONN *c, double now)
+{
+    int n;
+    uint32_t size;
+
+    n = read (c->fd, c->u.buf + c->len, sizeof(c->u.buf) - c->len);
+    if (n <= 0) {
+	if (n < 0 && (errno == EINTR || errno == EAGAIN)) return 0;
+	return -1;
+    }
+    c->len += n;
+    while (c->len >= (int)sizeof(uint32_t)) {
+	memcpy (&size, c->u.buf, sizeof(size));
+	if (size < offsetof(tlowlat_call, samples) || size > sizeof(tlowlat_call)) {
+	    fprintf (stderr, "Invalid record size %u\n", size);
+	    return -1;
+	}
+	if (c->len < (int)size) break;
+	if ((size - offsetof(tlowlat_call, samples)) / sizeof(I32) >= c->u.rec.sample_count)
+	    process_record (c, now);
+	else
+	    ++c->mismatch;
+	memmove (c->u.buf, c->u.buf + size, c->len - size);
+	c->len -= size;
+    }
+    return 0;
+}
+
+/************************************************************************
+ *  main procedure
+ ************************************************************************/
+int main (int argc, char **argv)
+{
+    char *host = "127.0.0.1";
+    double duration = 30.;
+    double warmup = 5.;
+    struct sockaddr_in addr;
+    struct pollfd fds[MAX_CONN];
+    uint64_t records = 0, samples = 0, gaps = 0, lost = 0, mismatch = 0;
+    double now, lat_sum = 0., lat_max = 0.;
+    int i, port, open_conns;
+
+    /* Variables needed for getopt. */
+    extern char	*optarg;
+    extern int	optind, opterr;
+    int		ch;
+
+    setlinebuf(stdout);
+    cmdname = basename(strdup(argv[0]));
+    while ( (ch = getopt(argc,argv,"hc:d:w:i:n")) != -1)
+	switch (ch) {
+	case '?':
+	case 'h':   print_syntax(cmdname,syntax,stdout); exit(1);
+	case 'c':   nconn = atoi(optarg); break;
+	case 'd':   duration = atof(optarg); break;
+	case 'w':   warmup = atof(optarg); break;
+	case 'i':   host = optarg; break;
+	case 'n':   check = 0; break;
+	default:
+	    fprintf (stderr, "Unsupported option: -%c\n", ch);
+	    exit(1);
+	}
+
+    /*	Skip over all options and their arguments.			*/
+    argv = &(argv[optind]);
+    argc -= optind;
+
+    if (argc != 1) {
+	print_syntax(cmdname,syntax,stdout);
+	exit(1);
+    }
+    port = atoi(argv[0]);
+    if (nconn <= 0 || nconn > MAX_CONN || duration <= 0. || warmup < 0.
+	|| port <= 0 || port > 65535) {
+	fprintf (stderr, "Invalid option value\n");
+	exit(1);
+    }
+    memset (&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (inet_pton (AF_INET, host, &addr.sin_addr) != 1) {
+	fprintf (stderr, "Invalid dataserver address: %s\n", host);
+	exit(1);
+    }
+
+    signal (SIGINT, finish_handler);
+    signal (SIGTERM, finish_handler);
+    signal (SIGPIPE, SIG_IGN);
+
+    for (i = 0; i < nconn; i++) {
+	if ((conns[i].fd = socket (AF_INET, SOCK_STREAM, 0)) < 0
+	    || connect (conns[i].fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+	    fprintf (stderr, "Unable to connect to %s:%d: %s\n", host, port, strerror(errno));
+	    exit(1);
+	}
+    }
+    now = dtime ();
+    measure_start = now + warmup;
+    measure_end = measure_start + duration;
+    printf ("%s version %s, %d connections to %s:%d, warmup %.0f sec, duration %.0f sec\n",
+	    cmdname, VERSION, nconn, host, port, warmup, duration);
+
+    open_conns = nconn;
+    while (! terminate_proc && open_conns > 0 && (now = dtime ()) < measure_end) {
+	for (i = 0; i < nconn; i++) {
+	    fds[i].fd = conns[i].fd;
+	    fds[i].events = POLLIN;
+	    fds[i].revents = 0;
+	}
+	if (poll (fds, nconn, 100) < 0) {
+	    if (errno == EINTR) continue;
+	    fprintf (stderr, "Error in poll: %s\n", strerror(errno));
+	    exit(1);
+	}
+	now = dtime ();
+	for (i = 0; i < nconn; i++) {
+	    if (fds[i].revents == 0) continue;
+	    if (read_conn (&conns[i], now) < 0) {
+		fprintf (stderr, "Connection %d closed by the dataserver\n", i+1);
+		close (conns[i].fd);
+		conns[i].fd = -1;
+		--open_conns;
+	    }
+	}
+    }
+    if (terminate_proc) return 1;
+
+    printf ("conn  records/s  samples/s  lat_mean  lat_max  gaps  lost_samples  mismatches\n");
+    for (i = 0; i < nconn; i++) {
+	CONN *c = &conns[i];
+	printf ("%4d %10.1f %10.1f %9.1f %8.1f %5llu %13llu %11llu\n", i+1,
+		c->records / duration, c->samples / duration,
+		c->records ? 1000. * c->lat_sum / c->records : 0., 1000. * c->lat_max,
+		(unsigned long long)c->gaps, (unsigned long long)c->lost,
+		(unsigned long long)c->mismatch);
+	records += c->records;
+	samples += c->samples;
+	gaps += c->gaps;
+	lost += c->lost;
+	mismatch += c->mismatch;
+	lat_sum += c->lat_sum;
+	if (c->lat_max > lat_max) lat_max = c->lat_max;
+    }
+    printf (" all %10.1f %10.1f %9.1f %8.1f %5llu %13llu %11llu\n",
+	    records / duration, samples / duration,
+	    records ? 1000. * lat_sum / records : 0., 1000. * lat_max,
+	    (unsigned long long)gaps, (unsigned long long)lost,
+	    (unsigned long long)mismatch);
+    return (records == 0 || mismatch > 0) ? 1 : 0;
+}
+
+/************************************************************************
+ *  print_syntax:
+ *	Print the syntax description of program.
+ ************************************************************************/
+int print_syntax (char	*cmd,		/* program name.			*/
+		  char	*syntax[],	/* syntax array.			*/
+		  FILE	*fp)		/* FILE ptr for output.			*/
+{
+    int i;
+    for (i=0; syntax[i] != NULL; i++) {
+	fprintf (fp, syntax[i], cmd);
+	fprintf (fp, "\n");
+    }
+    return (0);
+}
+
+/************************************************************************
+ *  finish_handler:
+ *	Signal handler to terminate the program.
+ ************************************************************************/
+void finish_handler (int sig)
+{
+    signal (sig, finish_handler);
+    terminate_proc = 1;
+}
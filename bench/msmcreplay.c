@@ -0,0 +1,327 @@
+/************************************************************************
+ *  msmcreplay - Multicast MiniSEED records for mserv servers.
+ *
+ *  msmcreplay sends MiniSEED records, one 512 byte record per UDP
+ *  datagram, to a multicast group in the form that mserv reads.  The
+ *  records of the n'th station in the station list are sent to port+n,
+ *  so that one mserv server per station can each join the group on its
+ *  own port.  The records are either read from MiniSEED files and
+ *  replayed for each station at a fixed rate, or generated for a number
+ *  of synthetic channels of each station at their sample rate, in real
+ *  time or faster.
+ ************************************************************************/
+
+/* Modification History:
+------------------------------------------------------------------------
+    2026.292     ver 1.0.0	Initial version.
+*/
+
+#define	VERSION		"1.0.0 (2026.292)"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include <unistd.h>
+#include <string.h>
+#include <signal.h>
+#include <libgen.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "cslimits.h"
+#include "cstypes.h"
+#include "stuff.h"
+#include "timeutil.h"
+#include "benchutil.h"
+
+#define	DEFAULT_NCHAN	12
+#define	DEFAULT_RATE	100.
+#define	STATUS_INTERVAL	10		/* Seconds between status messages.	*/
+#define	MAX_BATCH	1000		/* Records sent between time checks.	*/
+
+char *syntax[] = {
+"%s version " VERSION,
+"%s [-i ifaddr] [-t ttl] [-g nchan] [-s rate] [-x speed] [-r recs_per_sec] [-l loops] [-h]",
+"    group port station_list [file ...]",
+"    where:",
+"	-i ifaddr   Send on the interface with this address (default 127.0.0.1).",
+"	-t ttl	    Multicast time to live (default 0, this host only).",
+"	-g nchan    Number of synthetic channels per station (default 12).",
+"	-s rate	    Sample rate of the synthetic channels (default 100).",
+"	-x speed    Generate synthetic data speed times faster than real time.",
+"	-r recs_per_sec",
+"		    Rate at which file records are sent for each station",
+"		    (default 0, as fast as possible).",
+"	-l loops    Replay the files loops times (default 1, 0 forever).",
+"	-h	    Print brief help message for syntax.",
+"	group port  Multicast group and port of the first station.",
+"	station_list",
+"		    Comma-delimited list of NET.STA codes.",
+"	file	    MiniSEED files of 512 byte records, sent for every station",
+"		    with its codes.  Without files, synthetic Steim1 records",
+"		    are generated.",
+"Examples:",
+"	msmcreplay 239.255.73.1 17000 XX.B001,XX.B002",
+"			send 12 channels of 100 sps data for 2 stations.",
+NULL };
+
+typedef struct _mc_station {		/* One station of the list.	*/
+    char network[3];
+    char station[6];
+    struct sockaddr_in addr;		/* Group and port.		*/
+    SYNTH_CHAN *chans;			/* Synthetic channels.		*/
+} MC_STATION;
+
+char *cmdname;				/* Name of this program.	*/
+int terminate_proc;
+
+MC_STATION *stations;
+int nstations;
+int nchan = DEFAULT_NCHAN;
+double speed = 1.;
+double start_time;
+
+char *records;				/* File records.		*/
+int nrecords;
+
+int print_syntax (char *cmd, char *syntax[], FILE *fp);
+void finish_handler (int sig);
+
+/************************************************************************
+ *  next_chan:
+ *	Return the synthetic channel of any station whose next record
+ *	ends first, and set *ps to its station.
+ ************************************************************************/
+SYNTH_CHAN *next_chan (MC_STATION **ps)
+{
+    SYNTH_CHAN *c = &stations[0].chans[0];
+    int i, j;
+
+    *ps = &stations[0];
+    for (i = 0; i < nstations; i++) {
+	for (j = 0; j < nchan; j++) {
+	    if (stations[i].chans[j].start < c->start) {
+		c = &stations[i].chans[j];
+		*ps = &stations[i];
+	    }
+	}
+    }
+    return (c);
+}
+
+/************************************************************************
+ *  main procedure
+ ************************************************************************/
+int main (int argc, char **argv)
+{
+    char *ifaddr = "127.0.0.1";
+    int ttl = 0;
+    double rate = DEFAULT_RATE;
+    double recs_per_sec = 0.;
+    int loops = 1;
+    struct in_addr group, iface;
+    unsigned char mttl, loop = 1;
+    int port, fd;
+    char rec[BENCH_RECSIZE];
+    MC_STATION *s;
+    long next = 0;			/* Next file record of all stations. */
+    double now, due = 0., next_status;
+    uint64_t sent = 0, last_sent = 0, errors = 0;
+    char *p, *token, *dot;
+    int i, j, n;
+
+    /* Variables needed for getopt. */
+    extern char	*optarg;
+    extern int	optind, opterr;
+    int		ch;
+
+    setlinebuf(stdout);
+    cmdname = basename(strdup(argv[0]));
+    while ( (ch = getopt(argc,argv,"hi:t:g:s:x:r:l:")) != -1)
+	switch (ch) {
+	case '?':
+	case 'h':   print_syntax(cmdname,syntax,stdout); exit(1);
+	case 'i':   ifaddr = optarg; break;
+	case 't':   ttl = atoi(optarg); break;
+	case 'g':   nchan = atoi(optarg); break;
+	case 's':   rate = atof(optarg); break;
+	case 'x':   speed = atof(optarg); break;
+	case 'r':   recs_per_sec = atof(optarg); break;
+	case 'l':   loops = atoi(optarg); break;
+	default:
+	    fprintf (stderr, "Unsupported option: -%c\n", ch);
+	    exit(1);
+	}
+
+    /*	Skip over all options and their arguments.			*/
+    argv = &(argv[optind]);
+    argc -= optind;
+
+    if (argc < 3) {
+	print_syntax(cmdname,syntax,stdout);
+	exit(1);
+    }
+    if (nchan <= 0 || rate <= 0. || speed <= 0. || recs_per_sec < 0. || ttl < 0 || ttl > 255) {
+	fprintf (stderr, "Invalid option value\n");
+	exit(1);
+    }
+    if (inet_pton (AF_INET, argv[0], &group) != 1 || ! IN_MULTICAST(ntohl(group.s_addr))) {
+	fprintf (stderr, "Invalid multicast group: %s\n", argv[0]);
+	exit(1);
+    }
+    if ((port = atoi(argv[1])) <= 0 || port > 65535) {
+	fprintf (stderr, "Invalid port: %s\n", argv[1]);
+	exit(1);
+    }
+    if (inet_pton (AF_INET, ifaddr, &iface) != 1) {
+	fprintf (stderr, "Invalid interface address: %s\n", ifaddr);
+	exit(1);
+    }
+
+    for (p = argv[2]; (token = strtok(p, ",")) != NULL; p = NULL) {
+	stations = (MC_STATION *)realloc (stations, (nstations+1) * sizeof(MC_STATION));
+	s = &stations[nstations];
+	memset (s, 0, sizeof(MC_STATION));
+	upshift(token);
+	if ((dot = strchr (token, '.')) == NULL || dot - token > 2 || strlen(dot+1) > 5) {
+	    fprintf (stderr, "Invalid NET.STA: %s\n", token);
+	    exit(1);
+	}
+	strncpy (s->network, token, dot - token);
+	strcpy (s->station, dot + 1);
+	s->addr.sin_family = AF_INET;
+	s->addr.sin_addr = group;
+	s->addr.sin_port = htons(port + nstations);
+	if (port + nstations > 65535) {
+	    fprintf (stderr, "Too many stations for port %d\n", port);
+	    exit(1);
+	}
+	++nstations;
+    }
+
+    for (i = 3; i < argc; i++) {
+	if (ms_load (argv[i], &records, &nrecords) != 0) exit(1);
+    }
+    if (argc > 3 && nrecords == 0) {
+	fprintf (stderr, "No records to replay\n");
+	exit(1);
+    }
+
+    if ((fd = socket (AF_INET, SOCK_DGRAM, 0)) < 0) {
+	fprintf (stderr, "Unable to create socket: %s\n", strerror(errno));
+	exit(1);
+    }
+    mttl = ttl;
+    if (setsockopt (fd, IPPROTO_IP, IP_MULTICAST_IF, &iface, sizeof(iface)) < 0
+	|| setsockopt (fd, IPPROTO_IP, IP_MULTICAST_TTL, &mttl, sizeof(mttl)) < 0
+	|| setsockopt (fd, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop)) < 0) {
+	fprintf (stderr, "Unable to set multicast options: %s\n", strerror(errno));
+	exit(1);
+    }
+
+    signal (SIGHUP, finish_handler);
+    signal (SIGINT, finish_handler);
+    signal (SIGQUIT, finish_handler);
+    signal (SIGTERM, finish_handler);
+
+    start_time = dtime ();
+    if (nrecords == 0) {
+	for (i = 0; i < nstations; i++) {
+	    s = &stations[i];
+	    if ((s->chans = (SYNTH_CHAN *)calloc (nchan, sizeof(SYNTH_CHAN))) == NULL) {
+		fprintf (stderr, "Unable to allocate %d channels\n", nchan);
+		exit(1);
+	    }
+	    /* Spread the records of all channels over one record length. */
+	    for (j = 0; j < nchan; j++) {
+		synth_init (&s->chans[j], s->network, s->station, j, rate, 0.);
+		s->chans[j].start = start_time - synth_record_seconds (&s->chans[j])
+		    * (nchan * nstations - (j * nstations + i)) / (nchan * nstations);
+	    }
+	}
+	printf ("%s - %s version %s sending %d stations of %d channels at %.3f sps to %s:%d+, %.1f records/sec\n",
+		localtime_string(start_time), cmdname, VERSION, nstations, nchan, rate,
+		argv[0], port, nstations * nchan * speed / synth_record_seconds (&stations[0].chans[0]));
+    }
+    else {
+	printf ("%s - %s version %s sending %d records %d times for %d stations to %s:%d+\n",
+		localtime_string(start_time), cmdname, VERSION, nrecords, loops, nstations,
+		argv[0], port);
+    }
+
+    next_status = start_time + STATUS_INTERVAL;
+    while (! terminate_proc) {
+	now = dtime ();
+	for (n = 0; n < MAX_BATCH; n++) {
+	    if (nrecords > 0) {
+		if (loops > 0 && next >= (long)nrecords * loops * nstations) {
+		    terminate_proc = 1;
+		    break;
+		}
+		if (recs_per_sec > 0.
+		    && (due = start_time + (next / nstations) / recs_per_sec) > now) break;
+		s = &stations[next % nstations];
+		memcpy (rec, records + ((next / nstations) % nrecords) * BENCH_RECSIZE, BENCH_RECSIZE);
+		ms_set_station (rec, s->network, s->station);
+		++next;
+	    }
+	    else {
+		SYNTH_CHAN *c = next_chan (&s);
+		due = start_time + (c->start + synth_record_seconds (c) - start_time) / speed;
+		if (due > now) break;
+		synth_record (c, rec);
+	    }
+	    if (sendto (fd, rec, BENCH_RECSIZE, 0, (struct sockaddr *)&s->addr,
+			sizeof(s->addr)) == BENCH_RECSIZE)
+		++sent;
+	    else
+		++errors;
+	}
+
+	if (now >= next_status) {
+	    printf ("%s - sent %llu records, %.1f records/sec, %llu send errors\n",
+		    localtime_string(now), (unsigned long long)sent,
+		    (sent - last_sent) / (now - next_status + STATUS_INTERVAL),
+		    (unsigned long long)errors);
+	    last_sent = sent;
+	    next_status = now + STATUS_INTERVAL;
+	}
+
+	if (n >= MAX_BATCH || terminate_proc) continue;
+	bench_sleep_until ((due < next_status) ? due : next_status);
+    }
+
+    printf ("%s - %s terminated, sent %llu records\n", localtime_string(dtime()), cmdname,
+	    (unsigned long long)sent);
+    close (fd);
+    return (0);
+}
+
+/************************************************************************
+ *  print_syntax:
+ *	Print the syntax description of program.
+ ************************************************************************/
+int print_syntax (char	*cmd,		/* program name.			*/
+		  char	*syntax[],	/* syntax array.			*/
+		  FILE	*fp)		/* FILE ptr for output.			*/
+{
+    int i;
+    for (i=0; syntax[i] != NULL; i++) {
+	fprintf (fp, syntax[i], cmd);
+	fprintf (fp, "\n");
+    }
+    return (0);
+}
+
+/************************************************************************
+ *  finish_handler:
+ *	Signal handler to terminate the program.
+ ************************************************************************/
+void finish_handler (int sig)
+{
+    signal (sig, finish_handler);
+    terminate_proc = 1;
+}
@@ -0,0 +1,326 @@
+/************************************************************************
+ *  msreplay - comserv server that replays MiniSEED records.
+ *
+ *  msreplay runs as the server of a station in STATIONS_INI, in place of
+ *  q330serv, q8serv or mserv, and queues MiniSEED records into its
+ *  comserv rings with comserv_queue_rt, so that clients and the comserv
+ *  subsystem can be run under a known load without a data logger.
+ *
+ *  The records are either read from MiniSEED files and replayed at a
+ *  fixed rate, or generated for a number of synthetic channels of the
+ *  station at their sample rate, in real time or faster.
+ ************************************************************************/
+
+/* Modification History:
+------------------------------------------------------------------------
+    2026.292     ver 1.0.0	Initial version.
+*/
+
+#define	VERSION		"1.0.0 (2026.292)"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include <unistd.h>
+#include <string.h>
+#include <signal.h>
+#include <libgen.h>
+#include <sys/types.h>
+
+#include "cslimits.h"
+#include "cstypes.h"
+#include "dpstruc.h"
+#include "quanstrc.h"
+#include "service.h"
+#include "stuff.h"
+#include "logging.h"
+#include "csconfig.h"
+#include "comserv_calls.h"
+#include "comserv_queue.h"
+#include "benchutil.h"
+
+#define	DEFAULT_NCHAN	12
+#define	DEFAULT_RATE	100.
+#define	STATUS_INTERVAL	10		/* Seconds between status messages.	*/
+#define	MAX_BATCH	1000		/* Records queued between client scans.	*/
+
+char *syntax[] = {
+"%s version " VERSION,
+"%s [-g nchan] [-s rate] [-x speed] [-r recs_per_sec] [-l loops] [-R] [-h] station [file ...]",
+"    where:",
+"	-g nchan    Number of synthetic channels (default 12).",
+"	-s rate	    Sample rate of the synthetic channels (default 100).",
+"	-x speed    Generate synthetic data speed times faster than real time.",
+"	-r recs_per_sec",
+"		    Rate at which file records are queued (default 0, as fast",
+"		    as the comserv rings accept them).",
+"	-l loops    Replay the files loops times (default 1, 0 forever).",
+"	-R	    Set the station and network of file records to those of",
+"		    the station in STATIONS_INI.",
+"	-h	    Print brief help message for syntax.",
+"	station	    Station in STATIONS_INI to serve.",
+"	file	    MiniSEED files of 512 byte records.  Without files,",
+"		    synthetic Steim1 records are generated.",
+"Examples:",
+"	msreplay -g 24 -s 200 B001	serve 24 channels of 200 sps data.",
+"	msreplay -r 5000 -l 0 -R B001 day.mseed",
+"					replay day.mseed at 5000 records/sec.",
+NULL };
+
+char *cmdname;				/* Name of this program.	*/
+int terminate_proc;
+
+SYNTH_CHAN *chans;			/* Synthetic channels.		*/
+int nchan = DEFAULT_NCHAN;
+double speed = 1.;
+double replay_start;			/* Real and data time at start.	*/
+
+char *records;				/* File records.		*/
+int nrecords;
+
+int print_syntax (char *cmd, char *syntax[], FILE *fp);
+void finish_handler (int sig);
+void define_comserv_vars (void);
+
+/************************************************************************
+ *  real_time:
+ *	Convert synthetic data time to real time.
+ ************************************************************************/
+double real_time (double t)
+{
+    return replay_start + (t - replay_start) / speed;
+}
+
+/************************************************************************
+ *  next_chan:
+ *	Return the synthetic channel whose next record ends first.
+ ************************************************************************/
+SYNTH_CHAN *next_chan (void)
+{
+    SYNTH_CHAN *c = &chans[0];
+    int i;
+
+    for (i = 1; i < nchan; i++)
+	if (chans[i].start < c->start) c = &chans[i];
+    return (c);
+}
+
+/************************************************************************
+ *  main procedure
+ ************************************************************************/
+int main (int argc, char **argv)
+{
+    double rate = DEFAULT_RATE;
+    double recs_per_sec = 0.;
+    int loops = 1;
+    int restation = 0;
+    char server_name[CSMAXFILELEN];
+    csconfig cs_cfg;
+    struct sigaction action;
+    char rec[BENCH_RECSIZE];
+    char *prec;
+    int have_rec = 0;
+    int suspended = 0;
+    long next = 0;			/* Next file record.		*/
+    double now, due, next_scan, next_status;
+    uint64_t queued = 0, last_queued = 0;
+    uint32_t blocked = 0;
+    double scan_interval;
+    int i, n, rc;
+
+    /* Variables needed for getopt. */
+    extern char	*optarg;
+    extern int	optind, opterr;
+    int		ch;
+
+    setlinebuf(stdout);
+    define_comserv_vars();
+    cmdname = basename(strdup(argv[0]));
+    while ( (ch = getopt(argc,argv,"hg:s:x:r:l:R")) != -1)
+	switch (ch) {
+	case '?':
+	case 'h':   print_syntax(cmdname,syntax,stdout); exit(1);
+	case 'g':   nchan = atoi(optarg); break;
+	case 's':   rate = atof(optarg); break;
+	case 'x':   speed = atof(optarg); break;
+	case 'r':   recs_per_sec = atof(optarg); break;
+	case 'l':   loops = atoi(optarg); break;
+	case 'R':   restation = 1; break;
+	default:
+	    fprintf (stderr, "Unsupported option: -%c\n", ch);
+	    exit(1);
+	}
+
+    /*	Skip over all options and their arguments.			*/
+    argv = &(argv[optind]);
+    argc -= optind;
+
+    if (argc < 1) {
+	print_syntax(cmdname,syntax,stdout);
+	exit(1);
+    }
+    if (nchan <= 0 || rate <= 0. || speed <= 0. || recs_per_sec < 0.) {
+	fprintf (stderr, "Invalid option value\n");
+	exit(1);
+    }
+    strncpy (server_name, argv[0], sizeof(server_name)-1);
+    server_name[sizeof(server_name)-1] = '\0';
+    upshift(server_name);
+
+    for (i = 1; i < argc; i++) {
+	if (ms_load (argv[i], &records, &nrecords) != 0) exit(1);
+    }
+    if (argc > 1 && nrecords == 0) {
+	fprintf (stderr, "No records to replay\n");
+	exit(1);
+    }
+
+    initialize_csconfig(&cs_cfg);
+    if (getAllCSServerParams (&cs_cfg, server_name) != 0) {
+	fprintf (stderr, "Error: server exiting due to comserv subsystem configuration errors\n");
+	exit(12);
+    }
+    if (LogInit (CS_LOG_MODE_TO_STDOUT, ".", server_name, 2048) != 0) {
+	fprintf (stderr, "Error: LogInit() problems - exiting\n");
+	exit(12);
+    }
+
+    /* Client will send a SIGALRM signal when it puts its segment ID	*/
+    /* into the service queue.  Make sure we don't die on it.		*/
+    action.sa_handler = cs_sig_alrm;
+    action.sa_flags = 0;
+    sigemptyset (&(action.sa_mask));
+    sigaction (SIGALRM, &action, NULL);
+    signal (SIGPIPE, SIG_IGN);
+    signal (SIGHUP, finish_handler);
+    signal (SIGINT, finish_handler);
+    signal (SIGQUIT, finish_handler);
+    signal (SIGTERM, finish_handler);
+
+    LogMessage (CS_LOG_TYPE_INFO, "%s version %s starting for %s", cmdname, VERSION, server_name);
+    comserv_init (&cs_cfg, server_name);
+    comserv_stats_link (1, -1, 0., 0, 0);
+
+    replay_start = dtime ();
+    if (nrecords > 0) {
+	LogMessage (CS_LOG_TYPE_INFO, "Replaying %d records %d times at %s", nrecords, loops,
+		    (recs_per_sec > 0.) ? "a fixed rate" : "the rate the rings accept");
+    }
+    else {
+	if ((chans = (SYNTH_CHAN *)calloc (nchan, sizeof(SYNTH_CHAN))) == NULL) {
+	    LogMessage (CS_LOG_TYPE_ERROR, "Unable to allocate %d channels", nchan);
+	    exit(12);
+	}
+	/* Spread the records of the channels over one record length.	*/
+	for (i = 0; i < nchan; i++) {
+	    synth_init (&chans[i], cs_cfg.seed_network, cs_cfg.seed_station, i, rate, 0.);
+	    chans[i].start = replay_start - synth_record_seconds (&chans[i]) * (nchan - i) / nchan;
+	}
+	LogMessage (CS_LOG_TYPE_INFO, "Generating %d channels at %.3f sps, %.1f records/sec",
+		    nchan, rate, nchan * speed / synth_record_seconds (&chans[0]));
+    }
+
+    scan_interval = (cs_cfg.pollusecs > 0) ? cs_cfg.pollusecs / 1.0e6 : 0.1;
+    next_scan = next_status = replay_start;
+    next_status += STATUS_INTERVAL;
+    while (! terminate_proc) {
+	now = dtime ();
+
+	/* Queue the records that are due, until a ring is full.	*/
+	due = next_scan;
+	for (n = 0; n < MAX_BATCH && ! suspended; n++) {
+	    if (! have_rec) {
+		if (nrecords > 0) {
+		    if (loops > 0 && next >= (long)nrecords * loops) {
+			LogMessage (CS_LOG_TYPE_INFO, "Replay finished, %llu records queued",
+				    (unsigned long long)queued);
+			terminate_proc = 1;
+			break;
+		    }
+		    if (recs_per_sec > 0. && (due = replay_start + next / recs_per_sec) > now) break;
+		    prec = records + (next % nrecords) * BENCH_RECSIZE;
+		    memcpy (rec, prec, BENCH_RECSIZE);
+		    if (restation) ms_set_station (rec, cs_cfg.seed_network, cs_cfg.seed_station);
+		    ++next;
+		}
+		else {
+		    SYNTH_CHAN *c = next_chan ();
+		    if ((due = real_time (c->start + synth_record_seconds (c))) > now) break;
+		    synth_record (c, rec);
+		}
+		have_rec = 1;
+	    }
+	    rc = comserv_queue_rt (rec, BENCH_RECSIZE, RECORD_HEADER_1, dtime ());
+	    if (rc == 1) {
+		/* Ring blocked by a blocking client, retry after a scan. */
+		++blocked;
+		due = next_scan;
+		break;
+	    }
+	    have_rec = 0;
+	    if (rc == 0) ++queued;
+	}
+
+	/* Service the clients.						*/
+	if (now >= next_scan || n >= MAX_BATCH) {
+	    next_scan = now + scan_interval;
+	    switch (comserv_scan ()) {
+	    case CSCM_TERMINATE:
+		LogMessage (CS_LOG_TYPE_INFO, "Terminating server (Requested)");
+		terminate_proc = 1;
+		break;
+	    case CSCM_SUSPEND:
+		LogMessage (CS_LOG_TYPE_INFO, "Suspending replay (Requested)");
+		suspended = 1;
+		comserv_stats_link (0, -1, 0., 0, 0);
+		break;
+	    case CSCM_RESUME:
+		LogMessage (CS_LOG_TYPE_INFO, "Resuming replay (Requested)");
+		suspended = 0;
+		comserv_stats_link (1, -1, 0., 0, 0);
+		break;
+	    }
+	}
+
+	if (now >= next_status) {
+	    LogMessage (CS_LOG_TYPE_INFO, "Queued %llu records, %.1f records/sec, rings full %u times",
+			(unsigned long long)queued,
+			(queued - last_queued) / (now - next_status + STATUS_INTERVAL), blocked);
+	    last_queued = queued;
+	    next_status = now + STATUS_INTERVAL;
+	}
+
+	if (n >= MAX_BATCH) continue;
+	bench_sleep_until ((due < next_scan) ? due : next_scan);
+    }
+
+    LogMessage (CS_LOG_TYPE_INFO, "%s terminated", cmdname);
+    return (0);
+}
+
+/************************************************************************
+ *  print_syntax:
+ *	Print the syntax description of program.
+ ************************************************************************/
+int print_syntax (char	*cmd,		/* program name.			*/
+		  char	*syntax[],	/* syntax array.			*/
+		  FILE	*fp)		/* FILE ptr for output.			*/
+{
+    int i;
+    for (i=0; syntax[i] != NULL; i++) {
+	fprintf (fp, syntax[i], cmd);
+	fprintf (fp, "\n");
+    }
+    return (0);
+}
+
+/************************************************************************
+ *  finish_handler:
+ *	Signal handler to terminate the program.
+ ************************************************************************/
+void finish_handler (int sig)
+{
+    signal (sig, finish_handler);
+    terminate_proc = 1;
+}
@@ -0,0 +1,441 @@
+/************************************************************************
+ *  q330iotest - Differential test of the lib330 base-96 decoding.
+ *
+ *  q330iotest feeds QDP frames to the decode() routine of lib330/q330io.c,
+ *  which decodes a base-96 packet and checks its CRC in one pass, with
+ *  the scalar and, if the CPU supports it, the SSSE3 group decoding.
+ *  Every result is compared with a reference decoder that decodes the
+ *  whole packet first and then computes the CRC one byte at a time,
+ *  as lib330 did before: the return value must be the same, and for a
+ *  good packet the decoded bytes and the header must be the same too.
+ *
+ *  The frames are a set of golden frames with known results, frames
+ *  read from capture files, and random QDP packets that are encoded
+ *  with a random mask and then left intact, corrupted, truncated,
+ *  extended, given a bad length or a bad mask, or replaced by garbage.
+ *  The random frames can be written to a capture file to be replayed
+ *  later.
+ *
+ *  q330io.c is included rather than linked, to reach its static
+ *  routines, so it is compiled with the lib330 flags.
+ ************************************************************************/
+
+/* Modification History:
+------------------------------------------------------------------------
+    2026.292     ver 1.0.0	Initial version.
+*/
+
+#define	VERSION		"1.0.0 (2026.292)"
+
+#include "../lib330/q330io.c"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <libgen.h>
+
+#include "qdputil.h"
+
+#define	FRAME_MAX	(QDP_HDR_LTH + MAXDATA96)	/* As read by lib330.	*/
+#define	DATA_MAX	((FRAME_MAX - 2) / 4 * 3 - QDP_HDR_LTH)
+#define	DEFAULT_COUNT	100000
+#define	NKINDS		7
+
+char *syntax[] = {
+"%s version " VERSION,
+"%s [-n count] [-r seed] [-o capture] [-h] [capture ...]",
+"    where:",
+"	-n count    Number of random frames (default 100000).",
+"	-r seed	    Seed of the random frames (default 1).",
+"	-o capture  Write the random frames to this capture file.",
+"	-h	    Print brief help message for syntax.",
+"	capture	    Capture files of frames to test as well.",
+"Notes:",
+"1.  A capture file holds the UDP payloads of QDP data packets, each",
+"    preceded by its length as 2 bytes in network byte order.",
+"2.  The exit status is 0 only if every frame decoded the same way",
+"    as the reference.",
+NULL };
+
+/* Frame kinds of the random frames.					*/
+static const char *KIND_NAMES[NKINDS] = {
+    "intact", "bit flip", "truncated", "extended",
+    "bad length", "bad mask", "garbage"
+};
+
+/* Golden frames, with the length decode() returns for them (-1 when
+   the frame is not valid) and the CRC of the header.			*/
+static const struct {
+    const char *frame;
+    int actual;
+    uint32_t crc;
+} GOLDEN[] = {
+    /* C1_PING, no data */
+    { "5AQ\\%(BB8E:::5;::5", 12, 0x6BE65FF8 },
+    /* DT_DATA, 37 bytes and 2 pad bytes */
+    { "C3Z):Y;#!_#F'_1##/#$-_6?@_IR[_\\%.Z78AJJSTJ]&/E09B5KLU5^'(01:C DM"
+      "V _2A/", 49, 0x394A9918 },
+    /* the same with a bit flipped */
+    { "C3Z):Y;#!_#F'_1##/#$-_6?@_IR[_]%.Z78AJJSTJ]&/E09B5KLU5^'(01:C DM"
+      "V _2A/", -1, 0x00000000 },
+    /* DT_DATA, 120 bytes, mask 00 */
+    { "00)#/A( \"@ X_'_ HP_RE_8+^^QD7J*]PEC6)5\\OB 5([#NA4_'ZMZ@3&JYL?52%"
+      "X4K>1 $WJ/=0#_VI<J/\"UIH;.5!TG0:-  SF9_,_RZE8+J^QD57*]4PC6 )\\O/B5"
+      "(_[NAJ4'ZIM@35&YL0?2% XK>_1$W^J=0J#VIE</\"5UH; .!T#", 132, 0x89034F88 },
+    /* DT_DATA, 536 bytes and 1 pad byte */
+    { "FFUFH^G_]O]G__X_X_\\[X_SLC_8+\\^K8#JL3X4;\\;/X3LI#8K3\\+8ICLS.X[\\3[X"
+      "SDLC8Y+\\K)8#L-3X;)\\;XX3L#T8K\\B+8C=LSXW[\\[=XSLWC8+=\\K8B#L3'X;\\+;X"
+      "38L#8<K\\+88CL;SX[&\\[XQSLCL8+\\:K8#QL3X:;\\;\\X3L%#8KJ\\+8OCLS_X[\\_[X"
+      "S_LC8_+\\KZ8#LI3X;0\\;X^3L#E8K\\.+8CDLSXY[\\[.XSL3C8+D\\K8D#L3TX;\\G;X"
+      "3CL#82K\\+)8CLWSX[=\\[XWSLC=8+\\VK8#(L3X<;\\;MX3LA#8KQ\\+8ACLSLX[\\;[X"
+      "S&LC8Q+\\KK8#L%3X;K\\;XP3L#68K\\J+8C_LSX_[\\[_XSL_C8+_\\K8J#L3EX;\\#;X"
+      "3ZL#84K\\+Z8CL3SX[D\\[XYSLC.8+\\2K8#3L3X2;\\;>X3L-#8K(\\+8GCLS=X[\\W[X"
+      "S=LC8W+\\K88#LA3X;R\\;XV3L#'8K\\&+8C&LSXQ[\\[LXSL;C8+&\\K8L#L36X;\\O;X"
+      "3!L#8:K\\+K8CL_SX[_\\[X_SLC_8+\\^K8#JL3X4;\\;/X3LI#8K3\\+8ICLS.X[\\3[X"
+      "SDLC8Y+\\K)8#L-3X;)\\;XX3L#T8K\\B+8C=LSXW[\\[=XSLWC8+=\\K8B#L3'X;\\+;X"
+      "38L#8<K\\+88CL;SX[&\\[XQSLCL8+\\:K8#QL3X:;\\;\\X3L%#8KJ\\+8OCLS_X[\\_[X"
+      "S_LC8_+\\KZ8#LI3X;0\\;X^3L#E8K_/", 548, 0x0A195758 },
+    /* lower case mask */
+    { "5aY\\Y2R:8U:0:5;::5:::5:::5:::5:::5", -1, 0x00000000 },
+};
+
+char *cmdname;
+static tq330 *q330;
+static unsigned seed = 1;
+static int have_ssse3_cpu;
+static long nframes, nmismatch;
+static long nkind[NKINDS], ngood[NKINDS];
+
+int print_syntax (char *cmd, char *syntax[], FILE *fp);
+
+/************************************************************************
+ *  ref_decode:
+ *	Decode a base-96 frame into buf and check its CRC, the way
+ *	lib330 did it before decode() calculated the CRC while decoding.
+ *	Return the packet length, or -1 if the frame is not valid.
+ ************************************************************************/
+int ref_decode (const unsigned char *frame, int lth, unsigned char *buf, tqdp *hdr)
+{
+    const unsigned char *psrc;
+    unsigned char *pdest, m;
+    int groups, actual, diff, mask, i;
+    pbyte p;
+
+    mask = 0;
+    for (i = 0; i < 2; i++) {
+	m = frame[i];
+	if (m >= '0' && m <= '9') mask = (mask << 4) + (m - '0');
+	else if (m >= 'A' && m <= 'F') mask = (mask << 4) + (m - 'A' + 10);
+	else return -1;
+    }
+    psrc = frame + 2;
+    pdest = buf;
+    groups = (lth - 2) >> 2;
+    actual = groups * 3;
+    while (groups-- > 0) {
+	m = psrc[3] - 0x20;
+	*pdest++ = (psrc[0] - 0x20 + ((m & 0x30) << 2)) ^ mask;
+	*pdest++ = (psrc[1] - 0x20 + ((m & 0xc) << 4)) ^ mask;
+	*pdest++ = (psrc[2] - 0x20 + ((m & 3) << 6)) ^ mask;
+	psrc += 4;
+    }
+    if (actual < QDP_HDR_LTH) return -1;
+    p = buf;
+    loadqdphdr (&p, hdr);
+    diff = actual - (hdr->datalength + QDP_HDR_LTH);
+    if (diff < 0 || diff > 2) return -1;
+    actual = hdr->datalength + QDP_HDR_LTH;
+    if ((uint32_t)gcrccalc (&q330->crc_table, buf + 4, actual - 4) != (uint32_t)hdr->crc)
+	return -1;
+    return actual;
+}
+
+/************************************************************************
+ *  run_decode:
+ *	Decode a frame with decode() of lib330, with or without SSSE3.
+ *	Return the result of decode().
+ ************************************************************************/
+int run_decode (const unsigned char *frame, int lth, int ssse3)
+{
+#ifdef DECODE_SSSE3
+    have_ssse3 = ssse3;
+#endif
+    memset (q330->datain.qdp, 0xAA, FRAME_MAX);
+    memcpy (q330->datain.qdp, frame, lth);
+    return decode (q330, lth);
+}
+
+/************************************************************************
+ *  check_frame:
+ *	Compare decode() with the reference for one frame, in every
+ *	group decoding mode.  Return the reference result.
+ ************************************************************************/
+int check_frame (const unsigned char *frame, int lth, const char *what)
+{
+    unsigned char buf[FRAME_MAX];
+    tqdp hdr;
+    int expect, got, mode;
+
+    ++nframes;
+    memset (&hdr, 0, sizeof(hdr));
+    expect = ref_decode (frame, lth, buf, &hdr);
+    for (mode = 0; mode <= have_ssse3_cpu; mode++) {
+	got = run_decode (frame, lth, mode);
+	if (got != expect
+	    || (expect >= 0 && (memcmp (q330->datain.qdp, buf, expect) != 0
+				|| memcmp (&q330->recvhdr, &hdr, sizeof(hdr)) != 0))) {
+	    ++nmismatch;
+	    fprintf (stderr, "%s: %s frame %ld of %d bytes: %s decode returned %d, "
+		     "reference %d%s\n", cmdname, what, nframes, lth,
+		     mode ? "SSSE3" : "scalar", got, expect,
+		     (got == expect) ? ", decoded bytes differ" : "");
+	}
+    }
+    return expect;
+}
+
+/************************************************************************
+ *  encode:
+ *	Base-96 encode len bytes of a packet with mask into frame.
+ *	len must be a multiple of 3.  Return the frame length.
+ ************************************************************************/
+int encode (const unsigned char *pkt, int len, int mask, unsigned char *frame)
+{
+    unsigned char x0, x1, x2, *p;
+    int i;
+
+    sprintf ((char *)frame, "%02X", mask);
+    p = frame + 2;
+    for (i = 0; i < len; i += 3) {
+	x0 = pkt[i] ^ mask;
+	x1 = pkt[i+1] ^ mask;
+	x2 = pkt[i+2] ^ mask;
+	*p++ = (x0 & 0x3f) + 0x20;
+	*p++ = (x1 & 0x3f) + 0x20;
+	*p++ = (x2 & 0x3f) + 0x20;
+	*p++ = (((x0 >> 6) << 4) | ((x1 >> 6) << 2) | (x2 >> 6)) + 0x20;
+    }
+    return p - frame;
+}
+
+/************************************************************************
+ *  random_frame:
+ *	Build a random frame of the given kind.  Return its length.
+ ************************************************************************/
+int random_frame (int kind, unsigned char *frame)
+{
+    unsigned char pkt[FRAME_MAX];
+    int datalength, len, lth, i, n;
+
+    if (kind == 6) {
+	lth = qdp_random(&seed) % (FRAME_MAX + 1);
+	for (i = 0; i < lth; i++)
+	    frame[i] = (i < 2 && qdp_random(&seed) % 2) ? "0123456789ABCDEF"[qdp_random(&seed) % 16]
+		: 0x20 + qdp_random(&seed) % 0x40;
+	return lth;
+    }
+
+    /* A QDP packet of random size, padded to whole groups.		*/
+    datalength = qdp_random(&seed) % (DATA_MAX + 1);
+    if (qdp_random(&seed) % 4 == 0) datalength = qdp_random(&seed) % 64;
+    len = QDP_HDR_LTH + datalength;
+    for (i = 4; i < len; i++) pkt[i] = qdp_random(&seed);
+    qdp_put16 (pkt + 6, datalength);
+    while (len % 3) pkt[len++] = qdp_random(&seed);
+    qdp_put32 (pkt, qdp_crc (pkt + 4, QDP_HDR_LTH + datalength - 4));
+    if (kind == 4) {
+	/* A length that does not fit the frame, with a good CRC.	*/
+	n = datalength + ((qdp_random(&seed) % 2) ? 3 + qdp_random(&seed) % 6 : -1 - (int)(qdp_random(&seed) % 6));
+	if (n < 0) n = datalength + 3;
+	qdp_put16 (pkt + 6, n);
+	if (QDP_HDR_LTH + n <= len)
+	    qdp_put32 (pkt, qdp_crc (pkt + 4, QDP_HDR_LTH + n - 4));
+    }
+    lth = encode (pkt, len, qdp_random(&seed) % 256, frame);
+
+    switch (kind) {
+    case 1:	/* One bit of the packet or the mask.			*/
+	i = qdp_random(&seed) % lth;
+	frame[i] ^= 1 << (qdp_random(&seed) % 6);
+	break;
+    case 2:	/* Lose 1 to 8 bytes.					*/
+	n = 1 + qdp_random(&seed) % 8;
+	lth = (lth > n) ? lth - n : 0;
+	break;
+    case 3:	/* 1 to 8 more bytes, within what lib330 reads.		*/
+	n = 1 + qdp_random(&seed) % 8;
+	for (i = 0; i < n && lth < FRAME_MAX; i++)
+	    frame[lth++] = 0x20 + qdp_random(&seed) % 0x40;
+	break;
+    case 5:	/* Not an upper case hex digit.				*/
+	frame[qdp_random(&seed) % 2] = "Gg/:@a f"[qdp_random(&seed) % 8];
+	break;
+    }
+    return lth;
+}
+
+/************************************************************************
+ *  check_golden:
+ *	Check the golden frames.
+ ************************************************************************/
+void check_golden (void)
+{
+    int i, lth, mode, got, bad;
+
+    for (i = 0; i < (int)(sizeof(GOLDEN) / sizeof(GOLDEN[0])); i++) {
+	lth = strlen(GOLDEN[i].frame);
+	check_frame ((const unsigned char *)GOLDEN[i].frame, lth, "golden");
+	for (mode = 0; mode <= have_ssse3_cpu; mode++) {
+	    got = run_decode ((const unsigned char *)GOLDEN[i].frame, lth, mode);
+	    bad = (got != GOLDEN[i].actual);
+	    if (got >= 0 && (uint32_t)q330->recvhdr.crc != GOLDEN[i].crc) bad = 1;
+	    if (bad) {
+		++nmismatch;
+		fprintf (stderr, "%s: golden frame %d: %s decode returned %d crc %08X, "
+			 "expected %d crc %08X\n", cmdname, i, mode ? "SSSE3" : "scalar",
+			 got, (uint32_t)q330->recvhdr.crc, GOLDEN[i].actual, GOLDEN[i].crc);
+	    }
+	}
+    }
+    printf ("%s: %d golden frames\n", cmdname, i);
+}
+
+/************************************************************************
+ *  check_capture:
+ *	Check every frame of a capture file.
+ *	Return 0 on success, -1 if the file can't be read.
+ ************************************************************************/
+int check_capture (char *file)
+{
+    unsigned char frame[65536];
+    unsigned char lb[2];
+    long n = 0, good = 0;
+    int lth;
+    FILE *fp;
+
+    if ((fp = fopen (file, "r")) == NULL) {
+	fprintf (stderr, "%s: unable to open %s\n", cmdname, file);
+	return -1;
+    }
+    while (fread (lb, 1, 2, fp) == 2) {
+	lth = (lb[0] << 8) | lb[1];
+	if (fread (frame, 1, lth, fp) != (size_t)lth) {
+	    fprintf (stderr, "%s: %s is truncated\n", cmdname, file);
+	    break;
+	}
+	if (lth > FRAME_MAX) lth = FRAME_MAX;	/* As recvfrom() would.	*/
+	++n;
+	if (check_frame (frame, lth, file) >= 0) ++good;
+    }
+    fclose (fp);
+    printf ("%s: %s: %ld frames, %ld good\n", cmdname, file, n, good);
+    return 0;
+}
+
+/************************************************************************
+ *  main procedure
+ ************************************************************************/
+int main (int argc, char **argv)
+{
+    unsigned char frame[FRAME_MAX];
+    char *capture = NULL;
+    long count = DEFAULT_COUNT, i;
+    int kind, lth, status = 0;
+    FILE *out = NULL;
+
+    /* Variables needed for getopt. */
+    extern char	*optarg;
+    extern int	optind, opterr;
+    int		ch;
+
+    setlinebuf(stdout);
+    cmdname = basename(strdup(argv[0]));
+    while ( (ch = getopt(argc,argv,"hn:r:o:")) != -1)
+	switch (ch) {
+	case '?':
+	case 'h':   print_syntax(cmdname,syntax,stdout); exit(1);
+	case 'n':   count = atol(optarg); break;
+	case 'r':   seed = strtoul(optarg, NULL, 0); break;
+	case 'o':   capture = optarg; break;
+	default:
+	    fprintf (stderr, "Unsupported option: -%c\n", ch);
+	    exit(1);
+	}
+
+    /*	Skip over all options and their arguments.			*/
+    argv = &(argv[optind]);
+    argc -= optind;
+
+    if (count < 0 || seed == 0) {
+	fprintf (stderr, "Invalid option value\n");
+	exit(1);
+    }
+    if (capture != NULL && (out = fopen (capture, "w")) == NULL) {
+	fprintf (stderr, "%s: unable to create %s\n", cmdname, capture);
+	exit(1);
+    }
+
+    if ((q330 = calloc (1, sizeof(tq330))) == NULL) {
+	fprintf (stderr, "%s: out of memory\n", cmdname);
+	exit(1);
+    }
+    gcrcinit (&q330->crc_table);
+    gcrcslices (&q330->crc_table, &q330->crc_slices[0]);
+#ifdef DECODE_SSSE3
+    have_ssse3_cpu = __builtin_cpu_supports ("ssse3") != 0;
+#endif
+    printf ("%s: SSSE3 group decoding %s\n", cmdname,
+#ifdef DECODE_SSSE3
+	    have_ssse3_cpu ? "tested" : "not supported by this CPU"
+#else
+	    "not compiled"
+#endif
+	    );
+
+    check_golden ();
+    for (; argc > 0; argc--, argv++)
+	if (check_capture (argv[0]) < 0) status = 1;
+
+    for (i = 0; i < count; i++) {
+	kind = qdp_random(&seed) % NKINDS;
+	lth = random_frame (kind, frame);
+	++nkind[kind];
+	if (check_frame (frame, lth, KIND_NAMES[kind]) >= 0) ++ngood[kind];
+	if (out != NULL) {
+	    fputc (lth >> 8, out);
+	    fputc (lth & 255, out);
+	    fwrite (frame, 1, lth, out);
+	}
+    }
+    if (out != NULL && fclose (out) != 0) {
+	fprintf (stderr, "%s: unable to write %s\n", cmdname, capture);
+	status = 1;
+    }
+    for (kind = 0; kind < NKINDS; kind++)
+	printf ("%s: %-10s %8ld frames, %8ld good\n", cmdname, KIND_NAMES[kind],
+		nkind[kind], ngood[kind]);
+    printf ("%s: %ld frames, %ld mismatches\n", cmdname, nframes, nmismatch);
+    if (ngood[0] != nkind[0]) {
+	fprintf (stderr, "%s: %ld intact frames did not decode\n", cmdname,
+		 nkind[0] - ngood[0]);
+	status = 1;
+    }
+    exit ((nmismatch > 0) ? 1 : status);
+}
+
+/************************************************************************
+ *  print_syntax:
+ *	Print the syntax description of program.
+ ************************************************************************/
+int print_syntax (char	*cmd,		/* program name.			*/
+		  char	*syntax[],	/* syntax array.			*/
+		  FILE	*fp)		/* FILE ptr for output.			*/
+{
+    int i;
+    for (i=0; syntax[i] != NULL; i++) {
+	fprintf (fp, syntax[i], cmd);
+	fprintf (fp, "\n");
+    }
+    return (0);
+}
@@ -0,0 +1,1265 @@
+/************************************************************************
+ *  q330sim - Fake Q330 data logger for lib330 and q330serv.
+ *
+ *  q330sim answers the UDP control and data ports of one Q330 data
+ *  port, baseport+2*dataport and the next port.  It registers lib330
+ *  with a challenge, returns the fixed, global and logical port
+ *  configuration, the status blocks that lib330 asks for, and the
+ *  DP tokens of synthetic main digitizer channels as configuration
+ *  memory.  After DT_OPEN it sends DT_DATA packets of compressed
+ *  blockettes through a sliding window that is advanced by the DT_DACK
+ *  packets of lib330, and resends the packets that were not
+ *  acknowledged.
+ *
+ *  The Q330 packet buffer is modelled by the seconds of data that are
+ *  not yet packetized: they are generated when the window has room, so
+ *  that a backlog at start or after a lost registration is sent as
+ *  backfill at the speed of the window, and the oldest seconds are
+ *  discarded once the buffer is full.
+ *
+ *  To load lib330 harder than a real Q330, the data clock can run
+ *  faster than real time, DT_DATA packets can be dropped, singly or in
+ *  bursts, or delivered out of order, DT_FILL packets can be mixed in,
+ *  and the registration can be dropped at a fixed interval.
+ *
+ *  lib330 must be configured with a udpaddr other than 127.0.0.1, which
+ *  lib330 reserves for a local baler, e.g. 127.0.0.2.  The MD5 response
+ *  of the registration is not checked, the status blocks other than the
+ *  global and logical port status are zero, and TCP mode is not
+ *  supported.
+ ************************************************************************/
+
+/* Modification History:
+------------------------------------------------------------------------
+    2026.292     ver 1.0.0	Initial version.
+*/
+
+#define	VERSION		"1.0.0 (2026.292)"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include <unistd.h>
+#include <string.h>
+#include <signal.h>
+#include <libgen.h>
+#include <math.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "cslimits.h"
+#include "cstypes.h"
+#include "stuff.h"
+#include "timeutil.h"
+#include "qdputil.h"
+
+#define	Q330_EPOCH	946684800.	/* 2000-01-01 in seconds since 1970.	*/
+#define	DEFAULT_BASEPORT 5330
+#define	DEFAULT_NCHAN	3
+#define	DEFAULT_RATES	"100,40,1"
+#define	DEFAULT_BUFFER	3600		/* Seconds of data in the buffer.	*/
+#define	DEFAULT_WINDOW	64
+#define	STATUS_INTERVAL	10		/* Seconds between status messages.	*/
+#define	MAX_CHAN	6		/* Main digitizer channels.		*/
+#define	MAX_RATES	8		/* One per frequency bit.		*/
+#define	MAX_WINDOW	120		/* lib330 accepts 127 packets ahead.	*/
+#define	SEQ_OFFSET	1000000		/* Q330 seconds of data sequence 0.	*/
+
+/* QDP packets.								*/
+#define	QDP_VER		2
+#define	QDP_HDR_LTH	12
+#define	MAXDATA		536
+#define	C1_RQSRV	0x10
+#define	C1_SRVRSP	0x11
+#define	C1_DSRV		0x12
+#define	C1_SLOG		0x17
+#define	C1_RQLOG	0x18
+#define	C1_RQSTAT	0x1F
+#define	C1_RQGID	0x28
+#define	C1_UMSG		0x30
+#define	C1_WEB		0x33
+#define	C1_RQFGLS	0x34
+#define	C1_PING		0x38
+#define	C1_RQMEM	0x41
+#define	C1_CACK		0xA0
+#define	C1_SRVCH	0xA1
+#define	C1_CERR		0xA2
+#define	C1_LOG		0xA5
+#define	C1_STAT		0xA9
+#define	C1_GID		0xAC
+#define	C1_FGLS		0xB1
+#define	C1_MEM		0xB8
+#define	CERR_NOTR	2
+#define	CERR_INVREG	3
+#define	CERR_PAR	4
+#define	DT_DATA		0
+#define	DT_FILL		6
+#define	DT_DACK		0x0A
+#define	DT_OPEN		0x0B
+
+/* Configuration and status blocks.					*/
+#define	FIXED_LTH	188
+#define	GLOBAL_LTH	160
+#define	SENSCTRL_LTH	32
+#define	LOG_LTH		52
+#define	GID_LTH		(9 * 32)
+#define	MT_CFG1		1		/* Tokens of data port 1.		*/
+#define	MAXSEG		438		/* Token bytes per memory segment.	*/
+#define	SEG_OVERHEAD	10
+#define	LNKFLG_FILL	1
+#define	SRB_GLB		0
+#define	SRB_LOG1	8
+#define	SRB_LAST	19		/* Serial sensor status.		*/
+#define	CLOCK_QUAL	0xC5		/* PLL locked, 3D GPS fix, was locked.	*/
+
+/* DP tokens.								*/
+#define	TF_VERSION	1
+#define	TF_NET_STAT	2
+#define	TF_CLOCK	6
+#define	TF_MT		7
+#define	T1_LCQ		128
+#define	LCQ_LTH		15		/* From the length byte on.		*/
+#define	MAX_TOKENS	2048
+
+/* Data blockettes.							*/
+#define	DC_MN232	0x98		/* Timing blockette.			*/
+#define	DC_D32		0xE0		/* 1 sps sample.			*/
+#define	DC_COMP		0xE8		/* Compressed second.			*/
+#define	DC_MULT		0xF0		/* Segment of a compressed second.	*/
+#define	DMLS		0x8000		/* Last segment.			*/
+#define	HIGH_FREQ_BIT	7
+#define	MIN_SEG_WORDS	4		/* Words worth starting a segment with.	*/
+
+#define	PEND_MAX	256		/* Packets of one second.		*/
+#define	FAST_RESEND	0.02		/* Seconds before a gap is resent.	*/
+
+char *syntax[] = {
+"%s version " VERSION,
+"%s [-b baseport] [-i ifaddr] [-p dataport] [-g nchan] [-s rates] [-x speed]",
+"    [-B backlog] [-M buffer] [-w window] [-L loss%%] [-G burst] [-R reorder%%]",
+"    [-F fills] [-K seconds] [-r seed] [-h] NET.STA",
+"    where:",
+"	-b baseport Base port of the Q330 (default 5330).",
+"	-i ifaddr   Listen on the interface with this address (default 127.0.0.2).",
+"		    lib330 treats 127.0.0.1 as a local baler.",
+"	-p dataport Data port 1 to 4 (default 1), on baseport+2*dataport and",
+"		    the next port.",
+"	-g nchan    Number of main digitizer channels, 1 to 6 (default 3).",
+"	-s rates    Comma-delimited list of the sample rates of every channel,",
+"		    from 1,10,20,40,50,100,200 and one of 250,500,1000",
+"		    (default 100,40,1).",
+"	-x speed    Run the data clock speed times faster than real time.",
+"	-B backlog  Seconds of data in the packet buffer at start (default 0).",
+"	-M buffer   Seconds of data the packet buffer holds (default 3600).",
+"	-w window   Sliding window size in packets, 1 to 120 (default 64).",
+"	-L loss%%    Percentage of DT_DATA packets that are dropped when first sent.",
+"	-G burst    Drop this many packets in a row for each loss (default 1).",
+"	-R reorder%% Percentage of DT_DATA packets that are sent after the next one.",
+"	-F fills    DT_FILL packets per second.",
+"	-K seconds  Drop the registration this many seconds after DT_OPEN.",
+"	-r seed	    Seed of the packet loss and reordering (default 1).",
+"	-h	    Print brief help message for syntax.",
+"	NET.STA	    SEED network and station of the tokens.",
+"Examples:",
+"	q330sim -b 6000 -g 6 -s 200,100,1 XX.B001",
+"			18 channels for lib330 with baseport 6000.",
+"	q330sim -B 600 -L 1 -G 5 -K 300 XX.B001",
+"			start with 10 minutes of backfill, drop bursts of",
+"			5 packets, and drop the registration every 5 minutes.",
+NULL };
+
+/* Sample rates by frequency bit, and the fixed.freq7 code of the bit 7 rates. */
+static const int FREQTAB[MAX_RATES-1] = {1, 10, 20, 40, 50, 100, 200};
+static const struct {
+    int rate, code;
+} HIGHTAB[] = { {250, 5}, {500, 8}, {1000, 10} };
+static const char ORIENT[3] = "ZNE";
+
+struct lcq {
+    int chan;				/* Main digitizer channel 0-5.	*/
+    int rate;
+    int freqbit;
+    char loc[3];
+    char name[4];
+};
+
+struct pkt {
+    unsigned char cmd;
+    unsigned char acked;
+    int len;				/* Bytes of payload.		*/
+    int sends;
+    double sent, due;
+    unsigned char data[MAXDATA];
+};
+
+char *cmdname;				/* Name of this program.	*/
+int terminate_proc;
+
+char network[3];
+char station[6];
+int nchan = DEFAULT_NCHAN;
+int rates[MAX_RATES];			/* Sample rates of every channel. */
+int nrates;
+int freq7;				/* fixed.freq7 code.		*/
+struct lcq lcqs[MAX_CHAN*MAX_RATES];
+int nlcq;
+unsigned char tokens[MAX_TOKENS];
+int token_lth;
+
+double speed = 1.;
+double start_time;
+int backlog, buffer = DEFAULT_BUFFER;
+double loss, reorder, fills, kill_secs;
+int burst = 1;
+unsigned seed = 1;
+int dataport = 1;
+uint32_t sec_offset;			/* Q330 seconds of data sequence 0. */
+
+/* Logical port configuration.						*/
+int window = DEFAULT_WINDOW;
+int ack_cnt = 8, ack_to = 2;		/* Host acknowledge, 0.1 sec.	*/
+int rsnd_min = 5, rsnd_max = 40;	/* Resend timeouts, 0.1 sec.	*/
+
+int ctrl_sock, data_sock;
+struct sockaddr_in host_ctrl, host_data;
+int registered, data_open;
+unsigned char challenge[8];
+uint16_t ctrl_seq;
+
+/* Sliding window, indexed by sequence number modulo 256.		*/
+struct pkt win[256];
+uint16_t base_seq, next_seq;		/* Oldest unacked, next to send. */
+struct pkt pend[PEND_MAX];		/* Packets of the next second.	*/
+int npend, pend_out;
+int held = -1;				/* Sequence sent after the next. */
+int loss_left;
+uint32_t gen_sec;			/* Next second to packetize.	*/
+uint32_t fill_seq;
+double next_fill, kill_at;
+
+uint64_t packets, bytes, seconds, resent, dropped, reordered, fills_sent, overflow;
+int registrations;
+
+int print_syntax (char *cmd, char *syntax[], FILE *fp);
+void finish_handler (int sig);
+
+/************************************************************************
+ *  get16, get32:
+ *	Return a value in network byte order.
+ ************************************************************************/
+static unsigned get16 (const unsigned char *p)
+{
+    return (p[0] << 8) | p[1];
+}
+
+static uint32_t get32 (const unsigned char *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+/************************************************************************
+ *  data_time:
+ *	Return the time of the data clock, in seconds since 1970.
+ ************************************************************************/
+double data_time (double now)
+{
+    return start_time + (now - start_time) * speed;
+}
+
+/************************************************************************
+ *  last_complete:
+ *	Return the last second of data that is complete, in Q330 seconds.
+ ************************************************************************/
+uint32_t last_complete (double now)
+{
+    return (uint32_t)(floor(data_time(now) - Q330_EPOCH) - 1);
+}
+
+/************************************************************************
+ *  percent:
+ *	Return 1 with a probability of pct percent.
+ ************************************************************************/
+int percent (double pct)
+{
+    return pct > 0. && (qdp_random (&seed) % 1000000) < pct * 10000.;
+}
+
+/************************************************************************
+ *  send_qdp:
+ *	Frame a QDP packet and send it to addr from socket fd.
+ *	Return the number of bytes sent.
+ ************************************************************************/
+int send_qdp (int fd, const struct sockaddr_in *addr, int cmd, unsigned seq,
+	      unsigned ack, const unsigned char *data, int len)
+{
+    unsigned char pkt[QDP_HDR_LTH + MAXDATA];
+    unsigned char *p;
+
+    p = qdp_put32 (pkt, 0);
+    p = qdp_put8 (p, cmd);
+    p = qdp_put8 (p, QDP_VER);
+    p = qdp_put16 (p, len);
+    p = qdp_put16 (p, seq);
+    p = qdp_put16 (p, ack);
+    memcpy (p, data, len);
+    qdp_put32 (pkt, qdp_crc (pkt + 4, QDP_HDR_LTH - 4 + len));
+    if (sendto (fd, pkt, QDP_HDR_LTH + len, 0, (const struct sockaddr *)addr,
+		sizeof(*addr)) < 0)
+	return 0;
+    return QDP_HDR_LTH + len;
+}
+
+/************************************************************************
+ *  reply:
+ *	Send a command response, acknowledging command sequence ack.
+ ************************************************************************/
+void reply (int cmd, unsigned ack, const unsigned char *data, int len)
+{
+    send_qdp (ctrl_sock, &host_ctrl, cmd, ctrl_seq++, ack, data, len);
+}
+
+/************************************************************************
+ *  reply_err:
+ *	Send a C1_CERR response with an error code.
+ ************************************************************************/
+void reply_err (unsigned ack, int code)
+{
+    unsigned char err[2];
+
+    qdp_put16 (err, code);
+    reply (C1_CERR, ack, err, 2);
+}
+
+/************************************************************************
+ *  put_log:
+ *	Store the logical port configuration.  The data sequence is the
+ *	oldest packet that was not acknowledged, which a new registration
+ *	of lib330 expects next.
+ ************************************************************************/
+unsigned char *put_log (unsigned char *p)
+{
+    int c, r;
+    unsigned freqs;
+
+    p = qdp_put16 (p, dataport - 1);	/* Logical port.		*/
+    p = qdp_put16 (p, (fills > 0.) ? LNKFLG_FILL : 0);
+    p = qdp_put16 (p, 0);		/* Percent of buffer to keep.	*/
+    p = qdp_put16 (p, QDP_HDR_LTH + MAXDATA + 28);	/* MTU.		*/
+    p = qdp_put16 (p, 0);		/* Group count.			*/
+    p = qdp_put16 (p, rsnd_max);
+    p = qdp_put16 (p, 0);		/* Group timeout.		*/
+    p = qdp_put16 (p, rsnd_min);
+    p = qdp_put16 (p, window);
+    p = qdp_put16 (p, base_seq);
+    for (c = 0; c < MAX_CHAN; c++) {
+	freqs = 0;
+	for (r = 0; c < nchan && r < nrates; r++)
+	    freqs |= 1 << lcqs[c * nrates + r].freqbit;
+	p = qdp_put16 (p, freqs);
+    }
+    p = qdp_put16 (p, ack_cnt);
+    p = qdp_put16 (p, ack_to);
+    p = qdp_put32 (p, 0);		/* Old data threshold.		*/
+    p = qdp_put16 (p, 0);		/* Ethernet throttle.		*/
+    p = qdp_put16 (p, 0);		/* Full alert.			*/
+    p = qdp_put16 (p, 0);		/* Automatic filter.		*/
+    p = qdp_put16 (p, 0);		/* Manual filter.		*/
+    p = qdp_put32 (p, 0);
+    return p;
+}
+
+/************************************************************************
+ *  send_fgls:
+ *	Send the fixed, global, sensor control and logical port
+ *	configuration.
+ ************************************************************************/
+void send_fgls (unsigned ack)
+{
+    unsigned char buf[8 + FIXED_LTH + GLOBAL_LTH + SENSCTRL_LTH + LOG_LTH];
+    unsigned char *p = buf;
+    int i;
+
+    /* Offsets of the global, sensor control and logical port blocks. */
+    p = qdp_put16 (p, 8 + FIXED_LTH);
+    p = qdp_put16 (p, 8 + FIXED_LTH + GLOBAL_LTH);
+    p = qdp_put16 (p, 8 + FIXED_LTH + GLOBAL_LTH + SENSCTRL_LTH);
+    p = qdp_put16 (p, 0);
+
+    /* Fixed values.							*/
+    p = qdp_put32 (p, (uint32_t)(start_time - Q330_EPOCH));	/* Last reboot. */
+    p = qdp_put32 (p, 1);		/* Reboots.			*/
+    p = qdp_put32 (p, 0);		/* Backup and default maps.	*/
+    p = qdp_put32 (p, 0);
+    for (i = 0; i < 5; i++)
+	p = qdp_put16 (p, 0);		/* Calibrator, aux and clock types. */
+    p = qdp_put16 (p, 0);		/* Flags.			*/
+    p = qdp_put16 (p, 0x0168);		/* System version 1.104.	*/
+    p = qdp_put16 (p, 0);		/* Slave processor and PLD versions. */
+    p = qdp_put16 (p, 0);
+    p = qdp_put16 (p, 0);		/* Memory block size.		*/
+    p = qdp_put32 (p, 330);		/* Property tag.		*/
+    for (i = 0; i < 8; i++)
+	p = qdp_put32 (p, 0);		/* Serial numbers.		*/
+    for (i = 0; i < 7; i++)
+	p = qdp_put32 (p, 0);		/* QAPCHP numbers and memory sizes. */
+    for (i = 0; i < 4; i++)
+	p = qdp_put32 (p, 1 << 20);	/* Logical port buffer sizes.	*/
+    p = qdp_put8 (p, freq7);
+    for (i = 0; i < 7; i++)
+	p = qdp_put8 (p, 0);		/* freq6 to freq0.		*/
+    for (i = 0; i < 16; i++)
+	p = qdp_put32 (p, 0);		/* Filter delays.		*/
+
+    /* Global programming.						*/
+    for (i = 0; i < 11; i++)
+	p = qdp_put16 (p, 0);		/* Clock timeout to jump filter. */
+    p = qdp_put16 (p, 50000);		/* Jump threshold, usec.	*/
+    for (i = 0; i < 4; i++)
+	p = qdp_put16 (p, 0);		/* Calibration offset to GPS cold start. */
+    p = qdp_put32 (p, 0);		/* User tag.			*/
+    for (i = 0; i < 6 * 8 + 6 + 6; i++)
+	p = qdp_put16 (p, 0);		/* Scaling, offsets and gains.	*/
+    p = qdp_put32 (p, 0);		/* Message map.			*/
+
+    /* Sensor control.							*/
+    for (i = 0; i < 8; i++)
+	p = qdp_put32 (p, 0);
+
+    p = put_log (p);
+    reply (C1_FGLS, ack, buf, p - buf);
+}
+
+/************************************************************************
+ *  send_status:
+ *	Send the status blocks of a request that fit one packet.  lib330
+ *	asks again for the rest.
+ ************************************************************************/
+void send_status (unsigned ack, uint32_t request, double now)
+{
+    static const int lths[SRB_LAST+1] = {
+	52, 84, 20, 32, 0, 28, 4, 4, 32, 32, 32, 32, 36, 36, 36, 76, 48, 16, 8, 4
+    };
+    unsigned char buf[MAXDATA];
+    unsigned char *p = buf + 4;
+    uint32_t map = 0;
+    uint32_t t2000 = (uint32_t)(data_time (now) - Q330_EPOCH);
+    unsigned inflight = (uint16_t)(next_seq - base_seq);
+    int bit, i;
+
+    for (bit = 0; bit <= SRB_LAST; bit++) {
+	if ((request & (1u << bit)) == 0) continue;
+	if (p - buf + lths[bit] > MAXDATA) break;
+	map |= 1u << bit;
+	memset (p, 0, lths[bit]);
+	switch (bit) {
+	case SRB_GLB:
+	    qdp_put16 (p + 2, CLOCK_QUAL);
+	    qdp_put16 (p + 6, 1250);		/* Input volts.		*/
+	    qdp_put32 (p + 8, sec_offset);
+	    qdp_put32 (p + 16, (uint32_t)(now - start_time));	/* Total time. */
+	    qdp_put32 (p + 20, (uint32_t)(now - start_time));	/* Power time. */
+	    qdp_put16 (p + 40, base_seq);		/* Data sequence.	*/
+	    qdp_put32 (p + 48, t2000 - sec_offset);	/* Current sequence.	*/
+	    break;
+	case 6:				/* GPS satellites.		*/
+	case 7:				/* ARP table.			*/
+	    qdp_put16 (p + 2, 4);
+	    break;
+	case 18:			/* Aux board.			*/
+	    qdp_put16 (p, 8);
+	    break;
+	case 19:			/* Serial sensors.		*/
+	    qdp_put16 (p, 4);
+	    break;
+	case SRB_LOG1: case SRB_LOG1+1: case SRB_LOG1+2: case SRB_LOG1+3:
+	    qdp_put32 (p, (uint32_t)packets);
+	    qdp_put32 (p + 4, (uint32_t)resent);
+	    qdp_put32 (p + 8, fill_seq);
+	    qdp_put32 (p + 12, next_seq);
+	    /* Packets in the window and an estimate of the buffered ones. */
+	    i = inflight + npend - pend_out;
+	    if (gen_sec <= last_complete (now))
+		i += (last_complete (now) - gen_sec + 1) * (nrates * nchan / 4 + 1);
+	    qdp_put32 (p + 16, i);
+	    qdp_put32 (p + 20, base_seq - 1);
+	    qdp_put16 (p + 24, 2);		/* Ethernet.		*/
+	    qdp_put16 (p + 26, bit - SRB_LOG1);
+	    break;
+	}
+	p += lths[bit];
+    }
+    qdp_put32 (buf, map);
+    reply (C1_STAT, ack, buf, p - buf);
+}
+
+/************************************************************************
+ *  send_memory:
+ *	Send a segment of the tokens, the configuration memory of the
+ *	data port.
+ ************************************************************************/
+void send_memory (unsigned ack, const unsigned char *req)
+{
+    unsigned char buf[12 + MAXSEG];
+    unsigned char *p = buf;
+    uint32_t start = get32 (req);
+    int memtype = get16 (req + 6);
+    int segnum = start / (MAXSEG + SEG_OVERHEAD);
+    int total = (token_lth + MAXSEG - 1) / MAXSEG;
+    int n;
+
+    if (memtype != MT_CFG1 + dataport - 1 || segnum >= total) {
+	reply_err (ack, CERR_PAR);
+	return;
+    }
+    n = token_lth - segnum * MAXSEG;
+    if (n > MAXSEG) n = MAXSEG;
+    p = qdp_put32 (p, start);
+    p = qdp_put16 (p, n + 4);
+    p = qdp_put16 (p, memtype);
+    p = qdp_put16 (p, segnum + 1);
+    p = qdp_put16 (p, total);
+    memcpy (p, tokens + segnum * MAXSEG, n);
+    p += n;
+    reply (C1_MEM, ack, buf, p - buf);
+}
+
+/************************************************************************
+ *  build_tokens:
+ *	Build the DP tokens: version, station, clock, the log and timing
+ *	channels, and one LCQ per channel and rate.
+ ************************************************************************/
+void build_tokens (void)
+{
+    unsigned char *p = tokens;
+    int i;
+
+    p = qdp_put8 (p, TF_VERSION);
+    p = qdp_put8 (p, 0);
+    p = qdp_put8 (p, TF_NET_STAT);
+    memset (p, ' ', 7);
+    memcpy (p, network, strlen(network));
+    memcpy (p + 2, station, strlen(station));
+    p += 7;
+    p = qdp_put8 (p, TF_CLOCK);
+    p = qdp_put32 (p, 0);		/* Time zone.			*/
+    p = qdp_put16 (p, 0);		/* Degrade time.		*/
+    p = qdp_put8 (p, 100);		/* Locked.			*/
+    p = qdp_put8 (p, 90);		/* Tracking.			*/
+    p = qdp_put8 (p, 80);		/* Hold.			*/
+    p = qdp_put8 (p, 10);		/* Off.				*/
+    p = qdp_put8 (p, 0);
+    p = qdp_put8 (p, 90);		/* Highest and lowest unlocked.	*/
+    p = qdp_put8 (p, 10);
+    p = qdp_put8 (p, 0);		/* Never locked.		*/
+    p = qdp_put16 (p, 0);		/* Clock filter.		*/
+    p = qdp_put8 (p, TF_MT);
+    memcpy (p, "  LOG  ACE", 10);
+    p += 10;
+    for (i = 0; i < nlcq; i++) {
+	p = qdp_put8 (p, T1_LCQ);
+	p = qdp_put8 (p, LCQ_LTH);
+	memcpy (p, lcqs[i].loc, 2);
+	memcpy (p + 2, lcqs[i].name, 3);
+	p += 5;
+	p = qdp_put8 (p, i);
+	p = qdp_put8 (p, DC_D32 | lcqs[i].chan);
+	p = qdp_put8 (p, lcqs[i].freqbit);
+	p = qdp_put32 (p, 0);		/* Options.			*/
+	p = qdp_put16 (p, lcqs[i].rate);
+    }
+    token_lth = p - tokens;
+}
+
+/************************************************************************
+ *  new_packet:
+ *	Start the next pending packet of second sec.
+ *	Return the address after its data sequence number.
+ ************************************************************************/
+unsigned char *new_packet (uint32_t sec)
+{
+    struct pkt *pk = &pend[npend];
+
+    if (npend >= PEND_MAX) {
+	fprintf (stderr, "Too many packets in one second\n");
+	exit(1);
+    }
+    pk->cmd = DT_DATA;
+    return qdp_put32 (pk->data, sec - sec_offset);
+}
+
+/************************************************************************
+ *  end_packet:
+ *	Finish the current pending packet at p.
+ ************************************************************************/
+void end_packet (unsigned char *p)
+{
+    pend[npend].len = p - pend[npend].data;
+    ++npend;
+}
+
+/************************************************************************
+ *  gen_second:
+ *	Packetize one second of data: a timing blockette, a 1 sps sample
+ *	or a compressed blockette of every LCQ.  A compressed blockette
+ *	that does not fit the rest of a packet is continued as DC_MULT
+ *	segments in the next packets, for the rates that lib330 merges.
+ ************************************************************************/
+void gen_second (uint32_t sec)
+{
+    static int32_t diffs[1000];
+    static unsigned char codes[QDP_MAXWORDS];
+    static uint32_t words[QDP_MAXWORDS];
+    unsigned char map[QDP_MAXWORDS/4 + 4];
+    unsigned char *pkt, *p, *end;
+    struct lcq *q;
+    int i, k, w, nw, nwords, mapsize, offset, size, seg;
+    int32_t prev, last, x;
+    int64_t n0;
+
+    npend = pend_out = 0;
+    pkt = pend[0].data;
+    p = new_packet (sec);
+    p = qdp_put8 (p, DC_MN232);
+    p = qdp_put8 (p, CLOCK_QUAL);
+    p = qdp_put16 (p, 0);		/* Minutes since loss.		*/
+    p = qdp_put32 (p, sec_offset);
+    p = qdp_put32 (p, 0);		/* Usec offset.			*/
+
+    for (i = 0; i < nlcq; i++) {
+	q = &lcqs[i];
+	n0 = (int64_t)sec * q->rate;
+	if (q->rate == 1) {
+	    if (p + 8 > pkt + MAXDATA) {
+		end_packet (p);
+		pkt = pend[npend].data;
+		p = new_packet (sec);
+	    }
+	    p = qdp_put8 (p, DC_D32 | q->chan);
+	    p = qdp_put8 (p, 0);
+	    p = qdp_put16 (p, 0);
+	    p = qdp_put32 (p, qdp_sample (i, 1, n0));
+	    continue;
+	}
+	prev = last = qdp_sample (i, q->rate, n0 - 1);
+	for (k = 0; k < q->rate; k++) {
+	    x = qdp_sample (i, q->rate, n0 + k);
+	    diffs[k] = x - last;
+	    last = x;
+	}
+	nwords = qdp_compress (diffs, q->rate, codes, words);
+	mapsize = (nwords + 3) / 4;
+	qdp_map (codes, nwords, map);
+	offset = (10 + mapsize + 3) & ~3;
+	size = offset + nwords * 4;
+	end = pkt + MAXDATA;
+
+	/* Start a new packet unless the blockette fits, or a useful	*/
+	/* first segment of a segmented one does.			*/
+	if (p + size > end && (q->rate < 100 || p + offset + MIN_SEG_WORDS * 4 > end)) {
+	    end_packet (p);
+	    pkt = pend[npend].data;
+	    p = new_packet (sec);
+	    end = pkt + MAXDATA;
+	}
+	nw = (p + size <= end) ? nwords : (end - p - offset) / 4;
+	p = qdp_put8 (p, ((nw < nwords) ? DC_MULT : DC_COMP) | q->chan);
+	p = qdp_put8 (p, q->freqbit);
+	p = qdp_put16 (p, offset + nw * 4);
+	p = qdp_put32 (p, prev);
+	p = qdp_put16 (p, offset);
+	memset (p, 0, offset - 10);
+	memcpy (p, map, mapsize);
+	p += offset - 10;
+	for (w = 0; w < nw; w++)
+	    p = qdp_put32 (p, words[w]);
+
+	/* The following segments, numbered from 1, of DC_MULT.	*/
+	for (seg = 1; w < nwords; seg++) {
+	    end_packet (p);
+	    pkt = pend[npend].data;
+	    p = new_packet (sec);
+	    nw = (MAXDATA - 4 - 4) / 4;
+	    if (nw > nwords - w) nw = nwords - w;
+	    p = qdp_put8 (p, DC_MULT | q->chan);
+	    p = qdp_put8 (p, q->freqbit | (seg << 3));
+	    p = qdp_put16 (p, (4 + nw * 4) | ((w + nw == nwords) ? DMLS : 0));
+	    for (k = 0; k < nw; k++)
+		p = qdp_put32 (p, words[w++]);
+	}
+    }
+    end_packet (p);
+    ++seconds;
+}
+
+/************************************************************************
+ *  send_packet:
+ *	Send a packet of the window to the data port of lib330.
+ ************************************************************************/
+void send_packet (uint16_t seq)
+{
+    struct pkt *pk = &win[seq & 255];
+    int n;
+
+    if ((n = send_qdp (data_sock, &host_data, pk->cmd, seq, 0, pk->data, pk->len)) > 0) {
+	++packets;
+	bytes += n;
+    }
+}
+
+/************************************************************************
+ *  send_held:
+ *	Send the packet that was held back to be reordered.
+ ************************************************************************/
+void send_held (void)
+{
+    uint16_t seq = held;
+
+    held = -1;
+    if ((uint16_t)(seq - base_seq) < (uint16_t)(next_seq - base_seq) && ! win[seq & 255].acked)
+	send_packet (seq);
+}
+
+/************************************************************************
+ *  transmit:
+ *	Send a packet of the window and set its resend time, unless its
+ *	first transmission is to be dropped or held until the next
+ *	packet is sent.
+ ************************************************************************/
+void transmit (uint16_t seq, double now)
+{
+    struct pkt *pk = &win[seq & 255];
+    int first = (pk->sends == 0);
+    double rto;
+
+    rto = rsnd_min * 0.1 * (1 << (pk->sends < 6 ? pk->sends : 6));
+    if (rto > rsnd_max * 0.1) rto = rsnd_max * 0.1;
+    pk->sent = now;
+    pk->due = now + rto;
+    ++pk->sends;
+    if (first && pk->cmd == DT_DATA) {
+	if (loss_left > 0 || percent (loss)) {
+	    loss_left = (loss_left > 0) ? loss_left - 1 : burst - 1;
+	    ++dropped;
+	    return;
+	}
+	if (held < 0 && percent (reorder)) {
+	    held = seq;
+	    ++reordered;
+	    return;
+	}
+    }
+    if (! first) ++resent;
+    send_packet (seq);
+    if (held >= 0 && held != seq) send_held ();
+}
+
+/************************************************************************
+ *  fill_window:
+ *	Send new packets while the window has room: fill packets when
+ *	they are due, then the packets of the buffered seconds, oldest
+ *	first.
+ ************************************************************************/
+void fill_window (double now)
+{
+    struct pkt *pk;
+    uint32_t last = last_complete (now);
+
+    while ((uint16_t)(next_seq - base_seq) < window) {
+	pk = &win[next_seq & 255];
+	if (fills > 0. && now >= next_fill) {
+	    pk->cmd = DT_FILL;
+	    pk->len = qdp_put32 (pk->data, ++fill_seq) - pk->data;
+	    next_fill += 1. / fills;
+	    if (next_fill < now) next_fill = now + 1. / fills;
+	    ++fills_sent;
+	}
+	else {
+	    if (pend_out >= npend) {
+		if (gen_sec > last) break;
+		gen_second (gen_sec++);
+	    }
+	    memcpy (pk, &pend[pend_out++], sizeof(*pk));
+	}
+	pk->acked = 0;
+	pk->sends = 0;
+	transmit (next_seq++, now);
+    }
+    /* Nothing follows a held packet until the next pass.		*/
+    if (held >= 0) send_held ();
+}
+
+/************************************************************************
+ *  resend_due:
+ *	Resend the packets whose acknowledge timed out.
+ *	Return the time of the next timeout.
+ ************************************************************************/
+double resend_due (double now)
+{
+    double next = now + 3600.;
+    uint16_t seq;
+    struct pkt *pk;
+
+    for (seq = base_seq; seq != next_seq; seq++) {
+	pk = &win[seq & 255];
+	if (pk->acked) continue;
+	if (now >= pk->due) transmit (seq, now);
+	if (pk->due < next) next = pk->due;
+    }
+    return next;
+}
+
+/************************************************************************
+ *  process_dack:
+ *	Mark the packets that lib330 acknowledges, advance the window,
+ *	and resend the packets that are missing below acknowledged ones.
+ ************************************************************************/
+void process_dack (const unsigned char *pkt, int len, double now)
+{
+    uint16_t lowseq = get16 (pkt + 10);
+    uint16_t inflight = next_seq - base_seq;
+    uint16_t seq, high = base_seq;
+    int j, have_high = 0;
+
+    if (len < QDP_HDR_LTH + 4 + 16) return;
+    if ((uint16_t)(lowseq - base_seq) < inflight)
+	for (seq = base_seq; seq != (uint16_t)(lowseq + 1); seq++)
+	    win[seq & 255].acked = 1;
+    for (j = 0; j < 128; j++) {
+	if ((get32 (pkt + QDP_HDR_LTH + 4 + 4 * (j >> 5)) & (1u << (j & 31))) == 0) continue;
+	seq = lowseq + j;
+	if ((uint16_t)(seq - base_seq) >= inflight) continue;
+	win[seq & 255].acked = 1;
+	if (! have_high || (uint16_t)(seq - base_seq) > (uint16_t)(high - base_seq)) high = seq;
+	have_high = 1;
+    }
+    while (base_seq != next_seq && win[base_seq & 255].acked)
+	++base_seq;
+    if (! have_high || ! data_open) return;
+    for (seq = base_seq; seq != high && seq != next_seq; seq++)
+	if (! win[seq & 255].acked && now - win[seq & 255].sent >= FAST_RESEND)
+	    transmit (seq, now);
+}
+
+/************************************************************************
+ *  drop_registration:
+ *	Forget the registered server.  Its commands are answered with
+ *	"not registered" until it registers again.
+ ************************************************************************/
+void drop_registration (const char *why, double now)
+{
+    registered = data_open = 0;
+    held = -1;
+    printf ("%s - ", localtime_string(now));
+    printf ("registration dropped: %s\n", why);
+}
+
+/************************************************************************
+ *  process_command:
+ *	Handle one packet of the control port.
+ ************************************************************************/
+void process_command (unsigned char *pkt, int len, struct sockaddr_in *from, double now)
+{
+    unsigned char buf[MAXDATA];
+    unsigned char *p;
+    int cmd = pkt[4];
+    unsigned seq = get16 (pkt + 8);
+    int i;
+
+    host_ctrl = *from;
+    switch (cmd) {
+    case C1_RQSRV:
+	for (i = 0; i < 8; i++)
+	    challenge[i] = qdp_random (&seed);
+	memcpy (buf, challenge, 8);
+	p = qdp_put32 (buf + 8, ntohl(from->sin_addr.s_addr));
+	p = qdp_put16 (p, ntohs(from->sin_port));
+	p = qdp_put16 (p, 0);		/* Registration number.		*/
+	reply (C1_SRVCH, seq, buf, p - buf);
+	return;
+    case C1_SRVRSP:
+	if (len < QDP_HDR_LTH + 16 || memcmp (pkt + QDP_HDR_LTH + 8, challenge, 8) != 0) {
+	    reply_err (seq, CERR_INVREG);
+	    return;
+	}
+	registered = 1;
+	data_open = 0;
+	++registrations;
+	reply (C1_CACK, seq, NULL, 0);
+	printf ("%s - ", localtime_string(now));
+	printf ("registered %s:%d, %u packets in the window\n", inet_ntoa(from->sin_addr),
+		ntohs(from->sin_port), (uint16_t)(next_seq - base_seq));
+	return;
+    case C1_PING:
+	/* Echo the ping with the response type.			*/
+	memcpy (buf, pkt + QDP_HDR_LTH, len - QDP_HDR_LTH);
+	if (len >= QDP_HDR_LTH + 2)
+	    qdp_put16 (buf, get16 (buf) + 1);
+	reply (C1_PING, seq, buf, len - QDP_HDR_LTH);
+	return;
+    }
+    if (! registered) {
+	reply_err (seq, CERR_NOTR);
+	return;
+    }
+    switch (cmd) {
+    case C1_DSRV:
+	reply (C1_CACK, seq, NULL, 0);
+	drop_registration ("deregistered by the server", now);
+	break;
+    case C1_RQFGLS:
+	send_fgls (seq);
+	break;
+    case C1_RQGID:
+	memset (buf, 0, GID_LTH);
+	reply (C1_GID, seq, buf, GID_LTH);
+	break;
+    case C1_RQSTAT:
+	if (len < QDP_HDR_LTH + 4) {
+	    reply_err (seq, CERR_PAR);
+	    break;
+	}
+	send_status (seq, get32 (pkt + QDP_HDR_LTH), now);
+	break;
+    case C1_RQLOG:
+	p = put_log (buf);
+	reply (C1_LOG, seq, buf, p - buf);
+	break;
+    case C1_SLOG:
+	/* Keep the window and timeouts, the channels are fixed.	*/
+	if (len >= QDP_HDR_LTH + LOG_LTH) {
+	    p = pkt + QDP_HDR_LTH;
+	    rsnd_max = get16 (p + 10);
+	    rsnd_min = get16 (p + 14);
+	    if (get16 (p + 16) >= 1 && get16 (p + 16) <= MAX_WINDOW)
+		window = get16 (p + 16);
+	    ack_cnt = get16 (p + 32);
+	    ack_to = get16 (p + 34);
+	}
+	reply (C1_CACK, seq, NULL, 0);
+	break;
+    case C1_RQMEM:
+	if (len < QDP_HDR_LTH + 8) {
+	    reply_err (seq, CERR_PAR);
+	    break;
+	}
+	send_memory (seq, pkt + QDP_HDR_LTH);
+	break;
+    case C1_UMSG:
+    case C1_WEB:
+	reply (C1_CACK, seq, NULL, 0);
+	break;
+    default:
+	reply_err (seq, CERR_PAR);
+	break;
+    }
+}
+
+/************************************************************************
+ *  process_data:
+ *	Handle one packet of the data port.
+ ************************************************************************/
+void process_data (unsigned char *pkt, int len, struct sockaddr_in *from, double now)
+{
+    uint16_t seq;
+
+    if (! registered) return;
+    host_data = *from;
+    switch (pkt[4]) {
+    case DT_OPEN:
+	if (! data_open) {
+	    printf ("%s - ", localtime_string(now));
+	    printf ("DT_OPEN from %s:%d, data sequence %u\n", inet_ntoa(from->sin_addr),
+		    ntohs(from->sin_port), base_seq);
+	    kill_at = now + kill_secs;
+	}
+	data_open = 1;
+	for (seq = base_seq; seq != next_seq; seq++)
+	    win[seq & 255].due = now;
+	break;
+    case DT_DACK:
+	process_dack (pkt, len, now);
+	break;
+    }
+}
+
+/************************************************************************
+ *  read_socket:
+ *	Read and handle every packet waiting on a socket.
+ ************************************************************************/
+void read_socket (int fd, double now)
+{
+    unsigned char pkt[QDP_HDR_LTH + MAXDATA + 64];
+    struct sockaddr_in from;
+    socklen_t fromlen;
+    int n;
+
+    for (;;) {
+	fromlen = sizeof(from);
+	n = recvfrom (fd, pkt, sizeof(pkt), 0, (struct sockaddr *)&from, &fromlen);
+	if (n < 0) return;
+	if (n < QDP_HDR_LTH || get16 (pkt + 6) != n - QDP_HDR_LTH
+	    || get32 (pkt) != qdp_crc (pkt + 4, n - 4))
+	    continue;
+	if (fd == ctrl_sock)
+	    process_command (pkt, n, &from, now);
+	else
+	    process_data (pkt, n, &from, now);
+    }
+}
+
+/************************************************************************
+ *  open_udp:
+ *	Return a non-blocking UDP socket bound to ifaddr:port.
+ ************************************************************************/
+int open_udp (struct in_addr ifaddr, int port)
+{
+    struct sockaddr_in addr;
+    int fd, on = 1;
+
+    memset (&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr = ifaddr;
+    addr.sin_port = htons(port);
+    if ((fd = socket (AF_INET, SOCK_DGRAM, 0)) < 0
+	|| setsockopt (fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)) < 0
+	|| bind (fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+	fprintf (stderr, "Unable to bind port %d: %s\n", port, strerror(errno));
+	exit(1);
+    }
+    fcntl (fd, F_SETFL, O_NONBLOCK);
+    return fd;
+}
+
+/************************************************************************
+ *  main procedure
+ ************************************************************************/
+int main (int argc, char **argv)
+{
+    char *ifaddr = "127.0.0.2";
+    char *rate_list = DEFAULT_RATES;
+    int baseport = DEFAULT_BASEPORT;
+    struct in_addr iface;
+    struct pollfd fds[2];
+    double now, wake, next_print, next_due;
+    uint64_t last_packets = 0, last_bytes = 0;
+    uint32_t last;
+    char *p, *token, *dot;
+    int i, j, c, rate;
+    struct lcq *q;
+
+    /* Variables needed for getopt. */
+    extern char	*optarg;
+    extern int	optind, opterr;
+    int		ch;
+
+    setlinebuf(stdout);
+    cmdname = basename(strdup(argv[0]));
+    while ( (ch = getopt(argc,argv,"hb:i:p:g:s:x:B:M:w:L:G:R:F:K:r:")) != -1)
+	switch (ch) {
+	case '?':
+	case 'h':   print_syntax(cmdname,syntax,stdout); exit(1);
+	case 'b':   baseport = atoi(optarg); break;
+	case 'i':   ifaddr = optarg; break;
+	case 'p':   dataport = atoi(optarg); break;
+	case 'g':   nchan = atoi(optarg); break;
+	case 's':   rate_list = optarg; break;
+	case 'x':   speed = atof(optarg); break;
+	case 'B':   backlog = atoi(optarg); break;
+	case 'M':   buffer = atoi(optarg); break;
+	case 'w':   window = atoi(optarg); break;
+	case 'L':   loss = atof(optarg); break;
+	case 'G':   burst = atoi(optarg); break;
+	case 'R':   reorder = atof(optarg); break;
+	case 'F':   fills = atof(optarg); break;
+	case 'K':   kill_secs = atof(optarg); break;
+	case 'r':   seed = strtoul(optarg, NULL, 0); break;
+	default:
+	    fprintf (stderr, "Unsupported option: -%c\n", ch);
+	    exit(1);
+	}
+
+    /*	Skip over all options and their arguments.			*/
+    argv = &(argv[optind]);
+    argc -= optind;
+
+    if (argc != 1) {
+	print_syntax(cmdname,syntax,stdout);
+	exit(1);
+    }
+    if (nchan < 1 || nchan > MAX_CHAN || speed <= 0. || backlog < 0 || buffer < 1
+	|| backlog > buffer || buffer > SEQ_OFFSET / 2 || window < 1 || window > MAX_WINDOW
+	|| loss < 0. || loss > 100. || burst < 1 || reorder < 0. || reorder > 100.
+	|| fills < 0. || kill_secs < 0. || seed == 0 || dataport < 1 || dataport > 4
+	|| baseport <= 0 || baseport + 2 * dataport + 1 > 65535) {
+	fprintf (stderr, "Invalid option value\n");
+	exit(1);
+    }
+    if (inet_pton (AF_INET, ifaddr, &iface) != 1) {
+	fprintf (stderr, "Invalid interface address: %s\n", ifaddr);
+	exit(1);
+    }
+    upshift(argv[0]);
+    if ((dot = strchr (argv[0], '.')) == NULL || dot - argv[0] > 2 || strlen(dot+1) > 5
+	|| dot == argv[0] || dot[1] == '\0') {
+	fprintf (stderr, "Invalid NET.STA: %s\n", argv[0]);
+	exit(1);
+    }
+    strncpy (network, argv[0], dot - argv[0]);
+    strcpy (station, dot + 1);
+
+    for (p = strdup(rate_list); (token = strtok(p, ",")) != NULL; p = NULL) {
+	rate = atoi(token);
+	for (j = 0; j < MAX_RATES - 1 && FREQTAB[j] != rate; j++) ;
+	if (j == MAX_RATES - 1) {
+	    for (i = 0; i < 3 && HIGHTAB[i].rate != rate; i++) ;
+	    if (i == 3 || freq7 != 0) {
+		fprintf (stderr, "Invalid sample rate, or a second one above 200: %s\n", token);
+		exit(1);
+	    }
+	    freq7 = HIGHTAB[i].code;
+	}
+	for (i = 0; i < nrates && rates[i] != rate; i++) ;
+	if (i < nrates) {
+	    fprintf (stderr, "Repeated sample rate: %s\n", token);
+	    exit(1);
+	}
+	rates[nrates++] = rate;
+    }
+    if (nrates == 0) {
+	fprintf (stderr, "No sample rates\n");
+	exit(1);
+    }
+
+    /* One LCQ per channel and rate, named by band code, with the	*/
+    /* second set of 3 channels in location 10.				*/
+    for (c = 0; c < nchan; c++) {
+	for (i = 0; i < nrates; i++) {
+	    q = &lcqs[nlcq++];
+	    rate = rates[i];
+	    q->chan = c;
+	    q->rate = rate;
+	    for (j = 0; j < MAX_RATES - 1 && FREQTAB[j] != rate; j++) ;
+	    q->freqbit = (j < MAX_RATES - 1) ? j : HIGH_FREQ_BIT;
+	    strcpy (q->loc, (c < 3) ? "00" : "10");
+	    q->name[0] = (rate >= 1000) ? 'F' : (rate >= 250) ? 'C' : (rate >= 80) ? 'H'
+		: (rate >= 10) ? 'B' : 'L';
+	    q->name[1] = 'H';
+	    q->name[2] = ORIENT[c % 3];
+	    q->name[3] = '\0';
+	}
+    }
+    build_tokens ();
+
+    ctrl_sock = open_udp (iface, baseport + 2 * dataport);
+    data_sock = open_udp (iface, baseport + 2 * dataport + 1);
+
+    signal (SIGHUP, finish_handler);
+    signal (SIGINT, finish_handler);
+    signal (SIGQUIT, finish_handler);
+    signal (SIGTERM, finish_handler);
+    signal (SIGPIPE, SIG_IGN);
+
+    start_time = dtime ();
+    sec_offset = (uint32_t)(start_time - Q330_EPOCH) - SEQ_OFFSET;
+    gen_sec = last_complete (start_time) + 1 - backlog;
+    next_fill = start_time;
+    printf ("%s - %s version %s for %s.%s on %s:%d and %d, %d channels at %s sps, speed %.1f\n",
+	    localtime_string(start_time), cmdname, VERSION, network, station, ifaddr,
+	    baseport + 2 * dataport, baseport + 2 * dataport + 1, nchan, rate_list, speed);
+
+    next_print = start_time + STATUS_INTERVAL;
+    while (! terminate_proc) {
+	now = dtime ();
+
+	/* The buffer drops its oldest seconds once it is full.		*/
+	last = last_complete (now);
+	if (gen_sec + buffer <= last) {
+	    overflow += last - buffer + 1 - gen_sec;
+	    gen_sec = last - buffer + 1;
+	}
+
+	next_due = now + 3600.;
+	if (registered && data_open) {
+	    if (kill_secs > 0. && now >= kill_at)
+		drop_registration ("-K", now);
+	    else {
+		fill_window (now);
+		next_due = resend_due (now);
+	    }
+	}
+
+	if (now >= next_print) {
+	    printf ("%s - %s, %llu seconds, %llu packets, %.1f packets/sec, %.1f kbit/sec, "
+		    "%llu resent, %llu dropped, %llu reordered, %d registrations",
+		    localtime_string(now), (registered && data_open) ? "streaming" : "waiting",
+		    (unsigned long long)seconds, (unsigned long long)packets,
+		    (packets - last_packets) / (now - next_print + STATUS_INTERVAL),
+		    (bytes - last_bytes) * 8. / 1000. / (now - next_print + STATUS_INTERVAL),
+		    (unsigned long long)resent, (unsigned long long)dropped,
+		    (unsigned long long)reordered, registrations);
+	    if (fills > 0.)
+		printf (", %llu fills", (unsigned long long)fills_sent);
+	    if (overflow > 0)
+		printf (", %llu seconds lost to buffer overflow", (unsigned long long)overflow);
+	    printf (", %u seconds behind\n", last + 1 - gen_sec);
+	    last_packets = packets;
+	    last_bytes = bytes;
+	    next_print = now + STATUS_INTERVAL;
+	}
+
+	/* Wait for lib330, the next second of data, or a timer.	*/
+	fds[0].fd = ctrl_sock;
+	fds[1].fd = data_sock;
+	fds[0].events = fds[1].events = POLLIN;
+	wake = next_print;
+	if (registered && data_open) {
+	    double t = start_time + (floor(data_time(now)) + 1. - start_time) / speed;
+	    if (t < wake) wake = t;
+	    if (next_due < wake) wake = next_due;
+	    if (fills > 0. && next_fill < wake) wake = next_fill;
+	    if (kill_secs > 0. && kill_at < wake) wake = kill_at;
+	}
+	if (poll (fds, 2, (wake > now) ? (int)ceil((wake - now) * 1000.) : 0) < 0) continue;
+	now = dtime ();
+	if (fds[0].revents & POLLIN) read_socket (ctrl_sock, now);
+	if (fds[1].revents & POLLIN) read_socket (data_sock, now);
+    }
+
+    printf ("%s - %s terminated, sent %llu seconds in %llu packets, %llu resent\n",
+	    localtime_string(dtime()), cmdname, (unsigned long long)seconds,
+	    (unsigned long long)packets, (unsigned long long)resent);
+    close (ctrl_sock);
+    close (data_sock);
+    return (0);
+}
+
+/************************************************************************
+ *  print_syntax:
+ *	Print the syntax description of program.
+ ************************************************************************/
+int print_syntax (char	*cmd,		/* program name.			*/
+		  char	*syntax[],	/* syntax array.			*/
+		  FILE	*fp)		/* FILE ptr for output.			*/
+{
+    int i;
+    for (i=0; syntax[i] != NULL; i++) {
+	fprintf (fp, syntax[i], cmd);
+	fprintf (fp, "\n");
+    }
+    return (0);
+}
+
+/************************************************************************
+ *  finish_handler:
+ *	Signal handler to terminate the program.
+ ************************************************************************/
+void finish_handler (int sig)
+{
+    signal (sig, finish_handler);
+    terminate_proc = 1;
+}
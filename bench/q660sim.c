@@ -0,0 +1,848 @@
+/************************************************************************
+ *  q660sim - Fake Q660 data logger for lib660 and q8serv.
+ *
+ *  q660sim accepts the TCP connection of lib660 on the data port of a
+ *  Q660, baseport+2, and on the internal data logger port, baseport+5,
+ *  that lib660 uses for a local address.  It answers the registration
+ *  with a challenge and a configuration of synthetic main digitizer
+ *  channels, and after lib660 asks for packet mode streams one DT_DATA
+ *  second of compressed blockettes per second, and DT_STATUS packets
+ *  at the requested status interval.  A resume time in the registration
+ *  is answered with backfill from that second, up to a limit.
+ *
+ *  To load lib660 harder than a real Q660, the data clock can run
+ *  faster than real time, and DT_DATA packets can be dropped or
+ *  delivered out of order, and the connection dropped, at given rates,
+ *  to exercise the continuity and backfill code.
+ *
+ *  With -l the compressed blockettes of every rate above 1 sps are sent
+ *  as low latency segments of a tenth of a second, each with its
+ *  previous sample and the offset of its first sample in the second,
+ *  which lib660 passes to its low latency callback and dataserver.
+ *
+ *  The hash of the registration is not checked, and only the status
+ *  monitor block of the status packets is sent.
+ ************************************************************************/
+
+/* Modification History:
+------------------------------------------------------------------------
+    2026.292     ver 1.0.0	Initial version.
+    2026.292     ver 1.1.0	Added -l for low latency segments.
+*/
+
+#define	VERSION		"1.1.0 (2026.292)"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include <unistd.h>
+#include <string.h>
+#include <signal.h>
+#include <libgen.h>
+#include <math.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#include "cslimits.h"
+#include "cstypes.h"
+#include "stuff.h"
+#include "timeutil.h"
+#include "qdputil.h"
+
+#define	Q660_EPOCH	1451606400.	/* 2016-01-01 in seconds since 1970.	*/
+#define	DEFAULT_BASEPORT 5330
+#define	DEFAULT_NCHAN	3
+#define	DEFAULT_RATES	"100,40,1"
+#define	DEFAULT_BACKFILL 3600
+#define	STATUS_INTERVAL	10		/* Seconds between status messages.	*/
+#define	MAX_CHAN	6		/* Main digitizer channels.		*/
+#define	FREQS		10		/* Q660 sample rates.			*/
+
+/* QDP packets.								*/
+#define	QDP_VER		3
+#define	QDP_HDR_LTH	4
+#define	MAXDATA		1024
+#define	DT_DATA		0
+#define	DT_STATUS	2
+#define	DT_DISCON	3
+#define	GDS_TIM		0
+#define	GDS_MD		1
+#define	IB_EOS		0xFF
+#define	DHOF_MORE	0x20
+#define	DHOF_OFF	0x40
+#define	DHOF_PREV	0x80
+#define	SEG_WORDS	192		/* Data words in one blockette segment.	*/
+#define	LL_SEGS		10		/* Low latency segments per second.	*/
+#define	SM_LTH		88		/* Status monitor block.		*/
+
+#define	OUTBUF_SIZE	(1024*1024)
+#define	OUT_LOW		(64*1024)	/* Generate data below this backlog.	*/
+#define	INBUF_SIZE	16384
+#define	CFG_MINSIZE	4096		/* Bytes of configuration.		*/
+
+char *syntax[] = {
+"%s version " VERSION,
+"%s [-b baseport] [-i ifaddr] [-g nchan] [-s rates] [-x speed] [-B backfill]",
+"    [-L loss%%] [-R reorder%%] [-D seconds] [-K seconds] [-r seed] [-l] [-h] NET.STA",
+"    where:",
+"	-b baseport Base port of the Q660 (default 5330).  lib660 connects to",
+"		    baseport+2, or to baseport+5 for 127.0.0.1.",
+"	-i ifaddr   Listen on the interface with this address (default 127.0.0.1).",
+"	-g nchan    Number of main digitizer channels, 1 to 6 (default 3).",
+"	-s rates    Comma-delimited list of the sample rates of every channel,",
+"		    from 1,10,20,40,50,100,200,250,500,1000 (default 100,40,1).",
+"	-x speed    Run the data clock speed times faster than real time.",
+"	-B backfill Maximum seconds of backfill for a resume request (default 3600).",
+"	-L loss%%    Percentage of DT_DATA packets that are dropped.",
+"	-R reorder%% Percentage of DT_DATA packets that are sent after the next one.",
+"	-D seconds  Send a DT_DISCON request this many seconds after streaming starts.",
+"	-K seconds  Close the connection this many seconds after streaming starts.",
+"	-r seed	    Seed of the packet loss and reordering (default 1).",
+"	-l	    Send low latency segments with sample offsets, for the",
+"		    lib660 low latency callback.",
+"	-h	    Print brief help message for syntax.",
+"	NET.STA	    SEED network and station of the configuration.",
+"Examples:",
+"	q660sim -b 6000 -g 6 -s 1000,200,100 XX.B001",
+"			18 channels for lib660 with baseport 6000.",
+"	q660sim -L 0.5 -K 300 XX.B001",
+"			drop 0.5%% of the packets, reconnect every 5 minutes.",
+NULL };
+
+enum conn_state { CS_REQ, CS_RESP, CS_CFG, CS_RUN, CS_DISCON };
+
+static const int FREQTAB[FREQS] = {1, 10, 20, 40, 50, 100, 200, 250, 500, 1000};
+static const char ORIENT[MAX_CHAN+1] = "ZNE123";
+
+char *cmdname;				/* Name of this program.	*/
+int terminate_proc;
+
+char network[3];
+char station[6];
+int nchan = DEFAULT_NCHAN;
+int rates[FREQS];			/* Sample rates of every channel. */
+int freqnum[FREQS];			/* Their index in FREQTAB.	*/
+int nrates;
+double speed = 1.;
+double start_time;
+int backfill = DEFAULT_BACKFILL;
+double loss, reorder;			/* Percentages.			*/
+double discon_secs, kill_secs;
+unsigned seed = 1;
+int lowlat;				/* Send low latency segments.	*/
+
+int conn = -1;				/* lib660 connection.		*/
+enum conn_state state;
+char inbuf[INBUF_SIZE+1];
+int inlen;
+unsigned char *outbuf;
+int outlen, outoff;
+unsigned char held[MAXDATA];		/* Packet sent after the next one. */
+int held_lth;
+uint32_t resume;			/* Requested start second.	*/
+uint32_t next_sec;			/* Next second to send.		*/
+int status_interval = 10;
+double next_status_pkt, discon_at, kill_at;
+unsigned char pkt_seq;
+
+uint64_t packets, bytes, seconds, dropped, reordered;
+int connections;
+
+int print_syntax (char *cmd, char *syntax[], FILE *fp);
+void finish_handler (int sig);
+
+/************************************************************************
+ *  data_time:
+ *	Return the time of the data clock, in seconds since 1970.
+ ************************************************************************/
+double data_time (double now)
+{
+    return start_time + (now - start_time) * speed;
+}
+
+/************************************************************************
+ *  last_complete:
+ *	Return the last second of data that is complete, in Q660 seconds.
+ ************************************************************************/
+uint32_t last_complete (double now)
+{
+    return (uint32_t)(floor(data_time(now) - Q660_EPOCH) - 1);
+}
+
+/************************************************************************
+ *  q660_time_string:
+ *	Return a string of a time in Q660 seconds.
+ ************************************************************************/
+char *q660_time_string (uint32_t sec)
+{
+    return localtime_string ((double)sec + Q660_EPOCH);
+}
+
+/************************************************************************
+ *  queue_out:
+ *	Append bytes to the output buffer of the connection.
+ ************************************************************************/
+void queue_out (const void *buf, int len)
+{
+    if (outoff > 0 && outlen + len > OUTBUF_SIZE) {
+	memmove (outbuf, outbuf + outoff, outlen - outoff);
+	outlen -= outoff;
+	outoff = 0;
+    }
+    if (outlen + len > OUTBUF_SIZE) {
+	fprintf (stderr, "Output buffer overflow\n");
+	exit(1);
+    }
+    memcpy (outbuf + outlen, buf, len);
+    outlen += len;
+}
+
+/************************************************************************
+ *  queue_packet:
+ *	Frame a QDP packet of len bytes of data and queue it.
+ ************************************************************************/
+void queue_packet (int cmd, const unsigned char *data, int len)
+{
+    unsigned char pkt[QDP_HDR_LTH + MAXDATA + 4];
+    unsigned char *p = pkt;
+
+    p = qdp_put8 (p, (QDP_VER << 5) | cmd);
+    p = qdp_put8 (p, pkt_seq++);
+    p = qdp_put8 (p, len / 4 - 1);
+    p = qdp_put8 (p, ~(len / 4 - 1));
+    memcpy (p, data, len);
+    p += len;
+    p = qdp_put32 (p, qdp_crc (pkt, QDP_HDR_LTH + len));
+    queue_out (pkt, p - pkt);
+    ++packets;
+    bytes += p - pkt;
+}
+
+/************************************************************************
+ *  percent:
+ *	Return 1 with a probability of pct percent.
+ ************************************************************************/
+int percent (double pct)
+{
+    return pct > 0. && (qdp_random (&seed) % 1000000) < pct * 10000.;
+}
+
+/************************************************************************
+ *  send_data:
+ *	Queue a DT_DATA packet, unless it is to be dropped or reordered.
+ ************************************************************************/
+void send_data (const unsigned char *data, int len)
+{
+    if (percent (loss)) {
+	++dropped;
+	return;
+    }
+    if (held_lth == 0 && percent (reorder)) {
+	memcpy (held, data, len);
+	held_lth = len;
+	++reordered;
+	return;
+    }
+    queue_packet (DT_DATA, data, len);
+    if (held_lth > 0) {
+	queue_packet (DT_DATA, held, held_lth);
+	held_lth = 0;
+    }
+}
+
+/************************************************************************
+ *  put_blockette:
+ *	Append a compressed blockette segment of nw data words to the
+ *	DT_DATA packet pkt, which is filled up to p, after sending the
+ *	packet if it is full.  prev is the previous sample, or NULL, and
+ *	sampoff the offset of the first sample in the second, or -1.
+ *	Return the end of the packet.
+ ************************************************************************/
+unsigned char *put_blockette (unsigned char *pkt, unsigned char *p, uint32_t sec, int id,
+			      int more, const int32_t *prev, int sampoff,
+			      const unsigned char *codes, const uint32_t *words, int nw)
+{
+    unsigned char map[QDP_MAXWORDS/4 + 8];
+    int i, hdr, offset, size;
+
+    hdr = 4 + ((prev != NULL) ? 4 : 0) + ((sampoff >= 0) ? 2 : 0);
+    memset (map, 0, sizeof(map));
+    qdp_map (codes, nw, map);
+    offset = (hdr + (nw + 3) / 4 + 3) & ~3;
+    size = offset + nw * 4;
+    if (p - pkt + size > MAXDATA) {
+	send_data (pkt, p - pkt);
+	p = qdp_put32 (pkt, sec);
+    }
+    p = qdp_put8 (p, GDS_MD);
+    p = qdp_put8 (p, ((id / FREQS) << 4) | (id % FREQS));
+    p = qdp_put8 (p, (offset / 4) | (more ? DHOF_MORE : 0)
+		  | ((sampoff >= 0) ? DHOF_OFF : 0) | ((prev != NULL) ? DHOF_PREV : 0));
+    p = qdp_put8 (p, size / 4 - 1);
+    if (prev != NULL) p = qdp_put32 (p, *prev);
+    if (sampoff >= 0) p = qdp_put16 (p, sampoff);
+    memcpy (p, map, offset - hdr);
+    p += offset - hdr;
+    for (i = 0; i < nw; i++)
+	p = qdp_put32 (p, words[i]);
+    return p;
+}
+
+/************************************************************************
+ *  send_second:
+ *	Send the DT_DATA packets of one second: a timing blockette, a
+ *	compressed blockette of every channel and rate, split into
+ *	segments that fit a packet, and the end of second blockette.
+ *	1 sps data are sent in blocks of 10 samples, in the last second
+ *	of each block.  With -l the other rates are sent in LL_SEGS
+ *	low latency segments, each compressed on its own.
+ ************************************************************************/
+void send_second (uint32_t sec)
+{
+    static int32_t diffs[1000];
+    static unsigned char codes[QDP_MAXWORDS];
+    static uint32_t words[QDP_MAXWORDS];
+    unsigned char pkt[MAXDATA];
+    unsigned char *p;
+    int c, r, i, w, nw, nwords, id, nsamp, seg, first;
+    int32_t prev, last, x;
+    int64_t n0;
+
+    p = qdp_put32 (pkt, sec);
+    p = qdp_put8 (p, GDS_TIM);
+    p = qdp_put8 (p, 100);		/* Clock quality.		*/
+    p = qdp_put16 (p, 0);		/* Minutes since loss.		*/
+    p = qdp_put32 (p, 0);		/* Flags and usec offset.	*/
+
+    for (c = 0; c < nchan; c++) {
+	for (r = 0; r < nrates; r++) {
+	    id = c * FREQS + freqnum[r];
+	    if (rates[r] == 1) {
+		if (sec % 10 != 9) continue;
+		n0 = sec - 9;
+		nsamp = 10;
+	    }
+	    else {
+		n0 = (int64_t)sec * rates[r];
+		nsamp = rates[r];
+	    }
+	    if (lowlat && rates[r] > 1) {
+		seg = (nsamp + LL_SEGS - 1) / LL_SEGS;
+		for (first = 0; first < nsamp; first += seg) {
+		    prev = last = qdp_sample (id, rates[r], n0 + first - 1);
+		    for (i = 0; i < seg && first + i < nsamp; i++) {
+			x = qdp_sample (id, rates[r], n0 + first + i);
+			diffs[i] = x - last;
+			last = x;
+		    }
+		    nwords = qdp_compress (diffs, i, codes, words);
+		    p = put_blockette (pkt, p, sec, id, first + seg < nsamp, &prev, first,
+				       codes, words, nwords);
+		}
+		continue;
+	    }
+	    prev = last = qdp_sample (id, rates[r], n0 - 1);
+	    for (i = 0; i < nsamp; i++) {
+		x = qdp_sample (id, rates[r], n0 + i);
+		diffs[i] = x - last;
+		last = x;
+	    }
+	    nwords = qdp_compress (diffs, nsamp, codes, words);
+	    for (w = 0; w < nwords; w += nw) {
+		nw = (nwords - w > SEG_WORDS) ? SEG_WORDS : nwords - w;
+		p = put_blockette (pkt, p, sec, id, w + nw < nwords, (w == 0) ? &prev : NULL, -1,
+				   codes + w, words + w, nw);
+	    }
+	}
+    }
+
+    if (p - pkt + 4 > MAXDATA) {
+	send_data (pkt, p - pkt);
+	p = qdp_put32 (pkt, sec);
+    }
+    p = qdp_put32 (p, (uint32_t)IB_EOS << 24);
+    send_data (pkt, p - pkt);
+    ++seconds;
+}
+
+/************************************************************************
+ *  send_status:
+ *	Send a DT_STATUS packet with the status monitor block.
+ ************************************************************************/
+void send_status (double now)
+{
+    unsigned char pkt[4 + SM_LTH];
+    unsigned char *p = pkt;
+    int i;
+
+    p = qdp_put32 (p, 1);		/* Mask of ST_SM.		*/
+    p = qdp_put8 (p, 0);		/* ST_SM.			*/
+    p = qdp_put8 (p, 0);		/* Flags.			*/
+    p = qdp_put8 (p, 2);		/* PLL locked.			*/
+    p = qdp_put8 (p, SM_LTH / 4 - 1);
+    p = qdp_put8 (p, 0);		/* GPIO 1 and 2.		*/
+    p = qdp_put8 (p, 0);
+    p = qdp_put8 (p, 0);		/* Packet buffer percent.	*/
+    p = qdp_put8 (p, 30);		/* Humidity.			*/
+    for (i = 0; i < 2 + 6; i++)
+	p = qdp_put16 (p, 0);		/* Sensor currents and booms.	*/
+    p = qdp_put16 (p, 100);		/* System current.		*/
+    p = qdp_put16 (p, 20);		/* Antenna current.		*/
+    p = qdp_put16 (p, 1250);		/* Input volts.			*/
+    p = qdp_put16 (p, 25);		/* System temperature.		*/
+    p = qdp_put32 (p, 0);		/* Spare.			*/
+    p = qdp_put32 (p, 0);		/* Seconds and usec offset.	*/
+    p = qdp_put32 (p, 0);
+    p = qdp_put32 (p, (uint32_t)(now - start_time));	/* Total time.	*/
+    p = qdp_put32 (p, (uint32_t)(now - start_time));	/* Power time.	*/
+    p = qdp_put32 (p, 0);		/* Last resync and resyncs.	*/
+    p = qdp_put32 (p, 0);
+    p = qdp_put16 (p, 0);		/* Clock loss.			*/
+    p = qdp_put16 (p, 0);		/* Gain status.			*/
+    p = qdp_put16 (p, 0);		/* Sensor control map.		*/
+    p = qdp_put8 (p, 0);		/* Fault code.			*/
+    p = qdp_put8 (p, 0);
+    p = qdp_put8 (p, 0);		/* GPS power and fix.		*/
+    p = qdp_put8 (p, 0);
+    p = qdp_put8 (p, 100);		/* Clock quality.		*/
+    p = qdp_put8 (p, 0);		/* Calibration status.		*/
+    for (i = 0; i < 3; i++)
+	p = qdp_put32 (p, 0);		/* Elevation, latitude, longitude. */
+    p = qdp_put16 (p, 0);		/* Antenna volts.		*/
+    p = qdp_put16 (p, 0);
+    queue_packet (DT_STATUS, pkt, p - pkt);
+}
+
+/************************************************************************
+ *  send_xml:
+ *	Queue an XML message.
+ ************************************************************************/
+void send_xml (const char *s)
+{
+    queue_out (s, strlen(s));
+}
+
+/************************************************************************
+ *  send_config:
+ *	Send the configuration of the channels in reply to a registration.
+ *	cfgsize is the size of the whole reply.
+ ************************************************************************/
+void send_config (void)
+{
+    static char xml[65536];
+    char freqs[64];
+    char *p = xml;
+    char *end = xml + sizeof(xml);
+    char *cfgsize;
+    int c, r;
+    char band;
+
+    freqs[0] = '\0';
+    for (r = 0; r < nrates; r++)
+	sprintf (freqs + strlen(freqs), "%s%d", (r > 0) ? "," : "", rates[r]);
+
+    p += snprintf (p, end - p, "<Q660_Data>\r\n");
+    cfgsize = p;
+    p += snprintf (p, end - p, "<cfgsize>%08d</cfgsize>\r\n", 0);
+    p += snprintf (p, end - p, "<sysinfo>\r\n <reboots>1</reboots>\r\n <boot>%u</boot>\r\n"
+		   " <spslimit>1000</spslimit>\r\n <BE_version>1.0.0</BE_version>\r\n"
+		   " <FE_version>1.0.0</FE_version>\r\n <property_tag>q660sim</property_tag>\r\n"
+		   "</sysinfo>\r\n", (unsigned)(start_time - Q660_EPOCH));
+    p += snprintf (p, end - p, "<maindigi>\r\n");
+    for (c = 0; c < nchan; c++)
+	p += snprintf (p, end - p, " <chan%d>\r\n  <freqs>%s</freqs>\r\n  <gain>1</gain>\r\n"
+		       "  <linear_below>All</linear_below>\r\n </chan%d>\r\n", c + 1, freqs, c + 1);
+    p += snprintf (p, end - p, "</maindigi>\r\n");
+    p += snprintf (p, end - p, "<seed>\r\n <cfgname>q660sim</cfgname>\r\n"
+		   " <network>%s</network>\r\n <station>%s</station>\r\n", network, station);
+    for (c = 0; c < nchan; c++) {
+	for (r = 0; r < nrates; r++) {
+	    band = (rates[r] >= 1000) ? 'F' : (rates[r] >= 250) ? 'C'
+		: (rates[r] >= 80) ? 'H' : (rates[r] >= 10) ? 'B' : 'L';
+	    p += snprintf (p, end - p, " <chan>\r\n  <name>%02d-%cH%c</name>\r\n"
+			   "  <source>MD%d,%d</source>\r\n </chan>\r\n",
+			   r, band, ORIENT[c], c + 1, rates[r]);
+	}
+    }
+    p += snprintf (p, end - p, "</seed>\r\n");
+    /* lib660 reads the first 2000 bytes line by line, and only checks	*/
+    /* the size of the rest after another receive, so the reply is	*/
+    /* padded with lines that the XML reader skips.			*/
+    while (p - xml < CFG_MINSIZE && p < end)
+	p += snprintf (p, end - p, "<?pad?>\r\n");
+    p += snprintf (p, end - p, "</Q660_Data>\r\n");
+    if (p >= end) {
+	fprintf (stderr, "Configuration too large\n");
+	exit(1);
+    }
+    snprintf (freqs, sizeof(freqs), "%08d", (int)(p - xml));
+    memcpy (cfgsize + strlen("<cfgsize>"), freqs, 8);
+    queue_out (xml, p - xml);
+}
+
+/************************************************************************
+ *  close_conn:
+ *	Close the connection to lib660.
+ ************************************************************************/
+void close_conn (const char *why)
+{
+    printf ("%s - connection closed: %s\n", localtime_string(dtime()), why);
+    close (conn);
+    conn = -1;
+    outlen = outoff = inlen = held_lth = 0;
+}
+
+/************************************************************************
+ *  start_stream:
+ *	Start packet mode from the requested second, limited to the
+ *	backfill, or from the last complete second.
+ ************************************************************************/
+void start_stream (double now)
+{
+    uint32_t last = last_complete (now);
+
+    if (resume == 0 || resume > last)
+	next_sec = last;
+    else if (last - resume > (uint32_t)backfill)
+	next_sec = last - backfill;
+    else
+	next_sec = resume;
+    printf ("%s - ", localtime_string(now));
+    printf ("streaming from %s, %u seconds of backfill\n", q660_time_string(next_sec),
+	    last - next_sec);
+    state = CS_RUN;
+    next_status_pkt = now;
+    discon_at = now + discon_secs;
+    kill_at = now + kill_secs;
+}
+
+/************************************************************************
+ *  process_message:
+ *	Handle one XML message of lib660.
+ ************************************************************************/
+void process_message (char *msg, double now)
+{
+    char challenge[17];
+    char s[256];
+    char *pc;
+    int i;
+
+    if (state == CS_REQ && strstr (msg, "<regreq>")) {
+	for (i = 0; i < 16; i++)
+	    challenge[i] = "0123456789ABCDEF"[qdp_random (&seed) & 15];
+	challenge[16] = '\0';
+	snprintf (s, sizeof(s), "<Q660_Data>\r\n<challenge>%s</challenge>\r\n</Q660_Data>\r\n",
+		  challenge);
+	send_xml (s);
+	state = CS_RESP;
+    }
+    else if (state == CS_RESP && strstr (msg, "<regresp>")) {
+	resume = 0;
+	if ((pc = strstr (msg, "<resume>")) != NULL || (pc = strstr (msg, "<start>")) != NULL)
+	    resume = strtoul (strchr (pc, '>') + 1, NULL, 10);
+	send_config ();
+	state = CS_CFG;
+	printf ("%s - ", localtime_string(now));
+	printf ("registered, start %s\n", (resume > 0) ? q660_time_string(resume) : "now");
+    }
+    if ((pc = strstr (msg, "<interval>")) != NULL) {
+	status_interval = atoi (pc + strlen("<interval>"));
+	if (status_interval <= 0) status_interval = 1;
+    }
+    if ((pc = strstr (msg, "<packet_mode>")) != NULL && state == CS_CFG
+	&& atoi (pc + strlen("<packet_mode>")) == 1)
+	start_stream (now);
+}
+
+/************************************************************************
+ *  read_conn:
+ *	Read from lib660 and handle every complete XML message.
+ ************************************************************************/
+void read_conn (double now)
+{
+    char *end;
+    int n;
+
+    n = recv (conn, inbuf + inlen, INBUF_SIZE - inlen, 0);
+    if (n < 0 && (errno == EAGAIN || errno == EINTR)) return;
+    if (n <= 0) {
+	close_conn ((n == 0) ? "closed by lib660" : strerror(errno));
+	return;
+    }
+    inlen += n;
+    inbuf[inlen] = '\0';
+    while ((end = strstr (inbuf, "</Q660_Data>")) != NULL) {
+	end += strlen("</Q660_Data>");
+	n = *end;
+	*end = '\0';
+	process_message (inbuf, now);
+	*end = n;
+	if (conn < 0) return;
+	inlen -= end - inbuf;
+	memmove (inbuf, end, inlen + 1);
+    }
+    if (inlen >= INBUF_SIZE) close_conn ("message too long");
+}
+
+/************************************************************************
+ *  write_conn:
+ *	Send as much of the output buffer as the connection takes.
+ ************************************************************************/
+void write_conn (void)
+{
+    int n;
+
+    n = send (conn, outbuf + outoff, outlen - outoff, MSG_NOSIGNAL);
+    if (n < 0) {
+	if (errno != EAGAIN && errno != EINTR) close_conn (strerror(errno));
+	return;
+    }
+    outoff += n;
+    if (outoff == outlen) outoff = outlen = 0;
+}
+
+/************************************************************************
+ *  open_listener:
+ *	Return a non-blocking socket listening on ifaddr:port.
+ ************************************************************************/
+int open_listener (struct in_addr ifaddr, int port)
+{
+    struct sockaddr_in addr;
+    int fd, on = 1;
+
+    memset (&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr = ifaddr;
+    addr.sin_port = htons(port);
+    if ((fd = socket (AF_INET, SOCK_STREAM, 0)) < 0
+	|| setsockopt (fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)) < 0
+	|| bind (fd, (struct sockaddr *)&addr, sizeof(addr)) < 0
+	|| listen (fd, 4) < 0) {
+	fprintf (stderr, "Unable to listen on port %d: %s\n", port, strerror(errno));
+	exit(1);
+    }
+    fcntl (fd, F_SETFL, O_NONBLOCK);
+    return fd;
+}
+
+/************************************************************************
+ *  main procedure
+ ************************************************************************/
+int main (int argc, char **argv)
+{
+    char *ifaddr = "127.0.0.1";
+    char *rate_list = DEFAULT_RATES;
+    int baseport = DEFAULT_BASEPORT;
+    struct in_addr iface;
+    struct pollfd fds[3];
+    int listeners[2];
+    double now, wake, next_print;
+    uint64_t last_packets = 0, last_bytes = 0;
+    char *p, *token, *dot;
+    int i, j, fd, on = 1;
+
+    /* Variables needed for getopt. */
+    extern char	*optarg;
+    extern int	optind, opterr;
+    int		ch;
+
+    setlinebuf(stdout);
+    cmdname = basename(strdup(argv[0]));
+    while ( (ch = getopt(argc,argv,"hb:i:g:s:x:B:L:R:D:K:r:l")) != -1)
+	switch (ch) {
+	case '?':
+	case 'h':   print_syntax(cmdname,syntax,stdout); exit(1);
+	case 'b':   baseport = atoi(optarg); break;
+	case 'i':   ifaddr = optarg; break;
+	case 'g':   nchan = atoi(optarg); break;
+	case 's':   rate_list = optarg; break;
+	case 'x':   speed = atof(optarg); break;
+	case 'B':   backfill = atoi(optarg); break;
+	case 'L':   loss = atof(optarg); break;
+	case 'R':   reorder = atof(optarg); break;
+	case 'D':   discon_secs = atof(optarg); break;
+	case 'K':   kill_secs = atof(optarg); break;
+	case 'r':   seed = strtoul(optarg, NULL, 0); break;
+	case 'l':   lowlat = 1; break;
+	default:
+	    fprintf (stderr, "Unsupported option: -%c\n", ch);
+	    exit(1);
+	}
+
+    /*	Skip over all options and their arguments.			*/
+    argv = &(argv[optind]);
+    argc -= optind;
+
+    if (argc != 1) {
+	print_syntax(cmdname,syntax,stdout);
+	exit(1);
+    }
+    if (nchan < 1 || nchan > MAX_CHAN || speed <= 0. || backfill < 0 || loss < 0. || loss > 100.
+	|| reorder < 0. || reorder > 100. || discon_secs < 0. || kill_secs < 0. || seed == 0
+	|| baseport <= 0 || baseport + 5 > 65535) {
+	fprintf (stderr, "Invalid option value\n");
+	exit(1);
+    }
+    if (inet_pton (AF_INET, ifaddr, &iface) != 1) {
+	fprintf (stderr, "Invalid interface address: %s\n", ifaddr);
+	exit(1);
+    }
+    upshift(argv[0]);
+    if ((dot = strchr (argv[0], '.')) == NULL || dot - argv[0] > 2 || strlen(dot+1) > 5
+	|| dot == argv[0] || dot[1] == '\0') {
+	fprintf (stderr, "Invalid NET.STA: %s\n", argv[0]);
+	exit(1);
+    }
+    strncpy (network, argv[0], dot - argv[0]);
+    strcpy (station, dot + 1);
+
+    for (p = strdup(rate_list); (token = strtok(p, ",")) != NULL; p = NULL) {
+	for (j = 0; j < FREQS && FREQTAB[j] != atoi(token); j++) ;
+	for (i = 0; i < nrates && freqnum[i] != j; i++) ;
+	if (j == FREQS || i < nrates) {
+	    fprintf (stderr, "Invalid or repeated sample rate: %s\n", token);
+	    exit(1);
+	}
+	rates[nrates] = FREQTAB[j];
+	freqnum[nrates++] = j;
+    }
+    if (nrates == 0) {
+	fprintf (stderr, "No sample rates\n");
+	exit(1);
+    }
+    if ((outbuf = (unsigned char *)malloc (OUTBUF_SIZE)) == NULL) {
+	fprintf (stderr, "Unable to allocate output buffer\n");
+	exit(1);
+    }
+
+    listeners[0] = open_listener (iface, baseport + 2);
+    listeners[1] = open_listener (iface, baseport + 5);
+
+    signal (SIGHUP, finish_handler);
+    signal (SIGINT, finish_handler);
+    signal (SIGQUIT, finish_handler);
+    signal (SIGTERM, finish_handler);
+    signal (SIGPIPE, SIG_IGN);
+
+    start_time = dtime ();
+    printf ("%s - %s version %s for %s.%s on %s:%d and %d, %d channels at %s sps, speed %.1f\n",
+	    localtime_string(start_time), cmdname, VERSION, network, station, ifaddr,
+	    baseport + 2, baseport + 5, nchan, rate_list, speed);
+
+    next_print = start_time + STATUS_INTERVAL;
+    while (! terminate_proc) {
+	now = dtime ();
+
+	/* Generate data while the connection keeps up with it.	*/
+	if (conn >= 0 && state == CS_RUN) {
+	    if (kill_secs > 0. && now >= kill_at) {
+		close_conn ("closed by -K");
+	    }
+	    else if (discon_secs > 0. && now >= discon_at) {
+		if (held_lth > 0) queue_packet (DT_DATA, held, held_lth);
+		held_lth = 0;
+		queue_packet (DT_DISCON, (const unsigned char *)"\0\0\0\0", 4);
+		state = CS_DISCON;
+		printf ("%s - sent DT_DISCON\n", localtime_string(now));
+	    }
+	    else {
+		while (outlen - outoff < OUT_LOW && next_sec <= last_complete (now))
+		    send_second (next_sec++);
+		if (now >= next_status_pkt) {
+		    send_status (now);
+		    next_status_pkt = now + status_interval;
+		}
+	    }
+	}
+	if (conn >= 0 && outlen > outoff) write_conn ();
+
+	if (now >= next_print) {
+	    printf ("%s - %s, %llu seconds, %llu packets, %.1f packets/sec, %.1f kbit/sec, "
+		    "%llu dropped, %llu reordered, %d connections",
+		    localtime_string(now), (conn >= 0 && state >= CS_RUN) ? "streaming" : "waiting",
+		    (unsigned long long)seconds, (unsigned long long)packets,
+		    (packets - last_packets) / (now - next_print + STATUS_INTERVAL),
+		    (bytes - last_bytes) * 8. / 1000. / (now - next_print + STATUS_INTERVAL),
+		    (unsigned long long)dropped, (unsigned long long)reordered, connections);
+	    if (conn >= 0 && state == CS_RUN)
+		printf (", %u seconds behind", last_complete (now) + 1 - next_sec);
+	    printf ("\n");
+	    last_packets = packets;
+	    last_bytes = bytes;
+	    next_print = now + STATUS_INTERVAL;
+	}
+
+	/* Wait for lib660, the next second of data, or a timer.	*/
+	for (i = 0; i < 2; i++) {
+	    fds[i].fd = listeners[i];
+	    fds[i].events = POLLIN;
+	}
+	fds[2].fd = conn;
+	fds[2].events = POLLIN | ((outlen > outoff) ? POLLOUT : 0);
+	fds[2].revents = 0;
+	wake = next_print;
+	if (conn >= 0 && state == CS_RUN) {
+	    double t = start_time + (floor(data_time(now)) + 1. - start_time) / speed;
+	    if (next_sec <= last_complete (now) && outlen - outoff < OUT_LOW) t = now;
+	    if (t < wake) wake = t;
+	    if (next_status_pkt < wake) wake = next_status_pkt;
+	    if (kill_secs > 0. && kill_at < wake) wake = kill_at;
+	    if (discon_secs > 0. && discon_at < wake) wake = discon_at;
+	}
+	if (poll (fds, 3, (wake > now) ? (int)ceil((wake - now) * 1000.) : 0) < 0) continue;
+	now = dtime ();
+
+	for (i = 0; i < 2; i++) {
+	    if ((fds[i].revents & POLLIN) == 0) continue;
+	    if ((fd = accept (listeners[i], NULL, NULL)) < 0) continue;
+	    if (conn >= 0) close_conn ("replaced by a new connection");
+	    conn = fd;
+	    fcntl (conn, F_SETFL, O_NONBLOCK);
+	    setsockopt (conn, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+	    state = CS_REQ;
+	    status_interval = 10;
+	    ++connections;
+	    printf ("%s - connection %d on port %d\n", localtime_string(now), connections,
+		    baseport + ((i == 0) ? 2 : 5));
+	}
+	if (conn >= 0 && fds[2].fd == conn && (fds[2].revents & (POLLIN | POLLHUP | POLLERR)))
+	    read_conn (now);
+    }
+
+    printf ("%s - %s terminated, sent %llu seconds in %llu packets\n", localtime_string(dtime()),
+	    cmdname, (unsigned long long)seconds, (unsigned long long)packets);
+    if (conn >= 0) close (conn);
+    return (0);
+}
+
+/************************************************************************
+ *  print_syntax:
+ *	Print the syntax description of program.
+ ************************************************************************/
+int print_syntax (char	*cmd,		/* program name.			*/
+		  char	*syntax[],	/* syntax array.			*/
+		  FILE	*fp)		/* FILE ptr for output.			*/
+{
+    int i;
+    for (i=0; syntax[i] != NULL; i++) {
+	fprintf (fp, syntax[i], cmd);
+	fprintf (fp, "\n");
+    }
+    return (0);
+}
+
+/************************************************************************
+ *  finish_handler:
+ *	Signal handler to terminate the program.
+ ************************************************************************/
+void finish_handler (int sig)
+{
+    signal (sig, finish_handler);
+    terminate_proc = 1;
+}
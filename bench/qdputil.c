@@ -0,0 +1,161 @@
+/***********************************************************************
+ * qdputil.c - QDP packets for the fake data loggers of the benchmarks.
+ *
+ * 2026-10-19 Initial version.
+ **********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#include "qdputil.h"
+
+#define CRC_POLY	0x56070368	/* Polynomial of the QDP CRC.	*/
+#define AMPLITUDE	5000.		/* Counts.			*/
+#define PERIOD		10		/* Seconds.			*/
+#define NOISE		16		/* Counts.			*/
+
+/* Data word formats, tried from the most samples per word down.	*/
+/* code is the map code, dnib the 2 bit subcode in the data word.	*/
+static const struct {
+    int samps, bits, code, dnib;
+} formats[] = {
+    {7, 4, 3, 2}, {6, 5, 3, 1}, {5, 6, 3, 0}, {4, 8, 1, -1},
+    {3, 10, 2, 3}, {2, 15, 2, 2}, {1, 30, 2, 1}
+};
+#define NFORMATS	(int)(sizeof(formats) / sizeof(formats[0]))
+
+static uint32_t crc_table[256];
+
+/***********************************************************************
+ * qdp_crc()
+ *	RETURNS the CRC of a QDP packet, computed over len bytes.
+ **********************************************************************/
+
+uint32_t qdp_crc (const unsigned char *p, int len)
+{
+    uint32_t crc = 0;
+    int i, k;
+
+    if (crc_table[1] == 0) {
+	for (i = 0; i < 256; i++) {
+	    crc = (uint32_t)i << 24;
+	    for (k = 0; k < 8; k++)
+		crc = (crc & 0x80000000) ? (crc << 1) ^ CRC_POLY : crc << 1;
+	    crc_table[i] = crc;
+	}
+	crc = 0;
+    }
+    while (len-- > 0)
+	crc = (crc << 8) ^ crc_table[((crc >> 24) ^ *p++) & 255];
+    return crc;
+}
+
+/***********************************************************************
+ * qdp_put8(), qdp_put16(), qdp_put32()
+ *	Store a value in network byte order.
+ *	RETURNS the address after it.
+ **********************************************************************/
+
+unsigned char *qdp_put8 (unsigned char *p, unsigned v)
+{
+    *p++ = v;
+    return p;
+}
+
+unsigned char *qdp_put16 (unsigned char *p, unsigned v)
+{
+    *p++ = v >> 8;
+    *p++ = v;
+    return p;
+}
+
+unsigned char *qdp_put32 (unsigned char *p, uint32_t v)
+{
+    *p++ = v >> 24;
+    *p++ = v >> 16;
+    *p++ = v >> 8;
+    *p++ = v;
+    return p;
+}
+
+/***********************************************************************
+ * qdp_sample()
+ *	RETURNS sample n of synthetic channel chan at rate samples per
+ *	second: a sine wave of 10 seconds plus a little noise.
+ **********************************************************************/
+
+int32_t qdp_sample (int chan, int rate, int64_t n)
+{
+    uint64_t h = (uint64_t)n * 0x9E3779B97F4A7C15ull + (uint64_t)(chan + 1) * 0xBF58476D1CE4E5B9ull;
+    int64_t period = (int64_t)PERIOD * rate;
+
+    h ^= h >> 31;
+    h *= 0x94D049BB133111EBull;
+    h ^= h >> 29;
+    return (int32_t)lrint(AMPLITUDE * sin(2. * M_PI * (double)(((n % period) + period) % period) / period))
+	+ (int32_t)(h % (2 * NOISE + 1)) - NOISE;
+}
+
+/***********************************************************************
+ * qdp_compress()
+ *	Pack n sample differences into data words, with the map code of
+ *	each word in codes.
+ *	RETURNS the number of data words.
+ **********************************************************************/
+
+int qdp_compress (const int32_t *diffs, int n, unsigned char *codes, uint32_t *words)
+{
+    int nwords = 0;
+    int i, k, f;
+
+    for (i = 0; i < n && nwords < QDP_MAXWORDS; i += formats[f].samps) {
+	for (f = 0; f < NFORMATS - 1; f++) {
+	    int32_t lim = 1 << (formats[f].bits - 1);
+	    if (i + formats[f].samps > n) continue;
+	    for (k = 0; k < formats[f].samps; k++)
+		if (diffs[i+k] < -lim || diffs[i+k] >= lim) break;
+	    if (k == formats[f].samps) break;
+	}
+	words[nwords] = (formats[f].dnib < 0) ? 0 : (uint32_t)formats[f].dnib << 30;
+	for (k = 0; k < formats[f].samps; k++)
+	    words[nwords] |= ((uint32_t)diffs[i+k] & ((1u << formats[f].bits) - 1))
+		<< ((formats[f].samps - 1 - k) * formats[f].bits);
+	codes[nwords++] = formats[f].code;
+    }
+    return nwords;
+}
+
+/***********************************************************************
+ * qdp_map()
+ *	Build the map of nwords data words, 4 codes per byte starting
+ *	with the most significant bits, padded to a multiple of 4 bytes.
+ *	RETURNS the size of the map in bytes.
+ **********************************************************************/
+
+int qdp_map (const unsigned char *codes, int nwords, unsigned char *map)
+{
+    int size = (((nwords + 3) / 4) + 3) & ~3;
+    int i;
+
+    memset (map, 0, size);
+    for (i = 0; i < nwords; i++)
+	map[i / 4] |= codes[i] << (6 - 2 * (i % 4));
+    return size;
+}
+
+/***********************************************************************
+ * qdp_random()
+ *	RETURNS the next number of a small pseudo random sequence, so
+ *	that injected faults repeat from run to run.
+ **********************************************************************/
+
+unsigned qdp_random (unsigned *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
@@ -0,0 +1,37 @@
+/* qdputil.h - QDP packets for the fake data loggers of the benchmarks */
+
+#ifndef QDPUTIL_H
+#define QDPUTIL_H
+
+/*
+ * 2026-10-19 Initial version.
+ *
+ * q660sim and q330sim stand in for a Q660 and a Q330, so that lib660
+ * and lib330 can be loaded without a data logger.  Both loggers send
+ * one second of a channel as a compressed blockette: a map of 2 bit
+ * codes, one per 32 bit data word, and Steim2 style data words of
+ * sample differences.  The samples of a synthetic channel are a
+ * function of the sample index only, so any second can be generated
+ * again for a backfill request, and is contiguous with its neighbours.
+ */
+
+#include <stdint.h>
+
+#define QDP_MAXWORDS	1024		/* Data words of one second.	*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+uint32_t qdp_crc (const unsigned char *p, int len);
+unsigned char *qdp_put8 (unsigned char *p, unsigned v);
+unsigned char *qdp_put16 (unsigned char *p, unsigned v);
+unsigned char *qdp_put32 (unsigned char *p, uint32_t v);
+int32_t qdp_sample (int chan, int rate, int64_t n);
+int qdp_compress (const int32_t *diffs, int n, unsigned char *codes, uint32_t *words);
+int qdp_map (const unsigned char *codes, int nwords, unsigned char *map);
+unsigned qdp_random (unsigned *state);
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -16,6 +16,7 @@ Edit History:
     7 12 Jun 97 WHO Show seed sequence number for each record.
     8  3 Feb 2012 DSN Only disallow verbose option on little endian systems.
     9 29 Sep 2020 DSN Updated for comserv3.
+   10 19 Oct 2026     Wait for data with cs_wait instead of sleeping.
 */
 #include <stdio.h>
 #include <errno.h>
@@ -389,7 +390,7 @@ int main (int argc, char *argv[])
 	    }
 	}
 	else
-	sleep (1) ; /* Bother the server once every second */
+	cs_wait (me, 1000000) ; /* Bother the server at least once every second */
     }
     while (1) ;
 }
@@ -16,6 +16,7 @@ Edit History:
     6 22 Jul 96 WHO Fix offset calculation in final scan.
     7 04 Jan 2012 DSN Fix for little endian machine with big endian headers.
     8 29 Sep 2020 DSN Updated for comserv3.
+    9 19 Oct 2026     Wait for data with cs_wait instead of sleeping.
 */
 #include <stdio.h>
 #include <errno.h>
@@ -161,7 +162,7 @@ int main (int argc, char *argv[])
 	    }
 	}
 	else
-	    sleep (1) ; /* Bother the server once every second */
+	    cs_wait (me, 1000000) ; /* Bother the server at least once every second */
     }
     while (! terminate_proc) ;
     terminate_program(0) ;
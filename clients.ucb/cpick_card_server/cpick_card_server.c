@@ -12,9 +12,12 @@ Edit History:
     2 15 Feb 96 DSN Update for comserv 1.0.
     3 2020-09-29 DSN Updated for comserv3.
 		Ver 1.0.1 Modified for 15 character station and client names.
+    4 2026-10-19 Ver 1.0.2 Wait for data with cs_wait instead of sleeping.
+    5 2026-10-19 Ver 1.0.3 Use cs_gen_parallel so that a stalled comserv
+		does not delay the detections of the other stations.
 */
 
-#define	VERSION		"1.0.1 (2020.273)"
+#define	VERSION		"1.0.3 (2026.292)"
 
 #ifdef COMSERV2
 #define	CLIENT_NAME	"EVTD"
@@ -197,7 +200,7 @@ int main (int argc, char *argv[])
 		printf ("sleeping...");
 		fflush (stdout);
 	    }
-	    sleep (1) ; /* Bother the server once every second */
+	    cs_wait (me, 1000000) ; /* Bother the server at least once every second */
 	    if (verbosity & 2) {
 		printf ("awake\n");
 		fflush (stdout);
@@ -567,7 +570,7 @@ pclient_struc setup_comserv_connections(LIST station_list, LIST station_exclude,
     signal (SIGTERM,finish_handler);
 
     /* Create my segment and attach to all stations */      
-    me = cs_gen (&stations) ;
+    me = cs_gen_parallel (&stations) ;
 
     /* Set up special selectors. */
     set_selectors (me);
@@ -5,6 +5,8 @@
  *  2020-09-29 DSN Updated for comserv3.
  *  2022-02-07 DSN Updated to allow enviromental override of STATIONS_INI.
  *  2023-03-10 DSN Changed 1 second sleep to shorter sleep.
+ *  2026-10-19 Wait for windowed ringserver acks before acking comserv.
+ *  2026-10-19 Use cs_gen_parallel for station lists.
  ************************************************************************/
 
 #include <stdio.h>
@@ -44,6 +46,8 @@
 #include "service.h"
 #include "cfgutil.h"
 
+#include "ring_window.h"
+
 #define	TIMESTRLEN	40
 #define	MAX_BLKSIZE	512
 
@@ -109,6 +113,8 @@ extern int skip_ack;		/* skip comserv ack of packets.		*/
 extern int flush;		/* Default is no flush (blocking client).*/
 extern int nchannel;		/* number of entries in channelv.	*/
 extern CHANNEL_INFO **channelv;	/* list of channels.			*/
+extern int window;		/* Max unacked ringserver writes.	*/
+extern DLCP *dlconn;		/* descriptor for ring connection	*/
 
 extern char* seednamestring (seed_name_type *, location_type *);
 
@@ -258,6 +264,7 @@ int fill_from_comserv (char *station)
     char filename[CFGWIDTH];
     char time_str[TIMESTRLEN];
     int status;
+    short databufs;
 
     lockfile[0] = '\0';
     lockfd = -1;
@@ -354,10 +361,12 @@ int fill_from_comserv (char *station)
 
 /* Generate an entry for all available stations */      
 
-    cs_setup (&stations, client_name, station, TRUE, TRUE, 10, nchannel+1, data_mask, 6000) ;
+/* Request enough data buffers per scan to fill the ringserver window. */
+    databufs = (window > 10) ? window : 10;
+    cs_setup (&stations, client_name, station, TRUE, TRUE, databufs, nchannel+1, data_mask, 6000) ;
 
 /* Create my segment and attach to all stations */      
-    me = cs_gen (&stations) ;
+    me = cs_gen_parallel (&stations) ;
 
 /* Set up special selectors. */
 /*::
@@ -419,6 +428,13 @@ int fill_from_comserv (char *station)
 		    }
 		    pdat = (pdata_user) ((long) pdat + thist->dbufsize) ;
 		}
+		/* The next cs_scan acks these packets to comserv, so	*/
+		/* all ringserver writes must be acked first.		*/
+		if (window > 0 && ! skip_ack && ring_window_flush (dlconn) != SUCCESS) {
+		    printf("Error receiving ack from ring\n");
+		    terminate_proc = 1;
+		    skip_ack = 1;
+		}
 	    }
 	    if (terminate_proc) break;
 	}
@@ -427,7 +443,7 @@ int fill_from_comserv (char *station)
 		fprintf (info, "sleeping...");
 		fflush (info);
 	    }
-	    usleep (500000) ; /* short sleep between queries for more data */
+	    cs_wait (me, 500000) ; /* wait for more data */
 	    if (verbosity & 2)  {
 		fprintf (info, "awake\n");
 		fflush (info);
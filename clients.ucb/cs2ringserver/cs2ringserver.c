@@ -9,11 +9,24 @@
  *	Updated to allow enviromental override of STATIONS_INI.
  *  2023-03-10 ver 1.2.3 (2023.069) DSN
  *	Update to cleanly exit after error writing to ringserver.
+ *  2026-10-19 ver 1.3.0 (2026.292)
+ *	Added -w window option for pipelined ringserver writes with acks.
+ *	Comserv packets are acked only after ringserver acks all writes.
+ *	Replaced scnl_convert with the shared libcsutil sncl_remap table.
+ *	Added -m remapfile option for SNCL remap rules.
+ *  2026-10-19 ver 1.3.1 (2026.292)
+ *	Wait for comserv data with cs_wait instead of a fixed sleep.
+ *  2026-10-19 ver 1.3.2 (2026.292)
+ *	Exit when ringserver writes are not acked in datasock mode too.
+ *	A write rejected by the ringserver no longer hangs the window.
+ *  2026-10-19 ver 1.3.3 (2026.292)
+ *	Use cs_gen_parallel so that a stalled comserv does not delay the
+ *	other stations of a station list.
  ************************************************************************/
 
 #include <stdio.h>
 
-#define VERSION	"1.2.3 (2023.069)"
+#define VERSION	"1.3.3 (2026.292)"
 
 #ifdef COMSERV2
 #define CLIENT_NAME	"2RNG"
@@ -26,7 +39,8 @@ char *syntax[] = {
 "%s - write MSEED data records from comserv server or datasock socket to ringserver.",
 "Syntax:",
 "%s  [-H host] [-S service] [-p passwd] [-P passwdfile] [-R]",
-"    [-o station.net] [-n client_name] [-v n] [-h] station_list",
+"    [-o station.net] [-m remapfile] [-n client_name] [-a] [-w window]",
+"    [-v n] [-h] station_list",
 "    where:",
 "	-O ringserver	Name of ringserver (host:port).",
 "	-H host		Specify datasock host that provides input mSEED via a socket.",
@@ -35,9 +49,15 @@ char *syntax[] = {
 "	-P passwdfile	File containing passwd to for datasock host.",
 "	-o station.net	Override the station and network in the MSEED data",
 "			data records with the specified station.net.",
+"	-m remapfile	File of SNCL remap rules, one \"in_sncl out_sncl\" rule",
+"			per line, with SNCLs in STA.NET.CHAN.LOC format.",
 "	-n client_name	Override default comserv client name with new name.",
 "			Default client name is " CLIENT_NAME ".",
 "	-R		Request stations and channels from remote datasock.",
+"	-a		Request ringserver ack for each write.",
+"	-w window	Keep up to window unacked ringserver writes in flight.",
+"			Implies -a.  Comserv packets are only acked after",
+"			all of their ringserver writes have been acked.",
 "	-v n		Set verbosity level to n.",
 "	-f		Flush - start with new data.",
 "	-h		Help - prints syntax message.",
@@ -46,6 +66,7 @@ char *syntax[] = {
 "1.  Program will not register as a comserv client if it is receiving",
 "    MSEED data from a datasock socket.",
 "2.  Program exits if unable to write to ringserver.",
+"3.  Without -w, each acked write waits for a full ringserver round trip.",
 NULL };
 
 #include <stdlib.h>
@@ -84,9 +105,10 @@ NULL };
 #include "datasock_codes.h"
 #include "basics.h"
 
-#include "scnl_convert.h"
+#include "sncl_remap.h"
 
 #include "libdali.h"
+#include "ring_window.h"
 
 #define	SEED_BLKSIZE	512
 #define	SEED_MAX_BLKSIZE 8192
@@ -108,7 +130,10 @@ int nchannel;			/* number of entries in channelv.	*/
 CHANNEL_INFO **channelv = NULL;	/* list of channels.			*/
 DLCP *dlconn;			/* descriptor for ring connection	*/
 char *new_sn;			/* Optional station.channel rename.	*/
+char *remapfile;		/* Optional SNCL remap rule file.	*/
+SNCL_REMAP *remap;		/* SNCL remap table.			*/
 int ack = 0;			/* Default is no ack from ringserver.	*/
+int window = 0;			/* Max unacked writes (0 = synchronous).*/
 tclientname client_name;	/* Comserv client name			*/
 
 /*  Signal handler variables and functions.				*/
@@ -163,7 +188,10 @@ int ringput_mseed( char *pseed, int size )
     dataend = DL_EPOCH2DLTIME(de);
     free_data_hdr (hdr);
 
-    rc = dl_write( dlconn, pseed, size, streamid, datastart, dataend, ack);
+    if (window > 0)
+	rc = ring_window_write (dlconn, pseed, size, streamid, datastart, dataend);
+    else
+	rc = dl_write( dlconn, pseed, size, streamid, datastart, dataend, ack);
 
     if( rc < 0 ) {
 	fprintf( info, "ringput failed for packet source %s\n", streamid );
@@ -175,22 +203,6 @@ int ringput_mseed( char *pseed, int size )
     return (rc);
 }
 
-void remap_scnl (DATA_HDR *hdr) 
-{
-    S2S s;
-    s.scnl_in.s = hdr->station_id;
-    s.scnl_in.c = hdr->channel_id;
-    s.scnl_in.n = hdr->network_id;
-    s.scnl_in.l = hdr->location_id;
-    if (scnl2scnl(&s)) {
-	strncpy (hdr->station_id, s.scnl_out.s, DH_STATION_LEN);
-	strncpy (hdr->channel_id, s.scnl_out.c, DH_CHANNEL_LEN);
-	strncpy (hdr->network_id, s.scnl_out.n, DH_NETWORK_LEN);
-	strncpy (hdr->location_id, s.scnl_out.l, DH_LOCATION_LEN);
-    }
-    return;
-}
-
 /************************************************************************
  *  write_to_ring:
  *	Write SEED packet to ring.
@@ -204,6 +216,9 @@ int write_to_ring(seed_record_header *tseed)
     char out_buf[SEED_MAX_BLKSIZE];
     int data_offset, datalen;
 
+    /* Remap the SNCL in the raw header if required. */
+    if (remap) sncl_remap_record (remap, (char *)tseed);
+
     if ((hdr = decode_hdr_sdr((SDR_HDR *)tseed, SEED_BLKSIZE)) == NULL)
     {
 	return(FAILURE);
@@ -216,9 +231,6 @@ int write_to_ring(seed_record_header *tseed)
 	return(FAILURE);
     }
 
-    /* Remap the SNCL if required. */
-    if (new_sn) remap_scnl (hdr);
-
     /* Fill in the number of data frames.   */
     if ((bs = find_blockette(hdr,1001)) &&
 	(bh = (BLOCKETTE_HDR *)(bs->pb))) {
@@ -305,11 +317,13 @@ int main (int argc, char **argv)
     client_name[CLIENT_NAME_SIZE-1] ='\0';    
     
     cmdname = argv[0];
-    while ( (c = getopt(argc,argv,"hRv:O:H:S:p:P:o:n:")) != -1)
+    while ( (c = getopt(argc,argv,"hRav:w:O:H:S:p:P:o:m:n:")) != -1)
 	switch (c) {
 	case '?':
 	case 'h':   ANNOUNCE(cmdname,info); print_syntax (cmdname,syntax,stdout); exit(0);
 	case 'v':   verbosity=atoi(optarg); break;
+	case 'a':   ack = 1; break;
+	case 'w':   window=atoi(optarg); ack = 1; break;
 	case 'O':   strcpy(ringserver,optarg); break;
 	case 'H':   host = optarg; break;
 	case 'S':   service = optarg; break;
@@ -317,6 +331,7 @@ int main (int argc, char **argv)
 	case 'P':   passwdfile = optarg; break;
 	case 'R':   request_flag |= SOCKET_REQUEST_CHANNELS; break;
 	case 'o':   new_sn = optarg; break;
+	case 'm':   remapfile = optarg; break;
 	case 'n':   strncpy(client_name,optarg,CLIENT_NAME_SIZE);
 		    client_name[CLIENT_NAME_SIZE-1] ='\0'; break;
 	}
@@ -360,31 +375,39 @@ int main (int argc, char **argv)
     }
 
 
+    if (new_sn || remapfile) {
+	if ((remap = sncl_remap_new()) == NULL) {
+	    fprintf (stderr, "Error allocating SNCL remap table.\n");
+	    exit(1);
+	}
+    }
+    if (remapfile && sncl_remap_load (remap, remapfile) < 0) {
+	fprintf (stderr, "Error loading SNCL remap file %s\n", remapfile);
+	exit(1);
+    }
     if (new_sn) {
-	S2S s;
+	char out_sncl[32];
 	char *p1 = NULL, *p2 = NULL;
 	char *str = strdup(new_sn);
 	upshift(str) ;
-	s.scnl_in.s = strdup("*");
-	s.scnl_in.n = strdup("*");
-	s.scnl_in.c = strdup("*");
-	s.scnl_in.l = strdup("*");
-	s.scnl_out.c = strdup("*");
-	s.scnl_out.l = strdup("*");
 	p1 = strtok (str, ".");
 	p2 = strtok (NULL, ".");
 	if (p1 == NULL || p2 == NULL) {
 	    fprintf (stderr, "Invalid station.net specified for override: %s\n", new_sn);
 	    exit( -1 );
 	}
-	s.scnl_out.s = strdup(p1);
-	s.scnl_out.n = strdup(p2);
+	snprintf (out_sncl, sizeof(out_sncl), "%s.%s.*.*", p1, p2);
 	free (str);
-	if (s2s_set(s) == 0) {
+	/* The station.net override applies to all SNCLs not remapped	*/
+	/* by an earlier rule from the remap file.			*/
+	if (sncl_remap_add (remap, "*.*.*.*", out_sncl) < 0) {
 	    fprintf (stderr, "Error initializing station.net renaming.\n");
 	    exit(1);
 	}
-	sort_scnl();
+    }
+
+    if (window > 0 && ring_window_init (window) != SUCCESS) {
+	exit(1);
     }
 
     dlconn = dl_newdlcp (ringserver, cmdname);
@@ -0,0 +1,242 @@
+/************************************************************************
+ * fake_ringserver
+ *	Minimal DataLink server to test the ringserver writes of
+ *	cs2ringserver without a ringserver.
+ *
+ *	It accepts one connection at a time, answers the ID exchange
+ *	with WRITE permission, and answers every WRITE that asks for an
+ *	ack with OK and the packet number.  To test the error handling of
+ *	the client it can reject a write, or close the connection before
+ *	answering it, and it can delay every ack to emulate a network
+ *	round trip.  Other DataLink commands are answered with ERROR.
+ *
+ * Modification History:
+ *  2026-10-19 ver 1.0.0 (2026.292) Initial version.
+ ************************************************************************/
+
+#include <stdio.h>
+
+#define VERSION	"1.0.0 (2026.292)"
+
+char *syntax[] = {
+"%s   version " VERSION,
+"%s - minimal DataLink server for cs2ringserver tests.",
+"Syntax:",
+"%s  [-p port] [-e n] [-c n] [-d msec] [-1] [-v] [-h]",
+"    where:",
+"	-p port		Listen on this TCP port of 127.0.0.1 (default 16000).",
+"	-e n		Reject write number n of each connection with ERROR.",
+"	-c n		Close the connection instead of answering write n.",
+"	-d msec		Delay every ack by msec milliseconds.",
+"	-1		Exit after the first connection is closed.",
+"	-v		Print every command.",
+"	-h		Help - prints syntax message.",
+"Notes:",
+"1.  The number of writes received and acked is printed for every",
+"    connection, and the exit status is 0.",
+NULL };
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#define	DEFAULT_PORT	16000
+#define	MAX_HEADER	255
+#define	MAX_PACKET	16384
+#define	SERVER_ID	"ID DataLink fake_ringserver :: DLPROTO:1.0 PACKETSIZE:512 WRITE"
+
+char *cmdname;			/* Program name.			*/
+int verbose;			/* Print every command.			*/
+int reject_at;			/* Write number to reject.		*/
+int close_at;			/* Write number to close on.		*/
+int delay_msec;			/* Ack delay.				*/
+
+int print_syntax (char *cmd, char *syntax[], FILE *fp);
+
+/************************************************************************
+ *  read_full:
+ *	Read exactly n bytes.
+ *	Return n, or 0 on end of file or error.
+ ************************************************************************/
+int read_full (int fd, char *buf, int n)
+{
+    int got = 0, rc;
+
+    while (got < n) {
+	rc = read (fd, buf + got, n - got);
+	if (rc < 0 && errno == EINTR) continue;
+	if (rc <= 0) return (0);
+	got += rc;
+    }
+    return (n);
+}
+
+/************************************************************************
+ *  send_msg:
+ *	Send a DataLink message with a header and an optional body.
+ *	Return 0 on success, -1 on error.
+ ************************************************************************/
+int send_msg (int fd, const char *header, const char *body, int bodylen)
+{
+    char buf[3 + MAX_HEADER + MAX_HEADER];
+    int hlen = strlen(header);
+
+    buf[0] = 'D';
+    buf[1] = 'L';
+    buf[2] = hlen;
+    memcpy (buf + 3, header, hlen);
+    if (bodylen > 0) memcpy (buf + 3 + hlen, body, bodylen);
+    return (write (fd, buf, 3 + hlen + bodylen) == 3 + hlen + bodylen) ? 0 : -1;
+}
+
+/************************************************************************
+ *  send_error:
+ *	Send an ERROR reply with a message.
+ ************************************************************************/
+int send_error (int fd, const char *msg)
+{
+    char header[MAX_HEADER];
+
+    snprintf (header, sizeof(header), "ERROR 0 %d", (int)strlen(msg));
+    return (send_msg (fd, header, msg, strlen(msg)));
+}
+
+/************************************************************************
+ *  serve:
+ *	Handle the commands of one connection until it is closed.
+ ************************************************************************/
+void serve (int fd)
+{
+    char header[MAX_HEADER+1];
+    char packet[MAX_PACKET];
+    char reply[MAX_HEADER];
+    char streamid[MAX_HEADER], flags[MAX_HEADER];
+    long long start, end;
+    int hlen, size;
+    int nwrites = 0, nacked = 0;
+
+    for (;;) {
+	if (read_full (fd, header, 3) == 0) break;
+	if (header[0] != 'D' || header[1] != 'L') {
+	    fprintf (stderr, "%s: invalid DataLink preheader\n", cmdname);
+	    break;
+	}
+	hlen = (unsigned char)header[2];
+	if (read_full (fd, header, hlen) == 0) break;
+	header[hlen] = '\0';
+	if (verbose) printf ("%s: %s\n", cmdname, header);
+
+	if (strncmp (header, "ID", 2) == 0) {
+	    if (send_msg (fd, SERVER_ID, NULL, 0) < 0) break;
+	}
+	else if (strncmp (header, "WRITE", 5) == 0) {
+	    if (sscanf (header, "WRITE %254s %lld %lld %254s %d", streamid,
+			&start, &end, flags, &size) != 5
+		|| size < 0 || size > MAX_PACKET) {
+		send_error (fd, "invalid WRITE command");
+		break;
+	    }
+	    if (read_full (fd, packet, size) == 0) break;
+	    ++nwrites;
+	    if (nwrites == close_at) {
+		printf ("%s: closing connection at write %d\n", cmdname, nwrites);
+		break;
+	    }
+	    if (strchr (flags, 'A') == NULL) continue;
+	    if (delay_msec > 0) usleep (delay_msec * 1000);
+	    if (nwrites == reject_at) {
+		printf ("%s: rejecting write %d\n", cmdname, nwrites);
+		if (send_error (fd, "write rejected") < 0) break;
+		continue;
+	    }
+	    snprintf (reply, sizeof(reply), "OK %d 0", nwrites);
+	    if (send_msg (fd, reply, NULL, 0) < 0) break;
+	    ++nacked;
+	}
+	else {
+	    if (send_error (fd, "command not supported") < 0) break;
+	}
+    }
+    printf ("%s: connection closed, %d writes received, %d acked\n",
+	    cmdname, nwrites, nacked);
+    fflush (stdout);
+    close (fd);
+}
+
+/************************************************************************/
+int main (int argc, char **argv)
+{
+    struct sockaddr_in addr;
+    int port = DEFAULT_PORT;
+    int once = 0;
+    int lfd, fd, on = 1;
+
+    /* Variables needed for getopt. */
+    extern char	*optarg;
+    extern int	optind, opterr;
+    int		c;
+
+    cmdname = argv[0];
+    while ( (c = getopt(argc,argv,"hv1p:e:c:d:")) != -1)
+	switch (c) {
+	case '?':
+	case 'h':   print_syntax (cmdname,syntax,stdout); exit(0);
+	case 'v':   verbose = 1; break;
+	case '1':   once = 1; break;
+	case 'p':   port = atoi(optarg); break;
+	case 'e':   reject_at = atoi(optarg); break;
+	case 'c':   close_at = atoi(optarg); break;
+	case 'd':   delay_msec = atoi(optarg); break;
+	}
+    if (optind != argc) {
+	print_syntax (cmdname,syntax,stdout);
+	exit(1);
+    }
+
+    signal (SIGPIPE, SIG_IGN);
+    memset (&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    if ((lfd = socket (AF_INET, SOCK_STREAM, 0)) < 0
+	|| setsockopt (lfd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)) < 0
+	|| bind (lfd, (struct sockaddr *)&addr, sizeof(addr)) < 0
+	|| listen (lfd, 1) < 0) {
+	fprintf (stderr, "%s: unable to listen on port %d: %s\n",
+		 cmdname, port, strerror(errno));
+	exit(1);
+    }
+    printf ("%s: listening on 127.0.0.1:%d\n", cmdname, port);
+    fflush (stdout);
+
+    do {
+	if ((fd = accept (lfd, NULL, NULL)) < 0) {
+	    if (errno == EINTR) continue;
+	    fprintf (stderr, "%s: accept error: %s\n", cmdname, strerror(errno));
+	    exit(1);
+	}
+	serve (fd);
+    } while (! once);
+    close (lfd);
+    return (0);
+}
+
+/************************************************************************
+ *  print_syntax:
+ *	Print the syntax description of program.
+ ************************************************************************/
+int print_syntax (char *cmd, char *syntax[], FILE *fp)
+{
+    int i;
+    for (i=0; syntax[i] != NULL; i++) {
+	fprintf (fp, syntax[i], cmd, cmd);
+	fprintf (fp, "\n");
+    }
+    return (0);
+}
@@ -0,0 +1,191 @@
+/************************************************************************
+ *  ring_window.c
+ *	Windowed (pipelined) DataLink writes with acknowledgements.
+ *
+ *	dl_write() with the ack flag set sends one WRITE command and
+ *	then blocks for the server reply, so throughput is limited to
+ *	one record per round trip.  These routines send WRITE commands
+ *	with the ack flag set but do not wait for the reply.  Up to
+ *	"window" writes may be outstanding.  The ringserver processes
+ *	commands on a connection in order, so replies are matched to
+ *	outstanding writes in FIFO order.
+ *
+ *	The caller must call ring_window_flush() and check for SUCCESS
+ *	before acknowledging the records to the data source (eg before
+ *	the next cs_scan call for a comserv client).
+ *
+ * Modification History:
+ *  2026-10-19 Initial version.
+ ************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "basics.h"
+#include "ring_window.h"
+
+/************************************************************************
+ *  Externals variables and functions.
+ ************************************************************************/
+extern FILE *info;		/* Default FILE for messages.		*/
+extern int verbosity;		/* Verbosity flag.			*/
+
+typedef struct _pending_write {
+    char streamid[MAXSTREAMID];	/* streamid of outstanding write.	*/
+} PENDING_WRITE;
+
+static PENDING_WRITE *pending = NULL;	/* FIFO of outstanding writes.	*/
+static int window_size = 0;	/* Max number of outstanding writes.	*/
+static int head = 0;		/* Index of oldest outstanding write.	*/
+static int n_pending = 0;	/* Number of outstanding writes.	*/
+
+/************************************************************************
+ *  ring_window_init:
+ *	Allocate the FIFO for outstanding writes.
+ *	Return SUCCESS or FAILURE.
+ ************************************************************************/
+int ring_window_init (int window)
+{
+    if (window <= 0 || window > MAX_RING_WINDOW) {
+	fprintf (info, "Invalid ringserver write window %d, must be 1 to %d\n",
+		 window, MAX_RING_WINDOW);
+	return (FAILURE);
+    }
+    if (pending) free (pending);
+    pending = (PENDING_WRITE *)calloc (window, sizeof(PENDING_WRITE));
+    if (pending == NULL) {
+	fprintf (info, "Error allocating ringserver write window\n");
+	return (FAILURE);
+    }
+    window_size = window;
+    head = 0;
+    n_pending = 0;
+    return (SUCCESS);
+}
+
+/************************************************************************
+ *  ring_window_outstanding:
+ *	Return the number of unacknowledged writes.
+ ************************************************************************/
+int ring_window_outstanding (void)
+{
+    return (n_pending);
+}
+
+/************************************************************************
+ *  read_reply:
+ *	Read and process a single reply for the oldest outstanding write.
+ *	Return 1 if a positive ack was processed, 0 if no reply is
+ *	available (non-blocking only), or FAILURE on error.
+ ************************************************************************/
+static int read_reply (DLCP *dlconn, int blockflag)
+{
+    char reply[255];
+    int64_t value = 0;
+    int rc;
+
+    if (n_pending <= 0) return (0);
+    rc = dl_recvheader (dlconn, reply, sizeof(reply), blockflag);
+    if (rc == 0) return (0);
+    if (rc < 0) {
+	fprintf (info, "Error receiving ack from ringserver for %s\n",
+		 pending[head].streamid);
+	return (FAILURE);
+    }
+    rc = dl_handlereply (dlconn, reply, sizeof(reply), &value);
+    if (rc != 0) {
+	if (rc == 1) {
+	    fprintf (info, "Ringserver rejected write for %s: %s\n",
+		     pending[head].streamid, reply);
+	    /* The write was answered, and is not waited for again.	*/
+	    head = (head + 1) % window_size;
+	    n_pending--;
+	}
+	else {
+	    fprintf (info, "Error processing ack from ringserver for %s\n",
+		     pending[head].streamid);
+	}
+	return (FAILURE);
+    }
+    if (verbosity & 8) {
+	fprintf (info, "ringserver ack for %s pktid=%" PRId64 " outstanding=%d\n",
+		 pending[head].streamid, value, n_pending-1);
+    }
+    head = (head + 1) % window_size;
+    n_pending--;
+    return (1);
+}
+
+/************************************************************************
+ *  ring_window_collect:
+ *	Wait for acks until no more than max_outstanding writes remain
+ *	unacknowledged.  Any acks already available are also consumed.
+ *	Return SUCCESS or FAILURE.
+ ************************************************************************/
+int ring_window_collect (DLCP *dlconn, int max_outstanding)
+{
+    int rc;
+
+    /* Consume any acks that have already arrived.			*/
+    while (n_pending > 0) {
+	rc = read_reply (dlconn, 0);
+	if (rc < 0) return (FAILURE);
+	if (rc == 0) break;
+    }
+    /* Block until the window has room.					*/
+    while (n_pending > max_outstanding) {
+	rc = read_reply (dlconn, 1);
+	if (rc < 0) return (FAILURE);
+    }
+    return (SUCCESS);
+}
+
+/************************************************************************
+ *  ring_window_flush:
+ *	Wait until all outstanding writes have been acknowledged.
+ *	Return SUCCESS or FAILURE.
+ ************************************************************************/
+int ring_window_flush (DLCP *dlconn)
+{
+    return (ring_window_collect (dlconn, 0));
+}
+
+/************************************************************************
+ *  ring_window_write:
+ *	Send a DataLink WRITE command requesting an ack, without waiting
+ *	for the reply.  Blocks only if the window is full.
+ *	Return 0 on success, -1 on error (same as dl_write).
+ ************************************************************************/
+int ring_window_write (DLCP *dlconn, char *packet, int packetlen,
+		       char *streamid, dltime_t datastart, dltime_t dataend)
+{
+    char header[255];
+    int headerlen;
+    int tail;
+
+    if (dlconn->link == -1) return (-1);
+    if (! dlconn->writeperm) {
+	fprintf (info, "Ringserver connection is not configured for writing\n");
+	return (-1);
+    }
+    /* Make room in the window for this write.				*/
+    if (ring_window_collect (dlconn, window_size-1) != SUCCESS) return (-1);
+
+    headerlen = snprintf (header, sizeof(header),
+			  "WRITE %s %" PRId64 " %" PRId64 " A %d",
+			  streamid, datastart, dataend, packetlen);
+    if (headerlen < 0 || headerlen >= (int)sizeof(header)) {
+	fprintf (info, "Ringserver WRITE header too long for %s\n", streamid);
+	return (-1);
+    }
+    if (dl_sendpacket (dlconn, header, headerlen, packet, packetlen, NULL, 0) < 0) {
+	fprintf (info, "Error sending packet to ringserver for %s\n", streamid);
+	return (-1);
+    }
+    tail = (head + n_pending) % window_size;
+    strncpy (pending[tail].streamid, streamid, MAXSTREAMID);
+    pending[tail].streamid[MAXSTREAMID-1] = '\0';
+    n_pending++;
+    return (0);
+}
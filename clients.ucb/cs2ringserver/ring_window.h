@@ -0,0 +1,24 @@
+/************************************************************************
+ *  ring_window.h
+ *	Windowed (pipelined) DataLink writes with acknowledgements.
+ *
+ * Modification History:
+ *  2026-10-19 Initial version.
+ ************************************************************************/
+
+#ifndef ring_window_H
+#define ring_window_H
+
+#include "libdali.h"
+
+/* Maximum number of unacknowledged DataLink writes in flight.		*/
+#define MAX_RING_WINDOW	1000
+
+int ring_window_init (int window);
+int ring_window_write (DLCP *dlconn, char *packet, int packetlen,
+		       char *streamid, dltime_t datastart, dltime_t dataend);
+int ring_window_collect (DLCP *dlconn, int max_outstanding);
+int ring_window_flush (DLCP *dlconn);
+int ring_window_outstanding (void);
+
+#endif
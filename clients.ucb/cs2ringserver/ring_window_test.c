@@ -0,0 +1,123 @@
+/************************************************************************
+ * ring_window_test
+ *	Write synthetic records to a ringserver through the ring_window
+ *	routines of cs2ringserver, and report whether every write was
+ *	acknowledged.  Used with fake_ringserver by test_ring_window.
+ *
+ * Modification History:
+ *  2026-10-19 ver 1.0.0 (2026.292) Initial version.
+ ************************************************************************/
+
+#include <stdio.h>
+
+#define VERSION	"1.0.0 (2026.292)"
+
+char *syntax[] = {
+"%s   version " VERSION,
+"%s - test windowed ringserver writes.",
+"Syntax:",
+"%s  [-O ringserver] [-w window] [-n nrecords] [-v n] [-h]",
+"    where:",
+"	-O ringserver	Name of ringserver (default 127.0.0.1:16000).",
+"	-w window	Unacked writes in flight (default 16).",
+"	-n nrecords	Number of 512 byte records to write (default 100).",
+"	-v n		Set verbosity level to n.",
+"	-h		Help - prints syntax message.",
+"Notes:",
+"1.  Exit status is 0 only if every record was written and acked.",
+NULL };
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+
+#include "basics.h"
+#include "libdali.h"
+#include "ring_window.h"
+
+#define	RECSIZE		512
+
+FILE *info;			/* Default FILE for messages.		*/
+char *cmdname;			/* Program name.			*/
+int verbosity;			/* Verbosity flag.			*/
+
+int print_syntax (char *cmd, char *syntax[], FILE *fp);
+
+/************************************************************************/
+int main (int argc, char **argv)
+{
+    char *ringserver = "127.0.0.1:16000";
+    char record[RECSIZE];
+    char streamid[MAXSTREAMID];
+    dltime_t datastart;
+    DLCP *dlconn;
+    int window = 16;
+    int nrecords = 100;
+    int i, status = SUCCESS;
+
+    /* Variables needed for getopt. */
+    extern char	*optarg;
+    extern int	optind, opterr;
+    int		c;
+
+    info = stdout;
+    cmdname = argv[0];
+    while ( (c = getopt(argc,argv,"hv:O:w:n:")) != -1)
+	switch (c) {
+	case '?':
+	case 'h':   print_syntax (cmdname,syntax,stdout); exit(0);
+	case 'v':   verbosity=atoi(optarg); break;
+	case 'O':   ringserver = optarg; break;
+	case 'w':   window = atoi(optarg); break;
+	case 'n':   nrecords = atoi(optarg); break;
+	}
+    if (optind != argc) {
+	print_syntax (cmdname,syntax,stdout);
+	exit(1);
+    }
+
+    signal (SIGPIPE, SIG_IGN);
+    dl_loginit (verbosity, NULL, NULL, NULL, NULL);
+    if (ring_window_init (window) != SUCCESS) exit(1);
+    dlconn = dl_newdlcp (ringserver, cmdname);
+    if (dlconn == NULL || dl_connect (dlconn) < 0) {
+	fprintf (info, "Failed to connect to ringserver %s\n", ringserver);
+	exit(1);
+    }
+
+    memset (record, 0, sizeof(record));
+    for (i = 0; i < nrecords; i++) {
+	snprintf (streamid, sizeof(streamid), "XX_TEST_00_HH%c/MSEED", "ZNE"[i%3]);
+	datastart = DL_EPOCH2DLTIME(1700000000. + i);
+	snprintf (record, sizeof(record), "%06d", i);
+	if (ring_window_write (dlconn, record, RECSIZE, streamid, datastart,
+			       datastart + DL_EPOCH2DLTIME(1.)) < 0) {
+	    fprintf (info, "Write of record %d failed\n", i);
+	    status = FAILURE;
+	    break;
+	}
+    }
+    if (ring_window_flush (dlconn) != SUCCESS) {
+	fprintf (info, "Flush failed with %d writes unacked\n",
+		 ring_window_outstanding());
+	status = FAILURE;
+    }
+    fprintf (info, "%s: %d records written, %d unacked, %s\n", cmdname, i,
+	     ring_window_outstanding(), (status == SUCCESS) ? "OK" : "FAILED");
+    exit ((status == SUCCESS) ? 0 : 1);
+}
+
+/************************************************************************
+ *  print_syntax:
+ *	Print the syntax description of program.
+ ************************************************************************/
+int print_syntax (char *cmd, char *syntax[], FILE *fp)
+{
+    int i;
+    for (i=0; syntax[i] != NULL; i++) {
+	fprintf (fp, syntax[i], cmd, cmd);
+	fprintf (fp, "\n");
+    }
+    return (0);
+}
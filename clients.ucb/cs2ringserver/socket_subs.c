@@ -3,6 +3,7 @@
  * 
  * Modification History:
  *  2020-09-29 DSN Updated for comserv3.
+ *  2026-10-19 Flush windowed ringserver writes before closing socket.
  ************************************************************************/
 
 #include <stdio.h>
@@ -40,6 +41,8 @@
 #include "service.h"
 #include "cfgutil.h"
 
+#include "ring_window.h"
+
 /************************************************************************
  *  Externals variables and functions.
  ************************************************************************/
@@ -49,6 +52,8 @@ extern int verbosity;		/* Verbosity flag.			*/
 extern int terminate_proc;	/* Terminate program flag;		*/
 extern int nchannel;		/* number of entries in channelv.	*/
 extern CHANNEL_INFO **channelv;	/* list of channels.			*/
+extern int window;		/* Max unacked ringserver writes.	*/
+extern DLCP *dlconn;		/* descriptor for ring connection	*/
 
 /*  Signal handler variables and functions.		*/
 void finish_handler(int sig);
@@ -357,10 +362,18 @@ int fill_from_socket (char *station, char *host, char *service,
 		continue;
 	    }
 	    res = write_to_ring((seed_record_header *)seedrecord);
+	    free_data_hdr(data_hdr);
 	    if (res < 0) {
 		printf("Error writing to ring\n");
+		/* Exit on output error. */
+		terminate_proc = 1;	    /* Set program terminate flag. */
+		break;
 	    }
-	    free_data_hdr(data_hdr);
+	}
+	/* Records still in the window are not delivered until acked.	*/
+	if (window > 0 && ring_window_flush (dlconn) != SUCCESS) {
+	    printf("Error receiving ack from ring\n");
+	    terminate_proc = 1;
 	}
 
 	if (terminate_proc) break;
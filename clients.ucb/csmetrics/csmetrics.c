@@ -0,0 +1,685 @@
+/************************************************************************
+ *  csmetrics - Export the performance statistics of all comserv servers
+ *  on this host to Prometheus.
+ *
+ *  Every server (comserv, q330serv, q8serv, mserv) keeps a statistics
+ *  table in its shared memory segment (chanstats.h).  csmetrics serves
+ *  GET /metrics over HTTP, and on each request attaches read-only to the
+ *  segment of every station in the STATIONS_INI file, copies the
+ *  statistics, and returns them in the Prometheus text format.  It does
+ *  not register as a comserv client, so it never blocks a server and
+ *  needs no configuration in the station.ini files.
+ *
+ *  Packets and bytes per second are the rate() of the counters.
+ ************************************************************************/
+
+/* Modification History:
+------------------------------------------------------------------------
+    2026.292     ver 1.0.0	Initial version.
+*/
+
+#define	VERSION		"1.0.0 (2026.292)"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <unistd.h>
+#include <string.h>
+#include <signal.h>
+#include <libgen.h>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "cslimits.h"
+#include "cstypes.h"
+#include "dpstruc.h"
+#include "cfgutil.h"
+#include "service.h"
+#include "timeutil.h"
+#include "stuff.h"
+#include "chanstats.h"
+
+#define	QUOTE(x)	#x
+#define	STRING(x)	QUOTE(x)
+
+#define	DEFAULT_PORT	9330
+#define	REQUEST_TIMEOUT	5		/* Seconds to wait for a request.	*/
+#define	MAX_REQUEST	4096
+
+#define ANNOUNCE(cmd,fp)							\
+    ( fprintf (fp, "%s - Using STATIONS_INI=%s NETWORK_INI=%s\n", \
+	      cmd, get_stations_ini_pathname(), get_network_ini_pathname()) )
+
+char *syntax[] = {
+"%s version " VERSION,
+"%s [-p port] [-a address] [-v] [-h] [station_list]",
+"    where:",
+"	-p port	    Serve metrics on TCP port (default " STRING(DEFAULT_PORT) ").",
+"	-a address  Listen only on this local address (default all).",
+"	-v	    Log each request.",
+"	-h	    Print brief help message for syntax.",
+"	station_list",
+"		    Stations to export.  Default is all stations in STATIONS_INI.",
+"		    List can be multiple tokens or comma-delimited list.",
+"Examples:",
+"	csmetrics		export all stations on port " STRING(DEFAULT_PORT) ".",
+"	csmetrics -p 9400 WDC,CMB	export stations WDC and CMB on port 9400.",
+" Notes",
+" 1.  Scrape http://host:port/metrics.",
+NULL };
+
+static const char *ring_name[NUMQ] = {
+    "data", "detection", "calibration", "timing", "log", "blockette"
+};
+static const double hist_bounds[CS_HIST_BUCKETS-1] = CS_HIST_BOUNDS;
+
+/************************************************************************
+ *  Snapshot of one station, taken for each request.
+ ************************************************************************/
+typedef struct _station_info {
+    char name[CSMAXFILELEN];		/* Station name.		*/
+    int segkey;				/* Server segment key.		*/
+    int up;				/* Server running with a table.	*/
+    int pid;				/* Server pid.			*/
+    double start_time;			/* When the table was created.	*/
+    uint32_t dropped;			/* Records of channels not kept.*/
+    int nchan;				/* Channels in chan.		*/
+    cs_server_stats server;
+    cs_chan_stats *chan;
+} STATION_INFO;
+
+typedef struct _outbuf {		/* Growing response buffer.	*/
+    char *buf;
+    size_t len;
+    size_t size;
+} OUTBUF;
+
+char *cmdname;				/* Name of this program.	*/
+FILE *info;				/* Output FILE for info.	*/
+int verbose;
+int terminate_proc;
+char **selected;			/* Stations to export, or NULL.	*/
+int nselected;
+
+tstations_struc stations;
+STATION_INFO station_info[MAXSTATIONS];
+int nstations;
+
+int print_syntax (char *cmd, char *syntax[], FILE *fp);
+void finish_handler (int sig);
+int open_listener (char *address, int port);
+void serve_request (int fd);
+void take_snapshot (void);
+void free_snapshot (void);
+void write_metrics (OUTBUF *out);
+
+/************************************************************************
+ *  main procedure
+ ************************************************************************/
+int main (int argc, char **argv)
+{
+    int port = DEFAULT_PORT;
+    char *address = NULL;
+    struct pollfd pfd;
+    int listenfd, fd;
+    char *p, *token;
+    int i;
+
+    /* Variables needed for getopt. */
+    extern char	*optarg;
+    extern int	optind, opterr;
+    int		ch;
+
+    info = stdout;
+    cmdname = basename(strdup(argv[0]));
+    while ( (ch = getopt(argc,argv,"hvp:a:")) != -1)
+	switch (ch) {
+	case '?':
+	case 'h':   ANNOUNCE(cmdname,info); print_syntax(cmdname,syntax,info); exit(1);
+	case 'v':   verbose = 1; break;
+	case 'p':   port = atoi(optarg); break;
+	case 'a':   address = optarg; break;
+	default:
+	    fprintf (info, "Unsupported option: -%c\n", ch);
+	    exit(1);
+	}
+
+    /*	Skip over all options and their arguments.			*/
+    argv = &(argv[optind]);
+    argc -= optind;
+
+    if (port <= 0 || port > 65535) {
+	fprintf (info, "Invalid port: %d\n", port);
+	exit(1);
+    }
+
+    /* Remaining arguments are the (comma-delimited) stations.		*/
+    for (i = 0; i < argc; i++) {
+	for (p = argv[i]; (token = strtok(p, ",")) != NULL; p = NULL) {
+	    selected = (char **)realloc (selected, (nselected+1) * sizeof(char *));
+	    selected[nselected] = strdup(token);
+	    upshift(selected[nselected]);
+	    if (strcmp(selected[nselected], "ALL") == 0
+		|| strcmp(selected[nselected], "*") == 0) {
+		nselected = 0;
+		break;
+	    }
+	    ++nselected;
+	}
+	if (nselected == 0) break;
+    }
+
+    signal (SIGPIPE, SIG_IGN);
+    signal (SIGINT, finish_handler);
+    signal (SIGTERM, finish_handler);
+
+    if ((listenfd = open_listener (address, port)) < 0) exit(1);
+    ANNOUNCE(cmdname,info);
+    fprintf (info, "%s - %s version %s serving metrics on %s:%d\n",
+	     localtime_string(dtime()), cmdname, VERSION,
+	     (address != NULL) ? address : "*", port);
+    fflush (info);
+
+    pfd.fd = listenfd;
+    pfd.events = POLLIN;
+    while (! terminate_proc) {
+	if (poll (&pfd, 1, 1000) <= 0) continue;
+	if ((fd = accept (listenfd, NULL, NULL)) < 0) continue;
+	serve_request (fd);
+	close (fd);
+    }
+    close (listenfd);
+    fprintf (info, "%s - %s terminated\n", localtime_string(dtime()), cmdname);
+    return (0);
+}
+
+/************************************************************************
+ *  print_syntax:
+ *	Print the syntax description of program.
+ ************************************************************************/
+int print_syntax (char	*cmd,		/* program name.			*/
+		  char	*syntax[],	/* syntax array.			*/
+		  FILE	*fp)		/* FILE ptr for output.			*/
+{
+    int i;
+    for (i=0; syntax[i] != NULL; i++) {
+	fprintf (fp, syntax[i], cmd);
+	fprintf (fp, "\n");
+    }
+    return (0);
+}
+
+/************************************************************************
+ *  finish_handler:
+ *	Signal handler to terminate the program.
+ ************************************************************************/
+void finish_handler (int sig)
+{
+    signal (sig, finish_handler);
+    terminate_proc = 1;
+}
+
+/************************************************************************
+ *  open_listener:
+ *	Open the TCP socket for HTTP requests.
+ *  Return the socket, or -1 on error.
+ ************************************************************************/
+int open_listener (char *address, int port)
+{
+    struct sockaddr_in addr;
+    int fd, on = 1;
+
+    memset (&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (address != NULL && inet_pton (AF_INET, address, &addr.sin_addr) != 1) {
+	fprintf (info, "Invalid address: %s\n", address);
+	return (-1);
+    }
+    if ((fd = socket (AF_INET, SOCK_STREAM, 0)) < 0) {
+	fprintf (info, "Unable to create socket: %s\n", strerror(errno));
+	return (-1);
+    }
+    setsockopt (fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    if (bind (fd, (struct sockaddr *)&addr, sizeof(addr)) < 0
+	|| listen (fd, 8) < 0) {
+	fprintf (info, "Unable to listen on port %d: %s\n", port, strerror(errno));
+	close (fd);
+	return (-1);
+    }
+    return (fd);
+}
+
+/************************************************************************
+ *  outbuf_printf:
+ *	Append formatted text to the response buffer.
+ ************************************************************************/
+void outbuf_printf (OUTBUF *out, const char *fmt, ...)
+{
+    va_list ap;
+    int n;
+
+    while (1) {
+	va_start (ap, fmt);
+	n = vsnprintf (out->buf + out->len, out->size - out->len, fmt, ap);
+	va_end (ap);
+	if (n >= 0 && out->len + n < out->size) break;
+	out->size = (out->size == 0) ? 65536 : 2 * out->size;
+	if (n >= 0 && out->len + n >= out->size) out->size = out->len + n + 1;
+	if ((out->buf = (char *)realloc (out->buf, out->size)) == NULL) {
+	    fprintf (info, "%s - Unable to allocate response buffer\n",
+		     localtime_string(dtime()));
+	    exit(1);
+	}
+    }
+    out->len += n;
+}
+
+/************************************************************************
+ *  write_all:
+ *	Write the entire buffer to the socket.
+ ************************************************************************/
+int write_all (int fd, const char *buf, size_t len)
+{
+    ssize_t n;
+
+    while (len > 0) {
+	if ((n = write (fd, buf, len)) < 0) {
+	    if (errno == EINTR) continue;
+	    return (-1);
+	}
+	buf += n;
+	len -= n;
+    }
+    return (0);
+}
+
+/************************************************************************
+ *  serve_request:
+ *	Read one HTTP request and answer it.
+ ************************************************************************/
+void serve_request (int fd)
+{
+    struct timeval tv;
+    char request[MAX_REQUEST+1];
+    char header[256];
+    int len = 0, n;
+    OUTBUF out = { NULL, 0, 0 };
+    const char *status = "200 OK";
+
+    tv.tv_sec = REQUEST_TIMEOUT;
+    tv.tv_usec = 0;
+    setsockopt (fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt (fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+    /* Only the request line matters, but read the headers so that	*/
+    /* the client does not see a reset.					*/
+    while (len < MAX_REQUEST) {
+	if ((n = read (fd, request + len, MAX_REQUEST - len)) <= 0) break;
+	len += n;
+	request[len] = '\0';
+	if (strstr (request, "\r\n\r\n") || strstr (request, "\n\n")) break;
+    }
+    request[len] = '\0';
+    if (len == 0) return;
+
+    if (strncmp (request, "GET /metrics ", 13) == 0
+	|| strncmp (request, "GET /metrics?", 13) == 0) {
+	take_snapshot ();
+	write_metrics (&out);
+	free_snapshot ();
+    }
+    else if (strncmp (request, "GET ", 4) == 0) {
+	status = "404 Not Found";
+	outbuf_printf (&out, "Metrics are at /metrics\n");
+    }
+    else {
+	status = "405 Method Not Allowed";
+	outbuf_printf (&out, "Only GET is supported\n");
+    }
+
+    snprintf (header, sizeof(header),
+	      "HTTP/1.0 %s\r\n"
+	      "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+	      "Content-Length: %lu\r\n"
+	      "Connection: close\r\n\r\n",
+	      status, (unsigned long)out.len);
+    if (write_all (fd, header, strlen(header)) == 0)
+	write_all (fd, out.buf, out.len);
+    if (verbose) {
+	request[strcspn (request, "\r\n")] = '\0';
+	fprintf (info, "%s - %s: %s, %lu bytes\n", localtime_string(dtime()),
+		 request, status, (unsigned long)out.len);
+	fflush (info);
+    }
+    free (out.buf);
+}
+
+/************************************************************************
+ *  take_snapshot:
+ *	Find all stations, and copy the statistics of each running server.
+ *	The station list is read for every request, so that stations
+ *	added to STATIONS_INI are exported without a restart.
+ ************************************************************************/
+void take_snapshot (void)
+{
+    STATION_INFO *s;
+    pserver_struc base;
+    cs_stats_table *t;
+    void *segment;
+    int i, j, n;
+
+    cs_setup (&stations, (pchar)"CSMETRICS", (pchar)"*", TRUE, FALSE,
+	      1, 1, 0, 100);
+    nstations = 0;
+    for (i = 0; i < stations.station_count; i++) {
+	s = &station_info[nstations];
+	memset (s, 0, sizeof(STATION_INFO));
+	strncpy (s->name, (char *)sname_str_cs(stations.station_list[i].stationname),
+		 sizeof(s->name)-1);
+	if (nselected > 0) {
+	    for (j = 0; j < nselected; j++)
+		if (strcasecmp (s->name, selected[j]) == 0) break;
+	    if (j >= nselected) continue;
+	}
+	++nstations;
+	s->segkey = stations.station_list[i].segkey;
+	if (s->segkey == NOCLIENT) continue;
+	if ((t = cs_stats_attach (s->segkey, &segment)) == NULL) continue;
+	base = (pserver_struc)segment;
+	s->pid = base->server_pid;
+	s->up = (s->pid > 0 && (kill (s->pid, 0) == 0 || errno == EPERM));
+	s->start_time = t->start_time;
+	s->dropped = t->dropped;
+	cs_stats_read_server (t, &s->server);
+	n = t->nchan;
+	if (n > (int)t->maxchan) n = t->maxchan;
+	if (n > 0) s->chan = (cs_chan_stats *)malloc (n * sizeof(cs_chan_stats));
+	for (j = 0; j < n && s->chan != NULL; j++) {
+	    if (cs_stats_read (t, j, &s->chan[s->nchan]) == 0) ++s->nchan;
+	}
+	cs_stats_detach (segment);
+    }
+}
+
+void free_snapshot (void)
+{
+    int i;
+
+    for (i = 0; i < nstations; i++) {
+	free (station_info[i].chan);
+	station_info[i].chan = NULL;
+    }
+}
+
+/************************************************************************
+ *  label:
+ *	Return a label value with backslash, quote and newline escaped.
+ *	The result is valid until the next call with the same slot.
+ ************************************************************************/
+char *label (int slot, const char *value)
+{
+    static char buf[4][128];
+    char *p = buf[slot];
+
+    while (*value && p < buf[slot] + sizeof(buf[slot]) - 3) {
+	if (*value == '\\' || *value == '"') *p++ = '\\';
+	if (*value == '\n') { *p++ = '\\'; *p++ = 'n'; value++; continue; }
+	*p++ = *value++;
+    }
+    *p = '\0';
+    return (buf[slot]);
+}
+
+void family (OUTBUF *out, const char *name, const char *type, const char *help)
+{
+    outbuf_printf (out, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+/************************************************************************
+ *  write_histogram:
+ *	Write one station's series of a histogram family.
+ ************************************************************************/
+void write_histogram (OUTBUF *out, const char *name, const char *station,
+		      const cs_hist *h)
+{
+    uint64_t cumulative = 0;
+    int i;
+
+    for (i = 0; i < CS_HIST_BUCKETS - 1; i++) {
+	cumulative += h->bucket[i];
+	outbuf_printf (out, "%s_bucket{station=\"%s\",le=\"%g\"} %llu\n",
+		       name, station, hist_bounds[i], (unsigned long long)cumulative);
+    }
+    outbuf_printf (out, "%s_bucket{station=\"%s\",le=\"+Inf\"} %llu\n",
+		   name, station, (unsigned long long)h->count);
+    outbuf_printf (out, "%s_sum{station=\"%s\"} %.9g\n", name, station, h->sum);
+    outbuf_printf (out, "%s_count{station=\"%s\"} %llu\n",
+		   name, station, (unsigned long long)h->count);
+}
+
+/************************************************************************
+ *  write_metrics:
+ *	Write the snapshot in the Prometheus text format.  All series
+ *	of a metric family must be together, so each family loops over
+ *	the stations.
+ ************************************************************************/
+
+#define	FOR_UP_STATIONS(s)						\
+    for (s = station_info; s < station_info + nstations; s++)		\
+	if (s->up)
+#define	ST(s)		label(0, s->name)
+#define	LLU(v)		((unsigned long long)(v))
+
+void write_metrics (OUTBUF *out)
+{
+    STATION_INFO *s;
+    cs_server_stats *ss;
+    cs_client_stats *cs;
+    cs_chan_stats *c;
+    double now = dtime();
+    int i, q;
+
+    family (out, "comserv_up", "gauge",
+	    "1 if the station's server is running and has a statistics table.");
+    for (s = station_info; s < station_info + nstations; s++)
+	outbuf_printf (out, "comserv_up{station=\"%s\"} %d\n", ST(s), s->up);
+
+    family (out, "comserv_start_time_seconds", "gauge",
+	    "When the server created its statistics table.");
+    FOR_UP_STATIONS(s)
+	outbuf_printf (out, "comserv_start_time_seconds{station=\"%s\"} %.3f\n",
+		       ST(s), s->start_time);
+
+    family (out, "comserv_packets_total", "counter", "Packets queued in each comserv ring.");
+    FOR_UP_STATIONS(s)
+	for (q = 0; q < NUMQ; q++)
+	    outbuf_printf (out, "comserv_packets_total{station=\"%s\",ring=\"%s\"} %llu\n",
+			   ST(s), ring_name[q], LLU(s->server.packets[q]));
+
+    family (out, "comserv_bytes_total", "counter", "Bytes queued in the comserv rings.");
+    FOR_UP_STATIONS(s)
+	outbuf_printf (out, "comserv_bytes_total{station=\"%s\"} %llu\n",
+		       ST(s), LLU(s->server.bytes));
+
+    family (out, "comserv_ring_size", "gauge", "Packets each comserv ring can hold.");
+    FOR_UP_STATIONS(s)
+	for (q = 0; q < NUMQ; q++)
+	    outbuf_printf (out, "comserv_ring_size{station=\"%s\",ring=\"%s\"} %u\n",
+			   ST(s), ring_name[q], s->server.ring_count[q]);
+
+    family (out, "comserv_ring_packets", "gauge", "Packets held in each comserv ring.");
+    FOR_UP_STATIONS(s)
+	for (q = 0; q < NUMQ; q++)
+	    outbuf_printf (out, "comserv_ring_packets{station=\"%s\",ring=\"%s\"} %u\n",
+			   ST(s), ring_name[q], s->server.ring_used[q]);
+
+    family (out, "comserv_ring_blocked_packets", "gauge",
+	    "Packets in each ring held for blocking clients.");
+    FOR_UP_STATIONS(s)
+	for (q = 0; q < NUMQ; q++)
+	    outbuf_printf (out, "comserv_ring_blocked_packets{station=\"%s\",ring=\"%s\"} %u\n",
+			   ST(s), ring_name[q], s->server.ring_blocked[q]);
+
+    family (out, "comserv_ring_full_total", "counter",
+	    "Packets that found their ring full of blocked packets.");
+    FOR_UP_STATIONS(s)
+	outbuf_printf (out, "comserv_ring_full_total{station=\"%s\"} %u\n",
+		       ST(s), s->server.ring_full);
+
+    family (out, "comserv_packet_queue_depth", "gauge",
+	    "Packets waiting in the server's intermediate PacketQueue.");
+    FOR_UP_STATIONS(s)
+	if (s->server.queue_size > 0)
+	    outbuf_printf (out, "comserv_packet_queue_depth{station=\"%s\"} %u\n",
+			   ST(s), s->server.queue_depth);
+
+    family (out, "comserv_packet_queue_size", "gauge",
+	    "Size of the server's intermediate PacketQueue.");
+    FOR_UP_STATIONS(s)
+	if (s->server.queue_size > 0)
+	    outbuf_printf (out, "comserv_packet_queue_size{station=\"%s\"} %u\n",
+			   ST(s), s->server.queue_size);
+
+    family (out, "comserv_throttle_events_total", "counter",
+	    "Times the data logger callback was delayed because the PacketQueue was nearly full.");
+    FOR_UP_STATIONS(s)
+	outbuf_printf (out, "comserv_throttle_events_total{station=\"%s\"} %u\n",
+		       ST(s), s->server.throttle_events);
+
+    family (out, "comserv_throttle_seconds_total", "counter",
+	    "Total delay of the data logger callback.");
+    FOR_UP_STATIONS(s)
+	outbuf_printf (out, "comserv_throttle_seconds_total{station=\"%s\"} %.3f\n",
+		       ST(s), s->server.throttle_seconds);
+
+    family (out, "comserv_link_up", "gauge", "1 if the data logger link is running.");
+    FOR_UP_STATIONS(s)
+	if (s->server.link_up >= 0)
+	    outbuf_printf (out, "comserv_link_up{station=\"%s\"} %d\n",
+			   ST(s), s->server.link_up);
+
+    family (out, "comserv_link_buffer_fill_percent", "gauge",
+	    "Percent of the data logger packet buffer in use.");
+    FOR_UP_STATIONS(s)
+	if (s->server.link_buffer_fill >= 0)
+	    outbuf_printf (out, "comserv_link_buffer_fill_percent{station=\"%s\"} %d\n",
+			   ST(s), s->server.link_buffer_fill);
+
+    family (out, "comserv_link_rtt_seconds", "gauge",
+	    "Smoothed round trip time of the data logger data port.");
+    FOR_UP_STATIONS(s)
+	if (s->server.link_rtt > 0.0)
+	    outbuf_printf (out, "comserv_link_rtt_seconds{station=\"%s\"} %.6f\n",
+			   ST(s), s->server.link_rtt);
+
+    family (out, "comserv_link_retransmits_total", "counter",
+	    "Data packets received from the data logger more than once.");
+    FOR_UP_STATIONS(s)
+	if (s->server.link_up >= 0)
+	    outbuf_printf (out, "comserv_link_retransmits_total{station=\"%s\"} %u\n",
+			   ST(s), s->server.link_retransmits);
+
+    family (out, "comserv_link_stalls_total", "counter",
+	    "Times the data logger filled its sliding window.");
+    FOR_UP_STATIONS(s)
+	if (s->server.link_up >= 0)
+	    outbuf_printf (out, "comserv_link_stalls_total{station=\"%s\"} %u\n",
+			   ST(s), s->server.link_stalls);
+
+    family (out, "comserv_queue_delay_seconds", "histogram",
+	    "Time from packet reception to its comserv ring.");
+    FOR_UP_STATIONS(s)
+	write_histogram (out, "comserv_queue_delay_seconds", ST(s), &s->server.queue_delay);
+
+    family (out, "comserv_callback_seconds", "histogram",
+	    "Time spent in the data logger library's data callback.");
+    FOR_UP_STATIONS(s)
+	if (s->server.callback_time.count > 0)
+	    write_histogram (out, "comserv_callback_seconds", ST(s), &s->server.callback_time);
+
+    family (out, "comserv_client_lag_packets", "gauge",
+	    "Packets a client has not yet acknowledged.");
+    FOR_UP_STATIONS(s) {
+	ss = &s->server;
+	for (i = 0, cs = ss->client; i < (int)ss->nclients && i < MAXCLIENTS; i++, cs++)
+	    if (cs->pid != NOCLIENT)
+		outbuf_printf (out, "comserv_client_lag_packets{station=\"%s\",client=\"%s\",blocking=\"%d\"} %u\n",
+			       ST(s), label(1, cs->name), cs->blocking ? 1 : 0, cs->lag_packets);
+    }
+
+    family (out, "comserv_client_lag_seconds", "gauge",
+	    "Age of the oldest packet a client has not yet acknowledged.");
+    FOR_UP_STATIONS(s) {
+	ss = &s->server;
+	for (i = 0, cs = ss->client; i < (int)ss->nclients && i < MAXCLIENTS; i++, cs++)
+	    if (cs->pid != NOCLIENT)
+		outbuf_printf (out, "comserv_client_lag_seconds{station=\"%s\",client=\"%s\",blocking=\"%d\"} %.3f\n",
+			       ST(s), label(1, cs->name), cs->blocking ? 1 : 0, cs->lag_seconds);
+    }
+
+    family (out, "comserv_channels", "gauge", "Channels in the server's statistics table.");
+    FOR_UP_STATIONS(s)
+	outbuf_printf (out, "comserv_channels{station=\"%s\"} %d\n", ST(s), s->nchan);
+
+    family (out, "comserv_channel_dropped_records_total", "counter",
+	    "Records of channels that did not fit in the statistics table.");
+    FOR_UP_STATIONS(s)
+	outbuf_printf (out, "comserv_channel_dropped_records_total{station=\"%s\"} %u\n",
+		       ST(s), s->dropped);
+
+#define	CHANNEL_LABELS	"station=\"%s\",network=\"%s\",channel=\"%s\",location=\"%s\""
+#define	CHANNEL_VALUES(s,c)	ST(s), label(1, c->net), label(2, c->channel), label(3, c->location)
+
+    family (out, "comserv_channel_records_total", "counter", "Records received for a channel.");
+    FOR_UP_STATIONS(s)
+	for (c = s->chan; c < s->chan + s->nchan; c++)
+	    outbuf_printf (out, "comserv_channel_records_total{" CHANNEL_LABELS "} %u\n",
+			   CHANNEL_VALUES(s,c), c->records);
+
+    family (out, "comserv_channel_samples_total", "counter", "Samples received for a channel.");
+    FOR_UP_STATIONS(s)
+	for (c = s->chan; c < s->chan + s->nchan; c++)
+	    outbuf_printf (out, "comserv_channel_samples_total{" CHANNEL_LABELS "} %llu\n",
+			   CHANNEL_VALUES(s,c), LLU(c->samples));
+
+    family (out, "comserv_channel_latency_seconds", "gauge",
+	    "Time since the end of the channel's last record.");
+    FOR_UP_STATIONS(s)
+	for (c = s->chan; c < s->chan + s->nchan; c++)
+	    if (c->last_end > 0.0)
+		outbuf_printf (out, "comserv_channel_latency_seconds{" CHANNEL_LABELS "} %.3f\n",
+			       CHANNEL_VALUES(s,c), now - c->last_end);
+
+    family (out, "comserv_channel_last_reception_seconds", "gauge",
+	    "When the channel's last record was received.");
+    FOR_UP_STATIONS(s)
+	for (c = s->chan; c < s->chan + s->nchan; c++)
+	    outbuf_printf (out, "comserv_channel_last_reception_seconds{" CHANNEL_LABELS "} %.3f\n",
+			   CHANNEL_VALUES(s,c), c->last_reception);
+
+    family (out, "comserv_channel_gaps_total", "counter", "Gaps in a channel's data.");
+    FOR_UP_STATIONS(s)
+	for (c = s->chan; c < s->chan + s->nchan; c++)
+	    outbuf_printf (out, "comserv_channel_gaps_total{" CHANNEL_LABELS "} %u\n",
+			   CHANNEL_VALUES(s,c), c->gaps);
+
+    family (out, "comserv_channel_gap_seconds_total", "counter", "Total length of a channel's gaps.");
+    FOR_UP_STATIONS(s)
+	for (c = s->chan; c < s->chan + s->nchan; c++)
+	    outbuf_printf (out, "comserv_channel_gap_seconds_total{" CHANNEL_LABELS "} %.6f\n",
+			   CHANNEL_VALUES(s,c), c->gap_seconds);
+
+    family (out, "comserv_channel_overlaps_total", "counter", "Overlaps in a channel's data.");
+    FOR_UP_STATIONS(s)
+	for (c = s->chan; c < s->chan + s->nchan; c++)
+	    outbuf_printf (out, "comserv_channel_overlaps_total{" CHANNEL_LABELS "} %u\n",
+			   CHANNEL_VALUES(s,c), c->overlaps);
+}
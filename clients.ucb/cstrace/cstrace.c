@@ -0,0 +1,312 @@
+/************************************************************************
+ *  cstrace - Report where packets spend their time in a comserv server.
+ *
+ *  A server started with PKTTRACE=n in its station.ini section keeps
+ *  the times at which each of its last n packets passed each stage of
+ *  the data path in its shared memory segment (pkttrace.h).  cstrace
+ *  attaches read-only to the segment of the station, copies the table,
+ *  and prints the percentiles of the time spent between consecutive
+ *  stages, and of the total time from the data logger to the comserv
+ *  ring and to the first client.  A stage that a packet did not pass
+ *  (for example the PacketQueue of a packet that was copied straight
+ *  into its ring) is skipped, and its time is charged to the next stage.
+ ************************************************************************/
+
+/* Modification History:
+------------------------------------------------------------------------
+    2026.292     ver 1.0.0	Initial version.
+*/
+
+#define	VERSION		"1.0.0 (2026.292)"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include <unistd.h>
+#include <string.h>
+#include <signal.h>
+#include <libgen.h>
+#include <sys/types.h>
+#include <sys/shm.h>
+
+#include "cslimits.h"
+#include "cstypes.h"
+#include "dpstruc.h"
+#include "cfgutil.h"
+#include "service.h"
+#include "timeutil.h"
+#include "stuff.h"
+#include "pkttrace.h"
+
+#define ANNOUNCE(cmd,fp)							\
+    ( fprintf (fp, "%s - Using STATIONS_INI=%s NETWORK_INI=%s\n", \
+	      cmd, get_stations_ini_pathname(), get_network_ini_pathname()) )
+
+char *syntax[] = {
+"%s version " VERSION,
+"%s [-a] [-l] [-r interval] [-h] station",
+"    where:",
+"	-a	    Report packets of all rings (default the data ring only).",
+"	-l	    List the stage times of each packet.",
+"	-r interval Report again every interval seconds, on the packets",
+"		    queued since the previous report.",
+"	-h	    Print brief help message for syntax.",
+"	station	    Station whose server to report.",
+"Examples:",
+"	cstrace WDC		report the last packets traced by WDC.",
+"	cstrace -r 60 WDC	report WDC every minute.",
+" Notes",
+" 1.  The server must be running with PKTTRACE=n in its station.ini section.",
+" 2.  Times are in milliseconds.",
+NULL };
+
+static const char *stage_name[PT_NSTAGES] = PT_STAGE_NAMES;
+
+#define	NROWS		(PT_NSTAGES + 2)	/* Stages and two totals.	*/
+#define	ROW_TO_QUEUE	PT_NSTAGES
+#define	ROW_TO_DELIVER	(PT_NSTAGES + 1)
+
+typedef struct _samples {		/* Latencies of one report row.	*/
+    double *v;
+    int n;
+} SAMPLES;
+
+char *cmdname;				/* Name of this program.	*/
+FILE *info;				/* Output FILE for info.	*/
+int terminate_proc;
+
+int print_syntax (char *cmd, char *syntax[], FILE *fp);
+void finish_handler (int sig);
+int find_segkey (char *station);
+int report (pkt_trace_table *t, int all_rings, int list, int32_t *last_packet);
+
+/************************************************************************
+ *  main procedure
+ ************************************************************************/
+int main (int argc, char **argv)
+{
+    int all_rings = 0;
+    int list = 0;
+    int interval = 0;
+    int32_t last_packet = -1;
+    pkt_trace_table *t;
+    void *segment;
+    char *station;
+    int segkey;
+
+    /* Variables needed for getopt. */
+    extern char	*optarg;
+    extern int	optind, opterr;
+    int		ch;
+
+    info = stdout;
+    cmdname = basename(strdup(argv[0]));
+    while ( (ch = getopt(argc,argv,"halr:")) != -1)
+	switch (ch) {
+	case '?':
+	case 'h':   ANNOUNCE(cmdname,info); print_syntax(cmdname,syntax,info); exit(1);
+	case 'a':   all_rings = 1; break;
+	case 'l':   list = 1; break;
+	case 'r':   interval = atoi(optarg); break;
+	default:
+	    fprintf (info, "Unsupported option: -%c\n", ch);
+	    exit(1);
+	}
+
+    /*	Skip over all options and their arguments.			*/
+    argv = &(argv[optind]);
+    argc -= optind;
+
+    if (argc != 1) {
+	ANNOUNCE(cmdname,info);
+	print_syntax(cmdname,syntax,info);
+	exit(1);
+    }
+    station = strdup(argv[0]);
+    upshift(station);
+
+    if ((segkey = find_segkey (station)) == NOCLIENT) {
+	fprintf (info, "Station %s not found in %s\n", station,
+		 get_stations_ini_pathname());
+	exit(1);
+    }
+    if ((t = pkttrace_attach (segkey, &segment)) == NULL) {
+	fprintf (info, "The server for station %s is not running or is not tracing packets\n",
+		 station);
+	exit(1);
+    }
+
+    signal (SIGINT, finish_handler);
+    signal (SIGTERM, finish_handler);
+
+    while (1) {
+	printf ("%s - Station %s\n", localtime_string(dtime()), station);
+	report (t, all_rings, list, &last_packet);
+	fflush (stdout);
+	if (interval <= 0) break;
+	sleep (interval);
+	if (terminate_proc) break;
+    }
+    shmdt ((char *)segment);
+    return (0);
+}
+
+/************************************************************************
+ *  print_syntax:
+ *	Print the syntax description of program.
+ ************************************************************************/
+int print_syntax (char	*cmd,		/* program name.			*/
+		  char	*syntax[],	/* syntax array.			*/
+		  FILE	*fp)		/* FILE ptr for output.			*/
+{
+    int i;
+    for (i=0; syntax[i] != NULL; i++) {
+	fprintf (fp, syntax[i], cmd);
+	fprintf (fp, "\n");
+    }
+    return (0);
+}
+
+/************************************************************************
+ *  finish_handler:
+ *	Signal handler to terminate the program.
+ ************************************************************************/
+void finish_handler (int sig)
+{
+    signal (sig, finish_handler);
+    terminate_proc = 1;
+}
+
+/************************************************************************
+ *  find_segkey:
+ *	Return the server segment key of the station, or NOCLIENT.
+ ************************************************************************/
+int find_segkey (char *station)
+{
+    tstations_struc stations;
+    int i;
+
+    cs_setup (&stations, (pchar)"CSTRACE", (pchar)"*", TRUE, FALSE,
+	      1, 1, 0, 100);
+    for (i = 0; i < stations.station_count; i++) {
+	if (strcasecmp ((char *)sname_str_cs(stations.station_list[i].stationname),
+			station) == 0)
+	    return (stations.station_list[i].segkey);
+    }
+    return (NOCLIENT);
+}
+
+/************************************************************************
+ *  compare_double:
+ *	qsort comparison function.
+ ************************************************************************/
+int compare_double (const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return ((x < y) ? -1 : (x > y) ? 1 : 0);
+}
+
+/************************************************************************
+ *  percentile:
+ *	Return percentile p of the sorted samples.
+ ************************************************************************/
+double percentile (SAMPLES *s, double p)
+{
+    int i = (int)(p / 100. * s->n);
+    if (i >= s->n) i = s->n - 1;
+    return (s->v[i]);
+}
+
+/************************************************************************
+ *  add_sample:
+ *	Add a latency in nanoseconds to a report row.
+ ************************************************************************/
+void add_sample (SAMPLES *s, int64_t ns)
+{
+    s->v[s->n++] = ns / 1.0e6;
+}
+
+/************************************************************************
+ *  report:
+ *	Print the latency percentiles of the packets in the table.
+ *	Only packets after *last_packet are reported, and *last_packet
+ *	is set to the last packet reported.
+ *  Return the number of packets reported.
+ ************************************************************************/
+int report (pkt_trace_table *t, int all_rings, int list, int32_t *last_packet)
+{
+    SAMPLES rows[NROWS];
+    pkt_trace_entry e;
+    int32_t newest = *last_packet;
+    int64_t first, prev;
+    int npackets = 0;
+    int i, j, k;
+
+    for (k = 0; k < NROWS; k++) {
+	rows[k].n = 0;
+	if ((rows[k].v = (double *)malloc (t->nentries * sizeof(double))) == NULL) {
+	    fprintf (info, "Unable to allocate %u samples\n", t->nentries);
+	    exit(1);
+	}
+    }
+
+    if (list) {
+	printf ("%10s %4s", "packet", "ring");
+	for (j = 0; j < PT_NSTAGES; j++) printf (" %10s", stage_name[j]);
+	printf ("\n");
+    }
+    for (i = 0; i < (int)t->nentries; i++) {
+	if (pkttrace_read (t, i, &e) != 0) continue;
+	if (e.packet_num <= *last_packet) continue;
+	if (! all_rings && e.qnum != DATAQ) continue;
+	if (e.packet_num > newest) newest = e.packet_num;
+	++npackets;
+
+	/* Charge each stage with the time since the previous stage	*/
+	/* that the packet passed.					*/
+	first = prev = 0;
+	for (j = 0; j < PT_NSTAGES; j++) {
+	    if (e.trace.t[j] == 0) continue;
+	    if (prev != 0) add_sample (&rows[j], e.trace.t[j] - prev);
+	    else first = e.trace.t[j];
+	    prev = e.trace.t[j];
+	}
+	if (first != 0 && e.trace.t[PT_QUEUE] != 0)
+	    add_sample (&rows[ROW_TO_QUEUE], e.trace.t[PT_QUEUE] - first);
+	if (first != 0 && e.trace.t[PT_DELIVER] != 0)
+	    add_sample (&rows[ROW_TO_DELIVER], e.trace.t[PT_DELIVER] - first);
+
+	if (list) {
+	    printf ("%10d %4d", e.packet_num, e.qnum);
+	    for (j = 0; j < PT_NSTAGES; j++) {
+		if (e.trace.t[j] == 0) printf (" %10s", "-");
+		else printf (" %10.3f", (e.trace.t[j] - first) / 1.0e6);
+	    }
+	    printf ("\n");
+	}
+    }
+
+    printf ("%d packets traced since %s, %d reported from %s\n",
+	    (int)t->committed, localtime_string(t->start_time), npackets,
+	    all_rings ? "all rings" : "the data ring");
+    if (npackets > 0) {
+	printf ("%-16s %8s %10s %10s %10s %10s %10s\n",
+		"stage (msec)", "count", "p50", "p90", "p99", "p99.9", "max");
+	for (k = 0; k < NROWS; k++) {
+	    if (rows[k].n == 0) continue;
+	    qsort (rows[k].v, rows[k].n, sizeof(double), compare_double);
+	    printf ("%-16s %8d %10.3f %10.3f %10.3f %10.3f %10.3f\n",
+		    (k == ROW_TO_QUEUE) ? "total to queue" :
+		    (k == ROW_TO_DELIVER) ? "total to deliver" : stage_name[k],
+		    rows[k].n, percentile (&rows[k], 50.), percentile (&rows[k], 90.),
+		    percentile (&rows[k], 99.), percentile (&rows[k], 99.9),
+		    rows[k].v[rows[k].n-1]);
+	}
+    }
+
+    for (k = 0; k < NROWS; k++) free (rows[k].v);
+    *last_packet = newest;
+    return (npackets);
+}
@@ -20,9 +20,16 @@
 	Added optional debugging info for packets written to disk.
     2022-02-29 DSN ver 1.6.3 (2022.059)
 	Allow environment override of STATIONS_INI pathname.
+    2026-10-19 ver 1.7.0 (2026.292)
+	Added SNCL_REMAP directive.
+    2026-10-19 ver 1.7.1 (2026.292)
+	Wait for data with cs_wait instead of sleeping 1 second.
+    2026-10-19 ver 1.7.2 (2026.292)
+	Close the span index on every close_file path, and remove an
+	index that is no longer maintained.
 */
 
-#define	VERSION		"1.6.3 (2022.038)"
+#define	VERSION		"1.7.2 (2026.292)"
 
 #ifdef COMSERV2
 #define	CLIENT_NAME	"DLOG"
@@ -348,7 +355,7 @@ int main (int argc, char **argv)
 			localtime_string(dtime()));
 		fflush (stdout);
 	    }
-	    sleep (1);		/* Bother the server once every second */
+	    cs_wait (me, 1000000);	/* Bother the server at least once every second */
 	    if (verbosity & 2) {
 		printf ("%s awake\n", localtime_string(dtime()));
 		fflush (stdout);
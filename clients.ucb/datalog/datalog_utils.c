@@ -6,6 +6,9 @@
  *
  * Modification History:
  *  2020-09-29 DSN Updated for comserv3.
+ *  2026-10-19 Added SNCL_REMAP directive using libcsutil sncl_remap.
+ *  2026-10-19 Added SPAN_INDEX directive to maintain a binary time-span
+ *	index for each data file.
  ************************************************************************/
 
 #include <stdio.h>
@@ -39,9 +42,11 @@ off_t lseek (int fd, off_t offset, int whence);
 #include "timeutil.h"
 #include "service.h"
 #include "cfgutil.h"
+#include "sncl_remap.h"
 
 #include "datalog.h"
 #include "datalog_utils.h"
+#include "span_index.h"
 
 #define MAX_BLKSIZE	4096
 #define	MIN_SEED_BLKSIZE 256
@@ -81,6 +86,8 @@ static SEL sel[NUMQ];
 static char close_script[256] = "";
 static int close_offset = 0;
 static int mshdr_wordorder = -1;		/* default is ignore.		*/
+static SNCL_REMAP *sncl_remap = NULL;	/* optional SNCL remap table.	*/
+static int span_index = 0;		/* flag to maintain span indices.	*/
 
 /************************************************************************
  * store_bad_block(char *) - stores bogus blocks for post mortem
@@ -217,6 +224,7 @@ int store_seed (seed_record_header *pseed)
 	    fprintf (info, "Error appending to %s\n", datafile_path(fip));
 	    break;
 	}
+	if (fip->spanx) span_check(fip, hdr, pos);
 
 	/* Update volume header with new endtime. */
 	fip->endtime = int_to_ext(hdr->endtime);
@@ -472,6 +480,11 @@ int open_file(FINFO *fip)
 		 filename, channelstring(fip->station, fip->location, fip->channel, fip->network));
 	return(0);
     }
+    /* Open the span index.  Datalog continues without it on error.	*/
+    if (span_index && fip->itype == DAT_INDEX) {
+	fip->spanx = span_index_open(filename, fip->station, fip->network,
+				     fip->channel, fip->location);
+    }
     return(1);
 }
 
@@ -634,14 +647,23 @@ int close_file(FINFO *fip)
     }
     if (errno != ENOENT) {
 	fprintf (info, "Error %d stating file %s\n", errno, newname);
-	return(0);
+	status = -1;
     }
-    status = rename(oldname,newname);
-    if (status!=0) {
+    else if ((status = rename(oldname,newname)) != 0) {
 	fprintf (info, "Error %d renaming %s to %s\n", errno,
 		 oldname, newname);
-	return(0);
     }
+    /* The index stays with the data file whether or not it was renamed.
+       If only the index cannot be renamed, remove it so it is not
+       resumed for the next file opened under the old name.		*/
+    if (fip->spanx) {
+	if (status == 0 && span_index_rename(fip->spanx, newname) != 0)
+	    span_index_remove(fip->spanx);
+	else
+	    span_index_close(fip->spanx);
+	fip->spanx = NULL;
+    }
+    if (status != 0) return(0);
     if (strlen(close_script) > 0) {
 	sprintf(cmd, "%s %s %s %s", close_script, fip->station, fip->ch_dir,
 		build_name(fip,filename_fmt));
@@ -918,6 +940,19 @@ void parse_cfg (char *str1, char *str2)
     else if (strcmp(str1,"TRIMRECLEN")==0) {
 	trimreclen = boolean_value(str2);
     }
+    else if (strcmp(str1,"SPAN_INDEX")==0) {
+	span_index = boolean_value(str2);
+    }
+    else if (strcmp(str1,"SNCL_REMAP")==0) {	/* SNCL remap rule file	*/
+	if (sncl_remap == NULL && (sncl_remap = sncl_remap_new()) == NULL) {
+	    fprintf (info, "Error allocating SNCL remap table\n");
+	    terminate_program (1);
+	}
+	if (sncl_remap_load (sncl_remap, str2) < 0) {
+	    fprintf (info, "Error loading SNCL remap file: %s\n", str2);
+	    terminate_program (1);
+	}
+    }
 
     /* Set selector and/or data mask for each type of info.		*/
     /* Global selector sets default for data, detection, and cal.	*/
@@ -1490,6 +1525,30 @@ void gap_check (FINFO *fip, DATA_HDR *hdr)
     }
 }
 
+/************************************************************************
+ *  span_check:
+ *	Add the record just written at offset pos to the span index.
+ *	On error the index is removed and no longer maintained for this
+ *	file, since an incomplete index would report false gaps.
+ ************************************************************************/
+void span_check (FINFO *fip, DATA_HDR *hdr, off_t pos)
+{
+    double srate;
+    int64_t start, end;
+
+    srate = sps_rate(hdr->sample_rate, hdr->sample_rate_mult);
+    if (srate <= 0. || hdr->num_samples <= 0) return;
+    start = (int64_t)floor(int_to_tepoch(hdr->begtime) * USECS_PER_SEC + 0.5);
+    end = (int64_t)floor(int_to_tepoch(hdr->endtime) * USECS_PER_SEC + 0.5) +
+	(int64_t)(USECS_PER_SEC / srate + 0.5);
+    if (span_index_add(fip->spanx, start, end, srate, pos) < 0) {
+	fprintf (info, "Error updating span index for %s - index disabled\n",
+		 datafile_path(fip));
+	span_index_remove(fip->spanx);
+	fip->spanx = NULL;
+    }
+}
+
 /************************************************************************
  *  reduce_reclen:
  *	Change the blocksize of the record if it appears that all
@@ -1646,6 +1705,8 @@ int check_hdr_wordorder (DATA_HDR *hdr, SDR_HDR *pseed)
 /************************************************************************
  *  fix_sncl:
  *	Perform any custom mangling of the SNCL.
+ *	SNCL_REMAP rules are applied to the raw MiniSEED header, and the
+ *	decoded header is updated to match.
  ************************************************************************/
 int fix_sncl (DATA_HDR *hdr, SDR_HDR *pseed)
 {
@@ -1658,5 +1719,15 @@ int fix_sncl (DATA_HDR *hdr, SDR_HDR *pseed)
 	pseed->station_id[3]='H';
     }
 #endif
+    if (sncl_remap && sncl_remap_record (sncl_remap, (char *)pseed) > 0) {
+	charncpy (hdr->station_id, pseed->station_id, DH_STATION_LEN);
+	charncpy (hdr->location_id, pseed->location_id, DH_LOCATION_LEN);
+	charncpy (hdr->channel_id, pseed->channel_id, DH_CHANNEL_LEN);
+	charncpy (hdr->network_id, pseed->network_id, DH_NETWORK_LEN);
+	trim (hdr->station_id);
+	trim (hdr->location_id);
+	trim (hdr->channel_id);
+	trim (hdr->network_id);
+    }
     return (0);
 }
@@ -57,6 +57,7 @@ void verify_cfg();
 int write_vol(FINFO *fip, int blksize);
 int reduce_reclen (FINFO *fip, DATA_HDR *hdr, seed_record_header *pseed);
 void gap_check (FINFO *fip, DATA_HDR *hdr);
+void span_check (FINFO *fip, DATA_HDR *hdr, off_t pos);
 int terminate_program (int error);
 char *channelstring(char *station, char *network, char *channel, char *location);
 int check_hdr_wordorder (DATA_HDR *hdr, SDR_HDR *pseed);
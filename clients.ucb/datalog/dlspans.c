@@ -0,0 +1,245 @@
+/************************************************************************
+ *  dlspans - report data availability from datalog span index files.
+ *
+ *  Reads the span index (".idx") files that datalog maintains for
+ *  each data file when the SPAN_INDEX directive is enabled, so that
+ *  availability, gaps and extents can be reported without reading
+ *  any MiniSEED data.
+ *
+ * Modification History:
+ *  2026-10-19 ver 1.0.0 (2026.292) Initial version.
+ ************************************************************************/
+
+#define	VERSION		"1.0.0 (2026.292)"
+
+#include <stdio.h>
+
+char *syntax[] = {
+"%s version " VERSION,
+"%s    [-s start] [-e end] [-g | -x] [-h] idxfile ...",
+"    where:",
+"	-s start    Only report data after start time.",
+"	-e end	    Only report data before end time.",
+"	-g	    List gaps instead of spans.",
+"	-x	    Only list the extent and availability of each channel.",
+"	-h	    Print brief help message for syntax.",
+"	idxfile	    One or more datalog span index files.",
+"    Spans, gaps and extents are reported per channel (SNCL), with",
+"    overlapping and adjacent spans from all files merged.",
+"    The percent availability is computed over the -s and -e interval",
+"    if specified, else over the extent of the data.",
+NULL };
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <libgen.h>
+
+#include "qlib2.h"
+
+#include "span_index.h"
+
+#define	info	stderr
+
+typedef struct _chan_spans {
+    char    sncl[32];		/* STA.NET.CHAN.LOC			*/
+    SPAN_ENTRY *spans;		/* Spans from all files for channel.	*/
+    int	    nspans;
+    int	    maxspans;
+} CHAN_SPANS;
+
+char *cmdname;			/* Name of this program.		*/
+static CHAN_SPANS *chans;
+static int nchans, maxchans;
+
+/************************************************************************
+ *  usec_str:
+ *	Format a span index time.
+ ************************************************************************/
+static char *usec_str (int64_t t)
+{
+    return (time_to_str(tepoch_to_int((double)t / USECS_PER_SEC), MONTHS_FMT_1));
+}
+
+/************************************************************************
+ *  find_chan:
+ *	Return the span list for the SNCL, creating it if necessary.
+ ************************************************************************/
+static CHAN_SPANS *find_chan (SPAN_INDEX_HDR *hdr)
+{
+    char sncl[32];
+    int i;
+
+    snprintf (sncl, sizeof(sncl), "%s.%s.%s.%s", hdr->station, hdr->network,
+	      hdr->channel, (hdr->location[0] && hdr->location[0] != ' ') ?
+	      hdr->location : "--");
+    for (i=0; i<nchans; i++) {
+	if (strcmp(chans[i].sncl, sncl) == 0) return (&chans[i]);
+    }
+    if (nchans == maxchans) {
+	maxchans = (maxchans) ? maxchans * 2 : 16;
+	if ((chans = (CHAN_SPANS *)realloc (chans, maxchans * sizeof(CHAN_SPANS))) == NULL) {
+	    fprintf (info, "Unable to malloc channel list\n");
+	    exit(1);
+	}
+    }
+    memset (&chans[nchans], 0, sizeof(CHAN_SPANS));
+    strcpy (chans[nchans].sncl, sncl);
+    return (&chans[nchans++]);
+}
+
+/************************************************************************
+ *  add_span:
+ *	Add a span to a channel, clipped to [tstart, tend).
+ ************************************************************************/
+static void add_span (CHAN_SPANS *cp, SPAN_ENTRY *sp, int64_t tstart, int64_t tend)
+{
+    SPAN_ENTRY s = *sp;
+
+    if (s.start < tstart) s.start = tstart;
+    if (s.end > tend) s.end = tend;
+    if (s.end <= s.start) return;
+    if (cp->nspans == cp->maxspans) {
+	cp->maxspans = (cp->maxspans) ? cp->maxspans * 2 : 256;
+	if ((cp->spans = (SPAN_ENTRY *)realloc (cp->spans, cp->maxspans * sizeof(SPAN_ENTRY))) == NULL) {
+	    fprintf (info, "Unable to malloc span list for %s\n", cp->sncl);
+	    exit(1);
+	}
+    }
+    cp->spans[cp->nspans++] = s;
+}
+
+/************************************************************************
+ *  cmp_span:
+ *	qsort comparison by span start time.
+ ************************************************************************/
+static int cmp_span (const void *a, const void *b)
+{
+    int64_t ta = ((SPAN_ENTRY *)a)->start;
+    int64_t tb = ((SPAN_ENTRY *)b)->start;
+    return ((ta < tb) ? -1 : (ta > tb) ? 1 : 0);
+}
+
+/************************************************************************
+ *  merge_spans:
+ *	Sort and merge overlapping spans, and spans separated by less
+ *	than half a sample.  Return the number of spans after merging.
+ ************************************************************************/
+static int merge_spans (CHAN_SPANS *cp)
+{
+    SPAN_ENTRY *out, *sp;
+    int64_t tol;
+    int i;
+
+    if (cp->nspans == 0) return (0);
+    qsort (cp->spans, cp->nspans, sizeof(SPAN_ENTRY), cmp_span);
+    out = cp->spans;
+    for (i=1; i<cp->nspans; i++) {
+	sp = &cp->spans[i];
+	tol = (out->srate > 0.) ? (int64_t)(500000. / out->srate) : 0;
+	if (sp->start <= out->end + tol) {
+	    if (sp->end > out->end) out->end = sp->end;
+	    out->nrecords += sp->nrecords;
+	}
+	else {
+	    *++out = *sp;
+	}
+    }
+    cp->nspans = (int)(out - cp->spans) + 1;
+    return (cp->nspans);
+}
+
+/************************************************************************
+ *  main program.
+ ************************************************************************/
+int main (int argc, char **argv)
+{
+    SPAN_INDEX_HDR *hdr;
+    SPAN_ENTRY *spans;
+    CHAN_SPANS *cp;
+    size_t len;
+    INT_TIME *pt;
+    int64_t tstart = INT64_MIN, tend = INT64_MAX;
+    int64_t first, last, total, interval;
+    int gaps = 0, extent = 0;
+    int i, j, n, status = 0;
+
+    /* Variables needed for getopt. */
+    extern char	*optarg;
+    extern int	optind, opterr;
+    int		c;
+
+    cmdname = basename(strdup(argv[0]));
+    init_qlib2 (1);
+
+    while ( (c = getopt(argc,argv,"hs:e:gx")) != -1)
+	switch (c) {
+	case '?':
+	case 'h':   print_syntax(cmdname,syntax,info); exit(0);
+	case 's':
+	case 'e':
+	    if ((pt = parse_date(optarg)) == NULL) {
+		fprintf (info, "Invalid time: %s\n", optarg);
+		exit(1);
+	    }
+	    if (c == 's') tstart = (int64_t)(int_to_tepoch(*pt) * USECS_PER_SEC + 0.5);
+	    else tend = (int64_t)(int_to_tepoch(*pt) * USECS_PER_SEC + 0.5);
+	    break;
+	case 'g':   gaps = 1; break;
+	case 'x':   extent = 1; break;
+	}
+
+    /*	Skip over all options and their arguments.			*/
+    argv = &(argv[optind]);
+    argc -= optind;
+    if (argc <= 0) {
+	print_syntax(cmdname,syntax,info);
+	exit(1);
+    }
+
+    /* Collect the spans for each channel from all index files.	*/
+    for (i=0; i<argc; i++) {
+	if ((n = span_index_map (argv[i], &hdr, &spans, &len)) < 0) {
+	    status = 1;
+	    continue;
+	}
+	cp = find_chan (hdr);
+	for (j=0; j<n; j++) add_span (cp, &spans[j], tstart, tend);
+	span_index_unmap (hdr, len);
+    }
+
+    /* Report each channel.						*/
+    for (i=0; i<nchans; i++) {
+	cp = &chans[i];
+	if ((n = merge_spans (cp)) == 0) {
+	    printf ("%s no data\n", cp->sncl);
+	    continue;
+	}
+	first = cp->spans[0].start;
+	last = cp->spans[n-1].end;
+	total = 0;
+	for (j=0; j<n; j++) total += cp->spans[j].end - cp->spans[j].start;
+	interval = ((tend == INT64_MAX) ? last : tend) -
+	    ((tstart == INT64_MIN) ? first : tstart);
+	if (extent) {
+	    printf ("%s %s ", cp->sncl, usec_str(first));
+	    printf ("%s %.3f%% %d gaps\n", usec_str(last),
+		    (interval > 0) ? 100. * total / interval : 0., n-1);
+	    continue;
+	}
+	for (j=0; j<n; j++) {
+	    if (gaps) {
+		if (j == 0) continue;
+		printf ("%s gap %s ", cp->sncl, usec_str(cp->spans[j-1].end));
+		printf ("%s %.6f\n", usec_str(cp->spans[j].start),
+			(double)(cp->spans[j].start - cp->spans[j-1].end) / USECS_PER_SEC);
+	    }
+	    else {
+		printf ("%s %s ", cp->sncl, usec_str(cp->spans[j].start));
+		printf ("%s %u\n", usec_str(cp->spans[j].end), cp->spans[j].nrecords);
+	    }
+	}
+    }
+    return (status);
+}
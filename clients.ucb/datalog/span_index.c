@@ -0,0 +1,256 @@
+/************************************************************************
+ *  span_index.c - binary time-span index for datalog archive files.
+ *	See span_index.h for the file format.
+ *
+ * Modification History:
+ *  2026-10-19 Initial version.
+ ************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#include "span_index.h"
+
+#define	info	stderr
+
+struct _span_index {
+    int	    fd;			/* Index file descriptor.		*/
+    char    path[1024];		/* Index file pathname.			*/
+    SPAN_INDEX_HDR hdr;		/* Copy of the index header.		*/
+    SPAN_ENTRY last;		/* Copy of the last span.		*/
+};
+
+/************************************************************************
+ *  entry_pos:
+ *	Return the index file offset of span n.
+ ************************************************************************/
+static off_t entry_pos (uint32_t n)
+{
+    return ((off_t)sizeof(SPAN_INDEX_HDR) + (off_t)n * sizeof(SPAN_ENTRY));
+}
+
+/************************************************************************
+ *  xpwrite:
+ *	pwrite all bytes, retrying on EINTR.  Return 0 or -1.
+ ************************************************************************/
+static int xpwrite (int fd, void *buf, size_t n, off_t pos)
+{
+    char *p = (char *)buf;
+    ssize_t w;
+    while (n > 0) {
+	w = pwrite (fd, p, n, pos);
+	if (w < 0 && errno == EINTR) continue;
+	if (w <= 0) return (-1);
+	p += w;
+	pos += w;
+	n -= w;
+    }
+    return (0);
+}
+
+/************************************************************************
+ *  valid_hdr:
+ *	Return 1 if the header is a usable index header, else 0.
+ ************************************************************************/
+static int valid_hdr (SPAN_INDEX_HDR *hdr, off_t size)
+{
+    return (memcmp (hdr->magic, SPAN_INDEX_MAGIC, sizeof(hdr->magic)) == 0 &&
+	    hdr->byteorder == SPAN_INDEX_BYTEORDER &&
+	    hdr->version == SPAN_INDEX_VERSION &&
+	    hdr->entry_size == sizeof(SPAN_ENTRY) &&
+	    entry_pos(hdr->nspans) <= size);
+}
+
+/************************************************************************
+ *  span_index_open:
+ *	Open or create the index for a data file.  A new index is only
+ *	created for an empty data file, since an index started part way
+ *	through a file would omit its earlier records.  An unusable
+ *	existing index is removed.
+ *	Return the index, or NULL on error or if the file is not indexed.
+ ************************************************************************/
+SPAN_INDEX *span_index_open (char *datafile, char *station, char *network,
+			     char *channel, char *location)
+{
+    SPAN_INDEX *sx;
+    struct stat sb, db;
+    ssize_t n;
+
+    if ((sx = (SPAN_INDEX *)calloc (1, sizeof(SPAN_INDEX))) == NULL) {
+	fprintf (info, "Unable to malloc span index for %s\n", datafile);
+	return (NULL);
+    }
+    snprintf (sx->path, sizeof(sx->path), "%s%s", datafile, SPAN_INDEX_SUFFIX);
+    while ((sx->fd = open(sx->path, O_RDWR | O_CREAT, 0666)) == -1
+	   && errno == EINTR) ;
+    if (sx->fd < 0 || fstat (sx->fd, &sb) < 0) {
+	fprintf (info, "Unable to open span index %s\n", sx->path);
+	span_index_close (sx);
+	return (NULL);
+    }
+    n = (sb.st_size > 0) ? pread (sx->fd, &sx->hdr, sizeof(sx->hdr), 0) : 0;
+    if (n == sizeof(sx->hdr) && valid_hdr (&sx->hdr, sb.st_size)) {
+	if (sx->hdr.nspans > 0 &&
+	    pread (sx->fd, &sx->last, sizeof(sx->last), entry_pos(sx->hdr.nspans-1))
+	    != sizeof(sx->last)) {
+	    fprintf (info, "Error reading span index %s\n", sx->path);
+	    span_index_close (sx);
+	    return (NULL);
+	}
+	return (sx);
+    }
+
+    /* Create a new (empty) index.					*/
+    if (sb.st_size > 0) {
+	fprintf (info, "Invalid span index %s\n", sx->path);
+    }
+    if (stat (datafile, &db) == 0 && db.st_size > 0) {
+	fprintf (info, "No span index for %s - file not indexed\n", datafile);
+	span_index_remove (sx);
+	return (NULL);
+    }
+    memset (&sx->hdr, 0, sizeof(sx->hdr));
+    memcpy (sx->hdr.magic, SPAN_INDEX_MAGIC, sizeof(sx->hdr.magic));
+    sx->hdr.byteorder = SPAN_INDEX_BYTEORDER;
+    sx->hdr.version = SPAN_INDEX_VERSION;
+    sx->hdr.entry_size = sizeof(SPAN_ENTRY);
+    strncpy (sx->hdr.station, station, sizeof(sx->hdr.station)-1);
+    strncpy (sx->hdr.network, network, sizeof(sx->hdr.network)-1);
+    strncpy (sx->hdr.channel, channel, sizeof(sx->hdr.channel)-1);
+    strncpy (sx->hdr.location, location, sizeof(sx->hdr.location)-1);
+    if (ftruncate (sx->fd, 0) < 0 ||
+	xpwrite (sx->fd, &sx->hdr, sizeof(sx->hdr), 0) < 0) {
+	fprintf (info, "Error initializing span index %s\n", sx->path);
+	span_index_close (sx);
+	return (NULL);
+    }
+    return (sx);
+}
+
+/************************************************************************
+ *  span_index_add:
+ *	Add a record covering [start, end) at data file offset to the
+ *	index.  The record extends the last span if it starts within
+ *	half a sample of the end of the last span, else starts a new span.
+ *	Return 0 on success, -1 on error.
+ ************************************************************************/
+int span_index_add (SPAN_INDEX *sx, int64_t start, int64_t end, double srate,
+		    off_t offset)
+{
+    int64_t tol = (srate > 0.) ? (int64_t)(500000. / srate) : 0;
+    int64_t diff = start - sx->last.end;
+    uint32_t n = sx->hdr.nspans;
+
+    if (n > 0 && diff <= tol && diff >= -tol && sx->last.srate == (float)srate) {
+	sx->last.end = end;
+	sx->last.nrecords++;
+	return (xpwrite (sx->fd, &sx->last, sizeof(sx->last), entry_pos(n-1)));
+    }
+    sx->last.start = start;
+    sx->last.end = end;
+    sx->last.offset = offset;
+    sx->last.nrecords = 1;
+    sx->last.srate = (float)srate;
+    if (xpwrite (sx->fd, &sx->last, sizeof(sx->last), entry_pos(n)) < 0) return (-1);
+    sx->hdr.nspans = n + 1;
+    return (xpwrite (sx->fd, &sx->hdr.nspans, sizeof(sx->hdr.nspans),
+		     (off_t)offsetof(SPAN_INDEX_HDR, nspans)));
+}
+
+/************************************************************************
+ *  span_index_rename:
+ *	Rename the index to follow its renamed data file.
+ *	Return 0 on success, -1 on error.
+ ************************************************************************/
+int span_index_rename (SPAN_INDEX *sx, char *datafile)
+{
+    char newpath[1024];
+
+    snprintf (newpath, sizeof(newpath), "%s%s", datafile, SPAN_INDEX_SUFFIX);
+    if (rename (sx->path, newpath) != 0) {
+	fprintf (info, "Error %d renaming %s to %s\n", errno, sx->path, newpath);
+	return (-1);
+    }
+    strcpy (sx->path, newpath);
+    return (0);
+}
+
+/************************************************************************
+ *  span_index_close:
+ *	Close the index and free its storage.
+ ************************************************************************/
+void span_index_close (SPAN_INDEX *sx)
+{
+    if (sx == NULL) return;
+    if (sx->fd >= 0) close (sx->fd);
+    free (sx);
+}
+
+/************************************************************************
+ *  span_index_remove:
+ *	Remove an index that is no longer maintained, so it will not be
+ *	resumed or read as a complete index, then close it.
+ ************************************************************************/
+void span_index_remove (SPAN_INDEX *sx)
+{
+    if (sx == NULL) return;
+    if (unlink (sx->path) != 0 && errno != ENOENT) {
+	fprintf (info, "Error %d removing span index %s\n", errno, sx->path);
+    }
+    span_index_close (sx);
+}
+
+/************************************************************************
+ *  span_index_map:
+ *	Map an index file read-only.  Return the number of spans, or -1
+ *	on error.  Unmap with span_index_unmap (hdr, len).
+ ************************************************************************/
+int span_index_map (char *idxfile, SPAN_INDEX_HDR **phdr, SPAN_ENTRY **pspans,
+		    size_t *plen)
+{
+    struct stat sb;
+    void *p;
+    int fd;
+
+    if ((fd = open (idxfile, O_RDONLY)) < 0) {
+	fprintf (info, "Unable to open span index %s\n", idxfile);
+	return (-1);
+    }
+    if (fstat (fd, &sb) < 0 || sb.st_size < (off_t)sizeof(SPAN_INDEX_HDR)) {
+	fprintf (info, "Invalid span index %s\n", idxfile);
+	close (fd);
+	return (-1);
+    }
+    p = mmap (NULL, sb.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close (fd);
+    if (p == MAP_FAILED) {
+	fprintf (info, "Unable to map span index %s\n", idxfile);
+	return (-1);
+    }
+    if (! valid_hdr ((SPAN_INDEX_HDR *)p, sb.st_size)) {
+	fprintf (info, "Invalid span index %s\n", idxfile);
+	munmap (p, sb.st_size);
+	return (-1);
+    }
+    *phdr = (SPAN_INDEX_HDR *)p;
+    *pspans = (SPAN_ENTRY *)((char *)p + sizeof(SPAN_INDEX_HDR));
+    *plen = sb.st_size;
+    return ((int)(*phdr)->nspans);
+}
+
+/************************************************************************
+ *  span_index_unmap:
+ *	Unmap an index mapped with span_index_map.
+ ************************************************************************/
+void span_index_unmap (SPAN_INDEX_HDR *hdr, size_t len)
+{
+    if (hdr) munmap ((void *)hdr, len);
+}
@@ -0,0 +1,70 @@
+/************************************************************************
+ *  span_index.h - binary time-span index for datalog archive files.
+ *
+ * Modification History:
+ *  2026-10-19 Initial version.
+ ************************************************************************/
+
+#ifndef SPAN_INDEX_H
+#define SPAN_INDEX_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+/*
+ * Each datalog data file "file" may have an index file "file.idx".
+ * The index is a fixed size header followed by an array of spans of
+ * continuous data in the order they were written to the data file.
+ * Times are microseconds since 1970 (qlib2 true epoch).  A span covers
+ * [start, end), where end is the time of the sample following the last
+ * sample.  All values are in host byte order; byteorder is written as
+ * SPAN_INDEX_BYTEORDER so readers can detect a foreign index.
+ *
+ * datalog updates the index with pwrite after every record, extending
+ * the last span or appending a new one, so the index can be mapped and
+ * read at any time.  A new span is written before nspans is updated.
+ */
+
+#define SPAN_INDEX_MAGIC	"DLSPANIX"
+#define SPAN_INDEX_VERSION	1
+#define SPAN_INDEX_BYTEORDER	0x01020304
+#define SPAN_INDEX_SUFFIX	".idx"
+
+typedef struct _span_index_hdr {
+    char    magic[8];		/* SPAN_INDEX_MAGIC (not terminated).	*/
+    uint32_t byteorder;		/* SPAN_INDEX_BYTEORDER.		*/
+    uint32_t version;		/* SPAN_INDEX_VERSION.			*/
+    uint32_t entry_size;	/* sizeof(SPAN_ENTRY).			*/
+    uint32_t nspans;		/* Number of valid spans.		*/
+    char    station[8];		/* SNCL of data file, null terminated.	*/
+    char    network[4];
+    char    channel[4];
+    char    location[4];
+    char    reserved[20];
+} SPAN_INDEX_HDR;		/* 64 bytes.				*/
+
+typedef struct _span_entry {
+    int64_t start;		/* Time of first sample (usec).		*/
+    int64_t end;		/* Time after last sample (usec).	*/
+    int64_t offset;		/* Data file offset of first record.	*/
+    uint32_t nrecords;		/* Number of records in span.		*/
+    float   srate;		/* Sample rate (samples/sec).		*/
+} SPAN_ENTRY;			/* 32 bytes.				*/
+
+typedef struct _span_index SPAN_INDEX;
+
+/* Writer interface (datalog).						*/
+SPAN_INDEX *span_index_open (char *datafile, char *station, char *network,
+			     char *channel, char *location);
+int span_index_add (SPAN_INDEX *sx, int64_t start, int64_t end, double srate,
+		    off_t offset);
+int span_index_rename (SPAN_INDEX *sx, char *datafile);
+void span_index_close (SPAN_INDEX *sx);
+void span_index_remove (SPAN_INDEX *sx);
+
+/* Reader interface.  Map an index file read-only.			*/
+int span_index_map (char *idxfile, SPAN_INDEX_HDR **phdr, SPAN_ENTRY **pspans,
+		    size_t *plen);
+void span_index_unmap (SPAN_INDEX_HDR *hdr, size_t len);
+
+#endif
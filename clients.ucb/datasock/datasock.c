@@ -49,12 +49,15 @@ Date     who	Version	Modifications.
 			wildcarded station or station.net entries.
 2021.117   DSN  1.6.1   Initialize config_struc structure before open_cfg call.
 2022.059   DSN  1.6.2   Allow environmental override of STATIONS_INI pathname;
+2026.292        1.7.0   Use cs_gen_parallel so that data requests to all
+			comservs are outstanding at the same time.
+2026.292        1.7.1   Wait for data with cs_wait instead of a fixed sleep.
  ************************************************************************/
 
 #include <stdio.h>
 #include <stdlib.h>
 
-#define	VERSION	"1.6.2 (2022.059)"
+#define	VERSION	"1.7.1 (2026.292)"
 
 #ifdef COMSERV2
 #define	DEFAULT_CLIENT	"DSOC"
@@ -125,7 +128,7 @@ pchar seednamestring (seed_name_type *sd, location_type *loc);
 
 #define	SEED_BLKSIZE	512
 #define	TIMESTRLEN	40
-#define	POLLTIME	250000	/* microseconds to sleep.		*/
+#define	POLLTIME	250000	/* max microseconds to wait for data.	*/
 #define TIMEOUT	EINTR
 
 #define ANNOUNCE(cmd,fp)							\
@@ -190,11 +193,6 @@ int main (int argc, char *argv[], char **envp)
     char *passwdfile = NULL;
     char *passwd = NULL;		/* Optional password required.		*/
     char passwdstr[80];
-#ifdef SUNOS4
-    int usleeptime;
-#else
-    struct timespec rqtp, rmtp;
-#endif
     struct sigaction action;
 
     /* Variables needed for getopt. */
@@ -234,13 +232,6 @@ int main (int argc, char *argv[], char **envp)
 	passwd = passwdstr;
     }
 
-#ifdef	SUNOS4
-    usleeptime = POLLTIME;
-#else
-    rqtp.tv_sec = (1000 * POLLTIME) / 1000000000 ;
-    rqtp.tv_nsec = (1000 * POLLTIME) % 1000000000 ;
-#endif
-
     terminate_proc = 0;
     signal (SIGINT,finish_handler);
     signal (SIGTERM,finish_handler);
@@ -336,7 +327,7 @@ int main (int argc, char *argv[], char **envp)
     
     /* Create my segment and attach to all stations */      
     defer_terminate = 1;
-    me = cs_gen (&stations);
+    me = cs_gen_parallel (&stations);
     if (me == NULL) {
 	fprintf (stderr, "Error created shared memory for %s\n", cmdname);
 	exit(1);
@@ -418,11 +409,7 @@ int main (int argc, char *argv[], char **envp)
 		fprintf (info, "sleeping...");
 		fflush (info);
 	    }
-#ifdef SUNOS4
-	    usleep (usleeptime) ;
-#else
-	    nanosleep (&rqtp, &rmtp) ;
-#endif
+	    cs_wait (me, POLLTIME) ;
 	    if ((verbosity & 2) && port >= 0) {
 		fprintf (info, "awake\n");
 		fflush (info);
@@ -16,6 +16,8 @@ Edit History:
     8 2020-09-29  DSN Updated for comserv3.
 		ver 1.1.0 Modified for 15 character station and client names.
     9 2020-02-59 DSN ver 1.1.1 	Allow environment override of STATIONS_INI pathname.
+   10 2026-10-19 ver 1.1.2	Wait for data with cs_wait instead of sleeping.
+   11 2026-10-19 ver 1.1.3	Use cs_gen_parallel for station lists.
 */
 #include <stdint.h>
 #include <stdio.h>
@@ -43,7 +45,7 @@ Edit History:
 
 pchar seednamestring (seed_name_type *sd, location_type *loc);
 
-#define VERSION "1.1.1 (2020.059)"
+#define VERSION "1.1.3 (2026.292)"
 
 #ifdef COMSERV2
 #define CLIENT_NAME	"DSPY"
@@ -182,7 +184,7 @@ int main (int argc, char *argv[])
     }
 
     /* Create my segment and attach to all stations */      
-    me = cs_gen (&stations) ;
+    me = cs_gen_parallel (&stations) ;
 
     /* For selector test, only accept data from ??BH? */
     this = (pclient_station) ((intptr_t) me + me->offsets[0]) ;
@@ -412,7 +414,7 @@ int main (int argc, char *argv[])
 	}
 	else {
 	    if (verbose) { printf ("sleeping...\n"); fflush (stdout); }
-	    sleep (1) ; /* Bother the server once every second */
+	    cs_wait (me, 1000000) ; /* Bother the server at least once every second */
 	}
     }
     while (1) ;
@@ -17,9 +17,12 @@ Edit History:
     2020.273 DSN Updated for comserv3.
 		ver 1.1.0 Modified for 15 character station and client names.
     2021.140 DSN ver 1.1.1	Unlink file created with tmpfile_open.
+    2026.292 ver 1.1.2	Wait for data with cs_wait instead of sleeping.
+    2026.292 ver 1.1.3	Use cs_gen_parallel so that a stalled comserv does
+			not delay the detections of the other stations.
  ************************************************************************/
 
-#define	VERSION		"1.1.1 (2021.140)"
+#define	VERSION		"1.1.3 (2026.292)"
 
 #ifdef COMSERV2
 #define	CLIENT_NAME	"EVTA"
@@ -209,7 +212,7 @@ int main (int argc, char *argv[])
 		printf ("sleeping...");
 		fflush (stdout);
 	    }
-	    sleep (1) ; /* Bother the server once every second */
+	    cs_wait (me, 1000000) ; /* Bother the server at least once every second */
 	    if (verbosity & 2) {
 		printf ("awake\n");
 		fflush (stdout);
@@ -570,7 +573,7 @@ pclient_struc setup_comserv_connections(LIST station_list, LIST station_exclude,
     signal (SIGTERM,finish_handler);
 
     /* Create my segment and attach to all stations */      
-    me = cs_gen (&stations) ;
+    me = cs_gen_parallel (&stations) ;
 
     /* Set up special selectors. */
     set_selectors (me);
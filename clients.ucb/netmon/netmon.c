@@ -29,9 +29,23 @@
     2021.140 DSN ver 1.2.2	Unlink files opened with tmpfile_open.
     2022.059 DSN ver 1.2.3	Allow environment override of NETWORK_INI and 
 				STATIONS_INI pathnames.
+    2026.292     ver 1.2.5	Optional event driven monitoring (MONITOR_MODE=EVENT).
+				Spawned programs are tracked with pidfds and
+				SIGCHLD through a signalfd, and servers are
+				checked through their shared memory segment,
+				so a program that dies is restarted at once
+				instead of at the next poll.
+    2026.292     ver 1.2.6	Clients are spawned as soon as the server segment
+				is initialized, and shutdown steps proceed as soon
+				as their condition is met; the startup delays and
+				max_shutdown_wait are now upper limits.  Optional
+				MAX_PARALLEL limit on the number of stations
+				starting up or shutting down at once.
+				Per-station CLIENT_STARTUP_DELAY was taken as a
+				client definition.
 */
 
-#define	VERSION		"1.2.4 (2022.320)"
+#define	VERSION		"1.2.6 (2026.292)"
 
 #ifdef COMSERV2
 #define	CLIENT_NAME	"NETM"
@@ -64,6 +78,12 @@
 /* #include <vfork.h> */
 #endif
 #endif
+#ifdef	LINUX
+#include <poll.h>
+#include <sys/signalfd.h>
+#include <sys/inotify.h>
+#include <sys/syscall.h>
+#endif
 
 #include "cslimits.h"
 #include "cstypes.h"
@@ -137,6 +157,10 @@ NULL };
 #define	MIN_POLL		CS_CHECK_INTERVAL
 #define	MIN_MAX_SHUTDOWN	(2*MIN_POLL)
 
+/* In event mode, how often a station that is changing state but has no	*/
+/* pending deadline is checked again (msec).				*/
+#define	EVENT_TICK_MSEC		500
+
 #define CSCR_STATUS_UNKNOWN	-1
 
 #define	PARTIAL_SHUTDOWN	0
@@ -173,6 +197,8 @@ typedef struct _client_info {		/* Client info structure.	*/
     int	block_count;			/* # of packets blocked.	*/
     int status;				/* Client status.		*/
     int input_client;			/* Client feeds server.		*/
+    int pidfd;				/* Pidfd for client (event mode).*/
+    int exited;				/* Seen to exit (event mode).	*/
     struct _client_info *next;		/* Ptr to next client.		*/
 } CLIENT_INFO;
 
@@ -188,6 +214,8 @@ typedef struct _station_info {		/* Station info structure.	*/
     char program[256];			/* Server program.		*/
     double time_check;			/* Time to check server status.	*/
     double time_complete;		/* Time when action must finish.*/
+    char starting;			/* Startup in progress.		*/
+    char stopping;			/* Server told to terminate.	*/
     double time_timeout_started;	/* Time that timeout started.	*/
     double time_last_notified;		/* Time of last timeout notify.	*/
     double queued_request_time;		/* Time last request was queued.*/
@@ -200,6 +228,9 @@ typedef struct _station_info {		/* Station info structure.	*/
     char notify_prog[SECWIDTH];		/* Timeout notification prog.	*/
     int server_segment;			/* Shared segment for server.	*/
     int pid;				/* Server pid.			*/
+    int pidfd;				/* Pidfd for server (event mode).*/
+    double time_wakeup;			/* Time station needs attention.*/
+    double time_linkstat;		/* Time to refresh linkstat.	*/
     int status;				/* Server status.		*/
     linkstat_rec *linkstat;		/* Ptr to linkstat structure.	*/
     int nclients;			/* # of clients.		*/
@@ -249,11 +280,24 @@ int net_res_notify = 1;			/* Notify when back up.		*/
 char net_notify_prog[SECWIDTH];		/* Timeout notification prog.	*/
 char lockfile[SECWIDTH];		/* Daemon lockfile.		*/
 int lockfd;				/* Lockfile file desciptor.	*/
+int event_mode = 0;			/* Event driven monitoring.	*/
+int max_parallel = 0;			/* Max stations in transition.	*/
 
 /************************************************************************
  *  Function declarations, both local and external.
  ************************************************************************/
 int monitor_network();
+int monitor_events();
+void monitor_station (STATION_INFO *s);
+double station_wakeup (STATION_INFO *s, double now);
+void process_exited (STATION_INFO *s, CLIENT_INFO *c, int status);
+void reap_children();
+int watch_pid (int pid);
+int server_settled (STATION_INFO *s, double now);
+int station_active (STATION_INFO *s, double now);
+int parallel_slot (STATION_INFO *s);
+void unwatch_pid (int *pidfd);
+void exec_process (char *path, char **argv, char *logfile);
 STATION_INFO *collect_station_info (char *station);
 STATION_INFO *find_station_entry (char *station, int create_flag);
 CLIENT_INFO *find_client_entry (STATION_INFO *s, char *client, int create_flag);
@@ -380,6 +424,7 @@ int main(int argc, char **argv)
 
     network_ini = get_network_ini_pathname();
     read_network_cfg (network_ini, CLIENT_NAME);
+    if (! daemon_flag) event_mode = 0;
 
     if (daemon_flag + background_flag + boot_flag > 0 && strlen(lockfile) > 0) {
 	/* Perform preliminary lock on lockfile to see if another copy	*/
@@ -447,6 +492,16 @@ int main(int argc, char **argv)
     if (background_flag || daemon_flag) {
 	fprintf (info, "%s %s version %s (%d) (check interval %d) started\n", localtime_string(dtime()),
 		 cmdname, VERSION, getpid(), CS_CHECK_INTERVAL);
+#ifndef	LINUX
+	if (event_mode) {
+	    event_mode = 0;
+	    fprintf (info, "%s Warning: MONITOR_MODE=EVENT not supported, using POLL\n",
+		     localtime_string(dtime()));
+	}
+#endif
+	if (event_mode) {
+	    fprintf (info, "%s Event driven monitoring\n", localtime_string(dtime()));
+	}
 	fflush (info);
 
 	/* Ensure that daemon config parameters are within limits.	*/
@@ -568,7 +623,8 @@ int main(int argc, char **argv)
 
     /* Daemon operation - continuously monitor the network programs.	*/
     if (daemon_flag) {
-	monitor_network();
+	if (event_mode) monitor_events();
+	else monitor_network();
     }
 	
     /* Wrapup and sign off.						*/
@@ -618,97 +674,13 @@ int main(int argc, char **argv)
  ************************************************************************/
 int monitor_network()
 {
-    double now;
-    int status;
     int new_requests;
     STATION_INFO *s;
-    CLIENT_INFO *c;
 
     while (! terminate_proc) {
 	for (s=st_head; s!=NULL; s=s->next) {
 	    if (s->config_state == 'I') continue;
-	    now = dtime();
-
-	    /* Update the present server status.			*/
-	    status = server_status(s);
-	    if (status == CSCR_STATUS_UNKNOWN) continue;
-	    /* Monitor each client.					*/
-	    for (c=s->client; c!= NULL; c=c->next) {
-		status = client_status(s,c);
-	    }
-
-	    /* Compute the state of the station.			*/
-	    /* Cancel any time completion or time check conditions if	*/
-	    /* the station has reached its fully up configured state.	*/
-	    s->present_state = station_state(s);
-	    if (s->present_state == 'R' && 
-		(s->target_state == 'A' ||
-		 s->target_state == 'S' || 
-		 s->target_state == 'R')) {
-		s->time_complete = s->time_check = 0;
-	    }
-
-	    /* Process queued request if we are not waiting for an	*/
-	    /* an action to complete.					*/
-	    if (s->queued_request && now > s->time_complete) {
-		/* Process queued command. */
-		switch (s->queued_request) {
-		case STARTUP_REQUEST:
-		    switch (s->config_state) {
-		    case 'A': s->target_state = 'A'; s->present_state = 'U'; break;
-		    case 'S':
-		    case 'R': s->target_state = 'S'; s->present_state = 'U'; break;
-		    case 'N': s->target_state = 'N'; break;
-		    default:
-			fprintf (info, "%s Invalid config state %c for %s\n",
-				 localtime_string(dtime()), s->config_state, 
-				 s->station);
-		    }
-		    s->queued_request = 0;
-		    break;
-		case SHUTDOWN_REQUEST:
-		    s->target_state = 'N';
-		    s->queued_request = 0;
-		    break;
-		default:
-		    fprintf (info, "%s %s (%d) Unknown request '%c' for %s\n", 
-			     localtime_string(dtime()), cmdname, getpid(),
-			     s->queued_request, s->station);
-		    s->queued_request = 0;
-		    break;
-		}
-	    }
-
-	    /* Perform action based on state settings.			*/
-	    switch (s->present_state) {
-	    case 'R':
-		if (s->target_state == 'S' && s->linkstat && 
-		    s->linkstat->suspended == 0) {
-		    s->target_state = 'R';
-		}
-		else if (s->target_state == 'N') {
-		    shutdown_station(s);
-		    s->present_state = station_state(s);
-		}
-		break;
-	    case 'N':
-		if (s->target_state == 'A' || s->target_state == 'S') {
-		    startup_station(s);
-		    s->present_state = station_state(s);
-		}
-		break;
-	    case 'U':
-		if (s->target_state == 'N' || s->target_state == 'R') {
-		    shutdown_station(s);
-		    s->present_state = station_state(s);
-		}
-		else if (s->target_state == 'A' || s->target_state == 'S') {
-		    startup_station(s);
-		    s->present_state = station_state(s);
-		}
-		break;
-	    default:	break;
-	    }
+	    monitor_station(s);
 	}
 
 	/* Process all outstanding requests.				*/
@@ -733,6 +705,481 @@ int monitor_network()
     return 0;
 }
 
+/************************************************************************
+ *  monitor_station:
+ *	Update the status of one station, process its queued request,
+ *	and perform any startup or shutdown action required.
+ ************************************************************************/
+void monitor_station (STATION_INFO *s)
+{
+    double now;
+    int status;
+    CLIENT_INFO *c;
+
+    now = dtime();
+
+    /* Update the present server status.			*/
+    status = server_status(s);
+    if (status == CSCR_STATUS_UNKNOWN) return;
+    /* Monitor each client.					*/
+    for (c=s->client; c!= NULL; c=c->next) {
+	status = client_status(s,c);
+    }
+
+    /* Compute the state of the station.			*/
+    /* Cancel any time completion or time check conditions if	*/
+    /* the station has reached its fully up configured state.	*/
+    s->present_state = station_state(s);
+    if (s->present_state == 'R' && 
+	(s->target_state == 'A' ||
+	 s->target_state == 'S' || 
+	 s->target_state == 'R')) {
+	s->time_complete = s->time_check = 0;
+	s->starting = 0;
+    }
+
+    /* Process queued request if we are not waiting for an	*/
+    /* an action to complete.					*/
+    if (s->queued_request && now > s->time_complete) {
+	/* Process queued command. */
+	switch (s->queued_request) {
+	case STARTUP_REQUEST:
+	    switch (s->config_state) {
+	    case 'A': s->target_state = 'A'; s->present_state = 'U'; break;
+	    case 'S':
+	    case 'R': s->target_state = 'S'; s->present_state = 'U'; break;
+	    case 'N': s->target_state = 'N'; break;
+	    default:
+		fprintf (info, "%s Invalid config state %c for %s\n",
+			 localtime_string(dtime()), s->config_state, 
+			 s->station);
+	    }
+	    s->queued_request = 0;
+	    break;
+	case SHUTDOWN_REQUEST:
+	    s->target_state = 'N';
+	    s->queued_request = 0;
+	    break;
+	default:
+	    fprintf (info, "%s %s (%d) Unknown request '%c' for %s\n", 
+		     localtime_string(dtime()), cmdname, getpid(),
+		     s->queued_request, s->station);
+	    s->queued_request = 0;
+	    break;
+	}
+    }
+
+    /* Perform action based on state settings.			*/
+    switch (s->present_state) {
+    case 'R':
+	if (s->target_state == 'S' && s->linkstat && 
+	    s->linkstat->suspended == 0) {
+	    s->target_state = 'R';
+	}
+	else if (s->target_state == 'N') {
+	    shutdown_station(s);
+	    s->present_state = station_state(s);
+	}
+	break;
+    case 'N':
+	if (s->target_state == 'A' || s->target_state == 'S') {
+	    startup_station(s);
+	    s->present_state = station_state(s);
+	}
+	break;
+    case 'U':
+	if (s->target_state == 'N' || s->target_state == 'R') {
+	    shutdown_station(s);
+	    s->present_state = station_state(s);
+	}
+	else if (s->target_state == 'A' || s->target_state == 'S') {
+	    startup_station(s);
+	    s->present_state = station_state(s);
+	}
+	break;
+    default:	break;
+    }
+}
+
+/************************************************************************
+ *  monitor_events:
+ *	Event driven version of monitor_network (MONITOR_MODE=EVENT).
+ *	Instead of checking every station every poll_interval seconds,
+ *	wait in poll() for:
+ *	a.  the pidfd of a server or client to report that it exited,
+ *	b.  SIGCHLD for a program we spawned, and SIGHUP, SIGINT and
+ *	    SIGTERM, all read from a signalfd,
+ *	c.  a new command file in cmddir (inotify),
+ *	d.  the next deadline of a station that is starting up or
+ *	    shutting down.
+ *	Only stations that need attention are checked after an event.
+ *	All stations are checked every poll_interval seconds, which also
+ *	refreshes the link status used for timeout notification.
+ ************************************************************************/
+int monitor_events()
+{
+#ifdef	LINUX
+    sigset_t mask;
+    struct signalfd_siginfo si;
+    struct pollfd *pfd = NULL;
+    STATION_INFO **pfd_s = NULL;
+    CLIENT_INFO **pfd_c = NULL;
+    char ibuf[4096];
+    int sig_fd, cmd_fd;
+    int max_fds = 0;
+    int nfds, nfixed, n, i;
+    int timeout;
+    int sweep, check_cmds, new_requests;
+    double now, next_sweep, wakeup;
+    STATION_INFO *s;
+    CLIENT_INFO *c;
+
+    /* Receive signals through a signalfd.				*/
+    sigemptyset (&mask);
+    sigaddset (&mask, SIGCHLD);
+    sigaddset (&mask, SIGHUP);
+    sigaddset (&mask, SIGINT);
+    sigaddset (&mask, SIGTERM);
+    if (sigprocmask (SIG_BLOCK, &mask, NULL) < 0 ||
+	(sig_fd = signalfd (-1, &mask, SFD_NONBLOCK|SFD_CLOEXEC)) < 0) {
+	fprintf (info, "%s Unable to create signalfd, errno=%d - using POLL mode\n",
+		 localtime_string(dtime()), errno);
+	fflush (info);
+	sigprocmask (SIG_UNBLOCK, &mask, NULL);
+	event_mode = 0;
+	return (monitor_network());
+    }
+
+    /* Watch cmddir for new requests.  Without inotify the cmddir is	*/
+    /* scanned on every pass, as in poll mode.				*/
+    if ((cmd_fd = inotify_init1 (IN_NONBLOCK|IN_CLOEXEC)) >= 0 &&
+	inotify_add_watch (cmd_fd, cmddir, IN_CLOSE_WRITE|IN_MOVED_TO) < 0) {
+	close (cmd_fd);
+	cmd_fd = -1;
+    }
+    nfixed = (cmd_fd >= 0) ? 2 : 1;
+
+    /* Programs that died before we started catching SIGCHLD.		*/
+    reap_children();
+
+    next_sweep = 0;
+    check_cmds = 1;
+    while (! terminate_proc) {
+	now = dtime();
+	sweep = (now >= next_sweep);
+	if (sweep) next_sweep = now + poll_interval;
+	for (s=st_head; s!=NULL; s=s->next) {
+	    if (s->config_state == 'I') continue;
+	    if (sweep || (s->time_wakeup > 0 && s->time_wakeup <= now)) {
+		monitor_station(s);
+	    }
+	}
+
+	/* Process all outstanding requests.				*/
+	new_requests = 0;
+	if (sweep || check_cmds || cmd_fd < 0) {
+	    new_requests = process_requests();
+	    check_cmds = 0;
+	}
+#ifdef	ALLOW_RECONFIG
+	if (reconfig_flag) {
+	    reconfig_daemon();
+	    next_sweep = 0;
+	    continue;
+	}
+#endif	/* ALLOW_RECONFIG */
+	fflush (info);
+
+	/* Build the poll list and find the next station deadline.	*/
+	now = dtime();
+	wakeup = next_sweep;
+	nfds = nfixed;
+	for (s=st_head; s!=NULL; s=s->next) {
+	    nfds += 1 + s->nclients;
+	}
+	if (nfds > max_fds) {
+	    max_fds = nfds + 16;
+	    pfd = (struct pollfd *)realloc(pfd, max_fds * sizeof(struct pollfd));
+	    pfd_s = (STATION_INFO **)realloc(pfd_s, max_fds * sizeof(STATION_INFO *));
+	    pfd_c = (CLIENT_INFO **)realloc(pfd_c, max_fds * sizeof(CLIENT_INFO *));
+	    if (pfd == NULL || pfd_s == NULL || pfd_c == NULL) {
+		fprintf (info, "Error mallocing poll list\n");
+		exit(1);
+	    }
+	}
+	pfd[0].fd = sig_fd;
+	pfd[0].events = POLLIN;
+	if (cmd_fd >= 0) {
+	    pfd[1].fd = cmd_fd;
+	    pfd[1].events = POLLIN;
+	}
+	nfds = nfixed;
+	for (s=st_head; s!=NULL; s=s->next) {
+	    s->time_wakeup = station_wakeup(s, now);
+	    if (s->time_wakeup > 0 && s->time_wakeup < wakeup) wakeup = s->time_wakeup;
+	    if (s->pidfd >= 0) {
+		pfd[nfds].fd = s->pidfd;
+		pfd[nfds].events = POLLIN;
+		pfd_s[nfds] = s;
+		pfd_c[nfds++] = NULL;
+	    }
+	    for (c=s->client; c!=NULL; c=c->next) {
+		if (c->pidfd < 0) continue;
+		pfd[nfds].fd = c->pidfd;
+		pfd[nfds].events = POLLIN;
+		pfd_s[nfds] = s;
+		pfd_c[nfds++] = c;
+	    }
+	}
+	timeout = (new_requests) ? 0 : (int)((wakeup - now) * 1000.);
+	if (timeout < 0) timeout = 0;
+
+	if (debug(DEBUG_POLL)) {
+	    fprintf (info, "waiting %d msec for %d fds...", timeout, nfds);
+	    fflush (info);
+	}
+	n = poll (pfd, nfds, timeout);
+	if (debug(DEBUG_POLL)) {
+	    fprintf (info,"awake (%d)\n", n);
+	    fflush (info);
+	}
+	if (n < 0) {
+	    if (errno != EINTR) {
+		fprintf (info, "%s poll error, errno=%d\n",
+			 localtime_string(dtime()), errno);
+		sleep (1);
+	    }
+	    continue;
+	}
+	if (n == 0) continue;
+
+	/* Signals.  Reap children before looking at the pidfds.		*/
+	if (pfd[0].revents) {
+	    while (read (sig_fd, &si, sizeof(si)) == sizeof(si)) {
+		switch (si.ssi_signo) {
+		case SIGCHLD:	break;
+		case SIGHUP:	hup_handler(SIGHUP); break;
+		default:	finish_handler(si.ssi_signo); break;
+		}
+	    }
+	    reap_children();
+	}
+
+	/* New command files.						*/
+	if (cmd_fd >= 0 && pfd[1].revents) {
+	    while (read (cmd_fd, ibuf, sizeof(ibuf)) > 0) ;
+	    check_cmds = 1;
+	}
+
+	/* Servers and clients that exited.  Skip any entry whose pidfd	*/
+	/* was already closed when its process was reaped.		*/
+	for (i=nfixed; i<nfds; i++) {
+	    if (pfd[i].revents == 0) continue;
+	    s = pfd_s[i];
+	    c = pfd_c[i];
+	    if (pfd[i].fd != ((c) ? c->pidfd : s->pidfd)) continue;
+	    process_exited(s, c, -1);
+	}
+    }
+
+    /* Restore normal signal handling.					*/
+    close (sig_fd);
+    if (cmd_fd >= 0) close (cmd_fd);
+    sigprocmask (SIG_UNBLOCK, &mask, NULL);
+    free (pfd);
+    free (pfd_s);
+    free (pfd_c);
+    return 0;
+#else
+    return (monitor_network());
+#endif	/* LINUX */
+}
+
+/************************************************************************
+ *  station_wakeup:
+ *	Return the time that a station next needs attention in event
+ *	mode, or 0 if it is in a stable state and only needs to be checked
+ *	when one of its programs exits or at the next sweep.
+ ************************************************************************/
+double station_wakeup (STATION_INFO *s, double now)
+{
+    CLIENT_INFO *c;
+    double t = 0;
+    double tick;
+    int changing;
+
+    if (s->config_state == 'I') return (0);
+
+    /* Earliest pending deadline.					*/
+    if (s->time_check > now) t = s->time_check;
+    if (s->time_complete > now && (t == 0 || s->time_complete < t))
+	t = s->time_complete;
+    for (c=s->client; c!=NULL; c=c->next) {
+	if (c->time_check > now && (t == 0 || c->time_check < t))
+	    t = c->time_check;
+    }
+
+    /* A station that is changing state is waiting on a server or	*/
+    /* client that may be ready before any deadline, so check it again	*/
+    /* soon.								*/
+    switch (s->target_state) {
+    case 'A':
+    case 'S':
+    case 'R':	changing = (s->present_state != 'R'); break;
+    case 'N':	changing = (s->present_state != 'N'); break;
+    default:	changing = 0; break;
+    }
+    if (changing || s->queued_request || s->shutting_down || 
+	s->starting || s->stopping) {
+	tick = now + EVENT_TICK_MSEC / 1000.;
+	if (t == 0 || tick < t) t = tick;
+    }
+    return (t);
+}
+
+/************************************************************************
+ *  process_exited:
+ *	Record that a server (c == NULL) or client of a station exited,
+ *	and mark the station as needing attention at once.
+ *	status is the wait status, or -1 if it is not known.
+ ************************************************************************/
+void process_exited (STATION_INFO *s, CLIENT_INFO *c, int status)
+{
+    char how[40];
+    int i;
+
+    if (status == -1) strcpy (how, "exited");
+    else if (WIFSIGNALED(status)) sprintf (how, "killed by signal %d", WTERMSIG(status));
+    else sprintf (how, "exited with status %d", WEXITSTATUS(status));
+    if (c == NULL) {
+	fprintf (info, "%s Server for %s (pid %d) %s\n",
+		 localtime_string(dtime()), s->station, s->pid, how);
+	unwatch_pid(&s->pidfd);
+	s->pid = -1;
+	if ((i = station_index(s->station)) >= 0) cs_detach(me, i);
+	s->status = CSCR_DIED;
+	if (s->stopping) {
+	    s->stopping = 0;
+	    s->time_check = s->time_complete = 0;
+	}
+    }
+    else {
+	fprintf (info, "%s Client %s for %s (pid %d) %s\n",
+		 localtime_string(dtime()), c->client, s->station, c->pid, how);
+	unwatch_pid(&c->pidfd);
+	c->pid = -1;
+	c->status = CLIENT_DEAD;
+	c->exited = 1;
+    }
+    fflush (info);
+    s->time_wakeup = dtime();
+}
+
+/************************************************************************
+ *  reap_children:
+ *	Collect the exit status of all programs spawned in event mode
+ *	that have exited, and record the exit of known servers and clients.
+ ************************************************************************/
+void reap_children()
+{
+    STATION_INFO *s;
+    CLIENT_INFO *c;
+    int pid, status;
+
+    while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+	for (s=st_head; s!=NULL; s=s->next) {
+	    if (s->pid == pid) process_exited(s, NULL, status);
+	    for (c=s->client; c!=NULL; c=c->next) {
+		if (c->pid == pid) process_exited(s, c, status);
+	    }
+	}
+    }
+}
+
+/************************************************************************
+ *  watch_pid:
+ *	Return a pidfd that becomes readable when the process exits,
+ *	or -1 if not in event mode or pidfds are not supported.
+ ************************************************************************/
+int watch_pid (int pid)
+{
+#if defined(LINUX) && defined(SYS_pidfd_open)
+    if (event_mode && pid > 1) return ((int)syscall(SYS_pidfd_open, pid, 0));
+#endif
+    return (-1);
+}
+
+/************************************************************************
+ *  unwatch_pid:
+ *	Close a pidfd returned by watch_pid.
+ ************************************************************************/
+void unwatch_pid (int *pidfd)
+{
+    if (*pidfd >= 0) close (*pidfd);
+    *pidfd = -1;
+}
+
+/************************************************************************
+ *  server_settled:
+ *	While waiting for a server we spawned to initialize, or for a
+ *	server we terminated to exit, look at its shared memory segment
+ *	now rather than waiting for the full delay.
+ *	Return 1 if the server is ready (or has exited), 0 otherwise.
+ ************************************************************************/
+int server_settled (STATION_INFO *s, double now)
+{
+    pclient_station this;
+    int i, status;
+
+    if (! s->starting && ! s->stopping) return (0);
+    if ((i = station_index(s->station)) < 0) return (0);
+    this = (pclient_station) ((intptr_t) me + me->offsets[i]);
+    /* Do not wait for the next CS_CHECK_INTERVAL to link or check.	*/
+    this->last_attempt = 0;
+    status = cs_check (me, i, now);
+    if (s->stopping) return (status == CSCR_DIED);
+    if (status != CSCR_GOOD && status != CSCR_NODATA && status != CSCR_CHANGE)
+	return (0);
+    return (this->base != (pserver_struc) NOCLIENT && this->base->init == 'I');
+}
+
+/************************************************************************
+ *  station_active:
+ *	Return 1 if the station is starting up or shutting down and its
+ *	current step has not yet timed out.  Such a station holds one of
+ *	the MAX_PARALLEL slots.
+ ************************************************************************/
+int station_active (STATION_INFO *s, double now)
+{
+    return ((s->starting || s->stopping || s->shutting_down) &&
+	    now < s->time_complete);
+}
+
+/************************************************************************
+ *  parallel_slot:
+ *	Return 1 if the station may begin a startup or shutdown, or 0 if
+ *	it must wait because MAX_PARALLEL other stations are active.
+ *	Stations waiting for a slot get one in station order.
+ ************************************************************************/
+int parallel_slot (STATION_INFO *s)
+{
+    STATION_INFO *p;
+    double now;
+    int n = 0;
+
+    now = dtime();
+    if (max_parallel <= 0 || station_active(s, now)) return (1);
+    for (p=st_head; p!=NULL; p=p->next) {
+	if (p != s && station_active(p, now)) ++n;
+    }
+    if (n < max_parallel) return (1);
+    if (debug(DEBUG_STATE)) {
+	fprintf (info, "%s waiting, %d stations starting or stopping\n", 
+		 s->station, n);
+    }
+    return (0);
+}
+
 /************************************************************************
  *  collect_station_info:
  *	Collect information for the specified station(s).
@@ -794,6 +1241,7 @@ STATION_INFO *collect_station_info (char *station_name)
 	}
 	while ((c=s->client) != NULL) {
 	    s->client = c->next;
+	    unwatch_pid(&c->pidfd);
 	    free(c);
 	}
 	
@@ -867,7 +1315,8 @@ STATION_INFO *collect_station_info (char *station_name)
 	    else if (strcmp(str1,"SERVER")==0) {
 		strcpy(s->program,str2);
 	    }
-	    else if (strncmp(str1,"CLIENT",6)==0) {
+	    else if (strncmp(str1,"CLIENT",6)==0 &&
+		     strcmp(str1,"CLIENT_STARTUP_DELAY")!=0) {
 		if ((p = strchr(str2,',')) != NULL) {
 		    *p = '\0';
 		    c = find_client_entry (s, str2, 1);
@@ -1016,6 +1465,7 @@ STATION_INFO *find_station_entry (char *station, int create_flag)
     s->re_notify = -1;
     s->res_notify = -1;
     s->pid = -1;
+    s->pidfd = -1;
     if (p == NULL) {
 	/* Put at head of the list. */
 	s->next = st_head;
@@ -1058,6 +1508,7 @@ CLIENT_INFO *find_client_entry (STATION_INFO *s, char *client, int create_flag)
     strcpy(c->client,client);
     upshift(c->client);
     c->status = CSCR_STATUS_UNKNOWN;
+    c->pidfd = -1;
     if (p == NULL) {
 	/* Put at head of the list. */
 	c->next = s->client;
@@ -1167,13 +1618,19 @@ int server_status (STATION_INFO *s)
 
     now = dtime();
     if (now < s->time_check) {
-	if (debug(DEBUG_STATUS))
-	    fprintf (info, "skipping station %s - %.0lf more seconds\n",
-		     s->station, s->time_check - now);
-	status = CSCR_STATUS_UNKNOWN;
-	s->status = status;
-	return(status);
+	if (! server_settled(s, now)) {
+	    if (debug(DEBUG_STATUS))
+		fprintf (info, "skipping station %s - %.0lf more seconds\n",
+			 s->station, s->time_check - now);
+	    status = CSCR_STATUS_UNKNOWN;
+	    s->status = status;
+	    return(status);
+	}
+	/* Server is ready, or has exited, before the delay ended.	*/
+	s->time_check = 0;
+	if (s->stopping) s->time_complete = 0;
     }
+    s->stopping = 0;
 
     if ((i = station_index(s->station)) < 0) {
 	if (debug(DEBUG_STATUS))
@@ -1184,6 +1641,10 @@ int server_status (STATION_INFO *s)
     }
 
     this = (pclient_station) ((intptr_t) me + me->offsets[i]);
+    /* In event mode try to attach to a server at once rather than	*/
+    /* once every CS_CHECK_INTERVAL.  A server that dies is reported	*/
+    /* by its pidfd, and cs_link ignores the segment of a dead server.	*/
+    if (event_mode && this->status != CSCR_GOOD) this->last_attempt = 0;
     status = cs_check (me, i, now);
     pcomm = (pvoid) ((intptr_t) me + this->comoutoffset) ;
     pcomm->completion_status = CSCS_IDLE;
@@ -1201,11 +1662,21 @@ int server_status (STATION_INFO *s)
 	if (debug(DEBUG_STATUS))
 	    fprintf (info, "%-4.4s server died\n", s->station);
 	s->pid = -1;
+	unwatch_pid(&s->pidfd);
 	return(status);
     }
 
     if (status == CSCR_GOOD) {
+	if (s->pid != (this->base)->server_pid) unwatch_pid(&s->pidfd);
 	s->pid = (this->base)->server_pid;
+	if (event_mode) {
+	    /* The server is alive until its pidfd says otherwise, and	*/
+	    /* the link status is only needed for timeout notification	*/
+	    /* and the suspended flag, so get it once per poll_interval.	*/
+	    if (s->pidfd < 0) s->pidfd = watch_pid(s->pid);
+	    if (s->linkstat != NULL && now < s->time_linkstat) return (status);
+	    s->time_linkstat = now + poll_interval;
+	}
 	this->command = CSCM_LINKSTAT;
 	err = cs_svc(me, i) ;
 	if (err == CSCR_GOOD) {
@@ -1272,12 +1743,36 @@ int client_status (STATION_INFO *s, CLIENT_INFO *c)
 	return(c->status);
     }
     if (c->time_check > now) {
+	/* While the station is starting, a client that has registered	*/
+	/* with the server is good before its startup delay ends.	*/
+	if (s->starting) {
+	    double time_check = c->time_check;
+	    c->time_check = 0;
+	    status = client_status(s, c);
+	    c->time_check = time_check;
+	    if (status == CLIENT_GOOD) return (status);
+	    c->status = CSCR_STATUS_UNKNOWN;
+	}
 	if (debug(DEBUG_STATUS))
 	    fprintf (info, "skipping client %s - %.0lf more seconds\n",
 		     c->client, c->time_check - now);
 	return(c->status);
     }
 
+    /* In event mode a registered client is alive until its pidfd says	*/
+    /* otherwise, and one that we saw exit stays dead until we spawn it	*/
+    /* again, so the server need not be asked.  The block count is	*/
+    /* still needed from the server while shutting down.		*/
+    if (event_mode && c->exited) {
+	c->status = CLIENT_DEAD;
+	return (c->status);
+    }
+    if (event_mode && c->pidfd >= 0 && s->status == CSCR_GOOD && 
+	s->shutting_down == 0) {
+	c->status = CLIENT_GOOD;
+	return (c->status);
+    }
+
     if ((i = station_index(s->station)) < 0) {
 	if (debug(DEBUG_STATUS))
 	    fprintf (info, "Warning - %-4.4s not found\n", s->station);
@@ -1325,6 +1820,7 @@ int client_status (STATION_INFO *s, CLIENT_INFO *c)
 	return (c->status);
     }
     if (poc->client_pid != c->pid) {
+	unwatch_pid(&c->pidfd);
 	if (c->pid != -1 && debug(DEBUG_STATUS)) {
 	    fprintf (info, "Warning = server says pid = %d, pidfile says pid = %d\n",
 		     poc->client_pid, c->pid);
@@ -1338,11 +1834,13 @@ int client_status (STATION_INFO *s, CLIENT_INFO *c)
 	    fprintf (info, "Warning: %-4.4s client %s pid=%d not found\n",
 		     s->station, c->client, c->pid);
 	c->status = CLIENT_DEAD;
+	unwatch_pid(&c->pidfd);
     }
     else { 
 	if (debug(DEBUG_STATUS))
 	    fprintf (info, "Client %s for server %s found\n", c->client, s->station);
 	c->status = CLIENT_GOOD;
+	if (c->pidfd < 0) c->pidfd = watch_pid(c->pid);
     }
     return (c->status);
 }
@@ -1351,6 +1849,10 @@ int client_status (STATION_INFO *s, CLIENT_INFO *c)
 /************************************************************************
  *  spawn_process:
  *	Spawn a new process.
+ *	Normally the process is spawned as a grandchild, and the exit
+ *	status of the intermediate child is returned.  In event mode the
+ *	process is spawned as our own child so that we get SIGCHLD when
+ *	it exits, and its pid is returned.
  ************************************************************************/
 int spawn_process (char *prog, char *station)
 {
@@ -1363,7 +1865,6 @@ int spawn_process (char *prog, char *station)
     char logfile[2048];
     char cmd[2048];
     int n = 0;
-    int fd;
 
     fprintf (info, "%s Spawning for %s: %s %s\n", 
 	     localtime_string(dtime()), station, prog, station);
@@ -1393,28 +1894,33 @@ int spawn_process (char *prog, char *station)
     argv[n] = 0;
 
     fflush (info);
+    if (event_mode) {
+	pid = fork();
+	switch (pid) {
+	case 0:		    /* child process				*/
+	    {
+		/* Do not pass on the signals blocked for the signalfd.	*/
+		sigset_t mask;
+		sigemptyset (&mask);
+		sigprocmask (SIG_SETMASK, &mask, NULL);
+	    }
+	    exec_process (path, argv, logfile);
+	    break;
+	case -1:
+	    perror("fork");
+	    return (-1);
+	    break;
+	default:	    /* Parent process.				*/
+	    return (pid);
+	}
+    }
     pid = fork();
     switch (pid) {
     case 0:		    /* child process				*/
 	pid2 = fork();
 	switch (pid2) {
 	case 0:	    /* grandchild				*/
-	    fd = open ("/dev/null", O_RDONLY);
-	    fclose(stdin);
-	    dup2(fd,0);
-	    close(fd);
-	    fd = open (logfile, O_WRONLY|O_APPEND|O_CREAT,0666);
-	    fclose(stdout);
-	    fclose(stderr);
-	    dup2(fd,1);
-	    dup2(fd,2);
-	    close(fd);
-	    /* Close any misc units left open by libraries...		*/
-	    for (fd=3;fd<16;fd++) close(fd);
-	    /* execve (path, argv, new_environ); */
-	    execv (path, argv);  /* preserve existing environment */
-	    perror("vfork");
-	    _exit(-1);
+	    exec_process (path, argv, logfile);
 	    break;
 	case -1:
 	    perror("vfork");
@@ -1440,6 +1946,34 @@ int spawn_process (char *prog, char *station)
 	return(WEXITSTATUS(status));
     }
     }
+    return (-1);	/* Not reached.	*/
+}
+
+/************************************************************************
+ *  exec_process:
+ *	Redirect stdin from /dev/null and stdout and stderr to the
+ *	logfile, and exec the program.  Called in the spawned process.
+ ************************************************************************/
+void exec_process (char *path, char **argv, char *logfile)
+{
+    int fd;
+
+    fd = open ("/dev/null", O_RDONLY);
+    fclose(stdin);
+    dup2(fd,0);
+    close(fd);
+    fd = open (logfile, O_WRONLY|O_APPEND|O_CREAT,0666);
+    fclose(stdout);
+    fclose(stderr);
+    dup2(fd,1);
+    dup2(fd,2);
+    close(fd);
+    /* Close any misc units left open by libraries...			*/
+    for (fd=3;fd<16;fd++) close(fd);
+    /* execve (path, argv, new_environ); */
+    execv (path, argv);  /* preserve existing environment */
+    perror("vfork");
+    _exit(-1);
 }
 
 /************************************************************************
@@ -1520,6 +2054,8 @@ int shutdown_station (STATION_INFO *s)
 
     /* Terminate all managed input clients.				*/
     if (s->shutting_down == 0) {
+	if (! parallel_slot(s)) return (PARTIAL_SHUTDOWN);
+	s->starting = 0;
 	n = 0;
 	now = dtime();
 	for (c=s->client; c!=NULL; c=c->next) {
@@ -1540,7 +2076,7 @@ int shutdown_station (STATION_INFO *s)
 	}
 	s->shutting_down = 1;
 	if (n > 0) {
-	    s->time_check = now + s->client_startup_delay;
+	    s->time_check = 0;
 	    s->time_complete = now + s->max_shutdown_wait;
 	    return (PARTIAL_SHUTDOWN);
 	}
@@ -1560,6 +2096,7 @@ int shutdown_station (STATION_INFO *s)
 		else {
 		    c->status = CLIENT_DEAD;
 		    c->pid = -1;
+		    unwatch_pid(&c->pidfd);
 		}
 	    }
 	}
@@ -1580,7 +2117,7 @@ int shutdown_station (STATION_INFO *s)
 	    s->status = err;
 	    return (status);
 	}
-	s->time_check = now + s->client_startup_delay;
+	s->time_check = 0;
 	s->time_complete = now + s->max_shutdown_wait;
 	s->shutting_down = 3;
 	status = PARTIAL_SHUTDOWN;
@@ -1621,7 +2158,7 @@ int shutdown_station (STATION_INFO *s)
 		}
 	    }
 	}
-	s->time_check = now + s->client_startup_delay;
+	s->time_check = 0;
 	s->time_complete = now + s->max_shutdown_wait;
 	s->shutting_down = 5;
     }
@@ -1639,6 +2176,7 @@ int shutdown_station (STATION_INFO *s)
 		else {
 		    c->status = CLIENT_DEAD;
 		    c->pid = -1;
+		    unwatch_pid(&c->pidfd);
 		}
 	    }
 	}
@@ -1674,6 +2212,7 @@ int shutdown_station (STATION_INFO *s)
 	    fprintf (info, "%s Terminated server for %s\n", 
 		     localtime_string(dtime()), s->station);
 	    s->status = CSCR_DIED;	/* Assume that it has died.	*/
+	    s->stopping = 1;		/* Until we see it has.		*/
 	    status = FULL_SHUTDOWN;
 	}
 	else {
@@ -1703,6 +2242,7 @@ int startup_station (STATION_INFO *s)
 {
     CLIENT_INFO *c;
     int status;
+    int pid;
     double now;
 
     s->shutting_down = 0;
@@ -1711,12 +2251,16 @@ int startup_station (STATION_INFO *s)
     now = dtime();
     switch (status) {
     case CSCR_DIED:
+	if (! parallel_slot(s)) return (PARTIAL_STARTUP);
+	s->starting = 1;
+	s->stopping = 0;
 	s->time_check = now + s->server_startup_delay;	
 	s->time_complete = s->time_check;
 	fprintf (info, "%s Spawning server for %s\n", 
 		 localtime_string(now), s->station);
 	fflush (info);
-	spawn_process (s->program, s->station);
+	pid = spawn_process (s->program, s->station);
+	if (event_mode && pid > 0) s->pid = pid;
 	if (s->linkstat != NULL) {
 	    if (debug(DEBUG_MALLOC)) {
 		fprintf (info, "%s %s (%d) free linkstat_rec\n", 
@@ -1743,10 +2287,16 @@ int startup_station (STATION_INFO *s)
 	if (status != CLIENT_GOOD && now >= s->time_check && now >= c->time_check) {
 	    c->time_check = now + s->client_startup_delay;
 	    s->time_complete = c->time_check;
+	    s->starting = 1;
 	    fprintf (info, "%s Spawning client %s for %s\n", 
 		     localtime_string(dtime()), c->client, s->station);
 	    fflush (info);
-	    spawn_process (c->program, s->station);
+	    pid = spawn_process (c->program, s->station);
+	    if (event_mode && pid > 0) {
+		unwatch_pid(&c->pidfd);
+		c->pid = pid;
+		c->exited = 0;
+	    }
 	}
     }
     return(FULL_STARTUP);
@@ -1861,6 +2411,7 @@ int suspend_link (STATION_INFO *s)
     this->command = CSCM_SUSPEND;
     err = cs_svc(me, i);
     pcomm->completion_status = CSCS_IDLE;
+    s->time_linkstat = 0;
     if (err == CSCR_GOOD)
 	fprintf (info, "%s Suspended link for %s\n", localtime_string(dtime()), 
 		 s->station);
@@ -1893,6 +2444,7 @@ int resume_link (STATION_INFO *s)
     this->command = CSCM_RESUME;
     err = cs_svc(me, i);
     pcomm->completion_status = CSCS_IDLE;
+    s->time_linkstat = 0;
     if (err == CSCR_GOOD)
 	fprintf (info, "%s Resumed link for %s\n", localtime_string(dtime()), 
 		 s->station);
@@ -2154,6 +2706,7 @@ void set_initial_states (STATION_INFO *s, int flag)
 void reconfig_daemon() 
 {
     STATION_INFO *s;
+    CLIENT_INFO *c;
     char *network_ini;
 
     /* Determine if reconfiguration is allowed at this point.		*/
@@ -2171,6 +2724,8 @@ void reconfig_daemon()
     while (st_head != NULL) {
 	s = st_head;
 	st_head = s->next;
+	unwatch_pid(&s->pidfd);
+	for (c=s->client; c!=NULL; c=c->next) unwatch_pid(&c->pidfd);
 	free (s);
     }
     /* Read network configuration file.					*/
@@ -2236,6 +2791,12 @@ void read_network_cfg (char *config_file, char *section)
 	else if (strcmp(str1,"POLL_INTERVAL")==0) {
 	    poll_interval = atoi(str2);
 	}
+	else if (strcmp(str1,"MONITOR_MODE")==0) {
+	    event_mode = (strcasecmp(str2,"EVENT")==0);
+	}
+	else if (strcmp(str1,"MAX_PARALLEL")==0) {
+	    max_parallel = atoi(str2);
+	}
 	/* Default Startup/Shutdown parameters.			*/
 	/* Can be overridden on a per-station basis.		*/
 	else if (strcmp(str1,"SERVER_STARTUP_DELAY")==0) {
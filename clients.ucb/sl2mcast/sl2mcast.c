@@ -22,6 +22,9 @@
  *		to support libslink auto-detection of MiniSEED record size.
  *  2022-02-59 DSN ver 1.4.3 (2020.059)
  *		Allow environmental override of STATIONS_INI pathname;
+ *  2026-10-19 ver 1.4.4 (2026.292)
+ *		Wait for SeedLink data with poll() on the connection instead
+ *		of sleeping 5 to 100 ms.
  ***************************************************************************/
 
 /* System includes */
@@ -37,6 +40,7 @@
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <signal.h>
+#include <poll.h>
 #include <qlib2.h>
 #include <libslink.h>
 
@@ -51,7 +55,7 @@
 
 #include "retcodes.h"
 
-#define VERSION "1.4.2 (2021.309)"
+#define VERSION "1.4.4 (2026.292)"
 
 #ifdef COMSERV2
 #define	CLIENT_NAME	"SL2M"
@@ -188,9 +192,7 @@ int main (int argc, char **argv)
     char  *multicast_port = NULL;
     char  *seedlink_server = NULL;
 
-    int prethrottle = 0;
-    int throttlecnt = 1;
-    int throttlewait = 0;
+    struct pollfd pfd;
     char *seedlink_station = NULL;
     char *seedlink_station_default = NULL;
 
@@ -605,36 +607,24 @@ int main (int argc, char **argv)
 		    packetcnt = 0;
 		}
 	    }
-          
-	    prethrottle = 0;
 	}
-	else /* Otherwise throttle the loop */
+	else /* Otherwise wait for more data */
 	{
-	    /* Throttling scheme:
-	     *
-	     * First let the loop query the non-blocking socket 10 times (prethrottle),
-	     * this should allow the TCP subsystem time enough when data has reached the
-	     * host and is in the stack buffers.
-	     *
-	     * Next progressively throttle the loop by sleeping for 5ms and increasing
-	     * the sleep time by 5ms increments until a maximum of 100ms.  Continue to
-	     * throttle the loop by sleeping for 100ms until data arrives.
+	    /* Wait until the SeedLink connection is readable, for at most
+	     * 100ms so that the comserv server and the reconnect and
+	     * keepalive timers of libslink are still checked.  Without a
+	     * connection, libslink is waiting to reconnect.
 	     */
 	    if (debug>1) { printf("DEBUG: retval != SLPACKET\n"); }
-	    prethrottle++;
-          
-	    if ( prethrottle >= 10 )
+	    if ( slconn->link != -1 )
 	    {
-		if ( throttlewait < 100 || throttlecnt == 1 )
-		    throttlewait = 5 * throttlecnt;
-              
-		throttlecnt++;
-              
-		usleep (throttlewait*1000);
+		pfd.fd = slconn->link;
+		pfd.events = POLLIN;
+		poll (&pfd, 1, 100);
 	    }
 	    else
 	    {
-		throttlecnt = 1;
+		usleep (100000);
 	    }
 	}
     }
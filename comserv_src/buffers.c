@@ -17,6 +17,9 @@ Edit History:
                     the "noackmask" of all queues, rather than just
                     returning the current noackmask <> 0.
     7 29 Sep 2020 DSN	Updated for comserv3.
+    8 19 Oct 2026     Count packets and blocked rings in the statistics table.
+    9 19 Oct 2026     Record the packet trace of each new packet.
+   10 19 Oct 2026     Wake clients waiting in cs_wait for each new packet.
 */
 #include <stdio.h>
 #include <errno.h>
@@ -36,12 +39,15 @@ Edit History:
 #include "stuff.h"
 #include "service.h"
 #include "server.h"
+#include "chanstats.h"
+#include "pkttrace.h"
 
-short VER_BUFFERS = 7 ;
+short VER_BUFFERS = 9 ;
 
 extern tring rings[NUMQ] ;         /* Description of each ring buffer */
 extern pserver_struc base ;        /* Base address of server memory segment */
 extern int32_t blockmask, noackmask ;
+extern cs_stats_table *stats_table ;
 
 void setupbuffers (void)
 {
@@ -87,14 +93,24 @@ tring_elem *getbuffer (short qnum)
        "if (bscan->next->blockmap)" ??? */
     nbscan = (pvoid) bscan->next ;              /* tail to remove */
     if (nbscan->blockmap)
+      {
+	if (stats_table != NULL)
+	  {
+	    cs_stats_server_begin (stats_table)->ring_full++ ;
+	    cs_stats_server_end (stats_table) ;
+	  }
 	return NULL ;                   /* trying to get rid of blocked record */
+      }
     rings[qnum].head = nbscan ;         /* move next in pointer */
     memset((pchar) &bscan->user_data, 0, rings[qnum].size -
 	   (sizeof(tring_elem) - sizeof(tdata_user))) ; /* clear to zero */
     bscan->blockmap = blockmask ;       /* put in current mask */
     bscan->packet_num = base->next_data++ ; /* packet number */
+    cs_signal_data (base) ;             /* wake clients in cs_wait */
     if (nbscan == rings[qnum].tail)
 	rings[qnum].tail = (pring_elem) rings[qnum].tail->next ; /* throw away oldest */
+    cs_stats_packet (stats_table, qnum, rings[qnum].xfersize, 0.0, 0.0) ;
+    pkttrace_commit (bscan->packet_num, qnum) ;
     return bscan ;
 }
 
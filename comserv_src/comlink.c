@@ -89,6 +89,12 @@ Edit History:
  33   01 Mar 2012 DSN Removed (again) the unneeded flip2 calls for blockette info for COMMENTS.
  34   24 Apr 2017 DSN Removed line terminator from LogMessage calls.
  35   29 Sep 2020 DSN Updated for comserv3.
+ 36   19 Oct 2026     Scan input for SOH, DLE and ETX with memchr and unstuff whole
+                    runs with memcpy. check_input drains all pending input, and
+                    wait_input sleeps in poll() on the link. An accepted network
+                    connection is non-blocking and is closed when the DA closes it.
+ 37   19 Oct 2026     Add data records to the channel statistics table.
+ 38   19 Oct 2026     Mark the reception of each packet for the packet trace.
 */
 #include <stdio.h>
 #include <errno.h>
@@ -99,6 +105,8 @@ Edit History:
 #ifndef _OSK
 #include <termio.h>
 #include <fcntl.h>
+#include <poll.h>
+#include <time.h>
 #include <sys/types.h>
 #include <sys/ipc.h>
 #include <sys/sem.h>
@@ -119,6 +127,8 @@ Edit History:
 #include "server.h"
 #include "timeutil.h"
 #include "logging.h"
+#include "chanstats.h"
+#include "pkttrace.h"
 #ifdef _OSK
 #include "os9stuff.h"
 #endif
@@ -137,7 +147,11 @@ Edit History:
 #define SET_LITTLE_ENDIAN 0  /* of fixed SEED header */
 
 
-short VER_COMLINK = 35 ;
+/* Maximum number of reads per call to check_input, so that a link catching up
+   after an outage does not keep clients waiting for service indefinitely */
+#define MAXDRAIN 64
+
+short VER_COMLINK = 38 ;
 
 extern seed_net_type network ;
 extern complong station ;
@@ -146,7 +160,7 @@ boolean anystation = FALSE ;
 
 extern boolean noultra ;
 extern pchar src, srcend, dest, destend, term ;
-extern unsigned char sbuf[BLOB] ;
+extern unsigned char sbuf[SBUFSIZE] ;
 extern DA_to_DP_buffer dbuf ;
 extern byte last_packet_received ;
 extern byte lastchar ;
@@ -158,6 +172,7 @@ extern DP_to_DA_buffer temp_pkt ;
 extern tcrc_table crctable ;
 extern tclients clients[MAXCLIENTS] ;
 extern pserver_struc base ;
+extern cs_stats_table *stats_table ;
 
 extern byte inphase ;
 extern byte upphase ;
@@ -807,6 +822,7 @@ void process (void)
     random_calibration *calrand ;
     abort_calibration *calabort ;
 #endif
+    pkttrace_start () ;
     dest = (pchar) &dbuf.seq ; /* reset buffer pointer */
     linkstat.total_packets++ ;
     size = (short) ((uintptr_t) term - (uintptr_t) dest - 6) ;
@@ -1080,6 +1096,8 @@ void process (void)
 	    }
 	    p1 = (pvoid) ((uintptr_t) pseed + 64) ;             /* skip header */
 	    memcpy (p1, (pchar) &dbuf.data_buf.cr.frames, 448) ;   /* and copy data portion */	
+	    cs_stats_update (stats_table, (pchar) pseed, 512, DATAQ,
+			     freebuf->user_data.reception_time) ;
 	    break ;
 	}
 	case BLOCKETTE :
@@ -1775,12 +1793,29 @@ void process (void)
     }
 }
 
-void fillbuf (void)
+/* The DA closed the network connection, or reading from it failed */
+static void close_network (void)
+{
+    shutdown(path, 2) ;
+    close(path) ;
+    seq_valid = FALSE ;
+    if (linkstat.ultraon)
+    {
+	linkstat.linkrecv = FALSE ;
+	linkstat.ultrarecv = FALSE ;
+    }
+    path = -1 ; /* signal not open */
+}
+
+/* Read whatever is available into sbuf, returns number of bytes read */
+int fillbuf (void)
 {
     int numread ;
     socklen_t clilen;
 #ifdef _OSK
     u_int32 err, count ;
+#else
+    int flags ;
 #endif
 	
     src = (pchar) &sbuf ;
@@ -1794,6 +1829,14 @@ void fillbuf (void)
 	    netdly_cnt = 0 ;
 	    if ((verbose) && (path >= 0))
 		LogMessage(CS_LOG_TYPE_INFO, "Network connection with DA opened") ;
+#ifndef _OSK
+	    /* the accepted socket does not inherit FNDELAY from sockfd */
+	    if (path >= 0)
+	    {
+		flags = fcntl(path, F_GETFL, 0) ;
+		fcntl(path, F_SETFL, flags | FNDELAY) ;
+	    }
+#endif
 	    if (linkstat.ultraon)
 	    {
 		linkstat.linkrecv = FALSE ;
@@ -1803,14 +1846,14 @@ void fillbuf (void)
 	    }
 	}
 	if (path < 0)
-	    return ;
+	    return 0 ;
     }
 #ifdef _OSK
     if (serial) /* make sure we don't block here */
     {
 	err = _os_gs_ready(path, &count) ;
 	if ((err == EOS_NOTRDY) || (count == 0))
-	    return ;
+	    return 0 ;
 	else if (err != 0)
 	{
 	    numread = -1 ;
@@ -1818,8 +1861,8 @@ void fillbuf (void)
 	}
 	else
 	{
-	    if (count > BLOB)
-		count = BLOB ;
+	    if (count > SBUFSIZE)
+		count = SBUFSIZE ;
 	    err = blockread (path, count, src) ;
 	    if (err == 208)
 		numread = read(path, src, count) ;
@@ -1833,9 +1876,9 @@ void fillbuf (void)
 	}
     }
     else
-	numread = read(path, src, BLOB) ;
+	numread = read(path, src, SBUFSIZE) ;
 #else
-    numread = read(path, src, BLOB) ;
+    numread = read(path, src, SBUFSIZE) ;
 #endif
     if (numread > 0)
     {
@@ -1845,9 +1888,11 @@ void fillbuf (void)
 	    maxbytes = numread ;
 	    LogMessage(CS_LOG_TYPE_ERROR, "%d bytes read", numread) ;
 	}
+	return numread ;
     }
     else if (numread < 0)
-	if (errno != EWOULDBLOCK)
+    {
+	if ((errno != EWOULDBLOCK) && (errno != EAGAIN) && (errno != EINTR))
 	{
 	    linkstat.io_errors++ ;
 	    linkstat.lastio_error = errno ;
@@ -1860,161 +1905,192 @@ void fillbuf (void)
 	    {
 		if (verbose)
 		    perror ("Network connection with DA closed\n") ;
-		shutdown(path, 2) ;
-		close(path) ;
-		seq_valid = FALSE ;
-		if (linkstat.ultraon)
-		{
-		    linkstat.linkrecv = FALSE ;
-		    linkstat.ultrarecv = FALSE ;
-		}
-		path = -1 ; /* signal not open */
+		close_network () ;
 	    }
 	}
-}
-	
-short inserial (pchar b)
-{
-	
-    if (src == srcend)
-	fillbuf () ;
-	
-    if (src != srcend)
+    }
+    else if (!serial) /* end of file, the DA closed the connection */
     {
-	*b = *src++ ;
-	return 1 ;
+	if (verbose)
+	    LogMessage(CS_LOG_TYPE_INFO, "Network connection with DA closed") ;
+	close_network () ;
     }
-    else
-	return 0 ;
+    return 0 ;
 }
-	
+
+/* Copy the input up to the next ETX into dbuf, removing DLE stuffing.
+   Runs of bytes without DLE or ETX are found with memchr and copied as
+   a block. Sets term if an ETX was found. */
 void dlestrip (void)
 {
-    boolean indle ;
+    pchar p ;
+    int n ;
 	
     term = NULL ;
-    indle = (lastchar == DLE) ;
+    if ((lastchar == DLE) && (src != srcend) && (dest != destend))
+    {
+	*dest++ = *src++ ;
+	lastchar = NUL ;
+    }
     while ((src != srcend) && (dest != destend))
     {
-	if (indle)
-	{
-	    *dest++ = *src ;
-	    indle = FALSE ;
-	}
-	else if (*src == DLE)
-	    indle = TRUE ;
-	else if (*src == ETX)
+	n = srcend - src ;
+	if (n > destend - dest)
+	    n = destend - dest ;
+	p = memchr (src, DLE, n) ;
+	if (p != NULL)
+	    n = p - src ;
+	p = memchr (src, ETX, n) ;
+	if (p != NULL)
+	    n = p - src ;
+	memcpy (dest, src, n) ;
+	dest += n ;
+	src += n ;
+	if ((src == srcend) || (dest == destend))
+	    break ;
+	if (*src++ == ETX)
 	{
 	    term = dest ;
-	    src++ ;
 	    lastchar = NUL ;
 	    return ;
 	}
-	else
-	    *dest++ = *src ;
-	src++ ;
+	/* DLE, the next byte is data */
+	if (src == srcend)
+	{
+	    lastchar = DLE ;
+	    return ;
+	}
+	*dest++ = *src++ ;
     }
-    if (indle)
-	lastchar = DLE ;
-    else
-	lastchar = NUL ;
+    lastchar = NUL ;
 }
-	
-void check_input (void)
+
+/* Run the framing state machine over everything in sbuf, calling
+   process for each complete packet */
+static void scan_input (void)
 {
-    int numread ;
-    short err ;
+    pchar p ;
     char b ;
-	
-    if (udplink)
-    {
-	numread = recv(path, dest, destend - dest, 0) ;
-	if (numread > 0)
-	{
-	    term = (pchar) ((uintptr_t) dest + numread) ;
-	    process () ;
-	}
-	else if (numread < 0)
-	    if (errno != EWOULDBLOCK)
-	    {
-		linkstat.io_errors++ ;
-		linkstat.lastio_error = errno ;
-		seq_valid = FALSE ;
-		if (linkstat.ultraon)
-		{
-		    linkstat.linkrecv = FALSE ;
-		    linkstat.ultrarecv = FALSE ;
-		}
-	    }
-	return ;
-    }
-    if (src == srcend)
-	fillbuf () ;
-    switch (inphase)
-    {
-    case SOHWAIT :
-	dest = (pchar) &dbuf.seq ;
-    case SYNWAIT :
+
+    while (src != srcend)
     {
-	while (inphase != INBLOCK)
+	switch (inphase)
 	{
+	case SOHWAIT :
+	    dest = (pchar) &dbuf.seq ;
 	    lastchar = NUL ;
-	    err = inserial(&b) ;
-	    if (err != 1)
-		return ;
-	    if ((b == SOH))
+	    p = memchr (src, SOH, srcend - src) ;
+	    if (p == NULL)
+		src = srcend ;
+	    else
+	    {
+		src = p + 1 ;
 		inphase = SYNWAIT ;
-	    else if ((b == SYN) && (inphase == SYNWAIT))
+	    }
+	    break ;
+	case SYNWAIT :
+	    b = *src++ ;
+	    if (b == SYN)
+	    {
+		lastchar = NUL ;
 		inphase = INBLOCK ;
-	    else
+	    }
+	    else if (b != SOH)
 		inphase = SOHWAIT ;
-	}
-    }
-    case INBLOCK :
-    {
-	if (src == srcend)
-	    fillbuf (); /*IGD -> used to be just fillbuf with no brackets, fixed*/
-	if (src != srcend)
-	{
+	    break ;
+	case INBLOCK :
 	    dlestrip () ;
-	    if (dest == destend)
-		inphase = ETXWAIT ;
-	    else if (term != NULL)
+	    if (term != NULL)
 	    {
 		inphase = SOHWAIT ;
 		process () ;
-		break ;
 	    }
-	    else
-		break ;
-	}
-	else
+	    else if (dest == destend)
+		inphase = ETXWAIT ;
 	    break ;
-    }
-    case ETXWAIT :
-    {
-	if (src == srcend)
-	    fillbuf () ;
-	err = inserial (&b) ;
-	if (err == 1)
-	{
+	case ETXWAIT :
+	    b = *src++ ;
+	    inphase = SOHWAIT ;
 	    if (b == ETX)
 	    {
-		inphase = SOHWAIT ;
 		term = dest ;
 		process () ;
-		break ;
 	    }
-	    else
+	    break ;
+	default :
+	    inphase = SOHWAIT ;
+	    break ;
+	}
+    }
+}
+	
+/* Process all input that is available now, up to MAXDRAIN reads */
+void check_input (void)
+{
+    int numread, reads ;
+	
+    if (udplink)
+    {
+	for (reads = 0 ; reads < MAXDRAIN ; reads++)
+	{
+	    numread = recv(path, dest, destend - dest, 0) ;
+	    if (numread > 0)
 	    {
-		inphase = SOHWAIT ;
-		break ;
+		term = (pchar) ((uintptr_t) dest + numread) ;
+		process () ;
+		continue ;
 	    }
+	    else if (numread < 0)
+		if ((errno != EWOULDBLOCK) && (errno != EAGAIN) && (errno != EINTR))
+		{
+		    linkstat.io_errors++ ;
+		    linkstat.lastio_error = errno ;
+		    seq_valid = FALSE ;
+		    if (linkstat.ultraon)
+		    {
+			linkstat.linkrecv = FALSE ;
+			linkstat.ultrarecv = FALSE ;
+		    }
+		}
+	    break ;
 	}
+	return ;
     }
+    for (reads = 0 ; reads < MAXDRAIN ; reads++)
+    {
+	if ((src == srcend) && (fillbuf () == 0))
+	    break ;
+	scan_input () ;
     }
 }
 
+#ifndef _OSK
+/* Wait up to usecs microseconds for input from the DA. Returns at once
+   if input is already buffered. If the link is not open or reports an
+   error, just sleeps. */
+void wait_input (int32_t usecs)
+{
+    struct pollfd pfd ;
+    struct timespec rqtp, rmtp ;
+    int n ;
+
+    if (src != srcend)
+	return ;
+    rqtp.tv_sec = usecs / 1000000 ;
+    rqtp.tv_nsec = (usecs % 1000000) * 1000 ;
+    if (path >= 0)
+    {
+	pfd.fd = path ;
+	pfd.events = POLLIN ;
+	pfd.revents = 0 ;
+	n = poll (&pfd, 1, (usecs + 999) / 1000) ;
+	if ((n <= 0) || ((pfd.revents & (POLLERR | POLLHUP | POLLNVAL)) == 0))
+	    return ;
+    }
+    nanosleep (&rqtp, &rmtp) ;
+}
+#endif
+
 /******************************************************************************
                  BYTE-SWAPPING FUNCTIONS for little-endian vesion
 		Ilya Dricker, (i.dricker@isti.com) ISTI
@@ -44,6 +44,7 @@ Edit History:
    22 24 Aug 07 DSN Separate ENDIAN_LITTLE from LINUX logic.
    23 20 Feb 2012 DSN Fix new debugging code to output only on rambling or insane setting.
    24 29 Sep 2020 DSN Updated for comserv3.
+   25 19 Oct 2026     Mark the delivery of traced packets.
 */
 #include <stdio.h>
 #include <errno.h>
@@ -62,8 +63,9 @@ Edit History:
 #include "stuff.h"
 #include "service.h"
 #include "server.h"
+#include "pkttrace.h"
 
-short VER_COMMANDS = 24 ;     /*IGD LINUX compatible */
+short VER_COMMANDS = 25 ;     /*IGD LINUX compatible */
 
 extern tuser_privilege user_privilege ;
 extern boolean verbose ;
@@ -358,6 +360,7 @@ byte handler (pclient_struc svc, short clientnum)
 		if (good)
 		{
 		    memcpy ((pchar) pdata, (pchar) &bscan[lowi]->user_data, rings[lowi].xfersize) ;
+		    pkttrace_deliver (bscan[lowi]->packet_num) ;
 		    client->valdbuf++ ;
 		    pdata = (pdata_user) ((uintptr_t) pdata + client->dbufsize) ;
 		    if (insane) {
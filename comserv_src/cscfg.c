@@ -33,6 +33,7 @@ Edit History:
 		       with similar names.
    22 21 Apr 04 DSN Added myipaddr config directive.
    23 29 Sep 2020 DSN	Updated for comserv3.
+   24 19 Oct 2026     Add setting of "PKTTRACE".
 */
 #include <stdio.h>
 #include <errno.h>
@@ -70,7 +71,7 @@ Edit History:
 #include "os9stuff.h"
 #endif
 
-short VER_CSCFG = 23 ;
+short VER_CSCFG = 24 ;
 
 extern char log_channel_id[4] ;
 extern char log_location_id[3] ;
@@ -99,6 +100,7 @@ extern int32_t baud ;
 extern char parity ; 
 extern int32_t polltime ;
 extern int32_t reconfig_on_err ;
+extern int32_t pkttrace_entries ;
 extern int32_t grpsize ;
 extern int32_t grptime ;
 extern int32_t link_retry ;
@@ -293,6 +295,8 @@ void readcfg (void)
 	    rings[MSGQ].count = atoi((pchar)&str2) ;
 	else if (strcmp(str1, "BLKBUFS") == 0)
 	    rings[BLKQ].count = atoi((pchar)&str2) ;
+	else if (strcmp(str1, "PKTTRACE") == 0)
+	    pkttrace_entries = atoi((pchar)&str2) ;
 	else if (strcmp(str1, "RECONFIG") == 0)
 	    reconfig_on_err = atoi((pchar)&str2) ;
 	else if (strcmp(str1, "NETTO") == 0)
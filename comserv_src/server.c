@@ -71,6 +71,13 @@ Edit History:
    36 24 Apr 2017 DSN Removed line terminator from LogMessage calls.
    37 29 Sep 2020 DSN Updated for comserv3.
    38 07 Fev 2021 DSN Updated to allow environment variables override global pathnames.
+   39 19 Oct 2026     Wait for DA input in poll() instead of sleeping for polltime.
+   40 19 Oct 2026     Add the channel statistics table after the ring buffers
+                    in the server segment.
+   41 19 Oct 2026     Sample ring fill and client lag into the server
+                    statistics once a second.
+   42 19 Oct 2026     Add the packet trace table (PKTTRACE) after the
+                    statistics table.
 */           
 #include <stdio.h>
 #include <errno.h>
@@ -107,6 +114,8 @@ Edit History:
 #include "server.h"
 #include "timeutil.h"
 #include "logging.h"
+#include "chanstats.h"
+#include "pkttrace.h"
 #ifdef _OSK
 #include "os9stuff.h"
 #endif
@@ -134,7 +143,7 @@ typedef struct {
 #define PRIVILEGED_WAIT 1000000 /* 1 second */
 #define NON_PRIVILEGED_WAIT 100000 /* 0.1 second */
 #define NON_PRIVILEGED_TO 60.0
-#define EDITION 39
+#define EDITION 43
 
 char seedformat[4] = { 'V', '2', '.', '3' } ;
 char seedext = 'B' ;
@@ -148,6 +157,8 @@ string15 station ;
 tring rings[NUMQ] ;                /* Access structure for rings */
 
 pserver_struc base = NULL ;        /* Base address of server memory segment */
+cs_stats_table *stats_table = NULL ; /* Channel statistics in server segment */
+int32_t pkttrace_entries = 0 ;     /* Packets to trace, 0 if not tracing */
 pclient_struc cursvc = NULL ;      /* Current client being processed */
 pclient_station curclient = NULL ; /* Offset into client's memory for that station */
 
@@ -204,7 +215,7 @@ pchar srcend = NULL ;
 pchar dest = NULL ;
 pchar destend = NULL ;
 pchar term = NULL ;
-unsigned char sbuf[BLOB] ;
+unsigned char sbuf[SBUFSIZE] ;
 DA_to_DP_buffer dbuf ;
 
 byte last_packet_received = 0 ;
@@ -335,6 +346,7 @@ void send_window (void) ;
 void readcfg (void) ;
 void gcrcinit (void) ;
 void check_input (void) ;
+void wait_input (int32_t usecs) ;
 void setupbuffers (void) ;
 void request_ultra (void) ;
 void request_link (void) ;
@@ -461,18 +473,12 @@ int main (int argc, char *argv[], char **envp)
     int32_t ct, ctcount ;
     float cttotal ;
     struct sembuf notbusy = { 0, 1, 0 } ;
-    int32_t bufsize, size, stemp ;
+    int32_t bufsize, size, stemp, stats_offset, trace_offset ;
     int flags, ruflag ;
     int status ;
-#ifdef SOLARIS2
-    timespec_t rqtp, rmtp ;
-#endif
 #ifdef _OSK
     unsigned pollslp ;
 #endif
-#ifdef LINUX /*ADDED BY KIM */
-    struct timespec rqtp, rmtp ;
-#endif
 
        
     char filename[CFGWIDTH] ;
@@ -689,10 +695,15 @@ int main (int argc, char *argv[], char **envp)
 	rings[i].size = size ;
     }
     bufsize = (bufsize + 15) & 0xfffffff8 ; /* double word align */
+/* channel statistics table follows the ring buffers */
+    stats_offset = (sizeof(tserver_struc) + bufsize + 7) & 0xfffffff8 ;
+/* and the packet trace table follows the statistics */
+    trace_offset = (stats_offset + cs_stats_size(CS_STATS_MAXCHAN) + 7) & 0xfffffff8 ;
 
 /* create shared memory segment and install my process id */
-    shmid = shmget(segkey, sizeof(tserver_struc) + 
-		   bufsize, IPC_CREAT |  PERM) ;
+    shmid = shmget(segkey, trace_offset +
+		   ((pkttrace_entries > 0) ? pkttrace_size(pkttrace_entries) : 0),
+		   IPC_CREAT |  PERM) ;
     if (shmid == ERROR)
     {
 	LogMessage(CS_LOG_TYPE_ERROR, "Could not create server segment with key %d, exiting", segkey) ;
@@ -722,9 +733,24 @@ int main (int argc, char *argv[], char **envp)
 
 /* initialize next packet numbers */
     base->next_data = 0 ;
+    base->data_waiters = 0 ;
 
 /* Call routine to setup ring buffers for data and blockettes */
     setupbuffers () ;
+
+/* setup the channel statistics table */
+    stats_table = (cs_stats_table *) ((pchar) base + stats_offset) ;
+    cs_stats_init (stats_table, CS_STATS_MAXCHAN) ;
+    base->stats_offset = stats_offset ;
+
+/* setup the packet trace table */
+    base->trace_offset = 0 ;
+    if (pkttrace_entries > 0)
+    {
+	pkttrace_init ((pkt_trace_table *) ((pchar) base + trace_offset), pkttrace_entries) ;
+	base->trace_offset = trace_offset ;
+	LogMessage(CS_LOG_TYPE_INFO, "Tracing the last %d packets", pkttrace_table->nentries) ;
+    }
    
 /* Allow access to service queue */ 
 
@@ -1045,14 +1071,6 @@ int main (int argc, char *argv[], char **envp)
     }
     if (linkstat.ultraon)
 	request_link () ;
-#ifdef SOLARIS2
-    rqtp.tv_sec = (1000 * polltime) / 1000000000 ;
-    rqtp.tv_nsec = (1000 * polltime) % 1000000000 ;
-#endif
-#ifdef LINUX
-    rqtp.tv_sec = (1000 * polltime) / 1000000000 ;
-    rqtp.tv_nsec = (1000 * polltime) % 1000000000 ;
-#endif
 #ifdef _OSK
     if (polltime < 11000)
 	pollslp = 1 ;
@@ -1208,6 +1226,7 @@ int main (int argc, char *argv[], char **envp)
 	    uppoll++ ;
 	    lastsec = curtime ;
 	    check_clients () ;
+	    cs_stats_sample (stats_table, rings, clients, highclient) ;
 	    if (!serial)
             {
 		if ((path >= 0) && ! udplink)
@@ -1270,11 +1289,9 @@ int main (int argc, char *argv[], char **envp)
 		}
 	    oldackmask = noackmask ;
 	}
-#ifdef SOLARIS2
-	nanosleep (&rqtp, &rmtp) ;
-/* ADDED BY KIM	*/
-#elif defined LINUX
-	nanosleep (&rqtp, &rmtp) ;
+#if defined SOLARIS2 || defined LINUX
+	/* returns early when the DA sends something */
+	wait_input (polltime) ;
 #elif defined _OSK
 	tsleep (pollslp) ;
 #else
@@ -49,6 +49,7 @@
 // OF THE POSSIBILITY OF SUCH DAMAGE.
 //
 // 29 Sep 2020 DSN Updated for comserv3.
+// 19 Oct 2026 Per-thread entry buffers.
 // 
 
 #ifndef _LOGGER_H_
@@ -93,7 +94,9 @@ class Logger {
 
   private:
     void clearBuffer();
-    std::ostringstream logBuff;
+    std::ostringstream& buffer();
+    static void deleteBuffer(void *);
+    pthread_key_t buffKey;
     bool stdoutLogging;
     bool fileLogging;
     bool coutLogging;
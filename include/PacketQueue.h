@@ -4,29 +4,34 @@
 /*
  * 29 Sep 2020 DSN Updated for comserv3.
  * 03 Oct 2022 DSN Updated for runtime configuration of queueSize.
+ * 19 Oct 2026 Carry the packet reception time.
+ * 19 Oct 2026 Carry the packet trace stages (pkttrace.h).
  */
 
 #include <pthread.h>
+#include "pkttrace.h"
 
 class QueuedPacket {
  public:
-  QueuedPacket(char *, int, short);
+  QueuedPacket(char *, int, short, double = 0.);
   QueuedPacket();
   ~QueuedPacket();
 
-  void update(char *, int, short);
+  void update(char *, int, short, double = 0.);
   void clear();
 
   char data[512];
   int dataSize;
   short packetType;
+  double receptionTime;
+  pkt_trace trace;
 };
 
 class PacketQueue {
  public:
   PacketQueue(int n);
   ~PacketQueue();
-  void enqueuePacket(char *, int, short);
+  void enqueuePacket(char *, int, short, double = 0.);
   QueuedPacket dequeuePacket();
   int maxPackets();
   int numQueued();
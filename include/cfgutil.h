@@ -12,6 +12,7 @@ Edit History:
     3  3 Nov 97 WHO Larger line widths. Add c++ conditionals.
     4  9 Nov 99 IGD Porting to SuSE 6.1 LINUX begins
     5  29 Sep 2020 DSN Updated for comserv3.
+    6  19 Oct 2026     Compiled configuration file index, cfg_lookup.
 */
 
 #ifndef CFGUTIL_H
@@ -35,7 +36,15 @@ Edit History:
 #define STATIONS_INI_VARNAME	"STATIONS_INI"
 #define NETWORK_INI_VARNAME	"NETWORK_INI"
 
+/* Name of environment variable that controls configuration file indexes:
+   "off" to read the files directly, "nosave" to not save indexes. */
+#define CFG_INDEX_VARNAME	"COMSERV_CFG_INDEX"
+
 #define MAX_INDIRECTION 10
+
+/* Compiled index of a configuration file, see cfgindex.c */
+typedef struct cfg_index cfg_index;
+
 typedef struct
 {
     int cfg_init;
@@ -43,6 +52,8 @@ typedef struct
     FILE *cfgfile[MAX_INDIRECTION];
     int current_file;
     char *current_section;
+    cfg_index *index;		/* index of the file, NULL if reading the file */
+    int index_pos;		/* next line of the index */
 } config_struc;
 
 #ifdef __cplusplus
@@ -78,6 +89,16 @@ extern "C" {
     
     void comserv_split (pchar src, pchar right, char sep) ;
 
+/* Return the value of a directive in a section of a configuration file
+   in value, return TRUE if the file, section or directive is not found */
+    short cfg_lookup (pchar fname, pchar section, pchar name, pchar value) ;
+
+/* Configuration file indexes, used by open_cfg, skipto and read_cfg */
+    cfg_index *cfgidx_get (pchar fname) ;
+    void cfgidx_release (cfg_index *ci) ;
+    short cfgidx_skipto (config_struc *cs, pchar section) ;
+    void cfgidx_read (config_struc *cs, pchar s1, pchar s2) ;
+
 /* 
  * Initialize global pathnames used by comserv3.
  * Allow override by environmental variables.
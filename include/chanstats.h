@@ -0,0 +1,149 @@
+/* chanstats.h - server and per-channel statistics in the server shared memory segment */
+
+#ifndef CHANSTATS_H
+#define CHANSTATS_H
+
+/*
+ * 2026-10-19 Initial version.
+ * 2026-10-19 Version 2: added the server statistics.
+ *
+ * Each server keeps a table of statistics for every channel it queues
+ * in its comserv shared memory segment, after the ring buffers.  The
+ * offset of the table from the start of the segment is in the
+ * stats_offset field of tserver_struc.  A monitor such as csstat -S
+ * attaches the segment read-only and reads the table directly, without
+ * registering as a client or receiving any data.
+ *
+ * The server is the only writer.  Channels are appended and never
+ * removed, and nchan is only increased after the new entry is filled
+ * in.  Each entry has a sequence count that is odd while the entry is
+ * being updated, so a reader must use cs_stats_read() to get a
+ * consistent copy of an entry.
+ *
+ * All times are in seconds since 1970.  Gaps and overlaps are counted
+ * when a record does not start within half a sample of the end of the
+ * previous record of the channel.
+ *
+ * The server statistics are updated by the server for every packet it
+ * queues, and sampled from the rings and clients about once a second.
+ * They are protected by their own sequence count, and read with
+ * cs_stats_read_server().
+ */
+
+#include <stdint.h>
+
+#include "server.h"
+
+#define CS_STATS_MAGIC		0x43535453	/* "CSTS"			*/
+#define CS_STATS_VERSION	2
+#ifndef CS_STATS_MAXCHAN
+#define CS_STATS_MAXCHAN	1024		/* Channels in a server table	*/
+#endif
+
+/* Upper bounds in seconds of the histogram buckets.  The last bucket
+   holds everything larger. */
+#define CS_HIST_BOUNDS		{ 0.0001, 0.0005, 0.001, 0.005, 0.01, 0.05, 0.1, 0.5, 1.0 }
+#define CS_HIST_BUCKETS		10
+
+typedef struct {
+    uint64_t count;
+    double sum;			/* Seconds.					*/
+    uint32_t bucket[CS_HIST_BUCKETS];	/* Counts, not cumulative.		*/
+} cs_hist;			/* 56 bytes					*/
+
+typedef struct {
+    char name[32];		/* Client name, NUL terminated.			*/
+    int32_t pid;		/* Client process, NOCLIENT if none.		*/
+    int32_t blocking;		/* Server holds packets for the client.		*/
+    uint32_t lag_packets;	/* Packets the client has not acknowledged.	*/
+    uint32_t pad;
+    double lag_seconds;		/* Age of the oldest of those packets.		*/
+    double last_service;	/* Last service of a blocking client.		*/
+} cs_client_stats;		/* 64 bytes					*/
+
+typedef struct {
+    uint32_t seq;		/* Odd while the server is updating.		*/
+    uint32_t nclients;		/* Client entries in use.			*/
+    double sample_time;		/* When the rings and clients were sampled.	*/
+    uint64_t packets[NUMQ];	/* Packets queued in each ring.			*/
+    uint64_t bytes;		/* Bytes queued.				*/
+    uint32_t ring_count[NUMQ];	/* Elements in each ring.			*/
+    uint32_t ring_used[NUMQ];	/* Packets held in each ring.			*/
+    uint32_t ring_blocked[NUMQ];/* Elements held for blocking clients.		*/
+    uint32_t ring_full;		/* Packets that found their ring blocked.	*/
+    uint32_t queue_depth;	/* Packets waiting in the server's own queue.	*/
+    uint32_t queue_size;	/* Size of that queue, 0 if none.		*/
+    uint32_t throttle_events;	/* Times the data logger input was delayed.	*/
+    double throttle_seconds;	/* Total of those delays.			*/
+    int32_t link_up;		/* Data logger link running, -1 if unknown.	*/
+    int32_t link_buffer_fill;	/* Percent of data logger buffer in use, or -1.	*/
+    uint32_t link_retransmits;	/* Data packets received more than once.	*/
+    uint32_t link_stalls;	/* Times the data logger window filled.		*/
+    double link_rtt;		/* Smoothed round trip seconds, 0 if unknown.	*/
+    cs_hist queue_delay;	/* Reception to comserv ring, seconds.		*/
+    cs_hist callback_time;	/* Time spent in the data logger callback.	*/
+    cs_client_stats client[MAXCLIENTS];
+} cs_server_stats;
+
+typedef struct {
+    uint32_t seq;		/* Odd while the entry is being updated.	*/
+    int16_t qnum;		/* Comserv queue of the last record.		*/
+    int16_t reserved;
+    char net[4];		/* SEED codes, NUL terminated, without		*/
+    char station[12];		/* trailing blanks.				*/
+    char channel[4];
+    char location[4];
+    double sample_rate;		/* Samples per second, 0 if no samples yet.	*/
+    double first_reception;	/* Reception time of the first record.		*/
+    double last_reception;	/* Reception time of the last record.		*/
+    double last_start;		/* Start time of the last record with data.	*/
+    double last_end;		/* Time of the sample after that record.	*/
+    double record_interval;	/* Smoothed seconds between records.		*/
+    double gap_seconds;		/* Total length of gaps.			*/
+    double overlap_seconds;	/* Total length of overlaps.			*/
+    double last_gap;		/* Last gap (> 0) or overlap (< 0), seconds.	*/
+    double last_gap_time;	/* Data time at which it ended.			*/
+    uint64_t samples;		/* Samples received.				*/
+    uint32_t records;		/* Records received.				*/
+    uint32_t gaps;
+    uint32_t overlaps;
+    uint32_t pad;
+} cs_chan_stats;		/* 136 bytes					*/
+
+typedef struct {
+    uint32_t magic;		/* CS_STATS_MAGIC.				*/
+    uint32_t version;		/* CS_STATS_VERSION.				*/
+    uint32_t entry_size;	/* sizeof(cs_chan_stats).			*/
+    uint32_t maxchan;		/* Entries in the table.			*/
+    uint32_t nchan;		/* Entries in use.				*/
+    uint32_t dropped;		/* Records of channels that did not fit.	*/
+    double start_time;		/* When the table was created.			*/
+    cs_server_stats server;
+    cs_chan_stats chan[1];	/* maxchan entries.				*/
+} cs_stats_table;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/* Server. */
+int32_t cs_stats_size (int maxchan);
+void cs_stats_init (cs_stats_table *t, int maxchan);
+void cs_stats_update (cs_stats_table *t, const char *pkt, int len, short qnum,
+		      double reception_time);
+void cs_stats_packet (cs_stats_table *t, short qnum, int len, double reception_time,
+		      double now);
+void cs_stats_sample (cs_stats_table *t, tring *rings, tclients *clients, int nclients);
+cs_server_stats *cs_stats_server_begin (cs_stats_table *t);
+void cs_stats_server_end (cs_stats_table *t);
+void cs_hist_add (cs_hist *h, double seconds);
+
+/* Readers. */
+cs_stats_table *cs_stats_attach (int segkey, void **segment);
+void cs_stats_detach (void *segment);
+int  cs_stats_read (const cs_stats_table *t, int i, cs_chan_stats *copy);
+void cs_stats_read_server (const cs_stats_table *t, cs_server_stats *copy);
+#ifdef __cplusplus
+}
+#endif
+
+#endif
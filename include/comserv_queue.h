@@ -23,16 +23,38 @@
  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
  *
  * 29 Sep 2020 DSN Updated for comserv3.
+ * 19 Oct 2026 Added comserv_queue_rt with the packet reception time.
+ * 19 Oct 2026 Added comserv_reserve, comserv_commit and comserv_lock.
+ * 19 Oct 2026 Added comserv_stats_queue, _throttle, _callback and _link.
+ * 19 Oct 2026 Added comserv_trylock.
  */
 #ifndef COMSERV_QUEUE_H
 #define COMSERV_QUEUE_H
 
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
   int comserv_queue(char* buf,int len, int type);
+  int comserv_queue_rt(char* buf,int len, int type, double reception_time);
   int comserv_anyQueueBlocking();
+  /* Build a packet in place from another thread: on success the rings
+     stay locked until comserv_commit. */
+  char *comserv_reserve(int type, short *qnum);
+  void comserv_commit(short qnum, int len, double reception_time);
+  void comserv_lock(void);
+  /* Returns 1 with the rings locked, 0 if another thread holds them. */
+  int comserv_trylock(void);
+  void comserv_unlock(void);
+  /* Server statistics (chanstats.h).  up and buffer_fill are -1 if
+     unknown, rtt is in seconds. */
+  void comserv_stats_queue(int depth, int size);
+  void comserv_stats_throttle(double seconds);
+  void comserv_stats_callback(double seconds);
+  void comserv_stats_link(int up, int buffer_fill, double rtt,
+			  uint32_t retransmits, uint32_t stalls);
 #ifdef __cplusplus
 }
 #endif
@@ -3,6 +3,7 @@
 
 /*
  * 29 Sep 2020 DSN Updated for comserv3.
+ * 19 Oct 2026 Added stats_table.
  */
 
 #include <stdint.h>
@@ -11,6 +12,7 @@
 #include "cfgutil.h"
 #include "server.h"
 #include "service.h"
+#include "chanstats.h"
 
 #define MAXPROC 2 /* maximum number of service requests to process before checking serial port */
 //:: #define MAXWAIT 10 /* maximum number of seconds for clients to wait */
@@ -95,6 +97,7 @@ EXTERN config_struc cfg ;
 
 EXTERN tring rings[NUMQ] ;                /* Access structure for rings */
 EXTERN pserver_struc base ;
+EXTERN cs_stats_table *stats_table ;     /* Channel statistics in server segment */
 EXTERN tuser_privilege user_privilege ;
 EXTERN char str1[CFGWIDTH] ;
 EXTERN char str2[CFGWIDTH] ;
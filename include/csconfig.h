@@ -5,6 +5,7 @@
 
 /*
  * 29 Sep 2020 DSN Updated for comserv3.
+ * 19 Oct 2026 Added pkttrace.
  */
 
 #include <stdio.h>
@@ -53,6 +54,7 @@ typedef struct  {
     int32_t timbufs;
     int32_t msgbufs;
     int32_t blkbufs;
+    int32_t pkttrace;		/* Packets in the trace table, 0 for no tracing. */
     int32_t override;
     int32_t n_clients;
     cs_clients clients[MAXCLIENTS];
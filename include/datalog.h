@@ -5,6 +5,7 @@
 
 /*
  * 29 Sep 2020 DSN Updated for comserv3.
+ * 19 Oct 2026 Added span index to FINFO.
  */
 
 #define info stderr
@@ -39,6 +40,7 @@ typedef struct _finfo {
     EXT_TIME endtime;
     struct _finfo *next;
     int	    fd;
+    struct _span_index *spanx;	/* span index for data file, or NULL.	*/
 } FINFO;
 
 #endif
@@ -0,0 +1,47 @@
+/* logasync.h - asynchronous writer for LogMessage() */
+
+#ifndef LOGASYNC_H
+#define LOGASYNC_H
+
+/*
+ * 2026-10-19 Initial version.
+ *
+ * After LogInit(), a multi-threaded program may call LogAsyncStart() so
+ * that LogMessage() (and g_log) only formats the line and copies it to a
+ * lock-free ring owned by the calling thread.  A background writer
+ * thread drains all rings and writes the lines in batches with one
+ * flush per batch.  If a thread's ring is full the line is dropped and
+ * counted, and the writer logs the number of dropped lines.
+ * LogAsyncStop() (also called at exit) drains the rings and returns to
+ * synchronous logging; threads still logging then write their lines
+ * synchronously.  Programs using it must link with -lpthread.
+ */
+
+#ifndef LOG_RING_SIZE
+#define LOG_RING_SIZE		(256*1024)	/* Per-thread ring bytes (power of 2) */
+#endif
+#ifndef LOG_ASYNC_IDLE_USEC
+#define LOG_ASYNC_IDLE_USEC	20000		/* Writer sleep when idle */
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+int  LogAsyncStart (void);
+void LogAsyncStop (void);
+
+/* Internal interface between logging.c and logasync.c.  log_async_put */
+/* returns 0 if the line was queued, -1 if it was dropped, or		  */
+/* LOG_ASYNC_STOPPED if the writer is stopped and the caller must write	  */
+/* the line itself.							  */
+#define LOG_ASYNC_STOPPED	1
+extern int (*log_async_put)(const char *line, int len);
+int  log_emit_line (const char *line, int len);
+void log_flush (void);
+void log_lock (void);
+void log_unlock (void);
+#ifdef __cplusplus
+}
+#endif
+
+#endif
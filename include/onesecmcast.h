@@ -0,0 +1,111 @@
+/* onesecmcast.h - coalesced one second multicast packets */
+
+#ifndef ONESECMCAST_H
+#define ONESECMCAST_H
+
+/*
+ * 2026-10-19 Initial version.
+ *
+ * q330serv and q8serv multicast one second (and low latency) data
+ * either as one onesec_pkt datagram per channel, or in the coalesced
+ * format below, which packs the channels of a station into as few
+ * datagrams of up to OSM_MAX_PAYLOAD bytes as possible.  All values
+ * are in network byte order.
+ *
+ *	osm_hdr			once per datagram
+ *	osm_chan_hdr		once per channel, followed by
+ *	int32_t samples[nsamples]
+ *
+ * A channel is never split, so a datagram holding one high rate channel
+ * may be larger than OSM_MAX_PAYLOAD.  The sender numbers its datagrams
+ * so that a receiver can detect lost datagrams.  Receivers should
+ * ignore datagrams with a version they do not know.
+ *
+ * osm_decode() accepts both coalesced and original onesec_pkt datagrams.
+ */
+
+#include <stdint.h>
+#include <pthread.h>
+#include <netinet/in.h>
+
+#define OSM_MAGIC		"OSMC"
+#define OSM_VERSION		1
+#ifndef OSM_MAX_PAYLOAD
+#define OSM_MAX_PAYLOAD		1472	/* Ethernet MTU less IP and UDP headers */
+#endif
+#define OSM_MAX_SAMPLES		1000	/* Largest onesec sample count */
+#define OSM_ONESEC_HDR_LEN	52	/* Header of original onesec_pkt */
+
+typedef struct {
+    char magic[4];		/* OSM_MAGIC, not NUL terminated.		*/
+    uint8_t version;		/* OSM_VERSION.					*/
+    uint8_t flags;		/* Reserved, zero.				*/
+    uint16_t nchannels;		/* Number of channels that follow.		*/
+    uint32_t sequence;		/* Datagram number from this sender.		*/
+    char net[4];		/* Network code, NUL terminated.		*/
+    char station[16];		/* Station code, NUL terminated.		*/
+} osm_hdr;			/* 32 bytes					*/
+
+typedef struct {
+    char channel[4];		/* 3 characters, blank padded, NUL terminated.	*/
+    char location[4];		/* 2 characters, blank padded, NUL terminated.	*/
+    int32_t rate;		/* Sample rate as in onesec_pkt.		*/
+    uint32_t timestamp_sec;	/* Q330 epoch seconds as in onesec_pkt.		*/
+    uint32_t timestamp_usec;
+    uint16_t nsamples;
+    uint16_t reserved;		/* Zero.					*/
+} osm_chan_hdr;			/* 24 bytes					*/
+
+/* One channel of a received datagram, in host byte order. */
+typedef struct {
+    char net[4];
+    char station[16];
+    char channel[4];
+    char location[4];
+    int32_t rate;
+    uint32_t timestamp_sec;
+    uint32_t timestamp_usec;
+    int nsamples;
+    int32_t *samples;		/* Points into the caller's sample buffer.	*/
+} osm_channel;
+
+/* Sender state.  A sender may be used by several threads. */
+typedef struct {
+    int fd;			/* UDP socket, owned by the caller.		*/
+    struct sockaddr_in addr;	/* Destination.					*/
+    int coalesce;		/* Use the coalesced format.			*/
+    pthread_mutex_t lock;
+    uint32_t sequence;
+    int len;			/* Bytes in buf, 0 if nothing pending.		*/
+    double first_time;		/* When the pending datagram was started.	*/
+    uint32_t datagrams;		/* Statistics.					*/
+    uint32_t channels;
+    uint32_t errors;
+    char buf[OSM_MAX_PAYLOAD + sizeof(osm_chan_hdr) + OSM_MAX_SAMPLES * sizeof(int32_t)];
+} osm_sender;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/* Sending. */
+void osm_sender_init (osm_sender *s, int fd, struct sockaddr_in *addr, int coalesce);
+int  osm_send (osm_sender *s, const char *net, const char *station,
+	       const char *channel, const char *location, int rate,
+	       uint32_t timestamp_sec, uint32_t timestamp_usec,
+	       const int32_t *samples, int nsamples);
+int  osm_flush (osm_sender *s, double max_age);
+void osm_sender_destroy (osm_sender *s);
+
+/* Receiving. */
+int  osm_open (const char *ifaddr, const char *group, int port);
+int  osm_decode (const char *buf, int len, int32_t *samples, int maxsamples,
+		 int (*callback)(osm_channel *chan, void *arg), void *arg,
+		 uint32_t *sequence);
+
+/* Copy n 32 bit values converting between host and network byte order. */
+void osm_swap32 (int32_t *dst, const int32_t *src, int n);
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,97 @@
+/* pkttrace.h - optional tracing of packets through a server */
+
+#ifndef PKTTRACE_H
+#define PKTTRACE_H
+
+/*
+ * 2026-10-19 Initial version.
+ *
+ * A server started with PKTTRACE=n in its station.ini section keeps a
+ * table of the last n packets it queued in its comserv shared memory
+ * segment, after the channel statistics table.  The offset of the table
+ * is in the trace_offset field of tserver_struc, and is 0 if tracing is
+ * off.  For each packet the table holds the time at which it passed each
+ * of the stages below, so that a monitor such as cstrace can find where
+ * the time between the data logger and the clients is spent.
+ *
+ * The stages of a packet are marked by the thread that handles it.
+ * pkttrace_start() begins a new data logger packet, pkttrace_mark()
+ * records a stage of the current packet of the calling thread, and
+ * pkttrace_commit() writes the current stages into the entry of the
+ * comserv packet number.  A packet that is passed to another thread in
+ * the PacketQueue carries its stages with it (pkttrace_take() and
+ * pkttrace_set()).  PT_DELIVER is set the first time a client receives
+ * the packet.
+ *
+ * Times are CLOCK_MONOTONIC nanoseconds, 0 if the packet did not pass
+ * the stage.  Every function returns at once if tracing is off.
+ */
+
+#include <stdint.h>
+
+#define PKTTRACE_MAGIC		0x43535452	/* "CSTR"			*/
+#define PKTTRACE_VERSION	1
+#define PKTTRACE_MAXENTRIES	1048576
+
+#define PT_RECEIVE	0	/* Data logger packet received.			*/
+#define PT_DECOMPRESS	1	/* Data blockette decompressed.			*/
+#define PT_FINISH	2	/* MiniSEED record finished.			*/
+#define PT_CALLBACK	3	/* Record passed to the server.			*/
+#define PT_ENQUEUE	4	/* Put in the PacketQueue.			*/
+#define PT_DEQUEUE	5	/* Taken from the PacketQueue.			*/
+#define PT_QUEUE	6	/* Committed to its comserv ring.		*/
+#define PT_DELIVER	7	/* First copied to a client.			*/
+#define PT_NSTAGES	8
+#define PT_RECORD	PT_FINISH	/* First stage of a record rather than	*/
+					/* of a data logger packet.		*/
+
+#define PT_STAGE_NAMES	{ "receive", "decompress", "finish", "callback", \
+			  "enqueue", "dequeue", "queue", "deliver" }
+
+typedef struct {
+    int64_t t[PT_NSTAGES];
+} pkt_trace;
+
+typedef struct {
+    uint32_t seq;		/* Odd while the entry is being updated.	*/
+    int16_t qnum;		/* Comserv ring of the packet.			*/
+    int16_t reserved;
+    int32_t packet_num;		/* Comserv packet number, -1 if unused.		*/
+    int32_t pad;
+    pkt_trace trace;
+} pkt_trace_entry;		/* 80 bytes					*/
+
+typedef struct {
+    uint32_t magic;		/* PKTTRACE_MAGIC.				*/
+    uint32_t version;		/* PKTTRACE_VERSION.				*/
+    uint32_t entry_size;	/* sizeof(pkt_trace_entry).			*/
+    uint32_t nentries;		/* Entries in the table.			*/
+    uint64_t committed;		/* Packets traced.				*/
+    double start_time;		/* When the table was created.			*/
+    pkt_trace_entry entry[1];	/* Entry of packet n is n % nentries.		*/
+} pkt_trace_table;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/* Server. */
+extern pkt_trace_table *pkttrace_table;	/* NULL if tracing is off.		*/
+int32_t pkttrace_size (int nentries);
+void pkttrace_init (pkt_trace_table *t, int nentries);
+void pkttrace_start (void);
+void pkttrace_mark (int stage);
+void pkttrace_take (pkt_trace *copy);
+void pkttrace_set (const pkt_trace *trace);
+void pkttrace_clear (void);
+void pkttrace_commit (int32_t packet_num, short qnum);
+void pkttrace_deliver (int32_t packet_num);
+void pkttrace_hook (int stage);
+
+/* Readers. */
+pkt_trace_table *pkttrace_attach (int segkey, void **segment);
+int  pkttrace_read (const pkt_trace_table *t, int i, pkt_trace_entry *copy);
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -14,6 +14,7 @@ Edit History:
                     valid bytes to a client.
     5 29 Sep 2020 DSN Updated for comserv3.
     6 20 Dec 2020 DSN Make all uid and pid int32_t (signed) to allow for NOCLIENT (-1).
+    7 19 Oct 2026     Add SBUFSIZE for the DA input buffer.
 */
 
 #ifndef SERVER_H
@@ -26,6 +27,7 @@ Edit History:
 #include "service.h"
 
 #define BLOB 4096
+#define SBUFSIZE 65536 /* DA input buffer, read in one call */
 #define CRC_POLYNOMIAL 1443300200
 #define VERBOSE FALSE
 
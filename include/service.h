@@ -25,6 +25,15 @@ Edit History:
    10  3 Nov 97 WHO More stations for Unix version, add c++ cond.
    11 24 Aug 07 DSN Added cs_sig_alrm function.
    12 29 Sep 2020 DSN Updated for comserv3.
+   13 19 Oct 2026     Added cs_gen_parallel, cs_svc_start and cs_svc_finish.
+   14 19 Oct 2026     Added cs_wait.
+   15 19 Oct 2026     Added stats_offset to tserver_struc for the channel
+                    statistics table (chanstats.h).
+   16 19 Oct 2026     Added trace_offset to tserver_struc for the packet
+                    trace table (pkttrace.h).
+   17 19 Oct 2026     Added cs_signal_data. CS_WAIT_MAX_USEC is 1 second.
+   18 19 Oct 2026     Added data_waiters to tserver_struc, so cs_signal_data
+                    only wakes when a client is blocked in cs_wait.
 */
 /* NOTE : SEED data structure definitions (seedstrc.h) are not required
    to be used for gaining access to the server. This allows a client
@@ -89,6 +98,16 @@ Edit History:
 #endif
 #endif
 
+/* Shortest and longest intervals (usec) between checks of the servers in */
+/* cs_wait while it is not woken by a server. The interval starts short   */
+/* and doubles while no data arrives.                                     */
+#ifndef CS_WAIT_MIN_USEC
+#define CS_WAIT_MIN_USEC	2000
+#endif
+#ifndef CS_WAIT_MAX_USEC
+#define CS_WAIT_MAX_USEC	1000000
+#endif
+
 /* Following are used as the command for the cs_svc call */
 /* Local server commands (does not communicate with DA), returns immediately */
 #define CSCM_ATTACH 0           /* Attach me to server if not already attached */
@@ -206,6 +225,9 @@ typedef struct
     int32_t next_data ;        /* Next data packet number */
     double servcode ;          /* Unique server invocation code */
     tsvc svcreqs[MAXCLIENTS] ; /* Service queue */
+    int32_t stats_offset ;     /* Offset of channel statistics table, 0 if none */
+    int32_t trace_offset ;     /* Offset of packet trace table, 0 if none */
+    int32_t data_waiters ;     /* Clients blocked in cs_wait on next_data */
 } tserver_struc ;
 
 typedef tserver_struc *pserver_struc ;
@@ -364,6 +386,22 @@ void cs_remove (pstations_struc stations, short num) ;
 */
 pclient_struc cs_gen (pstations_struc stations) ;
 
+/*
+  Same as cs_gen, but cs_scan will have a data request outstanding to every
+  station at the same time rather than servicing stations one at a time, so
+  a slow or stalled server does not delay the other stations. Each station
+  uses its own private shared memory segment in addition to the one returned,
+  so this costs one segment and set of data buffers per station. Only one
+  parallel client may exist per process. Use with cs_scan, cs_svc, cs_detach
+  and cs_off. Falls back to cs_gen for a single station.
+  The clients that read data from a list of stations with cs_scan use it.
+  Clients that only send commands with cs_svc (netmon, config, dpda), that
+  serve one station per process (datalog, sl2mcast, msgmon), or that are
+  Quanterra examples (dataread) keep cs_gen, since they would gain nothing
+  for the extra segments.
+*/
+pclient_struc cs_gen_parallel (pstations_struc stations) ;
+
 /*
   This function detaches a client from the server shared memory segment.
 */
@@ -383,6 +421,17 @@ void cs_off (pclient_struc client) ;
 */
 short cs_svc (pclient_struc client, short station_number) ;
 
+/*
+  cs_svc split in two for callers that want to have more than one request
+  outstanding. cs_svc_start queues the request and signals the server,
+  returning CSCR_GOOD and the service slot and suggested poll interval (usec)
+  if the request was queued, else an error code. When client->done is set,
+  or the caller gives up waiting, cs_svc_finish returns the result.
+*/
+short cs_svc_start (pclient_struc client, short station_number, short *slot,
+      int32_t *sleeptime) ;
+short cs_svc_finish (pclient_struc client, short station_number, short slot) ;
+
 /* This is a polling routine used by cs_scan. The current time is the third
    parameter. It will check the station to see :
      1) If it does not have good status, then every 10 seconds it tries :
@@ -411,6 +460,27 @@ byte cs_check (pclient_struc client, short station_number, double now) ;
 */     
 short cs_scan (pclient_struc client, boolean *alert) ;
 
+/*
+  Call instead of sleeping when cs_scan returns NOCLIENT. Returns as soon as
+  any station of the client has new data or a changed server, or after
+  maxusec microseconds. On Linux it blocks with futex_waitv on the
+  next_data of every linked station at once, which the servers wake with
+  cs_signal_data, so the client is woken as soon as any of its servers
+  queues a packet. Server changes and parallel scan results are not
+  signalled, and are checked every CS_WAIT_MIN_USEC at first, backing off
+  to every CS_WAIT_MAX_USEC while nothing happens.
+  On kernels without futex_waitv (before 5.16), or for clients of more
+  than FUTEX_WAITV_MAX (128) stations, it blocks on one station at a
+  time in turn, so data of the other stations can wait for up to the
+  current backoff interval. Elsewhere it only polls. Returns TRUE if
+  cs_scan has work to do.
+*/
+boolean cs_wait (pclient_struc client, int32_t maxusec) ;
+
+/* Called by a server after it advances next_data to wake its clients
+   blocked in cs_wait. Costs no system call while none is blocked. */
+void cs_signal_data (pserver_struc srvr) ;
+
 /* try to link to server's shared memory segment. first copies server reference
    code into client's structure */
 void cs_link (pclient_struc client, short station_number, boolean first) ;
@@ -0,0 +1,63 @@
+/* SNCL remapping for MiniSEED records. */
+
+#ifndef SNCL_REMAP_H
+#define SNCL_REMAP_H
+
+/*
+ * 2026-10-19 Initial version.
+ *
+ * A remap table is a list of rules.  Each rule maps an input SNCL pattern
+ * to an output SNCL template, both written as STA.NET.CHAN.LOC.
+ *   - Input fields are shell glob patterns (fnmatch), eg "BK.*.HH?.00".
+ *   - Output fields are literal values, "*" to keep the input field,
+ *     or templates where each '?' copies the input character at that
+ *     position (eg "HN?" maps "HHZ" to "HNZ").
+ *   - "--" is used for a blank location code in patterns and templates.
+ * The first rule that matches a SNCL is used.
+ *
+ * Rules are evaluated once per distinct SNCL.  The result is cached in a
+ * hash table keyed by the packed 12 byte SNCL exactly as it appears in
+ * the MiniSEED fixed header (station[5], location[2], channel[3],
+ * network[2] starting at byte 8), so steady-state remapping of a record
+ * is a hash lookup and a 12 byte copy with no header decoding.
+ */
+
+#define SNCL_KEY_LEN		12	/* Packed SNCL length.			*/
+#define SNCL_KEY_OFFSET		8	/* Offset of packed SNCL in MiniSEED hdr*/
+
+typedef struct _sncl_remap SNCL_REMAP;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Create an empty remap table.  Returns NULL on allocation error.	*/
+SNCL_REMAP *sncl_remap_new (void);
+
+/* Free a remap table and all of its rules and cached results.		*/
+void sncl_remap_free (SNCL_REMAP *remap);
+
+/* Append a rule to the table.  Returns 0 on success, -1 on error.	*/
+int sncl_remap_add (SNCL_REMAP *remap, const char *in_sncl, const char *out_sncl);
+
+/* Append rules from a file with one "in_sncl out_sncl" rule per line.	*/
+/* Blank lines and lines starting with '#' are ignored.			*/
+/* Returns the number of rules read, or -1 on error.			*/
+int sncl_remap_load (SNCL_REMAP *remap, const char *filename);
+
+/* Return the number of rules in the table.				*/
+int sncl_remap_nrules (SNCL_REMAP *remap);
+
+/* Remap a packed 12 byte SNCL in place.				*/
+/* Returns 1 if the SNCL was changed, 0 if not, -1 on error.		*/
+int sncl_remap_key (SNCL_REMAP *remap, char *key);
+
+/* Remap the SNCL in the fixed header of a MiniSEED record in place.	*/
+/* Returns 1 if the SNCL was changed, 0 if not, -1 on error.		*/
+int sncl_remap_record (SNCL_REMAP *remap, char *record);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
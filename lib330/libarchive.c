@@ -35,6 +35,10 @@ Edit History:
                      last data record. If not set by continuity it's OK to start over since
                      SEED sequence numbers are informational only.
     5 2009-06-25 rdr Increment blockette count when appending timing blockettes.
+    6 2026-10-19     Assemble archival records on worker threads, see ARC_POOL.
+                     Data records with only a header frame are not flushed.
+    7 2026-10-19     Workers update the archive status under stat_mutex, add
+                     archive_lock and archive_unlock for status readers.
 */
 #ifndef OMIT_SEED
 #ifndef libarchive_h
@@ -77,6 +81,84 @@ Edit History:
 #include "libsample.h"
 #endif
 
+#ifdef ARC_POOL
+/*
+  Archival records are assembled by a small pool of worker threads so that
+  merging 512 byte records doesn't hold up the library thread. Each LCQ is
+  always handled by the same worker, so records and flushes for one channel
+  are processed in the order they were queued. Each worker has a single
+  producer, single consumer ring of jobs; the library thread only waits if
+  a ring is full or when it needs the archive state to be current.
+*/
+enum tarcjob_kind {ARJ_RECORD, ARJ_FLUSH} ;
+
+typedef struct {
+  enum tarcjob_kind kind ;
+  plcq q ;
+  integer blockette_index ; /* next free opaque blockette location when queued */
+  tcompressed_buffer_ring ring ; /* copy of header and record */
+} tarcjob ;
+
+typedef struct {
+  pthread_t threadid ;
+  pthread_mutex_t mutex ; /* only used for sleeping and waking */
+  pthread_cond_t cond ;
+  longword head ; /* next job to fill, written by library thread */
+  longword tail ; /* next job to process, written by worker */
+  boolean idle ; /* worker is waiting for a job */
+  boolean waiting ; /* library thread is waiting for worker */
+  boolean terminate ;
+  paqstruc paqs ;
+  tminiseed_call miniseed_call ; /* this worker's callback buffer */
+  tarcjob jobs[ARC_QUEUE_SIZE] ;
+} tarcworker ;
+
+typedef struct {
+  integer count ;
+  pthread_mutex_t callback_mutex ; /* one call_aminidata at a time */
+  pthread_mutex_t stat_mutex ; /* archive status counters of all LCQs */
+  tarcworker *workers[ARC_MAX_WORKERS] ;
+} tarcpool ;
+#endif
+
+/* Status counters that lib_lcqstat reads are updated by the workers under
+   stat_mutex. Without workers the library thread updates them directly */
+static void stat_lock (paqstruc paqs)
+begin
+#ifdef ARC_POOL
+  tarcpool *pool ;
+
+  pool = paqs->arcpool ;
+  if (pool)
+    then
+      pthread_mutex_lock (addr(pool->stat_mutex)) ;
+#endif
+end
+
+static void stat_unlock (paqstruc paqs)
+begin
+#ifdef ARC_POOL
+  tarcpool *pool ;
+
+  pool = paqs->arcpool ;
+  if (pool)
+    then
+      pthread_mutex_unlock (addr(pool->stat_mutex)) ;
+#endif
+end
+
+/* Return the next archive sequence number for a new record */
+static longint next_sequence (paqstruc paqs, tarc *parc)
+begin
+  longint seq ;
+
+  stat_lock (paqs) ;
+  inc(parc->records_written) ;
+  seq = parc->records_written ;
+  stat_unlock (paqs) ;
+  return seq ;
+end
+
 static void clear_archive (tarc *parc, integer size)
 begin
 
@@ -87,7 +169,30 @@ begin
   memset(addr(parc->hdr_buf), 0, sizeof(seed_header)) ;
 end
 
-void flush_archive (paqstruc paqs, plcq q)
+/* Clients expect archival callbacks one at a time */
+static void arc_callback (paqstruc paqs, tminiseed_call *pmini)
+begin
+  pq330 q330 ;
+#ifdef ARC_POOL
+  tarcpool *pool ;
+#endif
+
+  q330 = paqs->owner ;
+#ifdef ARC_POOL
+  pool = paqs->arcpool ;
+  if (pool)
+    then
+      begin
+        pthread_mutex_lock (addr(pool->callback_mutex)) ;
+        q330->par_create.call_aminidata (pmini) ;
+        pthread_mutex_unlock (addr(pool->callback_mutex)) ;
+        return ;
+      end
+#endif
+  q330->par_create.call_aminidata (pmini) ;
+end
+
+static void arc_flush (paqstruc paqs, plcq q, tminiseed_call *pmini)
 begin
 #define JAN_1_2006 189388800 /* first possible valid data */
 #define MAX_DATE 0x7FFF0000 /* above this just has to be nonsense */
@@ -98,14 +203,15 @@ begin
   q330 = paqs->owner ;
   parc = addr(q->arc) ;
   p = (pointer)parc->pcfr ; /* start of record */
-  q330->miniseed_call.timestamp = parc->hdr_buf.starting_time.seed_fpt ;
-  if ((q330->miniseed_call.timestamp < JAN_1_2006) lor (q330->miniseed_call.timestamp > MAX_DATE))
+  pmini->timestamp = parc->hdr_buf.starting_time.seed_fpt ;
+  if ((pmini->timestamp < JAN_1_2006) lor (pmini->timestamp > MAX_DATE))
     then
       begin
         clear_archive (parc, paqs->arc_size) ;
         return ; /* impossible time */
       end
   if (((q->pack_class == PKC_MESSAGE) land (parc->hdr_buf.samples_in_record == 0)) lor
+      ((q->pack_class == PKC_DATA) land (parc->total_frames <= 1)) lor
       ((q->pack_class != PKC_MESSAGE) land (parc->total_frames == 0)))
     then
       begin
@@ -113,16 +219,17 @@ begin
         return ; /* nothing to write */
       end
   storeseedhdr (addr(p), addr(parc->hdr_buf), q->pack_class == PKC_DATA) ; /* make sure is current */
-  q330->miniseed_call.context = q330 ;
-  memcpy(addr(q330->miniseed_call.station_name), addr(q330->station_ident), sizeof(string9)) ;
-  strcpy((pointer)addr(q330->miniseed_call.location), (pointer)addr(q->slocation)) ;
-  strcpy((pointer)addr(q330->miniseed_call.channel), (pointer)addr(q->sseedname)) ;
-  q330->miniseed_call.chan_number = q->lcq_num ;
-  q330->miniseed_call.rate = q->rate ;
-  q330->miniseed_call.cl_session = 0 ;
-  q330->miniseed_call.cl_offset = 0 ;
-  q330->miniseed_call.filter_bits = parc->amini_filter ;
-  q330->miniseed_call.packet_class = q->pack_class ;
+  pmini->context = q330 ;
+  memcpy(addr(pmini->station_name), addr(q330->station_ident), sizeof(string9)) ;
+  strcpy((pointer)addr(pmini->location), (pointer)addr(q->slocation)) ;
+  strcpy((pointer)addr(pmini->channel), (pointer)addr(q->sseedname)) ;
+  pmini->chan_number = q->lcq_num ;
+  pmini->rate = q->rate ;
+  pmini->cl_session = 0 ;
+  pmini->cl_offset = 0 ;
+  pmini->filter_bits = parc->amini_filter ;
+  pmini->packet_class = q->pack_class ;
+  stat_lock (paqs) ;
   if (parc->existing_record)
     then
       if (parc->appended)
@@ -131,12 +238,13 @@ begin
             inc(parc->records_overwritten_session) ;
             if (parc->leave_in_buffer)
               then
-                q330->miniseed_call.miniseed_action = MSA_INC ; /* middle of increments */
+                pmini->miniseed_action = MSA_INC ; /* middle of increments */
               else
-                q330->miniseed_call.miniseed_action = MSA_FINAL ; /* last increment */
+                pmini->miniseed_action = MSA_FINAL ; /* last increment */
           end
         else
           begin /* client is up to date, leave alone */
+            stat_unlock (paqs) ;
             parc->leave_in_buffer = FALSE ;
             clear_archive (parc, paqs->arc_size) ;
             return ;
@@ -146,16 +254,17 @@ begin
         inc(parc->records_written_session) ;
         if (parc->leave_in_buffer)
           then
-            q330->miniseed_call.miniseed_action = MSA_FIRST ; /* incremental new record */
+            pmini->miniseed_action = MSA_FIRST ; /* incremental new record */
           else
-            q330->miniseed_call.miniseed_action = MSA_ARC ; /* non-incremental new record */
+            pmini->miniseed_action = MSA_ARC ; /* non-incremental new record */
       end
   parc->last_updated = secsince () ;
-  q330->miniseed_call.data_size = paqs->arc_size ;
-  q330->miniseed_call.data_address = parc->pcfr ;
+  stat_unlock (paqs) ;
+  pmini->data_size = paqs->arc_size ;
+  pmini->data_address = parc->pcfr ;
   if (q330->par_create.call_aminidata)
     then
-      q330->par_create.call_aminidata (addr(q330->miniseed_call)) ;
+      arc_callback (paqs, pmini) ;
   if (parc->leave_in_buffer)
     then
       parc->existing_record = TRUE ; /* has been sent to client once */
@@ -165,7 +274,8 @@ begin
   parc->appended = FALSE ; /* client is up to date */
 end
 
-void archive_512_record (paqstruc paqs, plcq q, pcompressed_buffer_ring pbuf)
+static void arc_assemble (paqstruc paqs, plcq q, pcompressed_buffer_ring pbuf,
+                          tminiseed_call *pmini, integer blockette_index)
 begin
   pq330 q330 ;
   double drate, tdiff ;
@@ -196,7 +306,7 @@ begin
                     (parc->hdr_buf.starting_time.seed_fpt + parc->hdr_buf.samples_in_record / drate) ;
             if (((bcnt + fcnt + parc->total_frames) > paqs->arc_frames) lor (fabs(tdiff) > q->gap_secs))
               then /* won't fit or time gap */
-                flush_archive (paqs, q) ;
+                arc_flush (paqs, q, pmini) ;
           end
       psrc = (pointer)((pntrint)addr(pbuf->rec) + FRAME_SIZE) ;
       if (parc->total_frames > 1)
@@ -264,20 +374,19 @@ begin
             memcpy (pdest, psrc, 4) ; /* update last sample value */
             if (parc->total_frames >= paqs->arc_frames)
               then
-                flush_archive (paqs, q) ; /* totally full dude */
+                arc_flush (paqs, q, pmini) ; /* totally full dude */
             else if (parc->incremental)
               then
                 begin
                   parc->leave_in_buffer = TRUE ;
-                  flush_archive (paqs, q) ; /* write update to record, don't clear */
+                  arc_flush (paqs, q, pmini) ; /* write update to record, don't clear */
                 end
           end
         else
           begin /* new record */
             memcpy(addr(parc->hdr_buf), addr(pbuf->hdr_buf), sizeof(seed_header)) ; /* copy header */
             parc->hdr_buf.dob.rec_length = q330->par_create.amini_exponent ;
-            parc->hdr_buf.sequence.seed_num = parc->records_written + 1 ;
-            inc(parc->records_written) ;
+            parc->hdr_buf.sequence.seed_num = next_sequence (paqs, parc) ;
             psrc = (pointer)((pntrint)addr(pbuf->rec) + FRAME_SIZE) ;
             pdest = (pointer)((pntrint)parc->pcfr + FRAME_SIZE) ;
             if ((bcnt + fcnt) > 0)
@@ -290,7 +399,7 @@ begin
               then
                 begin
                   parc->leave_in_buffer = TRUE ;
-                  flush_archive (paqs, q) ; /* write new record, but don't clear */
+                  arc_flush (paqs, q, pmini) ; /* write new record, but don't clear */
                 end
           end
       break ;
@@ -301,7 +410,7 @@ begin
       if (((pbuf->hdr_buf.samples_in_record + parc->hdr_buf.samples_in_record) > (paqs->arc_size - NONDATA_OVERHEAD)) lor
            (pbuf->hdr_buf.starting_time.seed_fpt > (parc->hdr_buf.starting_time.seed_fpt + 60)))
         then /* won't fit or not the same time */
-          flush_archive (paqs, q) ;
+          arc_flush (paqs, q, pmini) ;
       psrc = (pointer)((pntrint)addr(pbuf->rec) + NONDATA_OVERHEAD) ;
       pdest = (pointer)((pntrint)parc->pcfr + NONDATA_OVERHEAD + parc->hdr_buf.samples_in_record) ;
       if (parc->hdr_buf.samples_in_record == 0)
@@ -310,8 +419,7 @@ begin
             memcpy(addr(parc->hdr_buf), addr(pbuf->hdr_buf), sizeof(seed_header)) ; /* copy header */
             parc->hdr_buf.dob.rec_length = q330->par_create.amini_exponent ;
             parc->hdr_buf.samples_in_record = 0 ; /* don't count first record twice! */
-            parc->hdr_buf.sequence.seed_num = parc->records_written + 1 ;
-            inc(parc->records_written) ;
+            parc->hdr_buf.sequence.seed_num = next_sequence (paqs, parc) ;
             parc->appended = FALSE ;
             parc->existing_record = FALSE ;
           end
@@ -322,14 +430,14 @@ begin
     case PKC_TIMING : /* Note: incoming will only have one blockette */
       if ((TIMING_BLOCKETTE_SIZE + parc->total_frames) > paqs->arc_size)
         then
-          flush_archive (paqs, q) ; /* new one won't fit */
+          arc_flush (paqs, q, pmini) ; /* new one won't fit */
       if (parc->total_frames > 0)
         then
           begin
             if ((lib_round(pbuf->hdr_buf.starting_time.seed_fpt) div 3600) !=
                 (lib_round(parc->hdr_buf.starting_time.seed_fpt) div 3600))
               then
-                flush_archive (paqs, q) ; /* different hour, start new record */
+                arc_flush (paqs, q, pmini) ; /* different hour, start new record */
           end
       psrc = (pointer)((pntrint)addr(pbuf->rec) + NONDATA_OVERHEAD) ;
       if (parc->total_frames > 0)
@@ -347,8 +455,7 @@ begin
           begin /* new record */
             memcpy(addr(parc->hdr_buf), addr(pbuf->hdr_buf), sizeof(seed_header)) ; /* copy header */
             parc->hdr_buf.dob.rec_length = q330->par_create.amini_exponent ;
-            parc->hdr_buf.sequence.seed_num = parc->records_written + 1 ;
-            inc(parc->records_written) ;
+            parc->hdr_buf.sequence.seed_num = next_sequence (paqs, parc) ;
             pdest = (pointer)((pntrint)parc->pcfr + NONDATA_OVERHEAD) ;
             memcpy (pdest, psrc, TIMING_BLOCKETTE_SIZE) ;
             parc->total_frames = NONDATA_OVERHEAD + TIMING_BLOCKETTE_SIZE ;
@@ -361,17 +468,17 @@ begin
       if (bcnt == 0)
         then
           return ; /* nothing to do */
-      size = q->com->blockette_index - NONDATA_OVERHEAD ; /* always a multiple of 4 bytes */
+      size = blockette_index - NONDATA_OVERHEAD ; /* always a multiple of 4 bytes */
       if (((size + parc->total_frames) > paqs->arc_size) lor (q->lcq_opt and LO_CNPP))
         then
-          flush_archive (paqs, q) ; /* new one won't fit or must preserve time */
+          arc_flush (paqs, q, pmini) ; /* new one won't fit or must preserve time */
       if (parc->total_frames > 0)
         then
           begin
             if ((lib_round(pbuf->hdr_buf.starting_time.seed_fpt) div 3600) !=
                 (lib_round(parc->hdr_buf.starting_time.seed_fpt) div 3600))
               then
-                flush_archive (paqs, q) ; /* different hour, start new record */
+                arc_flush (paqs, q, pmini) ; /* different hour, start new record */
           end
       psrc = (pointer)((pntrint)addr(pbuf->rec) + NONDATA_OVERHEAD) ;
       if (parc->total_frames == 0)
@@ -379,11 +486,10 @@ begin
           begin /* new record */
             memcpy(addr(parc->hdr_buf), addr(pbuf->hdr_buf), sizeof(seed_header)) ; /* copy header */
             parc->hdr_buf.dob.rec_length = q330->par_create.amini_exponent ;
-            parc->hdr_buf.sequence.seed_num = parc->records_written + 1 ;
-            inc(parc->records_written) ;
+            parc->hdr_buf.sequence.seed_num = next_sequence (paqs, parc) ;
             pdest = (pointer)((pntrint)parc->pcfr + NONDATA_OVERHEAD) ;
             memcpy (pdest, psrc, size) ; /* copy blockettes in as they are */
-            parc->total_frames = q->com->blockette_index ;
+            parc->total_frames = blockette_index ;
             parc->appended = TRUE ;
             parc->existing_record = FALSE ;
           end
@@ -423,6 +529,283 @@ begin
   end
 end
 
+#ifdef ARC_POOL
+static void wake_worker (tarcworker *w)
+begin
+
+  pthread_mutex_lock (addr(w->mutex)) ;
+  pthread_cond_broadcast (addr(w->cond)) ;
+  pthread_mutex_unlock (addr(w->mutex)) ;
+end
+
+static void *arcthread (pointer p)
+begin
+  tarcworker *w ;
+  tarcjob *job ;
+  longword tail ;
+
+  w = p ;
+  tail = w->tail ;
+  while (TRUE)
+    begin
+      if (__atomic_load_n (addr(w->head), __ATOMIC_SEQ_CST) == tail)
+        then
+          begin /* nothing to do, sleep until a job is queued */
+            pthread_mutex_lock (addr(w->mutex)) ;
+            __atomic_store_n (addr(w->idle), TRUE, __ATOMIC_SEQ_CST) ;
+            while ((__atomic_load_n (addr(w->head), __ATOMIC_SEQ_CST) == tail) land (lnot w->terminate))
+              pthread_cond_wait (addr(w->cond), addr(w->mutex)) ;
+            __atomic_store_n (addr(w->idle), FALSE, __ATOMIC_SEQ_CST) ;
+            pthread_mutex_unlock (addr(w->mutex)) ;
+            if (__atomic_load_n (addr(w->head), __ATOMIC_SEQ_CST) == tail)
+              then
+                break ; /* terminated and nothing left */
+            continue ;
+          end
+      job = addr(w->jobs[tail and (ARC_QUEUE_SIZE - 1)]) ;
+      if (job->kind == ARJ_RECORD)
+        then
+          arc_assemble (w->paqs, job->q, addr(job->ring), addr(w->miniseed_call), job->blockette_index) ;
+        else
+          arc_flush (w->paqs, job->q, addr(w->miniseed_call)) ;
+      inc(tail) ;
+      __atomic_store_n (addr(w->tail), tail, __ATOMIC_SEQ_CST) ;
+      if (__atomic_load_n (addr(w->waiting), __ATOMIC_SEQ_CST))
+        then
+          wake_worker (w) ; /* library thread is waiting for space or sync */
+    end
+  return NIL ;
+end
+
+/* Wait until no more than limit jobs are queued for worker */
+static void wait_worker (tarcworker *w, longword limit)
+begin
+
+  if ((w->head - __atomic_load_n (addr(w->tail), __ATOMIC_SEQ_CST)) <= limit)
+    then
+      return ;
+  pthread_mutex_lock (addr(w->mutex)) ;
+  __atomic_store_n (addr(w->waiting), TRUE, __ATOMIC_SEQ_CST) ;
+  while ((w->head - __atomic_load_n (addr(w->tail), __ATOMIC_SEQ_CST)) > limit)
+    pthread_cond_wait (addr(w->cond), addr(w->mutex)) ;
+  __atomic_store_n (addr(w->waiting), FALSE, __ATOMIC_SEQ_CST) ;
+  pthread_mutex_unlock (addr(w->mutex)) ;
+end
+
+static void archive_start (paqstruc paqs)
+begin
+  tarcpool *pool ;
+  tarcworker *w ;
+  integer i, count ;
+
+  count = (integer)sysconf(_SC_NPROCESSORS_ONLN) - 1 ; /* leave one for the library thread */
+  if (count > ARC_MAX_WORKERS)
+    then
+      count = ARC_MAX_WORKERS ;
+  if (count < 1)
+    then
+      count = 1 ;
+  pool = malloc (sizeof(tarcpool)) ;
+  if (pool == NIL)
+    then
+      return ; /* assemble in library thread */
+  memset (pool, 0, sizeof(tarcpool)) ;
+  pthread_mutex_init (addr(pool->callback_mutex), NULL) ;
+  pthread_mutex_init (addr(pool->stat_mutex), NULL) ;
+  for (i = 0 ; i < count ; i++)
+    begin
+      w = malloc (sizeof(tarcworker)) ;
+      if (w == NIL)
+        then
+          break ;
+      memset (w, 0, sizeof(tarcworker)) ;
+      w->paqs = paqs ;
+      pthread_mutex_init (addr(w->mutex), NULL) ;
+      pthread_cond_init (addr(w->cond), NULL) ;
+      if (pthread_create (addr(w->threadid), NULL, arcthread, w))
+        then
+          begin
+            pthread_cond_destroy (addr(w->cond)) ;
+            pthread_mutex_destroy (addr(w->mutex)) ;
+            free (w) ;
+            break ;
+          end
+      pool->workers[i] = w ;
+      pool->count = i + 1 ;
+    end
+  if (pool->count == 0)
+    then
+      begin
+        pthread_mutex_destroy (addr(pool->callback_mutex)) ;
+        pthread_mutex_destroy (addr(pool->stat_mutex)) ;
+        free (pool) ;
+        return ;
+      end
+  __atomic_store_n (addr(paqs->arcpool), pool, __ATOMIC_RELEASE) ; /* read by archive_lock */
+end
+
+/* Reserve the next job for this LCQ's worker, call put_job when filled in */
+static tarcjob *get_job (paqstruc paqs, plcq q, tarcworker **pw)
+begin
+  tarcpool *pool ;
+  tarcworker *w ;
+
+  pool = paqs->arcpool ;
+  w = pool->workers[q->lcq_num mod pool->count] ;
+  wait_worker (w, ARC_QUEUE_SIZE - 1) ; /* wait for a free slot */
+  *pw = w ;
+  return addr(w->jobs[w->head and (ARC_QUEUE_SIZE - 1)]) ;
+end
+
+static void put_job (tarcworker *w)
+begin
+
+  __atomic_store_n (addr(w->head), w->head + 1, __ATOMIC_SEQ_CST) ;
+  if (__atomic_load_n (addr(w->idle), __ATOMIC_SEQ_CST))
+    then
+      wake_worker (w) ;
+end
+
+/* Wait until workers have processed all queued jobs, the archive state of
+   every LCQ is then current and may be read or changed by the library thread */
+void archive_sync (paqstruc paqs)
+begin
+  tarcpool *pool ;
+  integer i ;
+
+  pool = paqs->arcpool ;
+  if (pool == NIL)
+    then
+      return ;
+  for (i = 0 ; i < pool->count ; i++)
+    wait_worker (pool->workers[i], 0) ;
+end
+
+/* Process all queued jobs and stop the workers */
+void archive_stop (paqstruc paqs)
+begin
+  tarcpool *pool ;
+  tarcworker *w ;
+  integer i ;
+
+  pool = paqs->arcpool ;
+  if (pool == NIL)
+    then
+      return ;
+  for (i = 0 ; i < pool->count ; i++)
+    begin
+      w = pool->workers[i] ;
+      pthread_mutex_lock (addr(w->mutex)) ;
+      w->terminate = TRUE ;
+      pthread_cond_broadcast (addr(w->cond)) ;
+      pthread_mutex_unlock (addr(w->mutex)) ;
+      pthread_join (w->threadid, NULL) ;
+      pthread_cond_destroy (addr(w->cond)) ;
+      pthread_mutex_destroy (addr(w->mutex)) ;
+      free (w) ;
+    end
+  paqs->arcpool = NIL ;
+  pthread_mutex_destroy (addr(pool->callback_mutex)) ;
+  pthread_mutex_destroy (addr(pool->stat_mutex)) ;
+  free (pool) ;
+end
+
+/* Lock the archive status of the LCQs against updates by the workers, for
+   a thread other than the library thread. Returns the value to pass to
+   archive_unlock, since the workers may start in between */
+pointer archive_lock (paqstruc paqs)
+begin
+  tarcpool *pool ;
+
+  pool = __atomic_load_n (addr(paqs->arcpool), __ATOMIC_ACQUIRE) ;
+  if (pool)
+    then
+      pthread_mutex_lock (addr(pool->stat_mutex)) ;
+  return pool ;
+end
+
+void archive_unlock (pointer lock)
+begin
+  tarcpool *pool ;
+
+  pool = lock ;
+  if (pool)
+    then
+      pthread_mutex_unlock (addr(pool->stat_mutex)) ;
+end
+
+#else
+
+pointer archive_lock (paqstruc paqs)
+begin
+  return NIL ;
+end
+
+void archive_unlock (pointer lock)
+begin
+end
+
+void archive_sync (paqstruc paqs)
+begin
+end
+
+void archive_stop (paqstruc paqs)
+begin
+end
+
+#endif
+
+void flush_archive (paqstruc paqs, plcq q)
+begin
+#ifdef ARC_POOL
+  tarcworker *w ;
+  tarcjob *job ;
+
+  if (paqs->arcpool)
+    then
+      begin
+        job = get_job (paqs, q, addr(w)) ;
+        job->kind = ARJ_FLUSH ;
+        job->q = q ;
+        put_job (w) ;
+        return ;
+      end
+#endif
+  arc_flush (paqs, q, addr(((pq330)paqs->owner)->miniseed_call)) ;
+end
+
+void archive_512_record (paqstruc paqs, plcq q, pcompressed_buffer_ring pbuf)
+begin
+  integer blockette_index ;
+#ifdef ARC_POOL
+  tarcworker *w ;
+  tarcjob *job ;
+#endif
+
+  blockette_index = 0 ;
+  if (q->pack_class == PKC_OPAQUE)
+    then
+      blockette_index = q->com->blockette_index ;
+#ifdef ARC_POOL
+  if (paqs->arcpool == NIL)
+    then
+      archive_start (paqs) ;
+  if (paqs->arcpool)
+    then
+      begin
+        job = get_job (paqs, q, addr(w)) ;
+        job->kind = ARJ_RECORD ;
+        job->q = q ;
+        job->blockette_index = blockette_index ;
+        memcpy (addr(job->ring.hdr_buf), addr(pbuf->hdr_buf), sizeof(seed_header)) ;
+        memcpy (addr(job->ring.rec), addr(pbuf->rec), LIB_REC_SIZE) ;
+        put_job (w) ;
+        return ;
+      end
+#endif
+  arc_assemble (paqs, q, pbuf, addr(((pq330)paqs->owner)->miniseed_call), blockette_index) ;
+end
+
 /* ask the client for the last record. If onelcq is NIL then read all normal or dp lcqs
   based on the from330 flag, else read that one lcq */
 void preload_archive (pq330 q330, boolean from330, plcq onelcq)
@@ -434,6 +817,7 @@ begin
   tarc *parc ;
 
   paqs = q330->aqstruc ;
+  archive_sync (paqs) ;
   if (onelcq)
     then
       q = onelcq ;
@@ -21,13 +21,20 @@ Edit History:
    Ed Date       By  Changes
    -- ---------- --- ---------------------------------------------------
     0 2006-10-11 rdr Created
+    1 2026-10-19     Add archive worker pool, archive_sync and archive_stop.
+    2 2026-10-19     Add archive_lock and archive_unlock.
 */
 #ifndef libarchive_h
 /* Flag this file as included */
 #define libarchive_h
-#define VER_LIBARCHIVE 5
+#define VER_LIBARCHIVE 6
 
 #ifndef OMIT_SEED
+#ifndef X86_WIN32
+#define ARC_POOL /* assemble archival records on worker threads */
+#define ARC_MAX_WORKERS 4
+#define ARC_QUEUE_SIZE 256 /* jobs per worker, must be power of 2 */
+#endif
 /* Make sure libtypes.h is included */
 #ifndef libtypes_h
 #include "libtypes.h"
@@ -42,6 +49,10 @@ Edit History:
 extern void flush_archive (paqstruc paqs, plcq q) ;
 extern void archive_512_record (paqstruc paqs, plcq q, pcompressed_buffer_ring pbuf) ;
 extern void preload_archive (pq330 q330, boolean from330, plcq onelcq) ;
+extern void archive_sync (paqstruc paqs) ;
+extern void archive_stop (paqstruc paqs) ;
+extern pointer archive_lock (paqstruc paqs) ;
+extern void archive_unlock (pointer lock) ;
 #endif
 
 #endif
@@ -35,6 +35,7 @@ Edit History:
     9 2009-02-09 rdr Add EP Support.
    10 2010-01-04 rdr Add version for libdss.
    11 2010-03-27 rdr Add Q335 support.
+   12 2026-10-19     Add lib_trace_call.
 */
 #ifndef q330types_h
 #include "q330types.h"
@@ -118,6 +119,8 @@ Edit History:
 #endif
 #endif
 
+tcall_trace lib_trace_call = NIL ; /* Set by the host to trace the data path */
+
 void lib_create_context (tcontext *ct, tpar_create *cfg) /* If ct = NIL return, check resp_err */
 begin
 
@@ -30,12 +30,14 @@ Edit History:
     7 2008-08-20 rdr Add tcp support.
     8 2009-08-02 rdr Add opt_dss_memory.
     9 2010-03-27 rdr Add Q335 State subtype definitions.
+   10 2026-10-19     Add retransmit, stall, acknowledge and round trip statistics to tslidestat.
+   11 2026-10-19     Add lib_trace_call for tracing of the data path.
 }
 */
 #ifndef libclient_h
 /* Flag this file as included */
 #define libclient_h
-#define VER_LIBCLIENT 15
+#define VER_LIBCLIENT 16
 
 /* Make sure libtypes.h is included */
 #ifndef libtypes_h
@@ -146,7 +148,7 @@ typedef struct { /* parameters for lib_register call */
   longword serial_hostip ; /* IP address to identify host */
 #endif
   word opt_latencytarget ; /* seconds latency target for low-latency data */
-  word opt_closedloop ; /* 1 = enable closed loop acknowledge */
+  word opt_closedloop ; /* 1 = enable closed loop acknowledge, adapted to round trip time */
   word opt_dynamic_ip ; /* 1 = dynamic IP address */
   word opt_hibertime ; /* hibernate time in minutes if non-zero */
   word opt_conntime ; /* maximum connection time in minutes if non-zero */
@@ -190,7 +192,16 @@ typedef struct {
   word low_seq ; /* last packet number acked */
   word latest ; /* latest packet received */
   longword validmap[8] ;
+  longword retransmits ; /* data packets received more than once */
+  longword stalls ; /* times the Q330 filled its window before being acknowledged */
+  longword acks ; /* acknowledge packets sent */
+  longword rtt ; /* smoothed round trip time in milliseconds, 0 if not measured */
 } tslidestat ;
+/* Data path trace points, passed to lib_trace_call if it is set */
+#define LIBTRACE_RECEIVE 0 /* data packet received from the Q330 */
+#define LIBTRACE_DECOMPRESS 1 /* data blockette decompressed */
+#define LIBTRACE_FINISH 2 /* miniseed record finished */
+typedef void (*tcall_trace)(integer stage) ;
 enum taccdur {AD_MINUTE, AD_HOUR, AD_DAY} ;
 /* Compiler doesn't understand this typedef longint taccstats[tacctype][taccdur] ; */
 typedef longint taccstats[AC_LAST + 1][AD_DAY + 1] ;
@@ -448,6 +459,7 @@ extern void lib_webadvertise (tcontext ct, string15 *stnname, string *dpaddr) ;
 extern enum tliberr lib_send_tunneled (tcontext ct, byte cmd, byte response, pointer buf, integer req_size) ;
 extern enum tliberr lib_get_tunneled (tcontext ct, byte *response, pointer buf, integer *resp_size) ;
 extern pmodules lib_get_modules (void) ;
+extern tcall_trace lib_trace_call ; /* NIL unless tracing the data path */
 extern enum tliberr lib_conntiming (tcontext ct, tconntiming *conntiming, boolean setter) ;
 extern longint lib_crccalc (tcontext ct, pbyte p, longint len) ;
 extern enum tliberr lib_send_checkip (tcontext ct, longword ip) ;
@@ -57,6 +57,7 @@ Edit History:
    23 2010-05-17 rdr Add sending Q335 Aware flag in C1_RQFGLS.
    24 2013-08-18 rdr Change reboot to lib330_reboot to avoid conflict with some nonsense.
    25 2016-01-26 rdr For CERR_INVREG just keep trying to register.
+   26 2026-10-19     Pass command round trip times and one second ticks to the sliding window.
 */
 #ifndef libcmds_h
 #include "libcmds.h"
@@ -149,6 +150,9 @@ begin
     then
       nw = nw + 0.001 ;
   r = (pcmd->retsz + pcmd->sendsz) / (nw - pcmd->sent) ;
+  if (pc->ctrl_retries == 0)
+    then
+      slider_rtt (q330, nw - pcmd->sent) ; /* not if resent, can't tell which one was answered */
   pc->histories[pc->history_idx] = r ;
   pc->history_idx = (pc->history_idx + 1) mod MAX_HISTORY ;
   if (pc->history_count < MAX_HISTORY)
@@ -1818,6 +1822,7 @@ begin
     then
       begin /* about 1 second */
         q330->timercnt = 0 ;
+        slider_second (q330) ;
         if (pc->ctrlrecnt)
           then
             dec(pc->ctrlrecnt) ;
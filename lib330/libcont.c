@@ -36,6 +36,7 @@ Edit History:
                      instead of using getmem.
     9 2010-07-21 rdr Add high frequency to connection continuity.
    10 2010-07-22 rdr Add updating of thread memory required. 
+   11 2026-10-19     Wait for archive workers before saving continuity.
 */
 #ifndef libcont_h
 #include "libcont.h"
@@ -69,6 +70,11 @@ Edit History:
 #include "libtokens.h"
 #endif
 #ifndef OMIT_SEED
+#ifndef libarchive_h
+#include "libarchive.h"
+#endif
+#endif
+#ifndef OMIT_SEED
 #ifndef libdetect_h
 #include "libdetect.h"
 #endif
@@ -593,6 +599,9 @@ begin
   integer mem ;
 
   paqs = q330->aqstruc ;
+#ifndef OMIT_SEED
+  archive_sync (paqs) ; /* archive state must be current */
+#endif
   if (q330->par_create.opt_contfile[0] == 0)
     then
       return ; /*don't want a file */
@@ -1151,6 +1160,9 @@ begin
   tcont_cache *freec ;
 
   paqs = q330->aqstruc ;
+#ifndef OMIT_SEED
+  archive_sync (paqs) ; /* archive state must be current */
+#endif
   if (q330->par_create.opt_contfile[0] == 0)
     then
       return ; /*don't want a file */
@@ -24,6 +24,7 @@ Edit History:
     1 2008-01-03 rdr Add log_timer handling.
     2 2008-03-13 rdr Don't reset records_written at 999999.
     3 2010-08-08 rdr In spad protect against negative length difference.
+    4 2026-10-19     Let flush_archive decide whether there is anything to flush.
 */
 #ifndef liblogs_h
 #include "liblogs.h"
@@ -273,7 +274,7 @@ begin
   if ((q == NIL) lor (q->com->ring == NIL))
     then
       return ;
-  if ((q->arc.amini_filter) land (q->arc.total_frames > 0))
+  if (q->arc.amini_filter)
     then
       flush_archive (paqs, q) ;
 end
@@ -651,7 +652,7 @@ begin
         q330->nested_log = FALSE ;
         pcom->frame = 0 ;
       end
-  if ((q->arc.amini_filter) land (q->arc.hdr_buf.samples_in_record))
+  if (q->arc.amini_filter)
     then
       flush_archive (paqs, q) ;
   paqs->log_timer = 0 ;
@@ -34,6 +34,12 @@ Edit History:
                      on accepted socket.
     7 2013-02-02 rdr Use actual highest socket for select.
     8 2013-08-08 rdr Fix checking for EPIPE in send_netserv_packet.
+    9 2026-10-19     Allow up to MAX_NS_CLIENTS clients, each with its own queue
+                     pointer. Send all queued records with one sendmsg and keep
+                     the rest of a partly sent record. Wake the thread with an
+                     eventfd (pipe on other Unix) instead of polling. Detect
+                     client close in read_from_client. Close the rejected
+                     client, not the listening socket, on whitelist failure.
 */
 #ifndef OMIT_SEED /* Can't use without seed generation */
 #ifndef OMIT_NETWORK /* or without network */
@@ -61,6 +67,39 @@ Edit History:
 #include "libstrucs.h"
 #endif
 
+#ifndef X86_WIN32
+#include <sys/uio.h>
+#if defined(linux)
+#include <sys/eventfd.h>
+#endif
+#endif
+
+#ifdef X86_WIN32
+#define NS_IOV_MAX 1 /* one record per send */
+typedef struct {
+  pointer iov_base ;
+  size_t iov_len ;
+} tiovec ;
+#else
+#define NS_IOV_MAX 64 /* records passed to one sendmsg */
+typedef struct iovec tiovec ;
+#endif
+
+typedef struct {
+#ifdef X86_WIN32
+  SOCKET sockpath ;
+#else
+  integer sockpath ;
+#endif
+  boolean sockfull ; /* last send would block */
+  integer nsq_out ; /* next record to send to this client */
+  integer part_lth ; /* bytes of a partly sent record not sent yet */
+  integer part_offset ; /* offset of those bytes in part */
+  completed_record part ; /* rest of partly sent record */
+  double last_sent ;
+} tnsclient ;
+typedef tnsclient *pnsclient ;
+
 typedef struct {
 #ifdef X86_WIN32
   HANDLE mutex ;
@@ -71,25 +110,23 @@ typedef struct {
   pthread_t threadid ;
 #endif
   boolean running ;
-  boolean haveclient ; /* accepted a client */
   boolean sockopen ;
-  boolean sockfull ; /* last send failed */
   boolean terminate ;
   tns_par ns_par ; /* creation parameters */
 #ifdef X86_WIN32
   SOCKET npath ; /* netserv socket */
   struct sockaddr nsockin, nsockout ; /* netserv address descriptors */
-  SOCKET sockpath ;
-  struct sockaddr client ;
 #else
   integer npath ; /* commands socket */
   struct sockaddr nsockin, nsockout ; /* netserv address descriptors */
-  integer sockpath ;
-  struct sockaddr client ;
-  integer high_socket ;
-#endif
-  integer nsq_in, nsq_out ;
-  double last_sent ;
+  integer wake_read ; /* eventfd or pipe used to wake nsthread */
+  integer wake_write ;
+  boolean wake_pending ; /* wakeup written and not read yet */
+#endif
+  integer client_count ;
+  tnsclient clients[MAX_NS_CLIENTS] ;
+  integer nsq_in ;
+  integer nsq_out ; /* oldest record kept for the next client while none connected */
   completed_record sync_record ;
 } tnsstr ;
 typedef tnsstr *pnsstr ;
@@ -145,10 +182,113 @@ begin
   pthread_mutex_unlock (addr(nsstr->mutex)) ;
 end
 
+/* The netserv thread sleeps in select until a client socket is ready or
+   lib_ns_send writes to the wakeup descriptor */
+static void open_wakeup (pnsstr nsstr)
+begin
+#if defined(linux)
+
+  nsstr->wake_read = eventfd (0, EFD_NONBLOCK) ;
+  nsstr->wake_write = nsstr->wake_read ;
+#else
+  integer fds[2] ;
+  integer flags ;
+
+  nsstr->wake_read = INVALID_SOCKET ;
+  nsstr->wake_write = INVALID_SOCKET ;
+  if (pipe (fds) == 0)
+    then
+      begin
+        flags = fcntl (fds[0], F_GETFL, 0) ;
+        fcntl (fds[0], F_SETFL, flags or O_NONBLOCK) ;
+        flags = fcntl (fds[1], F_GETFL, 0) ;
+        fcntl (fds[1], F_SETFL, flags or O_NONBLOCK) ;
+        nsstr->wake_read = fds[0] ;
+        nsstr->wake_write = fds[1] ;
+      end
+#endif
+end
+
+static void close_wakeup (pnsstr nsstr)
+begin
+
+  if (nsstr->wake_write != nsstr->wake_read)
+    then
+      close (nsstr->wake_write) ;
+  if (nsstr->wake_read != INVALID_SOCKET)
+    then
+      close (nsstr->wake_read) ;
+  nsstr->wake_read = INVALID_SOCKET ;
+  nsstr->wake_write = INVALID_SOCKET ;
+end
+
+/* must be called with queue locked */
+static void signal_wakeup (pnsstr nsstr)
+begin
+  uint64_t one ;
+
+  if ((nsstr->wake_pending) lor (nsstr->wake_write == INVALID_SOCKET))
+    then
+      return ;
+  one = 1 ;
+  if (write (nsstr->wake_write, addr(one), sizeof(one)) > 0)
+    then
+      nsstr->wake_pending = TRUE ;
+end
+
+/* must be called with queue locked */
+static void clear_wakeup (pnsstr nsstr)
+begin
+  uint64_t buf[8] ;
+
+  while (read (nsstr->wake_read, addr(buf), sizeof(buf)) > 0) ;
+  nsstr->wake_pending = FALSE ;
+end
+
+#endif
+
+static integer wrap_buffer (integer max, integer i)
+begin
+  integer j ;
+
+  j = i + 1 ;
+  if (j >= max)
+    then
+      j = 0 ;
+  return j ;
+end
+
+/* must be called with queue locked */
+static void close_client (pnsstr nsstr, pnsclient pc, boolean report)
+begin
+  string63 s ;
+
+  if (pc->sockpath == INVALID_SOCKET)
+    then
+      return ;
+#ifdef X86_WIN32
+  closesocket (pc->sockpath) ;
+#else
+  close (pc->sockpath) ;
 #endif
+  pc->sockpath = INVALID_SOCKET ;
+  pc->sockfull = FALSE ;
+  pc->part_lth = 0 ;
+  dec(nsstr->client_count) ;
+  if (nsstr->client_count == 0)
+    then
+      nsstr->nsq_out = pc->nsq_out ; /* keep what this client didn't get for the next one */
+  if (report)
+    then
+      begin
+        sprintf(s, "netserv[%d] port", nsstr->ns_par.server_number) ;
+        lib_msg_add(nsstr->ns_par.stnctx, AUXMSG_DISCON, 0, (pointer)addr(s)) ;
+      end
+end
 
 static void close_socket (pnsstr nsstr)
 begin
+  integer i ;
 
   nsstr->sockopen = FALSE ;
   if (nsstr->npath != INVALID_SOCKET)
@@ -161,19 +301,8 @@ begin
 #endif
         nsstr->npath = INVALID_SOCKET ;
       end
-  if (nsstr->sockpath != INVALID_SOCKET)
-    then
-      begin
-#ifdef X86_WIN32
-        closesocket (nsstr->sockpath) ;
-#else
-        close (nsstr->sockpath) ;
-#endif
-        nsstr->sockpath = INVALID_SOCKET ;
-      end
-#ifndef X86_WIN32
-  nsstr->high_socket = 0 ;
-#endif
+  for (i = 0 ; i < MAX_NS_CLIENTS ; i++)
+    close_client (nsstr, addr(nsstr->clients[i]), FALSE) ;
 end
 
 static void open_socket (pnsstr nsstr)
@@ -211,11 +340,6 @@ begin
         lib_msg_add(nsstr->ns_par.stnctx, AUXMSG_SOCKETERR, 0, (pointer)addr(s)) ;
         return ;
       end
-#ifndef X86_WIN32
-  if (nsstr->npath > nsstr->high_socket)
-    then
-      nsstr->high_socket = nsstr->npath ;
-#endif
   psock = (pointer) addr(nsstr->nsockin) ;
   memset(psock, 0, sizeof(struct sockaddr)) ;
   psock->sin_family = AF_INET ;
@@ -262,11 +386,11 @@ begin
 #ifdef X86_WIN32
   flag = 1 ;
   ioctlsocket (nsstr->npath, FIONBIO, addr(flag)) ;
-  err = listen (nsstr->npath, 1) ;
+  err = listen (nsstr->npath, MAX_NS_CLIENTS) ;
 #else
   flags = fcntl (nsstr->npath, F_GETFL, 0) ;
   fcntl (nsstr->npath, F_SETFL, flags or O_NONBLOCK) ;
-  err = listen (nsstr->npath, 1) ;
+  err = listen (nsstr->npath, MAX_NS_CLIENTS) ;
 #endif
   if (err)
     then
@@ -293,14 +417,17 @@ begin
   nsstr->sockopen = TRUE ;
 end
 
+
 static void accept_ns_socket (pnsstr nsstr)
 begin
   socklen_t lth ;
   integer i, err, err2 ;
 #ifdef X86_WIN32
   longword flag ;
+  SOCKET path ;
 #else
   integer flags ;
+  integer path ;
 #endif
   integer bufsize ;
   longword client_ip ;
@@ -308,15 +435,17 @@ begin
   boolean found ;
   string15 hostname ;
   string63 s ;
+  struct sockaddr client ;
   struct sockaddr_in *psock ;
   twhitelist *pwhite ;
+  pnsclient pc ;
 
   lth = sizeof(struct sockaddr) ;
   if (nsstr->npath == INVALID_SOCKET)
     then
       return ;
-  nsstr->sockpath = accept (nsstr->npath, addr(nsstr->client), addr(lth)) ;
-  if (nsstr->sockpath == INVALID_SOCKET)
+  path = accept (nsstr->npath, addr(client), addr(lth)) ;
+  if (path == INVALID_SOCKET)
     then
       begin
         err =
@@ -342,15 +471,12 @@ begin
       begin
 #ifdef X86_WIN32
         flag = 1 ;
-        ioctlsocket (nsstr->sockpath, FIONBIO, addr(flag)) ;
+        ioctlsocket (path, FIONBIO, addr(flag)) ;
 #else
-        if (nsstr->sockpath > nsstr->high_socket)
-          then
-            nsstr->high_socket = nsstr->sockpath ;
-        flags = fcntl (nsstr->sockpath, F_GETFL, 0) ;
-        fcntl (nsstr->sockpath, F_SETFL, flags or O_NONBLOCK) ;
+        flags = fcntl (path, F_GETFL, 0) ;
+        fcntl (path, F_SETFL, flags or O_NONBLOCK) ;
 #endif
-        psock = (pointer) addr(nsstr->client) ;
+        psock = (pointer) addr(client) ;
         showdot (ntohl(psock->sin_addr.s_addr), addr(hostname)) ;
         client_ip = ntohl(psock->sin_addr.s_addr) ;
         client_port = ntohs(psock->sin_port) ;
@@ -372,23 +498,22 @@ begin
                 then
                   begin
 #ifdef X86_WIN32
-                    closesocket (nsstr->npath) ;
+                    closesocket (path) ;
 #else
-                    close (nsstr->npath) ;
+                    close (path) ;
 #endif
-                    nsstr->sockpath = INVALID_SOCKET ;
                     return ;
                   end
             end
         sprintf(s, "\"%s:%d\" to netserv[%d] port", (char *)addr(hostname), client_port, nsstr->ns_par.server_number) ;
         lib_msg_add (nsstr->ns_par.stnctx, AUXMSG_CONN, 0, (pointer)addr(s)) ;
         lth = sizeof(integer) ;
-        err = getsockopt (nsstr->sockpath, SOL_SOCKET, SO_SNDBUF, addr(bufsize), addr(lth)) ;
+        err = getsockopt (path, SOL_SOCKET, SO_SNDBUF, addr(bufsize), addr(lth)) ;
         if ((err == 0) land (bufsize < 30000))
           then
             begin
               bufsize = 30000 ;
-              setsockopt (nsstr->sockpath, SOL_SOCKET, SO_SNDBUF, addr(bufsize), lth) ;
+              setsockopt (path, SOL_SOCKET, SO_SNDBUF, addr(bufsize), lth) ;
             end
 #ifndef X86_WIN32
 #if defined(linux) || defined(solaris)
@@ -396,27 +521,40 @@ begin
 #else
         flags = 1 ;
         lth = sizeof(integer) ;
-        setsockopt (nsstr->sockpath, SOL_SOCKET, SO_NOSIGPIPE, addr(flag), lth) ;
+        setsockopt (path, SOL_SOCKET, SO_NOSIGPIPE, addr(flags), lth) ;
 #endif
 #endif
-        nsstr->haveclient = TRUE ;
-        nsstr->last_sent = now () ;
-        nsstr->sockfull = FALSE ;
+        qlock (nsstr) ;
+        for (i = 0 ; i < MAX_NS_CLIENTS ; i++)
+          if (nsstr->clients[i].sockpath == INVALID_SOCKET)
+            then
+              break ;
+        pc = addr(nsstr->clients[i]) ;
+        pc->sockpath = path ;
+        pc->sockfull = FALSE ;
+        pc->part_lth = 0 ;
+        if (nsstr->client_count == 0)
+          then
+            pc->nsq_out = nsstr->nsq_out ; /* first client gets the backlog */
+          else
+            pc->nsq_out = nsstr->nsq_in ; /* others start with new data */
+        pc->last_sent = now () ;
+        inc(nsstr->client_count) ;
+        qunlock (nsstr) ;
       end
 end
 
-static void read_from_client (pnsstr nsstr)
+static void read_from_client (pnsstr nsstr, pnsclient pc)
 begin
 #define RBUFSIZE 100
   integer err ;
   byte buf[RBUFSIZE] ;
-  string63 s ;
 
   repeat
-    if (lnot nsstr->haveclient)
+    err = recv(pc->sockpath, addr(buf), RBUFSIZE, 0) ;
+    if (err == 0)
       then
-        return ;
-    err = recv(nsstr->sockpath, addr(buf), RBUFSIZE, 0) ;
+        break ; /* client closed connection */
     if (err == SOCKET_ERROR)
       then
         begin
@@ -428,287 +566,304 @@ begin
 #endif
           if ((err == ECONNRESET) lor (err == ECONNABORTED))
             then
-              begin
-#ifdef X86_WIN32
-                closesocket (nsstr->sockpath) ;
-#else
-                close (nsstr->sockpath) ;
-#endif
-                sprintf(s, "netserv[%d] port", nsstr->ns_par.server_number) ;
-                lib_msg_add(nsstr->ns_par.stnctx, AUXMSG_DISCON, 0, (pointer)addr(s)) ;
-                nsstr->haveclient = FALSE ;
-                nsstr->sockfull = FALSE ;
-                return ;
-              end
+              break ;
+          return ; /* nothing left in buffer */
         end
-  until (err == 0)) ; /* nothing left in buffer */
+  until FALSE) ;
+  qlock (nsstr) ;
+  close_client (nsstr, pc, TRUE) ;
+  qunlock (nsstr) ;
 end
 
-static integer wrap_buffer (integer max, integer i)
+static integer send_client (pnsclient pc, tiovec *iov, integer count)
 begin
-  integer j ;
-
-  j = i + 1 ;
-  if (j >= max)
-    then
-      j = 0 ;
-  return j ;
-end
+#ifdef X86_WIN32
 
-/* returns TRUE if error */
-static boolean send_netserv_packet (pnsstr nsstr, pointer buf)
-begin
-  integer err ;
-  string63 s ;
+  return send(pc->sockpath, iov[0].iov_base, (integer)iov[0].iov_len, 0) ;
+#else
+  struct msghdr msg ;
 
-  if (lnot nsstr->haveclient)
-    then
-      return TRUE ;
+  memset (addr(msg), 0, sizeof(struct msghdr)) ;
+  msg.msg_iov = iov ;
+  msg.msg_iovlen = count ;
 #if defined(linux)
-  err = send(nsstr->sockpath, buf, LIB_REC_SIZE, MSG_NOSIGNAL) ;
+  return sendmsg(pc->sockpath, addr(msg), MSG_NOSIGNAL) ;
 #else
-  err = send(nsstr->sockpath, buf, LIB_REC_SIZE, 0) ;
+  return sendmsg(pc->sockpath, addr(msg), 0) ;
 #endif
-  if (err == SOCKET_ERROR)
-    then
-      begin
-        err =
-#ifdef X86_WIN32
-               WSAGetLastError() ;
-#else
-               errno ;
 #endif
-        if (err == EWOULDBLOCK)
-          then
-            begin
-              nsstr->sockfull = TRUE ;
-              return TRUE ;
-            end
+end
+
+/* Send as much of the client's queue as the socket takes, must be called
+   with queue locked. A record that only partly fits is copied to the
+   client so its ring slot can be reused before the rest is sent. */
+static void flush_client (pnsstr nsstr, pnsclient pc)
+begin
+  tiovec iov[NS_IOV_MAX] ;
+  integer count, idx, err, sent, total ;
+
+  while ((lnot pc->sockfull) land ((pc->part_lth > 0) lor (pc->nsq_out != nsstr->nsq_in)))
+    begin
+      count = 0 ;
+      total = 0 ;
+      if (pc->part_lth > 0)
+        then
+          begin
+            iov[0].iov_base = addr(pc->part[pc->part_offset]) ;
+            iov[0].iov_len = pc->part_lth ;
+            total = pc->part_lth ;
+            count = 1 ;
+          end
+      idx = pc->nsq_out ;
+      while ((count < NS_IOV_MAX) land (idx != nsstr->nsq_in))
+        begin
+          iov[count].iov_base = addr((*(nsstr->ns_par.nsbuf))[idx]) ;
+          iov[count].iov_len = LIB_REC_SIZE ;
+          incn(total, LIB_REC_SIZE) ;
+          inc(count) ;
+          idx = wrap_buffer(nsstr->ns_par.record_count, idx) ;
+        end
+      sent = send_client (pc, addr(iov[0]), count) ;
+      if (sent == SOCKET_ERROR)
+        then
+          begin
+            err =
 #ifdef X86_WIN32
-        else if ((err == ECONNRESET) lor (err == ECONNABORTED))
+                 WSAGetLastError() ;
 #else
-        else if (err == EPIPE)
+                 errno ;
 #endif
-          then
-            begin
-#ifdef X86_WIN32
-              closesocket (nsstr->sockpath) ;
-#else
-              close (nsstr->sockpath) ;
+            if (err == EWOULDBLOCK)
+              then
+                pc->sockfull = TRUE ;
+#ifndef X86_WIN32
+            else if (err == EINTR)
+              then
+                continue ;
 #endif
-              sprintf(s, "netserv[%d] port", nsstr->ns_par.server_number) ;
-              lib_msg_add(nsstr->ns_par.stnctx, AUXMSG_DISCON, 0, (pointer)addr(s)) ;
-              nsstr->haveclient = FALSE ;
-              nsstr->sockfull = FALSE ;
-              return TRUE ;
-            end
-      end
-    else
-      nsstr->sockfull = FALSE ;
-  nsstr->last_sent = now () ;
-  return FALSE ;
+            else
+              close_client (nsstr, pc, TRUE) ;
+            return ;
+          end
+      pc->last_sent = now () ;
+      if (sent < total)
+        then
+          pc->sockfull = TRUE ; /* wait until socket is writable again */
+      if (pc->part_lth > 0)
+        then
+          begin
+            if (sent < pc->part_lth)
+              then
+                begin
+                  incn(pc->part_offset, sent) ;
+                  decn(pc->part_lth, sent) ;
+                  continue ;
+                end
+            decn(sent, pc->part_lth) ;
+            pc->part_lth = 0 ;
+          end
+      while (sent > 0)
+        begin
+          if (sent < LIB_REC_SIZE)
+            then
+              begin
+                memcpy (addr(pc->part), addr((*(nsstr->ns_par.nsbuf))[pc->nsq_out][sent]), LIB_REC_SIZE - sent) ;
+                pc->part_offset = 0 ;
+                pc->part_lth = LIB_REC_SIZE - sent ;
+                sent = 0 ;
+              end
+            else
+              decn(sent, LIB_REC_SIZE) ;
+          pc->nsq_out = wrap_buffer(nsstr->ns_par.record_count, pc->nsq_out) ; /* sucessful */
+        end
+    end
 end
 
-static void send_next_buffer (pnsstr nsstr)
+/* Send the sync record to a client that has been idle for sync_time seconds,
+   must be called with queue locked */
+static void sync_client (pnsstr nsstr, pnsclient pc)
 begin
-  boolean failed ;
 
-  if (lnot nsstr->haveclient)
+  if ((pc->sockfull) lor (pc->part_lth > 0) lor (pc->nsq_out != nsstr->nsq_in) lor
+      ((now () - pc->last_sent) < nsstr->ns_par.sync_time))
     then
       return ;
-  failed = send_netserv_packet (nsstr, addr((*(nsstr->ns_par.nsbuf))[nsstr->nsq_out])) ;
-  if (lnot failed)
-    then
-      nsstr->nsq_out = wrap_buffer(nsstr->ns_par.record_count, nsstr->nsq_out) ; /* sucessful */
+  memcpy (addr(pc->part), addr(nsstr->sync_record), LIB_REC_SIZE) ;
+  pc->part_offset = 0 ;
+  pc->part_lth = LIB_REC_SIZE ;
+  flush_client (nsstr, pc) ;
 end
 
 void lib_ns_send (pointer ct, pcompleted_record pbuf)
 begin
   pnsstr nsstr ;
-  integer nq ;
-  boolean wasempty ;
+  pnsclient pc ;
+  integer nq, i ;
 
   nsstr = ct ;
   qlock (nsstr) ;
-  wasempty = (nsstr->nsq_in == nsstr->nsq_out) ;
   nq = wrap_buffer (nsstr->ns_par.record_count, nsstr->nsq_in) ; /* next pointer after we insert new record */
   if (nq == nsstr->nsq_out)
     then
       nsstr->nsq_out = wrap_buffer(nsstr->ns_par.record_count, nsstr->nsq_out) ; /* throw away oldest */
+  for (i = 0 ; i < MAX_NS_CLIENTS ; i++)
+    begin
+      pc = addr(nsstr->clients[i]) ;
+      if ((pc->sockpath != INVALID_SOCKET) land (nq == pc->nsq_out))
+        then
+          pc->nsq_out = wrap_buffer(nsstr->ns_par.record_count, pc->nsq_out) ; /* client is behind, throw away its oldest */
+    end
   memcpy(addr((*(nsstr->ns_par.nsbuf))[nsstr->nsq_in]), pbuf, LIB_REC_SIZE) ;
   nsstr->nsq_in = nq ;
-  if (wasempty)
+  if (nsstr->client_count > 0)
     then
-      send_next_buffer (nsstr) ;
+      begin
+#ifdef X86_WIN32
+        for (i = 0 ; i < MAX_NS_CLIENTS ; i++)
+          if (nsstr->clients[i].sockpath != INVALID_SOCKET)
+            then
+              flush_client (nsstr, addr(nsstr->clients[i])) ;
+#else
+        signal_wakeup (nsstr) ;
+#endif
+      end
   qunlock (nsstr) ;
 end
 
 #ifdef X86_WIN32
 unsigned long  __stdcall nsthread (pointer p)
+#else
+void *nsthread (pointer p)
+#endif
 begin
   pnsstr nsstr ;
+  pnsclient pc ;
   fd_set readfds, writefds, exceptfds ;
   struct timeval timeout ;
-  integer res ;
-  boolean sent ;
+  integer res, i ;
+#ifndef X86_WIN32
+  integer high_socket ;
+#endif
 
   nsstr = p ;
   repeat
     if (nsstr->sockopen)
       then
-        begin /* wait for socket input or timeout */
+        begin /* wait for new data, socket input or timeout */
           FD_ZERO (addr(readfds)) ;
           FD_ZERO (addr(writefds)) ;
           FD_ZERO (addr(exceptfds)) ;
-          if (lnot nsstr->haveclient)
+#ifndef X86_WIN32
+          high_socket = 0 ;
+          if (nsstr->wake_read != INVALID_SOCKET)
             then
-              FD_SET (nsstr->npath, addr(readfds)) ; /* waiting for accept */
-            else
               begin
-                FD_SET (nsstr->sockpath, addr(readfds)) ; /* client might try to send me something */
-                if (nsstr->sockfull)
-                  then
-                    FD_SET (nsstr->sockpath, addr(writefds)) ; /* buffer was full */
+                FD_SET (nsstr->wake_read, addr(readfds)) ;
+                high_socket = nsstr->wake_read ;
               end
-          timeout.tv_sec = 0 ;
-          timeout.tv_usec = 25000 ; /* 25ms timeout */
-          res = select (0, addr(readfds), addr(writefds), addr(exceptfds), addr(timeout)) ;
-          if (res > 0)
+#endif
+          if ((nsstr->npath != INVALID_SOCKET) land (nsstr->client_count < MAX_NS_CLIENTS))
             then
               begin
-                if (FD_ISSET (nsstr->npath, addr(readfds)))
-                  then
-                    accept_ns_socket (nsstr) ;
-                else if (nsstr->haveclient)
+                FD_SET (nsstr->npath, addr(readfds)) ; /* waiting for accept */
+#ifndef X86_WIN32
+                if (nsstr->npath > high_socket)
                   then
-                    begin
-                      if (FD_ISSET (nsstr->sockpath, addr(readfds)))
-                        then
-                          read_from_client (nsstr) ;
-                      if ((nsstr->sockfull) land (FD_ISSET (nsstr->sockpath, addr(writefds))))
-                        then
-                          nsstr->sockfull = FALSE ;
-                    end
+                    high_socket = nsstr->npath ;
+#endif
               end
-          if (nsstr->haveclient)
+          for (i = 0 ; i < MAX_NS_CLIENTS ; i++)
+            begin
+              pc = addr(nsstr->clients[i]) ;
+              if (pc->sockpath == INVALID_SOCKET)
+                then
+                  continue ;
+              FD_SET (pc->sockpath, addr(readfds)) ; /* client might try to send me something */
+              if (pc->sockfull)
+                then
+                  FD_SET (pc->sockpath, addr(writefds)) ; /* buffer was full */
+#ifndef X86_WIN32
+              if (pc->sockpath > high_socket)
+                then
+                  high_socket = pc->sockpath ;
+#endif
+            end
+#ifdef X86_WIN32
+          timeout.tv_sec = 0 ;
+          timeout.tv_usec = 25000 ; /* 25ms timeout */
+          res = select (0, addr(readfds), addr(writefds), addr(exceptfds), addr(timeout)) ;
+#else
+          if (nsstr->wake_read != INVALID_SOCKET)
             then
               begin
-                sent = FALSE ;
-                if (nsstr->sockfull)
-                  then
-                    sleepms (25) ;
-                  else
-                    begin
-                      qlock (nsstr) ;
-                      if (nsstr->nsq_in != nsstr->nsq_out)
-                        then
-                          begin
-                            sent = TRUE ;
-                            send_next_buffer (nsstr) ;
-                          end
-                      qunlock (nsstr) ;
-                      if (lnot sent)
-                        then
-                          begin
-                            if ((nsstr->ns_par.sync_time) land ((now () - nsstr->last_sent) >= nsstr->ns_par.sync_time))
-                              then
-                                send_netserv_packet (nsstr, addr(nsstr->sync_record)) ;
-                              else
-                                sleepms (25) ;
-                          end
-                    end
+                timeout.tv_sec = 1 ; /* lib_ns_send will wake us */
+                timeout.tv_usec = 0 ;
               end
-        end
-      else
-        sleepms (25) ;
-  until nsstr->terminate) ;
-  nsstr->running = FALSE ;
-  ExitThread (0) ;
-  return 0 ;
-end
-#else
-void *nsthread (pointer p)
-begin
-  pnsstr nsstr ;
-  fd_set readfds, writefds, exceptfds ;
-  struct timeval timeout ;
-  integer res ;
-  boolean sent ;
-
-  nsstr = p ;
-  repeat
-    if (nsstr->sockopen)
-      then
-        begin /* wait for socket input or timeout */
-          FD_ZERO (addr(readfds)) ;
-          FD_ZERO (addr(writefds)) ;
-          FD_ZERO (addr(exceptfds)) ;
-          if (lnot nsstr->haveclient)
-            then
-              FD_SET (nsstr->npath, addr(readfds)) ; /* waiting for accept */
             else
               begin
-                FD_SET (nsstr->sockpath, addr(readfds)) ; /* client might try to send me something */
-                if (nsstr->sockfull)
-                  then
-                    FD_SET (nsstr->sockpath, addr(writefds)) ; /* buffer was full */
+                timeout.tv_sec = 0 ;
+                timeout.tv_usec = 25000 ; /* 25ms timeout */
               end
-          timeout.tv_sec = 0 ;
-          timeout.tv_usec = 25000 ; /* 25ms timeout */
-          res = select (nsstr->high_socket + 1, addr(readfds), addr(writefds), addr(exceptfds), addr(timeout)) ;
+          res = select (high_socket + 1, addr(readfds), addr(writefds), addr(exceptfds), addr(timeout)) ;
+#endif
           if (res > 0)
             then
               begin
-                if (FD_ISSET (nsstr->npath, addr(readfds)))
-                  then
-                    accept_ns_socket (nsstr) ;
-                else if (nsstr->haveclient)
+#ifndef X86_WIN32
+                if ((nsstr->wake_read != INVALID_SOCKET) land (FD_ISSET (nsstr->wake_read, addr(readfds))))
                   then
                     begin
-                      if (FD_ISSET (nsstr->sockpath, addr(readfds)))
-                        then
-                          read_from_client (nsstr) ;
-                      if ((nsstr->sockfull) land (FD_ISSET (nsstr->sockpath, addr(writefds))))
-                        then
-                          nsstr->sockfull = FALSE ;
+                      qlock (nsstr) ;
+                      clear_wakeup (nsstr) ;
+                      qunlock (nsstr) ;
                     end
+#endif
+                for (i = 0 ; i < MAX_NS_CLIENTS ; i++)
+                  begin
+                    pc = addr(nsstr->clients[i]) ;
+                    if ((pc->sockpath != INVALID_SOCKET) land (FD_ISSET (pc->sockpath, addr(readfds))))
+                      then
+                        read_from_client (nsstr, pc) ;
+                    if ((pc->sockpath != INVALID_SOCKET) land (pc->sockfull) land (FD_ISSET (pc->sockpath, addr(writefds))))
+                      then
+                        pc->sockfull = FALSE ;
+                  end
+                if ((nsstr->npath != INVALID_SOCKET) land (FD_ISSET (nsstr->npath, addr(readfds))))
+                  then
+                    accept_ns_socket (nsstr) ;
               end
-          if (nsstr->haveclient)
+          else if (res < 0)
+            then
+              sleepms (10) ;
+          if (nsstr->client_count > 0)
             then
               begin
-                sent = FALSE ;
-                if (nsstr->sockfull)
-                  then
-                    sleepms (25) ;
-                  else
-                    begin
-                      qlock (nsstr) ;
-                      if (nsstr->nsq_in != nsstr->nsq_out)
-                        then
-                          begin
-                            sent = TRUE ;
-                            send_next_buffer (nsstr) ;
-                          end
-                      qunlock (nsstr) ;
-                      if (lnot sent)
-                        then
-                          begin
-                            if ((nsstr->ns_par.sync_time) land ((now () - nsstr->last_sent) >= nsstr->ns_par.sync_time))
-                              then
-                                send_netserv_packet (nsstr, addr(nsstr->sync_record)) ;
-                              else
-                                sleepms (25) ;
-                          end
-                    end
+                qlock (nsstr) ;
+                for (i = 0 ; i < MAX_NS_CLIENTS ; i++)
+                  begin
+                    pc = addr(nsstr->clients[i]) ;
+                    if (pc->sockpath == INVALID_SOCKET)
+                      then
+                        continue ;
+                    flush_client (nsstr, pc) ;
+                    if ((nsstr->ns_par.sync_time) land (pc->sockpath != INVALID_SOCKET))
+                      then
+                        sync_client (nsstr, pc) ;
+                  end
+                qunlock (nsstr) ;
               end
         end
       else
         sleepms (25) ;
   until nsstr->terminate) ;
   nsstr->running = FALSE ;
+#ifdef X86_WIN32
+  ExitThread (0) ;
+  return 0 ;
+#else
   pthread_exit (0) ;
-end
 #endif
+end
 
 pointer lib_ns_start (tns_par *nspar)
 begin
@@ -731,7 +886,8 @@ begin
     end
   create_mutex (nsstr) ;
   nsstr->npath = INVALID_SOCKET ;
-  nsstr->sockpath = INVALID_SOCKET ;
+  for (i = 0 ; i < MAX_NS_CLIENTS ; i++)
+    nsstr->clients[i].sockpath = INVALID_SOCKET ;
   open_socket (nsstr) ;
   if (lnot nsstr->sockopen)
     then
@@ -743,6 +899,7 @@ begin
   nsstr->threadhandle = CreateThread (NIL, 0, nsthread, nsstr, 0, addr(nsstr->threadid)) ;
   if (nsstr->threadhandle == NIL)
 #else
+  open_wakeup (nsstr) ;
   err = pthread_create(addr(nsstr->threadid), NULL, nsthread, nsstr) ;
   if (err)
 #endif
@@ -760,11 +917,21 @@ begin
   pnsstr nsstr ;
 
   nsstr = ct ;
+  qlock (nsstr) ;
   nsstr->terminate = TRUE ;
+#ifndef X86_WIN32
+  signal_wakeup (nsstr) ;
+#endif
+  qunlock (nsstr) ;
   repeat
     sleepms (25) ;
   until (lnot nsstr->running)) ;
+  qlock (nsstr) ;
   close_socket (nsstr) ;
+  qunlock (nsstr) ;
+#ifndef X86_WIN32
+  close_wakeup (nsstr) ;
+#endif
   destroy_mutex (nsstr) ;
 end
 
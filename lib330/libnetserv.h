@@ -22,11 +22,12 @@ Edit History:
    -- ---------- --- ---------------------------------------------------
     0 2006-09-10 rdr Created
     1 2007-03-07 rdr pbuf declaration fixed for lib_ns_send.
+    2 2026-10-19     Add MAX_NS_CLIENTS.
 */
 #ifndef libnetserv_h
 /* Flag this file as included */
 #define libnetserv_h
-#define VER_LIBNETSERV 6
+#define VER_LIBNETSERV 7
 
 #ifndef OMIT_SEED
 /* Make sure libtypes.h is included */
@@ -40,6 +41,7 @@ Edit History:
 
 #define MAX_NETWHITE 10
 #define MAX_NS_BUFFERS 9800 /* 5.0MB as shown in station manager */
+#define MAX_NS_CLIENTS 8 /* simultaneous clients per netserver port */
 
 typedef completed_record tnsbuf[MAX_NS_BUFFERS] ;
 typedef struct {
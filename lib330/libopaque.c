@@ -27,6 +27,7 @@ Edit History:
     3 2008-01-16 rdr Fix record length for CNP blockette data.
     4 2008-02-27 rdr cfg_lastwritten set to data time, not host time.
     5 2008-03-13 rdr Don't reset records_written at 999999.
+    6 2026-10-19     Let flush_archive decide whether there is anything to flush.
 */
 #ifndef OMIT_SEED
 #ifndef libopaque_h
@@ -85,7 +86,7 @@ begin
     then
       begin
         paqs->cfg_timer = 0 ;
-        if ((q->arc.amini_filter) land (q->arc.total_frames > 1))
+        if (q->arc.amini_filter)
           then
             flush_archive (paqs, q) ;
       end
@@ -226,7 +227,7 @@ begin
   pcom->blockette_index = 56 ;
   pcom->last_blockette = 48 ;
   pcom->blockette_count = 0 ;
-  if ((q->arc.amini_filter) land (q->arc.total_frames > 1))
+  if (q->arc.amini_filter)
     then
       flush_archive (paqs, q) ;
 end
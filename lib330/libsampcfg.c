@@ -51,6 +51,8 @@ Edit History:
    14 2009-09-07 rdr Fix recursive mutex locking in verify_mapping.
    15 2010-03-27 rdr Q335 support added.
    16 2011-03-17 rdr Setup new gain_bits in LCQ init for deb_flags usage.
+   17 2026-10-19     Wait for archive workers before releasing LCQ memory.
+   18 2026-10-19     Read the archive status in lib_lcqstat under archive_lock.
 */
 #ifndef libsampcfg_h
 #include "libsampcfg.h"
@@ -794,6 +796,9 @@ begin
 /* totrec = print_actual_rectotals ;
          newuser.msg = inttostr(totrec) + ' recs. seq end: ' +
               inttostr(dt_data_sequence) ; */
+#ifndef OMIT_SEED
+  archive_sync (paqs) ; /* archive workers must be done with the LCQ's */
+#endif
   clear_sg (paqs) ;
   mem_release (q330) ; /* release all that memory used by LCQ's */
 end
@@ -845,6 +850,7 @@ begin
   longword cur ;
   integer pass ;
   tonelcqstat *pone ;
+  pointer arclock ;
 
   paqs = q330->aqstruc ;
   lcqstat->count = 0 ;
@@ -871,6 +877,7 @@ begin
               pone->rec_age = cur - q->last_record_generated ;
           pone->det_count = q->detections_session ;
           pone->cal_count = q->calibrations_session ;
+          arclock = archive_lock (paqs) ; /* updated by archive workers */
           pone->arec_cnt = q->arc.records_written_session ;
           pone->arec_over = q->arc.records_overwritten_session ;
           if (q->arc.last_updated == 0)
@@ -879,6 +886,7 @@ begin
             else
               pone->arec_age = cur - q->arc.last_updated ;
           pone->arec_seq = q->arc.records_written ;
+          archive_unlock (arclock) ;
           inc(lcqstat->count) ;
           q = q->link ;
         end
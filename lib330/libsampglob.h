@@ -30,11 +30,12 @@ Edit History:
                      Add gap_offset.
     6 2010-03-27 rdr Add Q335 definitions.
     7 2011-03-17 rdr Add gain_bits to tlcq.
+    8 2026-10-19     Add arcpool to taqstruc.
 */
 #ifndef libsampglob_h
 /* Flag this file as included */
 #define libsampglob_h
-#define VER_LIBSAMPGLOB 8
+#define VER_LIBSAMPGLOB 9
 
 #ifndef libtypes_h
 #include "libtypes.h"
@@ -509,6 +510,7 @@ typedef struct {
 #ifndef OMIT_SEED
   integer arc_size ; /* size of archival mini-seed records */
   integer arc_frames ; /* number of frames in an archival record */
+  pointer arcpool ; /* archive worker threads, NIL if not started */
 #endif
   word first_sg ; /* start of cleard fields */
   word webport ;
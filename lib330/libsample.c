@@ -37,6 +37,8 @@ Edit History:
    10 2011-03-17 rdr For Q335 new usage of deb_flags.
    11 2011-09-22 rdr In process_mult make sure have first segment, if not then don't
                      call process_lcq.
+   12 2026-10-19     Let flush_archive decide whether there is anything to flush.
+   13 2026-10-19     Trace points for decompression and finished records.
 */
 #ifndef libsample_h
 #include "libsample.h"
@@ -416,6 +418,9 @@ begin
   pq330 q330 ;
   seed_header *phdr ;
 
+  if (lib_trace_call)
+    then
+      lib_trace_call (LIBTRACE_FINISH) ;
   q330 = paqs->owner ;
   install_header (paqs, q, pcom) ;
   inc(pcom->records_written) ;
@@ -511,7 +516,7 @@ begin
             end
         finish_record (paqs, q, pcom) ;
       end
-  if ((q->arc.amini_filter) land (q->arc.total_frames > 1))
+  if (q->arc.amini_filter)
     then
       flush_archive (paqs, q) ;
 end
@@ -737,6 +742,9 @@ begin
     else
       begin /* pre-compressed data */
         samples = decompress_blockette (paqs, q) ;
+        if (lib_trace_call)
+          then
+            lib_trace_call (LIBTRACE_DECOMPRESS) ;
 #ifndef OMIT_SEED
         while (pi)
           begin
@@ -45,6 +45,10 @@ Edit History:
    16 2013-08-09 rdr Check for missing timing blockette when moving to next second of data.
    17 2022-04-18 dsn Remove 2 erroneous checks for dpath being open in send_dopen() and dack_out().
                      Add Q330 TCP telemetry debugging with BSL_Q330_TCP_DEBUG conditional compilation.
+   18 2026-10-19     Keep the receive window as a bitmap instead of scanning pkt_bufs for each
+                     packet. Add closed loop acknowledge (opt_closedloop) adapted to the command
+                     round trip time and packet rate. Count retransmits, window stalls and acks.
+   19 2026-10-19     Trace point for received data packets.
 */
 #ifndef libtypes_h
 #include "libtypes.h"
@@ -109,6 +113,54 @@ begin
     getthrbuf (q330, (pointer)addr(q330->pkt_bufs[i]), sizeof(tpkt_buf)) ;
 end
 
+/* Receive window bitmap, one bit per pkt_bufs entry */
+static void win_set (pq330 q330, word seq)
+begin
+
+  seq = seq and 255 ;
+  q330->winmap[seq shr 5] = q330->winmap[seq shr 5] or (1 shl (longword)(seq and 31)) ;
+end
+
+static void win_clear (pq330 q330, word seq)
+begin
+
+  seq = seq and 255 ;
+  q330->winmap[seq shr 5] = q330->winmap[seq shr 5] and not (1 shl (longword)(seq and 31)) ;
+end
+
+static boolean win_valid (pq330 q330, word seq)
+begin
+
+  seq = seq and 255 ;
+  return (q330->winmap[seq shr 5] and (1 shl (longword)(seq and 31))) != 0 ;
+end
+
+/* 32 window bits starting at seq, bit 0 is seq */
+static longword win_bits (pq330 q330, word seq)
+begin
+  integer w, b ;
+
+  seq = seq and 255 ;
+  w = seq shr 5 ;
+  b = seq and 31 ;
+  if (b == 0)
+    then
+      return q330->winmap[w] ;
+  return (q330->winmap[w] shr b) or (q330->winmap[(w + 1) and 7] shl (32 - b)) ;
+end
+
+/* Any packet waiting for an earlier one */
+static boolean win_ahead (pq330 q330)
+begin
+  integer i ;
+
+  for (i = 0 ; i <= 7 ; i++)
+    if (q330->winmap[i])
+      then
+        return TRUE ;
+  return FALSE ;
+end
+
 static void reset_window (pq330 q330)
 begin
   word w ;
@@ -132,20 +184,16 @@ end
 
 void reset_link (pq330 q330)
 begin
-  integer i ;
   paqstruc paqs ;
   string31 s ;
-  ppkt_buf pbuf ;
 
   paqs = q330->aqstruc ;
   lock (q330) ;
   q330->last_packet = q330->share.log.dataseq ;
   unlock (q330) ;
-  for (i = 0 ; i <= 255 ; i++)
-    begin
-      pbuf = q330->pkt_bufs[i] ;
-      pbuf->valid = FALSE ;
-    end
+  memset (addr(q330->winmap), 0, sizeof(q330->winmap)) ;
+  q330->acked_seq = q330->last_packet ;
+  q330->ack_now = FALSE ;
   q330->link_recv = TRUE ;
   q330->lasttime = 0 ;
   paqs->data_timetag = 0.0 ;
@@ -1142,6 +1190,9 @@ begin
 
   q330->ack_delay = 0 ;
   q330->piggyok = TRUE ;
+  q330->acked_seq = q330->last_packet ;
+  q330->ack_now = FALSE ;
+  inc(q330->acks) ;
   p = (pbyte)addr(q330->dataout.qdp) ;
   incn(p, 6) ; /* point at length */
   msglth = loadword (addr(p)) + QDP_HDR_LTH ;
@@ -1244,23 +1295,63 @@ begin
 #endif
 end
 
+/* Closed loop, acknowledge after this many packets so that the Q330 has
+   window left for the packets that arrive during one round trip */
+static integer closed_loop_limit (pq330 q330, word ack_cnt, word window)
+begin
+  integer limit, inflight ;
+
+  limit = ack_cnt ;
+  if (window)
+    then
+      begin
+        inflight = (integer)(q330->pkt_rate * q330->srtt + 0.999) ;
+        if (window - 1 - inflight < limit)
+          then
+            limit = window - 1 - inflight ;
+      end
+  if (limit < 1)
+    then
+      limit = 1 ;
+  return limit ;
+end
+
+/* Closed loop, don't hold an acknowledge (in 100ms ticks) past the time the
+   Q330 would fill its window at the current packet rate, less one round trip */
+static integer closed_loop_delay (pq330 q330, word ack_to, word window)
+begin
+  integer delay, ticks ;
+
+  delay = ack_to ;
+  if ((window) land (q330->pkt_rate > 0.1))
+    then
+      begin
+        ticks = (integer)(((window - q330->ack_counter) / q330->pkt_rate - q330->srtt) * 10.0) ;
+        if (ticks < delay)
+          then
+            delay = ticks ;
+      end
+  if (delay < 1)
+    then
+      delay = 1 ;
+  return delay ;
+end
+
 static void send_dack (pq330 q330)
 begin
-  integer i, j, k ;
-  word lowseq, idx ;
+  integer j ;
+  word lowseq, ack_cnt, ack_to, window ;
   tdp_ack pack ;
   pbyte p, pref, psave ;
   integer lth, msglth ;
-  ppkt_buf pbuf ;
 
   q330->ack_timeout = 0 ;
   repeat
-    pbuf = q330->pkt_bufs[q330->last_packet and 255] ;
-    if (pbuf->valid)
+    if (win_valid (q330, q330->last_packet))
       then
         begin
           proc_insequence (q330, q330->last_packet and 255) ;
-          pbuf->valid = FALSE ;
+          win_clear (q330, q330->last_packet) ;
           inc(q330->last_packet) ;
         end
       else
@@ -1268,18 +1359,9 @@ begin
   until (q330->libstate != LIBSTATE_RUN)) ;
   lowseq = q330->last_packet - 1 ;
   memset (addr(pack), 0, sizeof(tdp_ack)) ;
-  pack.acks[0] = 1 ; /* last_packet - 1 */
-  idx = q330->last_packet ;
-  for (i = 1 ; i <= WINBUFS - 1 ; i++)
-    begin
-      j = (i shr 5) and 3 ;
-      k = i and 31 ;
-      pbuf = q330->pkt_bufs[idx and 255] ;
-      if (pbuf->valid)
-        then
-          pack.acks[j] = pack.acks[j] or (1 shl (longint)k) ; /*add those in queue*/
-      inc(idx) ;
-    end
+  for (j = 0 ; j <= 3 ; j++)
+    pack.acks[j] = win_bits (q330, lowseq + (j shl 5)) ; /*add those in queue*/
+  pack.acks[0] = pack.acks[0] or 1 ; /* last_packet - 1 */
   p = (pbyte)addr(q330->dataout.qdp) ;
   psave = p ;
   storeqdphdr (addr(p), DT_DACK, 0, 0, lowseq) ;
@@ -1294,25 +1376,58 @@ begin
   storelongint (addr(p), gcrccalc (addr(q330->crc_table), (pointer)((pntrint)p + 4), msglth - 4)) ;
   inc(q330->ack_counter) ;
   lock (q330) ;
-  if (q330->ack_counter < q330->share.log.ack_cnt)
+  ack_cnt = q330->share.log.ack_cnt ;
+  ack_to = q330->share.log.ack_to ;
+  window = q330->share.log.window ;
+  unlock (q330) ;
+  if (q330->par_register.opt_closedloop)
+    then
+      begin /* acknowledge now if the window is filling, or to report a gap */
+        if ((lnot q330->ack_now) land (lnot win_ahead (q330)) land
+            (q330->ack_counter < closed_loop_limit (q330, ack_cnt, window)))
+          then
+            begin
+              if (q330->ack_delay == 0)
+                then
+                  q330->ack_delay = closed_loop_delay (q330, ack_to, window) ;
+              return ;
+            end
+      end
+  else if (q330->ack_counter < ack_cnt)
     then
       begin
         if (q330->ack_delay == 0)
           then
-            q330->ack_delay = q330->share.log.ack_to ;
-        unlock (q330) ;
+            q330->ack_delay = ack_to ;
         return ;
       end
-  unlock (q330) ;
   q330->ack_counter = 0 ;
   dack_out (q330) ;
 end
 
+/* Called once per second */
+void slider_second (pq330 q330)
+begin
+
+  q330->pkt_rate = q330->pkt_rate * 0.75 + q330->pkt_count * 0.25 ;
+  q330->pkt_count = 0 ;
+end
+
+/* Round trip time sample in seconds */
+void slider_rtt (pq330 q330, double rtt)
+begin
+
+  if (q330->srtt <= 0.0)
+    then
+      q330->srtt = rtt ;
+    else
+      q330->srtt = q330->srtt + (rtt - q330->srtt) / 8.0 ;
+end
+
 void process_data (pq330 q330)
 begin
-  word hw ;
+  word hw, window ;
   boolean good ;
-  integer i, j, k ;
   string95 s, s1 ;
   ppkt_buf pbuf ;
   pbyte p ;
@@ -1324,7 +1439,11 @@ begin
   if ((q330->libstate != LIBSTATE_RUN) lor (q330->share.freeze_timer > 0))
     then
       return ;
+  if (lib_trace_call)
+    then
+      lib_trace_call (LIBTRACE_RECEIVE) ;
   add_status (q330, AC_PACKETS, 1) ;
+  inc(q330->pkt_count) ;
   hw = q330->last_packet + WINWRAP ;
   good = q330->recvhdr.sequence >= q330->last_packet ;
   if (hw > q330->last_packet)
@@ -1353,25 +1472,45 @@ begin
   if (good)
     then
       begin
-        pbuf = q330->pkt_bufs[q330->recvhdr.sequence and 255] ;
-        pbuf->valid = TRUE ;
-        memcpy (addr(pbuf->buf.qdp), addr(q330->datain.qdp), q330->recvhdr.datalength + QDP_HDR_LTH) ;
+        if (win_valid (q330, q330->recvhdr.sequence))
+          then
+            inc(q330->retransmits) ; /* already have it */
+          else
+            begin
+              pbuf = q330->pkt_bufs[q330->recvhdr.sequence and 255] ;
+              memcpy (addr(pbuf->buf.qdp), addr(q330->datain.qdp), q330->recvhdr.datalength + QDP_HDR_LTH) ;
+              win_set (q330, q330->recvhdr.sequence) ;
+            end
+        lock (q330) ;
+        window = q330->share.log.window ;
+        unlock (q330) ;
+        if ((window) land (lnot q330->ack_now) land
+            ((word)(q330->recvhdr.sequence - q330->acked_seq) >= window - 1))
+          then
+            begin /* Q330 can't send more until acknowledged */
+              inc(q330->stalls) ;
+              q330->ack_now = TRUE ;
+            end
         lock (q330) ;
         memset (addr(q330->share.slidestat), 0, sizeof(tslidestat)) ;
         q330->share.slidestat.low_seq = q330->last_packet - 1 ;
         q330->share.slidestat.latest = q330->recvhdr.sequence ;
-        for (i = 0 ; i <= 255 ; i++)
-          begin
-            j = (i shr 5) and 7 ;
-            k = i and 31 ;
-            pbuf = q330->pkt_bufs[i] ;
-            if (pbuf->valid)
-              then
-                q330->share.slidestat.validmap[j] = q330->share.slidestat.validmap[j] or (1 shl (longword)k) ;
-          end
+        memcpy (addr(q330->share.slidestat.validmap), addr(q330->winmap), sizeof(q330->winmap)) ;
+        q330->share.slidestat.retransmits = q330->retransmits ;
+        q330->share.slidestat.stalls = q330->stalls ;
+        q330->share.slidestat.acks = q330->acks ;
+        q330->share.slidestat.rtt = (longword)(q330->srtt * 1000.0) ;
         unlock (q330) ;
       end
     else
-      add_status (q330, AC_SEQERR, 1) ;
+      begin
+        add_status (q330, AC_SEQERR, 1) ;
+        if ((word)(q330->last_packet - q330->recvhdr.sequence) <= WINBUFS)
+          then
+            begin /* already processed, the acknowledge was lost */
+              inc(q330->retransmits) ;
+              q330->ack_now = TRUE ;
+            end
+      end
   send_dack (q330) ;
 end
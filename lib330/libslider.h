@@ -21,11 +21,12 @@ Edit History:
    Ed Date       By  Changes
    -- ---------- --- ---------------------------------------------------
     0 2006-09-29 rdr Created
+    1 2026-10-19     Add slider_second and slider_rtt.
 */
 #ifndef libslider_h
 /* Flag this file as included */
 #define libslider_h
-#define VER_LIBSLIDER 17
+#define VER_LIBSLIDER 18
 
 #ifndef libstrucs_h
 #include "libstrucs.h"
@@ -225,5 +226,7 @@ extern void process_data (pq330 q330) ;
 extern void reset_link (pq330 q330) ;
 extern void send_dopen (pq330 q330) ;
 extern void dack_out (pq330 q330) ;
+extern void slider_second (pq330 q330) ;
+extern void slider_rtt (pq330 q330, double rtt) ;
 
 #endif
@@ -43,6 +43,8 @@ Edit History:
                      crash caused by buffer overflow past end of memory block).
                      New static getmem() called by getbuf() and getthrbuf() to
                      allocate memory buffers (fixes memory leak in getthrbuf()).
+   15 2026-10-19     Stop archive workers in lib_destroy_330.
+   16 2026-10-19     Add gcrcslices for calculating the CRC 4 bytes at a time.
 */
 /* Make sure libstrucs.h is included */
 #ifndef libstrucs_h
@@ -80,6 +82,9 @@ Edit History:
 #ifndef libdss_h
 #include "libdss.h"
 #endif
+#ifndef libarchive_h
+#include "libarchive.h"
+#endif
 #endif
 
 #define MS100 (0.1)
@@ -301,6 +306,25 @@ begin
     end
 end
 
+/* Tables for calculating the CRC 4 bytes at a time, slices[k] gives the
+   CRC of a byte followed by k + 1 zero bytes */
+void gcrcslices (crc_table_type *crctable, crc_table_type *slices)
+begin
+  integer count, k ;
+  longint prev ;
+
+  for (k = 0 ; k <= 2 ; k++)
+    for (count = 0 ; count <= 255 ; count++)
+      begin
+        if (k == 0)
+          then
+            prev = (*crctable)[count] ;
+          else
+            prev = slices[k - 1][count] ;
+        slices[k][count] = (prev shl 8) xor (*crctable)[((longword)prev shr 24) and 255] ;
+      end
+end
+
 longint gcrccalc (crc_table_type *crctable, pbyte p, longint len)
 begin
   longint crc ;
@@ -693,6 +717,7 @@ begin
   q330->share.target_state = LIBSTATE_IDLE ;
   memcpy (addr(q330->par_create), cfg, sizeof(tpar_create)) ;
   gcrcinit (addr(q330->crc_table)) ;
+  gcrcslices (addr(q330->crc_table), addr(q330->crc_slices[0])) ;
   memcpy (addr(q330->qclock), addr(default_clock), sizeof(tclock)) ;
   q330->share.opstat.status_latency = INVALID_LATENCY ;
   q330->share.opstat.data_latency = INVALID_LATENCY ;
@@ -776,6 +801,9 @@ begin
 
   q330 = *ct ;
   *ct = NIL ;
+#ifndef OMIT_SEED
+  archive_stop (q330->aqstruc) ;
+#endif
   destroy_mutex (q330) ;
   pm = q330->memory_head ;
   while (pm)
@@ -38,11 +38,14 @@ Edit History:
    11 2010-03-27 rdr Add Q335 flag.
    12 2010-05-07 rdr Add comm structure.
    13 2013-02-02 rdr Add high_socket.
+   14 2026-10-19     Add sliding window bitmap, closed loop acknowledge state and
+                     window statistics. Remove valid flag from tpkt_buf.
+   15 2026-10-19     Add crc_slices and gcrcslices.
 }*/
 #ifndef libstrucs_h
 /* Flag this file as included */
 #define libstrucs_h
-#define VER_LIBSTRUCS 18
+#define VER_LIBSTRUCS 20
 
 /* Make sure libtypes.h is included */
 #ifndef libtypes_h
@@ -121,8 +124,6 @@ typedef taccmstat taccmstats[AC_LAST + 1] ;
 typedef byte tcfgbuf[MAXCFG] ;
 typedef tcfgbuf *pcfgbuf ;
 typedef struct {
-  boolean valid ;
-  byte spare ;
   tany buf ;
 } tpkt_buf ;
 typedef word tcbuf[10000] ; /* continuity buffer */
@@ -293,6 +294,7 @@ typedef struct { /* this is the actual context which is hidden from clients */
   longword serial_ip ; /* Host serial IP */
   tany datain, dataout, datasave ;
   crc_table_type crc_table ;
+  crc_table_type crc_slices[3] ; /* crc_table for 1 to 3 following zero bytes */
   tstate_call state_call ; /* buffer for building state callbacks */
   tmsg_call msg_call ; /* buffer for building message callbacks */
   tonesec_call onesec_call ; /* buffer for building one second callbacks */
@@ -311,6 +313,15 @@ typedef struct { /* this is the actual context which is hidden from clients */
   integer ack_delay ;
   integer ack_timeout ; /* to send DT_NOP packets */
   word ack_counter ;
+  longword winmap[8] ; /* bitmap of pkt_bufs holding received packets */
+  word acked_seq ; /* first sequence not covered by the last DT_DACK sent */
+  word pkt_count ; /* data packets received this second */
+  boolean ack_now ; /* closed loop, acknowledge without waiting */
+  longword retransmits ; /* data packets received more than once */
+  longword stalls ; /* Q330 window filled before being acknowledged */
+  longword acks ; /* DT_DACK packets sent */
+  double srtt ; /* smoothed command round trip time in seconds, 0 if not measured */
+  double pkt_rate ; /* smoothed data packets per second */
   word timercnt ; /* count up getting one second intervals from 100ms */
   word q330cport ; /* Q330's command port */
   word q330dport ; /* Q330's data port */
@@ -387,6 +398,7 @@ extern void getbuf (pq330 q330, pointer *p, integer size) ;
 extern void mem_release (pq330 q330) ;
 extern void getthrbuf (pq330 q330, pointer *p, integer size) ;
 extern void gcrcinit (crc_table_type *crctable) ;
+extern void gcrcslices (crc_table_type *crctable, crc_table_type *slices) ;
 extern void lib_create_330 (tcontext *ct, tpar_create *cfg) ;
 extern enum tliberr lib_destroy_330 (tcontext *ct) ;
 extern enum tliberr lib_register_330 (pq330 q330, tpar_register *rpar) ;
@@ -43,6 +43,9 @@ Edit History:
    14 2010-05-13 rdr Add detection of 127.0.0.1 as additional baler port.
    15 2022-04-18 dsn Add check for EINPROGRESS return code from socket() call for linux.
                      Keep check for EWOULDBLOCK solaris return code.
+   16 2026-10-19     Decode base-96 packets and calculate the CRC in one pass, with an
+                     SSSE3 version of the group decoding where available.
+   17 2026-10-19     Build the SSSE3 group decoding without optimization too.
 */
 
 #ifdef X86_WIN32
@@ -51,6 +54,13 @@ Edit History:
 #include <unistd.h>			/* close(), read(), write() */
 #endif
 
+/* SSSE3 group decoding, compiled for SSSE3 with a target attribute
+   and selected at run time if the CPU supports it */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && !defined(OMIT_SSSE3)
+#define DECODE_SSSE3
+#include <tmmintrin.h>
+#endif
+
 #ifdef CMEX32
 #include "cmexserial.h"
 #endif
@@ -438,66 +448,173 @@ begin
 end
 #endif
 
-/* because of the original encoding, lth will always be a multiple of
-  4 bytes (1 group) plus 2. Returns -1 if not valid */
-static integer decode (pq330 q330, integer lth)
+static integer hexdigit (byte m)
 begin
-typedef byte tenc[4] ;
-  integer groups, actual, diff ;
-  pbyte p, psave, pdest ;
-  tenc enc ;
-  tenc *psrc ;
-  byte m ;
-  integer mask ;
-  char *pmask ;
-  longint thiscrc ;
 
-  psave = (pointer) addr(q330->datain.qdp) ;
-  pmask = (pointer) psave ;
-  /* NOTE: I was unable to find a C routine that would convert hexadecimal string
-     to binary AND clearly indicate that the input was not valid, so do the hard way */
-  mask = 0 ;
-  m = *pmask++ ;
-  if ((m >= '0') land (m <= '9'))
-    then
-      mask = m - 0x30 ;
-  else if ((m >= 'A') land (m <= 'F'))
-    then
-      mask = m - 0x37 ;
-    else
-      return -1 ; /* not valid */
-  m = *pmask++ ;
   if ((m >= '0') land (m <= '9'))
     then
-      mask = (mask shl 4) + (m - 0x30) ;
+      return m - 0x30 ;
   else if ((m >= 'A') land (m <= 'F'))
     then
-      mask = (mask shl 4) + (m - 0x37) ;
+      return m - 0x37 ;
     else
       return -1 ; /* not valid */
-  psrc = (pointer) pmask ; /* skipped over encoding */
-  pdest = psave ;
-  groups = (lth - 2) shr 2 ;
-  actual = groups * 3 ; /* decoded byte count */
+end
+
+/* Decode groups of 4 encoded bytes into 3 binary bytes. The two high bits
+   of each binary byte are carried in the fourth encoded byte */
+static void decode_groups (pbyte psrc, pbyte pdest, integer groups, byte mask)
+begin
+  byte m ;
+
   while (groups > 0)
     begin
-      memcpy(addr(enc), psrc, 4) ;
-      psrc++ ;
-      m = enc[3] - 0x20 ;
-      *pdest++ = (enc[0] - 0x20 + ((m and 0x30) shl 2)) xor mask ;
-      *pdest++ = (enc[1] - 0x20 + ((m and 0xc) shl 4)) xor mask ;
-      *pdest++ = (enc[2] - 0x20 + ((m and 3) shl 6)) xor mask ;
+      m = psrc[3] - 0x20 ;
+      pdest[0] = (psrc[0] - 0x20 + ((m and 0x30) shl 2)) xor mask ;
+      pdest[1] = (psrc[1] - 0x20 + ((m and 0xc) shl 4)) xor mask ;
+      pdest[2] = (psrc[2] - 0x20 + ((m and 3) shl 6)) xor mask ;
+      incn(psrc, 4) ;
+      incn(pdest, 3) ;
       dec(groups) ;
     end
+end
+
+#ifdef DECODE_SSSE3
+/* pshufb controls and masks for decode_quads_ssse3 */
+static const byte ssse3_high[16] = {3, 3, 3, 3, 7, 7, 7, 7, 11, 11, 11, 11, 15, 15, 15, 15} ;
+static const byte ssse3_pack[16] = {0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, 0x80, 0x80, 0x80, 0x80} ;
+static const byte ssse3_bits[3][16] = {
+  {0x30, 0, 0, 0, 0x30, 0, 0, 0, 0x30, 0, 0, 0, 0x30, 0, 0, 0},
+  {0, 0x0c, 0, 0, 0, 0x0c, 0, 0, 0, 0x0c, 0, 0, 0, 0x0c, 0, 0},
+  {0, 0, 0x03, 0, 0, 0, 0x03, 0, 0, 0, 0x03, 0, 0, 0, 0x03, 0}} ;
+
+/* Decode quads of 4 groups (16 encoded bytes) into 12 binary bytes. Writes
+   16 bytes for each quad, which is safe when decoding in place since pdest
+   is well behind the next group to be read */
+__attribute__((target("ssse3")))
+static void decode_quads_ssse3 (pbyte psrc, pbyte pdest, integer quads, byte mask)
+begin
+  __m128i v, m, hi, high, pack, bits0, bits1, bits2, bias, xmask ;
+
+  high = _mm_loadu_si128 ((const __m128i *)ssse3_high) ;
+  pack = _mm_loadu_si128 ((const __m128i *)ssse3_pack) ;
+  bits0 = _mm_loadu_si128 ((const __m128i *)ssse3_bits[0]) ;
+  bits1 = _mm_loadu_si128 ((const __m128i *)ssse3_bits[1]) ;
+  bits2 = _mm_loadu_si128 ((const __m128i *)ssse3_bits[2]) ;
+  bias = _mm_set1_epi8 (0x20) ;
+  xmask = _mm_set1_epi8 ((char)mask) ;
+  while (quads > 0)
+    begin
+      v = _mm_sub_epi8 (_mm_loadu_si128 ((const __m128i *)psrc), bias) ;
+      m = _mm_shuffle_epi8 (v, high) ; /* high bits byte to all four bytes of the group */
+      /* move each byte's bits to the top, 16 bit shifts can't carry out of a masked byte */
+      hi = _mm_slli_epi16 (_mm_and_si128 (m, bits0), 2) ;
+      hi = _mm_or_si128 (hi, _mm_slli_epi16 (_mm_and_si128 (m, bits1), 4)) ;
+      hi = _mm_or_si128 (hi, _mm_slli_epi16 (_mm_and_si128 (m, bits2), 6)) ;
+      v = _mm_xor_si128 (_mm_add_epi8 (v, hi), xmask) ;
+      _mm_storeu_si128 ((__m128i *)pdest, _mm_shuffle_epi8 (v, pack)) ;
+      incn(psrc, 16) ;
+      incn(pdest, 12) ;
+      dec(quads) ;
+    end
+end
+
+static integer have_ssse3 = -1 ;
+#endif
+
+/* Add len bytes to crc, 4 bytes at a time using crc_slices */
+static longint crc_update (pq330 q330, longint crc, pbyte p, integer len)
+begin
+  longword c ;
+
+  c = (longword)crc ;
+  while (len >= 4)
+    begin
+      c = c xor (((longword)p[0] shl 24) or ((longword)p[1] shl 16) or ((longword)p[2] shl 8) or p[3]) ;
+      c = (longword)q330->crc_slices[2][c shr 24] xor (longword)q330->crc_slices[1][(c shr 16) and 255] xor
+          (longword)q330->crc_slices[0][(c shr 8) and 255] xor (longword)q330->crc_table[c and 255] ;
+      incn(p, 4) ;
+      len = len - 4 ;
+    end
+  while (len > 0)
+    begin
+      c = (c shl 8) xor (longword)q330->crc_table[((c shr 24) xor *p++) and 255] ;
+      dec(len) ;
+    end
+  return (longint)c ;
+end
+
+/* because of the original encoding, lth will always be a multiple of
+  4 bytes (1 group) plus 2. Returns -1 if not valid. The header is
+  decoded first to get the length, then the rest of the packet is
+  decoded and added to the CRC DECODE_CHUNK groups at a time while
+  the decoded bytes are still in cache */
+#define DECODE_CHUNK 16
+static integer decode (pq330 q330, integer lth)
+begin
+  integer groups, actual, diff, left, n, i, hinib, lonib ;
+  pbyte p, psave, psrc, pdest ;
+  byte mask ;
+  longint thiscrc ;
+
+  psave = (pointer) addr(q330->datain.qdp) ;
+  hinib = hexdigit (psave[0]) ;
+  lonib = hexdigit (psave[1]) ;
+  if ((hinib < 0) lor (lonib < 0))
+    then
+      return -1 ; /* not valid */
+  mask = (hinib shl 4) + lonib ;
+  psrc = psave ;
+  incn(psrc, 2) ; /* skipped over encoding */
+  pdest = psave ;
+  groups = (lth - 2) shr 2 ;
+  if (groups < QDP_HDR_LTH div 3)
+    then
+      return -1 ; /* no room for header */
+  decode_groups (psrc, pdest, QDP_HDR_LTH div 3, mask) ;
+  incn(psrc, (QDP_HDR_LTH div 3) * 4) ;
+  incn(pdest, QDP_HDR_LTH) ;
+  groups = groups - QDP_HDR_LTH div 3 ;
   p = psave ;
   loadqdphdr (addr(p), addr(q330->recvhdr)) ;
-  diff = actual - (q330->recvhdr.datalength + QDP_HDR_LTH) ;
-  if ((diff >= 0) land (diff <= 2))
+  actual = q330->recvhdr.datalength + QDP_HDR_LTH ;
+  diff = (groups * 3 + QDP_HDR_LTH) - actual ;
+  if ((diff < 0) lor (diff > 2))
     then
-      actual = q330->recvhdr.datalength + QDP_HDR_LTH ; /* replace with exact length */
-    else
       return -1 ; /* no good, return */
-  thiscrc = gcrccalc (addr(q330->crc_table), (pointer)((pntrint)psave + 4), actual - 4) ;
+  thiscrc = crc_update (q330, 0, (pointer)((pntrint)psave + 4), QDP_HDR_LTH - 4) ;
+  left = actual - QDP_HDR_LTH ; /* bytes still to add to CRC */
+#ifdef DECODE_SSSE3
+  if (have_ssse3 < 0)
+    then
+      have_ssse3 = __builtin_cpu_supports ("ssse3") != 0 ;
+#endif
+  while (groups > 0)
+    begin
+      n = groups ;
+      if (n > DECODE_CHUNK)
+        then
+          n = DECODE_CHUNK ;
+      i = 0 ;
+#ifdef DECODE_SSSE3
+      if (have_ssse3)
+        then
+          begin
+            i = n and (not 3) ;
+            decode_quads_ssse3 (psrc, pdest, i shr 2, mask) ;
+          end
+#endif
+      decode_groups (psrc + i * 4, pdest + i * 3, n - i, mask) ;
+      incn(psrc, n * 4) ;
+      groups = groups - n ;
+      n = n * 3 ;
+      if (n > left)
+        then
+          n = left ; /* only the last groups can be short */
+      thiscrc = crc_update (q330, thiscrc, pdest, n) ;
+      left = left - n ;
+      incn(pdest, n) ;
+    end
   if (thiscrc == q330->recvhdr.crc)
     then
       return actual ; /* good crc, return actual length */
@@ -511,7 +628,7 @@ begin
   pbyte p ;
 
   p = (pbyte)addr(q330->datain.qdp) ;
-  thiscrc = gcrccalc (addr(q330->crc_table), (pointer)((pntrint)p + 4), lth - 4) ;
+  thiscrc = crc_update (q330, 0, (pointer)((pntrint)p + 4), lth - 4) ;
   loadqdphdr (addr(p), addr(q330->recvhdr)) ;
   if (thiscrc == q330->recvhdr.crc)
     then
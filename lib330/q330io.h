@@ -25,7 +25,7 @@ Edit History:
 #ifndef q330io_h
 /* Flag this file as included */
 #define q330io_h
-#define VER_Q330IO 15
+#define VER_Q330IO 16
 
 /* Make sure libtypes.h is included */
 #ifndef libtypes_h
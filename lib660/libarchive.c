@@ -29,6 +29,10 @@ Edit History:
     0 2017-06-06 rdr Created
     1 2021-12-24 rdr Copyright assignment to Kinemetrics.
 ------2022-02-24 jms remove pseudo-pascal macros------
+    2 2026-10-19     Assemble archival records on worker threads, see ARC_POOL.
+                     Data records with only a header frame are not flushed.
+    3 2026-10-19     Workers update the archive status under stat_mutex, add
+                     archive_lock and archive_unlock for status readers.
 */
 #include "libarchive.h"
 #include "libmsgs.h"
@@ -42,6 +46,108 @@ Edit History:
 #include "libsupport.h"
 #include "libsample.h"
 
+#ifdef ARC_POOL
+/*
+  Archival records are assembled by a small pool of worker threads so that
+  merging 512 byte records doesn't hold up the library thread. Each LCQ is
+  always handled by the same worker, so records and flushes for one channel
+  are processed in the order they were queued. Each worker has a single
+  producer, single consumer ring of jobs; the library thread only waits if
+  a ring is full or when it needs the archive state to be current.
+*/
+enum tarcjob_kind {ARJ_RECORD, ARJ_FLUSH} ;
+
+typedef struct
+{
+    enum tarcjob_kind kind ;
+    plcq q ;
+    int blockette_index ; /* next free opaque blockette location when queued */
+    tcompressed_buffer_ring ring ; /* copy of header and record */
+} tarcjob ;
+
+typedef struct
+{
+    pthread_t threadid ;
+    pthread_mutex_t mutex ; /* only used for sleeping and waking */
+    pthread_cond_t cond ;
+    U32 head ; /* next job to fill, written by library thread */
+    U32 tail ; /* next job to process, written by worker */
+    BOOLEAN idle ; /* worker is waiting for a job */
+    BOOLEAN waiting ; /* library thread is waiting for worker */
+    BOOLEAN terminate ;
+    pq660 q660 ;
+    tminiseed_call miniseed_call ; /* this worker's callback buffer */
+    tarcjob jobs[ARC_QUEUE_SIZE] ;
+} tarcworker ;
+
+typedef struct
+{
+    int count ;
+    pthread_mutex_t callback_mutex ; /* one call_aminidata at a time */
+    pthread_mutex_t stat_mutex ; /* archive status counters of all LCQs */
+    tarcworker *workers[ARC_MAX_WORKERS] ;
+} tarcpool ;
+#endif
+
+/* Status counters that lib_lcqstat reads are updated by the workers under
+   stat_mutex. Without workers the library thread updates them directly */
+static void stat_lock (pq660 q660)
+{
+#ifdef ARC_POOL
+    tarcpool *pool ;
+
+    pool = q660->arcpool ;
+
+    if (pool)
+        pthread_mutex_lock (&(pool->stat_mutex)) ;
+
+#endif
+}
+
+static void stat_unlock (pq660 q660)
+{
+#ifdef ARC_POOL
+    tarcpool *pool ;
+
+    pool = q660->arcpool ;
+
+    if (pool)
+        pthread_mutex_unlock (&(pool->stat_mutex)) ;
+
+#endif
+}
+
+/* Return the next archive sequence number for a new record */
+static I32 next_sequence (pq660 q660, tarc *parc)
+{
+    I32 seq ;
+
+    stat_lock (q660) ;
+    (parc->records_written)++ ;
+    seq = parc->records_written ;
+    stat_unlock (q660) ;
+    return seq ;
+}
+
+/* Clients expect archival callbacks one at a time */
+static void arc_callback (pq660 q660, tminiseed_call *pmini)
+{
+#ifdef ARC_POOL
+    tarcpool *pool ;
+
+    pool = q660->arcpool ;
+
+    if (pool) {
+        pthread_mutex_lock (&(pool->callback_mutex)) ;
+        q660->par_create.call_aminidata (pmini) ;
+        pthread_mutex_unlock (&(pool->callback_mutex)) ;
+        return ;
+    }
+
+#endif
+    q660->par_create.call_aminidata (pmini) ;
+}
+
 static void clear_archive (tarc *parc, int size)
 {
 
@@ -52,7 +158,7 @@ static void clear_archive (tarc *parc, int size)
     memclr(&(parc->hdr_buf), sizeof(seed_header)) ;
 }
 
-void flush_archive (pq660 q660, plcq q)
+static void arc_flush (pq660 q660, plcq q, tminiseed_call *pmini)
 {
 #define OCT_1_2016 23673600 /* first possible valid data */
 #define MAX_DATE 0x7FFF0000 /* above this just has to be nonsense */
@@ -61,14 +167,15 @@ void flush_archive (pq660 q660, plcq q)
 
     parc = &(q->arc) ;
     p = (pointer)parc->pcfr ; /* start of record */
-    q660->miniseed_call.timestamp = parc->hdr_buf.starting_time.seed_fpt ;
+    pmini->timestamp = parc->hdr_buf.starting_time.seed_fpt ;
 
-    if ((q660->miniseed_call.timestamp < OCT_1_2016) || (q660->miniseed_call.timestamp > MAX_DATE)) {
+    if ((pmini->timestamp < OCT_1_2016) || (pmini->timestamp > MAX_DATE)) {
         clear_archive (parc, q660->arc_size) ;
         return ; /* impossible time */
     }
 
     if (((q->pack_class == PKC_MESSAGE) && (parc->hdr_buf.samples_in_record == 0)) ||
+            ((q->pack_class == PKC_DATA) && (parc->total_frames <= 1)) ||
             ((q->pack_class != PKC_MESSAGE) && (parc->total_frames == 0)))
 
     {
@@ -77,25 +184,27 @@ void flush_archive (pq660 q660, plcq q)
     }
 
     storeseedhdr (&(p), (pvoid)&(parc->hdr_buf), q->pack_class == PKC_DATA) ; /* make sure is current */
-    q660->miniseed_call.context = q660 ;
-    memcpy(&(q660->miniseed_call.station_name), &(q660->station_ident), sizeof(string9)) ;
-    strcpy(q660->miniseed_call.location, q->slocation) ;
-    strcpy(q660->miniseed_call.channel, q->sseedname) ;
-    q660->miniseed_call.chan_number = q->lcq_num ;
-    q660->miniseed_call.rate = q->rate ;
-    q660->miniseed_call.filter_bits = parc->amini_filter ;
-    q660->miniseed_call.packet_class = q->pack_class ;
+    pmini->context = q660 ;
+    memcpy(&(pmini->station_name), &(q660->station_ident), sizeof(string9)) ;
+    strcpy(pmini->location, q->slocation) ;
+    strcpy(pmini->channel, q->sseedname) ;
+    pmini->chan_number = q->lcq_num ;
+    pmini->rate = q->rate ;
+    pmini->filter_bits = parc->amini_filter ;
+    pmini->packet_class = q->pack_class ;
+    stat_lock (q660) ;
 
     if (parc->existing_record)
         if (parc->appended) {
             (parc->records_overwritten_session)++ ;
 
             if (parc->leave_in_buffer)
-                q660->miniseed_call.miniseed_action = MSA_INC ; /* middle of increments */
+                pmini->miniseed_action = MSA_INC ; /* middle of increments */
             else
-                q660->miniseed_call.miniseed_action = MSA_FINAL ; /* last increment */
+                pmini->miniseed_action = MSA_FINAL ; /* last increment */
         } else {
             /* client is up to date, leave alone */
+            stat_unlock (q660) ;
             parc->leave_in_buffer = FALSE ;
             clear_archive (parc, q660->arc_size) ;
             return ;
@@ -103,17 +212,18 @@ void flush_archive (pq660 q660, plcq q)
         (parc->records_written_session)++ ;
 
         if (parc->leave_in_buffer)
-            q660->miniseed_call.miniseed_action = MSA_FIRST ; /* incremental new record */
+            pmini->miniseed_action = MSA_FIRST ; /* incremental new record */
         else
-            q660->miniseed_call.miniseed_action = MSA_ARC ; /* non-incremental new record */
+            pmini->miniseed_action = MSA_ARC ; /* non-incremental new record */
     }
 
     parc->last_updated = secsince () ;
-    q660->miniseed_call.data_size = q660->arc_size ;
-    q660->miniseed_call.data_address = parc->pcfr ;
+    stat_unlock (q660) ;
+    pmini->data_size = q660->arc_size ;
+    pmini->data_address = parc->pcfr ;
 
     if (q660->par_create.call_aminidata)
-        q660->par_create.call_aminidata (&(q660->miniseed_call)) ;
+        arc_callback (q660, pmini) ;
 
     if (parc->leave_in_buffer)
         parc->existing_record = TRUE ; /* has been sent to client once */
@@ -124,7 +234,8 @@ void flush_archive (pq660 q660, plcq q)
     parc->appended = FALSE ; /* client is up to date */
 }
 
-void archive_512_record (pq660 q660, plcq q, pcompressed_buffer_ring pbuf)
+static void arc_assemble (pq660 q660, plcq q, pcompressed_buffer_ring pbuf,
+                         tminiseed_call *pmini, int blockette_index)
 {
     double drate, tdiff ;
     int fcnt, bcnt, dbcnt, i ;
@@ -154,7 +265,7 @@ void archive_512_record (pq660 q660, plcq q, pcompressed_buffer_ring pbuf)
 
             if (((bcnt + fcnt + parc->total_frames) > q660->arc_frames) || (fabs(tdiff) > q->gap_secs))
                 /* won't fit or time gap */
-                flush_archive (q660, q) ;
+                arc_flush (q660, q, pmini) ;
         }
 
         psrc = (pointer)((PNTRINT)&(pbuf->rec) + FRAME_SIZE) ;
@@ -223,17 +334,16 @@ void archive_512_record (pq660 q660, plcq q, pcompressed_buffer_ring pbuf)
             memcpy (pdest, psrc, 4) ; /* update last sample value */
 
             if (parc->total_frames >= q660->arc_frames)
-                flush_archive (q660, q) ; /* totally full dude */
+                arc_flush (q660, q, pmini) ; /* totally full dude */
             else if (parc->incremental) {
                 parc->leave_in_buffer = TRUE ;
-                flush_archive (q660, q) ; /* write update to record, don't clear */
+                arc_flush (q660, q, pmini) ; /* write update to record, don't clear */
             }
         } else {
             /* new record */
             memcpy(&(parc->hdr_buf), &(pbuf->hdr_buf), sizeof(seed_header)) ; /* copy header */
             parc->hdr_buf.dob.rec_length = q660->par_create.amini_exponent ;
-            parc->hdr_buf.sequence.seed_num = parc->records_written + 1 ;
-            (parc->records_written)++ ;
+            parc->hdr_buf.sequence.seed_num = next_sequence (q660, parc) ;
             psrc = (pointer)((PNTRINT)&(pbuf->rec) + FRAME_SIZE) ;
             pdest = (pointer)((PNTRINT)parc->pcfr + FRAME_SIZE) ;
 
@@ -246,7 +356,7 @@ void archive_512_record (pq660 q660, plcq q, pcompressed_buffer_ring pbuf)
 
             if (parc->incremental) {
                 parc->leave_in_buffer = TRUE ;
-                flush_archive (q660, q) ; /* write new record, but don't clear */
+                arc_flush (q660, q, pmini) ; /* write new record, but don't clear */
             }
         }
 
@@ -259,7 +369,7 @@ void archive_512_record (pq660 q660, plcq q, pcompressed_buffer_ring pbuf)
         if (((pbuf->hdr_buf.samples_in_record + parc->hdr_buf.samples_in_record) > (q660->arc_size - NONDATA_OVERHEAD)) ||
                 (pbuf->hdr_buf.starting_time.seed_fpt > (parc->hdr_buf.starting_time.seed_fpt + 60)))
             /* won't fit or not the same time */
-            flush_archive (q660, q) ;
+            arc_flush (q660, q, pmini) ;
 
         psrc = (pointer)((PNTRINT)&(pbuf->rec) + NONDATA_OVERHEAD) ;
         pdest = (pointer)((PNTRINT)parc->pcfr + NONDATA_OVERHEAD + parc->hdr_buf.samples_in_record) ;
@@ -269,8 +379,7 @@ void archive_512_record (pq660 q660, plcq q, pcompressed_buffer_ring pbuf)
             memcpy(&(parc->hdr_buf), &(pbuf->hdr_buf), sizeof(seed_header)) ; /* copy header */
             parc->hdr_buf.dob.rec_length = q660->par_create.amini_exponent ;
             parc->hdr_buf.samples_in_record = 0 ; /* don't count first record twice! */
-            parc->hdr_buf.sequence.seed_num = parc->records_written + 1 ;
-            (parc->records_written)++ ;
+            parc->hdr_buf.sequence.seed_num = next_sequence (q660, parc) ;
             parc->appended = FALSE ;
             parc->existing_record = FALSE ;
         }
@@ -282,13 +391,13 @@ void archive_512_record (pq660 q660, plcq q, pcompressed_buffer_ring pbuf)
 
     case PKC_TIMING : /* Note: incoming will only have one blockette */
         if ((TIMING_BLOCKETTE_SIZE + parc->total_frames) > q660->arc_size)
-            flush_archive (q660, q) ; /* new one won't fit */
+            arc_flush (q660, q, pmini) ; /* new one won't fit */
 
         if (parc->total_frames > 0) {
             if ((lib_round(pbuf->hdr_buf.starting_time.seed_fpt) / 3600) !=
                     (lib_round(parc->hdr_buf.starting_time.seed_fpt) / 3600))
 
-                flush_archive (q660, q) ; /* different hour, start new record */
+                arc_flush (q660, q, pmini) ; /* different hour, start new record */
         }
 
         psrc = (pointer)((PNTRINT)&(pbuf->rec) + NONDATA_OVERHEAD) ;
@@ -306,8 +415,7 @@ void archive_512_record (pq660 q660, plcq q, pcompressed_buffer_ring pbuf)
             /* new record */
             memcpy(&(parc->hdr_buf), &(pbuf->hdr_buf), sizeof(seed_header)) ; /* copy header */
             parc->hdr_buf.dob.rec_length = q660->par_create.amini_exponent ;
-            parc->hdr_buf.sequence.seed_num = parc->records_written + 1 ;
-            (parc->records_written)++ ;
+            parc->hdr_buf.sequence.seed_num = next_sequence (q660, parc) ;
             pdest = (pointer)((PNTRINT)parc->pcfr + NONDATA_OVERHEAD) ;
             memcpy (pdest, psrc, TIMING_BLOCKETTE_SIZE) ;
             parc->total_frames = NONDATA_OVERHEAD + TIMING_BLOCKETTE_SIZE ;
@@ -323,16 +431,16 @@ void archive_512_record (pq660 q660, plcq q, pcompressed_buffer_ring pbuf)
         if (bcnt == 0)
             return ; /* nothing to do */
 
-        size = q->com->blockette_index - NONDATA_OVERHEAD ; /* always a multiple of 4 bytes */
+        size = blockette_index - NONDATA_OVERHEAD ; /* always a multiple of 4 bytes */
 
         if ((size + parc->total_frames) > q660->arc_size)
-            flush_archive (q660, q) ; /* new one won't fit or must preserve time */
+            arc_flush (q660, q, pmini) ; /* new one won't fit or must preserve time */
 
         if (parc->total_frames > 0) {
             if ((lib_round(pbuf->hdr_buf.starting_time.seed_fpt) / 3600) !=
                     (lib_round(parc->hdr_buf.starting_time.seed_fpt) / 3600))
 
-                flush_archive (q660, q) ; /* different hour, start new record */
+                arc_flush (q660, q, pmini) ; /* different hour, start new record */
         }
 
         psrc = (pointer)((PNTRINT)&(pbuf->rec) + NONDATA_OVERHEAD) ;
@@ -341,11 +449,10 @@ void archive_512_record (pq660 q660, plcq q, pcompressed_buffer_ring pbuf)
             /* new record */
             memcpy(&(parc->hdr_buf), &(pbuf->hdr_buf), sizeof(seed_header)) ; /* copy header */
             parc->hdr_buf.dob.rec_length = q660->par_create.amini_exponent ;
-            parc->hdr_buf.sequence.seed_num = parc->records_written + 1 ;
-            (parc->records_written)++ ;
+            parc->hdr_buf.sequence.seed_num = next_sequence (q660, parc) ;
             pdest = (pointer)((PNTRINT)parc->pcfr + NONDATA_OVERHEAD) ;
             memcpy (pdest, psrc, size) ; /* copy blockettes in as they are */
-            parc->total_frames = q->com->blockette_index ;
+            parc->total_frames = blockette_index ;
             parc->appended = TRUE ;
             parc->existing_record = FALSE ;
         } else {
@@ -389,6 +496,296 @@ void archive_512_record (pq660 q660, plcq q, pcompressed_buffer_ring pbuf)
     }
 }
 
+#ifdef ARC_POOL
+static void wake_worker (tarcworker *w)
+{
+
+    pthread_mutex_lock (&(w->mutex)) ;
+    pthread_cond_broadcast (&(w->cond)) ;
+    pthread_mutex_unlock (&(w->mutex)) ;
+}
+
+static void *arcthread (pointer p)
+{
+    tarcworker *w ;
+    tarcjob *job ;
+    U32 tail ;
+
+    w = p ;
+    tail = w->tail ;
+
+    while (TRUE) {
+        if (__atomic_load_n (&(w->head), __ATOMIC_SEQ_CST) == tail) {
+            /* nothing to do, sleep until a job is queued */
+            pthread_mutex_lock (&(w->mutex)) ;
+            __atomic_store_n (&(w->idle), TRUE, __ATOMIC_SEQ_CST) ;
+
+            while ((__atomic_load_n (&(w->head), __ATOMIC_SEQ_CST) == tail) && (! w->terminate))
+                pthread_cond_wait (&(w->cond), &(w->mutex)) ;
+
+            __atomic_store_n (&(w->idle), FALSE, __ATOMIC_SEQ_CST) ;
+            pthread_mutex_unlock (&(w->mutex)) ;
+
+            if (__atomic_load_n (&(w->head), __ATOMIC_SEQ_CST) == tail)
+                break ; /* terminated and nothing left */
+
+            continue ;
+        }
+
+        job = &(w->jobs[tail & (ARC_QUEUE_SIZE - 1)]) ;
+
+        if (job->kind == ARJ_RECORD)
+            arc_assemble (w->q660, job->q, &(job->ring), &(w->miniseed_call), job->blockette_index) ;
+        else
+            arc_flush (w->q660, job->q, &(w->miniseed_call)) ;
+
+        tail++ ;
+        __atomic_store_n (&(w->tail), tail, __ATOMIC_SEQ_CST) ;
+
+        if (__atomic_load_n (&(w->waiting), __ATOMIC_SEQ_CST))
+            wake_worker (w) ; /* library thread is waiting for space or sync */
+    }
+
+    return NIL ;
+}
+
+/* Wait until no more than limit jobs are queued for worker */
+static void wait_worker (tarcworker *w, U32 limit)
+{
+
+    if ((w->head - __atomic_load_n (&(w->tail), __ATOMIC_SEQ_CST)) <= limit)
+        return ;
+
+    pthread_mutex_lock (&(w->mutex)) ;
+    __atomic_store_n (&(w->waiting), TRUE, __ATOMIC_SEQ_CST) ;
+
+    while ((w->head - __atomic_load_n (&(w->tail), __ATOMIC_SEQ_CST)) > limit)
+        pthread_cond_wait (&(w->cond), &(w->mutex)) ;
+
+    __atomic_store_n (&(w->waiting), FALSE, __ATOMIC_SEQ_CST) ;
+    pthread_mutex_unlock (&(w->mutex)) ;
+}
+
+static void archive_start (pq660 q660)
+{
+    tarcpool *pool ;
+    tarcworker *w ;
+    int i, count ;
+
+    count = (int)sysconf(_SC_NPROCESSORS_ONLN) - 1 ; /* leave one for the library thread */
+
+    if (count > ARC_MAX_WORKERS)
+        count = ARC_MAX_WORKERS ;
+
+    if (count < 1)
+        count = 1 ;
+
+    pool = malloc (sizeof(tarcpool)) ;
+
+    if (pool == NIL)
+        return ; /* assemble in library thread */
+
+    memset (pool, 0, sizeof(tarcpool)) ;
+    pthread_mutex_init (&(pool->callback_mutex), NULL) ;
+    pthread_mutex_init (&(pool->stat_mutex), NULL) ;
+
+    for (i = 0 ; i < count ; i++) {
+        w = malloc (sizeof(tarcworker)) ;
+
+        if (w == NIL)
+            break ;
+
+        memset (w, 0, sizeof(tarcworker)) ;
+        w->q660 = q660 ;
+        pthread_mutex_init (&(w->mutex), NULL) ;
+        pthread_cond_init (&(w->cond), NULL) ;
+
+        if (pthread_create (&(w->threadid), NULL, arcthread, w)) {
+            pthread_cond_destroy (&(w->cond)) ;
+            pthread_mutex_destroy (&(w->mutex)) ;
+            free (w) ;
+            break ;
+        }
+
+        pool->workers[i] = w ;
+        pool->count = i + 1 ;
+    }
+
+    if (pool->count == 0) {
+        pthread_mutex_destroy (&(pool->callback_mutex)) ;
+        pthread_mutex_destroy (&(pool->stat_mutex)) ;
+        free (pool) ;
+        return ;
+    }
+
+    __atomic_store_n (&(q660->arcpool), pool, __ATOMIC_RELEASE) ; /* read by archive_lock */
+}
+
+/* Reserve the next job for this LCQ's worker, call put_job when filled in */
+static tarcjob *get_job (pq660 q660, plcq q, tarcworker **pw)
+{
+    tarcpool *pool ;
+    tarcworker *w ;
+
+    pool = q660->arcpool ;
+    w = pool->workers[q->lcq_num % pool->count] ;
+    wait_worker (w, ARC_QUEUE_SIZE - 1) ; /* wait for a free slot */
+    *pw = w ;
+    return &(w->jobs[w->head & (ARC_QUEUE_SIZE - 1)]) ;
+}
+
+static void put_job (tarcworker *w)
+{
+
+    __atomic_store_n (&(w->head), w->head + 1, __ATOMIC_SEQ_CST) ;
+
+    if (__atomic_load_n (&(w->idle), __ATOMIC_SEQ_CST))
+        wake_worker (w) ;
+}
+
+/* Wait until workers have processed all queued jobs, the archive state of
+   every LCQ is then current and may be read or changed by the library thread */
+void archive_sync (pq660 q660)
+{
+    tarcpool *pool ;
+    int i ;
+
+    pool = q660->arcpool ;
+
+    if (pool == NIL)
+        return ;
+
+    for (i = 0 ; i < pool->count ; i++)
+        wait_worker (pool->workers[i], 0) ;
+}
+
+/* Process all queued jobs and stop the workers */
+void archive_stop (pq660 q660)
+{
+    tarcpool *pool ;
+    tarcworker *w ;
+    int i ;
+
+    pool = q660->arcpool ;
+
+    if (pool == NIL)
+        return ;
+
+    for (i = 0 ; i < pool->count ; i++) {
+        w = pool->workers[i] ;
+        pthread_mutex_lock (&(w->mutex)) ;
+        w->terminate = TRUE ;
+        pthread_cond_broadcast (&(w->cond)) ;
+        pthread_mutex_unlock (&(w->mutex)) ;
+        pthread_join (w->threadid, NULL) ;
+        pthread_cond_destroy (&(w->cond)) ;
+        pthread_mutex_destroy (&(w->mutex)) ;
+        free (w) ;
+    }
+
+    q660->arcpool = NIL ;
+    pthread_mutex_destroy (&(pool->callback_mutex)) ;
+    pthread_mutex_destroy (&(pool->stat_mutex)) ;
+    free (pool) ;
+}
+
+/* Lock the archive status of the LCQs against updates by the workers, for
+   a thread other than the library thread. Returns the value to pass to
+   archive_unlock, since the workers may start in between */
+pointer archive_lock (pq660 q660)
+{
+    tarcpool *pool ;
+
+    pool = __atomic_load_n (&(q660->arcpool), __ATOMIC_ACQUIRE) ;
+
+    if (pool)
+        pthread_mutex_lock (&(pool->stat_mutex)) ;
+
+    return pool ;
+}
+
+void archive_unlock (pointer lock)
+{
+    tarcpool *pool ;
+
+    pool = lock ;
+
+    if (pool)
+        pthread_mutex_unlock (&(pool->stat_mutex)) ;
+}
+
+#else
+
+pointer archive_lock (pq660 q660)
+{
+    return NIL ;
+}
+
+void archive_unlock (pointer lock)
+{
+}
+
+void archive_sync (pq660 q660)
+{
+}
+
+void archive_stop (pq660 q660)
+{
+}
+
+#endif
+
+void flush_archive (pq660 q660, plcq q)
+{
+#ifdef ARC_POOL
+    tarcworker *w ;
+    tarcjob *job ;
+
+    if (q660->arcpool) {
+        job = get_job (q660, q, &(w)) ;
+        job->kind = ARJ_FLUSH ;
+        job->q = q ;
+        put_job (w) ;
+        return ;
+    }
+
+#endif
+    arc_flush (q660, q, &(q660->miniseed_call)) ;
+}
+
+void archive_512_record (pq660 q660, plcq q, pcompressed_buffer_ring pbuf)
+{
+    int blockette_index ;
+#ifdef ARC_POOL
+    tarcworker *w ;
+    tarcjob *job ;
+#endif
+
+    blockette_index = 0 ;
+
+    if (q->pack_class == PKC_OPAQUE)
+        blockette_index = q->com->blockette_index ;
+
+#ifdef ARC_POOL
+
+    if (q660->arcpool == NIL)
+        archive_start (q660) ;
+
+    if (q660->arcpool) {
+        job = get_job (q660, q, &(w)) ;
+        job->kind = ARJ_RECORD ;
+        job->q = q ;
+        job->blockette_index = blockette_index ;
+        memcpy (&(job->ring.hdr_buf), &(pbuf->hdr_buf), sizeof(seed_header)) ;
+        memcpy (&(job->ring.rec), &(pbuf->rec), LIB_REC_SIZE) ;
+        put_job (w) ;
+        return ;
+    }
+
+#endif
+    arc_assemble (q660, q, pbuf, &(q660->miniseed_call), blockette_index) ;
+}
+
 /* ask the client for the last record. If onelcq is NIL then read all normal or dp lcqs
   based on the from660 flag, else read that one lcq */
 void preload_archive (pq660 q660, BOOLEAN from660, plcq onelcq)
@@ -398,6 +795,8 @@ void preload_archive (pq660 q660, BOOLEAN from660, plcq onelcq)
     int fcnt ;
     tarc *parc ;
 
+    archive_sync (q660) ; /* archive state must be current */
+
     if (onelcq)
         q = onelcq ;
     else if (from660)
@@ -29,18 +29,30 @@ Edit History:
     0 2017-06-07 rdr Created
     1 2021-12-24 rdr Copyright assignment to Kinemetrics.
 ------2022-02-24 jms remove pseudo-pascal macros------
+    2 2026-10-19     Add archive worker pool.
+    3 2026-10-19     Add archive_lock and archive_unlock.
 */
 #ifndef libarchive_h
 /* Flag this file as included */
 #define libarchive_h
-#define VER_LIBARCHIVE 1
+#define VER_LIBARCHIVE 2
 
 #include "libtypes.h"
 #include "libsampglob.h"
 #include "libstrucs.h"
 
+#ifndef X86_WIN32
+#define ARC_POOL /* assemble archival records on worker threads */
+#define ARC_MAX_WORKERS 4 /* most archive worker threads */
+#define ARC_QUEUE_SIZE 256 /* records queued per worker, must be power of 2 */
+#endif
+
 extern void flush_archive (pq660 q660, plcq q) ;
 extern void archive_512_record (pq660 q660, plcq q, pcompressed_buffer_ring pbuf) ;
 extern void preload_archive (pq660 q660, BOOLEAN from660, plcq onelcq) ;
+extern void archive_sync (pq660 q660) ;
+extern void archive_stop (pq660 q660) ;
+extern pointer archive_lock (pq660 q660) ;
+extern void archive_unlock (pointer lock) ;
 
 #endif
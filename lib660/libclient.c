@@ -37,6 +37,7 @@ Edit History:
     6 2021-04-04 rdr Add Dust status handling.
     7 2021-12-24 rdr Copyright assignment to Kinemetrics.
 ------2022-02-24 jms remove pseudo-pascal macros------
+    8 2026-10-19     Add lib_trace_call.
 */
 #include "libstrucs.h"
 #include "libmsgs.h"
@@ -61,6 +62,8 @@ Edit History:
 #include "libarchive.h"
 #include "libdata.h"
 
+tcall_trace lib_trace_call = NULL ; /* Set by the host to trace the data path */
+
 void lib_create_context (tcontext *ct, tpar_create *cfg) /* If ct = NIL return, check resp_err */
 {
 
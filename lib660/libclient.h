@@ -31,12 +31,14 @@ Edit History:
 ------2022-02-24 jms remove pseudo-pascal macros------
     2 2022-03-01 jms implement throttle (V1 only) and BSL options. 
     3 2022-04-01 jms added BW fill    
+    4 2026-10-19     Add chan_number to tlowlat_call.
+    5 2026-10-19     Add lib_trace_call for tracing of the data path.
 }
 */
 #ifndef libclient_h
 /* Flag this file as included */
 #define libclient_h
-#define VER_LIBCLIENT 9
+#define VER_LIBCLIENT 10
 
 #include "utiltypes.h"
 #include "readpackets.h"
@@ -205,7 +207,9 @@ typedef struct   /* For low latency callback */
     U16 sample_count ; /* Number of samples */
     int rate ; /* sampling rate */
     U32 reserved ; /* must be zero */
-    U32 reserved2 ;
+    U8 chan_number ; /* channel number according to tokens, same as for miniseed */
+    U8 spare ;
+    U16 reserved2 ;
     double timestamp ; /* Time of data, corrected for any filtering */
     U16 qual_perc ; /* time quality percentage */
     U16 activity_flags ; /* same as in Miniseed */
@@ -216,6 +220,11 @@ typedef struct   /* For low latency callback */
     I32 samples[MAX_RATE] ; /* decompressed samples */
 } tlowlat_call ;
 typedef tlowlat_call tonesec_call ; /* Same for one second data */
+/* Data path trace points, passed to lib_trace_call if it is set */
+#define LIBTRACE_RECEIVE 0 /* data packet received from the Q660 */
+#define LIBTRACE_DECOMPRESS 1 /* data blockette decompressed */
+#define LIBTRACE_FINISH 2 /* miniseed record finished */
+typedef void (*tcall_trace)(int stage) ;
 
 enum tminiseed_action
 {MSA_512, /* new 512 byte packet */
@@ -379,6 +388,7 @@ extern void lib_change_enable (tcontext ct, tdetchange *detchange) ;
 extern enum tliberr lib_get_dpcfg (tcontext ct, tdpcfg *dpcfg) ;
 extern void lib_msg_add (tcontext ct, U16 msgcode, U32 dt, pchar msgsuf) ;
 extern pmodules lib_get_modules (void) ;
+extern tcall_trace lib_trace_call ; /* NULL unless tracing the data path */
 extern enum tliberr lib_conntiming (tcontext ct, tconntiming *conntiming, BOOLEAN setter) ;
 extern I32 lib_crccalc (PU8 p, I32 len) ;
 extern enum tliberr lib_set_freeze_timer (tcontext ct, int seconds) ;
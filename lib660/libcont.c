@@ -30,6 +30,7 @@ Edit History:
     1 2021-01-06 jms omit admin DP channels on IDL
     2 2021-12-24 rdr Copyright assignment to Kinemetrics.
 ------2022-02-24 jms remove pseudo-pascal macros------
+    3 2026-10-19     Wait for archive workers before saving continuity.
 */
 #ifndef libcont_h
 #include "libcont.h"
@@ -43,6 +44,7 @@ Edit History:
 #include "libsampglob.h"
 #include "libsampcfg.h"
 #include "libdetect.h"
+#include "libarchive.h"
 
 #define OMITADMINCHANNELSONIDL
 
@@ -255,6 +257,8 @@ void save_thread_continuity (pq660 q660)
     string fname ;
     int good, value ;
 
+    archive_sync (q660) ; /* archive sequence numbers must be current */
+
     if (q660->q660cont_updated)
         write_q660_cont (q660) ; /* write cache to disk */
 
@@ -472,6 +476,7 @@ void save_continuity (pq660 q660)
     tcont_cache *freec ;
     string fname ;
 
+    archive_sync (q660) ; /* archive sequence numbers must be current */
     freec = q660->contfree ;
 
     if (freec) {
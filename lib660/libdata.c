@@ -41,6 +41,7 @@ Edit History:
     9 2021-12-24 rdr Copyright assignment to Kinemetrics.
 ------2022-02-24 jms remove pseudo-pascal macros------
    10 2022-03-01 jms use dust embedded timestamp
+   11 2026-10-19     Trace point for received data packets.
 */
 #include "libdata.h"
 #include "libclient.h"
@@ -105,6 +106,8 @@ void process_data (pq660 q660, PU8 p, int lth)
     U8 b1, b2, dev ;
     PU8 starts[100] ; /* Just used for debugging */
 
+    if (lib_trace_call)
+        lib_trace_call (LIBTRACE_RECEIVE) ;
     seqgap_occurred = FALSE ;
     loops = 0 ;
     bufend = (PNTRINT)p + (PNTRINT)lth ;
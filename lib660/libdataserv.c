@@ -34,6 +34,13 @@ Edit History:
     4 2021-12-11 jms prevent segfault when low_latency callback not defined.
     5 2021-12-24 rdr Copyright assignment to Kinemetrics.
 ------2022-02-24 jms remove pseudo-pascal macros------
+    6 2026-10-19     Allow up to MAX_DS_CLIENTS clients, each with its own queue
+                     pointer. Send all queued records with one sendmsg and keep
+                     the rest of a partly sent record. Wake the thread with an
+                     eventfd (pipe on other Unix) instead of polling. Only copy
+                     total_size bytes of each record. Detect client close in
+                     read_from_client.
+    7 2026-10-19     Set chan_number in low latency callback.
 */
 #include "libdataserv.h"
 #include "libmsgs.h"
@@ -41,6 +48,39 @@ Edit History:
 #include "libsupport.h"
 #include "libstrucs.h"
 #include "libcompress.h"
+#ifndef X86_WIN32
+#include <sys/uio.h>
+#if defined(linux)
+#include <sys/eventfd.h>
+#endif
+#endif
+
+#ifdef X86_WIN32
+#define DS_IOV_MAX 1 /* one record per send */
+typedef struct
+{
+    pvoid iov_base ;
+    size_t iov_len ;
+} tiovec ;
+#else
+#define DS_IOV_MAX 64 /* records passed to one sendmsg */
+typedef struct iovec tiovec ;
+#endif
+
+typedef struct
+{
+#ifdef X86_WIN32
+    SOCKET sockpath ;
+#else
+    int sockpath ;
+#endif
+    BOOLEAN sockfull ; /* last send would block */
+    int dsq_out ; /* next record to send to this client */
+    int part_lth ; /* bytes of a partly sent record not sent yet */
+    int part_offset ; /* offset of those bytes in part */
+    U8 part[sizeof(tlowlat_call)] ; /* rest of partly sent record */
+} tdsclient ;
+typedef tdsclient *pdsclient ;
 
 typedef struct
 {
@@ -53,22 +93,23 @@ typedef struct
     pthread_t threadid ;
 #endif
     BOOLEAN running ;
-    BOOLEAN haveclient ; /* accepted a client */
     BOOLEAN sockopen ;
-    BOOLEAN sockfull ; /* last send failed */
     BOOLEAN terminate ;
     tds_par ds_par ; /* creation parameters */
 #ifdef X86_WIN32
     SOCKET dpath ; /* dataserv socket */
     struct sockaddr dsockin ; /* dataserv address descriptors */
-    SOCKET sockpath ;
 #else
     int dpath ; /* commands socket */
     struct sockaddr dsockin ; /* dataserv address descriptors */
-    int sockpath ;
-    int high_socket ;
-#endif
-    int dsq_in, dsq_out ;
+    int wake_read ; /* eventfd or pipe used to wake dsthread */
+    int wake_write ;
+    BOOLEAN wake_pending ; /* wakeup written and not read yet */
+#endif
+    int client_count ;
+    tdsclient clients[MAX_DS_CLIENTS] ;
+    int dsq_in ;
+    int dsq_out ; /* oldest record kept for the next client while none connected */
     double last_sent ;
 } tdsstr ;
 typedef tdsstr *pdsstr ;
@@ -124,10 +165,114 @@ static void qunlock (pdsstr dsstr)
     pthread_mutex_unlock (&(dsstr->mutex)) ;
 }
 
+/* The data thread sleeps in select until a client socket is ready or
+   lib_ds_send writes to the wakeup descriptor */
+static void open_wakeup (pdsstr dsstr)
+{
+#if defined(linux)
+
+    dsstr->wake_read = eventfd (0, EFD_NONBLOCK) ;
+    dsstr->wake_write = dsstr->wake_read ;
+#else
+    int fds[2] ;
+    int flag ;
+
+    dsstr->wake_read = INVALID_SOCKET ;
+    dsstr->wake_write = INVALID_SOCKET ;
+
+    if (pipe (fds) == 0) {
+        flag = fcntl (fds[0], F_GETFL, 0) ;
+        fcntl (fds[0], F_SETFL, flag | O_NONBLOCK) ;
+        flag = fcntl (fds[1], F_GETFL, 0) ;
+        fcntl (fds[1], F_SETFL, flag | O_NONBLOCK) ;
+        dsstr->wake_read = fds[0] ;
+        dsstr->wake_write = fds[1] ;
+    }
+
+#endif
+}
+
+static void close_wakeup (pdsstr dsstr)
+{
+
+    if (dsstr->wake_write != dsstr->wake_read)
+        close (dsstr->wake_write) ;
+
+    if (dsstr->wake_read != INVALID_SOCKET)
+        close (dsstr->wake_read) ;
+
+    dsstr->wake_read = INVALID_SOCKET ;
+    dsstr->wake_write = INVALID_SOCKET ;
+}
+
+/* must be called with queue locked */
+static void signal_wakeup (pdsstr dsstr)
+{
+    uint64_t one ;
+
+    if ((dsstr->wake_pending) || (dsstr->wake_write == INVALID_SOCKET))
+        return ;
+
+    one = 1 ;
+
+    if (write (dsstr->wake_write, &(one), sizeof(one)) > 0)
+        dsstr->wake_pending = TRUE ;
+}
+
+/* must be called with queue locked */
+static void clear_wakeup (pdsstr dsstr)
+{
+    uint64_t buf[8] ;
+
+    while (read (dsstr->wake_read, &(buf), sizeof(buf)) > 0) ;
+
+    dsstr->wake_pending = FALSE ;
+}
+
+#endif
+
+static int wrap_buffer (int max, int i)
+{
+    int j ;
+
+    j = i + 1 ;
+
+    if (j >= max)
+        j = 0 ;
+
+    return j ;
+}
+
+/* must be called with queue locked */
+static void close_client (pdsstr dsstr, pdsclient pc, BOOLEAN report)
+{
+    string63 s ;
+
+    if (pc->sockpath == INVALID_SOCKET)
+        return ;
+
+#ifdef X86_WIN32
+    closesocket (pc->sockpath) ;
+#else
+    close (pc->sockpath) ;
 #endif
+    pc->sockpath = INVALID_SOCKET ;
+    pc->sockfull = FALSE ;
+    pc->part_lth = 0 ;
+    (dsstr->client_count)-- ;
+
+    if (dsstr->client_count == 0)
+        dsstr->dsq_out = pc->dsq_out ; /* keep what this client didn't get for the next one */
+
+    if (report) {
+        sprintf(s, "dataserv[%d] port", dsstr->ds_par.server_number) ;
+        lib_msg_add(dsstr->ds_par.stnctx, AUXMSG_DISCON, 0, s) ;
+    }
+}
 
 static void close_socket (pdsstr dsstr)
 {
+    int i ;
 
     dsstr->sockopen = FALSE ;
 
@@ -140,18 +285,8 @@ static void close_socket (pdsstr dsstr)
         dsstr->dpath = INVALID_SOCKET ;
     }
 
-    if (dsstr->sockpath != INVALID_SOCKET) {
-#ifdef X86_WIN32
-        closesocket (dsstr->sockpath) ;
-#else
-        close (dsstr->sockpath) ;
-#endif
-        dsstr->sockpath = INVALID_SOCKET ;
-    }
-
-#ifndef X86_WIN32
-    dsstr->high_socket = 0 ;
-#endif
+    for (i = 0 ; i < MAX_DS_CLIENTS ; i++)
+        close_client (dsstr, &(dsstr->clients[i]), FALSE) ;
 }
 
 static void open_socket (pdsstr dsstr)
@@ -185,12 +320,6 @@ static void open_socket (pdsstr dsstr)
         return ;
     }
 
-#ifndef X86_WIN32
-
-    if (dsstr->dpath > dsstr->high_socket)
-        dsstr->high_socket = dsstr->dpath ;
-
-#endif
     psock = (pointer) &(dsstr->dsockin) ;
     memset(psock, 0, sizeof(struct sockaddr)) ;
     psock->sin_family = AF_INET ;
@@ -255,11 +384,11 @@ static void open_socket (pdsstr dsstr)
     flag = 1 ;
 #ifdef X86_WIN32
     ioctlsocket (dsstr->dpath, FIONBIO, (pvoid)&(flag)) ;
-    err = listen (dsstr->dpath, 1) ;
+    err = listen (dsstr->dpath, MAX_DS_CLIENTS) ;
 #else
     flag = fcntl (dsstr->dpath, F_GETFL, 0) ;
     fcntl (dsstr->dpath, F_SETFL, flag | O_NONBLOCK) ;
-    err = listen (dsstr->dpath, 1) ;
+    err = listen (dsstr->dpath, MAX_DS_CLIENTS) ;
 #endif
 
     if (err) {
@@ -288,7 +417,7 @@ static void open_socket (pdsstr dsstr)
 
 static void accept_ds_socket (pdsstr dsstr)
 {
-    int lth, err, err2 ;
+    int lth, err, err2, i ;
     int flag ;
     int bufsize ;
     U16 client_port ;
@@ -296,6 +425,12 @@ static void accept_ds_socket (pdsstr dsstr)
     string63 s ;
     struct sockaddr_storage tmpsock ;
     struct sockaddr_in *psock ;
+    pdsclient pc ;
+#ifdef X86_WIN32
+    SOCKET path ;
+#else
+    int path ;
+#endif
 #ifndef CBUILDERX
     struct sockaddr_in6 *psock6 ;
     U32 lw6[4] ; /* IPV6 represented as 4 32 bit entries */
@@ -306,13 +441,9 @@ static void accept_ds_socket (pdsstr dsstr)
     if (dsstr->dpath == INVALID_SOCKET)
         return ;
 
-#ifdef X86_WIN32
-    dsstr->sockpath = accept (dsstr->dpath, (pvoid)&(tmpsock), (pvoid)&(lth)) ;
-#else
-    dsstr->sockpath = accept (dsstr->dpath, (pvoid)&(tmpsock), (pvoid)&(lth)) ;
-#endif
+    path = accept (dsstr->dpath, (pvoid)&(tmpsock), (pvoid)&(lth)) ;
 
-    if (dsstr->sockpath == INVALID_SOCKET) {
+    if (path == INVALID_SOCKET) {
         err =
 #ifdef X86_WIN32
             WSAGetLastError() ;
@@ -333,14 +464,10 @@ static void accept_ds_socket (pdsstr dsstr)
     } else {
 #ifdef X86_WIN32
         flag = 1 ;
-        ioctlsocket (dsstr->sockpath, FIONBIO, (pvoid)&(flag)) ;
+        ioctlsocket (path, FIONBIO, (pvoid)&(flag)) ;
 #else
-
-        if (dsstr->sockpath > dsstr->high_socket)
-            dsstr->high_socket = dsstr->sockpath ;
-
-        flag = fcntl (dsstr->sockpath, F_GETFL, 0) ;
-        fcntl (dsstr->sockpath, F_SETFL, flag | O_NONBLOCK) ;
+        flag = fcntl (path, F_GETFL, 0) ;
+        fcntl (path, F_SETFL, flag | O_NONBLOCK) ;
 #endif
 
         if (tmpsock.ss_family == AF_INET) {
@@ -367,19 +494,11 @@ static void accept_ds_socket (pdsstr dsstr)
         sprintf(s, "\"%s:%d\" to dataserv[%d] port", hostname, client_port, dsstr->ds_par.server_number) ;
         lib_msg_add (dsstr->ds_par.stnctx, AUXMSG_CONN, 0, s) ;
         lth = sizeof(int) ;
-#ifdef X86_WIN32
-        err = getsockopt (dsstr->sockpath, SOL_SOCKET, SO_SNDBUF, (pvoid)&(bufsize), (pvoid)&(lth)) ;
-#else
-        err = getsockopt (dsstr->sockpath, SOL_SOCKET, SO_SNDBUF, (pvoid)&(bufsize), (pvoid)&(lth)) ;
-#endif
+        err = getsockopt (path, SOL_SOCKET, SO_SNDBUF, (pvoid)&(bufsize), (pvoid)&(lth)) ;
 
         if ((err == 0) && (bufsize < 30000)) {
             bufsize = 30000 ;
-#ifdef X86_WIN32
-            setsockopt (dsstr->sockpath, SOL_SOCKET, SO_SNDBUF, (pvoid)&(bufsize), lth) ;
-#else
-            setsockopt (dsstr->sockpath, SOL_SOCKET, SO_SNDBUF, (pvoid)&(bufsize), lth) ;
-#endif
+            setsockopt (path, SOL_SOCKET, SO_SNDBUF, (pvoid)&(bufsize), lth) ;
         }
 
 #ifndef X86_WIN32
@@ -388,27 +507,42 @@ static void accept_ds_socket (pdsstr dsstr)
 #if defined(linux) || defined(solaris)
         signal (SIGPIPE, SIG_IGN) ;
 #else
-        setsockopt (dsstr->sockpath, SOL_SOCKET, SO_NOSIGPIPE, (pvoid)&(flag), lth) ;
+        setsockopt (path, SOL_SOCKET, SO_NOSIGPIPE, (pvoid)&(flag), lth) ;
 #endif
 #endif
-        dsstr->haveclient = TRUE ;
+        qlock (dsstr) ;
+
+        for (i = 0 ; i < MAX_DS_CLIENTS ; i++)
+            if (dsstr->clients[i].sockpath == INVALID_SOCKET)
+                break ;
+
+        pc = &(dsstr->clients[i]) ;
+        pc->sockpath = path ;
+        pc->sockfull = FALSE ;
+        pc->part_lth = 0 ;
+
+        if (dsstr->client_count == 0)
+            pc->dsq_out = dsstr->dsq_out ; /* first client gets the backlog */
+        else
+            pc->dsq_out = dsstr->dsq_in ; /* others start with new data */
+
+        (dsstr->client_count)++ ;
         dsstr->last_sent = now () ;
-        dsstr->sockfull = FALSE ;
+        qunlock (dsstr) ;
     }
 }
 
-static void read_from_client (pdsstr dsstr)
+static void read_from_client (pdsstr dsstr, pdsclient pc)
 {
 #define RBUFSIZE 100
     int err ;
     U8 buf[RBUFSIZE] ;
-    string63 s ;
 
-    do {
-        if (! dsstr->haveclient)
-            return ;
+    while (TRUE) {
+        err = (int)recv(pc->sockpath, (pvoid)&(buf), RBUFSIZE, 0) ;
 
-        err = (int)recv(dsstr->sockpath, (pvoid)&(buf), RBUFSIZE, 0) ;
+        if (err == 0)
+            break ; /* client closed connection */
 
         if (err == SOCKET_ERROR) {
             err =
@@ -418,109 +552,161 @@ static void read_from_client (pdsstr dsstr)
                 errno ;
 #endif
 
-            if ((err == ECONNRESET) || (err == ECONNABORTED)) {
-#ifdef X86_WIN32
-                closesocket (dsstr->sockpath) ;
-#else
-                close (dsstr->sockpath) ;
-#endif
-                sprintf(s, "dataserv[%d] port", dsstr->ds_par.server_number) ;
-                lib_msg_add(dsstr->ds_par.stnctx, AUXMSG_DISCON, 0, s) ;
-                dsstr->haveclient = FALSE ;
-                dsstr->sockfull = FALSE ;
-                return ;
-            }
-        }
-    } while (! (err == 0)) ; /* nothing left in buffer */
-}
-
-static int wrap_buffer (int max, int i)
-{
-    int j ;
-
-    j = i + 1 ;
+            if ((err == ECONNRESET) || (err == ECONNABORTED))
+                break ;
 
-    if (j >= max)
-        j = 0 ;
+            return ; /* nothing left in buffer */
+        }
+    }
 
-    return j ;
+    qlock (dsstr) ;
+    close_client (dsstr, pc, TRUE) ;
+    qunlock (dsstr) ;
 }
 
-static void send_next_buffer (pdsstr dsstr)
+static int send_client (pdsclient pc, tiovec *iov, int count)
 {
-    int err, lth ;
-    PI32 pl ;
-    string95 s ;
+#ifdef X86_WIN32
 
-    if (! dsstr->haveclient)
-        return ;
+    return (int)send(pc->sockpath, iov[0].iov_base, (int)iov[0].iov_len, 0) ;
+#else
+    struct msghdr msg ;
 
-    pl = (PI32)&((*(dsstr->ds_par.dsbuf))[dsstr->dsq_out]) ;
-    lth = *pl ;
+    memset (&(msg), 0, sizeof(struct msghdr)) ;
+    msg.msg_iov = iov ;
+    msg.msg_iovlen = count ;
 #if defined(linux)
-    err = (int)send(dsstr->sockpath, (pvoid)pl, lth, MSG_NOSIGNAL) ;
+    return (int)sendmsg(pc->sockpath, &(msg), MSG_NOSIGNAL) ;
 #else
-    err = (int)send(dsstr->sockpath, (pvoid)pl, lth, 0) ;
+    return (int)sendmsg(pc->sockpath, &(msg), 0) ;
 #endif
-
-    if (err == SOCKET_ERROR) {
-        err =
-#ifdef X86_WIN32
-            WSAGetLastError() ;
-#else
-            errno ;
 #endif
+}
 
-        if (err == EWOULDBLOCK) {
-            dsstr->sockfull = TRUE ;
-            return ;
+/* Send as much of the client's queue as the socket takes, must be called
+   with queue locked. A record that only partly fits is copied to the
+   client so its ring slot can be reused before the rest is sent. */
+static void flush_client (pdsstr dsstr, pdsclient pc)
+{
+    tiovec iov[DS_IOV_MAX] ;
+    int count, idx, err, sent, total, lth ;
+    PU32 pl ;
+
+    while ((! pc->sockfull) && ((pc->part_lth > 0) || (pc->dsq_out != dsstr->dsq_in))) {
+        count = 0 ;
+        total = 0 ;
+
+        if (pc->part_lth > 0) {
+            iov[0].iov_base = &(pc->part[pc->part_offset]) ;
+            iov[0].iov_len = pc->part_lth ;
+            total = pc->part_lth ;
+            count = 1 ;
+        }
+
+        idx = pc->dsq_out ;
+
+        while ((count < DS_IOV_MAX) && (idx != dsstr->dsq_in)) {
+            pl = (PU32)&((*(dsstr->ds_par.dsbuf))[idx]) ;
+            iov[count].iov_base = (pvoid)pl ;
+            iov[count].iov_len = *pl ;
+            total = total + *pl ;
+            count++ ;
+            idx = wrap_buffer(dsstr->ds_par.record_count, idx) ;
         }
 
+        sent = send_client (pc, iov, count) ;
+
+        if (sent == SOCKET_ERROR) {
+            err =
 #ifdef X86_WIN32
-        else if ((err == ECONNRESET) || (err == ECONNABORTED))
+                WSAGetLastError() ;
 #else
-        else if (err == EPIPE)
+                errno ;
 #endif
 
-        {
-#ifdef X86_WIN32
-            closesocket (dsstr->sockpath) ;
-#else
-            close (dsstr->sockpath) ;
+            if (err == EWOULDBLOCK)
+                pc->sockfull = TRUE ;
+#ifndef X86_WIN32
+            else if (err == EINTR)
+                continue ;
 #endif
-            sprintf(s, "dataserv[%d] port", dsstr->ds_par.server_number) ;
-            lib_msg_add(dsstr->ds_par.stnctx, AUXMSG_DISCON, 0, s) ;
-            dsstr->haveclient = FALSE ;
-            dsstr->sockfull = FALSE ;
+            else
+                close_client (dsstr, pc, TRUE) ;
+
             return ;
         }
-    } else {
-        dsstr->sockfull = FALSE ;
-        dsstr->dsq_out = wrap_buffer(dsstr->ds_par.record_count, dsstr->dsq_out) ;
-    }
 
-    dsstr->last_sent = now () ;
+        dsstr->last_sent = now () ;
+
+        if (sent < total)
+            pc->sockfull = TRUE ; /* wait until socket is writable again */
+
+        if (pc->part_lth > 0) {
+            if (sent < pc->part_lth) {
+                pc->part_offset = pc->part_offset + sent ;
+                pc->part_lth = pc->part_lth - sent ;
+                continue ;
+            }
+
+            sent = sent - pc->part_lth ;
+            pc->part_lth = 0 ;
+        }
+
+        while (sent > 0) {
+            pl = (PU32)&((*(dsstr->ds_par.dsbuf))[pc->dsq_out]) ;
+            lth = *pl ;
+
+            if (sent < lth) {
+                memcpy (&(pc->part), (PU8)pl + sent, lth - sent) ;
+                pc->part_offset = 0 ;
+                pc->part_lth = lth - sent ;
+                sent = 0 ;
+            } else
+                sent = sent - lth ;
+
+            pc->dsq_out = wrap_buffer(dsstr->ds_par.record_count, pc->dsq_out) ;
+        }
+    }
 }
 
 void lib_ds_send (pointer ct, plowlat_call pbuf)
 {
     pdsstr dsstr ;
-    int nq ;
-    BOOLEAN wasempty ;
+    pdsclient pc ;
+    int nq, i ;
 
     dsstr = ct ;
+
+    if ((pbuf->total_size == 0) || (pbuf->total_size > sizeof(tlowlat_call)))
+        return ;
+
     qlock (dsstr) ;
-    wasempty = (dsstr->dsq_in == dsstr->dsq_out) ;
     nq = wrap_buffer (dsstr->ds_par.record_count, dsstr->dsq_in) ; /* next pointer after we insert new record */
 
     if (nq == dsstr->dsq_out)
         dsstr->dsq_out = wrap_buffer(dsstr->ds_par.record_count, dsstr->dsq_out) ; /* throw away oldest */
 
-    memcpy(&((*(dsstr->ds_par.dsbuf))[dsstr->dsq_in]), pbuf, LIB_REC_SIZE) ;
+    for (i = 0 ; i < MAX_DS_CLIENTS ; i++) {
+        pc = &(dsstr->clients[i]) ;
+
+        if ((pc->sockpath != INVALID_SOCKET) && (nq == pc->dsq_out))
+            pc->dsq_out = wrap_buffer(dsstr->ds_par.record_count, pc->dsq_out) ; /* client is behind, throw away its oldest */
+    }
+
+    memcpy(&((*(dsstr->ds_par.dsbuf))[dsstr->dsq_in]), pbuf, pbuf->total_size) ;
     dsstr->dsq_in = nq ;
 
-    if (wasempty)
-        send_next_buffer (dsstr) ;
+    if (dsstr->client_count > 0) {
+#ifdef X86_WIN32
+
+        for (i = 0 ; i < MAX_DS_CLIENTS ; i++)
+            if (dsstr->clients[i].sockpath != INVALID_SOCKET)
+                flush_client (dsstr, &(dsstr->clients[i])) ;
+
+#else
+        signal_wakeup (dsstr) ;
+#endif
+    }
 
     qunlock (dsstr) ;
 }
@@ -532,10 +718,13 @@ void *dsthread (pointer p)
 #endif
 {
     pdsstr dsstr ;
+    pdsclient pc ;
     fd_set readfds, writefds, exceptfds ;
     struct timeval timeout ;
-    int res ;
-    BOOLEAN sent ;
+    int res, i ;
+#ifndef X86_WIN32
+    int high_socket ;
+#endif
 
 #ifndef X86_WIN32
     pthread_detach (pthread_self ()) ;
@@ -544,58 +733,100 @@ void *dsthread (pointer p)
 
     do {
         if (dsstr->sockopen) {
-            /* wait for socket input or timeout */
+            /* wait for new data, socket input or timeout */
             FD_ZERO (&(readfds)) ;
             FD_ZERO (&(writefds)) ;
             FD_ZERO (&(exceptfds)) ;
+#ifndef X86_WIN32
+            high_socket = 0 ;
+
+            if (dsstr->wake_read != INVALID_SOCKET) {
+                FD_SET (dsstr->wake_read, &(readfds)) ;
+                high_socket = dsstr->wake_read ;
+            }
+
+#endif
 
-            if (! dsstr->haveclient)
+            if ((dsstr->dpath != INVALID_SOCKET) && (dsstr->client_count < MAX_DS_CLIENTS)) {
                 FD_SET (dsstr->dpath, &(readfds)) ; /* waiting for accept */
-            else {
-                FD_SET (dsstr->sockpath, &(readfds)) ; /* client might try to send me something */
+#ifndef X86_WIN32
+
+                if (dsstr->dpath > high_socket)
+                    high_socket = dsstr->dpath ;
+
+#endif
+            }
+
+            for (i = 0 ; i < MAX_DS_CLIENTS ; i++) {
+                pc = &(dsstr->clients[i]) ;
+
+                if (pc->sockpath == INVALID_SOCKET)
+                    continue ;
 
-                if (dsstr->sockfull)
-                    FD_SET (dsstr->sockpath, &(writefds)) ; /* buffer was full */
+                FD_SET (pc->sockpath, &(readfds)) ; /* client might try to send me something */
+
+                if (pc->sockfull)
+                    FD_SET (pc->sockpath, &(writefds)) ; /* buffer was full */
+
+#ifndef X86_WIN32
+
+                if (pc->sockpath > high_socket)
+                    high_socket = pc->sockpath ;
+
+#endif
             }
 
+#ifdef X86_WIN32
             timeout.tv_sec = 0 ;
             timeout.tv_usec = 25000 ; /* 25ms timeout */
-#ifdef X86_WIN32
             res = select (0, &(readfds), &(writefds), &(exceptfds), &(timeout)) ;
 #else
-            res = select (dsstr->high_socket + 1, &(readfds), &(writefds), &(exceptfds), &(timeout)) ;
+
+            if (dsstr->wake_read != INVALID_SOCKET) {
+                timeout.tv_sec = 1 ; /* lib_ds_send will wake us */
+                timeout.tv_usec = 0 ;
+            } else {
+                timeout.tv_sec = 0 ;
+                timeout.tv_usec = 25000 ; /* 25ms timeout */
+            }
+
+            res = select (high_socket + 1, &(readfds), &(writefds), &(exceptfds), &(timeout)) ;
 #endif
 
             if (res > 0) {
-                if (FD_ISSET (dsstr->dpath, &(readfds)))
-                    accept_ds_socket (dsstr) ;
-                else if (dsstr->haveclient) {
-                    if (FD_ISSET (dsstr->sockpath, &(readfds)))
-                        read_from_client (dsstr) ;
+#ifndef X86_WIN32
 
-                    if ((dsstr->sockfull) && (FD_ISSET (dsstr->sockpath, &(writefds))))
-                        dsstr->sockfull = FALSE ;
+                if ((dsstr->wake_read != INVALID_SOCKET) && (FD_ISSET (dsstr->wake_read, &(readfds)))) {
+                    qlock (dsstr) ;
+                    clear_wakeup (dsstr) ;
+                    qunlock (dsstr) ;
                 }
-            }
 
-            if (dsstr->haveclient) {
-                sent = FALSE ;
-
-                if (dsstr->sockfull)
-                    sleepms (10) ;
-                else {
-                    qlock (dsstr) ;
+#endif
 
-                    if (dsstr->dsq_in != dsstr->dsq_out) {
-                        sent = TRUE ;
-                        send_next_buffer (dsstr) ;
-                    }
+                for (i = 0 ; i < MAX_DS_CLIENTS ; i++) {
+                    pc = &(dsstr->clients[i]) ;
 
-                    qunlock (dsstr) ;
+                    if ((pc->sockpath != INVALID_SOCKET) && (FD_ISSET (pc->sockpath, &(readfds))))
+                        read_from_client (dsstr, pc) ;
 
-                    if (! sent)
-                        sleepms (10) ;
+                    if ((pc->sockpath != INVALID_SOCKET) && (pc->sockfull) && (FD_ISSET (pc->sockpath, &(writefds))))
+                        pc->sockfull = FALSE ;
                 }
+
+                if ((dsstr->dpath != INVALID_SOCKET) && (FD_ISSET (dsstr->dpath, &(readfds))))
+                    accept_ds_socket (dsstr) ;
+            } else if (res < 0)
+                sleepms (10) ;
+
+            if (dsstr->client_count > 0) {
+                qlock (dsstr) ;
+
+                for (i = 0 ; i < MAX_DS_CLIENTS ; i++)
+                    if (dsstr->clients[i].sockpath != INVALID_SOCKET)
+                        flush_client (dsstr, &(dsstr->clients[i])) ;
+
+                qunlock (dsstr) ;
             }
         } else
             sleepms (25) ;
@@ -613,6 +844,7 @@ void *dsthread (pointer p)
 pointer lib_ds_start (tds_par *dspar)
 {
     pdsstr dsstr ;
+    int i ;
 #ifndef X86_WIN32
     int err ;
     pthread_attr_t attr;
@@ -623,7 +855,10 @@ pointer lib_ds_start (tds_par *dspar)
     memcpy (&(dsstr->ds_par), dspar, sizeof(tds_par)) ;
     create_mutex (dsstr) ;
     dsstr->dpath = INVALID_SOCKET ;
-    dsstr->sockpath = INVALID_SOCKET ;
+
+    for (i = 0 ; i < MAX_DS_CLIENTS ; i++)
+        dsstr->clients[i].sockpath = INVALID_SOCKET ;
+
     open_socket (dsstr) ;
 
     if (! dsstr->sockopen) {
@@ -636,6 +871,7 @@ pointer lib_ds_start (tds_par *dspar)
 
     if (dsstr->threadhandle == NIL)
 #else
+    open_wakeup (dsstr) ;
     err = pthread_attr_init (&(attr)) ;
 
     if (err == 0)
@@ -661,13 +897,23 @@ void lib_ds_stop (pointer ct)
     pdsstr dsstr ;
 
     dsstr = ct ;
+    qlock (dsstr) ;
     dsstr->terminate = TRUE ;
+#ifndef X86_WIN32
+    signal_wakeup (dsstr) ;
+#endif
+    qunlock (dsstr) ;
 
     do {
         sleepms (25) ;
     } while (! (! dsstr->running)) ;
 
+    qlock (dsstr) ;
     close_socket (dsstr) ;
+    qunlock (dsstr) ;
+#ifndef X86_WIN32
+    close_wakeup (dsstr) ;
+#endif
     destroy_mutex (dsstr) ;
 }
 
@@ -693,6 +939,7 @@ void process_ll (pq660 q660, PU8 p, int chan_offset,
 
     strcpy (q660->lowlat_call.location, q->slocation) ;
     strcpy (q660->lowlat_call.channel, q->sseedname) ;
+    q660->lowlat_call.chan_number = q->lcq_num ;
     q660->ll_lcq.gen_src = datahdr.gds ;
     q660->lowlat_call.src_gen = q660->ll_lcq.gen_src ;
     q660->lowlat_call.src_subchan = datahdr.chan ;
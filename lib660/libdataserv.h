@@ -29,11 +29,12 @@ Edit History:
     0 2017-06-08 rdr Created
     1 2021-12-24 rdr Copyright assignment to Kinemetrics.
 ------2022-02-24 jms remove pseudo-pascal macros------
+    2 2026-10-19     Add MAX_DS_CLIENTS.
 */
 #ifndef libdataserv_h
 /* Flag this file as included */
 #define libdataserv_h
-#define VER_LIBDATASERV 5
+#define VER_LIBDATASERV 6
 
 #include "libtypes.h"
 #include "libstrucs.h"
@@ -41,6 +42,7 @@ Edit History:
 #include "libseed.h"
 
 #define MAX_DS_BUFFERS 16 /* around 65K */
+#define MAX_DS_CLIENTS 8 /* simultaneous clients per dataserver port */
 
 typedef tlowlat_call tdsbuf[MAX_DS_BUFFERS] ;
 typedef struct
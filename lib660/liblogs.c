@@ -35,6 +35,7 @@ Edit History:
                         corruption when time jump > 250us occurred.
     5 2021-12-24 rdr Copyright assignment to Kinemetrics.
 ------2022-02-24 jms remove pseudo-pascal macros------
+    6 2026-10-19     Always ask flush_archive to flush, it checks if anything to write.
 */
 #ifndef liblogs_h
 #include "liblogs.h"
@@ -258,7 +259,7 @@ void flush_timing (pq660 q660)
     if ((q == NIL) || (q->com->ring == NIL))
         return ;
 
-    if ((q->arc.amini_filter) && (q->arc.total_frames > 0))
+    if (q->arc.amini_filter)
         flush_archive (q660, q) ;
 }
 
@@ -610,7 +611,7 @@ void flush_messages (pq660 q660)
         pcom->frame = 0 ;
     }
 
-    if ((q->arc.amini_filter) && (q->arc.hdr_buf.samples_in_record))
+    if (q->arc.amini_filter)
         flush_archive (q660, q) ;
 
     q660->log_timer = 0 ;
@@ -29,6 +29,7 @@ Edit History:
     0 2017-06-10 rdr Created
     1 2021-12-24 rdr Copyright assignment to Kinemetrics.
 ------2022-02-24 jms remove pseudo-pascal macros------
+    2 2026-10-19     Always ask flush_archive to flush, it checks if anything to write.
 */
 #include "libopaque.h"
 #include "libmsgs.h"
@@ -148,7 +149,7 @@ void write_ocf (pq660 q660)
         sizeleft = sizeleft - size ;
     }
 
-    if ((pcl->arc.amini_filter) && (pcl->arc.total_frames > 1))
+    if (pcl->arc.amini_filter)
         flush_archive (q660, q660->cfg_lcq) ;
 }
 
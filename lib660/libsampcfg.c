@@ -40,6 +40,7 @@ Edit History:
     9 2021-01-06 jms remove unused code. block admin DP channels on IDL
    10 2021-12-24 rdr Copyright assignment to Kinemetrics.
 ------2022-02-24 jms remove pseudo-pascal macros------
+   11 2026-10-19     Read the archive status in lib_lcqstat under archive_lock.
 */
 #include "libsampcfg.h"
 #include "xmlseed.h"
@@ -703,6 +704,7 @@ enum tliberr lib_lcqstat (pq660 q660, tlcqstat *lcqstat)
     U32 cur ;
     int pass ;
     tonelcqstat *pone ;
+    pointer arclock ;
 
     lcqstat->count = 0 ;
     cur = secsince () ;
@@ -728,6 +730,7 @@ enum tliberr lib_lcqstat (pq660 q660, tlcqstat *lcqstat)
 
             pone->det_count = q->detections_session ;
             pone->cal_count = q->calibrations_session ;
+            arclock = archive_lock (q660) ; /* updated by archive workers */
             pone->arec_cnt = q->arc.records_written_session ;
             pone->arec_over = q->arc.records_overwritten_session ;
 
@@ -737,6 +740,7 @@ enum tliberr lib_lcqstat (pq660 q660, tlcqstat *lcqstat)
                 pone->arec_age = cur - q->arc.last_updated ;
 
             pone->arec_seq = q->arc.records_written ;
+            archive_unlock (arclock) ;
 
             if (q->def)
                 strcpy (pone->desc, q->def->desc) ;
@@ -37,6 +37,9 @@ Edit History:
     6 2021-12-11 jms various temporary debugging prints.
     7 2021-12-24 rdr Copyright assignment to Kinemetrics.
 ------2022-02-24 jms remove pseudo-pascal macros------
+    8 2026-10-19     Always ask flush_archive to flush, it checks if anything to write.
+    9 2026-10-19     Set chan_number in one second callback.
+   10 2026-10-19     Trace points for decompression and finished records.
 */
 
 #undef LINUXDEBUGPRINT
@@ -330,6 +333,8 @@ void finish_record (pq660 q660, plcq q, pcom_packet pcom)
     PU8 p ;
     seed_header *phdr ;
 
+    if (lib_trace_call)
+        lib_trace_call (LIBTRACE_FINISH) ;
     install_header (q660, q, pcom) ;
     (pcom->records_written)++ ;
 #ifdef NOTIMPLEMENTEDYET
@@ -427,7 +432,7 @@ void flush_lcq (pq660 q660, plcq q, pcom_packet pcom)
         finish_record (q660, q, pcom) ;
     }
 
-    if ((q->arc.amini_filter) && (q->arc.total_frames > 1))
+    if (q->arc.amini_filter)
         flush_archive (q660, q) ;
 }
 
@@ -627,6 +632,8 @@ void process_lcq (pq660 q660, plcq q, int src_samp, tfloat dv)
     } else {
         /* pre-compressed data */
         samples = decompress_blockette (q660, q) ;
+        if (lib_trace_call)
+            lib_trace_call (LIBTRACE_DECOMPRESS) ;
 
         while (pi) {
             p1 = (pointer)q->databuf ;
@@ -698,6 +705,7 @@ void process_lcq (pq660 q660, plcq q, int src_samp, tfloat dv)
         memcpy(&(q660->onesec_call.station_name), &(q660->station_ident), sizeof(string9)) ;
         strcpy(q660->onesec_call.location, q->slocation) ;
         strcpy(q660->onesec_call.channel, q->sseedname) ;
+        q660->onesec_call.chan_number = q->lcq_num ;
         q660->onesec_call.timestamp = q660->data_timetag - q->delay ;
         q660->onesec_call.qual_perc = q660->data_qual ;
         q660->onesec_call.rate = q->rate ;
@@ -32,6 +32,7 @@ Edit History:
     3 2021-12-11 jms various temporary debugging prints.
     4 2021-12-24 rdr Copyright assignment to Kinemetrics.
 ------2022-02-24 jms remove pseudo-pascal macros------
+    5 2026-10-19     Stop archive workers in lib_destroy_660.
 */
 
 #undef LINUXDEBUGPRINT
@@ -44,6 +45,7 @@ Edit History:
 #include "libsampcfg.h"
 #include "libcont.h"
 #include "libfilters.h"
+#include "libarchive.h"
 
 #define MS100 (0.1)
 
@@ -444,6 +446,7 @@ enum tliberr lib_destroy_660 (tcontext *ct)
 
     q660 = *ct ;
     *ct = NIL ;
+    archive_stop (q660) ;
     destroy_mutex (q660) ;
     pm = q660->connmem.memory_head ;
 
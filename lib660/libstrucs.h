@@ -36,6 +36,7 @@ Edit History:
 ------2022-02-24 jms remove pseudo-pascal macros------
     5 2022-03-22 jms add local time stamp of last received packet to be used to 
                         inform be660 of receiver latency.
+    6 2026-10-19     Add arcpool.
 
 }*/
 #ifndef libstrucs_h
@@ -188,6 +189,7 @@ typedef struct   /* this is the actual context which is hidden from clients */
     tminiseed_call miniseed_call ; /* buffer for building miniseed callbacks */
     int arc_size ; /* size of archival mini-seed records */
     int arc_frames ; /* number of frames in an archival record */
+    pointer arcpool ; /* archive worker threads, NIL if not started */
     double ref2016 ; /* for converting between system time and since 2016 time */
     double last_status_received ; /* last time status was received */
     string contmsg ; /* any errors from continuity checking */
@@ -17,6 +17,8 @@ Edit History:
                     the "noackmask" of all queues, rather than just
                     returning the current noackmask <> 0.
     7 29 Sep 2020 DSN Updated for comserv3.
+    8 19 Oct 2026     Add getbuffer_inplace for packets built in the ring.
+    9 19 Oct 2026     Wake clients waiting in cs_wait for each new packet.
 */
 #include <stdio.h>
 #include <errno.h>
@@ -37,7 +39,7 @@ Edit History:
 #include "service.h"
 #include "server.h"
 
-short VER_BUFFERS = 7 ;
+short VER_BUFFERS = 8 ;
 
 extern tring rings[NUMQ] ;         /* Description of each ring buffer */
 extern pserver_struc base ;        /* Base address of server memory segment */
@@ -93,6 +95,30 @@ tring_elem *getbuffer (short qnum)
 	   (sizeof(tring_elem) - sizeof(tdata_user))) ; /* clear to zero */
     bscan->blockmap = blockmask ;       /* put in current mask */
     bscan->packet_num = base->next_data++ ; /* packet number */
+    cs_signal_data (base) ;             /* wake clients in cs_wait */
+    if (nbscan == rings[qnum].tail)
+	rings[qnum].tail = (pring_elem) rings[qnum].tail->next ; /* throw away oldest */
+    return bscan ;
+}
+
+/* Like getbuffer, but for a packet already built in the data bytes
+   of the next free block (rings[qnum].head), which are not cleared.
+   The caller must have checked bufavail.
+*/
+tring_elem *getbuffer_inplace (short qnum)
+{
+    tring_elem *bscan, *nbscan ;
+
+    bscan = rings[qnum].head ;          /* next in */
+    nbscan = (pvoid) bscan->next ;      /* tail to remove */
+    if (nbscan->blockmap)
+	return NULL ;                   /* trying to get rid of blocked record */
+    rings[qnum].head = nbscan ;         /* move next in pointer */
+    bscan->user_data.reception_time = 0 ;
+    bscan->user_data.header_time = 0 ;
+    bscan->blockmap = blockmask ;       /* put in current mask */
+    bscan->packet_num = base->next_data++ ; /* packet number */
+    cs_signal_data (base) ;             /* wake clients in cs_wait */
     if (nbscan == rings[qnum].tail)
 	rings[qnum].tail = (pring_elem) rings[qnum].tail->next ; /* throw away oldest */
     return bscan ;
@@ -42,6 +42,9 @@ Edit History:
       18 Dec 99 IGD Number of changes ; presumably swapping for every case of handler()
    22 24 Aug 07 DSN Separate ENDIAN_LITTLE from LINUX logic.
    23 29 Sep 2020 DSN Updated for comserv3.
+   24 19 Oct 2026     Mark delivery of traced packets.
+   25 19 Oct 2026     Hold comserv_lock while reading or unblocking the
+                    rings, which library threads may be filling.
 */
 #include <stdio.h>
 #include <errno.h>
@@ -61,8 +64,10 @@ Edit History:
 #include "stuff.h"
 #include "service.h"
 #include "server.h"
+#include "pkttrace.h"
+#include "comserv_queue.h"
 
-short VER_COMMANDS = 23 ;     /*IGD LINUX compatible */
+short VER_COMMANDS = 24 ;     /*IGD LINUX compatible */
 
 /* Comserv external variables used in this file. */
 extern int retVal;
@@ -193,6 +198,7 @@ byte client_handler (pclient_struc svc, short clientnum)
     case CSCM_DATA_BLK :
     {
 	client->valdbuf = 0 ;
+	comserv_lock () ;
 /* If starting fresh, clear pointers and counters */
 	if (client->seqdbuf != CSQ_NEXT)
 	{
@@ -279,6 +285,7 @@ byte client_handler (pclient_struc svc, short clientnum)
 		if (good)
 		{
 		    memcpy ((pchar) pdata, (pchar) &bscan[lowi]->user_data, rings[lowi].xfersize) ;
+		    pkttrace_deliver (bscan[lowi]->packet_num) ;
 		    client->valdbuf++ ;
 		    pdata = (pdata_user) ((uintptr_t) pdata + client->dbufsize) ;
 		}
@@ -286,6 +293,7 @@ byte client_handler (pclient_struc svc, short clientnum)
 	    client->next_data = bscan[lowi]->packet_num + 1 ;
 	    bscan[lowi] = (pvoid) bscan[lowi]->next ;
 	}
+	comserv_unlock () ;
 	client->seqdbuf = CSQ_NEXT ;
 	break ;
     }
@@ -309,6 +317,9 @@ byte client_handler (pclient_struc svc, short clientnum)
     {
 	if (client->comoutsize < sizeof(linkstat_rec))
 	    return CSCR_SIZE ;
+	if (checkcom(pcom, clientnum, FALSE))
+	    return CSCR_BUSY ;
+	comserv_lock () ;
 	msize = 0 ;
 	for (j = DATAQ ; j < NUMQ ; j++)
 	{
@@ -320,8 +331,6 @@ byte client_handler (pclient_struc svc, short clientnum)
 		datatemp = (pvoid) datatemp->next ;
 	    }
 	}
-	if (checkcom(pcom, clientnum, FALSE))
-	    return CSCR_BUSY ;
 	linkstat.blocked_packets = msize ;
 	linkstat.seconds_inop = (uintptr_t) dtime () - start_time ;
 	memcpy((pchar) &linkstat.seedformat, (pchar) &seedformat, 4) ;
@@ -335,6 +344,7 @@ byte client_handler (pclient_struc svc, short clientnum)
 	linkstat.grpsize = grpsize ;
 	linkstat.grptime = grptime ;
 	memcpy(pv, (pchar) &linkstat, sizeof(linkstat_rec)) ;
+	comserv_unlock () ;
 	pcom->command_tag = cmd_seq ;
 	pcom->completion_status = CSCS_FINISHED ;
 	break ;
@@ -351,6 +361,7 @@ byte client_handler (pclient_struc svc, short clientnum)
 	    return CSCR_BUSY ;
 	pci = pv ;
 	pci->client_count = 0 ;
+	comserv_lock () ;
 	for (i = 0 ; i < highclient ; i++)
 	{
 	    poc = &pci->clients[pci->client_count++] ;
@@ -375,6 +386,7 @@ byte client_handler (pclient_struc svc, short clientnum)
 	    }
 	    poc->block_count = msize ;
 	}
+	comserv_unlock () ;
 	pcom->command_tag = cmd_seq ;
 	pcom->completion_status = CSCS_FINISHED ;
 	break ;
@@ -382,8 +394,10 @@ byte client_handler (pclient_struc svc, short clientnum)
     case CSCM_UNBLOCK :
     {
 	pshort = (pvoid) ((uintptr_t) svc + client->cominoffset) ;
+	comserv_lock () ;
 	unblock (*pshort) ;
 	clr_bit (&blockmask, *pshort) ;
+	comserv_unlock () ;
 	break ;
     }
     case CSCM_RECONFIGURE :
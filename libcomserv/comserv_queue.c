@@ -111,6 +111,19 @@ Edit History:
                     set_byte_order_SEED_IO_BYTE() ).
  30   24 Aug 07 DSN Separate ENDIAN_LITTLE from LINUX logic.
  31   29 Sep 2020 DSN Updated for comserv3.
+ 32   19 Oct 2026     Added comserv_queue_rt to set the reception time
+                    from the receiving library.
+ 33   19 Oct 2026     Added comserv_reserve and comserv_commit so that a
+                    library thread can build a packet directly in its
+                    ring slot. Ring access is protected by comserv_lock.
+                    comserv_queue copies the packet straight into the ring.
+ 34   19 Oct 2026     Update the channel statistics table in comserv_commit.
+ 35   19 Oct 2026     Count packets, bytes, queue delay and blocked rings in
+                    the server statistics. Added comserv_stats_queue,
+                    comserv_stats_throttle, comserv_stats_callback and
+                    comserv_stats_link for the server programs.
+ 36   19 Oct 2026     Commit traced packets to the packet trace table.
+ 37   19 Oct 2026     Added comserv_trylock.
 */
 #include <stdio.h>
 #include <errno.h>
@@ -128,6 +141,7 @@ Edit History:
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <netdb.h>
+#include <pthread.h>
 
 #include "quanstrc.h"
 #include "stuff.h"
@@ -136,6 +150,9 @@ Edit History:
 #include "server.h"
 #include "timeutil.h"
 #include "logging.h"
+#include "comserv_queue.h"
+#include "pkttrace.h"
+#include "chanstats.h"
 
 #ifdef	LINUX
 #include "unistd.h"
@@ -150,13 +167,14 @@ Edit History:
 #define SET_LITTLE_ENDIAN 0  /* of fixed SEED header */
 
 
-short VER_COMLINK = 31 ;
+short VER_COMLINK = 36 ;
 
 /* Comserv external variables used in this file. */
-extern pchar dest ;
+extern tring rings[NUMQ] ;
 extern linkstat_rec linkstat ;
 extern boolean override ;	// No longer used?
 extern int32_t netto_cnt ;
+extern cs_stats_table *stats_table ;
 
 /* External variables used only in this file */
 string3 seed_names[20][7] =
@@ -183,13 +201,71 @@ string3 seed_names[20][7] =
     /*R2*/ {"BX8","EX8","HX8","MX8","LX8","VX8","UX8"}} ;
 
 /* External functions used in this file. */
-tring_elem *getbuffer (short qnum) ;
+tring_elem *getbuffer_inplace (short qnum) ;
 boolean bufavail (short qnum) ;
 boolean checkmask (short qnum) ;
 void flip_fixed_header(seed_fixed_data_record_header *);
 char set_byte_order_SEED_IO_BYTE(char, short); /* IGD 03/09/01 */
 char process_set_byte_order_SEED_IO_BYTE(char);
 
+/* Ring access lock, recursive so that a caller holding it may still
+   call the routines below. */
+static pthread_mutex_t ring_mutex ;
+static pthread_once_t ring_mutex_once = PTHREAD_ONCE_INIT ;
+
+static void ring_mutex_init (void)
+{
+    pthread_mutexattr_t attr ;
+
+    pthread_mutexattr_init (&attr) ;
+    pthread_mutexattr_settype (&attr, PTHREAD_MUTEX_RECURSIVE) ;
+    pthread_mutex_init (&ring_mutex, &attr) ;
+    pthread_mutexattr_destroy (&attr) ;
+}
+
+/***********************************************************************
+ * comserv_lock, comserv_trylock, comserv_unlock
+ *	Lock the comserv rings and link statistics against other threads.
+ *	comserv_scan takes the lock only around ring access, so a library
+ *	thread that finds it busy (comserv_trylock returns 0) should queue
+ *	the packet for the main thread rather than wait.
+ ***********************************************************************/
+void comserv_lock (void)
+{
+    pthread_once (&ring_mutex_once, ring_mutex_init) ;
+    pthread_mutex_lock (&ring_mutex) ;
+}
+
+int comserv_trylock (void)
+{
+    pthread_once (&ring_mutex_once, ring_mutex_init) ;
+    return pthread_mutex_trylock (&ring_mutex) == 0 ;
+}
+
+void comserv_unlock (void)
+{
+    pthread_mutex_unlock (&ring_mutex) ;
+}
+
+/***********************************************************************
+ * packet_qnum
+ *	Return the comserv queue (ring) for the packet type, -1 if unknown.
+ ***********************************************************************/
+static short packet_qnum (int packettype)
+{
+    switch (packettype)
+    {
+    case RECORD_HEADER_1 :	return DATAQ ;
+    case BLOCKETTE :		return BLKQ ;
+    case COMMENTS :		return MSGQ ;
+    case CLOCK_CORRECTION :	return TIMQ ;
+    case DETECTION_RESULT :	return DETQ ;
+    case END_OF_DETECTION :	return DATAQ ;
+    case CALIBRATION :		return CALQ ;
+    default :			return -1 ;
+    }
+}
+
 /***********************************************************************
  * comserv_anyQueueBlocking()
  *	This routine checks to see if any of the comserv queues (rings)
@@ -199,8 +275,141 @@ char process_set_byte_order_SEED_IO_BYTE(char);
  *	false: if packet buffer available in all queues.
  ***********************************************************************/
 int comserv_anyQueueBlocking() {
-    return ! ( bufavail(DATAQ) && bufavail(DETQ) && bufavail(CALQ) &&
-	       bufavail(TIMQ) && bufavail(MSGQ) && bufavail(BLKQ) );
+    int blocking ;
+
+    comserv_lock () ;
+    blocking = ! ( bufavail(DATAQ) && bufavail(DETQ) && bufavail(CALQ) &&
+		   bufavail(TIMQ) && bufavail(MSGQ) && bufavail(BLKQ) );
+    comserv_unlock () ;
+    return blocking ;
+}
+
+/***********************************************************************
+ * comserv_reserve
+ *	Reserve the next slot of the comserv queue (ring) for packettype,
+ *	so that the caller can build the packet in place.  The slot is
+ *	not seen by clients until comserv_commit is called.
+ *	On success the rings are locked until comserv_commit, so the
+ *	caller must fill in the packet and commit it without delay.
+ *   Return values:
+ *	Address of the 512 byte packet area, with *qnum set to the queue.
+ *	NULL if the queue is blocked or the type unknown, nothing is locked.
+ ***********************************************************************/
+char *comserv_reserve(int packettype, short *qnum)
+{
+    short q ;
+
+    q = packet_qnum (packettype) ;
+    if (q < 0)
+    {
+	LogMessage(CS_LOG_TYPE_ERROR, "Unknown Packet Type %d\n",packettype);
+	return NULL ;
+    }
+    comserv_lock () ;
+    if (! bufavail (q))
+    {
+	if (stats_table != NULL)
+	{
+	    cs_stats_server_begin (stats_table)->ring_full++ ;
+	    cs_stats_server_end (stats_table) ;
+	}
+	comserv_unlock () ;
+	return NULL ;
+    }
+    *qnum = q ;
+    return (char *) &rings[q].head->user_data.data_bytes ;
+}
+
+/***********************************************************************
+ * comserv_commit
+ *	Make the packet reserved by comserv_reserve available to clients,
+ *	add it to the channel statistics, and unlock the rings.
+ *	If reception_time is 0 the current time is used.
+ ***********************************************************************/
+void comserv_commit(short qnum, int len, double reception_time)
+{
+    tring_elem *freebuf ;
+    pchar pdata ;
+
+    /* getbuffer would clear the whole element, only clear what follows the packet */
+    pdata = (pchar) &rings[qnum].head->user_data.data_bytes ;
+    if (len < 512)
+	memset (pdata + len, 0, 512 - len) ;
+    freebuf = getbuffer_inplace (qnum) ;
+
+    /* Increment packet count. */
+    linkstat.total_packets++ ;
+    netto_cnt = 0 ; /* got a packet, reset timeout */
+    linkstat.last_good = dtime () ;
+
+    /* We punt and use the current time as the packet time. */
+    freebuf->user_data.header_time = linkstat.last_good ;
+    freebuf->user_data.reception_time = (reception_time > 0.) ?
+	reception_time : linkstat.last_good ;    /* reception time */
+    cs_stats_update (stats_table, (char *) &freebuf->user_data.data_bytes, len,
+		     qnum, freebuf->user_data.reception_time) ;
+    cs_stats_packet (stats_table, qnum, len, reception_time, linkstat.last_good) ;
+    pkttrace_commit (freebuf->packet_num, qnum) ;
+    comserv_unlock () ;
+}
+
+/***********************************************************************
+ * comserv_stats_queue, comserv_stats_throttle, comserv_stats_callback,
+ * comserv_stats_link
+ *	Report the server's own packet queue, delays of the data logger
+ *	library, and the state of the data logger link in the server
+ *	statistics (chanstats.h).  They may be called from any thread.
+ ***********************************************************************/
+void comserv_stats_queue (int depth, int size)
+{
+    cs_server_stats *s ;
+
+    if (stats_table == NULL) return ;
+    comserv_lock () ;
+    s = cs_stats_server_begin (stats_table) ;
+    s->queue_depth = depth ;
+    s->queue_size = size ;
+    cs_stats_server_end (stats_table) ;
+    comserv_unlock () ;
+}
+
+void comserv_stats_throttle (double seconds)
+{
+    cs_server_stats *s ;
+
+    if (stats_table == NULL) return ;
+    comserv_lock () ;
+    s = cs_stats_server_begin (stats_table) ;
+    s->throttle_events++ ;
+    s->throttle_seconds += seconds ;
+    cs_stats_server_end (stats_table) ;
+    comserv_unlock () ;
+}
+
+void comserv_stats_callback (double seconds)
+{
+    if (stats_table == NULL) return ;
+    comserv_lock () ;
+    cs_hist_add (&cs_stats_server_begin (stats_table)->callback_time, seconds) ;
+    cs_stats_server_end (stats_table) ;
+    comserv_unlock () ;
+}
+
+void comserv_stats_link (int up, int buffer_fill, double rtt, 
+			 uint32_t retransmits, uint32_t stalls)
+{
+    cs_server_stats *s ;
+
+    if (stats_table == NULL) return ;
+    comserv_lock () ;
+    s = cs_stats_server_begin (stats_table) ;
+    s->link_up = up ;
+    s->link_buffer_fill = buffer_fill ;
+    s->link_rtt = rtt ;
+    s->link_retransmits = retransmits ;
+    s->link_stalls = stalls ;
+    cs_stats_server_end (stats_table) ;
+    comserv_unlock () ;
 }
 
 /***********************************************************************
@@ -215,135 +424,42 @@ int comserv_anyQueueBlocking() {
  ***********************************************************************/
 int comserv_queue(char* buf,int len,int packettype)
 {
-    short size ;
-    tring_elem *freebuf ;
-    seed_fixed_data_record_header *pseed ;
-
-    /* Create a temporary storage area for the received packets seed header */
-    seed_fixed_data_record_header my_seed_header;
-    int packet_type;
-    double packet_time;
-
-    /* Move parameters into local vars */
-    memcpy(dest,buf,len);
-    packet_type = packettype;
-    size = (short ) len;
-
-    /* Increment packet count. */
-    linkstat.total_packets++ ;
+    return comserv_queue_rt (buf, len, packettype, 0.) ;
+}
 
-    /* Debug only statments here */
-    // tsize = (short) ((int32_t) term - (int32_t) dest);
-    // printf("For debug show calculated size - mserv %d\n",tsize);
-    // tsize = (short) ((int32_t) term - (int32_t) dest - 6) ;
-    // printf("For debug show calculated size - comlink %d\n",tsize);
+/***********************************************************************
+ * comserv_queue_rt
+ *	comserv_queue with the time the packet was received, in seconds
+ *	since 1970.  If reception_time is 0, the current time is used.
+ ***********************************************************************/
+int comserv_queue_rt(char* buf,int len,int packettype,double reception_time)
+{
+    short qnum ;
+    char *pdata ;
 
     /* At this point, all known packets are 512 bytes in length or less, so reject */
     /* any that are not larger. */
-    if (size > 512) 
+    if (len > 512) 
+    {
+	LogMessage(CS_LOG_TYPE_ERROR, "Unknown packet size %d\n",len);
+	return -1;
+    }
+    if (packet_qnum (packettype) < 0)
     {
-	LogMessage(CS_LOG_TYPE_ERROR, "Unknown packet size %d\n",size);
+	LogMessage(CS_LOG_TYPE_ERROR, "Unknown Packet Type %d\n",packettype);
 	return -1;
     }
 
     /* All received packets are considered valid (no checksum calc) */
     /* Because they were received by the calling program */
-    /* Here we process the packet, and put it into the next avaiable comserv */
-    /* Ring buffer slot. */
-    netto_cnt = 0 ; /* got a packet, reset timeout */
-    linkstat.last_good = dtime () ;
-
-    /*:: NO LONGER SUPPORTING OVERRIDING THE SEED SITENAME IN THE INCOMING MSEED RECORD. */
-
-    /* Copy the header portion of the received packet. */
-    memcpy(&my_seed_header,dest,64);
-
-    /* We punt and use the current time as the packet time. */
-    packet_time = dtime();
-
-    /* Find a free buffer in the ring for the specified packet time. */
+    /* Here we put the packet into the next avaiable comserv ring buffer slot. */
     /* If no free buffer, return an error. */
     /* Caller gets to decide how to handle this situatin. */
-    switch(packet_type)
-    {
-    case RECORD_HEADER_1 :
-    {
-	freebuf = getbuffer (DATAQ) ;    /* get free buffer */
-	if(freebuf == NULL)
-	{
-	    return 1;
-	}
-	break;
-    }
-    case BLOCKETTE :
-    {
-	freebuf = getbuffer (BLKQ) ;    /* get free buffer */
-	if(freebuf == NULL)
-	{
-	    return 1;
-	}
-	break;
-    }
-    case COMMENTS :
-    {
-	freebuf = getbuffer (MSGQ) ;    /* get free buffer */
-	if(freebuf == NULL)
-	{
-	    return 1;
-	}
-	break;
-    }
-    case CLOCK_CORRECTION :
-    {
-	freebuf = getbuffer (TIMQ) ;    /* get free buffer */
-	if(freebuf == NULL)
-	{
-	    return 1;
-	}
-	break;
-    }
-    case DETECTION_RESULT :
-    {
-	freebuf = getbuffer (DETQ) ;    /* get free buffer */
-	if(freebuf == NULL)
-	{
-	    return 1;
-	}
-	break;
-    }
-    case END_OF_DETECTION :
-    {
-	freebuf = getbuffer (DATAQ) ;    /* get free buffer */
-	if(freebuf == NULL)
-	{
-	    return 1;
-	}
-	break;
-    }
-    case CALIBRATION :
-    {
-	freebuf = getbuffer (CALQ) ;    /* get free buffer */
-	if(freebuf == NULL)
-	{
-	    return 1;
-	}
-	break;
-    }
-    default :
-    {
-	LogMessage(CS_LOG_TYPE_ERROR, "Unknown Packet Type %d\n",packet_type);
-	return -1;
-    }
-    } /* End of Switch */
-
-    /* Now freebuf points to the proper comserv ring buffer. Now we */
-    /* put the data into the buffer. */
-    pseed = (pvoid) &freebuf->user_data.data_bytes ;
-    freebuf->user_data.reception_time = dtime () ;    
-    /* reception time */
-    freebuf->user_data.header_time = packet_time;
-    memcpy (pseed,dest,512) ;
-    
+    pdata = comserv_reserve (packettype, &qnum) ;
+    if (pdata == NULL)
+	return 1 ;
+    memcpy (pdata, buf, len) ;
+    comserv_commit (qnum, len, reception_time) ;
     return 0;
 }
 
@@ -92,6 +92,15 @@ Edit History:
    			Removed _OSK conditional code.
    40 29 Sep 2020 DSN Updated for comserv3.
    41  3 Mar 2023 DSN Skip client with NULL client address in comserv_scan.
+   42 19 Oct 2026     Hold comserv_lock while servicing clients in comserv_scan.
+   43 19 Oct 2026     Add the channel statistics table after the ring buffers
+                    in the server segment.
+   44 19 Oct 2026     Sample ring fill and client lag for the server
+                    statistics once a second in comserv_scan.
+   45 19 Oct 2026     Add the packet trace table after the channel statistics
+                    table when PKTTRACE is set.
+   46 19 Oct 2026     Hold comserv_lock in comserv_scan only around ring
+                    access, not for the whole pass over the clients.
 */           
 
 #define EDITION 39
@@ -124,6 +133,8 @@ Edit History:
 #include "logging.h"
 #include "comserv_vars.h"
 #include "csconfig.h"
+#include "comserv_queue.h"
+#include "pkttrace.h"
 
 /* Comserv module version numbers */
 extern short VER_TIMEUTIL ;
@@ -286,7 +297,7 @@ int comserv_init (csconfig *cs_cfg, char* server_name)
     int semid;
     short i, j ;
     struct sembuf notbusy = { 0, 1, 0 } ;
-    int32_t bufsize, size ;
+    int32_t bufsize, size, stats_offset, trace_offset ;
        
     tservername station_name ;
       
@@ -406,10 +417,15 @@ int comserv_init (csconfig *cs_cfg, char* server_name)
 	rings[i].size = size ;
     }
     bufsize = (bufsize + 15) & 0xfffffff8 ; /* double word align */
+    /* Channel statistics table follows the ring buffers */
+    stats_offset = (sizeof(tserver_struc) + bufsize + 7) & 0xfffffff8 ;
+    /* Optional packet trace table follows the channel statistics */
+    trace_offset = (stats_offset + cs_stats_size(CS_STATS_MAXCHAN) + 7) & 0xfffffff8 ;
 
     /* Create shared memory segment and install my process id */
-    shmid = shmget(segkey, sizeof(tserver_struc) + 
-		   bufsize, IPC_CREAT | PERM) ;
+    shmid = shmget(segkey, trace_offset + 
+		   ((cs_cfg->pkttrace > 0) ? pkttrace_size(cs_cfg->pkttrace) : 0),
+		   IPC_CREAT | PERM) ;
     if (shmid == ERROR)
     {
 	LogMessage (CS_LOG_TYPE_ERROR, "Exit: Could not create server segment with key %d\n", segkey) ;
@@ -439,9 +455,24 @@ int comserv_init (csconfig *cs_cfg, char* server_name)
 
     /* Initialize next packet numbers */
     base->next_data = 0 ;
+    base->data_waiters = 0 ;
 
     /* Call routine to setup ring buffers for data and blockettes */
     setupbuffers () ;
+
+    /* Setup the channel statistics table */
+    stats_table = (cs_stats_table *) ((pchar) base + stats_offset) ;
+    cs_stats_init (stats_table, CS_STATS_MAXCHAN) ;
+    base->stats_offset = stats_offset ;
+
+    /* Setup the packet trace table */
+    base->trace_offset = 0 ;
+    if (cs_cfg->pkttrace > 0)
+    {
+	pkttrace_init ((pkt_trace_table *) ((pchar) base + trace_offset), cs_cfg->pkttrace) ;
+	base->trace_offset = trace_offset ;
+	LogMessage (CS_LOG_TYPE_INFO, "Tracing the last %d packets\n", pkttrace_table->nentries) ;
+    }
    
     /* Allow access to service queue */ 
     if (semop(semid, &notbusy, 1) == ERROR) 
@@ -553,6 +584,8 @@ int comserv_scan()
 			{
 			    curclient = (pclient_station) ((uintptr_t) cursvc +
 							   cursvc->offsets[cursvc->curstation]) ;
+			    /* Library threads may be adding packets to the rings. */
+			    comserv_lock () ;
 			    if (curclient->blocking)
 			    { /* client is taking blocking option */
 				clients[i].blocking = TRUE ;
@@ -564,6 +597,7 @@ int comserv_scan()
 				unblock(i) ;
 				clr_bit (&blockmask, i) ;
 			    }
+			    comserv_unlock () ;
 			}
 			break ;
 		    }
@@ -626,7 +660,10 @@ int comserv_scan()
     {
 	uppoll++ ;
 	lastsec = curtime ;
+	comserv_lock () ;
 	check_clients () ;
+	cs_stats_sample (stats_table, rings, clients, highclient) ;
+	comserv_unlock () ;
     }
     nanosleep (&rqtp, &rmtp) ;
     return retVal;
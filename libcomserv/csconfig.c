@@ -31,6 +31,7 @@ Edit History:
    21 22 Feb 99 PJM Modified this to support the multicast comserv
    22 01 Dec 05 PAF Added in LOGDIR directive for logging directory
    23 29 Sep 2020 DSN Updated for comserv3.
+   24 19 Oct 2026     Add setting of "PKTTRACE".
 
    This is based on the original cscfg.c.
    Changes include:
@@ -52,7 +53,7 @@ Edit History:
 #include "cfgutil.h"
 #include "csconfig.h"
 
-short VER_CSCFG = 23 ;
+short VER_CSCFG = 24 ;
 
 #define STATION_INI	"station.ini"
 #ifdef COMSERV2
@@ -351,6 +352,11 @@ int getCSServerParams (csconfig *cs_cfg, char *server_dir, char *section)
 	    cs_cfg->blkbufs = atoi((pchar)&str2) ;
 	    continue;
 	}
+	if (strcmp(str1, "PKTTRACE") == 0)
+	{
+	    cs_cfg->pkttrace = atoi((pchar)&str2) ;
+	    continue;
+	}
 	/* Look for compound keyword directives. */
 	strcpy(stemp, str1) ;
 	/* look for client[xx]=name[,timeout] */
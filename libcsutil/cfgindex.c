@@ -0,0 +1,772 @@
+/***********************************************************************
+ * cfgindex.c - compiled index of a configuration file.
+ *
+ * open_cfg() compiles a configuration file, with its @include files,
+ * into an index of its section headers and directive lines, and
+ * skipto() and read_cfg() then work from the index instead of reading
+ * the file.  Section headers and directives are found through a hash
+ * table, so skipto() to a named section and cfg_lookup() of one
+ * directive take constant time however large the file is.
+ *
+ * The index is saved as "<file>.idx" beside the file when the
+ * directory is writable, so that other programs map it rather than
+ * parse the file again.  It records the device, inode, size and
+ * modification time of every file it was built from (and the value of
+ * COMSERV_PARAMS used for include files), and is rebuilt when any of
+ * them change or the saved index is damaged.  Indexes are kept for the
+ * life of the process, and are checked against their files on every
+ * open_cfg().
+ *
+ * The environment variable COMSERV_CFG_INDEX may be set to "off" to
+ * read configuration files directly, or to "nosave" to build indexes
+ * in memory only.
+ *
+ * 2026-10-19 Initial version.
+ **********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#include "cstypes.h"
+#include "cfgutil.h"
+#include "stuff.h"
+
+#define SUCCESS 0
+#define FAILURE 1
+
+#define CFGIDX_MAGIC	"CSCI"
+#define CFGIDX_VERSION	1
+#define CFGIDX_ORDER	0x01020304	/* Detects an index from another host.	*/
+#define CFGIDX_NONE	0xffffffff
+#define CFGIDX_HEADER	1
+#define CFGIDX_DIRECTIVE 2
+#define CFGIDX_SUFFIX	".idx"
+
+#define COMSERV_PARAMS_ENV "COMSERV_PARAMS"
+
+/* Layout of an index, in memory and on disk.  All offsets are from the
+   start of the index. */
+typedef struct {
+    char magic[4];		/* CFGIDX_MAGIC.				*/
+    uint32_t version;		/* CFGIDX_VERSION.				*/
+    uint32_t order;		/* CFGIDX_ORDER in host byte order.		*/
+    uint32_t size;		/* Total bytes.					*/
+    uint32_t nfiles;		/* Source files.				*/
+    uint32_t nlines;		/* Headers and directives, in file order.	*/
+    uint32_t nhash;		/* Hash buckets, a power of 2.			*/
+    uint32_t files;		/* Offset of cfgidx_file[nfiles].		*/
+    uint32_t lines;		/* Offset of cfgidx_line[nlines].		*/
+    uint32_t hash;		/* Offset of uint32_t[nhash], line number + 1.	*/
+    uint32_t params;		/* COMSERV_PARAMS when built, string offset.	*/
+    uint32_t last;		/* Last line of the file, string offset.	*/
+} cfgidx_hdr;
+
+typedef struct {
+    uint32_t name;		/* Pathname, string offset.			*/
+    uint32_t exists;		/* File existed, else an include was missing.	*/
+    uint64_t dev;
+    uint64_t ino;
+    int64_t size;
+    int64_t mtime;
+    int64_t mtime_nsec;
+} cfgidx_file;
+
+typedef struct {
+    uint32_t type;		/* CFGIDX_HEADER or CFGIDX_DIRECTIVE.		*/
+    uint32_t text;		/* Line as read, string offset.			*/
+    uint32_t key;		/* Upshifted header line or directive name.	*/
+    uint32_t value;		/* Directive value.				*/
+    uint32_t section;		/* Header line of a directive, or CFGIDX_NONE.	*/
+    uint32_t next;		/* Next header with the same name, or CFGIDX_NONE. */
+    uint32_t hash;
+    uint32_t reserved;
+} cfgidx_line;
+
+struct cfg_index {
+    struct cfg_index *next;	/* Process cache.				*/
+    char *fname;		/* Configuration file.				*/
+    char *base;			/* The index.					*/
+    size_t len;
+    int mapped;			/* base is mapped, else malloced.		*/
+    int refs;			/* config_strucs using the index.		*/
+    int stale;			/* Out of date, free when unused.		*/
+};
+
+#define HDR(ci)		((cfgidx_hdr *) (ci)->base)
+#define FILES(ci)	((cfgidx_file *) ((ci)->base + HDR(ci)->files))
+#define LINES(ci)	((cfgidx_line *) ((ci)->base + HDR(ci)->lines))
+#define HASH(ci)	((uint32_t *) ((ci)->base + HDR(ci)->hash))
+#define STR(ci,off)	((ci)->base + (off))
+
+static cfg_index *cache = NULL;
+static pthread_mutex_t cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Index being built. */
+typedef struct {
+    cfgidx_file *files;
+    int nfiles, maxfiles;
+    cfgidx_line *lines;
+    int nlines, maxlines;
+    char *strings;
+    uint32_t nstrings, maxstrings;
+    uint32_t section;
+    char last[CFGWIDTH];	/* Last line read, left in lastread at the end.	*/
+} cfgidx_build;
+
+/***********************************************************************
+ * Hashing.  Names compare without regard to case, as in skipto().
+ **********************************************************************/
+
+static uint32_t hash_key (const char *key, uint32_t section)
+{
+    uint32_t h = 2166136261u;
+
+    while (*key)
+    {
+	h ^= (unsigned char) toupper ((unsigned char) *key++);
+	h *= 16777619u;
+    }
+    if (section != CFGIDX_NONE)
+	h ^= (section + 1) * 0x9e3779b1u;
+    return h;
+}
+
+static const char *cfgidx_params (void)
+{
+    const char *p = getenv (COMSERV_PARAMS_ENV);
+
+    return (p != NULL) ? p : "";
+}
+
+/***********************************************************************
+ * Building an index.
+ **********************************************************************/
+
+static int add_string (cfgidx_build *b, const char *s, uint32_t *off)
+{
+    uint32_t n = strlen (s) + 1;
+    char *p;
+
+    if (b->nstrings + n > b->maxstrings)
+    {
+	b->maxstrings = (b->maxstrings + n) * 2;
+	if ((p = (char *) realloc (b->strings, b->maxstrings)) == NULL) return FAILURE;
+	b->strings = p;
+    }
+    memcpy (b->strings + b->nstrings, s, n);
+    *off = b->nstrings;
+    b->nstrings += n;
+    return SUCCESS;
+}
+
+static cfgidx_line *add_line (cfgidx_build *b)
+{
+    cfgidx_line *p;
+
+    if (b->nlines == b->maxlines)
+    {
+	b->maxlines = b->maxlines ? b->maxlines * 2 : 256;
+	if ((p = (cfgidx_line *) realloc (b->lines, b->maxlines * sizeof(cfgidx_line))) == NULL)
+	    return NULL;
+	b->lines = p;
+    }
+    p = &b->lines[b->nlines++];
+    memset (p, 0, sizeof(cfgidx_line));
+    return p;
+}
+
+/* Record a source file, returns FAILURE if out of memory. */
+static int add_file (cfgidx_build *b, const char *fname, struct stat *st, int exists)
+{
+    cfgidx_file *f;
+
+    if (b->nfiles == b->maxfiles)
+    {
+	b->maxfiles = b->maxfiles ? b->maxfiles * 2 : 4;
+	if ((f = (cfgidx_file *) realloc (b->files, b->maxfiles * sizeof(cfgidx_file))) == NULL)
+	    return FAILURE;
+	b->files = f;
+    }
+    f = &b->files[b->nfiles++];
+    memset (f, 0, sizeof(cfgidx_file));
+    if (add_string (b, fname, &f->name) != SUCCESS) return FAILURE;
+    f->exists = exists;
+    if (exists)
+    {
+	f->dev = st->st_dev;
+	f->ino = st->st_ino;
+	f->size = st->st_size;
+	f->mtime = st->st_mtim.tv_sec;
+	f->mtime_nsec = st->st_mtim.tv_nsec;
+    }
+    return SUCCESS;
+}
+
+/* Add the lines of one file, following @include lines in the same way
+   as skipto() and read_cfg().  Returns FAILURE if the file cannot be
+   opened or out of memory. */
+static int parse_file (cfgidx_build *b, const char *fname, int depth)
+{
+    FILE *fp;
+    struct stat st;
+    char line[CFGWIDTH];
+    char include[2*CFGWIDTH];
+    char *p;
+    cfgidx_line *l;
+    uint32_t off;
+    int status = SUCCESS;
+
+    if (depth >= MAX_INDIRECTION)
+    {
+	fprintf (stderr, "util/open_cfg(): Fatal Warning: include file level exceeds %d, skipping %s\n",
+		 MAX_INDIRECTION, fname);
+	return SUCCESS;
+    }
+    if ((fp = fopen (fname, "r")) == NULL || fstat (fileno (fp), &st) != 0)
+    {
+	if (fp != NULL) fclose (fp);
+	/* Remember a missing include file, so the index is rebuilt if it appears. */
+	if (depth > 0)
+	{
+	    fprintf(stderr, "util/open_cfg(): Fatal Warning: file at path %s could not be opened, skipping\n", fname);
+	    return add_file (b, fname, NULL, 0);
+	}
+	return FAILURE;
+    }
+    if (add_file (b, fname, &st, 1) != SUCCESS)
+    {
+	fclose (fp);
+	return FAILURE;
+    }
+    while (status == SUCCESS && fgets (line, CFGWIDTH-1, fp) != NULL)
+    {
+	untrail (line);
+	strcpy (b->last, line);
+	if (line[0] == '@')
+	{
+	    /* Resolve the include file as _open_include_cfg() does. */
+	    include[0] = '\0';
+	    if (line[1] != '/' && (p = getenv (COMSERV_PARAMS_ENV)) != NULL)
+	    {
+		strcat (include, p);
+		strcat (include, "/");
+	    }
+	    strcat (include, &line[1]);
+	    status = parse_file (b, include, depth + 1);
+	    continue;
+	}
+	if (line[0] != '[' && ! isalnum ((unsigned char) line[0]))
+	    continue;
+	if ((l = add_line (b)) == NULL || add_string (b, line, &l->text) != SUCCESS)
+	{
+	    status = FAILURE;
+	    break;
+	}
+	if (line[0] == '[')
+	{
+	    l->type = CFGIDX_HEADER;
+	    upshift (line);
+	    b->section = b->nlines - 1;
+	    l->section = CFGIDX_NONE;
+	    l->hash = hash_key (line, CFGIDX_NONE);
+	    status = add_string (b, line, &l->key);
+	}
+	else
+	{
+	    l->type = CFGIDX_DIRECTIVE;
+	    l->section = b->section;
+	    if ((p = strchr (line, '=')) != NULL)
+		*p++ = '\0';
+	    else
+		p = "";
+	    status = add_string (b, p, &off);
+	    l->value = off;
+	    upshift (line);
+	    l->hash = hash_key (line, l->section);
+	    if (status == SUCCESS) status = add_string (b, line, &l->key);
+	}
+	l->next = CFGIDX_NONE;
+    }
+    fclose (fp);
+    return status;
+}
+
+/* Lay out a built index in one block.  Returns NULL if out of memory. */
+static char *layout (cfgidx_build *b, size_t *len)
+{
+    cfgidx_hdr *hdr;
+    cfgidx_line *lines, *l, *m;
+    uint32_t *hash;
+    uint32_t nhash, h, i, j, params, last;
+    size_t size;
+    char *base;
+
+    if (add_string (b, cfgidx_params (), &params) != SUCCESS
+	|| add_string (b, b->last, &last) != SUCCESS)
+	return NULL;
+    for (nhash = 16; nhash < 2 * (uint32_t) b->nlines; nhash *= 2) ;
+    size = sizeof(cfgidx_hdr) + b->nfiles * sizeof(cfgidx_file)
+	+ b->nlines * sizeof(cfgidx_line) + nhash * sizeof(uint32_t);
+    if ((base = (char *) calloc (1, size + b->nstrings)) == NULL) return NULL;
+    hdr = (cfgidx_hdr *) base;
+    memcpy (hdr->magic, CFGIDX_MAGIC, 4);
+    hdr->version = CFGIDX_VERSION;
+    hdr->order = CFGIDX_ORDER;
+    hdr->size = size + b->nstrings;
+    hdr->nfiles = b->nfiles;
+    hdr->nlines = b->nlines;
+    hdr->nhash = nhash;
+    hdr->files = sizeof(cfgidx_hdr);
+    hdr->lines = hdr->files + b->nfiles * sizeof(cfgidx_file);
+    hdr->hash = hdr->lines + b->nlines * sizeof(cfgidx_line);
+    hdr->params = size + params;
+    hdr->last = size + last;
+
+    /* Strings go last, so their offsets move by size. */
+    memcpy (base + size, b->strings, b->nstrings);
+    memcpy (base + hdr->files, b->files, b->nfiles * sizeof(cfgidx_file));
+    for (i = 0; i < b->nfiles; i++)
+	((cfgidx_file *) (base + hdr->files))[i].name += size;
+    lines = (cfgidx_line *) (base + hdr->lines);
+    memcpy (lines, b->lines, b->nlines * sizeof(cfgidx_line));
+    hash = (uint32_t *) (base + hdr->hash);
+    for (i = 0; i < b->nlines; i++)
+    {
+	l = &lines[i];
+	l->text += size;
+	l->key += size;
+	if (l->type == CFGIDX_DIRECTIVE) l->value += size;
+	/* The first header of each name, and the last directive of each name
+	   in a section, as read_cfg() callers let later directives win. */
+	for (h = l->hash & (nhash - 1); (j = hash[h]) != 0; h = (h + 1) & (nhash - 1))
+	{
+	    m = &lines[j - 1];
+	    if (m->hash == l->hash && m->type == l->type && m->section == l->section
+		&& strcmp (base + m->key, base + l->key) == 0)
+		break;
+	}
+	if (j == 0)
+	    hash[h] = i + 1;
+	else if (l->type == CFGIDX_DIRECTIVE)
+	    hash[h] = i + 1;
+	else
+	{
+	    /* Chain later headers of the same name to the first. */
+	    while (m->next != CFGIDX_NONE) m = &lines[m->next];
+	    m->next = i;
+	}
+    }
+    *len = hdr->size;
+    return base;
+}
+
+/* Write the index beside the configuration file, replacing any old one.
+   Failure only means the next program builds its own. */
+static void save_index (const char *fname, const char *base, size_t len)
+{
+    char idxname[2*CFGWIDTH], tmpname[2*CFGWIDTH+16];
+    int fd;
+    ssize_t n;
+
+    snprintf (idxname, sizeof(idxname), "%s%s", fname, CFGIDX_SUFFIX);
+    snprintf (tmpname, sizeof(tmpname), "%s.%d", idxname, (int) getpid ());
+    if ((fd = open (tmpname, O_WRONLY|O_CREAT|O_TRUNC, 0644)) < 0) return;
+    n = write (fd, base, len);
+    if (close (fd) != 0 || n != (ssize_t) len || rename (tmpname, idxname) != 0)
+	unlink (tmpname);
+}
+
+/***********************************************************************
+ * Loading an index.
+ **********************************************************************/
+
+/* Return TRUE if off is the offset of a string in the string area of
+   the index, terminated within max bytes. */
+static int valid_string (cfg_index *ci, uint32_t off, size_t max)
+{
+    uint64_t start = HDR(ci)->hash + (uint64_t) HDR(ci)->nhash * sizeof(uint32_t);
+
+    if (off < start || off >= ci->len) return FALSE;
+    if (max > ci->len - off) max = ci->len - off;
+    return memchr (ci->base + off, '\0', max) != NULL;
+}
+
+/* Return TRUE if a saved index is laid out as layout() builds it, so
+   that no table, string or line number of it leads outside the index,
+   beyond the CFGWIDTH buffers it is copied to, or around a loop. */
+static int valid_index (cfg_index *ci)
+{
+    cfgidx_hdr *hdr = HDR(ci);
+    cfgidx_line *l;
+    uint32_t i, empty;
+
+    if (memcmp (hdr->magic, CFGIDX_MAGIC, 4) != 0 || hdr->version != CFGIDX_VERSION
+	|| hdr->order != CFGIDX_ORDER || hdr->size != ci->len
+	|| hdr->files != sizeof(cfgidx_hdr)
+	|| hdr->lines != hdr->files + (uint64_t) hdr->nfiles * sizeof(cfgidx_file)
+	|| hdr->hash != hdr->lines + (uint64_t) hdr->nlines * sizeof(cfgidx_line)
+	|| hdr->hash + (uint64_t) hdr->nhash * sizeof(uint32_t) > ci->len
+	|| hdr->nhash <= hdr->nlines || (hdr->nhash & (hdr->nhash - 1)) != 0
+	|| ! valid_string (ci, hdr->params, ci->len)
+	|| ! valid_string (ci, hdr->last, CFGWIDTH))
+	return FALSE;
+    for (i = 0; i < hdr->nfiles; i++)
+	if (! valid_string (ci, FILES(ci)[i].name, ci->len)) return FALSE;
+    for (i = 0; i < hdr->nlines; i++)
+    {
+	l = &LINES(ci)[i];
+	if (! valid_string (ci, l->text, CFGWIDTH) || ! valid_string (ci, l->key, CFGWIDTH))
+	    return FALSE;
+	if (l->type == CFGIDX_HEADER)
+	{
+	    /* Headers of the same name are chained forward. */
+	    if (l->next != CFGIDX_NONE
+		&& (l->next <= i || l->next >= hdr->nlines || LINES(ci)[l->next].type != CFGIDX_HEADER))
+		return FALSE;
+	}
+	else if (l->type != CFGIDX_DIRECTIVE || ! valid_string (ci, l->value, CFGWIDTH)
+		 || (l->section != CFGIDX_NONE && l->section >= i))
+	    return FALSE;
+    }
+    /* Probing stops at an empty bucket. */
+    for (i = 0, empty = 0; i < hdr->nhash; i++)
+    {
+	if (HASH(ci)[i] > hdr->nlines) return FALSE;
+	if (HASH(ci)[i] == 0) empty++;
+    }
+    return empty > 0;
+}
+
+/* Return TRUE if every source file of the index is unchanged. */
+static int index_current (cfg_index *ci)
+{
+    cfgidx_file *f = FILES(ci);
+    struct stat st;
+    uint32_t i;
+
+    if (strcmp (STR(ci, HDR(ci)->params), cfgidx_params ()) != 0) return FALSE;
+    for (i = 0; i < HDR(ci)->nfiles; i++, f++)
+    {
+	if (stat (STR(ci, f->name), &st) != 0)
+	{
+	    if (f->exists) return FALSE;
+	    continue;
+	}
+	if (! f->exists || f->dev != (uint64_t) st.st_dev || f->ino != (uint64_t) st.st_ino
+	    || f->size != (int64_t) st.st_size || f->mtime != (int64_t) st.st_mtim.tv_sec
+	    || f->mtime_nsec != (int64_t) st.st_mtim.tv_nsec)
+	    return FALSE;
+    }
+    return TRUE;
+}
+
+static void free_index (cfg_index *ci)
+{
+    if (ci->mapped)
+	munmap (ci->base, ci->len);
+    else
+	free (ci->base);
+    free (ci->fname);
+    free (ci);
+}
+
+/* Map a saved index.  Returns NULL if there is none or it is damaged or
+   out of date, and the caller builds a new one. */
+static cfg_index *map_index (const char *fname)
+{
+    char idxname[2*CFGWIDTH];
+    struct stat st;
+    cfg_index *ci;
+    void *base;
+    int fd;
+
+    snprintf (idxname, sizeof(idxname), "%s%s", fname, CFGIDX_SUFFIX);
+    if ((fd = open (idxname, O_RDONLY)) < 0) return NULL;
+    if (fstat (fd, &st) != 0 || st.st_size < (off_t) sizeof(cfgidx_hdr))
+    {
+	close (fd);
+	return NULL;
+    }
+    base = mmap (NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close (fd);
+    if (base == MAP_FAILED) return NULL;
+    if ((ci = (cfg_index *) calloc (1, sizeof(cfg_index))) == NULL)
+    {
+	munmap (base, st.st_size);
+	return NULL;
+    }
+    ci->base = (char *) base;
+    ci->len = st.st_size;
+    ci->mapped = 1;
+    if (! valid_index (ci) || ! index_current (ci))
+    {
+	free_index (ci);
+	return NULL;
+    }
+    return ci;
+}
+
+/* Build an index from the configuration file.  Returns NULL if the file
+   cannot be read. */
+static cfg_index *build_index (const char *fname, int save)
+{
+    cfgidx_build b;
+    cfg_index *ci = NULL;
+    char *base = NULL;
+    size_t len;
+
+    memset (&b, 0, sizeof(b));
+    b.section = CFGIDX_NONE;
+    if (parse_file (&b, fname, 0) == SUCCESS && (base = layout (&b, &len)) != NULL
+	&& (ci = (cfg_index *) calloc (1, sizeof(cfg_index))) != NULL)
+    {
+	ci->base = base;
+	ci->len = len;
+	/* Do not save an index of a file that changed while it was read. */
+	if (save && index_current (ci))
+	    save_index (fname, base, len);
+    }
+    else
+	free (base);
+    free (b.files);
+    free (b.lines);
+    free (b.strings);
+    return ci;
+}
+
+/***********************************************************************
+ * cfgidx_get()
+ *	Return a current index of the configuration file, from the process
+ *	cache, a saved index or a new one.  Release it with cfgidx_release().
+ *	RETURNS NULL if indexes are turned off or the file cannot be read.
+ **********************************************************************/
+
+cfg_index *cfgidx_get (pchar fname)
+{
+    cfg_index *ci, **pp;
+    const char *mode = getenv (CFG_INDEX_VARNAME);
+
+    if (mode != NULL && strcasecmp (mode, "off") == 0) return NULL;
+    pthread_mutex_lock (&cache_lock);
+    for (pp = &cache; (ci = *pp) != NULL; )
+    {
+	if (! ci->stale && strcmp (ci->fname, fname) == 0)
+	{
+	    if (index_current (ci)) break;
+	    ci->stale = 1;
+	}
+	if (ci->stale && ci->refs == 0)
+	{
+	    *pp = ci->next;
+	    free_index (ci);
+	    continue;
+	}
+	pp = &ci->next;
+    }
+    if (ci == NULL)
+    {
+	if ((ci = map_index (fname)) == NULL)
+	    ci = build_index (fname, mode == NULL || strcasecmp (mode, "nosave") != 0);
+	if (ci != NULL && (ci->fname = strdup (fname)) == NULL)
+	{
+	    free_index (ci);
+	    ci = NULL;
+	}
+	if (ci != NULL)
+	{
+	    ci->next = cache;
+	    cache = ci;
+	}
+    }
+    if (ci != NULL) ci->refs++;
+    pthread_mutex_unlock (&cache_lock);
+    return ci;
+}
+
+void cfgidx_release (cfg_index *ci)
+{
+    pthread_mutex_lock (&cache_lock);
+    ci->refs--;
+    pthread_mutex_unlock (&cache_lock);
+}
+
+/***********************************************************************
+ * Lookups.
+ **********************************************************************/
+
+/* Return the first header line of the section, or CFGIDX_NONE. */
+static uint32_t find_section (cfg_index *ci, const char *section)
+{
+    char key[SECWIDTH+2];
+    cfgidx_line *l;
+    uint32_t h, j, mask = HDR(ci)->nhash - 1;
+
+    snprintf (key, sizeof(key), "[%s]", section);
+    upshift (key);
+    h = hash_key (key, CFGIDX_NONE);
+    for (j = h & mask; HASH(ci)[j] != 0; j = (j + 1) & mask)
+    {
+	l = &LINES(ci)[HASH(ci)[j] - 1];
+	if (l->hash == h && l->type == CFGIDX_HEADER && strcmp (STR(ci, l->key), key) == 0)
+	    return HASH(ci)[j] - 1;
+    }
+    return CFGIDX_NONE;
+}
+
+/* Return the last directive of the name in the section, or NULL. */
+static cfgidx_line *find_directive (cfg_index *ci, uint32_t section, const char *name)
+{
+    char key[CFGWIDTH];
+    cfgidx_line *l;
+    uint32_t h, j, mask = HDR(ci)->nhash - 1;
+
+    strncpy (key, name, CFGWIDTH-1);
+    key[CFGWIDTH-1] = '\0';
+    upshift (key);
+    h = hash_key (key, section);
+    for (j = h & mask; HASH(ci)[j] != 0; j = (j + 1) & mask)
+    {
+	l = &LINES(ci)[HASH(ci)[j] - 1];
+	if (l->hash == h && l->type == CFGIDX_DIRECTIVE && l->section == section
+	    && strcmp (STR(ci, l->key), key) == 0)
+	    return l;
+    }
+    return NULL;
+}
+
+/* Position after header line n, as skipto() leaves the file. */
+static short at_header (config_struc *cs, uint32_t n)
+{
+    cs->index_pos = n + 1;
+    strcpy (cs->lastread, STR(cs->index, LINES(cs->index)[n].text));
+    return SUCCESS;
+}
+
+/***********************************************************************
+ * cfgidx_skipto()
+ *	skipto() on an index.  Like skipto(), finds a named section
+ *	after the current position or else from the start of the file,
+ *	and "*" finds the next section after the current position.
+ **********************************************************************/
+
+short cfgidx_skipto (config_struc *cs, pchar section)
+{
+    cfg_index *ci = cs->index;
+    cfgidx_line *lines = LINES(ci);
+    uint32_t n, first, nlines = HDR(ci)->nlines;
+    int any = (strcmp (section, "*") == 0);
+    char s[SECWIDTH+2];
+
+    /* The line just read satisfies the request. */
+    snprintf (s, sizeof(s), "[%s]", section);
+    if ((strcasecmp (cs->lastread, s) == 0) || (any && (cs->lastread[0] == '[')))
+	return SUCCESS;
+    if (any)
+    {
+	for (n = cs->index_pos; n < nlines; n++)
+	    if (lines[n].type == CFGIDX_HEADER)
+		return at_header (cs, n);
+    }
+    else if ((first = find_section (ci, section)) != CFGIDX_NONE)
+    {
+	for (n = first; n != CFGIDX_NONE; n = lines[n].next)
+	    if (n >= cs->index_pos)
+		return at_header (cs, n);
+	return at_header (cs, first);
+    }
+    /* Not found, skipto() leaves the file rewound. */
+    cs->index_pos = 0;
+    cs->lastread[0] = '\0';
+    return FAILURE;
+}
+
+/***********************************************************************
+ * cfgidx_read()
+ *	read_cfg() on an index.
+ **********************************************************************/
+
+void cfgidx_read (config_struc *cs, pchar s1, pchar s2)
+{
+    cfg_index *ci = cs->index;
+    cfgidx_line *l;
+
+    *s1 = '\0';
+    *s2 = '\0';
+    if (cs->index_pos >= (int) HDR(ci)->nlines)
+    {
+	strcpy (cs->lastread, STR(ci, HDR(ci)->last));
+	return;
+    }
+    l = &LINES(ci)[cs->index_pos++];
+    strcpy (cs->lastread, STR(ci, l->text));
+    if (l->type == CFGIDX_HEADER) return;
+    strcpy (s1, STR(ci, l->key));
+    strcpy (s2, STR(ci, l->value));
+}
+
+/***********************************************************************
+ * cfg_lookup()
+ *	Find the value of one directive in a section of a configuration
+ *	file.  If the directive appears more than once in the section, the
+ *	last value is returned.  value must hold CFGWIDTH characters.
+ *
+ *	RETURNS 0 upon success, 1 if the file, section or directive is
+ *	not found.
+ **********************************************************************/
+
+short cfg_lookup (pchar fname, pchar section, pchar name, pchar value)
+{
+    config_struc cs;
+    cfg_index *ci;
+    cfgidx_line *l;
+    uint32_t n;
+    char str1[CFGWIDTH], str2[CFGWIDTH], key[CFGWIDTH];
+    short status = FAILURE;
+
+    value[0] = '\0';
+    if ((ci = cfgidx_get (fname)) != NULL)
+    {
+	if ((n = find_section (ci, section)) != CFGIDX_NONE
+	    && (l = find_directive (ci, n, name)) != NULL)
+	{
+	    strcpy (value, STR(ci, l->value));
+	    status = SUCCESS;
+	}
+	cfgidx_release (ci);
+	return status;
+    }
+
+    /* No index, read the section. */
+    strncpy (key, name, CFGWIDTH-1);
+    key[CFGWIDTH-1] = '\0';
+    upshift (key);
+    memset (&cs, 0, sizeof(cs));
+    if (open_cfg (&cs, fname, section) == SUCCESS)
+    {
+	do
+	{
+	    read_cfg (&cs, str1, str2);
+	    if (str1[0] == '\0')
+		break;
+	    if (strcmp (str1, key) == 0)
+	    {
+		strcpy (value, str2);
+		status = SUCCESS;
+	    }
+	}
+	while (1);
+    }
+    close_cfg (&cs);
+    return status;
+}
@@ -29,6 +29,8 @@ Edit History:
 		      Remove duplicate definition of config_struc.
 		      Fixed include file handling to allow include file at
 		      any place in the configuration files.
+   13 19 Oct 2026     Use the compiled index of a configuration file when
+		      there is one, see cfgindex.c.
 */
 #include <stdio.h>
 #include <stdlib.h>
@@ -49,7 +51,7 @@ Edit History:
 
 #define COMSERV_PARAMS_ENV "COMSERV_PARAMS"	/* the params dir where @ included file will be found */
 
-short VER_CFGUTIL = 13 ;
+short VER_CFGUTIL = 14 ;
 
 #define SUCCESS 0
 #define FAILURE 1
@@ -148,6 +150,10 @@ short skipto (config_struc *cs, pchar section)
 	/* No section is specified. */
 	return FAILURE;
     } 
+    if (cs->index != NULL)
+    {
+	return cfgidx_skipto(cs, section);
+    }
     if (cs->current_file == -1) 
     {
 	/* No configuration file open. */
@@ -225,6 +231,16 @@ short skipto (config_struc *cs, pchar section)
    Return FAILURE otherwise. */
 short open_cfg (config_struc *cs, pchar fname, pchar section)
 {
+    /* Use the index of the file when there is one. */
+    if ((cs->index = cfgidx_get (fname)) != NULL) {
+	cs->cfg_init = 1;
+	cs->current_file = 0;
+	cs->cfgfile[0] = NULL;
+	cs->index_pos = 0;
+	cs->lastread[0] = '\0' ;
+	cs->current_section = section;
+	return skipto(cs, section) ;
+    }
     if (_open_cfg (cs, fname) != SUCCESS) {
 	return FAILURE; /* Error opening config file. */
     }
@@ -246,6 +262,11 @@ void read_cfg (config_struc *cs, pchar s1, pchar s2)
 /* start with two null strings, in case things don't go well */
     *s1 = '\0' ;
     *s2 = '\0' ;
+    if (cs->index != NULL)
+    {
+	cfgidx_read(cs, s1, s2);
+	return;
+    }
     do
     {
 	/* Ensure we have an open configuration file. */
@@ -308,6 +329,14 @@ void read_cfg (config_struc *cs, pchar s1, pchar s2)
 /* Close all files (including any included files) opend with this config_struct. */
 void close_cfg (config_struc *cs)
 {
+    if (cs->cfg_init != 0 && cs->index != NULL)
+    {
+	cfgidx_release(cs->index);
+	cs->index = NULL;
+	cs->current_file = -1;
+	cs->cfg_init = 0;
+	return;
+    }
     if (cs->cfg_init == 0 || cs->current_file == -1 || cs->cfgfile[cs->current_file] == NULL) 
     { 
 	cs->cfg_init = 0;
@@ -0,0 +1,475 @@
+/***********************************************************************
+ * chanstats.c - server and per-channel statistics in the server shared
+ * memory segment.
+ *
+ * The server calls cs_stats_update() for every record it queues.  The
+ * channel of the record is found through a hash index that is private
+ * to the server, so the update only decodes the fixed header of the
+ * record and adjusts a few counters in the table.
+ *
+ * The server statistics are counted with cs_stats_packet() and the
+ * other counters between cs_stats_server_begin() and _end().  Ring fill
+ * and client lag are found by cs_stats_sample(), which walks the rings
+ * and which the server calls about once a second.
+ *
+ * Readers attach the server segment read-only with cs_stats_attach()
+ * and copy entries with cs_stats_read(), which retries while the server
+ * is updating the entry.
+ *
+ * 2026-10-19 Initial version.
+ * 2026-10-19 Added the server statistics.
+ **********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+
+#include "dpstruc.h"
+#include "seedstrc.h"
+#include "service.h"
+#include "stuff.h"
+#include "chanstats.h"
+
+#define KEY_LEN		12		/* Station, location, channel, net	*/
+#define INTERVAL_WEIGHT	0.125		/* Smoothing of record_interval		*/
+#define READ_TRIES	100000		/* Give up waiting for a dead writer	*/
+
+/* Server's private index of the table. */
+typedef struct {
+    char key[KEY_LEN];
+    int32_t index;
+} STATS_SLOT;
+
+static const double hist_bounds[CS_HIST_BUCKETS - 1] = CS_HIST_BOUNDS;
+static cs_stats_table *index_table = NULL;
+static STATS_SLOT *slots = NULL;
+static uint32_t slot_mask = 0;
+
+static uint16_t get2 (const void *p, int swap)
+{
+    uint16_t v;
+
+    memcpy (&v, p, 2);
+    return swap ? (uint16_t)((v >> 8) | (v << 8)) : v;
+}
+
+/***********************************************************************
+ * seed_epoch()
+ *	Return the SEED start time in seconds since 1970.
+ **********************************************************************/
+
+static double seed_epoch (const seed_time_struc *st, int swap)
+{
+    int yr = (int16_t)get2 (&st->yr, swap);
+    int jday = get2 (&st->jday, swap);
+    int y = yr - 1;
+    int32_t days;
+
+    days = (yr - 1970) * 365 + (y / 4 - 1969 / 4) - (y / 100 - 1969 / 100)
+	+ (y / 400 - 1969 / 400) + jday - 1;
+    return (double)days * 86400.0 + st->hr * 3600.0 + st->minute * 60.0
+	+ st->seconds + get2 (&st->tenth_millisec, swap) * 0.0001;
+}
+
+/***********************************************************************
+ * seed_rate()
+ *	Return the sample rate in samples per second, 0 if none.
+ **********************************************************************/
+
+static double seed_rate (int factor, int mult)
+{
+    if (factor == 0 || mult == 0) return 0.0;
+    if (factor > 0)
+	return (mult > 0) ? (double)factor * mult : -(double)factor / mult;
+    return (mult > 0) ? -(double)mult / factor : 1.0 / ((double)factor * mult);
+}
+
+/* Copy a blank padded SEED code, dropping trailing blanks. */
+static void copy_code (char *dst, const char *src, int n)
+{
+    memcpy (dst, src, n);
+    while (n > 0 && (dst[n-1] == ' ' || dst[n-1] == '\0')) --n;
+    dst[n] = '\0';
+}
+
+static uint32_t key_hash (const char *key)
+{
+    uint32_t h = 2166136261u;
+    int i;
+
+    for (i = 0; i < KEY_LEN; i++)
+	h = (h ^ (unsigned char)key[i]) * 16777619u;
+    return h;
+}
+
+/***********************************************************************
+ * cs_stats_size()
+ *	RETURNS the bytes needed for a table of maxchan channels.
+ **********************************************************************/
+
+int32_t cs_stats_size (int maxchan)
+{
+    if (maxchan < 1) maxchan = 1;
+    return (int32_t)(offsetof(cs_stats_table, chan) + maxchan * sizeof(cs_chan_stats));
+}
+
+/***********************************************************************
+ * cs_stats_init()
+ *	Initialize an empty table in the server segment, and the
+ *	server's index of it.
+ **********************************************************************/
+
+void cs_stats_init (cs_stats_table *t, int maxchan)
+{
+    uint32_t nslots;
+
+    if (maxchan < 1) maxchan = 1;
+    memset (t, 0, cs_stats_size (maxchan));
+    t->magic = CS_STATS_MAGIC;
+    t->version = CS_STATS_VERSION;
+    t->entry_size = sizeof(cs_chan_stats);
+    t->maxchan = maxchan;
+    t->start_time = dtime ();
+    t->server.link_up = -1;
+    t->server.link_buffer_fill = -1;
+
+    for (nslots = 16; nslots < 2 * (uint32_t)maxchan; nslots <<= 1)
+	;
+    free (slots);
+    if ((slots = (STATS_SLOT *)calloc (nslots, sizeof(STATS_SLOT))) == NULL)
+    {
+	index_table = NULL;
+	return;
+    }
+    slot_mask = nslots - 1;
+    index_table = t;
+}
+
+/***********************************************************************
+ * find_channel()
+ *	Return the entry of the channel, adding it if it is new.
+ *	RETURNS NULL if the table is full.
+ **********************************************************************/
+
+static cs_chan_stats *find_channel (cs_stats_table *t, const seed_record_header *h)
+{
+    char key[KEY_LEN];
+    STATS_SLOT *slot;
+    cs_chan_stats *c;
+    uint32_t i;
+
+    memcpy (key, h->station_ID_call_letters, 5);
+    memcpy (key + 5, h->location_id, 2);
+    memcpy (key + 7, h->channel_id, 3);
+    memcpy (key + 10, h->seednet, 2);
+    for (i = key_hash (key) & slot_mask; ; i = (i + 1) & slot_mask)
+    {
+	slot = &slots[i];
+	if (slot->index == 0) break;
+	if (memcmp (slot->key, key, KEY_LEN) == 0)
+	    return &t->chan[slot->index - 1];
+    }
+    if (t->nchan >= t->maxchan)
+	return NULL;
+
+    c = &t->chan[t->nchan];
+    memset (c, 0, sizeof(cs_chan_stats));
+    copy_code (c->station, h->station_ID_call_letters, 5);
+    copy_code (c->location, h->location_id, 2);
+    copy_code (c->channel, h->channel_id, 3);
+    copy_code (c->net, h->seednet, 2);
+    memcpy (slot->key, key, KEY_LEN);
+    slot->index = t->nchan + 1;
+    __atomic_store_n (&t->nchan, t->nchan + 1, __ATOMIC_RELEASE);
+    return c;
+}
+
+/***********************************************************************
+ * cs_stats_update()
+ *	Add a MiniSEED record that the server has queued to the table.
+ *	The record header may be in either byte order.
+ **********************************************************************/
+
+void cs_stats_update (cs_stats_table *t, const char *pkt, int len, short qnum,
+		      double reception_time)
+{
+    const seed_record_header *h = (const seed_record_header *)pkt;
+    cs_chan_stats *c;
+    double start, end, rate, diff;
+    int yr, nsamples, swap;
+
+    if (t == NULL || t != index_table || len < (int)sizeof(seed_record_header))
+	return;
+    /* Decide the byte order of the header from the year. */
+    yr = (int16_t)get2 (&h->starting_time.yr, 0);
+    swap = (yr < 1900 || yr > 2100);
+    if ((c = find_channel (t, h)) == NULL)
+    {
+	++t->dropped;
+	return;
+    }
+
+    __atomic_store_n (&c->seq, c->seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence (__ATOMIC_RELEASE);
+
+    if (c->records == 0)
+	c->first_reception = reception_time;
+    else if (c->records == 1)
+	c->record_interval = reception_time - c->last_reception;
+    else
+	c->record_interval += INTERVAL_WEIGHT *
+	    ((reception_time - c->last_reception) - c->record_interval);
+    c->last_reception = reception_time;
+    c->qnum = qnum;
+    ++c->records;
+
+    nsamples = get2 (&h->samples_in_record, swap);
+    rate = seed_rate ((int16_t)get2 (&h->sample_rate_factor, swap),
+		      (int16_t)get2 (&h->sample_rate_multiplier, swap));
+    if (nsamples > 0 && rate > 0.0)
+    {
+	start = seed_epoch (&h->starting_time, swap);
+	end = start + nsamples / rate;
+	if (c->samples > 0)
+	{
+	    diff = start - c->last_end;
+	    if (diff > 0.5 / rate)
+	    {
+		++c->gaps;
+		c->gap_seconds += diff;
+		c->last_gap = diff;
+		c->last_gap_time = start;
+	    }
+	    else if (diff < -0.5 / rate)
+	    {
+		++c->overlaps;
+		c->overlap_seconds -= diff;
+		c->last_gap = diff;
+		c->last_gap_time = start;
+	    }
+	}
+	c->sample_rate = rate;
+	c->last_start = start;
+	c->last_end = end;
+	c->samples += nsamples;
+    }
+
+    __atomic_store_n (&c->seq, c->seq + 1, __ATOMIC_RELEASE);
+}
+
+/***********************************************************************
+ * cs_stats_server_begin(), cs_stats_server_end()
+ *	Bracket updates of the server statistics.  The server must not
+ *	update them from two threads at once.
+ **********************************************************************/
+
+cs_server_stats *cs_stats_server_begin (cs_stats_table *t)
+{
+    __atomic_store_n (&t->server.seq, t->server.seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence (__ATOMIC_RELEASE);
+    return &t->server;
+}
+
+void cs_stats_server_end (cs_stats_table *t)
+{
+    __atomic_store_n (&t->server.seq, t->server.seq + 1, __ATOMIC_RELEASE);
+}
+
+/***********************************************************************
+ * cs_hist_add()
+ *	Add a time in seconds to a histogram.
+ **********************************************************************/
+
+void cs_hist_add (cs_hist *h, double seconds)
+{
+    int i;
+
+    for (i = 0; i < CS_HIST_BUCKETS - 1 && seconds > hist_bounds[i]; i++)
+	;
+    ++h->bucket[i];
+    ++h->count;
+    h->sum += seconds;
+}
+
+/***********************************************************************
+ * cs_stats_packet()
+ *	Count a packet the server has queued in ring qnum.
+ **********************************************************************/
+
+void cs_stats_packet (cs_stats_table *t, short qnum, int len, double reception_time,
+		      double now)
+{
+    cs_server_stats *s;
+
+    if (t == NULL || qnum < 0 || qnum >= NUMQ) return;
+    s = cs_stats_server_begin (t);
+    ++s->packets[qnum];
+    s->bytes += len;
+    if (reception_time > 0.0 && now >= reception_time)
+	cs_hist_add (&s->queue_delay, now - reception_time);
+    cs_stats_server_end (t);
+}
+
+/***********************************************************************
+ * cs_stats_sample()
+ *	Record how full the rings are and how far each client is behind.
+ *	A client is behind by the packets after the last one it has
+ *	acknowledged, or by all packets in the rings if it has not
+ *	acknowledged a packet that is still there.
+ **********************************************************************/
+
+void cs_stats_sample (cs_stats_table *t, tring *rings, tclients *clients, int nclients)
+{
+    cs_server_stats *s;
+    cs_client_stats *cs;
+    tclients *c;
+    pring_elem p;
+    double now, oldest;
+    uint32_t blocked, lag;
+    int i, q, n;
+
+    if (t == NULL) return;
+    if (nclients > MAXCLIENTS) nclients = MAXCLIENTS;
+    now = dtime ();
+    s = cs_stats_server_begin (t);
+    for (q = 0; q < NUMQ; q++)
+    {
+	blocked = 0;
+	for (p = rings[q].head, n = 0; n < rings[q].count; n++, p = p->next)
+	    if (p->blockmap) ++blocked;
+	for (p = rings[q].tail, n = 0; p != rings[q].head && n < rings[q].count; n++)
+	    p = p->next;
+	s->ring_count[q] = rings[q].count;
+	s->ring_used[q] = n;
+	s->ring_blocked[q] = blocked;
+    }
+    for (i = 0; i < nclients; i++)
+    {
+	c = &clients[i];
+	cs = &s->client[i];
+	memset (cs, 0, sizeof(cs_client_stats));
+	copy_code (cs->name, (const char *)&c->client_name, 
+		   (CLIENT_NAME_SIZE < 31) ? CLIENT_NAME_SIZE : 31);
+	cs->pid = c->client_pid;
+	cs->blocking = c->blocking;
+	cs->last_service = c->last_service;
+	if (c->client_pid == NOCLIENT) continue;
+	lag = 0;
+	oldest = 0.0;
+	for (q = 0; q < NUMQ; q++)
+	{
+	    p = c->last[q].scan;
+	    if (p == NULL || p->packet_num != c->last[q].packet)
+		p = rings[q].tail;
+	    for (n = 0; p != rings[q].head && n < rings[q].count; n++, p = p->next)
+	    {
+		if (lag++ == 0 || p->user_data.reception_time < oldest)
+		    oldest = p->user_data.reception_time;
+	    }
+	}
+	cs->lag_packets = lag;
+	cs->lag_seconds = (lag > 0 && oldest > 0.0) ? now - oldest : 0.0;
+    }
+    s->nclients = nclients;
+    s->sample_time = now;
+    cs_stats_server_end (t);
+}
+
+/***********************************************************************
+ * cs_stats_attach()
+ *	Attach read-only to the segment of the server with segkey.
+ *	*segment is set to the segment address for cs_stats_detach().
+ *	RETURNS the statistics table, or NULL if the server has none.
+ **********************************************************************/
+
+cs_stats_table *cs_stats_attach (int segkey, void **segment)
+{
+    struct shmid_ds ds;
+    pserver_struc base;
+    cs_stats_table *t;
+    int shmid;
+    int32_t off;
+
+    *segment = NULL;
+    if ((shmid = shmget (segkey, 0, 0)) < 0 || shmctl (shmid, IPC_STAT, &ds) < 0)
+	return NULL;
+    base = (pserver_struc) shmat (shmid, NULL, SHM_RDONLY);
+    if (base == (pserver_struc) -1)
+	return NULL;
+    off = base->stats_offset;
+    if (base->init != 'I' || off < (int32_t)sizeof(tserver_struc)
+	|| off + offsetof(cs_stats_table, chan) > ds.shm_segsz)
+    {
+	shmdt ((char *)base);
+	return NULL;
+    }
+    t = (cs_stats_table *)((char *)base + off);
+    if (t->magic != CS_STATS_MAGIC || t->version != CS_STATS_VERSION
+	|| t->entry_size != sizeof(cs_chan_stats)
+	|| off + (size_t)cs_stats_size (t->maxchan) > ds.shm_segsz)
+    {
+	shmdt ((char *)base);
+	return NULL;
+    }
+    *segment = base;
+    return t;
+}
+
+void cs_stats_detach (void *segment)
+{
+    if (segment != NULL) shmdt ((char *)segment);
+}
+
+/***********************************************************************
+ * cs_stats_read()
+ *	Copy entry i of the table.
+ *	RETURNS 0 upon success, -1 if there is no such entry.
+ **********************************************************************/
+
+int cs_stats_read (const cs_stats_table *t, int i, cs_chan_stats *copy)
+{
+    uint32_t seq;
+    int tries = 0;
+
+    if (i < 0 || (uint32_t)i >= __atomic_load_n (&t->nchan, __ATOMIC_ACQUIRE))
+	return -1;
+    do
+    {
+	while (((seq = __atomic_load_n (&t->chan[i].seq, __ATOMIC_ACQUIRE)) & 1)
+	       && ++tries < READ_TRIES)
+	    ;
+	memcpy (copy, (const void *)&t->chan[i], sizeof(cs_chan_stats));
+	__atomic_thread_fence (__ATOMIC_ACQUIRE);
+    }
+    /* A server that died during an update leaves the entry odd. */
+    while (__atomic_load_n (&t->chan[i].seq, __ATOMIC_RELAXED) != seq
+	   && ++tries < READ_TRIES);
+    return 0;
+}
+
+/***********************************************************************
+ * cs_stats_read_server()
+ *	Copy the server statistics.
+ **********************************************************************/
+
+void cs_stats_read_server (const cs_stats_table *t, cs_server_stats *copy)
+{
+    uint32_t seq;
+    int tries = 0;
+
+    do
+    {
+	while (((seq = __atomic_load_n (&t->server.seq, __ATOMIC_ACQUIRE)) & 1)
+	       && ++tries < READ_TRIES)
+	    ;
+	memcpy (copy, (const void *)&t->server, sizeof(cs_server_stats));
+	__atomic_thread_fence (__ATOMIC_ACQUIRE);
+    }
+    while (__atomic_load_n (&t->server.seq, __ATOMIC_RELAXED) != seq
+	   && ++tries < READ_TRIES);
+}
@@ -0,0 +1,288 @@
+/***********************************************************************
+ * logasync.c - asynchronous writer for LogMessage().
+ *
+ * Each thread that logs gets its own single-producer, single-consumer
+ * ring of length-prefixed lines.  The owning thread only advances the
+ * ring head and the writer thread only advances the tail, so putting a
+ * line takes no lock and never waits for the log file.  Rings are kept
+ * on a list that only grows; a ring released by an exiting thread is
+ * reused by the next new thread.
+ *
+ * The writer thread drains every ring through log_emit_line(), which
+ * handles the daily logfile change, and flushes after each ring.  Lines
+ * from one thread stay in order; lines from different threads are
+ * written in the order the writer finds them.
+ *
+ * LogAsyncStop() first stops ring_put() from queueing lines and waits
+ * for the puts in progress, so no line is queued after the last drain.
+ * Later lines are written synchronously by the logging thread.
+ *
+ * 2026-10-19 Initial version.
+ * 2026-10-19 Stop queueing before the writer is stopped, and hold
+ *	      log_lock() while writing.
+ **********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "logging.h"
+#include "logasync.h"
+
+#define LOG_RING_MASK	(LOG_RING_SIZE - 1)
+#define LOG_LEN_SIZE	((uint32_t)sizeof(uint32_t))
+
+typedef struct _log_ring {
+    char buf[LOG_RING_SIZE];
+    uint32_t head;		/* Put position, written by owner thread.	*/
+    uint32_t tail;		/* Take position, written by writer thread.	*/
+    uint32_t dropped;		/* Lines dropped because the ring was full.	*/
+    uint32_t reported;		/* Dropped lines already reported.		*/
+    int in_use;			/* Ring is owned by a thread.			*/
+    struct _log_ring *next;
+} LOG_RING;
+
+static LOG_RING *rings = NULL;		/* All rings, never freed.		*/
+static __thread LOG_RING *my_ring = NULL;
+static pthread_key_t ring_key;
+static pthread_once_t ring_key_once = PTHREAD_ONCE_INIT;
+static pthread_t writer;
+static int running = 0;
+static int accepting = 0;		/* ring_put() may queue lines.		*/
+static int putting = 0;			/* ring_put() calls in progress.	*/
+static int atexit_set = 0;
+static char line_buf[LOG_RING_SIZE];	/* Writer copy of a wrapped line.	*/
+
+/***********************************************************************
+ * ring_release()
+ *	Thread exit destructor.  Let another thread reuse the ring.
+ **********************************************************************/
+
+static void ring_release(void *p)
+{
+    __atomic_store_n(&((LOG_RING *)p)->in_use, 0, __ATOMIC_RELEASE);
+}
+
+static void ring_key_create(void)
+{
+    pthread_key_create(&ring_key, ring_release);
+}
+
+/***********************************************************************
+ * ring_get()
+ *	Return the calling thread's ring, claiming a released ring or
+ *	adding a new one on first use.  Returns NULL if out of memory.
+ **********************************************************************/
+
+static LOG_RING *ring_get(void)
+{
+    LOG_RING *r;
+    int free_ring;
+
+    if (my_ring != NULL) return my_ring;
+    for (r = __atomic_load_n(&rings, __ATOMIC_ACQUIRE); r != NULL; r = r->next)
+    {
+	free_ring = 0;
+	if (__atomic_compare_exchange_n(&r->in_use, &free_ring, 1, 0,
+					__ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+	    break;
+    }
+    if (r == NULL)
+    {
+	if ((r = (LOG_RING *)calloc(1, sizeof(LOG_RING))) == NULL) return NULL;
+	r->in_use = 1;
+	r->next = __atomic_load_n(&rings, __ATOMIC_RELAXED);
+	while (! __atomic_compare_exchange_n(&rings, &r->next, r, 0,
+					     __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+	    ;
+    }
+    pthread_once(&ring_key_once, ring_key_create);
+    pthread_setspecific(ring_key, r);
+    my_ring = r;
+    return r;
+}
+
+/* Copy to and from ring positions, wrapping at the end of the ring. */
+static void ring_copy_in(LOG_RING *r, uint32_t pos, const void *src, uint32_t n)
+{
+    uint32_t off = pos & LOG_RING_MASK;
+    uint32_t first = (n < LOG_RING_SIZE - off) ? n : LOG_RING_SIZE - off;
+
+    memcpy(r->buf + off, src, first);
+    memcpy(r->buf, (const char *)src + first, n - first);
+}
+
+static void ring_copy_out(LOG_RING *r, uint32_t pos, void *dst, uint32_t n)
+{
+    uint32_t off = pos & LOG_RING_MASK;
+    uint32_t first = (n < LOG_RING_SIZE - off) ? n : LOG_RING_SIZE - off;
+
+    memcpy(dst, r->buf + off, first);
+    memcpy((char *)dst + first, r->buf, n - first);
+}
+
+/***********************************************************************
+ * ring_queue()
+ *	Put a formatted line in the calling thread's ring.
+ *	RETURNS 0 upon success, -1 if the line was dropped.
+ **********************************************************************/
+
+static int ring_queue(const char *line, int len)
+{
+    LOG_RING *r;
+    uint32_t head, tail, n, need;
+
+    if ((r = ring_get()) == NULL) return -1;
+    n = (uint32_t)len;
+    need = LOG_LEN_SIZE + n;
+    head = r->head;
+    tail = __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE);
+    if (need > LOG_RING_SIZE - (head - tail))
+    {
+	__atomic_fetch_add(&r->dropped, 1, __ATOMIC_RELAXED);
+	return -1;
+    }
+    ring_copy_in(r, head, &n, LOG_LEN_SIZE);
+    ring_copy_in(r, head + LOG_LEN_SIZE, line, n);
+    __atomic_store_n(&r->head, head + need, __ATOMIC_RELEASE);
+    return 0;
+}
+
+/***********************************************************************
+ * ring_put()
+ *	log_async_put() hook.  Queue the line unless LogAsyncStop() has
+ *	begun.
+ *	RETURNS 0 upon success, -1 if the line was dropped, or
+ *	LOG_ASYNC_STOPPED.
+ **********************************************************************/
+
+static int ring_put(const char *line, int len)
+{
+    int rc = LOG_ASYNC_STOPPED;
+
+    __atomic_fetch_add(&putting, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&accepting, __ATOMIC_SEQ_CST))
+	rc = ring_queue(line, len);
+    __atomic_fetch_sub(&putting, 1, __ATOMIC_RELEASE);
+    return rc;
+}
+
+/***********************************************************************
+ * ring_drain()
+ *	Write all queued lines from all rings, and flush.
+ *	Only one thread may drain at a time.
+ *	RETURNS the number of lines written.
+ **********************************************************************/
+
+static int ring_drain(void)
+{
+    LOG_RING *r;
+    uint32_t head, tail, n, off, dropped;
+    int nlines = 0;
+
+    for (r = __atomic_load_n(&rings, __ATOMIC_ACQUIRE); r != NULL; r = r->next)
+    {
+	head = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+	tail = r->tail;
+	if (tail != head) log_lock();
+	while (tail != head)
+	{
+	    ring_copy_out(r, tail, &n, LOG_LEN_SIZE);
+	    off = (tail + LOG_LEN_SIZE) & LOG_RING_MASK;
+	    if (off + n <= LOG_RING_SIZE)
+		log_emit_line(r->buf + off, (int)n);
+	    else
+	    {
+		ring_copy_out(r, tail + LOG_LEN_SIZE, line_buf, n);
+		log_emit_line(line_buf, (int)n);
+	    }
+	    tail += LOG_LEN_SIZE + n;
+	    ++nlines;
+	    if (tail == head)
+	    {
+		log_flush();
+		log_unlock();
+	    }
+	}
+	__atomic_store_n(&r->tail, tail, __ATOMIC_RELEASE);
+
+	dropped = __atomic_load_n(&r->dropped, __ATOMIC_RELAXED);
+	if (dropped != r->reported)
+	{
+	    LogMessage(CS_LOG_TYPE_ERROR, "LogMessage(): %u lines dropped, log ring full\n",
+		       dropped - r->reported);
+	    r->reported = dropped;
+	}
+    }
+    return nlines;
+}
+
+/***********************************************************************
+ * log_writer()
+ *	Writer thread.  Drain the rings until stopped, sleeping briefly
+ *	whenever there is nothing to write.
+ **********************************************************************/
+
+static void *log_writer(void *arg)
+{
+    struct timespec idle;
+
+    idle.tv_sec = 0;
+    idle.tv_nsec = LOG_ASYNC_IDLE_USEC * 1000L;
+    while (__atomic_load_n(&running, __ATOMIC_ACQUIRE))
+    {
+	if (ring_drain() == 0) nanosleep(&idle, NULL);
+    }
+    ring_drain();
+    return NULL;
+}
+
+/***********************************************************************
+ * LogAsyncStart()
+ *	Start the writer thread and send LogMessage() output through it.
+ *	LogInit() must be called first.
+ *
+ *	RETURNS 0 upon success, -1 upon failure
+ **********************************************************************/
+
+int LogAsyncStart(void)
+{
+    int rc;
+
+    if (running) return 0;
+    running = 1;
+    if ((rc = pthread_create(&writer, NULL, log_writer, NULL)) != 0)
+    {
+	running = 0;
+	LogMessage(CS_LOG_TYPE_ERROR, "LogAsyncStart(): Error %d creating writer thread\n", rc);
+	return -1;
+    }
+    __atomic_store_n(&log_async_put, ring_put, __ATOMIC_RELEASE);
+    __atomic_store_n(&accepting, 1, __ATOMIC_SEQ_CST);
+    if (! atexit_set)
+    {
+	atexit(LogAsyncStop);
+	atexit_set = 1;
+    }
+    return 0;
+}
+
+/***********************************************************************
+ * LogAsyncStop()
+ *	Return to synchronous logging, write all queued lines, and stop
+ *	the writer thread.  Other threads may keep logging meanwhile.
+ **********************************************************************/
+
+void LogAsyncStop(void)
+{
+    if (! running) return;
+    __atomic_store_n(&accepting, 0, __ATOMIC_SEQ_CST);
+    while (__atomic_load_n(&putting, __ATOMIC_ACQUIRE) != 0)
+	sched_yield();
+    __atomic_store_n(&running, 0, __ATOMIC_RELEASE);
+    pthread_join(writer, NULL);
+}
@@ -4,8 +4,10 @@
 #include <time.h>
 #include <stdarg.h>
 #include <stdint.h>
+#include <sched.h>
 
 #include "logging.h"
+#include "logasync.h"
 #include "dpstruc.h"
 #include "cfgutil.h"
 #include "csconfig.h"
@@ -20,6 +22,17 @@
     Changed timestamp to ISO format:  yyyy-mm-ddThh:mm:ss
     Added additional functions to allow redefing printf calls to logging calls.
   29 Sep 2020 DSN Updated for comserv3.
+  2026-10-19
+    Format each message into a per-call buffer with a per-thread cached
+    timestamp, so concurrent callers no longer share one static buffer.
+    Log file output moved to log_emit_line() and log_flush(), which are
+    also used by the asynchronous writer in logasync.c.
+  2026-10-19
+    Only change to a new logfile when the date of a line is later than
+    the current one, since the asynchronous writer can write lines from
+    different threads out of time order.  Serialize log_emit_line()
+    callers with log_lock(), and write synchronously when the
+    asynchronous writer is stopped.
 */
 
 #define         DATE_LEN                16	/** Length of the date field **/
@@ -28,18 +41,25 @@ static FILE   *fp = NULL;
 static char   date[DATE_LEN];
 static char   datetime[DATETIME_LEN];
 static char   date_prev[DATE_LEN];
+static __thread time_t ts_epoch = -1;		/* Cached timestamp for thread. */
+static __thread char ts_datetime[DATETIME_LEN];
 static char  log_path[1024];
 static char  log_name[1024];
 static char  log_fullpath[2048+1+16];
 static int   log_bufsize;
 static int   log_mode;
-static char * buf;
 static int   init=0;
+static int   emit_lock=0;	/* Held while writing to the log file.	*/
+
+/* Set by LogAsyncStart() to queue lines for the writer thread.	*/
+int (*log_async_put)(const char *line, int len) = NULL;
 
 
 #define DATE_FORMAT	 "%04d-%02d-%02d"
 #define TIME_FORMAT	 "%02d:%02d:%02d"
 #define DATETIME_FORMAT DATE_FORMAT "T" TIME_FORMAT
+#define DATE_STRLEN	10	/* strlen of DATE_FORMAT output	*/
+#define DATETIME_STRLEN	19	/* strlen of DATETIME_FORMAT output	*/
 
 #define LOG_MAX_TYPE 3
 char log_type_string[LOG_MAX_TYPE][10]= {"INFO", "DEBUG", "ERROR"};
@@ -100,13 +120,6 @@ int LogInit(int mode, char *path, char *logname, int buf_size)
     	strcpy(log_name, logname);
     }
     log_bufsize = buf_size;
-
-    /* allocate the message buffer */
-    if ( (buf = (char *) malloc( (size_t) log_bufsize)) == NULL)
-    {
-	fprintf(stderr, "LogInit(): Fatal Error, malloc() of %d bytes failed.\n", buf_size);
-	return -1;
-    }
     switch (mode) 
     {
   	case CS_LOG_MODE_TO_STDOUT:
@@ -134,6 +147,113 @@ int LogInit(int mode, char *path, char *logname, int buf_size)
     return 0;
 }
 
+/***********************************************************************
+ * log_datetime()
+ *	Return the current ISO datetime string.  The string is cached
+ *	per thread and only reformatted when the second changes.
+ **********************************************************************/
+
+static char *log_datetime(void)
+{
+    struct tm gmt_now;
+    time_t    now_epoch;
+
+    time(&now_epoch);
+    if (now_epoch != ts_epoch)
+    {
+	gmtime_r(&now_epoch, &gmt_now);
+	sprintf(ts_datetime, DATETIME_FORMAT, 
+		gmt_now.tm_year + 1900, gmt_now.tm_mon+1, gmt_now.tm_mday,
+		gmt_now.tm_hour, gmt_now.tm_min, gmt_now.tm_sec);
+	ts_epoch = now_epoch;
+    }
+    return ts_datetime;
+}
+
+/***********************************************************************
+ * log_lock(), log_unlock()
+ *	Serialize calls to log_emit_line() and log_flush().  A spin lock,
+ *	so that programs that do not log from threads need no -lpthread.
+ **********************************************************************/
+
+void log_lock(void)
+{
+    while (__atomic_exchange_n(&emit_lock, 1, __ATOMIC_ACQUIRE))
+	sched_yield();
+}
+
+void log_unlock(void)
+{
+    __atomic_store_n(&emit_lock, 0, __ATOMIC_RELEASE);
+}
+
+/***********************************************************************
+ * log_emit_line()
+ *	Write a formatted log line to the log.  The line starts with its
+ *	ISO datetime, which is used to switch to a new logfile when the
+ *	UTC date advances.  A line dated before the current logfile, which
+ *	the asynchronous writer can produce around midnight, is written to
+ *	the current logfile.  The caller must call log_flush(), and must
+ *	hold log_lock().
+ *
+ *	RETURNS 0 upon success, -1 upon failure
+ **********************************************************************/
+
+int log_emit_line(const char *line, int len)
+{
+    if (fp == NULL) return -1;
+    if (fp != stdout && len >= DATETIME_STRLEN && strncmp(line, date_prev, DATE_STRLEN) > 0)
+    {
+	memcpy(date, line, DATE_STRLEN);
+	date[DATE_STRLEN] = '\0';
+	memcpy(datetime, line, DATETIME_STRLEN);
+	datetime[DATETIME_STRLEN] = '\0';
+    	fprintf(fp,"%s - END - UTC date changed; Logfile continues in file with date %s\n", datetime, date);
+    	fclose(fp);
+	sprintf(log_fullpath,LOGPATH_FORMAT, log_path, log_name, date);
+	if ( (fp = fopen(log_fullpath, "a")) == NULL )
+	{
+		fprintf(stderr, "LogMessage(): Fatal Error, could not open new file %s for writing\n", log_fullpath);
+		return -1;
+	}
+    	fprintf(fp,"%s - START - UTC date changed; Logfile continues from with date %s\n", datetime, date_prev);
+	strcpy(date_prev, date);
+    }
+    if (fwrite(line, 1, len, fp) != (size_t)len) return -1;
+    return 0;
+}
+
+/***********************************************************************
+ * log_flush()
+ *	Flush log output written with log_emit_line().
+ **********************************************************************/
+
+void log_flush(void)
+{
+    if (fp != NULL) fflush(fp);
+}
+
+/***********************************************************************
+ * log_put()
+ *	Queue the line for the writer thread if asynchronous logging is
+ *	running, else write it now.
+ **********************************************************************/
+
+static int log_put(const char *line, int len)
+{
+    int (*put)(const char *line, int len);
+    int ret;
+
+    put = __atomic_load_n(&log_async_put, __ATOMIC_ACQUIRE);
+    if (put != NULL && (ret = (*put)(line, len)) != LOG_ASYNC_STOPPED)
+	return ret;
+    log_lock();
+    ret = log_emit_line(line, len);
+    log_flush();
+    log_unlock();
+    return ret;
+}
+
 /***********************************************************************
  * vLogMessage()
  * Logs the message with date and type tag.
@@ -147,9 +267,8 @@ int LogInit(int mode, char *path, char *logname, int buf_size)
 
 static int vLogMessage(int type, const char *format, va_list args)
 {
-    struct tm *gmt_now;
-    time_t    now_epoch;
-    int  ret;
+    char *dt;
+    int  n, ret;
 
     if (!init)
     {
@@ -162,43 +281,24 @@ static int vLogMessage(int type, const char *format, va_list args)
 	return -1;
     }
 
-    /* get date for comparison */
-    time(&now_epoch);
-    gmt_now = gmtime(&now_epoch);
-    sprintf(date, DATE_FORMAT, gmt_now->tm_year + 1900, gmt_now->tm_mon+1, gmt_now->tm_mday);
-    sprintf(datetime, DATETIME_FORMAT, 
-	    gmt_now->tm_year + 1900, gmt_now->tm_mon+1, gmt_now->tm_mday,
-	    gmt_now->tm_hour, gmt_now->tm_min, gmt_now->tm_sec);
-    
-    if (fp != stdout && strcmp(date, date_prev) != 0)
-    {
-    	fprintf(fp,"%s - END - UTC date changed; Logfile continues in file with date %s\n", datetime, date);
-    	fclose(fp);
-	sprintf(log_fullpath,LOGPATH_FORMAT, log_path, log_name, date);
-	if ( (fp = fopen(log_fullpath, "a")) == NULL )
-	{
-		fprintf(stderr, "LogMessage(): Fatal Error, could not open new file %s for writing\n", log_fullpath);
-		return -1;
-	}
-    	fprintf(fp,"%s - START - UTC date changed; Logfile continues from with date %s\n", datetime, date_prev);
-	strcpy(date_prev, date);
-    }
+    /* Line buffer for datetime, type, message and newline. */
+    char line[DATETIME_LEN + 16 + log_bufsize];
 
-    /* now write to the buffer */
-    ret = vsnprintf(buf, log_bufsize, format, args);
+    dt = log_datetime();
+    n = sprintf(line, "%s - %s - ", dt, log_type_string[type]);
+    ret = vsnprintf(line+n, log_bufsize, format, args);
 
-    if (ret > log_bufsize || ret == -1)
+    if (ret >= log_bufsize || ret < 0)
     {
-    	fprintf(fp,"%s - ERROR - LogMessage() called with too big a mesage for buffer specified.\n", datetime);
+	n = sprintf(line, "%s - ERROR - LogMessage() called with too big a mesage for buffer specified.\n", dt);
+	log_put(line, n);
 	return -1;
     }
-
-    if (ret > 1 && buf[ret-1] == '\n')
-	fprintf(fp,"%s - %s - %s",   datetime, log_type_string[type], buf);
-    else
-	fprintf(fp,"%s - %s - %s\n", datetime, log_type_string[type], buf);
-    fflush(fp);
-    return 0;
+    n += ret;
+    if (! (ret > 1 && line[n-1] == '\n'))
+	line[n++] = '\n';
+    line[n] = '\0';
+    return log_put(line, n);
 }
 
 /***********************************************************************
@@ -0,0 +1,348 @@
+/***********************************************************************
+ * onesecmcast.c - one second multicast packets, original and coalesced.
+ *
+ * The sender appends each channel's one second packet to a pending
+ * datagram for the station and sends the datagram when the next
+ * channel would not fit, when the station changes, or when a channel
+ * already in the datagram is seen again (the next second).  The server
+ * main thread calls osm_flush() regularly so that a partly filled
+ * datagram waits no longer than the server's polling interval.
+ *
+ * Samples are converted to network byte order 4 at a time with SSE2
+ * where available.
+ *
+ * 2026-10-19 Initial version.
+ **********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "onesecmcast.h"
+
+/***********************************************************************
+ * osm_swap32()
+ *	Copy n 32 bit values, reversing the byte order on little endian
+ *	hosts.  dst and src may be the same but must not otherwise overlap.
+ **********************************************************************/
+
+void osm_swap32(int32_t *dst, const int32_t *src, int n)
+{
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    int i = 0;
+#if defined(__SSE2__)
+    __m128i v;
+
+    for (; i + 4 <= n; i += 4)
+    {
+	v = _mm_loadu_si128((const __m128i *)(src + i));
+	/* Swap the bytes of each 16 bit word, then the words of each value. */
+	v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+	v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, 0xB1), 0xB1);
+	_mm_storeu_si128((__m128i *)(dst + i), v);
+    }
+#endif
+    for (; i < n; i++)
+	dst[i] = (int32_t)__builtin_bswap32((uint32_t)src[i]);
+#else
+    if (dst != src) memcpy(dst, src, n * sizeof(int32_t));
+#endif
+}
+
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Copy a code to a fixed field, blank padded to width, NUL terminated. */
+static void pad_code(char *dst, const char *src, int width)
+{
+    int i;
+
+    for (i = 0; i < width && src[i] != '\0'; i++) dst[i] = src[i];
+    for (; i < width; i++) dst[i] = ' ';
+    dst[width] = '\0';
+}
+
+/***********************************************************************
+ * osm_sender_init()
+ *	Set up a sender for the socket fd and destination addr.
+ *	If coalesce is 0 each channel is sent as an original onesec_pkt.
+ **********************************************************************/
+
+void osm_sender_init(osm_sender *s, int fd, struct sockaddr_in *addr, int coalesce)
+{
+    memset(s, 0, sizeof(osm_sender));
+    s->fd = fd;
+    s->addr = *addr;
+    s->coalesce = coalesce;
+    pthread_mutex_init(&s->lock, NULL);
+}
+
+void osm_sender_destroy(osm_sender *s)
+{
+    pthread_mutex_destroy(&s->lock);
+}
+
+/* Send the pending datagram.  Caller holds the lock. */
+static int send_pending(osm_sender *s)
+{
+    int rc = 0;
+
+    if (s->len == 0) return 0;
+    if (sendto(s->fd, s->buf, s->len, 0, (struct sockaddr *)&s->addr,
+	       sizeof(s->addr)) < 0)
+    {
+	++s->errors;
+	rc = -1;
+    }
+    ++s->datagrams;
+    s->len = 0;
+    return rc;
+}
+
+/* Return 1 if the channel is already in the pending datagram. */
+static int in_pending(osm_sender *s, const char *channel, const char *location)
+{
+    osm_chan_hdr *ch;
+    int off, n, i;
+
+    n = ntohs(((osm_hdr *)s->buf)->nchannels);
+    for (i = 0, off = sizeof(osm_hdr); i < n; i++)
+    {
+	ch = (osm_chan_hdr *)(s->buf + off);
+	if (memcmp(ch->channel, channel, 4) == 0 && memcmp(ch->location, location, 4) == 0)
+	    return 1;
+	off += sizeof(osm_chan_hdr) + ntohs(ch->nsamples) * sizeof(int32_t);
+    }
+    return 0;
+}
+
+/***********************************************************************
+ * osm_send()
+ *	Multicast one channel's samples, or add them to the pending
+ *	coalesced datagram.  Samples are in host byte order.
+ *	RETURNS 0 upon success, -1 if a datagram could not be sent.
+ **********************************************************************/
+
+int osm_send(osm_sender *s, const char *net, const char *station,
+	     const char *channel, const char *location, int rate,
+	     uint32_t timestamp_sec, uint32_t timestamp_usec,
+	     const int32_t *samples, int nsamples)
+{
+    osm_hdr *hdr = (osm_hdr *)s->buf;
+    osm_chan_hdr *ch;
+    char chan[4], loc[4];
+    int need, rc = 0;
+
+    if (nsamples < 0) nsamples = 0;
+    if (nsamples > OSM_MAX_SAMPLES) nsamples = OSM_MAX_SAMPLES;
+    pad_code(chan, channel, 3);
+    pad_code(loc, location, 2);
+    pthread_mutex_lock(&s->lock);
+
+    if (! s->coalesce)
+    {
+	/* Original onesec_pkt: net[4] station[16] channel[16] location[4]	*/
+	/* rate timestamp_sec timestamp_usec samples[]			*/
+	uint32_t v;
+	memset(s->buf, 0, OSM_ONESEC_HDR_LEN);
+	strncpy(s->buf, net, 3);
+	strncpy(s->buf + 4, station, 15);
+	memcpy(s->buf + 20, chan, 4);
+	memcpy(s->buf + 36, loc, 4);
+	v = htonl((uint32_t)rate);
+	memcpy(s->buf + 40, &v, 4);
+	v = htonl(timestamp_sec);
+	memcpy(s->buf + 44, &v, 4);
+	v = htonl(timestamp_usec);
+	memcpy(s->buf + 48, &v, 4);
+	osm_swap32((int32_t *)(s->buf + OSM_ONESEC_HDR_LEN), samples, nsamples);
+	s->len = OSM_ONESEC_HDR_LEN + nsamples * sizeof(int32_t);
+	++s->channels;
+	rc = send_pending(s);
+	pthread_mutex_unlock(&s->lock);
+	return rc;
+    }
+
+    need = sizeof(osm_chan_hdr) + nsamples * sizeof(int32_t);
+    if (s->len > 0 &&
+	(s->len + need > OSM_MAX_PAYLOAD ||
+	 strncmp(hdr->net, net, sizeof(hdr->net) - 1) != 0 ||
+	 strncmp(hdr->station, station, sizeof(hdr->station) - 1) != 0 ||
+	 in_pending(s, chan, loc)))
+    {
+	rc = send_pending(s);
+    }
+    if (s->len == 0)
+    {
+	memset(hdr, 0, sizeof(osm_hdr));
+	memcpy(hdr->magic, OSM_MAGIC, 4);
+	hdr->version = OSM_VERSION;
+	hdr->sequence = htonl(s->sequence++);
+	strncpy(hdr->net, net, sizeof(hdr->net) - 1);
+	strncpy(hdr->station, station, sizeof(hdr->station) - 1);
+	s->len = sizeof(osm_hdr);
+	s->first_time = now();
+    }
+    ch = (osm_chan_hdr *)(s->buf + s->len);
+    memcpy(ch->channel, chan, 4);
+    memcpy(ch->location, loc, 4);
+    ch->rate = (int32_t)htonl((uint32_t)rate);
+    ch->timestamp_sec = htonl(timestamp_sec);
+    ch->timestamp_usec = htonl(timestamp_usec);
+    ch->nsamples = htons((uint16_t)nsamples);
+    ch->reserved = 0;
+    osm_swap32((int32_t *)(ch + 1), samples, nsamples);
+    s->len += need;
+    hdr->nchannels = htons(ntohs(hdr->nchannels) + 1);
+    ++s->channels;
+    if (s->len >= OSM_MAX_PAYLOAD)
+	rc |= send_pending(s);
+    pthread_mutex_unlock(&s->lock);
+    return rc;
+}
+
+/***********************************************************************
+ * osm_flush()
+ *	Send the pending datagram if it was started at least max_age
+ *	seconds ago.  Use max_age 0 to send it now.
+ *	RETURNS 0 upon success, -1 if the datagram could not be sent.
+ **********************************************************************/
+
+int osm_flush(osm_sender *s, double max_age)
+{
+    int rc = 0;
+
+    pthread_mutex_lock(&s->lock);
+    if (s->len > 0 && now() - s->first_time >= max_age)
+	rc = send_pending(s);
+    pthread_mutex_unlock(&s->lock);
+    return rc;
+}
+
+/***********************************************************************
+ * osm_open()
+ *	Open a UDP socket bound to port that has joined the multicast
+ *	group on the interface with address ifaddr (NULL for any).
+ *	RETURNS the socket, or -1 upon failure.
+ **********************************************************************/
+
+int osm_open(const char *ifaddr, const char *group, int port)
+{
+    struct sockaddr_in addr;
+    struct ip_mreq mreq;
+    int fd, on = 1;
+
+    if ((fd = socket(PF_INET, SOCK_DGRAM, IPPROTO_UDP)) < 0) return -1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    memset(&mreq, 0, sizeof(mreq));
+    mreq.imr_multiaddr.s_addr = inet_addr(group);
+    mreq.imr_interface.s_addr = (ifaddr != NULL) ? inet_addr(ifaddr) : htonl(INADDR_ANY);
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+	setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0)
+    {
+	close(fd);
+	return -1;
+    }
+    return fd;
+}
+
+/* Copy a fixed field to a NUL terminated code. */
+static void get_code(char *dst, const char *src, int size)
+{
+    memcpy(dst, src, size - 1);
+    dst[size - 1] = '\0';
+}
+
+/***********************************************************************
+ * osm_decode()
+ *	Decode a received coalesced or original onesec datagram and call
+ *	callback for each channel, with the samples converted to host
+ *	byte order in samples[maxsamples].  Decoding stops if callback
+ *	returns non-zero.  For coalesced datagrams *sequence (if not NULL)
+ *	is set to the sender's datagram number.
+ *	RETURNS the number of channels decoded, or -1 if the datagram
+ *	is malformed or of an unknown version.
+ **********************************************************************/
+
+int osm_decode(const char *buf, int len, int32_t *samples, int maxsamples,
+	       int (*callback)(osm_channel *chan, void *arg), void *arg,
+	       uint32_t *sequence)
+{
+    osm_channel chan;
+    osm_hdr hdr;
+    osm_chan_hdr ch;
+    uint32_t v;
+    int off, n, i, nch;
+
+    memset(&chan, 0, sizeof(chan));
+    chan.samples = samples;
+    if (len >= (int)sizeof(osm_hdr) && memcmp(buf, OSM_MAGIC, 4) == 0)
+    {
+	memcpy(&hdr, buf, sizeof(hdr));
+	if (hdr.version != OSM_VERSION) return -1;
+	if (sequence != NULL) *sequence = ntohl(hdr.sequence);
+	get_code(chan.net, hdr.net, sizeof(chan.net));
+	get_code(chan.station, hdr.station, sizeof(chan.station));
+	nch = ntohs(hdr.nchannels);
+	for (i = 0, off = sizeof(osm_hdr); i < nch; i++)
+	{
+	    if (off + (int)sizeof(osm_chan_hdr) > len) return -1;
+	    memcpy(&ch, buf + off, sizeof(ch));
+	    off += sizeof(osm_chan_hdr);
+	    n = ntohs(ch.nsamples);
+	    if (off + n * (int)sizeof(int32_t) > len || n > maxsamples) return -1;
+	    get_code(chan.channel, ch.channel, sizeof(chan.channel));
+	    get_code(chan.location, ch.location, sizeof(chan.location));
+	    chan.rate = (int32_t)ntohl((uint32_t)ch.rate);
+	    chan.timestamp_sec = ntohl(ch.timestamp_sec);
+	    chan.timestamp_usec = ntohl(ch.timestamp_usec);
+	    chan.nsamples = n;
+	    memcpy(samples, buf + off, n * sizeof(int32_t));
+	    osm_swap32(samples, samples, n);
+	    off += n * sizeof(int32_t);
+	    if (callback(&chan, arg) != 0) return i + 1;
+	}
+	return nch;
+    }
+
+    /* Original onesec_pkt. */
+    if (len < OSM_ONESEC_HDR_LEN || (len - OSM_ONESEC_HDR_LEN) % sizeof(int32_t) != 0)
+	return -1;
+    n = (len - OSM_ONESEC_HDR_LEN) / sizeof(int32_t);
+    if (n > maxsamples) return -1;
+    get_code(chan.net, buf, sizeof(chan.net));
+    get_code(chan.station, buf + 4, sizeof(chan.station));
+    get_code(chan.channel, buf + 20, sizeof(chan.channel));
+    get_code(chan.location, buf + 36, sizeof(chan.location));
+    memcpy(&v, buf + 40, 4);
+    chan.rate = (int32_t)ntohl(v);
+    memcpy(&v, buf + 44, 4);
+    chan.timestamp_sec = ntohl(v);
+    memcpy(&v, buf + 48, 4);
+    chan.timestamp_usec = ntohl(v);
+    chan.nsamples = n;
+    memcpy(samples, buf + OSM_ONESEC_HDR_LEN, n * sizeof(int32_t));
+    osm_swap32(samples, samples, n);
+    callback(&chan, arg);
+    return 1;
+}
@@ -0,0 +1,250 @@
+/***********************************************************************
+ * pkttrace.c - optional tracing of packets through a server.
+ *
+ * The stages of the packet that a thread is handling are kept in a
+ * thread local pkt_trace, so marking a stage is one clock read and one
+ * store, and nothing is shared between threads until the packet is
+ * committed to a comserv ring.  pkttrace_commit() and pkttrace_deliver()
+ * are called with the comserv lock held (or from the single thread of
+ * comserv), so entries have a single writer at a time.
+ *
+ * pkttrace_commit() clears the stages of the record (PT_RECORD and
+ * later), but keeps the stages of the data logger packet, because one
+ * data logger packet may finish several records.
+ *
+ * 2026-10-19 Initial version.
+ **********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+
+#include "dpstruc.h"
+#include "service.h"
+#include "stuff.h"
+#include "pkttrace.h"
+
+#define READ_TRIES	100000		/* Give up waiting for a dead writer	*/
+
+pkt_trace_table *pkttrace_table = NULL;
+static __thread pkt_trace current;
+
+static int64_t monotonic_ns (void)
+{
+    struct timespec ts;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/***********************************************************************
+ * pkttrace_size()
+ *	RETURNS the bytes needed for a table of nentries packets.
+ **********************************************************************/
+
+int32_t pkttrace_size (int nentries)
+{
+    if (nentries < 1) nentries = 1;
+    if (nentries > PKTTRACE_MAXENTRIES) nentries = PKTTRACE_MAXENTRIES;
+    return (int32_t)(offsetof(pkt_trace_table, entry) + nentries * sizeof(pkt_trace_entry));
+}
+
+/***********************************************************************
+ * pkttrace_init()
+ *	Initialize the table and turn tracing on.
+ **********************************************************************/
+
+void pkttrace_init (pkt_trace_table *t, int nentries)
+{
+    int i;
+
+    if (nentries < 1) nentries = 1;
+    if (nentries > PKTTRACE_MAXENTRIES) nentries = PKTTRACE_MAXENTRIES;
+    memset (t, 0, pkttrace_size (nentries));
+    t->magic = PKTTRACE_MAGIC;
+    t->version = PKTTRACE_VERSION;
+    t->entry_size = sizeof(pkt_trace_entry);
+    t->nentries = nentries;
+    t->start_time = dtime ();
+    for (i = 0; i < nentries; i++)
+	t->entry[i].packet_num = -1;
+    pkttrace_table = t;
+}
+
+/***********************************************************************
+ * pkttrace_start(), pkttrace_mark()
+ *	Begin a new data logger packet, or mark a stage of the current
+ *	packet of this thread.
+ **********************************************************************/
+
+void pkttrace_start (void)
+{
+    if (pkttrace_table == NULL) return;
+    memset (&current, 0, sizeof(current));
+    current.t[PT_RECEIVE] = monotonic_ns ();
+}
+
+void pkttrace_mark (int stage)
+{
+    if (pkttrace_table == NULL || stage < 0 || stage >= PT_NSTAGES) return;
+    current.t[stage] = monotonic_ns ();
+}
+
+/***********************************************************************
+ * pkttrace_hook()
+ *	Stage callback for the data logger libraries, which number their
+ *	stages as PT_RECEIVE, PT_DECOMPRESS and PT_FINISH.
+ **********************************************************************/
+
+void pkttrace_hook (int stage)
+{
+    if (stage == PT_RECEIVE)
+	pkttrace_start ();
+    else
+	pkttrace_mark (stage);
+}
+
+/***********************************************************************
+ * pkttrace_take(), pkttrace_set(), pkttrace_clear()
+ *	Take the stages of the current record to pass them to another
+ *	thread, make them the current stages of this thread, or forget
+ *	them.
+ **********************************************************************/
+
+void pkttrace_take (pkt_trace *copy)
+{
+    if (pkttrace_table == NULL)
+    {
+	memset (copy, 0, sizeof(pkt_trace));
+	return;
+    }
+    *copy = current;
+    memset (&current.t[PT_RECORD], 0, (PT_NSTAGES - PT_RECORD) * sizeof(int64_t));
+}
+
+void pkttrace_set (const pkt_trace *trace)
+{
+    if (pkttrace_table == NULL) return;
+    current = *trace;
+}
+
+void pkttrace_clear (void)
+{
+    if (pkttrace_table == NULL) return;
+    memset (&current, 0, sizeof(current));
+}
+
+/***********************************************************************
+ * pkttrace_commit()
+ *	Mark PT_QUEUE and write the stages of the current record to the
+ *	entry of packet_num.
+ **********************************************************************/
+
+void pkttrace_commit (int32_t packet_num, short qnum)
+{
+    pkt_trace_table *t = pkttrace_table;
+    pkt_trace_entry *e;
+
+    if (t == NULL || packet_num < 0) return;
+    current.t[PT_QUEUE] = monotonic_ns ();
+    current.t[PT_DELIVER] = 0;
+    e = &t->entry[(uint32_t)packet_num % t->nentries];
+    __atomic_store_n (&e->seq, e->seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence (__ATOMIC_RELEASE);
+    e->qnum = qnum;
+    e->packet_num = packet_num;
+    e->trace = current;
+    __atomic_store_n (&e->seq, e->seq + 1, __ATOMIC_RELEASE);
+    __atomic_store_n (&t->committed, t->committed + 1, __ATOMIC_RELAXED);
+    memset (&current.t[PT_RECORD], 0, (PT_NSTAGES - PT_RECORD) * sizeof(int64_t));
+}
+
+/***********************************************************************
+ * pkttrace_deliver()
+ *	Mark PT_DELIVER of packet_num if no client has received it yet.
+ **********************************************************************/
+
+void pkttrace_deliver (int32_t packet_num)
+{
+    pkt_trace_table *t = pkttrace_table;
+    pkt_trace_entry *e;
+
+    if (t == NULL || packet_num < 0) return;
+    e = &t->entry[(uint32_t)packet_num % t->nentries];
+    if (e->packet_num != packet_num || e->trace.t[PT_DELIVER] != 0) return;
+    __atomic_store_n (&e->seq, e->seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence (__ATOMIC_RELEASE);
+    e->trace.t[PT_DELIVER] = monotonic_ns ();
+    __atomic_store_n (&e->seq, e->seq + 1, __ATOMIC_RELEASE);
+}
+
+/***********************************************************************
+ * pkttrace_attach()
+ *	Attach read-only to the segment of the server with segkey.
+ *	*segment is set to the segment address for shmdt().
+ *	RETURNS the trace table, or NULL if the server is not tracing.
+ **********************************************************************/
+
+pkt_trace_table *pkttrace_attach (int segkey, void **segment)
+{
+    struct shmid_ds ds;
+    pserver_struc base;
+    pkt_trace_table *t;
+    int shmid;
+    int32_t off;
+
+    *segment = NULL;
+    if ((shmid = shmget (segkey, 0, 0)) < 0 || shmctl (shmid, IPC_STAT, &ds) < 0)
+	return NULL;
+    base = (pserver_struc) shmat (shmid, NULL, SHM_RDONLY);
+    if (base == (pserver_struc) -1)
+	return NULL;
+    off = base->trace_offset;
+    if (base->init != 'I' || off < (int32_t)sizeof(tserver_struc)
+	|| off + offsetof(pkt_trace_table, entry) > ds.shm_segsz)
+    {
+	shmdt ((char *)base);
+	return NULL;
+    }
+    t = (pkt_trace_table *)((char *)base + off);
+    if (t->magic != PKTTRACE_MAGIC || t->version != PKTTRACE_VERSION
+	|| t->entry_size != sizeof(pkt_trace_entry)
+	|| off + (size_t)pkttrace_size (t->nentries) > ds.shm_segsz)
+    {
+	shmdt ((char *)base);
+	return NULL;
+    }
+    *segment = base;
+    return t;
+}
+
+/***********************************************************************
+ * pkttrace_read()
+ *	Copy entry i of the table.
+ *	RETURNS 0 upon success, -1 if the entry is unused.
+ **********************************************************************/
+
+int pkttrace_read (const pkt_trace_table *t, int i, pkt_trace_entry *copy)
+{
+    uint32_t seq;
+    int tries = 0;
+
+    if (i < 0 || (uint32_t)i >= t->nentries) return -1;
+    do
+    {
+	while (((seq = __atomic_load_n (&t->entry[i].seq, __ATOMIC_ACQUIRE)) & 1)
+	       && ++tries < READ_TRIES)
+	    ;
+	memcpy (copy, (const void *)&t->entry[i], sizeof(pkt_trace_entry));
+	__atomic_thread_fence (__ATOMIC_ACQUIRE);
+    }
+    while (__atomic_load_n (&t->entry[i].seq, __ATOMIC_RELAXED) != seq
+	   && ++tries < READ_TRIES);
+    return (copy->packet_num < 0) ? -1 : 0;
+}
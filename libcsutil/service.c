@@ -31,6 +31,22 @@ Edit History:
    19 22 Jan 2020 DSN	Parameterized CS_CHECK_INTERVAL in service.h.  
    			Originally it was the constant 10.
    20 29 Sep 2020 DSN Updated for comserv3.
+   21 19 Oct 2026     Split cs_svc into cs_svc_start/cs_svc_finish and added
+                      cs_gen_parallel for concurrent multi-station scans.
+   22 19 Oct 2026     Added cs_wait to replace fixed client poll sleeps.
+   23 19 Oct 2026     Use cfg_lookup for SEGID in cs_setup.
+   24 19 Oct 2026     cs_svc on a parallel client keeps scan results that are
+                      not delivered yet instead of dropping them.
+   25 19 Oct 2026     cs_wait blocks on a futex on the server's next_data,
+                      which cs_signal_data wakes, and backs off to 1 second.
+   26 19 Oct 2026     Look up SEGID in cs_setup under each station's own SOURCE
+                      rather than that of the last station listed.
+   27 19 Oct 2026     cs_wait blocks on every linked station at once with
+                      futex_waitv, and cs_signal_data only wakes when a client
+                      is waiting.
+   28 19 Oct 2026     Build the station.ini pathname in cs_setup in its own
+                      buffer, so it does not become the directory of a
+                      following station that has no DIR line.
 */
 #include <stdio.h>
 #include <errno.h>
@@ -45,6 +61,17 @@ Edit History:
 #include <sys/shm.h>
 #include <signal.h>
 #include <unistd.h>
+#include <stdlib.h>
+#include <limits.h>
+#ifdef __linux__
+#include <time.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+/* futex_waitv, Linux 5.16 and later headers */
+#if defined(SYS_futex_waitv) && defined(FUTEX_WAITV_MAX)
+#define CS_WAIT_WAITV
+#endif
+#endif
 
 #include "dpstruc.h"
 #include "service.h"
@@ -62,20 +89,38 @@ void cs_sig_alrm (int signo)
 
 void cs_detach (pclient_struc client, short station_number);
 
-/* Try to put the structure pointed to by "client" into service queue for
-   server pointed to by "srvr". Returns 0 if no error, -1 if cannot
+/* Parallel scan state for a client created by cs_gen_parallel. Each station
+   is serviced through its own private single-station segment (shadow), since
+   the done/error/curstation fields and data buffers of a client segment only
+   allow one outstanding service request at a time. Only one parallel client
+   segment per process is supported.
 */
-short cs_svc (pclient_struc client, short station_number)
+typedef struct
+{
+    pclient_struc shadow ;    /* Private segment used to talk to this station */
+    boolean inflight ;        /* Request queued on server, not yet complete */
+    boolean ready ;           /* Request complete, results not yet delivered */
+    short slot ;              /* Server service queue slot of request */
+    int32_t sleeptime ;       /* Microseconds per wait for this server */
+    int32_t sofar ;           /* Microseconds waited so far */
+} tpar_station ;
+
+static pclient_struc par_client = NULL ;
+static tpar_station *par_station = NULL ;
+
+static short cs_svc_parallel (pclient_struc client, short station_number) ;
+
+/* Put the request for "station_number" into the service queue of its server
+   and signal the server. Returns CSCR_GOOD if the request was queued, with
+   the queue slot and the per-wait sleep time, otherwise the failure status.
+*/
+short cs_svc_start (pclient_struc client, short station_number, short *slot, int32_t *sleeptime)
 {
     short found, i ;
-    int32_t sofar, sleeptime ;
     struct sembuf busy = { 0, -1, 0 } ;
     struct sembuf notbusy = { 0, 1, 0 } ;
     pclient_station curclient ;
     pserver_struc srvr ;
-#ifdef SOLARIS2
-    timespec_t rqtp, rmtp ;
-#endif
 
     found = FALSE ;
     client->done = FALSE ;
@@ -116,6 +161,7 @@ short cs_svc (pclient_struc client, short station_number)
 	}
     if (! found)
 	return CSCR_ENQUEUE ;
+    *slot = i ;
     if (srvr->server_uid == client->client_uid)
     {
 	if (kill (srvr->server_pid, SIGALRM) == ERROR) /* get its attention */
@@ -126,7 +172,7 @@ short cs_svc (pclient_struc client, short station_number)
 	    curclient->status = CSCR_DIED ;
 	    return CSCR_DIED ;
 	}
-	sleeptime = srvr->privusec ;
+	*sleeptime = srvr->privusec ;
     }
     else
     {
@@ -137,10 +183,58 @@ short cs_svc (pclient_struc client, short station_number)
 	  curclient->status = CSCR_DIED ;
 	  return CSCR_DIED ;
 	  } */
-	sleeptime = srvr->nonusec ;
+	*sleeptime = srvr->nonusec ;
     }
+    return CSCR_GOOD ;
+}
+
+/* Complete a request started with cs_svc_start. If the server has not
+   finished the request, it is removed from the service queue and
+   CSCR_TIMEOUT is returned, else the service status is returned.
+*/
+short cs_svc_finish (pclient_struc client, short station_number, short slot)
+{
+    struct sembuf busy = { 0, -1, 0 } ;
+    struct sembuf notbusy = { 0, 1, 0 } ;
+    pclient_station curclient ;
+    pserver_struc srvr ;
+
+    curclient = (pclient_station) ((uintptr_t) client + client->offsets[station_number]) ;
+    srvr = curclient->base ;
+    if (! client->done)
+    {
+	if (srvr == (pserver_struc) NOCLIENT)
+	    return CSCR_TIMEOUT ;
+	semop (srvr->server_semid, &busy, 1) ;
+	if (srvr->svcreqs[slot].clientseg == client->client_shm) /* still valid */
+	    srvr->svcreqs[slot].clientseg = NOCLIENT ;
+	semop (srvr->server_semid, &notbusy, 1) ;
+	return CSCR_TIMEOUT ;
+    }
+    curclient->last_good = dtime () ;
+    return client->error ;
+}
+
+/* Try to put the structure pointed to by "client" into service queue for
+   server pointed to by "srvr". Returns 0 if no error, -1 if cannot
+*/
+short cs_svc (pclient_struc client, short station_number)
+{
+    short slot, status ;
+    int32_t sofar, sleeptime ;
+    pclient_station curclient ;
+#ifdef SOLARIS2
+    timespec_t rqtp, rmtp ;
+#endif
+
+    if ((client == par_client) && (par_client != NULL))
+	return cs_svc_parallel (client, station_number) ;
+    status = cs_svc_start (client, station_number, &slot, &sleeptime) ;
+    if (status != CSCR_GOOD)
+	return status ;
+    curclient = (pclient_station) ((uintptr_t) client + client->offsets[station_number]) ;
     sofar = 0 ;
-    while ((! client->done) && (sofar <= srvr->client_wait))
+    while ((! client->done) && (sofar <= curclient->base->client_wait))
     {
 #ifdef SOLARIS2
 	if (sleeptime >= 1000000)
@@ -156,16 +250,7 @@ short cs_svc (pclient_struc client, short station_number)
 #endif
 	sofar = sofar + sleeptime ;
     }
-    if (! client->done)
-    {
-	semop (srvr->server_semid, &busy, 1) ;
-	if (srvr->svcreqs[i].clientseg == client->client_shm) /* still valid */
-	    srvr->svcreqs[i].clientseg = NOCLIENT ;
-	semop (srvr->server_semid, &notbusy, 1) ;
-	return CSCR_TIMEOUT ;
-    }
-    curclient->last_good = dtime () ;
-    return client->error ;
+    return cs_svc_finish (client, station_number, slot) ;
 }          
 
 void cs_setup (pstations_struc stations, pchar name, pchar sname, boolean shared, 
@@ -179,6 +264,7 @@ void cs_setup (pstations_struc stations, pchar name, pchar sname, boolean shared
     char stemp[CFGWIDTH] ;
     char source[SECWIDTH] ;
     char filename[CFGWIDTH] ;
+    char ininame[CFGWIDTH] ;
 
     if (comsize < 100)
 	comsize = 100 ;
@@ -231,32 +317,16 @@ void cs_setup (pstations_struc stations, pchar name, pchar sname, boolean shared
 	    stations->station_list[j].mask = mask ;
 	    stations->station_list[j].segkey = NOCLIENT ;
 	    stations->station_list[j].blocking = blocking ;
+/* Look up the segment key in the station.ini file in this station's directory */
+	    strcpy (ininame, filename) ;
+	    addslash (ininame) ;
+	    strcat (ininame, "station.ini") ;
+	    if (! cfg_lookup(ininame, source, "SEGID", str2))
+		stations->station_list[j].segkey = atoi((pchar) &str2) ;
 	}
     }
     while (any && (! skipto (&cfg, sname))) ;
     close_cfg(&cfg) ;
-      
-    for (j = 0 ; j < stations->station_count ; j++)
-    {
-/* Try to open the station.ini file in this station's directory */
-	strcpy (filename, stations->station_list[j].directory) ;
-	addslash (filename) ;
-	strcat (filename, "station.ini") ;
-//	if (! open_cfg(&cfg, filename, "comlink"))
-	if ((strlen(source) > 0) && ! open_cfg(&cfg, filename, source))
-	{
-	    do
-	    {
-		read_cfg(&cfg, str1, str2) ;
-		if (str1[0] == '\0')
-		    break ;
-		else if (strcmp(str1, "SEGID") == 0)
-		    stations->station_list[j].segkey = atoi((pchar) &str2) ;
-	    }
-	    while (1) ;
-	    close_cfg(&cfg) ;
-	}
-    }
 }
 
 void cs_remove (pstations_struc stations, short num)
@@ -323,7 +393,7 @@ void cs_attach (pclient_struc client, short station_number)
     }
 }
 
-pclient_struc cs_gen (pstations_struc stations)
+static pclient_struc cs_gen_segment (pstations_struc stations, boolean link)
 {
     pclient_struc me ;
     pclient_station this ;
@@ -435,13 +505,208 @@ pclient_struc cs_gen (pstations_struc stations)
 	strcpy(psel[0], "?????") ;
 
 /* now attach to the server's shared memory segment */
-	cs_link (me, j, TRUE) ;
-	if (this->base != (pserver_struc) NOCLIENT)
-	    cs_attach (me, j) ;
+	if (link)
+	{
+	    cs_link (me, j, TRUE) ;
+	    if (this->base != (pserver_struc) NOCLIENT)
+		cs_attach (me, j) ;
+	}
     }
     return me ;
 }
 
+pclient_struc cs_gen (pstations_struc stations)
+{
+    return cs_gen_segment (stations, TRUE) ;
+}
+
+/* Copy the request fields of station j of the parallel client into the
+   station's shadow segment. The command buffers are only copied for
+   commands other than CSCM_DATA_BLK.
+*/
+static void par_sync_in (pclient_struc client, short j, boolean cmdbufs)
+{
+    pclient_station this, sh ;
+    pclient_struc shadow ;
+
+    shadow = par_station[j].shadow ;
+    this = (pclient_station) ((uintptr_t) client + client->offsets[j]) ;
+    sh = (pclient_station) ((uintptr_t) shadow + shadow->offsets[0]) ;
+    sh->command = this->command ;
+    sh->blocking = this->blocking ;
+    sh->reqdbuf = (this->reqdbuf > sh->maxdbuf) ? sh->maxdbuf : this->reqdbuf ;
+    sh->seqdbuf = this->seqdbuf ;
+    sh->startdbuf = this->startdbuf ;
+    sh->datamask = this->datamask ;
+    memcpy ((pchar) sh->sels, (pchar) this->sels, sizeof(sh->sels)) ;
+    memcpy ((pchar) shadow + sh->seloffset, (pchar) client + this->seloffset,
+	    sizeof(seltype) * this->maxsel) ;
+    if (cmdbufs)
+    {
+	memcpy ((pchar) shadow + sh->cominoffset, (pchar) client + this->cominoffset, 104) ;
+	memcpy ((pchar) shadow + sh->comoutoffset, (pchar) client + this->comoutoffset,
+		this->comoutsize) ;
+    }
+}
+
+/* Copy the state and results of station j's shadow segment back into the
+   parallel client so that callers see the usual single-segment view. The
+   data buffers and data request state are only copied if "data" is set.
+*/
+static void par_sync_out (pclient_struc client, short j, boolean cmdbufs, boolean data)
+{
+    pclient_station this, sh ;
+    pclient_struc shadow ;
+
+    shadow = par_station[j].shadow ;
+    this = (pclient_station) ((uintptr_t) client + client->offsets[j]) ;
+    sh = (pclient_station) ((uintptr_t) shadow + shadow->offsets[0]) ;
+    this->status = sh->status ;
+    this->last_attempt = sh->last_attempt ;
+    this->last_good = sh->last_good ;
+    this->servcode = sh->servcode ;
+    this->base = sh->base ;
+    if (data)
+    {
+	this->next_data = sh->next_data ;
+	this->seqdbuf = sh->seqdbuf ;
+	this->valdbuf = sh->valdbuf ;
+	if (this->valdbuf > 0)
+	    memcpy ((pchar) client + this->dbufoffset, (pchar) shadow + sh->dbufoffset,
+		    this->valdbuf * sh->dbufsize) ;
+    }
+    else
+	this->valdbuf = 0 ;
+    if (cmdbufs)
+	memcpy ((pchar) client + this->comoutoffset, (pchar) shadow + sh->comoutoffset,
+		this->comoutsize) ;
+    client->client_uid = shadow->client_uid ;
+    client->error = shadow->error ;
+    client->done = shadow->done ;
+}
+
+/* Microseconds to wait for the server of a parallel station. */
+static int32_t par_client_wait (tpar_station *ps)
+{
+    pclient_station sh ;
+
+    sh = (pclient_station) ((uintptr_t) ps->shadow + ps->shadow->offsets[0]) ;
+    if (sh->base == (pserver_struc) NOCLIENT)
+	return 0 ;
+    return sh->base->client_wait ;
+}
+
+/* cs_svc for a parallel client, performed synchronously through the
+   station's shadow segment. Any outstanding scan request for the station
+   is completed first. Results of a scan request that are not delivered yet
+   answer a CSCM_DATA_BLK request for the next data, and are kept in the
+   shadow segment for the next cs_scan for any other command.
+*/
+static short cs_svc_parallel (pclient_struc client, short station_number)
+{
+    tpar_station *ps ;
+    pclient_station this, sh ;
+    byte old_status ;
+    int16_t seqdbuf ;
+    short status ;
+
+    ps = &par_station[station_number] ;
+    this = (pclient_station) ((uintptr_t) client + client->offsets[station_number]) ;
+    sh = (pclient_station) ((uintptr_t) ps->shadow + ps->shadow->offsets[0]) ;
+    client->curstation = station_number ;
+    if (ps->inflight)
+    {
+	while ((! ps->shadow->done) && (ps->sofar <= par_client_wait (ps)))
+	{
+	    usleep (ps->sleeptime) ;
+	    ps->sofar += ps->sleeptime ;
+	}
+	old_status = sh->status ;
+	sh->status = cs_svc_finish (ps->shadow, 0, ps->slot) ;
+	ps->inflight = FALSE ;
+	if ((sh->status != old_status) || (sh->valdbuf != 0))
+	    ps->ready = TRUE ;
+    }
+    if (ps->ready)
+    {
+	if ((this->command == CSCM_DATA_BLK) && (this->seqdbuf == CSQ_NEXT))
+	{
+	    ps->ready = FALSE ;
+	    par_sync_out (client, station_number, FALSE, TRUE) ;
+	    return sh->status ;
+	}
+	if (this->command != CSCM_DATA_BLK)
+	{
+	    seqdbuf = sh->seqdbuf ;
+	    par_sync_in (client, station_number, TRUE) ;
+	    sh->seqdbuf = seqdbuf ;
+	    status = cs_svc (ps->shadow, 0) ;
+	    par_sync_out (client, station_number, TRUE, FALSE) ;
+	    return status ;
+	}
+/* A data request that starts over replaces the undelivered results */
+	ps->ready = FALSE ;
+    }
+    par_sync_in (client, station_number, TRUE) ;
+    status = cs_svc (ps->shadow, 0) ;
+    par_sync_out (client, station_number, TRUE, TRUE) ;
+    return status ;
+}
+
+/*
+  Like cs_gen, but each station is serviced through a private single-station
+  shared memory segment so that cs_scan can have service requests outstanding
+  to all stations at once. The returned segment is used exactly like the one
+  returned by cs_gen. Falls back to cs_gen for a single station.
+*/
+pclient_struc cs_gen_parallel (pstations_struc stations)
+{
+    pclient_struc me, shadow ;
+    pstations_struc single ;
+    short j ;
+
+    if ((stations->station_count <= 1) || (par_client != NULL))
+	return cs_gen (stations) ;
+    me = cs_gen_segment (stations, FALSE) ;
+    if ((me == (pclient_struc) CSCR_PRIVATE) || (me == (pclient_struc) ERROR))
+	return me ;
+    par_station = (tpar_station *) calloc (stations->station_count, sizeof(tpar_station)) ;
+    single = (pstations_struc) calloc (1, sizeof(tstations_struc)) ;
+    if ((par_station == NULL) || (single == NULL))
+    {
+	free (single) ;
+	free (par_station) ;
+	par_station = NULL ;
+	cs_off (me) ;
+	return (pclient_struc) CSCR_PRIVATE ;
+    }
+    copy_cname_cs_cs(single->myname,stations->myname);
+    single->shared = TRUE ;
+    single->station_count = 1 ;
+    single->data_buffers = stations->data_buffers ;
+    for (j = 0 ; j < stations->station_count ; j++)
+    {
+	single->station_list[0] = stations->station_list[j] ;
+	shadow = cs_gen_segment (single, TRUE) ;
+	if ((shadow == (pclient_struc) CSCR_PRIVATE) || (shadow == (pclient_struc) ERROR))
+	{
+	    while (--j >= 0)
+		cs_off (par_station[j].shadow) ;
+	    free (single) ;
+	    free (par_station) ;
+	    par_station = NULL ;
+	    cs_off (me) ;
+	    return (pclient_struc) CSCR_PRIVATE ;
+	}
+	par_station[j].shadow = shadow ;
+    }
+    free (single) ;
+    par_client = me ;
+    for (j = 0 ; j < me->maxstation ; j++)
+	par_sync_out (me, j, FALSE, TRUE) ;
+    return me ;
+}
+
 byte cs_check (pclient_struc client, short station_number, double now)
 {
     pclient_station curclient ;
@@ -499,6 +764,18 @@ void cs_detach (pclient_struc client, short station_number)
     pclient_station this ;
       
     this = (pclient_station) ((uintptr_t) client + client->offsets[station_number]) ;
+    if ((client == par_client) && (par_client != NULL))
+    {
+/* The server segment is attached by the shadow, not by this segment */
+	if (par_station[station_number].inflight)
+	{
+	    cs_svc_finish (par_station[station_number].shadow, 0, par_station[station_number].slot) ;
+	    par_station[station_number].inflight = FALSE ;
+	}
+	par_station[station_number].ready = FALSE ;
+	cs_detach (par_station[station_number].shadow, 0) ;
+	this->base = (pserver_struc) NOCLIENT ;
+    }
 /* Detach from server segment */
     if (! (this->base == (pserver_struc) NOCLIENT))
 	shmdt((pchar)this->base) ;
@@ -515,6 +792,16 @@ void cs_off (pclient_struc client)
     for (j = 0 ; j < client->maxstation ; j++)
         cs_detach (client, j) ;
 
+/* Remove the private segments of a parallel client */
+    if ((client == par_client) && (par_client != NULL))
+    {
+	for (j = 0 ; j < client->maxstation ; j++)
+	    cs_off (par_station[j].shadow) ;
+	free (par_station) ;
+	par_station = NULL ;
+	par_client = NULL ;
+    }
+
 /* Detach from my segment */
     seg = client->client_shm ;
     shmdt((pchar)client) ;
@@ -523,6 +810,127 @@ void cs_off (pclient_struc client)
     shmctl(seg, IPC_RMID, NULL) ;
 }
 
+/* Return the results of a completed parallel request for station j to the
+   caller. Returns j.
+*/
+static short par_deliver (pclient_struc client, short j, boolean *alert)
+{
+    pclient_station this ;
+    byte old_status ;
+
+    this = (pclient_station) ((uintptr_t) client + client->offsets[j]) ;
+    old_status = this->status ;
+    par_sync_out (client, j, FALSE, TRUE) ;
+    par_station[j].ready = FALSE ;
+    client->curstation = j ;
+    *alert = (this->status != old_status) ;
+    return j ;
+}
+
+/* cs_scan for a parallel client. Requests are issued to every station that
+   has new data and does not already have a request outstanding, then the
+   first completion from any station is returned. Requests that complete
+   later are returned by subsequent calls, so a slow or dead server only
+   delays its own station.
+*/
+static short cs_scan_parallel (pclient_struc client, boolean *alert)
+{
+    tpar_station *ps ;
+    pclient_station this, sh ;
+    byte old_status, result ;
+    short j, n, status ;
+    int32_t sleeptime ;
+    boolean waiting ;
+    double curtime ;
+
+    curtime = dtime () ;
+    *alert = FALSE ;
+
+/* Deliver any request that completed since the last call, then issue new
+   requests, round robin starting after the last station returned. */
+    j = client->curstation ;
+    for (n = 0 ; n < client->maxstation ; n++)
+    {
+	if (++j >= client->maxstation)
+	    j = 0 ;
+	if (par_station[j].ready)
+	    return par_deliver (client, j, alert) ;
+    }
+    for (n = 0 ; n < client->maxstation ; n++)
+    {
+	if (++j >= client->maxstation)
+	    j = 0 ;
+	ps = &par_station[j] ;
+	if (ps->inflight)
+	    continue ;
+	this = (pclient_station) ((uintptr_t) client + client->offsets[j]) ;
+	sh = (pclient_station) ((uintptr_t) ps->shadow + ps->shadow->offsets[0]) ;
+	old_status = this->status ;
+	par_sync_in (client, j, FALSE) ;
+	result = cs_check (ps->shadow, 0, curtime) ;
+	sh->valdbuf = 0 ;
+	if (result == CSCR_GOOD)
+	{
+	    sh->command = CSCM_DATA_BLK ;
+	    status = cs_svc_start (ps->shadow, 0, &ps->slot, &ps->sleeptime) ;
+	    if (status == CSCR_GOOD)
+	    {
+		ps->inflight = TRUE ;
+		ps->sofar = 0 ;
+		continue ;
+	    }
+	    sh->status = status ;
+	}
+	if (sh->status != old_status)
+	    return par_deliver (client, j, alert) ;
+	par_sync_out (client, j, FALSE, TRUE) ;
+    }
+
+/* Wait for the first completion, or until all outstanding requests time out */
+    do
+    {
+	waiting = FALSE ;
+	sleeptime = 0 ;
+	for (n = 0 ; n < client->maxstation ; n++)
+	{
+	    if (++j >= client->maxstation)
+		j = 0 ;
+	    ps = &par_station[j] ;
+	    if (! ps->inflight)
+		continue ;
+	    sh = (pclient_station) ((uintptr_t) ps->shadow + ps->shadow->offsets[0]) ;
+	    if (ps->shadow->done || (ps->sofar > par_client_wait (ps)))
+	    {
+		old_status = sh->status ;
+		sh->status = cs_svc_finish (ps->shadow, 0, ps->slot) ;
+		ps->inflight = FALSE ;
+		if ((sh->status != old_status) || (sh->valdbuf != 0))
+		    ps->ready = TRUE ;
+		continue ;
+	    }
+	    waiting = TRUE ;
+	    if ((sleeptime == 0) || (ps->sleeptime < sleeptime))
+		sleeptime = ps->sleeptime ;
+	}
+	for (n = 0 ; n < client->maxstation ; n++)
+	{
+	    if (++j >= client->maxstation)
+		j = 0 ;
+	    if (par_station[j].ready)
+		return par_deliver (client, j, alert) ;
+	}
+	if (waiting)
+	{
+	    usleep (sleeptime) ; /* server completion SIGALRM ends this early */
+	    for (n = 0 ; n < client->maxstation ; n++)
+		if (par_station[n].inflight)
+		    par_station[n].sofar += sleeptime ;
+	}
+    }
+    while (waiting) ;
+    return NOCLIENT ;
+}
+
 short cs_scan (pclient_struc client, boolean *alert)
 {
     byte old_status, result ;
@@ -530,6 +938,8 @@ short cs_scan (pclient_struc client, boolean *alert)
     pclient_station this ;
     double curtime ;
       
+    if ((client == par_client) && (par_client != NULL))
+	return cs_scan_parallel (client, alert) ;
     old_station = client->curstation ;
     curtime = dtime () ;
     *alert = FALSE ;
@@ -558,3 +968,171 @@ short cs_scan (pclient_struc client, boolean *alert)
     return NOCLIENT ;      
 }
 
+/* TRUE if cs_scan would find new data or a changed server for any station */
+static boolean cs_pending (pclient_struc client)
+{
+    short j ;
+    pclient_station this ;
+    pserver_struc srvr ;
+
+    for (j = 0 ; j < client->maxstation ; j++)
+    {
+	if ((client == par_client) && (par_client != NULL))
+	{
+	    if (par_station[j].ready)
+		return TRUE ;
+	    if (par_station[j].inflight && par_station[j].shadow->done)
+		return TRUE ;
+	}
+	this = (pclient_station) ((uintptr_t) client + client->offsets[j]) ;
+	srvr = this->base ;
+	if ((this->status != CSCR_GOOD) || (srvr == (pserver_struc) NOCLIENT))
+	    continue ;
+	if ((this->servcode != srvr->servcode) || (this->next_data < srvr->next_data))
+	    return TRUE ;
+    }
+    return FALSE ;
+}
+
+/* Sleep for usec, or until the server of station j advances next_data
+   past the value the client last saw. */
+static void cs_wait_station (pclient_struc client, short j, int32_t usec)
+{
+#ifdef __linux__
+    pclient_station this ;
+    pserver_struc srvr ;
+    int32_t seen ;
+    struct timespec ts ;
+
+    this = (pclient_station) ((uintptr_t) client + client->offsets[j]) ;
+    srvr = this->base ;
+    if ((this->status == CSCR_GOOD) && (srvr != (pserver_struc) NOCLIENT))
+    {
+/* Count this client as waiting before reading next_data, the reverse of
+   the order in cs_signal_data */
+	__atomic_fetch_add (&srvr->data_waiters, 1, __ATOMIC_SEQ_CST) ;
+	seen = __atomic_load_n (&srvr->next_data, __ATOMIC_SEQ_CST) ;
+	if (this->next_data >= seen)
+	{
+	    ts.tv_sec = usec / 1000000 ;
+	    ts.tv_nsec = (usec % 1000000) * 1000 ;
+	    syscall (SYS_futex, &srvr->next_data, FUTEX_WAIT, seen, &ts, NULL, 0) ;
+	}
+	__atomic_fetch_sub (&srvr->data_waiters, 1, __ATOMIC_SEQ_CST) ;
+	return ;
+    }
+#endif
+    usleep (usec) ;
+}
+
+#ifdef CS_WAIT_WAITV
+static boolean have_waitv = TRUE ;
+
+/* Sleep for usec, or until the server of any linked station advances
+   next_data past the value the client last saw. Returns FALSE without
+   waiting if futex_waitv is not available or there are too many linked
+   stations for one call. */
+static boolean cs_wait_all (pclient_struc client, int32_t usec)
+{
+    struct futex_waitv waiters[FUTEX_WAITV_MAX] ;
+    pserver_struc srvrs[FUTEX_WAITV_MAX] ;
+    pclient_station this ;
+    struct timespec ts ;
+    int32_t seen ;
+    short j, n, i ;
+    boolean ready ;
+
+    if (! have_waitv)
+	return FALSE ;
+    n = 0 ;
+    ready = FALSE ;
+    for (j = 0 ; j < client->maxstation ; j++)
+    {
+	this = (pclient_station) ((uintptr_t) client + client->offsets[j]) ;
+	if ((this->status != CSCR_GOOD) || (this->base == (pserver_struc) NOCLIENT))
+	    continue ;
+	if (n >= FUTEX_WAITV_MAX)
+	    break ;
+	srvrs[n] = this->base ;
+	__atomic_fetch_add (&srvrs[n]->data_waiters, 1, __ATOMIC_SEQ_CST) ;
+	seen = __atomic_load_n (&srvrs[n]->next_data, __ATOMIC_SEQ_CST) ;
+	if (this->next_data < seen)
+	    ready = TRUE ;
+	memset (&waiters[n], 0, sizeof(waiters[n])) ;
+	waiters[n].val = (uint32_t) seen ;
+	waiters[n].uaddr = (uintptr_t) &srvrs[n]->next_data ;
+	waiters[n].flags = FUTEX_32 ;
+	n++ ;
+    }
+    if ((j < client->maxstation) || (n == 0))
+	ready = TRUE ; /* too many stations for futex_waitv, or none to wait on */
+    if (! ready)
+    {
+	clock_gettime (CLOCK_MONOTONIC, &ts) ;
+	ts.tv_sec += usec / 1000000 ;
+	ts.tv_nsec += (usec % 1000000) * 1000 ;
+	if (ts.tv_nsec >= 1000000000)
+	{
+	    ts.tv_sec++ ;
+	    ts.tv_nsec -= 1000000000 ;
+	}
+	if ((syscall (SYS_futex_waitv, waiters, n, 0, &ts, CLOCK_MONOTONIC) < 0) && (errno == ENOSYS))
+	    have_waitv = FALSE ;
+    }
+    for (i = 0 ; i < n ; i++)
+	__atomic_fetch_sub (&srvrs[i]->data_waiters, 1, __ATOMIC_SEQ_CST) ;
+    return have_waitv && ((j == client->maxstation) && (n > 0)) ;
+}
+#endif
+
+boolean cs_wait (pclient_struc client, int32_t maxusec)
+{
+    int32_t sofar, step ;
+    short j, n ;
+    double start ;
+
+    sofar = 0 ;
+    step = CS_WAIT_MIN_USEC ;
+    j = client->curstation ;
+    start = dtime () ;
+    while (! cs_pending (client))
+    {
+	if (sofar >= maxusec)
+	    return FALSE ;
+	if (step > maxusec - sofar)
+	    step = maxusec - sofar ;
+#ifdef CS_WAIT_WAITV
+	if (! cs_wait_all (client, step))
+#endif
+	{
+/* Block on the next linked station in turn, so a client of one station
+   is woken by its server as soon as data arrives */
+	    for (n = 0 ; n < client->maxstation ; n++)
+	    {
+		if (++j >= client->maxstation)
+		    j = 0 ;
+		if (((pclient_station) ((uintptr_t) client + client->offsets[j]))->status == CSCR_GOOD)
+		    break ;
+	    }
+	    cs_wait_station (client, j, step) ;
+	}
+	sofar = (int32_t) ((dtime () - start) * 1000000.0) ;
+	step = step * 2 ;
+	if (step > CS_WAIT_MAX_USEC)
+	    step = CS_WAIT_MAX_USEC ;
+    }
+    return TRUE ;
+}
+
+/* Wake the clients blocked in cs_wait on this server. Called by the
+   server whenever it advances next_data. The fence orders the new
+   next_data before the read of data_waiters, so a client that is about
+   to block either is counted here or sees the new next_data. */
+void cs_signal_data (pserver_struc srvr)
+{
+#ifdef __linux__
+    __atomic_thread_fence (__ATOMIC_SEQ_CST) ;
+    if (__atomic_load_n (&srvr->data_waiters, __ATOMIC_RELAXED) > 0)
+	syscall (SYS_futex, &srvr->next_data, FUTEX_WAKE, INT_MAX, NULL, NULL, 0) ;
+#endif
+}
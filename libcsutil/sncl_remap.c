@@ -0,0 +1,317 @@
+/************************************************************************
+ *  sncl_remap.c
+ *	Compiled SNCL remap table for MiniSEED records.
+ *	See sncl_remap.h for the rule syntax.
+ *
+ * Modification History:
+ *  2026-10-19 Initial version.  Replaces the per-client scnl_convert
+ *	table so that all forwarding clients remap consistently.
+ ************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <stdint.h>
+#include <fnmatch.h>
+
+#include "sncl_remap.h"
+
+#define NFIELDS		4	/* S, N, C, L in rule order.		*/
+#define FIELD_LEN	8	/* Max pattern/template length per field*/
+#define INITIAL_SLOTS	256	/* Initial cache size (power of 2).	*/
+
+enum { F_STA = 0, F_NET, F_CHAN, F_LOC };
+
+/* Position and width of each rule field in the packed 12 byte key.	*/
+static const int key_offset[NFIELDS] = { 0, 10, 7, 5 };
+static const int key_width[NFIELDS] = { 5, 2, 3, 2 };
+
+typedef struct _remap_rule {
+    char in[NFIELDS][FIELD_LEN+1];	/* fnmatch patterns.		*/
+    char out[NFIELDS][FIELD_LEN+1];	/* output templates.		*/
+} REMAP_RULE;
+
+typedef struct _remap_slot {
+    char key[SNCL_KEY_LEN];		/* input SNCL.			*/
+    char out[SNCL_KEY_LEN];		/* remapped SNCL.		*/
+    char used;				/* slot is in use.		*/
+    char changed;			/* out differs from key.	*/
+} REMAP_SLOT;
+
+struct _sncl_remap {
+    REMAP_RULE *rules;			/* rules in priority order.	*/
+    int nrules;
+    int maxrules;
+    REMAP_SLOT *slots;			/* cache of evaluated SNCLs.	*/
+    uint32_t nslots;			/* always a power of 2.		*/
+    uint32_t nused;
+};
+
+/************************************************************************
+ *  hash_key:
+ *	FNV-1a hash of a packed SNCL.
+ ************************************************************************/
+static uint32_t hash_key (const char *key)
+{
+    uint32_t h = 2166136261u;
+    int i;
+    for (i=0; i<SNCL_KEY_LEN; i++) {
+	h ^= (unsigned char)key[i];
+	h *= 16777619u;
+    }
+    return (h);
+}
+
+/************************************************************************
+ *  find_slot:
+ *	Return the cache slot for key, or the empty slot where it belongs.
+ ************************************************************************/
+static REMAP_SLOT *find_slot (REMAP_SLOT *slots, uint32_t nslots, const char *key)
+{
+    uint32_t i = hash_key(key) & (nslots - 1);
+    while (slots[i].used && memcmp(slots[i].key, key, SNCL_KEY_LEN) != 0) {
+	i = (i + 1) & (nslots - 1);
+    }
+    return (&slots[i]);
+}
+
+/************************************************************************
+ *  grow_cache:
+ *	Double the size of the cache.  Return 0 on success, -1 on error.
+ ************************************************************************/
+static int grow_cache (SNCL_REMAP *remap)
+{
+    uint32_t nslots = (remap->nslots) ? remap->nslots * 2 : INITIAL_SLOTS;
+    REMAP_SLOT *slots;
+    uint32_t i;
+
+    slots = (REMAP_SLOT *)calloc (nslots, sizeof(REMAP_SLOT));
+    if (slots == NULL) return (-1);
+    for (i=0; i<remap->nslots; i++) {
+	if (remap->slots[i].used) {
+	    *find_slot (slots, nslots, remap->slots[i].key) = remap->slots[i];
+	}
+    }
+    free (remap->slots);
+    remap->slots = slots;
+    remap->nslots = nslots;
+    return (0);
+}
+
+/************************************************************************
+ *  clear_cache:
+ *	Discard all cached results (eg after the rules change).
+ ************************************************************************/
+static void clear_cache (SNCL_REMAP *remap)
+{
+    if (remap->slots) memset (remap->slots, 0, remap->nslots * sizeof(REMAP_SLOT));
+    remap->nused = 0;
+}
+
+/************************************************************************
+ *  key_field:
+ *	Extract a blank-trimmed, null-terminated field from a packed key.
+ ************************************************************************/
+static void key_field (const char *key, int f, char *str)
+{
+    int n = key_width[f];
+    memcpy (str, key + key_offset[f], n);
+    while (n > 0 && (str[n-1] == ' ' || str[n-1] == '\0')) --n;
+    str[n] = '\0';
+}
+
+/************************************************************************
+ *  parse_sncl:
+ *	Split STA.NET.CHAN.LOC (or STA.NET) into upper case fields.
+ *	A "--" location is stored as an empty string.
+ *	Return 0 on success, -1 on error.
+ ************************************************************************/
+static int parse_sncl (const char *sncl, char field[NFIELDS][FIELD_LEN+1], int is_output)
+{
+    const char *p = sncl;
+    const char *q;
+    int f, n, i;
+
+    for (f=0; f<NFIELDS; f++) {
+	if (p == NULL) {
+	    /* STA.NET shorthand - match or keep any CHAN and LOC.	*/
+	    if (f != F_CHAN) return (-1);
+	    strcpy (field[F_CHAN], "*");
+	    strcpy (field[F_LOC], "*");
+	    return (0);
+	}
+	q = strchr (p, '.');
+	n = (q) ? (int)(q - p) : (int)strlen(p);
+	if (n > FIELD_LEN) return (-1);
+	if (is_output && n > key_width[f] && ! (n == 1 && p[0] == '*')) return (-1);
+	for (i=0; i<n; i++) field[f][i] = toupper((unsigned char)p[i]);
+	field[f][n] = '\0';
+	if (f == F_LOC && strcmp(field[f], "--") == 0) field[f][0] = '\0';
+	p = (q) ? q + 1 : NULL;
+    }
+    return (p == NULL) ? 0 : -1;
+}
+
+/************************************************************************
+ *  apply_rules:
+ *	Compute the remapped key for key.  Return 1 if changed, else 0.
+ ************************************************************************/
+static int apply_rules (SNCL_REMAP *remap, const char *key, char *out)
+{
+    char in[NFIELDS][FIELD_LEN+1];
+    REMAP_RULE *r;
+    int i, f, j, n;
+
+    memcpy (out, key, SNCL_KEY_LEN);
+    for (f=0; f<NFIELDS; f++) key_field (key, f, in[f]);
+    for (i=0; i<remap->nrules; i++) {
+	r = &remap->rules[i];
+	for (f=0; f<NFIELDS; f++) {
+	    if (fnmatch (r->in[f], in[f], 0) != 0) break;
+	}
+	if (f < NFIELDS) continue;
+	/* First matching rule - build the output fields.		*/
+	for (f=0; f<NFIELDS; f++) {
+	    const char *t = r->out[f];
+	    char *o = out + key_offset[f];
+	    if (strcmp (t, "*") == 0) continue;
+	    n = strlen(t);
+	    for (j=0; j<key_width[f]; j++) {
+		if (j >= n) o[j] = ' ';
+		else if (t[j] == '?') o[j] = key[key_offset[f]+j];
+		else o[j] = t[j];
+	    }
+	}
+	break;
+    }
+    return (memcmp (out, key, SNCL_KEY_LEN) != 0);
+}
+
+/************************************************************************
+ *  sncl_remap_new:
+ ************************************************************************/
+SNCL_REMAP *sncl_remap_new (void)
+{
+    SNCL_REMAP *remap = (SNCL_REMAP *)calloc (1, sizeof(SNCL_REMAP));
+    if (remap == NULL) return (NULL);
+    if (grow_cache (remap) < 0) {
+	free (remap);
+	return (NULL);
+    }
+    return (remap);
+}
+
+/************************************************************************
+ *  sncl_remap_free:
+ ************************************************************************/
+void sncl_remap_free (SNCL_REMAP *remap)
+{
+    if (remap == NULL) return;
+    free (remap->rules);
+    free (remap->slots);
+    free (remap);
+}
+
+/************************************************************************
+ *  sncl_remap_add:
+ *	Append a rule.  Return 0 on success, -1 on error.
+ ************************************************************************/
+int sncl_remap_add (SNCL_REMAP *remap, const char *in_sncl, const char *out_sncl)
+{
+    REMAP_RULE rule;
+
+    if (parse_sncl (in_sncl, rule.in, 0) < 0) {
+	fprintf (stderr, "sncl_remap: invalid input SNCL pattern: %s\n", in_sncl);
+	return (-1);
+    }
+    if (parse_sncl (out_sncl, rule.out, 1) < 0) {
+	fprintf (stderr, "sncl_remap: invalid output SNCL template: %s\n", out_sncl);
+	return (-1);
+    }
+    if (remap->nrules == remap->maxrules) {
+	int maxrules = (remap->maxrules) ? remap->maxrules * 2 : 16;
+	REMAP_RULE *rules = (REMAP_RULE *)realloc (remap->rules, maxrules * sizeof(REMAP_RULE));
+	if (rules == NULL) {
+	    fprintf (stderr, "sncl_remap: out of memory for rules\n");
+	    return (-1);
+	}
+	remap->rules = rules;
+	remap->maxrules = maxrules;
+    }
+    remap->rules[remap->nrules++] = rule;
+    clear_cache (remap);
+    return (0);
+}
+
+/************************************************************************
+ *  sncl_remap_load:
+ *	Append rules from a file.  Return number of rules read or -1.
+ ************************************************************************/
+int sncl_remap_load (SNCL_REMAP *remap, const char *filename)
+{
+    FILE *fp;
+    char line[256], in_sncl[64], out_sncl[64];
+    int n = 0, lineno = 0;
+
+    if ((fp = fopen (filename, "r")) == NULL) {
+	fprintf (stderr, "sncl_remap: unable to open %s\n", filename);
+	return (-1);
+    }
+    while (fgets (line, sizeof(line), fp) != NULL) {
+	++lineno;
+	if (sscanf (line, "%63s", in_sncl) != 1 || in_sncl[0] == '#') continue;
+	if (sscanf (line, "%63s %63s", in_sncl, out_sncl) != 2 ||
+	    sncl_remap_add (remap, in_sncl, out_sncl) < 0) {
+	    fprintf (stderr, "sncl_remap: error at line %d of %s\n", lineno, filename);
+	    fclose (fp);
+	    return (-1);
+	}
+	++n;
+    }
+    fclose (fp);
+    return (n);
+}
+
+/************************************************************************
+ *  sncl_remap_nrules:
+ ************************************************************************/
+int sncl_remap_nrules (SNCL_REMAP *remap)
+{
+    return (remap) ? remap->nrules : 0;
+}
+
+/************************************************************************
+ *  sncl_remap_key:
+ *	Remap a packed SNCL in place.  Return 1 if changed, 0 if not,
+ *	-1 on error.
+ ************************************************************************/
+int sncl_remap_key (SNCL_REMAP *remap, char *key)
+{
+    REMAP_SLOT *slot;
+
+    if (remap == NULL || remap->nrules == 0) return (0);
+    slot = find_slot (remap->slots, remap->nslots, key);
+    if (! slot->used) {
+	if (2 * (remap->nused + 1) > remap->nslots) {
+	    if (grow_cache (remap) < 0) return (-1);
+	    slot = find_slot (remap->slots, remap->nslots, key);
+	}
+	memcpy (slot->key, key, SNCL_KEY_LEN);
+	slot->changed = apply_rules (remap, key, slot->out);
+	slot->used = 1;
+	remap->nused++;
+    }
+    if (! slot->changed) return (0);
+    memcpy (key, slot->out, SNCL_KEY_LEN);
+    return (1);
+}
+
+/************************************************************************
+ *  sncl_remap_record:
+ *	Remap the SNCL in a MiniSEED fixed header in place.
+ ************************************************************************/
+int sncl_remap_record (SNCL_REMAP *remap, char *record)
+{
+    return (sncl_remap_key (remap, record + SNCL_KEY_OFFSET));
+}
@@ -25,6 +25,8 @@ Edit History:
    -- ---------- --- ---------------------------------------------------
     0 2020-08-31 DSN Created from Lib660.
     1 2020-09-29 DSN Updated for comserv3.
+    2 2026-10-19     Added msmcast_local_path and tminiseed_call reception_time.
+    3 2026-10-19     Added MSMCAST_LOCAL_STAMP.
 */
 
 #ifndef LIBCLIENT_H
@@ -69,8 +71,14 @@ typedef struct { /* parameters for lib_register call */
     word opt_connwait ; /* wait this many minutes after connection time or buflevel shutdown */
 //::     string15 seed_station;
 //::     string15 seed_network;
+    string250 msmcast_local_path ; /* if non-empty, receive from mserv demux socket at this path */
 } tpar_register ;
 
+/* Each record the mserv demultiplexer sends to msmcast_local_path is
+   preceded by a struct timespec with the time the demultiplexer received
+   it from the multicast group. */
+#define MSMCAST_LOCAL_STAMP sizeof(struct timespec)
+
 #define AC_FIRST LOGF_DATA_GAP
 #define AC_LAST LOGF_CHKERR
 #define INVALID_ENTRY -1 /* no data for this time period */
@@ -108,6 +116,7 @@ typedef struct { /* format for miniseed and archival miniseed */
     enum tpacket_class packet_class ; /* type of record */
     word data_size ; /* size of actual miniseed data */
     pointer data_address ; /* pointer to miniseed record */
+    double reception_time ; /* Time the record was received (seconds since 1970) */
 } tminiseed_call ;
 typedef tminiseed_call *pminiseed_call ;
 
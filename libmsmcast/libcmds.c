@@ -25,11 +25,20 @@ Edit History:
    -- ---------- --- ---------------------------------------------------
     0 2020-08-31 DSN Created from Lib660.
     1 2020-09-29 DSN Updated for comserv3.
+    2 2026-10-19     Receive from a local mserv demux socket if msmcast_local_path is set.
+    3 2026-10-19     Read datagrams in batches with recvmmsg, with kernel receive
+                     timestamps (SO_TIMESTAMPNS) passed as the reception time.
+    4 2026-10-19     Records from a local demux socket carry the time the
+                     demultiplexer received them, which is used instead.
 */
 
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE /* recvmmsg */
+#endif
 #include "libcmds.h"
 #include "libclient.h"
 #include "libmsgs.h"
+#include <sys/un.h>
 
 #define RECV_BUF_NUM_MSEED_PACKETS 100 /* the maximum number of mseed packets to buffer in recv() */
 
@@ -57,6 +66,8 @@ void close_socket (pmsmcast msmcast)
     {
         close (msmcast->cpath) ;
         msmcast->cpath = INVALID_SOCKET ;
+        if (msmcast->par_register.msmcast_local_path[0])
+            unlink (msmcast->par_register.msmcast_local_path) ;
     }
 }
 
@@ -167,6 +178,13 @@ void lib_continue_registration (pmsmcast msmcast)
     wb = bufso;
     init_bufsocket (bufso, BUFSOCKETSIZE);
 
+    if (msmcast->par_register.msmcast_local_path[0])
+    {
+        sprintf (s, "on %s", msmcast->par_register.msmcast_local_path) ;
+        libmsgadd(msmcast, LIBMSG_SOCKETOPEN, s) ;
+        new_state (msmcast, LIBSTATE_REQ) ;
+        return ;
+    }
     if (msmcast->ipv6)
     {
         lth = sizeof(struct sockaddr_in6) ;
@@ -209,6 +227,82 @@ void send_chan_mask (pmsmcast msmcast)
     /*:: Function not needed. */
 }
 
+/* Request kernel receive timestamps on the socket.  If not available, */
+/* records are stamped with the time they are read.                    */
+static void enable_timestamps (pmsmcast msmcast)
+{
+    int flag = 1 ;
+    string s ;
+
+    msmcast->rcv_timestamps = (setsockopt (msmcast->cpath, SOL_SOCKET, SO_TIMESTAMPNS,
+					   (pvoid)addr(flag), sizeof(flag)) == 0) ;
+    if (! msmcast->rcv_timestamps)
+    {
+        sprintf (s, "%d setsockopt SO_TIMESTAMPNS, using read time", errno) ;
+        libmsgadd(msmcast, LIBMSG_SOCKETERR, s) ;
+    }
+}
+
+/* Open a local datagram socket that receives this station's records */
+/* from an mserv multicast demultiplexer (mserv -d).                 */
+static boolean open_local_socket (pmsmcast msmcast)
+{
+    integer flag, err ;
+    int recv_buf_bytes ;
+    struct sockaddr_un sun ;
+    string s ;
+
+    close_socket (msmcast) ;
+    if (strlen(msmcast->par_register.msmcast_local_path) >= sizeof(sun.sun_path))
+    {
+        libmsgadd(msmcast, LIBMSG_ADDRERR, msmcast->par_register.msmcast_local_path) ;
+        return TRUE ;
+    }
+    msmcast->cpath = socket (AF_UNIX, SOCK_DGRAM, 0) ;
+    if (msmcast->cpath == INVALID_SOCKET)
+    {
+        err = errno ;
+        sprintf (s, "%d opening socket %s", err, msmcast->par_register.msmcast_local_path) ;
+        libmsgadd(msmcast, LIBMSG_SOCKETERR, s) ;
+        return TRUE ;
+    }
+
+    /* Remove a socket left by a previous server, and bind. */
+    memset (&sun, 0, sizeof(sun)) ;
+    sun.sun_family = AF_UNIX ;
+    strcpy (sun.sun_path, msmcast->par_register.msmcast_local_path) ;
+    unlink (sun.sun_path) ;
+    if (bind (msmcast->cpath, (struct sockaddr *)&sun, sizeof(sun)))
+    {
+        err = errno ;
+        sprintf (s, "%d bind socket %s", err, msmcast->par_register.msmcast_local_path) ;
+        libmsgadd(msmcast, LIBMSG_SOCKETERR, s) ;
+        close (msmcast->cpath) ;
+        msmcast->cpath = INVALID_SOCKET ;
+        return TRUE ;
+    }
+
+    /* The demultiplexer drops records rather than block, so give */
+    /* the socket the same buffer as the multicast socket.        */
+    recv_buf_bytes = MAX_MSEED_BLKSIZE * RECV_BUF_NUM_MSEED_PACKETS;
+    if (setsockopt(msmcast->cpath,SOL_SOCKET,SO_RCVBUF,
+		   &recv_buf_bytes,sizeof(recv_buf_bytes)))
+    {
+	err = errno ;
+	sprintf (s, "%d setsockopt SO_RCVBUF %d on %s", 
+		 err, recv_buf_bytes, msmcast->par_register.msmcast_local_path) ;
+	libmsgadd(msmcast, LIBMSG_SOCKETERR, s) ;
+    }
+
+    if (msmcast->cpath > msmcast->high_socket)
+	msmcast->high_socket = msmcast->cpath ;
+    flag = fcntl (msmcast->cpath, F_GETFL, 0) ;
+    fcntl (msmcast->cpath, F_SETFL, flag | O_NONBLOCK) ;
+    msmcast->rcv_timestamps = FALSE ; /* records carry the demultiplexer receive time */
+    msmcast->ipv6 = FALSE ;
+    return FALSE ;
+}
+
 static boolean open_socket (pmsmcast msmcast)
 {
     integer flag, j, err  ;
@@ -230,6 +324,9 @@ static boolean open_socket (pmsmcast msmcast)
     int recv_buf_bytes ;
     struct ip_mreq mreq;
     struct ipv6_mreq mreq6 ;
+
+    if (msmcast->par_register.msmcast_local_path[0])
+        return open_local_socket (msmcast) ;
     close_socket (msmcast) ;
     is_ipv6 = FALSE ;
 
@@ -384,6 +481,7 @@ static boolean open_socket (pmsmcast msmcast)
 	}
     }
 
+    enable_timestamps (msmcast) ;
     msmcast->ipv6 = is_ipv6 ;
     return FALSE ;
 }
@@ -420,11 +518,36 @@ static void check_for_disconnect (pmsmcast msmcast, integer err)
 }
 
 
+/* Return the reception time of a received datagram, seconds since 1970. */
+static double reception_time (struct msghdr *mh, double readtime)
+{
+    struct cmsghdr *cm ;
+    struct timespec ts ;
+
+    for (cm = CMSG_FIRSTHDR(mh) ; cm != NULL ; cm = CMSG_NXTHDR(mh, cm))
+    {
+        if (cm->cmsg_level == SOL_SOCKET && cm->cmsg_type == SCM_TIMESTAMPNS)
+	{
+	    memcpy (addr(ts), CMSG_DATA(cm), sizeof(ts)) ;
+	    return (double)ts.tv_sec + (double)ts.tv_nsec / 1.0e9 ;
+	}
+    }
+    return readtime ;
+}
+
 void read_mcast_socket (pmsmcast msmcast)
 {
     integer err ;
     integer recsize ;
     integer good ;
+    integer i, n ;
+    struct mmsghdr msgs[MCAST_BATCH] ;
+    struct iovec iov[MCAST_BATCH] ;
+    struct iovec liov[MCAST_BATCH][2] ;
+    struct timespec stamp[MCAST_BATCH] ;
+    struct timespec ts ;
+    double readtime, rtime ;
+    boolean local ;
     string s ;
 
     switch (msmcast->libstate) {
@@ -434,10 +557,33 @@ void read_mcast_socket (pmsmcast msmcast)
 	    DBPRINT(printf ("DEBUG:: Invalid socket in read_mcast_socket"));
 	    return ;
 	}
-	err = (integer)recv (msmcast->cpath, (pvoid)addr(msmcast->tcpbuf[msmcast->tcpidx]),
-			     TCPBUFSZ - msmcast->tcpidx, 0) ;
-	DBPRINT(printf ("DEBUG:: recv err=%d\n", err));
-	if (err == SOCKET_ERROR)
+	/* Drain up to MCAST_BATCH datagrams from the socket at once. */
+	local = (msmcast->par_register.msmcast_local_path[0] != 0) ;
+	memclr (addr(msgs), sizeof(msgs)) ;
+	for (i = 0 ; i < MCAST_BATCH ; i++)
+	{
+	    iov[i].iov_base = msmcast->mcastbuf[i] ;
+	    iov[i].iov_len = TCPBUFSZ ;
+	    msgs[i].msg_hdr.msg_iov = addr(iov[i]) ;
+	    msgs[i].msg_hdr.msg_iovlen = 1 ;
+	    if (local)
+	    {
+		/* The demultiplexer's receive time precedes the record. */
+		liov[i][0].iov_base = addr(stamp[i]) ;
+		liov[i][0].iov_len = MSMCAST_LOCAL_STAMP ;
+		liov[i][1] = iov[i] ;
+		msgs[i].msg_hdr.msg_iov = liov[i] ;
+		msgs[i].msg_hdr.msg_iovlen = 2 ;
+	    }
+	    else if (msmcast->rcv_timestamps)
+	    {
+		msgs[i].msg_hdr.msg_control = msmcast->mcastctl[i] ;
+		msgs[i].msg_hdr.msg_controllen = MCAST_CTLSZ ;
+	    }
+	}
+	n = (integer)recvmmsg (msmcast->cpath, msgs, MCAST_BATCH, MSG_DONTWAIT, NULL) ;
+	DBPRINT(printf ("DEBUG:: recvmmsg n=%d\n", n));
+	if (n == SOCKET_ERROR)
 	{
 	    err = errno ;
 	    if (err == EPIPE)
@@ -449,33 +595,41 @@ void read_mcast_socket (pmsmcast msmcast)
 	    }
 	    return ;
 	}
-	else if (err == 0)
+	else if (n <= 0)
 	{
-	    DBPRINT (printf("state=%d recv err 0, read size=%d\n",msmcast->libstate, TCPBUFSZ - msmcast->tcpidx));
-	    check_for_disconnect (msmcast, ECONNRESET) ;
 	    return ;
 	}
-	else if (err < 0)
-	{
-	    return ;
-	}
-	/* Increment status info for the data packet read. */
-	add_status (msmcast, LOGF_RECVBPS, err) ;
-	add_status (msmcast, LOGF_PACKRECV, 1) ;
-
-	/* Process and distribute MiniSEED data packet. */
-	int recsize = err;
-	DBPRINT(printf ("DEBUG:: calling process_mseed\n"));
-	good = process_mseed (msmcast, (pvoid)addr(msmcast->tcpbuf[msmcast->tcpidx]), recsize);
-	DBPRINT(printf ("DEBUG:: process_mseed rc=%d\n", good));
-	if (! good)
+	clock_gettime (CLOCK_REALTIME, addr(ts)) ;
+	readtime = (double)ts.tv_sec + (double)ts.tv_nsec / 1.0e9 ;
+
+	for (i = 0 ; i < n ; i++)
 	{
-	    tcp_error (msmcast, "Invalid Data Packet") ;
+	    /* Increment status info for the data packet read. */
+	    recsize = (integer)msgs[i].msg_len ;
+	    add_status (msmcast, LOGF_RECVBPS, recsize) ;
+	    add_status (msmcast, LOGF_PACKRECV, 1) ;
+	    if (local)
+	    {
+		recsize = recsize - (integer)MSMCAST_LOCAL_STAMP ;
+		rtime = (recsize >= 0) ?
+		    (double)stamp[i].tv_sec + (double)stamp[i].tv_nsec / 1.0e9 : readtime ;
+	    }
+	    else
+		rtime = reception_time (addr(msgs[i].msg_hdr), readtime) ;
+
+	    /* Process and distribute MiniSEED data packet. */
+	    /* Since this library read multicast UDP MiniSEED packets, */
+	    /* by definition there is only one MiniSEED record per packet. */
+	    DBPRINT(printf ("DEBUG:: calling process_mseed\n"));
+	    good = process_mseed (msmcast, (pvoid)msmcast->mcastbuf[i], recsize, rtime) ;
+	    DBPRINT(printf ("DEBUG:: process_mseed rc=%d\n", good));
+	    if (! good)
+	    {
+		/* The socket has been closed, discard the rest of the batch. */
+		tcp_error (msmcast, "Invalid Data Packet") ;
+		break ;
+	    }
 	}
-	
-	/* Since this library read multicast UDP MiniSEED packets, */
-	/* by definition there is only one MiniSEED record per packet. */
-//::       	msmcast->tcpidx = msmcast->tcpidx + recsize ;
 	msmcast->tcpidx = 0;
 	break ;
     default :
@@ -24,6 +24,8 @@ Edit History:
    -- ---------- --- ---------------------------------------------------
     0 2020-08-31 DSN Created from Lib660.
     1 2020-09-29 DSN Updated for comserv3.
+    2 2026-10-19     Pass the record reception time to the miniseed callback.
+    3 2026-10-19     Set the miniseed callback timestamp to the reception time.
 */
 
 #include "libtypes.h"
@@ -40,7 +42,7 @@ typedef char string5[6];
 #define DBPRINT(A) 
 #endif
 
-int process_mseed(pmsmcast msmcast, pbyte pbuf, int recsize)
+int process_mseed(pmsmcast msmcast, pbyte pbuf, int recsize, double reception_time)
 {
     seed_header hdr;
     int status;
@@ -87,10 +89,11 @@ int process_mseed(pmsmcast msmcast, pbyte pbuf, int recsize)
     drate = sps_rate(hdr.sample_rate_factor, hdr.sample_rate_multiplier);
     irate = (drate >= 1) ? lib_round(drate) : (-1 * lib_round (1./drate));
     msmcast->miniseed_call.rate = irate;
-    msmcast->miniseed_call.timestamp = 0. ;  //:: FIX THIS
+    msmcast->miniseed_call.timestamp = reception_time ;
     msmcast->miniseed_call.packet_class = packet_class ;
     msmcast->miniseed_call.data_size = 512 ;
     msmcast->miniseed_call.data_address = pbuf ;
+    msmcast->miniseed_call.reception_time = reception_time ;
     msmcast->par_create.call_minidata (addr(msmcast->miniseed_call)) ;
 
     return TRUE;
@@ -24,6 +24,7 @@ Edit History:
    -- ---------- --- ---------------------------------------------------
     0 2020-08-31 DSN Created from Lib660.
     1 2020-09-29 DSN Updated for comserv3.
+    2 2026-10-19     Added reception_time to process_mseed.
 */
 
 #ifndef LIBDATA_H
@@ -36,6 +37,6 @@ Edit History:
 #include "libstrucs.h"
 #include "libsupport.h"
 
-int process_mseed(pmsmcast msmcast, pbyte pbuf, int recsize);
+int process_mseed(pmsmcast msmcast, pbyte pbuf, int recsize, double reception_time);
 
 #endif
@@ -25,6 +25,7 @@ Edit History:
    -- ---------- --- ---------------------------------------------------
     0 2020-08-31 DSN Created from Lib660.
     1 2020-09-29 DSN Updated for comserv3.
+    2 2026-10-19     Added batch receive buffers for read_mcast_socket.
 */
 
 #ifndef LIBSTRUCS_H
@@ -40,6 +41,8 @@ Edit History:
 /* Make the buffer the 2x size of the maximum expected MSEED packet size. */
 #define MAX_MSEED_BLKSIZE 512
 #define TCPBUFSZ MAX_MSEED_BLKSIZE * 2
+#define MCAST_BATCH 32 /* maximum datagrams read by one recvmmsg */
+#define MCAST_CTLSZ 64 /* control buffer for the receive timestamp */
 #define DEFAULT_PIU_RETRY 5 * 60 /* Port in Use */
 #define DEFAULT_DATA_TIMEOUT 5 * 60 /* Data timeout */
 #define DEFAULT_DATA_TIMEOUT_RETRY 5 * 60 ;
@@ -108,6 +111,9 @@ typedef struct { /* this is the actual context which is hidden from clients */
     integer log_timer ; /* count-down since last added message line */
     plcq msg_lcq ;
     string31 station_ident ; /* network-station */
+    boolean rcv_timestamps ; /* kernel receive timestamps enabled */
+    char mcastbuf[MCAST_BATCH][TCPBUFSZ] ; /* batch of received datagrams */
+    char mcastctl[MCAST_BATCH][MCAST_CTLSZ] ; /* and their timestamps */
     /* following are cleared after de-registering */
     word first_clear ; /* first byte to clear */
     boolean ipv6 ; /* TRUE if using IPV6 */
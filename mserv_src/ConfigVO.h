@@ -55,6 +55,7 @@ public:
     char *   getMcastIf() const;
     char *   getUdpAddr() const;
     uint32_t getIPPort() const;
+    char *   getDemuxDir() const;
     char *   getLockFile() const;
     char *   getStartMsg() const;
     uint32_t getStatusInterval() const;
@@ -76,6 +77,7 @@ public:
     void setMcastIf(char *input);
     void setUdpAddr(char *input);
     void setIPPort(char *input);
+    void setDemuxDir(char *input);
     void setLockFile(char* input);
     void setStartMsg(char* input);
     void setStatusInterval(char *input);
@@ -106,6 +108,7 @@ private:
     char p_mcastif[256];
     char p_udpaddr[256];
     uint32_t p_ipport;
+    char p_demuxdir[256];
     char p_lockfile[256];
     char p_startmsg[256];
     uint32_t p_statusinterval;
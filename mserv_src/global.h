@@ -9,6 +9,8 @@
     2012-01-11 - v2.0.5 - paulf version with newer compiler fixes 
     2012-02-06 - v2.0.6 - DSN version with limit to RLIMIT_NOFILE.
     2020-09-29 DSN Updated for comserv3.
+    2026-10-19 - v2.1.0 - Added -d multicast demultiplexer mode and DEMUXDIR.
+    2026-10-19 - v2.1.1 - Asynchronous log writer.
 */
 
 #ifndef __GLOBAL_H__
@@ -29,9 +31,9 @@
 
 #define APP_IDENT_STRING "mserv"
 #define MAJOR_VERSION 2
-#define MINOR_VERSION 0
-#define RELEASE_VERSION 3
-#define RELEASE_DATE "2023.093-beta"
+#define MINOR_VERSION 1
+#define RELEASE_VERSION 1
+#define RELEASE_DATE "2026.292"
 #define APP_VERSION_STRING APP_IDENT_STRING " v" STRING(MAJOR_VERSION) "." STRING(MINOR_VERSION) "." STRING(RELEASE_VERSION) " (" RELEASE_DATE ")"
 
 #define STATION_INI	"station.ini"
@@ -0,0 +1,391 @@
+/*
+ * File     :
+ *   mcastdemux.c
+ *
+ * Purpose  :
+ *  Single multicast receiver for mserv.
+ *
+ *  When several mserv servers receive stations from the same multicast
+ *  group, each one normally joins the group and receives and parses
+ *  every station's packets.  In demux mode (mserv -d) one process joins
+ *  the group, drains it in batches with recvmmsg, and forwards each
+ *  MiniSEED record by its fixed header station and network codes to
+ *  the local datagram socket of that station's mserv with sendmmsg.
+ *  A per-station mserv with DEMUXDIR set reads only its own records
+ *  from the socket DEMUXDIR/NET.STA instead of joining the group.
+ *
+ *  Records for stations with no running mserv are dropped, and the
+ *  station's socket is retried every DEMUX_RETRY seconds.
+ *
+ *  Each forwarded record is preceded by a struct timespec with the
+ *  kernel receive time of its multicast datagram (MSMCAST_LOCAL_STAMP
+ *  in libmsmcast), so the station's mserv stamps the record with the
+ *  time it arrived rather than the time it crossed the local socket.
+ *
+ * 2026-10-19 Initial version.
+ * 2026-10-19 Forward the multicast receive time with each record.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE	/* recvmmsg and sendmmsg */
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <signal.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "logging.h"
+#include "mcastdemux.h"
+
+#define DEMUX_BATCH	64	/* Max datagrams per recvmmsg/sendmmsg.	*/
+#define DEMUX_PKTSIZE	8192	/* Max datagram size.			*/
+#define DEMUX_SLOTS	4096	/* Station table size (power of 2).	*/
+#define DEMUX_RETRY	10	/* Seconds before retrying a socket.	*/
+#define DEMUX_RCVBUF	(512 * 2000)	/* Multicast socket buffer size.	*/
+#define	MIN_HDR_SIZE	20	/* Bytes needed for station and network.*/
+#define	DEMUX_CTLSZ	64	/* Control buffer for the receive time.	*/
+
+#define	STA_OFFSET	8	/* Fixed header station offset.		*/
+#define	STA_LEN		5
+#define	NET_OFFSET	18	/* Fixed header network offset.		*/
+#define	NET_LEN		2
+#define	KEY_LEN		(STA_LEN+NET_LEN)
+
+typedef struct _demux_dest {
+    char    key[KEY_LEN];	/* station and network from header.	*/
+    char    used;		/* slot is in use.			*/
+    char    present;		/* station socket accepted last record.	*/
+    char    invalid;		/* no socket path for station.		*/
+    time_t  retry;		/* time to retry an absent station.	*/
+    struct sockaddr_un sun;	/* station socket address.		*/
+    socklen_t sunlen;
+    uint64_t delivered;
+    uint64_t dropped;
+} DEMUX_DEST;
+
+static DEMUX_DEST *dest;
+static int ndest;
+static volatile sig_atomic_t demux_done;
+
+static void demux_finish (int sig)
+{
+    demux_done = 1;
+}
+
+/************************************************************************
+ *  trimcpy:
+ *	Copy n characters of a blank-padded field, dropping blanks.
+ ************************************************************************/
+static void trimcpy (char *out, const char *in, int n)
+{
+    int i, j = 0;
+    for (i=0; i<n; i++) {
+	if (in[i] != ' ' && in[i] != '\0') out[j++] = in[i];
+    }
+    out[j] = '\0';
+}
+
+/************************************************************************
+ *  mcast_demux_path:
+ *	Build the local socket pathname for a station.
+ *	Return 0 on success, -1 if the path is too long or incomplete.
+ ************************************************************************/
+int mcast_demux_path (char *path, int pathlen, char *demuxdir,
+		      char *station, char *network)
+{
+    char sta[STA_LEN+1], net[NET_LEN+1];
+    int n;
+
+    trimcpy (sta, station, strnlen(station, STA_LEN));
+    trimcpy (net, network, strnlen(network, NET_LEN));
+    if (sta[0] == '\0' || net[0] == '\0') return -1;
+    n = snprintf (path, pathlen, "%s/%s.%s", demuxdir, net, sta);
+    if (n < 0 || n >= pathlen || n >= (int)sizeof(((struct sockaddr_un *)0)->sun_path))
+	return -1;
+    return 0;
+}
+
+/************************************************************************
+ *  find_dest:
+ *	Return the table entry for the station and network in a record,
+ *	creating it if necessary.  Return NULL if the table is full.
+ ************************************************************************/
+static DEMUX_DEST *find_dest (const char *rec, char *demuxdir)
+{
+    char key[KEY_LEN];
+    char sta[STA_LEN+1], net[NET_LEN+1];
+    uint32_t h = 2166136261u;
+    DEMUX_DEST *dp;
+    int i;
+
+    memcpy (key, rec + STA_OFFSET, STA_LEN);
+    memcpy (key + STA_LEN, rec + NET_OFFSET, NET_LEN);
+    for (i=0; i<KEY_LEN; i++) {
+	h ^= (unsigned char)key[i];
+	h *= 16777619u;
+    }
+    i = h & (DEMUX_SLOTS - 1);
+    while (dest[i].used && memcmp (dest[i].key, key, KEY_LEN) != 0) {
+	i = (i + 1) & (DEMUX_SLOTS - 1);
+    }
+    dp = &dest[i];
+    if (dp->used) return dp;
+    if (4 * (ndest + 1) > 3 * DEMUX_SLOTS) return NULL;
+
+    memcpy (dp->key, key, KEY_LEN);
+    dp->used = 1;
+    dp->sun.sun_family = AF_UNIX;
+    memcpy (sta, key, STA_LEN);
+    sta[STA_LEN] = '\0';
+    memcpy (net, key + STA_LEN, NET_LEN);
+    net[NET_LEN] = '\0';
+    if (mcast_demux_path (dp->sun.sun_path, sizeof(dp->sun.sun_path),
+			  demuxdir, sta, net) != 0) {
+	dp->invalid = 1;
+	LogMessage (CS_LOG_TYPE_ERROR, "demux: invalid station or network in record: '%.5s' '%.2s'\n",
+		    key, key + STA_LEN);
+    }
+    dp->sunlen = sizeof(dp->sun);
+    ++ndest;
+    return dp;
+}
+
+/************************************************************************
+ *  open_mcast:
+ *	Open a UDP socket joined to the multicast group.
+ *	Return the socket, or -1 on error.
+ ************************************************************************/
+static int open_mcast (char *mcastif, char *udpaddr, int port)
+{
+    struct addrinfo hints, *grp = NULL, *ifa = NULL;
+    char portstr[16];
+    int fd, on = 1, rcvbuf = DEMUX_RCVBUF, err;
+
+    memset (&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    hints.ai_flags = AI_PASSIVE;
+    sprintf (portstr, "%d", port);
+    if ((err = getaddrinfo (udpaddr, portstr, &hints, &grp)) != 0) {
+	LogMessage (CS_LOG_TYPE_ERROR, "demux: invalid multicast address %s: %s\n",
+		    udpaddr, gai_strerror(err));
+	return -1;
+    }
+    if ((fd = socket (grp->ai_family, SOCK_DGRAM, 0)) < 0) {
+	LogMessage (CS_LOG_TYPE_ERROR, "demux: %d opening socket for %s\n", errno, udpaddr);
+	freeaddrinfo (grp);
+	return -1;
+    }
+    setsockopt (fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    if (setsockopt (fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf)) != 0) {
+	LogMessage (CS_LOG_TYPE_ERROR, "demux: %d setsockopt SO_RCVBUF %d\n", errno, rcvbuf);
+    }
+    if (bind (fd, grp->ai_addr, grp->ai_addrlen) != 0) {
+	LogMessage (CS_LOG_TYPE_ERROR, "demux: %d bind port %d on %s\n", errno, port, udpaddr);
+	goto fail;
+    }
+    if (grp->ai_family == AF_INET6) {
+	struct ipv6_mreq mreq6;
+	memset (&mreq6, 0, sizeof(mreq6));
+	mreq6.ipv6mr_multiaddr = ((struct sockaddr_in6 *)grp->ai_addr)->sin6_addr;
+	mreq6.ipv6mr_interface = 0;
+	err = setsockopt (fd, IPPROTO_IPV6, IPV6_ADD_MEMBERSHIP, &mreq6, sizeof(mreq6));
+    }
+    else {
+	struct ip_mreq mreq;
+	hints.ai_family = AF_INET;
+	hints.ai_flags = 0;
+	if (getaddrinfo (mcastif, NULL, &hints, &ifa) != 0) {
+	    LogMessage (CS_LOG_TYPE_ERROR, "demux: invalid multicast interface %s\n", mcastif);
+	    goto fail;
+	}
+	mreq.imr_multiaddr = ((struct sockaddr_in *)grp->ai_addr)->sin_addr;
+	mreq.imr_interface = ((struct sockaddr_in *)ifa->ai_addr)->sin_addr;
+	err = setsockopt (fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq));
+	freeaddrinfo (ifa);
+    }
+    if (err != 0) {
+	LogMessage (CS_LOG_TYPE_ERROR, "demux: %d joining multicast group %s on %s\n",
+		    errno, udpaddr, mcastif);
+	goto fail;
+    }
+    freeaddrinfo (grp);
+    return fd;
+
+fail:
+    close (fd);
+    freeaddrinfo (grp);
+    return -1;
+}
+
+/************************************************************************
+ *  receive_time:
+ *	Set ts to the kernel receive time of a datagram, or to readtime
+ *	if it has none.
+ ************************************************************************/
+static void receive_time (struct msghdr *mh, struct timespec *readtime,
+			  struct timespec *ts)
+{
+    struct cmsghdr *cm;
+
+    for (cm = CMSG_FIRSTHDR(mh); cm != NULL; cm = CMSG_NXTHDR(mh, cm)) {
+	if (cm->cmsg_level == SOL_SOCKET && cm->cmsg_type == SCM_TIMESTAMPNS) {
+	    memcpy (ts, CMSG_DATA(cm), sizeof(*ts));
+	    return;
+	}
+    }
+    *ts = *readtime;
+}
+
+/************************************************************************
+ *  mcast_demux:
+ *	Receive the multicast group and forward records to station
+ *	sockets until terminated by a signal.  Return 0 on normal
+ *	termination, -1 on error.
+ ************************************************************************/
+int mcast_demux (char *mcastif, char *udpaddr, int port, char *demuxdir,
+		 int statusinterval)
+{
+    static char buf[DEMUX_BATCH][DEMUX_PKTSIZE];
+    static char ctl[DEMUX_BATCH][DEMUX_CTLSZ];
+    struct mmsghdr in[DEMUX_BATCH], out[DEMUX_BATCH];
+    struct iovec iov_in[DEMUX_BATCH], iov_out[DEMUX_BATCH][2];
+    struct timespec stamp[DEMUX_BATCH], readtime;
+    DEMUX_DEST *outdest[DEMUX_BATCH];
+    DEMUX_DEST *dp;
+    struct sigaction action;
+    uint64_t received = 0, delivered = 0, dropped = 0;
+    time_t now, next_status;
+    int mfd, ofd, n, nout, i, sent, on = 1;
+
+    if ((dest = (DEMUX_DEST *)calloc (DEMUX_SLOTS, sizeof(DEMUX_DEST))) == NULL) {
+	LogMessage (CS_LOG_TYPE_ERROR, "demux: unable to allocate station table\n");
+	return -1;
+    }
+    if ((mfd = open_mcast (mcastif, udpaddr, port)) < 0) return -1;
+    if (setsockopt (mfd, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on)) != 0) {
+	LogMessage (CS_LOG_TYPE_ERROR, "demux: %d setsockopt SO_TIMESTAMPNS, using read time\n", errno);
+    }
+    if ((ofd = socket (AF_UNIX, SOCK_DGRAM, 0)) < 0) {
+	LogMessage (CS_LOG_TYPE_ERROR, "demux: %d opening local socket\n", errno);
+	close (mfd);
+	return -1;
+    }
+
+    /* Terminate signals must interrupt recvmmsg. */
+    memset (&action, 0, sizeof(action));
+    action.sa_handler = demux_finish;
+    sigemptyset (&action.sa_mask);
+    sigaction (SIGHUP, &action, NULL);
+    sigaction (SIGINT, &action, NULL);
+    sigaction (SIGQUIT, &action, NULL);
+    sigaction (SIGTERM, &action, NULL);
+    signal (SIGPIPE, SIG_IGN);
+
+    memset (in, 0, sizeof(in));
+    for (i=0; i<DEMUX_BATCH; i++) {
+	iov_in[i].iov_base = buf[i];
+	iov_in[i].iov_len = DEMUX_PKTSIZE;
+	in[i].msg_hdr.msg_iov = &iov_in[i];
+	in[i].msg_hdr.msg_iovlen = 1;
+	in[i].msg_hdr.msg_control = ctl[i];
+    }
+    LogMessage (CS_LOG_TYPE_INFO, "demux: receiving %s port %d on %s, forwarding to %s\n",
+		udpaddr, port, mcastif, demuxdir);
+    next_status = time(NULL) + statusinterval;
+
+    while (! demux_done) {
+	for (i=0; i<DEMUX_BATCH; i++) in[i].msg_hdr.msg_controllen = DEMUX_CTLSZ;
+	n = recvmmsg (mfd, in, DEMUX_BATCH, MSG_WAITFORONE, NULL);
+	if (n < 0) {
+	    if (errno == EINTR) continue;
+	    LogMessage (CS_LOG_TYPE_ERROR, "demux: %d receiving from %s\n", errno, udpaddr);
+	    break;
+	}
+	clock_gettime (CLOCK_REALTIME, &readtime);
+	now = readtime.tv_sec;
+	received += n;
+
+	/* Build the batch of records for stations that are present. */
+	nout = 0;
+	for (i=0; i<n; i++) {
+	    if (in[i].msg_len < MIN_HDR_SIZE ||
+		(dp = find_dest (buf[i], demuxdir)) == NULL) {
+		++dropped;
+		continue;
+	    }
+	    if (dp->invalid || dp->retry > now) {
+		++dp->dropped;
+		++dropped;
+		continue;
+	    }
+	    receive_time (&in[i].msg_hdr, &readtime, &stamp[i]);
+	    iov_out[nout][0].iov_base = &stamp[i];
+	    iov_out[nout][0].iov_len = sizeof(stamp[i]);
+	    iov_out[nout][1].iov_base = buf[i];
+	    iov_out[nout][1].iov_len = in[i].msg_len;
+	    memset (&out[nout], 0, sizeof(out[nout]));
+	    out[nout].msg_hdr.msg_name = &dp->sun;
+	    out[nout].msg_hdr.msg_namelen = dp->sunlen;
+	    out[nout].msg_hdr.msg_iov = iov_out[nout];
+	    out[nout].msg_hdr.msg_iovlen = 2;
+	    outdest[nout] = dp;
+	    ++nout;
+	}
+
+	/* sendmmsg stops at the first failed record.  Drop that record, */
+	/* mark its station absent if it has no socket, and continue.	 */
+	i = 0;
+	while (i < nout) {
+	    sent = sendmmsg (ofd, &out[i], nout - i, MSG_DONTWAIT);
+	    if (sent < 0) {
+		if (errno == EINTR) continue;
+		dp = outdest[i];
+		++dp->dropped;
+		++dropped;
+		if (errno != EAGAIN && errno != EWOULDBLOCK && errno != ENOBUFS) {
+		    if (dp->present || dp->delivered == 0) {
+			LogMessage (CS_LOG_TYPE_INFO, "demux: no server for %s (%d), retry every %d seconds\n",
+				    dp->sun.sun_path, errno, DEMUX_RETRY);
+		    }
+		    dp->present = 0;
+		    dp->retry = now + DEMUX_RETRY;
+		}
+		++i;
+		continue;
+	    }
+	    for (; sent > 0; sent--, i++) {
+		dp = outdest[i];
+		if (! dp->present) {
+		    LogMessage (CS_LOG_TYPE_INFO, "demux: forwarding to %s\n", dp->sun.sun_path);
+		    dp->present = 1;
+		}
+		++dp->delivered;
+		++delivered;
+	    }
+	}
+
+	if (statusinterval > 0 && now >= next_status) {
+	    LogMessage (CS_LOG_TYPE_INFO, "demux: stations=%d received=%llu delivered=%llu dropped=%llu\n",
+			ndest, (unsigned long long)received, (unsigned long long)delivered,
+			(unsigned long long)dropped);
+	    next_status = now + statusinterval;
+	}
+    }
+    LogMessage (CS_LOG_TYPE_INFO, "demux: terminated, received=%llu delivered=%llu dropped=%llu\n",
+		(unsigned long long)received, (unsigned long long)delivered,
+		(unsigned long long)dropped);
+    close (ofd);
+    close (mfd);
+    return (demux_done) ? 0 : -1;
+}
@@ -0,0 +1,26 @@
+/*
+ * File     :
+ *   mcastdemux.h
+ *
+ * Purpose  :
+ *  Single multicast receiver that demultiplexes MiniSEED records by
+ *  station and network to the local sockets of per-station mserv servers.
+ *
+ * 2026-10-19 Initial version.
+ */
+
+#ifndef MCASTDEMUX_H
+#define MCASTDEMUX_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    int mcast_demux_path(char *path, int pathlen, char *demuxdir,
+			 char *station, char *network);
+    int mcast_demux(char *mcastif, char *udpaddr, int port, char *demuxdir,
+		    int statusinterval);
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -282,6 +282,11 @@ int GetServerParamsFromStationIni(struct mserv_cfg* out_cfg, char *section_name)
 	    strcpy(out_cfg->ipport, str2) ;
 	    continue;
 	}
+	if (strcmp(str1, "DEMUXDIR") == 0)
+	{
+	    strcpy(out_cfg->demuxdir, str2) ;
+	    continue;
+	}
 	if (strcmp(str1, "LOCKFILE") == 0)
 	{
 	    strcpy(out_cfg->lockfile, str2) ;
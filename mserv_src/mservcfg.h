@@ -47,6 +47,7 @@ struct mserv_cfg
     char mcastif[CFGWIDTH];
     char udpaddr[CFGWIDTH];
     char ipport[CFGWIDTH];
+    char demuxdir[CFGWIDTH];
     char lockfile[CFGWIDTH];
     char startmsg[CFGWIDTH];
     char verbosity[CFGWIDTH];
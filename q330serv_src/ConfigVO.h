@@ -20,6 +20,9 @@
  *  27 July 2002
  *  2020-09-29 DSN Updated for comserv3.
  *  2022-03-16 DSN Added support for TCP connection to Q330/baler.
+ *  2026-10-19 Added MULTICASTFORMAT for coalesced onesec multicast packets.
+ *  2026-10-19 Added CLOSEDLOOP for closed loop data acknowledge.
+ *  2026-10-19 Added NETSERVERPORT to start a lib330 netserver.
  */
 
 #ifndef _ConfigVO_H
@@ -70,6 +73,9 @@ public:
     uint16_t getMulticastPort() const;
     char *   getMulticastHost() const;
     char *   getMulticastChannelList() const;
+    uint16_t getMulticastCoalesce() const;
+    uint16_t getClosedLoop() const;
+    uint16_t getNetserverPort() const;
     char *   getContFileDir() const;
     uint32_t getWaitForClients() const;
     uint32_t getPacketQueueSize() const;
@@ -103,6 +109,9 @@ public:
     void setMulticastPort(char * input);
     void setMulticastHost(char * input);
     void setMulticastChannelList(char * input);
+    void setMulticastFormat(char * input);
+    void setClosedLoop(char * input);
+    void setNetserverPort(char * input);
     void setContFileDir(char * input);
     void setWaitForClients(char *input);
     void setPacketQueueSize(char *input);
@@ -147,6 +156,9 @@ private:
     uint16_t p_multicast_port;
     char     p_multicast_host[256];
     char     p_multicast_channellist[512];
+    uint16_t p_multicast_coalesce;
+    uint16_t p_closed_loop;
+    uint16_t p_netserver_port;
     char     p_contFileDir[256];
     uint32_t p_waitForClients;
     uint32_t p_packetQueueSize;
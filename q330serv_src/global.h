@@ -10,6 +10,7 @@
     2012-01-11 - v2.0.5 - paulf version with newer compiler fixes 
     2012-02-06 - v2.0.6 - DSN version with limit to RLIMIT_NOFILE.
     2020-09-29 DSN Updated for comserv3.
+    2026-10-19 - v1.1.2 - Asynchronous log writer.
 */
  
 #ifndef __GLOBAL_H__
@@ -29,8 +30,8 @@
 #define APP_IDENT_STRING "q330serv"
 #define MAJOR_VERSION 1
 #define MINOR_VERSION 1
-#define RELEASE_VERSION 1
-#define RELEASE_DATE "2023.093-beta"
+#define RELEASE_VERSION 2
+#define RELEASE_DATE "2026.292"
 #define APP_VERSION_STRING APP_IDENT_STRING " v" STRING(MAJOR_VERSION) "." STRING(MINOR_VERSION) "." STRING(RELEASE_VERSION) " (" RELEASE_DATE ")"
 
 #define STATION_INI	"station.ini"
@@ -3,6 +3,9 @@
  *
  * Modification History:
  *  2020-09-29 DSN Updated for comserv3.
+ *  2026-10-19 Multicast through an osm_sender (multicastformat).
+ *  2026-10-19 Added updateStatistics.
+ *  2026-10-19 Added netserver for NETSERVERPORT.
  */
 
 #ifndef __LIB330INTERFACE_H__
@@ -22,10 +25,12 @@ extern "C" {
 #include <libtypes.h>
 #include <libmsgs.h>
 #include <libsupport.h>
+#include <libnetserv.h>
 }
 
 #include "ConfigVO.h"
 #include "PacketQueue.h"
+#include "onesecmcast.h"
 
 #define MAX_MULTICASTCHANNELENTRIES 256
 
@@ -47,6 +52,9 @@ struct onesec_pkt{
 
 #define ONESEC_PKT_HDR_LEN 52
 
+// Longest time a partly filled coalesced multicast datagram is held.
+#define MULTICAST_MAX_AGE	0.02
+
 // Q330 epoch start time is 2000-01-01T00:00:00 
 // Q330 systems count in nominal seconds (ignoring leapseconds),
 // eg 1 day is always 8640 seconds.
@@ -70,6 +78,7 @@ EXTERN int mcastSocketFD = -1;
 #else
 EXTERN int mcastSocketFD;
 #endif
+EXTERN osm_sender mcastSender;
 
 
 class Lib330Interface {
@@ -83,10 +92,12 @@ public:
     void startDataFlow();
     void flushData();
     void displayStatusUpdate();
+    void updateStatistics();
     int waitForState(enum tlibstate, int, void(*)());
     enum tlibstate getLibState();
     void ping();
     int processPacketQueue();
+    void flushMulticast();
     int queueNearFull();
     bool build_multicastChannelList(char *);
     void log_q330serv_config(ConfigVO ourConfig);
@@ -102,6 +113,7 @@ public:
     static int num_multicastChannelEntries;
     static multicastChannelEntry multicastChannelList[MAX_MULTICASTCHANNELENTRIES];
     static double timestampOfLastRecord;
+    static pointer netserver;
 
 private:
     int sendUserMessage(char *);
@@ -114,6 +126,7 @@ private:
     tpar_register registrationInfo;
     tpar_create   creationInfo;
     enum tlibstate currentLibState;
+    tnsbuf *netserverBuffer;
 
 };
 
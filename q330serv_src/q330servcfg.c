@@ -22,6 +22,9 @@
  *  2015/09/25 - DSN - Added close_cfg() calls to close all config files.
  *  2020-09-29 DSN Updated for comserv3.
  *  2022-03-16 DSN Added support for TCP connection to Q330/baler.
+ *  2026-10-19 Added MULTICASTFORMAT for coalesced onesec multicast packets.
+ *  2026-10-19 Added CLOSEDLOOP for closed loop data acknowledge.
+ *  2026-10-19 Added NETSERVERPORT to start a lib330 netserver.
  */
 
 #include "q330servcfg.h"
@@ -202,6 +205,16 @@ int GetGlobalParamsFromNetworkIni(struct q330serv_cfg* out_cfg)
 	    strcpy(out_cfg->multicastChannelList, str2);
 	    continue;
 	}
+	if (strcmp(str1, "MULTICASTFORMAT") == 0)
+	{
+	    strcpy(out_cfg->multicastFormat, str2);
+	    continue;
+	}
+	if (strcmp(str1, "CLOSEDLOOP") == 0)
+	{
+	    strcpy(out_cfg->closedLoop, str2);
+	    continue;
+	}
 	if (strcmp(str1, "FAILEDREGISTRATIONSBEFORESLEEP") == 0)
 	{
 	    strcpy(out_cfg->failedRegistrationsBeforeSleep, str2);
@@ -316,6 +329,16 @@ int GetServerParamsFromStationIni(struct q330serv_cfg* out_cfg, char *section_na
 	    strcpy(out_cfg->multicastChannelList, str2);
 	    continue;
 	}
+	if (strcmp(str1, "MULTICASTFORMAT") == 0)
+	{
+	    strcpy(out_cfg->multicastFormat, str2);
+	    continue;
+	}
+	if (strcmp(str1, "CLOSEDLOOP") == 0)
+	{
+	    strcpy(out_cfg->closedLoop, str2);
+	    continue;
+	}
 	if (strcmp(str1, "FAILEDREGISTRATIONSBEFORESLEEP") == 0)
 	{
 	    strcpy(out_cfg->failedRegistrationsBeforeSleep, str2);
@@ -382,6 +405,11 @@ int GetServerParamsFromStationIni(struct q330serv_cfg* out_cfg, char *section_na
 	    strcpy(out_cfg->multicastPort, str2);
 	    continue;
 	}
+	if (strcmp(str1, "NETSERVERPORT") == 0)
+	{
+	    strcpy(out_cfg->netserverPort, str2);
+	    continue;
+	}
     }
     close_cfg(&cfg);
     return QSERV_SUCCESS;
@@ -22,6 +22,9 @@
  *  28 March 2002
  *  2020-09-29 DSN Updated for comserv3.
  *  2022-03-16 DSN Added support for TCP connection to Q330/baler.
+ *  2026-10-19 Added MULTICASTFORMAT for coalesced onesec multicast packets.
+ *  2026-10-19 Added CLOSEDLOOP for closed loop data acknowledge.
+ *  2026-10-19 Added NETSERVERPORT to start a lib330 netserver.
  */
 
 #ifndef Q330CFG_H
@@ -65,6 +68,9 @@ struct q330serv_cfg
     char multicastHost[CFGWIDTH];
     char multicastEnabled[CFGWIDTH];
     char multicastChannelList[CFGWIDTH];
+    char multicastFormat[CFGWIDTH];
+    char closedLoop[CFGWIDTH];
+    char netserverPort[CFGWIDTH];
     char waitForClients[CFGWIDTH];
     char packetQueueSize[CFGWIDTH];
 };
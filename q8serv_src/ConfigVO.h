@@ -21,6 +21,8 @@
  * Modification History:
  *  27 July 2002
  *  2020-09-29 DSN Updated for comserv3.
+ *  2026-10-19 Added MULTICASTFORMAT for coalesced onesec multicast packets.
+ *  2026-10-19 Added DATASERVERPORT to start a lib660 dataserver.
  */
 
 #ifndef _ConfigVO_H
@@ -69,8 +71,10 @@ public:
     uint16_t getMulticastPort() const;
     char *   getMulticastHost() const;
     char *   getMulticastChannelList() const;
+    uint16_t getMulticastCoalesce() const;
     char *   getContFileDir() const;
     uint32_t getLimitBackfill() const;
+    uint16_t getDataserverPort() const;
     uint32_t getWaitForClients() const;
     uint32_t getPacketQueueSize() const;
     // Bandwith control options
@@ -108,8 +112,10 @@ public:
     void setMulticastPort(char * input);
     void setMulticastHost(char *input);
     void setMulticastChannelList(char *input);
+    void setMulticastFormat(char *input);
     void setContFileDir(char *input);
     void setLimitBackfill(char *input);
+    void setDataserverPort(char *input);
     void setWaitForClients(char *input);
     void setPacketQueueSize(char *input);
     // Bandwith control options
@@ -165,8 +171,10 @@ private:
     uint16_t p_multicast_port;
     char     p_multicast_host[CFGWIDTH];
     char     p_multicast_channellist[512];
+    uint16_t p_multicast_coalesce;
     char     p_contFileDir[CFGWIDTH];
     uint32_t p_limitBackfill;
+    uint16_t p_dataserver_port;
     uint32_t p_waitForClients;
     uint32_t p_packetQueueSize;
     // Bandwidth control options
@@ -4,6 +4,11 @@
  * Modification History:
  *  2020-04-08 DSN Initial coding derived from lib330interface.C
  *  2020-09-29 DSN Updated for comserv3.
+ *  2026-10-19 Per-channel multicast descriptor cache for onesec and
+ *		lowlatency callbacks, replacing lowlatencymap.
+ *  2026-10-19 Multicast through an osm_sender (multicastformat).
+ *  2026-10-19 Added updateStatistics.
+ *  2026-10-19 Added dataserver for DATASERVERPORT.
  */
 
 #ifndef __LIB660INTERFACE_H__
@@ -29,12 +34,14 @@ extern "C" {
 #include <libmsgs.h>
 #include <libsupport.h>
 #include <libstrucs.h>
+#include <libdataserv.h>
 #include "q8_private_station_info.h"
 #include "file_callback.h"
 }
 
 #include "ConfigVO.h"
 #include "PacketQueue.h"
+#include "onesecmcast.h"
 
 #define MAX_MULTICASTCHANNELENTRIES	256
 
@@ -56,6 +63,33 @@ struct onesec_pkt{
 
 #define ONESEC_PKT_HDR_LEN 52
 
+// Longest time a partly filled coalesced multicast datagram is held.
+#define MULTICAST_MAX_AGE	0.02
+
+// Fixed leading part of onesec_pkt for a channel.
+struct onesec_pkt_hdr{
+    char net[4];
+    char station[16];
+    char channel[16];
+    char location[4];
+};
+
+// Multicast descriptor for a channel, indexed by the lib660 channel
+// number (tonesec_call chan_number) and built the first time the channel is seen by the onesec or
+// lowlatency callback.  The names are kept to detect a different
+// channel using the same number.
+#define MAX_CHANNEL_DESC	256
+
+typedef struct {
+    int generation;		// Descriptor is valid if equal to descGeneration.
+    string9 station_name;	// lib660 names the descriptor was built for.
+    string2 location;
+    string3 channel;
+    bool multicast;		// Channel matches the multicast channel list.
+    bool lowlatency;		// Channel is multicast by lowlatency_callback.
+    struct onesec_pkt_hdr hdr;	// Pre-rendered packet header, network byte order.
+} multicastChannelDesc;
+
 // Q330 epoch start time is 2000-01-01T00:00:00 
 // Q660 epoch start time is 2016-01-01T00:00:00
 // Both systems count in nominal seconds (ignoring leapseconds),
@@ -84,6 +118,7 @@ EXTERN int mcastSocketFD = -1;
 EXTERN int mcastSocketFD;
 #endif
 EXTERN char multicastChannelList[256][8];
+EXTERN osm_sender mcastSender;
 
 extern tcontext g_stationContext;	//:: DEBUG
 
@@ -98,9 +133,11 @@ public:
     void startDataFlow();
     void flushData();
     void displayStatusUpdate();
+    void updateStatistics();
     int waitForState(enum tlibstate, int, void(*)());
     enum tlibstate getLibState();
     int processPacketQueue();
+    void flushMulticast();
     int queueNearFull();
     bool build_multicastChannelList(char *);
     void log_q8serv_config(ConfigVO ourConfig);
@@ -119,9 +156,13 @@ public:
     static int num_multicastChannelEntries;
     static multicastChannelEntry multicastChannelList[MAX_MULTICASTCHANNELENTRIES];
     static double timestampOfLastRecord;
-    /* Map and interator for list of lowlatency channels. */
-    static std::map<std::string, int> lowlatencymap;
-    static std::map<std::string,int>::iterator it;
+    /* Multicast descriptors, and generation to invalidate all of them. */
+    static multicastChannelDesc channelDesc[MAX_CHANNEL_DESC];
+    static int descGeneration;
+    static pointer dataserver;
+    static multicastChannelDesc *getChannelDesc(tonesec_call *src);
+    static void sendOnesecPacket(multicastChannelDesc *desc, tonesec_call *src, const char *func);
+    static void clearChannelDescs();
 
 private:
     int sendUserMessage(char *);
@@ -134,6 +175,7 @@ private:
     tpar_register registrationInfo;
     tpar_create   creationInfo;
     enum tlibstate currentLibState;
+    tdsbuf *dataserverBuffer;
     /* Structures for site-specific info. */
     tfile_owner fowner;
     private_station_info station_info;
@@ -21,6 +21,10 @@
  *  28 March 2002
  *  2015/09/25 DSN Added close_cfg() calls to close all config files.
  *  2020-09-29 DSN Updated for comserv3.
+ *  2026-10-19 Added MULTICASTFORMAT for coalesced onesec multicast packets.
+ *  2026-10-19 Added DATASERVERPORT to start a lib660 dataserver.
+ *  2026-10-19 Restored the end of the GetGlobalParamsFromNetworkIni
+ *		header comment, which had swallowed the function definition.
  */
 
 #include "stuff.h"
@@ -117,7 +121,10 @@ int GetServerParamsFromStationsIni(struct q8serv_cfg *out_cfg, char *server_name
 /***********************************************************************
  * GetGlobalParamsFromNetworkIni
  *   Retrieve and return any pertinent global parameters from NETWORK_INI.
- *   Silently ignore any paremters that you are not interested int GetGlobalParamsFromNetworkIni(struct q8serv_cfg* out_cfg)
+ *   Silently ignore any paremters that you are not interested in.
+ **********************************************************************/
+
+int GetGlobalParamsFromNetworkIni(struct q8serv_cfg* out_cfg)
 {
     config_struc network_cfg;           /* structure for config file op */
     char str1[CFGWIDTH], str2[CFGWIDTH];
@@ -200,6 +207,11 @@ int GetServerParamsFromStationsIni(struct q8serv_cfg *out_cfg, char *server_name
 	    strcpy(out_cfg->multicastChannelList, str2);
 	    continue;
 	}
+	if (strcmp(str1, "MULTICASTFORMAT") == 0)
+	{
+	    strcpy(out_cfg->multicastFormat, str2);
+	    continue;
+	}
 	if (strcmp(str1, "FAILEDREGISTRATIONSBEFORESLEEP") == 0)
 	{
 	    strcpy(out_cfg->failedRegistrationsBeforeSleep, str2);
@@ -349,6 +361,11 @@ int GetServerParamsFromStationIni(struct q8serv_cfg* out_cfg, char *section_name
 	    strcpy(out_cfg->multicastChannelList, str2);
 	    continue;
 	}
+	if (strcmp(str1, "MULTICASTFORMAT") == 0)
+	{
+	    strcpy(out_cfg->multicastFormat, str2);
+	    continue;
+	}
 	if (strcmp(str1, "FAILEDREGISTRATIONSBEFORESLEEP") == 0)
 	{
 	    strcpy(out_cfg->failedRegistrationsBeforeSleep, str2);
@@ -450,6 +467,11 @@ int GetServerParamsFromStationIni(struct q8serv_cfg* out_cfg, char *section_name
 	    strcpy(out_cfg->multicastPort, str2);
 	    continue;
 	}
+	if (strcmp(str1, "DATASERVERPORT") == 0)
+	{
+	    strcpy(out_cfg->dataserverPort, str2);
+	    continue;
+	}
     }
     close_cfg(&cfg);
     return QSERV_SUCCESS;
@@ -21,6 +21,8 @@
  * Mod Date :
  *  28 March 2002
  *  2020-09-29 DSN Updated for comserv3.
+ *  2026-10-19 Added MULTICASTFORMAT for coalesced onesec multicast packets.
+ *  2026-10-19 Added DATASERVERPORT to start a lib660 dataserver.
  */
 
 #ifndef Q8SERVCFG_H
@@ -61,7 +63,9 @@ struct q8serv_cfg
     char multicastPort[CFGWIDTH];
     char multicastHost[CFGWIDTH];
     char multicastChannelList[CFGWIDTH];
+    char multicastFormat[CFGWIDTH];
     char limitBackfill[CFGWIDTH];
+    char dataserverPort[CFGWIDTH];
     char waitForClients[CFGWIDTH];
     char packetQueueSize[CFGWIDTH];
     /* Info for lowlatency support. */